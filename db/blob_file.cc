@@ -0,0 +1,427 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "db/blob_file.h"
+
+#include <string.h>
+#include <vector>
+
+#include "db/filename.h"
+#include "db/version_edit.h"
+#include "vidardb/splitter.h"
+#include "vidardb/statistics.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/file_reader_writer.h"
+#include "util/logging.h"
+#include "util/perf_context_imp.h"
+#include "util/stop_watch.h"
+#include "util/string_util.h"
+
+namespace vidardb {
+
+namespace {
+
+const uint64_t kBlobFileMagicNumber = 0x62d3a4ff1c7b09e5ull;
+const uint64_t kBlobFileHeaderSize = 8;
+
+const char kInlineColumn = '\0';
+const char kBlobColumn = '\1';
+
+static void DeleteBlobFile(const Slice& key, void* value) {
+  delete reinterpret_cast<RandomAccessFileReader*>(value);
+}
+
+// Blob files share the table cache with the table readers, so their keys are
+// one byte longer than the file numbers keying the tables.
+static std::string GetBlobFileCacheKey(uint64_t file_number) {
+  std::string key(1, 'b');
+  PutFixed64(&key, file_number);
+  return key;
+}
+
+std::vector<Slice> SplitColumns(const Slice& value, const Splitter* splitter) {
+  if (splitter == nullptr) {
+    return std::vector<Slice>(1, value);
+  }
+  return splitter->Split(value);
+}
+
+struct BlobColumn {
+  uint64_t file_number;
+  uint64_t offset;
+  uint64_t size;
+};
+
+bool DecodeBlobColumn(Slice column, BlobColumn* blob) {
+  if (column.empty() || column[0] != kBlobColumn) {
+    return false;
+  }
+  column.remove_prefix(1);
+  uint64_t* fields[] = {&blob->file_number, &blob->offset, &blob->size};
+  for (size_t i = 0; i < 3; i++) {
+    if (i > 0) {
+      if (column.empty() || column[0] != ' ') {
+        return false;
+      }
+      column.remove_prefix(1);
+    }
+    if (!ConsumeDecimalNumber(&column, fields[i])) {
+      return false;
+    }
+  }
+  return column.empty();
+}
+
+void EncodeBlobColumn(const BlobColumn& blob, std::string* dst) {
+  dst->push_back(kBlobColumn);
+  AppendNumberTo(dst, blob.file_number);
+  dst->push_back(' ');
+  AppendNumberTo(dst, blob.offset);
+  dst->push_back(' ');
+  AppendNumberTo(dst, blob.size);
+}
+
+}  // namespace
+
+bool GetBlobFileRef(const Slice& blob_index, const Splitter* splitter,
+                    uint64_t* file_number, uint64_t* blob_bytes) {
+  if (blob_index.empty()) {
+    return false;
+  }
+  *blob_bytes = 0;
+  for (const auto& column : SplitColumns(blob_index, splitter)) {
+    BlobColumn blob;
+    if (DecodeBlobColumn(column, &blob)) {
+      *file_number = blob.file_number;
+      *blob_bytes += blob.size + kBlobTrailerSize;
+    }
+  }
+  return *blob_bytes > 0;
+}
+
+uint32_t FindBlobFilePathId(Env* env, const std::vector<DbPath>& db_paths,
+                            uint64_t file_number) {
+  for (uint32_t path_id = 0; path_id < db_paths.size(); path_id++) {
+    if (env->FileExists(BlobFileName(db_paths, file_number, path_id)).ok()) {
+      return path_id;
+    }
+  }
+  return 0;
+}
+
+BlobFileCache::BlobFileCache(const ImmutableCFOptions& ioptions,
+                             const EnvOptions& env_options, Cache* cache)
+    : ioptions_(ioptions), env_options_(env_options), cache_(cache) {}
+
+Status BlobFileCache::FindBlobFile(uint64_t file_number,
+                                   Cache::Handle** handle) {
+  std::string key = GetBlobFileCacheKey(file_number);
+  *handle = cache_->Lookup(key);
+  if (*handle != nullptr) {
+    return Status::OK();
+  }
+
+  std::string fname = BlobFileName(
+      ioptions_.db_paths, file_number,
+      FindBlobFilePathId(ioptions_.env, ioptions_.db_paths, file_number));
+  unique_ptr<RandomAccessFile> file;
+  Status s = ioptions_.env->NewRandomAccessFile(fname, &file, env_options_);
+  RecordTick(ioptions_.statistics, NO_FILE_OPENS);
+  if (!s.ok()) {
+    RecordTick(ioptions_.statistics, NO_FILE_ERRORS);
+    return s;
+  }
+  if (ioptions_.advise_random_on_open) {
+    file->Hint(RandomAccessFile::RANDOM);
+  }
+  std::unique_ptr<RandomAccessFileReader> file_reader(
+      new RandomAccessFileReader(std::move(file), ioptions_.env,
+                                 ioptions_.statistics));
+  s = cache_->Insert(key, file_reader.get(), 1, &DeleteBlobFile, handle);
+  if (s.ok()) {
+    // Release ownership of file reader.
+    file_reader.release();
+  }
+  return s;
+}
+
+Status BlobFileCache::ReadBlob(const ReadOptions& read_options,
+                               uint64_t file_number, uint64_t offset,
+                               uint64_t size, std::string* value) {
+  if (read_options.read_tier == kBlockCacheTier) {
+    return Status::Incomplete("Blob not read, no_io is set");
+  }
+  Cache::Handle* handle = nullptr;
+  Status s = FindBlobFile(file_number, &handle);
+  if (!s.ok()) {
+    return s;
+  }
+  auto file = reinterpret_cast<RandomAccessFileReader*>(cache_->Value(handle));
+
+  // read the blob right into *value, trailer included
+  const size_t pos = value->size();
+  const size_t n = static_cast<size_t>(size + kBlobTrailerSize);
+  value->resize(pos + n);
+  char* scratch = &(*value)[pos];
+  Slice result;
+  s = file->Read(offset, n, &result, scratch);
+  cache_->Release(handle);
+  if (s.ok() && result.size() != n) {
+    s = Status::Corruption("truncated blob read from blob file #" +
+                           ToString(file_number));
+  }
+  if (s.ok() && read_options.verify_checksums) {
+    const uint32_t crc = crc32c::Unmask(DecodeFixed32(result.data() + size));
+    if (crc32c::Value(result.data(), static_cast<size_t>(size)) != crc) {
+      s = Status::Corruption("blob checksum mismatch in blob file #" +
+                             ToString(file_number));
+    }
+  }
+  if (s.ok() && result.data() != scratch) {
+    memcpy(scratch, result.data(), static_cast<size_t>(size));
+  }
+  value->resize(s.ok() ? pos + static_cast<size_t>(size) : pos);
+  return s;
+}
+
+Status BlobFileCache::GetBlobValue(const ReadOptions& read_options,
+                                   const Slice& blob_index,
+                                   std::string* value) {
+  value->clear();
+  if (blob_index.empty()) {
+    // e.g. all the columns projected away
+    return Status::OK();
+  }
+
+  const Splitter* splitter = ioptions_.splitter;
+  std::vector<Slice> columns(SplitColumns(blob_index, splitter));
+  std::string blob;
+  for (size_t i = 0; i < columns.size(); i++) {
+    Slice column = columns[i];
+    if (column.empty()) {
+      return Status::Corruption("empty column in blob index");
+    }
+    Slice resolved;
+    if (column[0] == kInlineColumn) {
+      resolved = Slice(column.data() + 1, column.size() - 1);
+    } else {
+      BlobColumn b;
+      if (!DecodeBlobColumn(column, &b)) {
+        return Status::Corruption("bad blob column in blob index");
+      }
+      blob.clear();
+      Status s = ReadBlob(read_options, b.file_number, b.offset, b.size,
+                          splitter == nullptr ? value : &blob);
+      if (!s.ok()) {
+        return s;
+      }
+      resolved = blob;
+    }
+    if (splitter != nullptr) {
+      splitter->Append(*value, resolved, i + 1 == columns.size());
+    } else if (column[0] == kInlineColumn) {
+      value->assign(resolved.data(), resolved.size());
+    }
+  }
+  return Status::OK();
+}
+
+Status BlobFileCache::GetBlobFileBytes(uint64_t file_number,
+                                       uint64_t* bytes) {
+  uint64_t file_size = 0;
+  Status s = ioptions_.env->GetFileSize(
+      BlobFileName(ioptions_.db_paths, file_number,
+                   FindBlobFilePathId(ioptions_.env, ioptions_.db_paths,
+                                      file_number)),
+      &file_size);
+  if (s.ok()) {
+    *bytes = file_size > kBlobFileHeaderSize ? file_size - kBlobFileHeaderSize
+                                             : 0;
+  }
+  return s;
+}
+
+void BlobFileCache::Evict(Cache* cache, uint64_t file_number) {
+  cache->Erase(GetBlobFileCacheKey(file_number));
+}
+
+BlobFileBuilder::BlobFileBuilder(
+    const ImmutableCFOptions& ioptions, const EnvOptions& env_options,
+    uint64_t file_number, uint32_t path_id, Env::IOPriority io_priority,
+    BlobFileCache* blob_file_cache,
+    const std::unordered_set<uint64_t>* gc_blob_files)
+    : ioptions_(ioptions),
+      env_options_(env_options),
+      file_number_(file_number),
+      path_id_(path_id),
+      io_priority_(io_priority),
+      blob_file_cache_(blob_file_cache),
+      gc_blob_files_(gc_blob_files),
+      file_size_(0),
+      num_blobs_(0) {}
+
+BlobFileBuilder::~BlobFileBuilder() {}
+
+Status BlobFileBuilder::AddBlob(const Slice& column,
+                                std::string* column_index) {
+  Status s;
+  if (file_ == nullptr) {
+    unique_ptr<WritableFile> file;
+    s = NewWritableFile(
+        ioptions_.env, BlobFileName(ioptions_.db_paths, file_number_, path_id_),
+        &file, env_options_);
+    if (!s.ok()) {
+      return s;
+    }
+    file->SetIOPriority(io_priority_);
+    file_.reset(new WritableFileWriter(std::move(file), env_options_));
+    char header[kBlobFileHeaderSize];
+    EncodeFixed64(header, kBlobFileMagicNumber);
+    s = file_->Append(Slice(header, sizeof(header)));
+    if (!s.ok()) {
+      return s;
+    }
+    file_size_ = kBlobFileHeaderSize;
+  }
+
+  char trailer[kBlobTrailerSize];
+  EncodeFixed32(trailer, crc32c::Mask(crc32c::Value(column.data(),
+                                                    column.size())));
+  s = file_->Append(column);
+  if (s.ok()) {
+    s = file_->Append(Slice(trailer, sizeof(trailer)));
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  BlobColumn blob = {file_number_, file_size_, column.size()};
+  EncodeBlobColumn(blob, column_index);
+  file_size_ += column.size() + kBlobTrailerSize;
+  blob_refs_[file_number_] += column.size() + kBlobTrailerSize;
+  num_blobs_++;
+  return s;
+}
+
+Status BlobFileBuilder::Separate(const Slice& value, std::string* blob_index) {
+  blob_index->clear();
+  const uint64_t min_blob_size = ioptions_.min_blob_size;
+  if (min_blob_size == 0 || value.size() < min_blob_size) {
+    return Status::OK();
+  }
+
+  const Splitter* splitter = ioptions_.splitter;
+  std::vector<Slice> columns(SplitColumns(value, splitter));
+  bool separated = false;
+  for (const auto& column : columns) {
+    if (column.size() >= min_blob_size) {
+      separated = true;
+      break;
+    }
+  }
+  if (!separated) {
+    return Status::OK();
+  }
+
+  std::string column_index;
+  for (size_t i = 0; i < columns.size(); i++) {
+    column_index.clear();
+    if (columns[i].size() >= min_blob_size) {
+      Status s = AddBlob(columns[i], &column_index);
+      if (!s.ok()) {
+        return s;
+      }
+    } else {
+      column_index.push_back(kInlineColumn);
+      column_index.append(columns[i].data(), columns[i].size());
+    }
+    if (splitter != nullptr) {
+      splitter->Append(*blob_index, column_index, i + 1 == columns.size());
+    } else {
+      blob_index->swap(column_index);
+    }
+  }
+  return Status::OK();
+}
+
+Status BlobFileBuilder::Add(const ParsedInternalKey& ikey, Slice* key,
+                            Slice* value) {
+  Slice input = *value;
+  if (ikey.type == kTypeBlobIndex) {
+    uint64_t file_number = 0;
+    uint64_t blob_bytes = 0;
+    if (!GetBlobFileRef(input, ioptions_.splitter, &file_number,
+                        &blob_bytes)) {
+      return Status::OK();
+    }
+    if (gc_blob_files_ == nullptr ||
+        gc_blob_files_->find(file_number) == gc_blob_files_->end()) {
+      // the blobs stay where they are
+      blob_refs_[file_number] += blob_bytes;
+      return Status::OK();
+    }
+    // move the blobs out of the blob file to collect
+    assert(blob_file_cache_ != nullptr);
+    ReadOptions read_options;
+    read_options.fill_cache = false;
+    Status s = blob_file_cache_->GetBlobValue(read_options, input, &blob_buf_);
+    if (!s.ok()) {
+      return s;
+    }
+    input = blob_buf_;
+  } else if (ikey.type != kTypeValue) {
+    return Status::OK();
+  }
+
+  Status s = Separate(input, &value_buf_);
+  if (!s.ok()) {
+    return s;
+  }
+  ValueType type = kTypeBlobIndex;
+  if (value_buf_.empty()) {
+    if (ikey.type == kTypeValue) {
+      return Status::OK();
+    }
+    // a collected value that is no longer large enough to be separated
+    value_buf_.assign(input.data(), input.size());
+    type = kTypeValue;
+  }
+  key_buf_.clear();
+  AppendInternalKey(&key_buf_,
+                    ParsedInternalKey(ikey.user_key, ikey.sequence, type));
+  *key = key_buf_;
+  *value = value_buf_;
+  return Status::OK();
+}
+
+Status BlobFileBuilder::Finish(FileMetaData* meta) {
+  Status s;
+  if (file_ != nullptr) {
+    if (!ioptions_.disable_data_sync) {
+      StopWatch sw(ioptions_.env, ioptions_.statistics, TABLE_SYNC_MICROS);
+      s = file_->Sync(ioptions_.use_fsync);
+    }
+    if (s.ok()) {
+      s = file_->Close();
+    }
+    file_.reset();
+  }
+  if (s.ok()) {
+    meta->blob_refs = blob_refs_;
+  }
+  return s;
+}
+
+void BlobFileBuilder::Abandon() {
+  if (file_ != nullptr) {
+    file_->Close();
+    file_.reset();
+    ioptions_.env->DeleteFile(
+        BlobFileName(ioptions_.db_paths, file_number_, path_id_));
+  }
+}
+
+}  // namespace vidardb
@@ -0,0 +1,151 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Key-value separation. The columns of at least min_blob_size bytes (the whole
+// value if there is no splitter) are appended to a blob file when a table file
+// is written, and the table stores the value as kTypeBlobIndex instead: the
+// columns joined with the splitter as before, so that projections and column
+// tables keep working on it, each prefixed with a tag
+//    kInlineColumn: column bytes
+//    kBlobColumn:   "<file number> <offset> <size>" in decimal, which never
+//                   contains the delimiter of a splitter
+// All the blob columns of a value are in the same blob file.
+//
+// Blob file format:
+//    magic: fixed64
+//    blob[0], blob[1], ..., blob[n-1]
+// where each blob is the column bytes followed by their masked crc32c
+// (fixed32). A blob file is named after the table file written with it, sits
+// on the same db path, and is deleted once no live table file references it
+// any more.
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "db/dbformat.h"
+#include "vidardb/cache.h"
+#include "vidardb/env.h"
+#include "vidardb/immutable_options.h"
+#include "vidardb/options.h"
+#include "vidardb/status.h"
+
+namespace vidardb {
+
+class Splitter;
+class WritableFileWriter;
+struct FileMetaData;
+
+// Bytes following the column bytes of every blob.
+const uint64_t kBlobTrailerSize = 4;
+
+// Sets *file_number to the blob file referenced by the kTypeBlobIndex value
+// blob_index and *blob_bytes to the bytes of its blobs, trailers included.
+// Returns false if the value references no blob.
+extern bool GetBlobFileRef(const Slice& blob_index, const Splitter* splitter,
+                           uint64_t* file_number, uint64_t* blob_bytes);
+
+// Returns the db path id of the blob file. The blob references only record
+// file numbers, so the db paths are searched in order, and 0 is returned if
+// the file is in none of them.
+extern uint32_t FindBlobFilePathId(Env* env,
+                                   const std::vector<DbPath>& db_paths,
+                                   uint64_t file_number);
+
+// Caches the blob files opened for reading in the table cache, next to the
+// table readers.
+class BlobFileCache {
+ public:
+  BlobFileCache(const ImmutableCFOptions& ioptions,
+                const EnvOptions& env_options, Cache* cache);
+
+  // Sets *value to the kTypeBlobIndex value blob_index with its blob columns
+  // read back from the blob files.
+  Status GetBlobValue(const ReadOptions& read_options, const Slice& blob_index,
+                      std::string* value);
+
+  // Sets *bytes to the bytes of all the blobs in a blob file.
+  Status GetBlobFileBytes(uint64_t file_number, uint64_t* bytes);
+
+  // Evict any entry for the specified blob file number.
+  static void Evict(Cache* cache, uint64_t file_number);
+
+ private:
+  Status FindBlobFile(uint64_t file_number, Cache::Handle** handle);
+
+  // Appends the column bytes of a blob to *value.
+  Status ReadBlob(const ReadOptions& read_options, uint64_t file_number,
+                  uint64_t offset, uint64_t size, std::string* value);
+
+  const ImmutableCFOptions& ioptions_;
+  const EnvOptions& env_options_;
+  Cache* const cache_;
+};
+
+// Rewrites the entries a flush or a compaction adds to one table file: the
+// large columns of the values go to the blob file of the table, and so do
+// the blobs of the blob files picked for garbage collection.
+class BlobFileBuilder {
+ public:
+  // The blob file is written to the db path path_id of its table file.
+  // blob_file_cache and gc_blob_files may be nullptr if no blob file has to
+  // be collected, e.g. in a flush.
+  BlobFileBuilder(const ImmutableCFOptions& ioptions,
+                  const EnvOptions& env_options, uint64_t file_number,
+                  uint32_t path_id, Env::IOPriority io_priority,
+                  BlobFileCache* blob_file_cache = nullptr,
+                  const std::unordered_set<uint64_t>* gc_blob_files = nullptr);
+
+  ~BlobFileBuilder();
+
+  // Sets *key and *value to the entry to add to the table in place of the
+  // ones parsed into ikey. They point either to the input or to buffers
+  // valid until the next call.
+  Status Add(const ParsedInternalKey& ikey, Slice* key, Slice* value);
+
+  // Syncs and closes the blob file if any blob was added, and records the
+  // blob files referenced by the table in meta->blob_refs.
+  Status Finish(FileMetaData* meta);
+
+  // Deletes the blob file if any blob was added.
+  void Abandon();
+
+  uint64_t NumBlobs() const { return num_blobs_; }
+
+ private:
+  // Appends the large columns of value to the blob file and sets *blob_index
+  // to the kTypeBlobIndex value. Leaves *blob_index empty if no column is
+  // large enough.
+  Status Separate(const Slice& value, std::string* blob_index);
+
+  Status AddBlob(const Slice& column, std::string* column_index);
+
+  const ImmutableCFOptions& ioptions_;
+  const EnvOptions& env_options_;
+  const uint64_t file_number_;
+  const uint32_t path_id_;
+  const Env::IOPriority io_priority_;
+  BlobFileCache* blob_file_cache_;
+  const std::unordered_set<uint64_t>* gc_blob_files_;
+
+  std::unique_ptr<WritableFileWriter> file_;
+  uint64_t file_size_;
+  uint64_t num_blobs_;
+  std::map<uint64_t, uint64_t> blob_refs_;
+
+  std::string key_buf_;
+  std::string value_buf_;
+  std::string blob_buf_;
+
+  // No copying allowed
+  BlobFileBuilder(const BlobFileBuilder&);
+  void operator=(const BlobFileBuilder&);
+};
+
+}  // namespace vidardb
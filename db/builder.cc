@@ -18,6 +18,7 @@
 #include <deque>
 #include <vector>
 
+#include "db/blob_file.h"
 #include "db/compaction_iterator.h"
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
@@ -49,7 +50,7 @@ TableBuilder* NewTableBuilder(
     uint32_t column_family_id, const std::string& column_family_name,
     WritableFileWriter* file, const CompressionType compression_type,
     const CompressionOptions& compression_opts, const EnvOptions& env_options,  // Shichao
-    const std::string* compression_dict) {
+    const std::string* compression_dict, int path_id) {
   assert((column_family_id ==
           TablePropertiesCollectorFactory::Context::kUnknownColumnFamily) ==
          column_family_name.empty());
@@ -57,7 +58,8 @@ TableBuilder* NewTableBuilder(
       TableBuilderOptions(ioptions, internal_comparator,
                           int_tbl_prop_collector_factories, compression_type,
                           compression_opts, compression_dict,
-                          column_family_name, env_options),  // Shichao
+                          column_family_name, env_options,  // Shichao
+                          path_id),
       column_family_id, file);
 }
 
@@ -112,17 +114,24 @@ Status BuildTable(
       builder = NewTableBuilder(
           ioptions, internal_comparator, int_tbl_prop_collector_factories,
           column_family_id, column_family_name, file_writer.get(), compression,
-          compression_opts, env_options);  // Shichao
+          compression_opts, env_options, nullptr /* compression_dict */,
+          static_cast<int>(meta->fd.GetPathId()));  // Shichao
     }
 
+    BlobFileBuilder blob_builder(ioptions, env_options, meta->fd.GetNumber(),
+                                 meta->fd.GetPathId(), io_priority);
     CompactionIterator c_iter(iter, internal_comparator.user_comparator(),
                               kMaxSequenceNumber, &snapshots,
                               earliest_write_conflict_snapshot,
                               true /* internal key corruption is not ok */);
     c_iter.SeekToFirst();
     for (; c_iter.Valid(); c_iter.Next()) {
-      const Slice& key = c_iter.key();
-      const Slice& value = c_iter.value();
+      Slice key = c_iter.key();
+      Slice value = c_iter.value();
+      s = blob_builder.Add(c_iter.ikey(), &key, &value);
+      if (!s.ok()) {
+        break;
+      }
       builder->Add(key, value);
       meta->UpdateBoundaries(key, c_iter.ikey().sequence);
 
@@ -136,17 +145,26 @@ Status BuildTable(
 
     // Finish and check for builder errors
     bool empty = builder->NumEntries() == 0;
-    s = c_iter.status();
+    if (s.ok()) {
+      s = c_iter.status();
+    }
     if (!s.ok() || empty) {
       builder->Abandon();
     } else {
       s = builder->Finish();
     }
+    if (s.ok() && !empty) {
+      s = blob_builder.Finish(meta);
+    }
+    if (!s.ok() || empty) {
+      blob_builder.Abandon();
+    }
 
     if (s.ok() && !empty) {
       uint64_t file_size = builder->FileSize();
       meta->fd.file_size = file_size;
       meta->fd.file_size_total = builder->FileSizeTotal();  // Shichao
+      meta->sub_path_ids = builder->SubFilePathIds();
       meta->marked_for_compaction = builder->NeedCompact();
       assert(meta->fd.GetFileSize() > 0);
       tp = builder->GetTableProperties();
@@ -189,6 +207,11 @@ Status BuildTable(
 
   if (!s.ok() || meta->fd.GetFileSize() == 0) {
     env->DeleteFile(fname);
+    if (!meta->blob_refs.empty()) {
+      env->DeleteFile(BlobFileName(ioptions.db_paths, meta->fd.GetNumber(),
+                                   meta->fd.GetPathId()));
+      meta->blob_refs.clear();
+    }
   }
 
   // Output to event logger and fire events.
@@ -46,6 +46,8 @@ class InternalIterator;
 //    TableBuilder returned by this function.
 // @param compression_dict Data for presetting the compression library's
 //    dictionary, or nullptr.
+// @param path_id Index of options.db_paths the file is written to, or -1 if
+//    it is written outside of the db paths.
 TableBuilder* NewTableBuilder(
     const ImmutableCFOptions& options,
     const InternalKeyComparator& internal_comparator,
@@ -55,7 +57,7 @@ TableBuilder* NewTableBuilder(
     WritableFileWriter* file, const CompressionType compression_type,
     const CompressionOptions& compression_opts,
     const EnvOptions& env_options = EnvOptions(),  // Shichao
-    const std::string* compression_dict = nullptr);
+    const std::string* compression_dict = nullptr, int path_id = -1);
 
 // Build a Table file from the contents of *iter.  The generated file
 // will be named according to number specified in meta. On success, the rest of
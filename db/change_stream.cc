@@ -0,0 +1,191 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include "db/change_stream.h"
+
+#include <inttypes.h>
+#include <algorithm>
+
+#include "db/filename.h"
+#include "db/version_set.h"
+#include "db/wal_manager.h"
+#include "db/write_batch_internal.h"
+#include "util/coding.h"
+#include "util/file_reader_writer.h"
+#include "util/string_util.h"
+
+namespace vidardb {
+
+ChangeStreamImpl::ChangeStreamImpl(const DBOptions* db_options,
+                                   const EnvOptions& env_options,
+                                   const ChangeStreamOptions& options,
+                                   SequenceNumber seq, WalManager* wal_manager,
+                                   const VersionSet* versions)
+    : db_options_(db_options),
+      env_options_(env_options),
+      options_(options),
+      wal_manager_(wal_manager),
+      versions_(versions),
+      next_seq_(seq),
+      log_number_(0) {
+  reporter_.info_log = db_options_->info_log.get();
+  reporter_.status = &reader_status_;
+}
+
+Status ChangeStreamImpl::FindLog(bool after_current, uint64_t* number,
+                                 WalFileType* type) {
+  *number = 0;
+  VectorLogPtr files;
+  Status s = wal_manager_->GetSortedWalFiles(files);
+  if (!s.ok()) {
+    return s;
+  }
+  const LogFile* found = nullptr;
+  for (const auto& file : files) {
+    if (after_current) {
+      if (file->LogNumber() > log_number_) {
+        found = file.get();
+        break;
+      }
+    } else if (found == nullptr || (file->StartSequence() > 0 &&
+                                    file->StartSequence() <= next_seq_)) {
+      // the last file starting at or before next_seq_, an empty file
+      // starting at 0
+      found = file.get();
+    }
+  }
+  if (found != nullptr) {
+    *number = found->LogNumber();
+    *type = found->Type();
+  }
+  return Status::OK();
+}
+
+Status ChangeStreamImpl::OpenLog(uint64_t number, WalFileType type) {
+  Env* env = db_options_->env;
+  const std::string& dir = db_options_->wal_dir;
+  unique_ptr<SequentialFile> file;
+  Status s;
+  if (type == kAliveLogFile) {
+    s = env->NewSequentialFile(LogFileName(dir, number), &file, env_options_);
+  }
+  if (type == kArchivedLogFile || !s.ok()) {
+    // an alive file may have been archived in the meanwhile
+    s = env->NewSequentialFile(ArchivedLogFileName(dir, number), &file,
+                               env_options_);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  if (options_.readahead_size > log::kBlockSize) {
+    file = NewReadaheadSequentialFile(std::move(file), options_.readahead_size);
+  }
+  unique_ptr<SequentialFileReader> file_reader(
+      new SequentialFileReader(std::move(file)));
+  reader_.reset(new log::Reader(db_options_->info_log, std::move(file_reader),
+                                &reporter_, options_.verify_checksums, 0,
+                                number));
+  log_number_ = number;
+  return Status::OK();
+}
+
+bool ChangeStreamImpl::ReadFromCurrentLog(Slice* record) {
+  if (reader_->ReadRecord(record, &scratch_)) {
+    return true;
+  }
+  if (reader_->IsEOF()) {
+    // look again for the records written since
+    reader_->UnmarkEOF();
+    return reader_->ReadRecord(record, &scratch_);
+  }
+  return false;
+}
+
+bool ChangeStreamImpl::ReadRecord(Slice* record, Status* s) {
+  uint64_t number;
+  WalFileType type;
+  if (reader_ == nullptr) {
+    *s = FindLog(false, &number, &type);
+    if (!s->ok() || number == 0) {
+      return false;
+    }
+    *s = OpenLog(number, type);
+    if (!s->ok()) {
+      return false;
+    }
+  }
+  while (true) {
+    if (ReadFromCurrentLog(record)) {
+      return true;
+    }
+    if (!reader_status_.ok()) {
+      *s = reader_status_;
+      return false;
+    }
+    *s = FindLog(true, &number, &type);
+    if (!s->ok() || number == 0) {
+      return false;
+    }
+    // The current file was complete before the next one was created, but
+    // its last records may have been written after the read above
+    if (ReadFromCurrentLog(record)) {
+      return true;
+    }
+    *s = OpenLog(number, type);
+    if (!s->ok()) {
+      return false;
+    }
+  }
+}
+
+Status ChangeStreamImpl::Next(std::vector<ChangeRecord>* records) {
+  records->clear();
+  buffer_.clear();
+  offsets_.clear();
+
+  Status s;
+  Slice record;
+  // Only the records of the updates already visible are complete
+  while (buffer_.size() < options_.max_chunk_bytes &&
+         next_seq_ <= versions_->LastSequence() && ReadRecord(&record, &s)) {
+    if (record.size() < WriteBatchInternal::kHeader) {
+      s = Status::Corruption("very small log record");
+      break;
+    }
+    SequenceNumber seq = DecodeFixed64(record.data());
+    uint32_t count = DecodeFixed32(record.data() + 8);
+    if (count > 0 ? seq + count <= next_seq_ : seq < next_seq_) {
+      // before the start of the stream
+      continue;
+    }
+    if (seq > next_seq_) {
+      s = Status::Corruption(
+          "Gap in the sequence numbers of the WAL, from " + ToString(next_seq_),
+          "to " + ToString(seq));
+      break;
+    }
+    offsets_.emplace_back(seq, buffer_.size());
+    buffer_.append(record.data(), record.size());
+    next_seq_ = std::max(next_seq_, seq + count);
+  }
+
+  // Only now that buffer_ is no longer growing
+  for (size_t i = 0; i < offsets_.size(); i++) {
+    size_t end =
+        i + 1 < offsets_.size() ? offsets_[i + 1].second : buffer_.size();
+    records->push_back({offsets_[i].first,
+                        Slice(buffer_.data() + offsets_[i].second,
+                              end - offsets_[i].second)});
+  }
+  return s;
+}
+
+}  // namespace vidardb
+#endif  // VIDARDB_LITE
@@ -0,0 +1,80 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "db/log_reader.h"
+#include "port/port.h"
+#include "vidardb/env.h"
+#include "vidardb/options.h"
+#include "vidardb/transaction_log.h"
+
+namespace vidardb {
+
+class VersionSet;
+class WalManager;
+
+class ChangeStreamImpl : public ChangeStream {
+ public:
+  ChangeStreamImpl(const DBOptions* db_options, const EnvOptions& env_options,
+                   const ChangeStreamOptions& options, SequenceNumber seq,
+                   WalManager* wal_manager, const VersionSet* versions);
+
+  virtual Status Next(std::vector<ChangeRecord>* records) override;
+
+  virtual SequenceNumber NextSequence() const override { return next_seq_; }
+
+ private:
+  struct LogReporter : public log::Reader::Reporter {
+    Logger* info_log;
+    Status* status;
+    virtual void Corruption(size_t bytes, const Status& s) override {
+      Log(InfoLogLevel::ERROR_LEVEL, info_log,
+          "change stream dropping %" VIDARDB_PRIszt " bytes; %s", bytes,
+          s.ToString().c_str());
+      if (status->ok()) {
+        *status = s;
+      }
+    }
+  };
+
+  // Sets *number to the WAL file that should hold next_seq_, or else to the
+  // first one after the current file if after_current, 0 if there is none.
+  Status FindLog(bool after_current, uint64_t* number, WalFileType* type);
+
+  Status OpenLog(uint64_t number, WalFileType type);
+
+  // The next record of the current WAL file, including the ones written
+  // since the last read.
+  bool ReadFromCurrentLog(Slice* record);
+
+  // Reads the next record of the WAL files, false at their end or on error.
+  bool ReadRecord(Slice* record, Status* s);
+
+  const DBOptions* const db_options_;
+  const EnvOptions env_options_;
+  const ChangeStreamOptions options_;
+  WalManager* const wal_manager_;
+  const VersionSet* const versions_;
+
+  SequenceNumber next_seq_;
+  uint64_t log_number_;  // of the WAL file being read, 0 if none
+  std::unique_ptr<log::Reader> reader_;
+  LogReporter reporter_;
+  Status reader_status_;  // corruption reported by reader_
+  std::string scratch_;
+  // The batches handed out by the last Next()
+  std::string buffer_;
+  std::vector<std::pair<SequenceNumber, size_t>> offsets_;
+};
+
+}  // namespace vidardb
+#endif  // VIDARDB_LITE
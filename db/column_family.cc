@@ -126,6 +126,11 @@ Status CheckConcurrentWritesSupported(const ColumnFamilyOptions& cf_options) {
     return Status::InvalidArgument(
         "Memtable doesn't concurrent writes (allow_concurrent_memtable_write)");
   }
+  if (cf_options.inplace_update_support) {
+    return Status::InvalidArgument(
+        "In-place memtable updates (inplace_update_support) is not compatible "
+        "with concurrent writes (allow_concurrent_memtable_write)");
+  }
   return Status::OK();
 }
 
@@ -178,6 +183,11 @@ ColumnFamilyOptions SanitizeOptions(const DBOptions& db_options,
     result.level0_file_num_compaction_trigger = 1;
   }
 
+  if (result.compaction_weight == 0) {
+    Warn(db_options.info_log.get(), "compaction_weight cannot be 0");
+    result.compaction_weight = 1;
+  }
+
   return result;
 }
 
@@ -283,6 +293,8 @@ ColumnFamilyData::ColumnFamilyData(
     internal_stats_.reset(
         new InternalStats(ioptions_.num_levels, db_options->env, this));
     table_cache_.reset(new TableCache(ioptions_, env_options, _table_cache));
+    blob_file_cache_.reset(
+        new BlobFileCache(ioptions_, env_options, _table_cache));
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(
           new LevelCompactionPicker(ioptions_, &internal_comparator_));
@@ -530,6 +542,26 @@ bool ColumnFamilyData::NeedsCompaction() const {
   return compaction_picker_->NeedsCompaction(current_->storage_info());
 }
 
+bool ColumnFamilyData::IsCompactionUrgent() const {
+  int trigger = mutable_cf_options_.level0_file_num_compaction_trigger;
+  return trigger > 0 &&
+         current_->storage_info()->l0_delay_trigger_count() >=
+             GetL0ThresholdSpeedupCompaction(trigger);
+}
+
+double ColumnFamilyData::CompactionUrgency() const {
+  const auto* vstorage = current_->storage_info();
+  // The scores are sorted, the first one is the highest
+  double urgency = vstorage->CompactionScore(0);
+  int trigger = mutable_cf_options_.level0_file_num_compaction_trigger;
+  if (trigger > 0) {
+    urgency = std::max(
+        urgency,
+        static_cast<double>(vstorage->l0_delay_trigger_count()) / trigger);
+  }
+  return urgency * std::max(mutable_cf_options_.compaction_weight, 1U);
+}
+
 Compaction* ColumnFamilyData::PickCompaction(
     const MutableCFOptions& mutable_options, LogBuffer* log_buffer) {
   auto* result = compaction_picker_->PickCompaction(
@@ -15,6 +15,7 @@
 #include <atomic>
 
 #include "memtable/memtable_list.h"
+#include "db/blob_file.h"
 #include "db/write_batch_internal.h"
 #include "db/write_controller.h"
 #include "db/table_cache.h"
@@ -242,10 +243,19 @@ class ColumnFamilyData {
                          SequenceNumber earliest_seq);
 
   TableCache* table_cache() const { return table_cache_.get(); }
+  BlobFileCache* blob_file_cache() const { return blob_file_cache_.get(); }
 
   // See documentation in compaction_picker.h
   // REQUIRES: DB mutex held
   bool NeedsCompaction() const;
+  // True if the level-0 files of this column family are many enough to make
+  // the writes speed up compactions.
+  // REQUIRES: DB mutex held
+  bool IsCompactionUrgent() const;
+  // How far the levels are past their compaction triggers, times
+  // compaction_weight. Used to pick the next column family to compact.
+  // REQUIRES: DB mutex held
+  double CompactionUrgency() const;
   // REQUIRES: DB mutex held
   Compaction* PickCompaction(const MutableCFOptions& mutable_options,
                              LogBuffer* log_buffer);
@@ -345,6 +355,7 @@ class ColumnFamilyData {
   MutableCFOptions mutable_cf_options_;
 
   std::unique_ptr<TableCache> table_cache_;
+  std::unique_ptr<BlobFileCache> blob_file_cache_;
 
   std::unique_ptr<InternalStats> internal_stats_;
 
@@ -11,7 +11,9 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include "db/compaction_iterator.h"
+#include "db/column_family.h"
 #include "table/internal_iterator.h"
+#include "util/stop_watch.h"
 
 namespace vidardb {
 
@@ -25,11 +27,17 @@ CompactionIterator::CompactionIterator(
       snapshots_(snapshots),
       earliest_write_conflict_snapshot_(earliest_write_conflict_snapshot),
       expect_valid_internal_key_(expect_valid_internal_key),
-      compaction_(compaction) {
+      compaction_(compaction),
+      compaction_filter_(nullptr),
+      env_(nullptr) {
   bottommost_level_ =
       compaction_ == nullptr ? false : compaction_->bottommost_level();
   if (compaction_ != nullptr) {
     level_ptrs_ = std::vector<size_t>(compaction_->number_levels(), 0);
+    const ImmutableCFOptions* ioptions =
+        compaction_->column_family_data()->ioptions();
+    compaction_filter_ = ioptions->compaction_filter;
+    env_ = ioptions->env;
   }
 
   if (snapshots_->size() == 0) {
@@ -120,6 +128,34 @@ void CompactionIterator::NextFromInput() {
       has_outputted_key_ = false;
       current_user_key_sequence_ = kMaxSequenceNumber;
       current_user_key_snapshot_ = 0;
+
+      // Apply the compaction filter to the first occurrence of the user key,
+      // unless a snapshot can still see it. Blob indexes are not filtered.
+      if (compaction_filter_ != nullptr && ikey_.type == kTypeValue &&
+          (visible_at_tip_ || ikey_.sequence > latest_snapshot_ ||
+           ignore_snapshots_)) {
+        bool value_changed = false;
+        bool to_delete = false;
+        compaction_filter_value_.clear();
+        {
+          StopWatchNano timer(env_, true);
+          to_delete = compaction_filter_->Filter(
+              compaction_->level(), ikey_.user_key, value_,
+              &compaction_filter_value_, &value_changed);
+          iter_stats_.total_filter_time += timer.ElapsedNanos();
+        }
+
+        if (to_delete) {
+          // convert the current key to a delete
+          ikey_.type = kTypeDeletion;
+          current_key_.UpdateInternalKey(ikey_.sequence, kTypeDeletion);
+          // no value associated with delete
+          value_.clear();
+          iter_stats_.num_record_drop_user++;
+        } else if (value_changed) {
+          value_ = compaction_filter_value_;
+        }
+      }
     } else {
       // Update the current key to reflect the new sequence number/type without
       // copying the user key.
@@ -147,9 +183,14 @@ void CompactionIterator::NextFromInput() {
       // In the previous iteration we encountered a single delete that we could
       // not compact out.  We will keep this Put, but can drop it's data.
       // (See Optimization 3, below.)
-      assert(ikey_.type == kTypeValue);
+      assert(ikey_.type == kTypeValue || ikey_.type == kTypeBlobIndex);
       assert(current_user_key_snapshot_ == last_snapshot);
 
+      if (ikey_.type == kTypeBlobIndex) {
+        // an empty value references no blob
+        ikey_.type = kTypeValue;
+        current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
+      }
       value_.clear();
       valid_ = true;
       clear_and_output_next_key_ = false;
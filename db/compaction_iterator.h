@@ -13,6 +13,7 @@
 
 #include "db/compaction.h"
 #include "util/log_buffer.h"
+#include "vidardb/compaction_filter.h"
 
 namespace vidardb {
 
@@ -87,6 +88,8 @@ class CompactionIterator {
   const SequenceNumber earliest_write_conflict_snapshot_;
   bool expect_valid_internal_key_;
   const Compaction* compaction_;
+  const CompactionFilter* compaction_filter_;
+  Env* env_;
   bool bottommost_level_;
   bool valid_ = false;
   SequenceNumber visible_at_tip_;
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <random>
 #include <set>
@@ -29,6 +30,7 @@
 #include <utility>
 #include <vector>
 
+#include "db/blob_file.h"
 #include "db/builder.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
@@ -90,6 +92,7 @@ struct CompactionJob::SubcompactionState {
   std::vector<Output> outputs;
   std::unique_ptr<WritableFileWriter> outfile;
   std::unique_ptr<TableBuilder> builder;
+  std::unique_ptr<BlobFileBuilder> blob_builder;
   Output* current_output() {
     if (outputs.empty()) {
       // This subcompaction's outptut could be empty if compaction was aborted
@@ -125,6 +128,7 @@ struct CompactionJob::SubcompactionState {
         end(_end),
         outfile(nullptr),
         builder(nullptr),
+        blob_builder(nullptr),
         total_bytes(0),
         num_input_records(0),
         num_output_records(0),
@@ -146,6 +150,7 @@ struct CompactionJob::SubcompactionState {
     outputs = std::move(o.outputs);
     outfile = std::move(o.outfile);
     builder = std::move(o.builder);
+    blob_builder = std::move(o.blob_builder);
     total_bytes = std::move(o.total_bytes);
     num_input_records = std::move(o.num_input_records);
     num_output_records = std::move(o.num_output_records);
@@ -386,6 +391,60 @@ void CompactionJob::Prepare() {
   }
 }
 
+void CompactionJob::PickBlobFilesToGC() {
+  auto* c = compact_->compaction;
+  auto* cfd = c->column_family_data();
+  const double garbage_ratio = cfd->ioptions()->blob_gc_garbage_ratio;
+  if (garbage_ratio >= 1.0) {
+    return;
+  }
+
+  std::map<uint64_t, uint64_t> live_bytes;
+  for (size_t i = 0; i < c->num_input_levels(); i++) {
+    for (const auto* f : *c->inputs(i)) {
+      for (const auto& ref : f->blob_refs) {
+        live_bytes[ref.first] = 0;
+      }
+    }
+  }
+  if (live_bytes.empty()) {
+    return;
+  }
+
+  // All the references to a blob file are in the same column family
+  const auto* vstorage = c->input_version()->storage_info();
+  for (int level = 0; level < vstorage->num_levels(); level++) {
+    for (const auto* f : vstorage->LevelFiles(level)) {
+      for (const auto& ref : f->blob_refs) {
+        auto it = live_bytes.find(ref.first);
+        if (it != live_bytes.end()) {
+          it->second += ref.second;
+        }
+      }
+    }
+  }
+
+  for (const auto& blob_file : live_bytes) {
+    uint64_t total_bytes = 0;
+    Status s = cfd->blob_file_cache()->GetBlobFileBytes(blob_file.first,
+                                                        &total_bytes);
+    if (!s.ok() || total_bytes == 0) {
+      continue;
+    }
+    double garbage =
+        1.0 - static_cast<double>(std::min(blob_file.second, total_bytes)) /
+                  total_bytes;
+    if (garbage > garbage_ratio) {
+      gc_blob_files_.insert(blob_file.first);
+    }
+  }
+  if (!gc_blob_files_.empty()) {
+    LogToBuffer(log_buffer_, "[%s] [JOB %d] Collecting %" VIDARDB_PRIszt
+                " blob files",
+                cfd->GetName().c_str(), job_id_, gc_blob_files_.size());
+  }
+}
+
 struct RangeWithSize {
   Range range;
   uint64_t size;
@@ -521,6 +580,8 @@ Status CompactionJob::Run() {
   assert(num_threads > 0);
   const uint64_t start_micros = env_->NowMicros();
 
+  PickBlobFilesToGC();
+
   // Launch a thread for each of subcompactions 1...num_threads-1
   std::vector<std::thread> thread_pool;
   thread_pool.reserve(num_threads - 1);
@@ -583,6 +644,8 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
   ColumnFamilyData* cfd = compact_->compaction->column_family_data();
   cfd->internal_stats()->AddCompactionStats(
       compact_->compaction->output_level(), compaction_stats_);
+  cfd->internal_stats()->AddCFStats(InternalStats::COMPACTION_MICROS,
+                                    compaction_stats_.micros);
 
   if (status.ok()) {
     status = InstallCompactionResults(mutable_cf_options);
@@ -764,15 +827,22 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     assert(sub_compact->builder != nullptr);
     assert(sub_compact->current_output() != nullptr);
 
-    sub_compact->builder->Add(key, value);
+    Slice output_key = key;
+    Slice output_value = value;
+    status = sub_compact->blob_builder->Add(c_iter->ikey(), &output_key,
+                                            &output_value);
+    if (!status.ok()) {
+      break;
+    }
+    sub_compact->builder->Add(output_key, output_value);
     sub_compact->current_output()->meta.UpdateBoundaries(
-        key, c_iter->ikey().sequence);
+        output_key, c_iter->ikey().sequence);
     sub_compact->num_output_records++;
 
     if (sub_compact->outputs.size() == 1) {  // first output file
       // Check if this key/value overlaps any sample intervals; if so, appends
       // overlapping portions to the dictionary.
-      for (const auto& data_elmt : {key, value}) {
+      for (const auto& data_elmt : {output_key, output_value}) {
         size_t data_end_offset = data_begin_offset + data_elmt.size();
         while (sample_begin_offset_iter != sample_begin_offsets.cend() &&
                *sample_begin_offset_iter < data_end_offset) {
@@ -929,9 +999,16 @@ Status CompactionJob::FinishCompactionOutputFile(
   } else {
     sub_compact->builder->Abandon();
   }
+  if (s.ok()) {
+    s = sub_compact->blob_builder->Finish(meta);
+  } else {
+    sub_compact->blob_builder->Abandon();
+  }
+  sub_compact->blob_builder.reset();
   const uint64_t current_bytes = sub_compact->builder->FileSizeTotal();  // Shichao
   meta->fd.file_size = sub_compact->builder->FileSize();  // Shichao
   meta->fd.file_size_total = current_bytes;  // Shichao
+  meta->sub_path_ids = sub_compact->builder->SubFilePathIds();
   sub_compact->current_output()->finished = true;
   sub_compact->total_bytes += current_bytes;
 
@@ -1117,7 +1194,12 @@ Status CompactionJob::OpenCompactionOutputFile(
       cfd->int_tbl_prop_collector_factories(), cfd->GetID(), cfd->GetName(),
       sub_compact->outfile.get(), sub_compact->compaction->output_compression(),
       cfd->ioptions()->compression_opts, env_options_,  // Shichao
-      &sub_compact->compression_dict));
+      &sub_compact->compression_dict,
+      static_cast<int>(sub_compact->compaction->output_path_id())));
+  sub_compact->blob_builder.reset(new BlobFileBuilder(
+      *cfd->ioptions(), env_options_, file_number,
+      sub_compact->compaction->output_path_id(), Env::IO_LOW,
+      cfd->blob_file_cache(), &gc_blob_files_));
 
   LogFlush(db_options_.info_log);
   return s;
@@ -1131,6 +1213,8 @@ void CompactionJob::CleanupCompaction() {
       // May happen if we get a shutdown call in the middle of compaction
       sub_compact.builder->Abandon();
       sub_compact.builder.reset();
+      sub_compact.blob_builder->Abandon();
+      sub_compact.blob_builder.reset();
     } else {
       assert(!sub_status.ok() || sub_compact.outfile == nullptr);
     }
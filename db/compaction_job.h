@@ -14,6 +14,7 @@
 #include <limits>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -83,6 +84,10 @@ class CompactionJob {
 
   void AggregateStatistics();
   void GenSubcompactionBoundaries();
+  // Pick the blob files, referenced by the input files, whose garbage ratio
+  // exceeds blob_gc_garbage_ratio, so that their live blobs are moved to the
+  // blob files of the outputs.
+  void PickBlobFilesToGC();
 
   // update the thread status for starting a compaction.
   void ReportStartedCompaction(Compaction* compaction);
@@ -152,6 +157,8 @@ class CompactionJob {
   std::vector<Slice> boundaries_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
+  // Blob files whose blobs are rewritten by this compaction
+  std::unordered_set<uint64_t> gc_blob_files_;
 };
 
 }  // namespace vidardb
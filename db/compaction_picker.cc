@@ -19,8 +19,10 @@
 #endif
 
 #include <inttypes.h>
+#include <algorithm>
 #include <limits>
 #include <queue>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -935,6 +937,36 @@ Compaction* LevelCompactionPicker::PickCompaction(
     // cause the 'smallest' and 'largest' key to get extended to a
     // larger range. So, re-invoke GetRange to get the new key range
     GetRange(inputs, &smallest, &largest);
+
+    // The files of a sorted run, e.g. the outputs of one flush split into
+    // subflushes, are compacted together, as would be the single file they
+    // stand for.
+    std::vector<int> runs;
+    vstorage->Level0SortedRuns(&runs);
+    const auto& level0_files = vstorage->LevelFiles(0);
+    while (true) {
+      std::set<int> picked_runs;
+      for (size_t i = 0; i < level0_files.size(); i++) {
+        if (std::find(inputs.files.begin(), inputs.files.end(),
+                      level0_files[i]) != inputs.files.end()) {
+          picked_runs.insert(runs[i]);
+        }
+      }
+      size_t old_size = inputs.files.size();
+      inputs.files.clear();
+      for (size_t i = 0; i < level0_files.size(); i++) {
+        if (picked_runs.count(runs[i]) > 0) {
+          inputs.files.push_back(level0_files[i]);
+        }
+      }
+      GetRange(inputs, &smallest, &largest);
+      inputs.files.clear();
+      vstorage->GetOverlappingInputs(0, &smallest, &largest, &inputs.files);
+      GetRange(inputs, &smallest, &largest);
+      if (inputs.files.size() == old_size) {
+        break;
+      }
+    }
     if (RangeInCompaction(vstorage, &smallest, &largest, output_level,
                           &parent_index)) {
       return nullptr;
@@ -118,21 +118,30 @@ Status DBImpl::GetLiveFiles(std::vector<std::string>& ret,
 
   // Make a set of all of the live *.sst files
   std::vector<FileDescriptor> live;
+  std::vector<uint64_t> blob_live;
   for (auto cfd : *versions_->GetColumnFamilySet()) {
     if (cfd->IsDropped()) {
       continue;
     }
     cfd->current()->AddLiveFiles(&live);
+    cfd->current()->AddLiveBlobFiles(&blob_live);
   }
+  std::sort(blob_live.begin(), blob_live.end());
+  blob_live.erase(std::unique(blob_live.begin(), blob_live.end()),
+                  blob_live.end());
 
   ret.clear();
-  ret.reserve(live.size() + 2); //*.sst + CURRENT + MANIFEST
+  // *.sst + *.blob + CURRENT + MANIFEST
+  ret.reserve(live.size() + blob_live.size() + 2);
 
   // create names of the live files. The names are not absolute
   // paths, instead they are relative to dbname_;
   for (auto live_file : live) {
     ret.push_back(MakeTableFileName("", live_file.GetNumber()));
   }
+  for (auto blob_file : blob_live) {
+    ret.push_back(MakeBlobFileName("", blob_file));
+  }
 
   ret.push_back(CurrentFileName(""));
   ret.push_back(DescriptorFileName("", versions_->manifest_file_number()));
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <climits>
 #include <cstdio>
+#include <cstring>
 #include <map>
 #include <set>
 #include <stdexcept>
@@ -42,6 +43,7 @@
 
 #include "db/auto_roll_logger.h"
 #include "db/builder.h"
+#include "db/change_stream.h"
 #include "db/compaction_job.h"
 #include "db/db_info_dumper.h"
 #include "db/db_iter.h"
@@ -53,6 +55,9 @@
 #include "db/job_context.h"
 #include "db/log_reader.h"
 #include "db/log_writer.h"
+#include "db/pre_release_callback.h"
+#include "db/range_sampler.h"
+#include "db/read_callback.h"
 #include "memtable/memtable.h"
 #include "memtable/memtable_list.h"
 #include "db/table_cache.h"
@@ -73,6 +78,7 @@
 #include "vidardb/version.h"
 #include "table/block.h"
 #include "table/block_based_table_factory.h"
+#include "table/format.h"
 #include "table/merger.h"
 #include "table/table_builder.h"
 #include "table/two_level_iterator.h"
@@ -95,6 +101,7 @@
 #include "util/sync_point.h"
 #include "util/thread_status_updater.h"
 #include "util/thread_status_util.h"
+#include "util/threadpool.h"
 #include "vidardb/utilities/json.hpp"  // Shichao
 
 namespace vidardb {
@@ -238,6 +245,10 @@ static Status ValidateOptions(
         "then os caching (allow_os_buffer) must also be enabled. ");
   }
 
+  if (!IsSupportedChecksum(db_options.wal_checksum)) {
+    return Status::InvalidArgument("Unsupported wal_checksum type.");
+  }
+
   return Status::OK();
 }
 
@@ -298,6 +309,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
       unscheduled_flushes_(0),
       unscheduled_compactions_(0),
       bg_compaction_scheduled_(0),
+      bg_bottom_compaction_scheduled_(0),
       num_running_compactions_(0),
       bg_flush_scheduled_(0),
       num_running_flushes_(0),
@@ -332,6 +344,11 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
   column_family_memtables_.reset(
       new ColumnFamilyMemTablesImpl(versions_->GetColumnFamilySet()));
 
+  // Its threads start on the first read scheduled
+  read_pool_.reset(new ThreadPool());
+  read_pool_->SetHostEnv(env_);
+  read_pool_->SetBackgroundThreads(std::max(db_options_.async_read_threads, 1));
+
   DumpVidarDBBuildVersion(db_options_.info_log.get());
   DumpDBFileSummary(db_options_, dbname_);
   db_options_.Dump(db_options_.info_log.get());
@@ -347,12 +364,17 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
     return;
   }
   // Wait for background work to finish
-  while (bg_compaction_scheduled_ || bg_flush_scheduled_) {
+  while (bg_compaction_scheduled_ || bg_bottom_compaction_scheduled_ ||
+         bg_flush_scheduled_) {
     bg_cv_.Wait();
   }
 }
 
 DBImpl::~DBImpl() {
+  // The async reads still queued fail, the running ones are waited for
+  read_pool_->UnSchedule(this);
+  read_pool_->JoinAllThreads();
+
   mutex_.Lock();
 
   if (!shutting_down_.load(std::memory_order_acquire) &&
@@ -373,14 +395,23 @@ DBImpl::~DBImpl() {
   // marker. After this we do a variant of the waiting and unschedule work
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
   CancelAllBackgroundWork(false);
+  int bottom_compactions_unscheduled =
+      env_->UnSchedule(this, Env::Priority::BOTTOM);
   int compactions_unscheduled = env_->UnSchedule(this, Env::Priority::LOW);
   int flushes_unscheduled = env_->UnSchedule(this, Env::Priority::HIGH);
   mutex_.Lock();
+  bg_bottom_compaction_scheduled_ -= bottom_compactions_unscheduled;
   bg_compaction_scheduled_ -= compactions_unscheduled;
   bg_flush_scheduled_ -= flushes_unscheduled;
+  for (auto c : unscheduled_bottom_compactions_) {
+    c->ReleaseCompactionFiles(Status::ShutdownInProgress());
+    delete c;
+  }
+  unscheduled_bottom_compactions_.clear();
 
   // Wait for background work to finish
-  while (bg_compaction_scheduled_ || bg_flush_scheduled_) {
+  while (bg_compaction_scheduled_ || bg_bottom_compaction_scheduled_ ||
+         bg_flush_scheduled_) {
     bg_cv_.Wait();
   }
 
@@ -772,6 +803,7 @@ void DBImpl::FindObsoleteFiles(JobContext* job_context, bool force,
   job_context->prev_log_number = versions_->prev_log_number();
 
   versions_->AddLiveFiles(&job_context->sst_live);
+  versions_->AddLiveBlobFiles(&job_context->blob_live);
   if (doing_the_full_scan) {
     for (size_t path_id = 0; path_id < db_options_.db_paths.size(); path_id++) {
       // set of all files in the directory. We'll exclude files that are still
@@ -877,6 +909,8 @@ void DBImpl::PurgeObsoleteFiles(const JobContext& state) {
   for (const FileDescriptor& fd : state.sst_live) {
     sst_live_map[fd.GetNumber()] = &fd;
   }
+  std::unordered_set<uint64_t> blob_live_set(state.blob_live.begin(),
+                                             state.blob_live.end());
 
   auto candidate_files = state.full_scan_candidate_files;
   candidate_files.reserve(
@@ -888,6 +922,19 @@ void DBImpl::PurgeObsoleteFiles(const JobContext& state) {
     candidate_files.emplace_back(
         MakeTableFileName(kDumbDbName, file->fd.GetNumber()),
         file->fd.GetPathId());
+    // Sub files with unknown placement are left to the full scan.
+    for (size_t i = 0; i < file->sub_path_ids.size(); i++) {
+      candidate_files.emplace_back(
+          TableSubFileName(
+              MakeTableFileName(kDumbDbName, file->fd.GetNumber()),
+              static_cast<uint32_t>(i + 1)),
+          file->sub_path_ids[i]);
+    }
+    for (const auto& ref : file->blob_refs) {
+      candidate_files.emplace_back(
+          MakeBlobFileName(kDumbDbName, ref.first),
+          FindBlobFilePathId(env_, db_options_.db_paths, ref.first));
+    }
     delete file;
   }
 
@@ -939,6 +986,10 @@ void DBImpl::PurgeObsoleteFiles(const JobContext& state) {
         keep = (sst_live_map.find(number) != sst_live_map.end()) ||
                number >= state.min_pending_output;
         break;
+      case kBlobFile:
+        keep = (blob_live_set.find(number) != blob_live_set.end()) ||
+               number >= state.min_pending_output;
+        break;
       case kTempFile:
         // Any temp files that are currently being written to must
         // be recorded in pending_outputs_, which is inserted into "live".
@@ -981,6 +1032,9 @@ void DBImpl::PurgeObsoleteFiles(const JobContext& state) {
       fname = TableFileName(db_options_.db_paths, number, path_id);
       fname.append(to_delete.substr(to_delete.find_last_of('_')));
     /************************** Shichao **************************/
+    } else if (type == kBlobFile) {
+      BlobFileCache::Evict(table_cache_.get(), number);
+      fname = BlobFileName(db_options_.db_paths, number, path_id);
     } else {
       fname = ((type == kLogFile) ?
           db_options_.wal_dir : dbname_) + "/" + to_delete;
@@ -1386,7 +1440,10 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       }
       WriteBatchInternal::SetContents(&batch, record);
 
-      if (*next_sequence == kMaxSequenceNumber) {
+      if (*next_sequence == kMaxSequenceNumber ||
+          WriteBatchInternal::Sequence(&batch) > *next_sequence) {
+        // the sequence numbers skipped were used outside of the WAL, or
+        // reserved by the pre-release callbacks of the write
         *next_sequence = WriteBatchInternal::Sequence(&batch);
       }
       WriteBatchInternal::SetSequence(&batch, *next_sequence);
@@ -1581,7 +1638,8 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
     edit->AddFile(level, meta.fd.GetNumber(), meta.fd.GetPathId(),
                   meta.fd.GetFileSize(), meta.smallest, meta.largest,
                   meta.smallest_seqno, meta.largest_seqno,
-                  meta.marked_for_compaction, meta.fd.GetFileSizeTotal());  // Shichao
+                  meta.marked_for_compaction, meta.fd.GetFileSizeTotal(),  // Shichao
+                  meta.sub_path_ids, meta.blob_refs);
   }
 
   InternalStats::CompactionStats stats(1);
@@ -1642,22 +1700,158 @@ Status DBImpl::FlushMemTableToOutputFile(
     bg_error_ = s;
   }
   if (s.ok()) {
+    // the file of the first subflush, then the ones of the others
+    std::vector<FlushJob::SubflushOutput> outputs(1);
+    outputs[0].meta = file_meta;
+    outputs[0].table_properties = flush_job.GetTableProperties();
+    outputs.insert(outputs.end(), flush_job.GetSubflushOutputs().begin(),
+                   flush_job.GetSubflushOutputs().end());
+    auto sfm =
+        static_cast<SstFileManagerImpl*>(db_options_.sst_file_manager.get());
+    for (auto& output : outputs) {
 #ifndef VIDARDB_LITE
-    // may temporarily unlock and lock the mutex.
-    NotifyOnFlushCompleted(cfd, &file_meta, mutable_cf_options,
-                           job_context->job_id, flush_job.GetTableProperties());
+      // may temporarily unlock and lock the mutex.
+      NotifyOnFlushCompleted(cfd, &output.meta, mutable_cf_options,
+                             job_context->job_id, output.table_properties);
 #endif  // VIDARDB_LITE
+      if (sfm) {
+        // Notify sst_file_manager that a new file was added
+        std::string file_path = MakeTableFileName(
+            db_options_.db_paths[0].path, output.meta.fd.GetNumber());
+        sfm->OnAddFile(file_path);
+        if (sfm->IsMaxAllowedSpaceReached() && bg_error_.ok()) {
+          bg_error_ = Status::IOError("Max allowed space was reached");
+          TEST_SYNC_POINT(
+              "DBImpl::FlushMemTableToOutputFile:MaxAllowedSpaceReached");
+        }
+      }
+    }
+  }
+  return s;
+}
+
+Status DBImpl::AtomicFlushMemTablesToOutputFiles(
+    const std::vector<ColumnFamilyData*>& cfds, bool* made_progress,
+    JobContext* job_context, LogBuffer* log_buffer) {
+  mutex_.AssertHeld();
+
+  SequenceNumber earliest_write_conflict_snapshot;
+  std::vector<SequenceNumber> snapshot_seqs =
+      snapshots_.GetAll(&earliest_write_conflict_snapshot);
+
+  // FlushJob keeps a reference to its options
+  std::vector<MutableCFOptions> mutable_cf_options;
+  mutable_cf_options.reserve(cfds.size());
+  std::vector<std::unique_ptr<FlushJob>> jobs;
+  for (auto cfd : cfds) {
+    mutable_cf_options.push_back(*cfd->GetLatestMutableCFOptions());
+    const MutableCFOptions& cf_options = mutable_cf_options.back();
+    jobs.emplace_back(new FlushJob(
+        dbname_, cfd, db_options_, cf_options, env_options_, versions_.get(),
+        &mutex_, &shutting_down_, snapshot_seqs,
+        earliest_write_conflict_snapshot, job_context, log_buffer,
+        directories_.GetDbDir(), directories_.GetDataDir(0U),
+        GetCompressionFlush(*cfd->ioptions(), cf_options), stats_,
+        &event_logger_, cf_options.report_bg_io_stats,
+        false /* write_manifest */));
+  }
+
+  // Pick the memtables of every column family before any of them is written,
+  // as writing releases the mutex and new memtables may become immutable.
+  for (auto& job : jobs) {
+    job->PickMemTable();
+  }
+
+  Status s;
+  size_t num_run = 0;
+  for (; num_run < jobs.size(); num_run++) {
+    // This will release and re-acquire the mutex. On failure the job rolls
+    // back its own memtables.
+    s = jobs[num_run]->Run();
+    if (!s.ok()) {
+      break;
+    }
+  }
+
+  std::vector<ColumnFamilyData*> flushed_cfds;
+  std::vector<const MutableCFOptions*> flushed_cf_options;
+  std::vector<const std::vector<MemTable*>*> flushed_mems;
+  std::vector<uint64_t> file_numbers;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    if (i > num_run) {
+      jobs[i]->Cancel();
+    } else if (i < num_run && !jobs[i]->GetMemTables().empty()) {
+      if (s.ok()) {
+        flushed_cfds.push_back(cfds[i]);
+        flushed_cf_options.push_back(&mutable_cf_options[i]);
+        flushed_mems.push_back(&jobs[i]->GetMemTables());
+        file_numbers.push_back(jobs[i]->GetFileMetaData().fd.GetNumber());
+      } else {
+        // the group is not committed, so neither is this column family
+        cfds[i]->imm()->RollbackMemtableFlush(jobs[i]->GetMemTables(), 0);
+      }
+    }
+  }
+
+  if (s.ok() && !flushed_cfds.empty()) {
+    TEST_SYNC_POINT("DBImpl::AtomicFlushMemTablesToOutputFiles:Install");
+    s = MemTableList::InstallMemtableAtomicFlushResults(
+        flushed_cfds, flushed_cf_options, flushed_mems, versions_.get(),
+        &mutex_, file_numbers, &job_context->memtables_to_free,
+        directories_.GetDbDir(), log_buffer);
+  }
+
+  if (s.ok()) {
+    for (size_t i = 0; i < jobs.size(); i++) {
+      if (jobs[i]->GetMemTables().empty()) {
+        continue;
+      }
+      ColumnFamilyData* cfd = cfds[i];
+      InstallSuperVersionAndScheduleWorkWrapper(cfd, job_context,
+                                                mutable_cf_options[i]);
+      if (made_progress) {
+        *made_progress = 1;
+      }
+      VersionStorageInfo::LevelSummaryStorage tmp;
+      LogToBuffer(log_buffer, "[%s] Level summary: %s\n",
+                  cfd->GetName().c_str(),
+                  cfd->current()->storage_info()->LevelSummary(&tmp));
+    }
+  }
+
+  if (!s.ok() && !s.IsShutdownInProgress() && db_options_.paranoid_checks &&
+      bg_error_.ok()) {
+    // if a bad error happened (not ShutdownInProgress) and paranoid_checks is
+    // true, mark DB read-only
+    bg_error_ = s;
+  }
+  if (s.ok()) {
     auto sfm =
         static_cast<SstFileManagerImpl*>(db_options_.sst_file_manager.get());
-    if (sfm) {
-      // Notify sst_file_manager that a new file was added
-      std::string file_path = MakeTableFileName(db_options_.db_paths[0].path,
-                                                file_meta.fd.GetNumber());
-      sfm->OnAddFile(file_path);
-      if (sfm->IsMaxAllowedSpaceReached() && bg_error_.ok()) {
-        bg_error_ = Status::IOError("Max allowed space was reached");
-        TEST_SYNC_POINT(
-            "DBImpl::FlushMemTableToOutputFile:MaxAllowedSpaceReached");
+    for (size_t i = 0; i < jobs.size(); i++) {
+      if (jobs[i]->GetMemTables().empty()) {
+        continue;
+      }
+      std::vector<FlushJob::SubflushOutput> outputs(1);
+      outputs[0].meta = jobs[i]->GetFileMetaData();
+      outputs[0].table_properties = jobs[i]->GetTableProperties();
+      outputs.insert(outputs.end(), jobs[i]->GetSubflushOutputs().begin(),
+                     jobs[i]->GetSubflushOutputs().end());
+      for (auto& output : outputs) {
+#ifndef VIDARDB_LITE
+        // may temporarily unlock and lock the mutex.
+        NotifyOnFlushCompleted(cfds[i], &output.meta, mutable_cf_options[i],
+                               job_context->job_id, output.table_properties);
+#endif  // VIDARDB_LITE
+        if (sfm) {
+          // Notify sst_file_manager that a new file was added
+          std::string file_path = MakeTableFileName(
+              db_options_.db_paths[0].path, output.meta.fd.GetNumber());
+          sfm->OnAddFile(file_path);
+          if (sfm->IsMaxAllowedSpaceReached() && bg_error_.ok()) {
+            bg_error_ = Status::IOError("Max allowed space was reached");
+          }
+        }
       }
     }
   }
@@ -1994,7 +2188,8 @@ Status DBImpl::CompactFilesImpl(
 Status DBImpl::PauseBackgroundWork() {
   InstrumentedMutexLock guard_lock(&mutex_);
   bg_compaction_paused_++;
-  while (bg_compaction_scheduled_ > 0 || bg_flush_scheduled_ > 0) {
+  while (bg_compaction_scheduled_ > 0 || bg_bottom_compaction_scheduled_ > 0 ||
+         bg_flush_scheduled_ > 0) {
     bg_cv_.Wait();
   }
   bg_work_paused_++;
@@ -2214,7 +2409,8 @@ Status DBImpl::ReFitLevel(ColumnFamilyData* cfd, int level, int target_level) {
       edit.AddFile(to_level, f->fd.GetNumber(), f->fd.GetPathId(),
                    f->fd.GetFileSize(), f->smallest, f->largest,
                    f->smallest_seqno, f->largest_seqno,
-                   f->marked_for_compaction, f->fd.GetFileSizeTotal());  // Shichao
+                   f->marked_for_compaction, f->fd.GetFileSizeTotal(),  // Shichao
+                   f->sub_path_ids, f->blob_refs);
     }
     Log(InfoLogLevel::DEBUG_LEVEL, db_options_.info_log,
         "[%s] Apply version edit:\n%s", cfd->GetName().c_str(),
@@ -2403,7 +2599,8 @@ Status DBImpl::RunManualCompaction(ColumnFamilyData* cfd, int input_level,
   AddManualCompaction(&manual);
   TEST_SYNC_POINT_CALLBACK("DBImpl::RunManualCompaction:NotScheduled", &mutex_);
   if (exclusive) {
-    while (bg_compaction_scheduled_ > 0) {
+    while (bg_compaction_scheduled_ > 0 ||
+           bg_bottom_compaction_scheduled_ > 0) {
       Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
           "[%s] Manual compaction waiting for all other scheduled background "
           "compactions to finish",
@@ -2450,6 +2647,7 @@ Status DBImpl::RunManualCompaction(ColumnFamilyData* cfd, int input_level,
       ca = new CompactionArg;
       ca->db = this;
       ca->m = &manual;
+      ca->prepicked_compaction = nullptr;
       manual.incomplete = false;
       bg_compaction_scheduled_++;
       env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
@@ -2484,6 +2682,10 @@ InternalIterator* DBImpl::NewInternalIterator(
 
 Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
                              const FlushOptions& flush_options) {
+  if (db_options_.atomic_flush) {
+    return AtomicFlushMemTables(flush_options);
+  }
+
   Status s;
   {
     WriteContext context;
@@ -2516,6 +2718,45 @@ Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
   return s;
 }
 
+Status DBImpl::AtomicFlushMemTables(const FlushOptions& flush_options) {
+  Status s;
+  std::vector<ColumnFamilyData*> cfds;
+  {
+    WriteContext context;
+    InstrumentedMutexLock guard_lock(&mutex_);
+
+    WriteThread::Writer w;
+    write_thread_.EnterUnbatched(&w, &mutex_);
+
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->IsDropped() &&
+          (cfd->imm()->NumNotFlushed() != 0 || !cfd->mem()->IsEmpty())) {
+        cfd->Ref();
+        cfds.push_back(cfd);
+      }
+    }
+    // SwitchMemtable() will release and reacquire mutex
+    // during execution
+    s = SwitchMemtablesForAtomicFlush(&context);
+    write_thread_.ExitUnbatched(&w);
+  }
+
+  for (auto cfd : cfds) {
+    if (s.ok() && flush_options.wait) {
+      // Wait until the flush completes
+      s = WaitForFlushMemTable(cfd);
+    }
+  }
+
+  InstrumentedMutexLock guard_lock(&mutex_);
+  for (auto cfd : cfds) {
+    if (cfd->Unref()) {
+      delete cfd;
+    }
+  }
+  return s;
+}
+
 Status DBImpl::WaitForFlushMemTable(ColumnFamilyData* cfd) {
   Status s;
   // Wait until the compaction completes
@@ -2636,8 +2877,13 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     return;
   }
 
+  // An atomic flush picks up every queued column family, so one at a time
+  const int max_flushes_scheduled =
+      db_options_.atomic_flush
+          ? std::min(db_options_.max_background_flushes, 1)
+          : db_options_.max_background_flushes;
   while (unscheduled_flushes_ > 0 &&
-         bg_flush_scheduled_ < db_options_.max_background_flushes) {
+         bg_flush_scheduled_ < max_flushes_scheduled) {
     unscheduled_flushes_--;
     bg_flush_scheduled_++;
     env_->Schedule(&DBImpl::BGWorkFlush, this, Env::Priority::HIGH, this);
@@ -2650,7 +2896,8 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
   if (db_options_.max_background_flushes == 0) {
     while (unscheduled_flushes_ > 0 &&
            bg_flush_scheduled_ + bg_compaction_scheduled_ <
-               bg_compactions_allowed) {
+               bg_compactions_allowed &&
+           (!db_options_.atomic_flush || bg_flush_scheduled_ == 0)) {
       unscheduled_flushes_--;
       bg_flush_scheduled_++;
       env_->Schedule(&DBImpl::BGWorkFlush, this, Env::Priority::LOW, this);
@@ -2673,6 +2920,7 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     CompactionArg* ca = new CompactionArg;
     ca->db = this;
     ca->m = nullptr;
+    ca->prepicked_compaction = nullptr;
     bg_compaction_scheduled_++;
     unscheduled_compactions_--;
     env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
@@ -2704,6 +2952,35 @@ ColumnFamilyData* DBImpl::PopFirstFromCompactionQueue() {
   return cfd;
 }
 
+ColumnFamilyData* DBImpl::PopMostUrgentFromCompactionQueue() {
+  assert(!compaction_queue_.empty());
+  auto best = compaction_queue_.begin();
+  bool best_urgent = false;
+  double best_urgency = 0;
+  for (auto it = compaction_queue_.begin(); it != compaction_queue_.end();
+       ++it) {
+    ColumnFamilyData* cfd = *it;
+    if (cfd->IsDropped()) {
+      // Nothing to compact, it is only released
+      best = it;
+      break;
+    }
+    bool urgent = cfd->IsCompactionUrgent();
+    double urgency = cfd->CompactionUrgency();
+    if (it == compaction_queue_.begin() || (urgent && !best_urgent) ||
+        (urgent == best_urgent && urgency > best_urgency)) {
+      best = it;
+      best_urgent = urgent;
+      best_urgency = urgency;
+    }
+  }
+  auto cfd = *best;
+  compaction_queue_.erase(best);
+  assert(cfd->pending_compaction());
+  cfd->set_pending_compaction(false);
+  return cfd;
+}
+
 void DBImpl::AddToFlushQueue(ColumnFamilyData* cfd) {
   assert(!cfd->pending_flush());
   cfd->Ref();
@@ -2749,12 +3026,47 @@ void DBImpl::BGWorkCompaction(void* arg) {
   reinterpret_cast<DBImpl*>(ca.db)->BackgroundCallCompaction(ca.m);
 }
 
+void DBImpl::BGWorkBottomCompaction(void* arg) {
+  CompactionArg ca = *(reinterpret_cast<CompactionArg*>(arg));
+  delete reinterpret_cast<CompactionArg*>(arg);
+  IOSTATS_SET_THREAD_POOL_ID(Env::Priority::BOTTOM);
+  TEST_SYNC_POINT("DBImpl::BGWorkBottomCompaction");
+  assert(ca.prepicked_compaction != nullptr);
+  ca.db->BackgroundCallCompaction(nullptr, ca.prepicked_compaction);
+}
+
+void DBImpl::ScheduleAsyncRead(std::function<void()>&& run,
+                               std::function<void()>&& cancel) {
+  AsyncReadArg* arg = new AsyncReadArg;
+  arg->run = std::move(run);
+  arg->cancel = std::move(cancel);
+  read_pool_->Schedule(&DBImpl::BGWorkAsyncRead, arg, this,
+                       &DBImpl::UnscheduleAsyncReadCallback);
+}
+
+void DBImpl::BGWorkAsyncRead(void* arg) {
+  AsyncReadArg* ra = reinterpret_cast<AsyncReadArg*>(arg);
+  ra->run();
+  delete ra;
+}
+
+void DBImpl::UnscheduleAsyncReadCallback(void* arg) {
+  AsyncReadArg* ra = reinterpret_cast<AsyncReadArg*>(arg);
+  ra->cancel();
+  delete ra;
+}
+
 void DBImpl::UnscheduleCallback(void* arg) {
   CompactionArg ca = *(reinterpret_cast<CompactionArg*>(arg));
   delete reinterpret_cast<CompactionArg*>(arg);
   if ((ca.m != nullptr) && (ca.m->compaction != nullptr)) {
     delete ca.m->compaction;
   }
+  if (ca.prepicked_compaction != nullptr) {
+    // Called under the mutex of the pool, which the threads scheduling work
+    // take under mutex_, so the files are released later by the destructor
+    ca.db->unscheduled_bottom_compactions_.push_back(ca.prepicked_compaction);
+  }
   TEST_SYNC_POINT("DBImpl::UnscheduleCallback");
 }
 
@@ -2771,6 +3083,43 @@ Status DBImpl::BackgroundFlush(bool* made_progress, JobContext* job_context,
     return status;
   }
 
+  if (db_options_.atomic_flush) {
+    std::vector<ColumnFamilyData*> cfds;
+    bool first = true;
+    while (!flush_queue_.empty()) {
+      // This cfd is already referenced
+      auto cfd = PopFirstFromFlushQueue();
+      if (first) {
+        first = false;
+      } else if (unscheduled_flushes_ > 0) {
+        // picked up by this flush instead of a separately scheduled one
+        unscheduled_flushes_--;
+      }
+      if (cfd->IsDropped() || !cfd->imm()->IsFlushPending()) {
+        if (cfd->Unref()) {
+          delete cfd;
+        }
+        continue;
+      }
+      cfds.push_back(cfd);
+    }
+    if (!cfds.empty()) {
+      LogToBuffer(
+          log_buffer,
+          "Calling AtomicFlushMemTablesToOutputFiles with %" VIDARDB_PRIszt
+          " column families, flush slots available %d",
+          cfds.size(), db_options_.max_background_flushes);
+      status = AtomicFlushMemTablesToOutputFiles(cfds, made_progress,
+                                                 job_context, log_buffer);
+      for (auto cfd : cfds) {
+        if (cfd->Unref()) {
+          delete cfd;
+        }
+      }
+    }
+    return status;
+  }
+
   ColumnFamilyData* cfd = nullptr;
   while (!flush_queue_.empty()) {
     // This cfd is already referenced
@@ -2875,7 +3224,8 @@ void DBImpl::BackgroundCallFlush() {
   }
 }
 
-void DBImpl::BackgroundCallCompaction(void* arg) {
+void DBImpl::BackgroundCallCompaction(void* arg,
+                                      Compaction* prepicked_compaction) {
   bool made_progress = false;
   ManualCompaction* m = reinterpret_cast<ManualCompaction*>(arg);
   JobContext job_context(next_job_id_.fetch_add(1), true);
@@ -2889,9 +3239,10 @@ void DBImpl::BackgroundCallCompaction(void* arg) {
     auto pending_outputs_inserted_elem =
         CaptureCurrentFileNumberInPendingOutputs();
 
-    assert(bg_compaction_scheduled_);
-    Status s =
-        BackgroundCompaction(&made_progress, &job_context, &log_buffer, m);
+    assert(prepicked_compaction != nullptr ? bg_bottom_compaction_scheduled_
+                                           : bg_compaction_scheduled_);
+    Status s = BackgroundCompaction(&made_progress, &job_context, &log_buffer,
+                                    m, prepicked_compaction);
     TEST_SYNC_POINT("BackgroundCallCompaction:1");
     if (!s.ok() && !s.IsShutdownInProgress()) {
       // Wait a little bit before retrying background compaction in
@@ -2937,13 +3288,19 @@ void DBImpl::BackgroundCallCompaction(void* arg) {
 
     assert(num_running_compactions_ > 0);
     num_running_compactions_--;
-    bg_compaction_scheduled_--;
+    if (prepicked_compaction != nullptr) {
+      bg_bottom_compaction_scheduled_--;
+    } else {
+      bg_compaction_scheduled_--;
+    }
 
     versions_->GetColumnFamilySet()->FreeDeadColumnFamilies();
 
     // See if there's more work to be done
     MaybeScheduleFlushOrCompaction();
-    if (made_progress || bg_compaction_scheduled_ == 0 ||
+    if (made_progress ||
+        (bg_compaction_scheduled_ == 0 &&
+         bg_bottom_compaction_scheduled_ == 0) ||
         HasPendingManualCompaction()) {
       // signal if
       // * made_progress -- need to wakeup DelayWrite
@@ -2962,7 +3319,8 @@ void DBImpl::BackgroundCallCompaction(void* arg) {
 
 Status DBImpl::BackgroundCompaction(bool* made_progress,
                                     JobContext* job_context,
-                                    LogBuffer* log_buffer, void* arg) {
+                                    LogBuffer* log_buffer, void* arg,
+                                    Compaction* prepicked_compaction) {
   ManualCompaction* manual_compaction =
       reinterpret_cast<ManualCompaction*>(arg);
   *made_progress = false;
@@ -2988,6 +3346,10 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
       delete manual_compaction->compaction;
       manual_compaction = nullptr;
     }
+    if (prepicked_compaction != nullptr) {
+      prepicked_compaction->ReleaseCompactionFiles(status);
+      delete prepicked_compaction;
+    }
     return status;
   }
 
@@ -2999,7 +3361,9 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
   unique_ptr<Compaction> c;
   // InternalKey manual_end_storage;
   // InternalKey* manual_end = &manual_end_storage;
-  if (is_manual) {
+  if (prepicked_compaction != nullptr) {
+    c.reset(prepicked_compaction);
+  } else if (is_manual) {
     ManualCompaction* m = manual_compaction;
     assert(m->in_progress);
     c.reset(std::move(m->compaction));
@@ -3025,7 +3389,7 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     }
   } else if (!compaction_queue_.empty()) {
     // cfd is referenced here
-    auto cfd = PopFirstFromCompactionQueue();
+    auto cfd = PopMostUrgentFromCompactionQueue();
     // We unreference here because the following code will take a Ref() on
     // this cfd if it is going to use it (Compaction class holds a
     // reference).
@@ -3079,6 +3443,22 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
         }
       }
     }
+
+    if (c != nullptr && c->bottommost_level() && !c->deletion_compaction() &&
+        !c->IsTrivialMove() &&
+        env_->GetBackgroundThreads(Env::Priority::BOTTOM) > 0) {
+      // A bottommost-level compaction is the longest one, so it runs in the
+      // BOTTOM pool, and this LOW thread is left to the upper levels
+      CompactionArg* ca = new CompactionArg;
+      ca->db = this;
+      ca->m = nullptr;
+      ca->prepicked_compaction = c.release();
+      bg_bottom_compaction_scheduled_++;
+      env_->Schedule(&DBImpl::BGWorkBottomCompaction, ca,
+                     Env::Priority::BOTTOM, this,
+                     &DBImpl::UnscheduleCallback);
+      return Status::OK();
+    }
   }
 
   if (!c) {
@@ -3130,7 +3510,8 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
         c->edit()->AddFile(c->output_level(), f->fd.GetNumber(), f->fd.GetPathId(),
                            f->fd.GetFileSize(), f->smallest, f->largest,
                            f->smallest_seqno, f->largest_seqno,
-                           f->marked_for_compaction, f->fd.GetFileSizeTotal());  // Shichao
+                           f->marked_for_compaction, f->fd.GetFileSizeTotal(),  // Shichao
+                           f->sub_path_ids, f->blob_refs);
 
         LogToBuffer(log_buffer,
                     "[%s] Moving #%" PRIu64 " to level-%d %" PRIu64 " bytes\n",
@@ -3284,7 +3665,8 @@ void DBImpl::RemoveManualCompaction(DBImpl::ManualCompaction* m) {
 
 bool DBImpl::ShouldntRunManualCompaction(ManualCompaction* m) {
   if (m->exclusive) {
-    return (bg_compaction_scheduled_ > 0);
+    return (bg_compaction_scheduled_ > 0 ||
+            bg_bottom_compaction_scheduled_ > 0);
   }
   std::deque<ManualCompaction*>::iterator it =
       manual_compaction_dequeue_.begin();
@@ -3412,6 +3794,63 @@ Status DBImpl::Get(ReadOptions& read_options, ColumnFamilyHandle* column_family,
   return GetImpl(read_options, column_family, key, value);
 }
 
+Status DBImpl::GetColumns(const ReadOptions& read_options,
+                          ColumnFamilyHandle* column_family, const Slice& key,
+                          const std::vector<uint32_t>& columns,
+                          std::vector<std::string>* values) {
+  auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
+  const ImmutableCFOptions* ioptions = cfh->cfd()->ioptions();
+  const Splitter* splitter = ioptions->splitter;
+  if (splitter == nullptr) {
+    return Status::InvalidArgument("GetColumns needs a splitter.");
+  }
+  // The column tables read only the requested columns, which are checked
+  // against their column count. The other values are read whole, and their
+  // columns checked once split.
+  uint32_t column_count = 0;
+  TableFactory* table_factory = ioptions->table_factory;
+  if (strcmp(table_factory->Name(), "ColumnTable") == 0) {
+    column_count = static_cast<ColumnTableOptions*>(
+        table_factory->GetOptions())->column_count;
+  }
+  for (auto column : columns) {
+    // only the value columns
+    if (column < 1 || (column_count > 0 && column > column_count)) {
+      return Status::InvalidArgument("GetColumns column out of range.");
+    }
+  }
+
+  ReadOptions ro(read_options);
+  if (column_count > 0) {
+    ro.columns = columns;
+  }
+  std::string value;
+  Status s = GetImpl(ro, column_family, key, &value);
+  values->clear();
+  if (!s.ok()) {
+    return s;
+  }
+  std::vector<Slice> split(splitter->Split(value));
+  if (column_count > 0 || columns.empty()) {
+    for (const auto& column : split) {
+      values->emplace_back(column.data(), column.size());
+    }
+    if (!columns.empty()) {
+      // a trailing empty column may not survive the stitching
+      values->resize(columns.size());
+    }
+    return s;
+  }
+  for (auto column : columns) {
+    if (column > split.size()) {
+      values->clear();
+      return Status::InvalidArgument("GetColumns column out of range.");
+    }
+    values->emplace_back(split[column - 1].data(), split[column - 1].size());
+  }
+  return s;
+}
+
 // JobContext gets created and destructed outside of the lock --
 // we
 // use this convinently to:
@@ -3466,7 +3905,8 @@ SuperVersion* DBImpl::InstallSuperVersionAndScheduleWork(
 
 Status DBImpl::GetImpl(ReadOptions& read_options,
                        ColumnFamilyHandle* column_family, const Slice& key,
-                       std::string* value, bool* value_found) {
+                       std::string* value, bool* value_found,
+                       ReadCallback* callback) {
   StopWatch sw(env_, stats_, DB_GET);
   PERF_TIMER_GUARD(get_snapshot_time);
 
@@ -3494,17 +3934,19 @@ Status DBImpl::GetImpl(ReadOptions& read_options,
       (read_options.read_tier == kPersistedTier && has_unpersisted_data_);
   bool done = false;
   if (!skip_memtable) {
-    if (sv->mem->Get(read_options, lkey, value, &s)) {
+    SequenceNumber seq;
+    if (sv->mem->Get(read_options, lkey, value, &s, &seq, callback)) {
       done = true;
       RecordTick(stats_, MEMTABLE_HIT);
-    } else if (sv->imm->Get(read_options, lkey, value, &s)) {
+    } else if (sv->imm->Get(read_options, lkey, value, &s, &seq, callback)) {
       done = true;
       RecordTick(stats_, MEMTABLE_HIT);
     }
   }
   if (!done) {
     PERF_TIMER_GUARD(get_from_output_files_time);
-    sv->current->Get(read_options, lkey, value, &s, value_found);
+    sv->current->Get(read_options, lkey, value, &s, value_found,
+                     nullptr /* key_exists */, nullptr /* seq */, callback);
     RecordTick(stats_, MEMTABLE_MISS);
   }
 
@@ -3521,9 +3963,149 @@ Status DBImpl::GetImpl(ReadOptions& read_options,
 }
 
 /***************************** Shichao ******************************/
+void DBImpl::GetAsync(const ReadOptions& options,
+                      ColumnFamilyHandle* column_family, const Slice& key,
+                      GetCallback callback) {
+  ReadOptions read_options(options);
+  if (options.read_tier != kPersistedTier) {
+    // Served right away unless a file or a block has to be read
+    std::string value;
+    bool value_found = true;
+    read_options.read_tier = kBlockCacheTier;
+    Status s = GetImpl(read_options, column_family, key, &value, &value_found);
+    if (s.ok() && !value_found) {
+      s = Status::Incomplete("Not in the block cache");
+    }
+    if (!s.IsIncomplete() || options.read_tier == kBlockCacheTier) {
+      callback(s, std::move(value));
+      return;
+    }
+    read_options.read_tier = options.read_tier;
+  }
+
+  std::string user_key = key.ToString();
+  ScheduleAsyncRead(
+      [this, read_options, column_family, user_key, callback]() mutable {
+        std::string value;
+        Status s = Get(read_options, column_family, user_key, &value);
+        callback(s, std::move(value));
+      },
+      [callback]() {
+        callback(Status::ShutdownInProgress(), std::string());
+      });
+}
+
+void DBImpl::RangeQueryAsync(ReadOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Range& range,
+                             std::list<RangeQueryKeyVal>& res,
+                             RangeQueryCallback callback) {
+  ReadOptions* read_options = &options;
+  std::list<RangeQueryKeyVal>* result = &res;
+  std::string start = range.start.ToString();
+  std::string limit = range.limit.ToString();
+  ScheduleAsyncRead(
+      [this, read_options, column_family, start, limit, result, callback]() {
+        Status s;
+        bool next_query = RangeQuery(*read_options, column_family,
+                                     Range(start, limit), *result, &s);
+        callback(s, next_query);
+      },
+      [callback]() { callback(Status::ShutdownInProgress(), false); });
+}
+
 bool DBImpl::RangeQuery(ReadOptions& read_options,
                         ColumnFamilyHandle* column_family, const Range& range,
                         std::list<RangeQueryKeyVal>& res, Status* s) {
+  const auto& predicates = read_options.column_predicates;
+  if (predicates.empty()) {
+    return RangeQueryImpl(read_options, column_family, range, res, s);
+  }
+
+  auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
+  const Splitter* splitter = cfh->cfd()->ioptions()->splitter;
+  if (splitter == nullptr) {
+    res.clear();
+    *s = Status::InvalidArgument("Column predicates need a splitter.");
+    return false;
+  }
+
+  // The predicate columns are fetched along with the requested ones, and cut
+  // off once the rows are filtered. positions are the ones of the predicate
+  // columns in the fetched values.
+  std::vector<uint32_t> columns(read_options.columns);
+  size_t num_columns = 0;  // requested value columns
+  for (auto column : columns) {
+    num_columns += column > 0 ? 1 : 0;
+  }
+  std::vector<size_t> positions;
+  positions.reserve(predicates.size());
+  for (const auto& predicate : predicates) {
+    if (predicate.column == 0) {
+      res.clear();
+      *s = Status::InvalidArgument("Column predicate on the user key.");
+      return false;
+    }
+    if (columns.empty()) {  // all value columns
+      positions.push_back(predicate.column - 1);
+      continue;
+    }
+    size_t pos = 0;
+    bool found = false;
+    for (auto column : read_options.columns) {
+      if (column == predicate.column) {
+        found = true;
+        break;
+      }
+      pos += column > 0 ? 1 : 0;
+    }
+    if (!found) {
+      read_options.columns.push_back(predicate.column);
+    }
+    positions.push_back(pos);
+  }
+
+  bool next_query = RangeQueryImpl(read_options, column_family, range, res, s);
+  read_options.columns.swap(columns);
+  if (!s->ok()) {
+    return next_query;
+  }
+
+  bool widened = read_options.columns.size() < columns.size();
+  for (auto it = res.begin(); it != res.end();) {
+    std::vector<Slice> vals(splitter->Split(it->user_val));
+    bool match = true;
+    for (size_t i = 0; match && i < predicates.size(); i++) {
+      match = positions[i] < vals.size() &&
+              std::find(predicates[i].values.begin(),
+                        predicates[i].values.end(),
+                        vals[positions[i]]) != predicates[i].values.end();
+    }
+
+    size_t prev_val_size = it->user_val.size();
+    if (!match) {
+      assert(read_options.result_key_size >= it->user_key.size());
+      assert(read_options.result_val_size >= prev_val_size);
+      read_options.result_key_size -= it->user_key.size();
+      read_options.result_val_size -= prev_val_size;
+      it = res.erase(it);
+      continue;
+    }
+    if (widened) {
+      vals.resize(num_columns);
+      it->user_val = num_columns > 0 ? splitter->Stitch(vals) : "";
+      assert(read_options.result_val_size >= prev_val_size);
+      read_options.result_val_size += it->user_val.size() - prev_val_size;
+    }
+    ++it;
+  }
+  return next_query;
+}
+
+bool DBImpl::RangeQueryImpl(ReadOptions& read_options,
+                            ColumnFamilyHandle* column_family,
+                            const Range& range,
+                            std::list<RangeQueryKeyVal>& res, Status* s) {
   res.clear();
   read_options.result_key_size = 0;
   read_options.result_val_size = 0;
@@ -3541,7 +4123,9 @@ bool DBImpl::RangeQuery(ReadOptions& read_options,
     auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
     auto cfd = cfh->cfd();
 
-    SuperVersion* sv = GetAndRefSuperVersion(cfd);
+    // Not the thread local super version, since it is held across the
+    // batches, which RangeQueryAsync() may run on different threads
+    SuperVersion* sv = cfd->GetReferencedSuperVersion(&mutex_);
     read_options.range_query_meta = new RangeQueryMeta(cfd, sv, snapshot,
       nullptr, 0UL, cfd->user_comparator());
     RangeQueryMeta* meta =
@@ -3594,16 +4178,33 @@ bool DBImpl::RangeQuery(ReadOptions& read_options,
     // Not include the next start key
     size_t delta_key_size = it->second.iter_->user_key.size();
     size_t delta_val_size = it->second.iter_->user_val.size();
+    if (it->second.type_ == kTypeDeletion) {
+      meta->del_keys.erase(&*it->second.iter_);
+    }
     res.erase(it->second.iter_);
     assert(read_options.result_key_size >= delta_key_size);
     assert(read_options.result_val_size >= delta_val_size);
     read_options.result_key_size -= delta_key_size;
     read_options.result_val_size -= delta_val_size;
-    if (it->second.type_ == kTypeDeletion) {
-      meta->del_keys.erase(it->second.seq_);
-    }
     meta->map_res->erase(it);
   }
+
+  // Read back the values separated into blob files
+  for (auto& it : *meta->map_res) {
+    if (it.second.type_ != kTypeBlobIndex) {
+      continue;
+    }
+    std::string& user_val = it.second.iter_->user_val;
+    std::string blob_index;
+    blob_index.swap(user_val);
+    *s = cfd->blob_file_cache()->GetBlobValue(read_options, blob_index,
+                                              &user_val);
+    if (!s->ok()) {
+      return false;
+    }
+    assert(read_options.result_val_size >= blob_index.size());
+    read_options.result_val_size += user_val.size() - blob_index.size();
+  }
   meta->map_res->clear();
 
   // Hide deleted keys from users, erase them in list
@@ -3623,7 +4224,13 @@ bool DBImpl::RangeQuery(ReadOptions& read_options,
   if (result_total_size == 0 || read_options.batch_capacity == 0 ||
       result_total_size <= read_options.batch_capacity) {
     next_query = false;
-    ReturnAndCleanupSuperVersion(cfd, sv);
+    if (sv->Unref()) {
+      {
+        InstrumentedMutexLock l(&mutex_);
+        sv->Cleanup();
+      }
+      delete sv;
+    }
     delete meta;
     read_options.range_query_meta = nullptr;
   }
@@ -3632,6 +4239,91 @@ bool DBImpl::RangeQuery(ReadOptions& read_options,
 }
 /***************************** Shichao ******************************/
 
+Status DBImpl::SampleRange(const ReadOptions& read_options,
+                           ColumnFamilyHandle* column_family,
+                           const Range& range, size_t n,
+                           std::list<RangeQueryKeyVal>& res) {
+  // Rows scanned per sampled row, and blocks scanned at least unless the
+  // sample is smaller, so that the sample does not come from a few blocks
+  const uint64_t kOversampling = 2;
+  const size_t kMinSampledBlocks = 32;
+  if (n == 0) {
+    return Status::OK();
+  }
+
+  auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
+  auto cfd = cfh->cfd();
+  const Comparator* ucmp = cfd->user_comparator();
+
+  // The iterator resolves the visibility of the rows of the picked blocks
+  // through all the levels and the memtables. It is created first as both
+  // use the thread local super version.
+  std::unique_ptr<Iterator> iter(NewIterator(read_options, column_family));
+  SuperVersion* sv = GetAndRefSuperVersion(cfd);
+  RangeSampler sampler(sv, env_options_, range, env_->NowMicros());
+  Random64 rnd(env_->NowMicros() + 1);
+
+  std::vector<RangeQueryKeyVal> sample;
+  // The blocks of different levels overlap, so the same rows may be seen
+  // again
+  std::unordered_set<std::string> seen;
+  size_t num_blocks = 0;
+  auto add = [&]() {
+    if (!seen.insert(iter->key().ToString()).second) {
+      return;
+    }
+    // reservoir sampling
+    if (sample.size() < n) {
+      sample.emplace_back(iter->key().ToString(), iter->value().ToString());
+    } else {
+      uint64_t i = rnd.Uniform(seen.size());
+      if (i < n) {
+        sample[i] = RangeQueryKeyVal(iter->key().ToString(),
+                                     iter->value().ToString());
+      }
+    }
+  };
+
+  std::string start, limit;
+  bool start_included;
+  while ((seen.size() < kOversampling * n ||
+          num_blocks < std::min(n, kMinSampledBlocks)) &&
+         sampler.Next(&start, &start_included, &limit)) {
+    num_blocks++;
+    iter->Seek(start);
+    if (!start_included && iter->Valid() &&
+        ucmp->Compare(iter->key(), start) == 0) {
+      iter->Next();
+    }
+    for (; iter->Valid() && ucmp->Compare(iter->key(), limit) <= 0;
+         iter->Next()) {
+      add();
+    }
+    if (!iter->status().ok()) {
+      break;
+    }
+  }
+
+  Status s = sampler.status();
+  if (s.ok()) {
+    s = iter->status();
+  }
+  iter.reset();
+  ReturnAndCleanupSuperVersion(cfd, sv);
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::sort(sample.begin(), sample.end(),
+            [ucmp](const RangeQueryKeyVal& a, const RangeQueryKeyVal& b) {
+              return ucmp->Compare(a.user_key, b.user_key) < 0;
+            });
+  for (auto& kv : sample) {
+    res.emplace_back(std::move(kv));
+  }
+  return Status::OK();
+}
+
 #ifndef VIDARDB_LITE
 Status DBImpl::AddFile(ColumnFamilyHandle* column_family,
                        const std::string& file_path, bool move_file) {
@@ -4027,6 +4719,12 @@ Status DBImpl::DropColumnFamily(ColumnFamilyHandle* column_family) {
 
 Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
                               ColumnFamilyHandle* column_family) {
+  return NewIteratorImpl(read_options, column_family, nullptr);
+}
+
+Iterator* DBImpl::NewIteratorImpl(const ReadOptions& read_options,
+                                  ColumnFamilyHandle* column_family,
+                                  ReadCallback* callback) {
   if (read_options.read_tier == kPersistedTier) {
     return NewErrorIterator(Status::NotSupported(
         "ReadTier::kPersistedData is not yet supported in iterators."));
@@ -4043,7 +4741,8 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
     auto iter = new ForwardIterator(this, read_options, cfd, sv);
     return NewDBIterator(env_, *cfd->ioptions(), cfd->user_comparator(), iter,
                          kMaxSequenceNumber, sv->version_number,
-                         read_options.pin_data);
+                         read_options.pin_data, cfd->blob_file_cache(),
+                         read_options, callback);
 #endif
   } else {
     SequenceNumber latest_snapshot = versions_->LastSequence();
@@ -4099,7 +4798,8 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
     // that they are likely to be in the same cache line and/or page.
     ArenaWrappedDBIter* db_iter = NewArenaWrappedDbIterator(
         env_, *cfd->ioptions(), cfd->user_comparator(), snapshot,
-        sv->version_number, read_options.pin_data);
+        sv->version_number, read_options.pin_data, cfd->blob_file_cache(),
+        read_options, callback);
 
     InternalIterator* internal_iter =
         NewInternalIterator(read_options, cfd, sv, db_iter->GetArena());
@@ -4119,7 +4819,18 @@ const Snapshot* DBImpl::GetSnapshotForWriteConflictBoundary() {
 }
 #endif  // VIDARDB_LITE
 
-const Snapshot* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary) {
+const Snapshot* DBImpl::GetSnapshotAt(SequenceNumber seq) {
+  assert(seq <= versions_->LastSequence());
+  return GetSnapshotImpl(false, seq);
+}
+
+std::vector<SequenceNumber> DBImpl::GetSnapshotSequences() {
+  InstrumentedMutexLock l(&mutex_);
+  return snapshots_.GetAll();
+}
+
+const Snapshot* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary,
+                                        SequenceNumber seq) {
   int64_t unix_time = 0;
   env_->GetCurrentTime(&unix_time);  // Ignore error
   SnapshotImpl* s = new SnapshotImpl;
@@ -4130,8 +4841,9 @@ const Snapshot* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary) {
     delete s;
     return nullptr;
   }
-  return snapshots_.New(s, versions_->LastSequence(), unix_time,
-                        is_write_conflict_boundary);
+  return snapshots_.New(
+      s, seq == kMaxSequenceNumber ? versions_->LastSequence() : seq,
+      unix_time, is_write_conflict_boundary);
 }
 
 void DBImpl::ReleaseSnapshot(const Snapshot* s) {
@@ -4161,7 +4873,8 @@ Status DBImpl::Write(const WriteOptions& write_options, WriteBatch* my_batch) {
 Status DBImpl::WriteImpl(const WriteOptions& write_options,
                          WriteBatch* my_batch, WriteCallback* callback,
                          uint64_t* log_used, uint64_t log_ref,
-                         bool disable_memtable) {
+                         bool disable_memtable,
+                         PreReleaseCallback* pre_release_callback) {
   if (my_batch == nullptr) {
     return Status::Corruption("Batch is nullptr!");
   }
@@ -4176,6 +4889,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   w.disable_memtable = disable_memtable;
   w.in_batch_group = false;
   w.log_ref = log_ref;
+  w.pre_release_callback = pre_release_callback;
 
   if (!write_options.disableWAL) {
     RecordTick(stats_, WRITE_WITH_WAL);
@@ -4258,8 +4972,11 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         flush_column_family_if_log_file, total_log_size_, max_total_wal_size);
     // no need to refcount because drop is happening in write thread, so can't
     // happen while we're in the write thread
+    if (db_options_.atomic_flush) {
+      status = SwitchMemtablesForAtomicFlush(&context);
+    }
     for (auto cfd : *versions_->GetColumnFamilySet()) {
-      if (cfd->IsDropped()) {
+      if (cfd->IsDropped() || db_options_.atomic_flush) {
         continue;
       }
       if (cfd->GetLogNumber() <= flush_column_family_if_log_file) {
@@ -4283,7 +5000,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     size_t largest_cfd_size = 0;
 
     for (auto cfd : *versions_->GetColumnFamilySet()) {
-      if (cfd->IsDropped()) {
+      if (cfd->IsDropped() || db_options_.atomic_flush) {
         continue;
       }
       if (!cfd->mem()->IsEmpty()) {
@@ -4296,7 +5013,9 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         }
       }
     }
-    if (largest_cfd != nullptr) {
+    if (db_options_.atomic_flush) {
+      status = SwitchMemtablesForAtomicFlush(&context);
+    } else if (largest_cfd != nullptr) {
       status = SwitchMemtable(largest_cfd, &context);
       if (status.ok()) {
         largest_cfd->imm()->FlushRequested();
@@ -4372,11 +5091,15 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     bool parallel =
         db_options_.allow_concurrent_memtable_write && write_group.size() > 1;
     int total_count = 0;
+    int reserved_count = 0;  // by the pre-release callbacks
     uint64_t total_byte_size = 0;
     for (auto writer : write_group) {
       if (writer->ShouldWriteToMemtable()) {
         total_count += WriteBatchInternal::Count(writer->batch);
       }
+      if (writer->pre_release_callback != nullptr) {
+        reserved_count++;
+      }
 
       if (writer->ShouldWriteToWAL()) {
         total_byte_size = WriteBatchInternal::AppendedByteSize(
@@ -4384,7 +5107,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       }
     }
     const SequenceNumber current_sequence = last_sequence + 1;
-    last_sequence += total_count;
+    last_sequence += total_count + reserved_count;
 
     // Record statistics
     RecordTick(stats_, NUMBER_KEYS_WRITTEN, total_count);
@@ -4458,6 +5181,18 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         tmp_batch_.Clear();
       }
     }
+    if (status.ok() && reserved_count > 0) {
+      // Same numbering as the memtable inserts below
+      SequenceNumber sequence = current_sequence;
+      for (auto writer : write_group) {
+        if (writer->pre_release_callback != nullptr) {
+          writer->pre_release_callback->Callback(sequence, last_sequence);
+        }
+        if (writer->ShouldWriteToMemtable()) {
+          sequence += WriteBatchInternal::Count(writer->batch);
+        }
+      }
+    }
     if (status.ok()) {
       PERF_TIMER_GUARD(write_memtable_time);
 
@@ -4606,6 +5341,14 @@ Status DBImpl::DelayWrite(uint64_t num_bytes) {
 
 Status DBImpl::ScheduleFlushes(WriteContext* context) {
   ColumnFamilyData* cfd;
+  if (db_options_.atomic_flush) {
+    while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+      if (cfd->Unref()) {
+        delete cfd;
+      }
+    }
+    return SwitchMemtablesForAtomicFlush(context);
+  }
   while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
     auto status = SwitchMemtable(cfd, context);
     if (cfd->Unref()) {
@@ -4634,6 +5377,31 @@ void DBImpl::NotifyOnMemTableSealed(ColumnFamilyData* cfd,
 }
 #endif  // VIDARDB_LITE
 
+// REQUIRES: mutex_ is held
+// REQUIRES: this thread is currently at the front of the writer queue
+Status DBImpl::SwitchMemtablesForAtomicFlush(WriteContext* context) {
+  Status s;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped() || cfd->mem()->IsEmpty()) {
+      continue;
+    }
+    s = SwitchMemtable(cfd, context);
+    if (!s.ok()) {
+      break;
+    }
+  }
+  // Schedule whatever was switched even on failure, so that no immutable
+  // memtable is left behind without a pending flush.
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (!cfd->IsDropped() && cfd->imm()->NumNotFlushed() != 0) {
+      cfd->imm()->FlushRequested();
+      SchedulePendingFlush(cfd);
+    }
+  }
+  MaybeScheduleFlushOrCompaction();
+  return s;
+}
+
 // REQUIRES: mutex_ is held
 // REQUIRES: this thread is currently at the front of the writer queue
 Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
@@ -4696,7 +5464,8 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
         unique_ptr<WritableFileWriter> file_writer(
             new WritableFileWriter(std::move(lfile), opt_env_opt));
         new_log = new log::Writer(std::move(file_writer), new_log_number,
-                                  db_options_.recycle_log_file_num > 0);
+                                  db_options_.recycle_log_file_num > 0,
+                                  db_options_.wal_checksum);
       }
     }
 
@@ -4796,6 +5565,29 @@ Status DBImpl::GetPropertiesOfTablesInRange(ColumnFamilyHandle* column_family,
   return s;
 }
 
+Status DBImpl::EstimateRangeStats(ColumnFamilyHandle* column_family,
+                                  const Range& range,
+                                  const std::vector<uint32_t>& columns,
+                                  RangeStats* stats) {
+  auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
+  auto cfd = cfh->cfd();
+
+  // Increment the ref count
+  mutex_.Lock();
+  auto version = cfd->current();
+  version->Ref();
+  mutex_.Unlock();
+
+  auto s = version->EstimateRangeStats(range, columns, stats);
+
+  // Decrement the ref count
+  mutex_.Lock();
+  version->Unref();
+  mutex_.Unlock();
+
+  return s;
+}
+
 #endif  // VIDARDB_LITE
 
 const std::string& DBImpl::GetName() const {
@@ -5009,6 +5801,13 @@ ColumnFamilyHandle* DBImpl::GetColumnFamilyHandleUnlocked(
   return cf_memtables->GetColumnFamilyHandle();
 }
 
+ColumnFamilyHandle* DBImpl::NewColumnFamilyHandle(
+    ColumnFamilyHandle* column_family) {
+  auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
+  InstrumentedMutexLock l(&mutex_);
+  return new ColumnFamilyHandleImpl(cfh->cfd(), this, &mutex_);
+}
+
 void DBImpl::GetApproximateSizes(ColumnFamilyHandle* column_family,
                                  const Range* range, int n, uint64_t* sizes,
                                  bool include_memtable) {
@@ -5060,6 +5859,17 @@ Status DBImpl::GetUpdatesSince(
   return wal_manager_.GetUpdatesSince(seq, iter, read_options, versions_.get());
 }
 
+Status DBImpl::NewChangeStream(SequenceNumber seq,
+                               unique_ptr<ChangeStream>* stream,
+                               const ChangeStreamOptions& options) {
+  if (seq > versions_->LastSequence() + 1) {
+    return Status::NotFound("Requested sequence not yet written in the db");
+  }
+  stream->reset(new ChangeStreamImpl(&db_options_, env_options_, options, seq,
+                                     &wal_manager_, versions_.get()));
+  return Status::OK();
+}
+
 Status DBImpl::DeleteFile(std::string name) {
   uint64_t number;
   FileType type;
@@ -5332,6 +6142,46 @@ Status DB::Put(const WriteOptions& opt, ColumnFamilyHandle* column_family,
   return Write(opt, &batch);
 }
 
+Status DB::PutColumns(const WriteOptions& opt,
+                      ColumnFamilyHandle* column_family, const Slice& key,
+                      const std::vector<Slice>& columns) {
+  size_t size = key.size() + 24;
+  for (const auto& column : columns) {
+    size += column.size() + 5;
+  }
+  WriteBatch batch(size);
+  Status s = batch.PutColumns(column_family, key, columns);
+  if (!s.ok()) {
+    return s;
+  }
+  return Write(opt, &batch);
+}
+
+std::future<std::pair<Status, std::string>> DB::GetAsync(
+    const ReadOptions& options, ColumnFamilyHandle* column_family,
+    const Slice& key) {
+  auto promise =
+      std::make_shared<std::promise<std::pair<Status, std::string>>>();
+  auto future = promise->get_future();
+  GetAsync(options, column_family, key,
+           [promise](const Status& s, std::string&& value) {
+             promise->set_value(std::make_pair(s, std::move(value)));
+           });
+  return future;
+}
+
+std::future<std::pair<Status, bool>> DB::RangeQueryAsync(
+    ReadOptions& options, ColumnFamilyHandle* column_family,
+    const Range& range, std::list<RangeQueryKeyVal>& res) {
+  auto promise = std::make_shared<std::promise<std::pair<Status, bool>>>();
+  auto future = promise->get_future();
+  RangeQueryAsync(options, column_family, range, res,
+                  [promise](const Status& s, bool next_query) {
+                    promise->set_value(std::make_pair(s, next_query));
+                  });
+  return future;
+}
+
 Status DB::Delete(const WriteOptions& opt, ColumnFamilyHandle* column_family,
                   const Slice& key) {
   WriteBatch batch;
@@ -5431,7 +6281,8 @@ Status DB::Open(const DBOptions& db_options, const std::string& dbname,
       impl->logs_.emplace_back(
           new_log_number,
           new log::Writer(std::move(file_writer), new_log_number,
-                          impl->db_options_.recycle_log_file_num > 0));
+                          impl->db_options_.recycle_log_file_num > 0,
+                          impl->db_options_.wal_checksum));
 
       // set column family handles
       for (auto cf : column_families) {
@@ -5601,9 +6452,10 @@ Status DestroyDB(const std::string& dbname, const Options& options) {
       for (size_t i = 0; i < filenames.size(); i++) {
         if (ParseFileName(filenames[i], &number, &type) &&
           /********************** Shichao *********************************/
-            (type == kTableFile || type == kTableSubFile)) {  // Lock file will be deleted at end
+            (type == kTableFile || type == kTableSubFile ||
+             type == kBlobFile)) {
           std::string table_path = db_path.path + "/" + filenames[i];
-          Status del = type == kTableSubFile? options.env->DeleteFile(table_path):
+          Status del = type != kTableFile? options.env->DeleteFile(table_path):
               DeleteSSTFile(&options, table_path, static_cast<uint32_t>(path_id));
           /********************** Shichao *********************************/
           if (result.ok() && !del.ok()) {
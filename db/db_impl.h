@@ -58,10 +58,13 @@ class Version;
 class VersionEdit;
 class VersionSet;
 class Arena;
+class PreReleaseCallback;
+class ReadCallback;
 class WriteCallback;
 struct JobContext;
 struct ExternalSstFileInfo;
 struct MemTableInfo;
+class ThreadPool;
 
 class DBImpl : public DB {
  public:
@@ -85,6 +88,13 @@ class DBImpl : public DB {
   virtual Status Get(ReadOptions& options, ColumnFamilyHandle* column_family,
                      const Slice& key, std::string* value) override;
 
+  using DB::GetColumns;
+  virtual Status GetColumns(const ReadOptions& options,
+                            ColumnFamilyHandle* column_family,
+                            const Slice& key,
+                            const std::vector<uint32_t>& columns,
+                            std::vector<std::string>* values) override;
+
   /*************************** Shichao ****************************/
   using DB::RangeQuery;
   virtual bool RangeQuery(ReadOptions& options,
@@ -93,6 +103,24 @@ class DBImpl : public DB {
                           Status* s = nullptr) override;
   /*************************** Shichao ****************************/
 
+  using DB::SampleRange;
+  virtual Status SampleRange(const ReadOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Range& range, size_t n,
+                             std::list<RangeQueryKeyVal>& res) override;
+
+  using DB::GetAsync;
+  virtual void GetAsync(const ReadOptions& options,
+                        ColumnFamilyHandle* column_family, const Slice& key,
+                        GetCallback callback) override;
+
+  using DB::RangeQueryAsync;
+  virtual void RangeQueryAsync(ReadOptions& options,
+                               ColumnFamilyHandle* column_family,
+                               const Range& range,
+                               std::list<RangeQueryKeyVal>& res,
+                               RangeQueryCallback callback) override;
+
   virtual Status CreateColumnFamily(const ColumnFamilyOptions& options,
                                     const std::string& column_family,
                                     ColumnFamilyHandle** handle) override;
@@ -172,6 +200,10 @@ class DBImpl : public DB {
       SequenceNumber seq_number, unique_ptr<TransactionLogIterator>* iter,
       const TransactionLogIterator::ReadOptions&
           read_options = TransactionLogIterator::ReadOptions()) override;
+  virtual Status NewChangeStream(SequenceNumber seq_number,
+                                 unique_ptr<ChangeStream>* stream,
+                                 const ChangeStreamOptions& options =
+                                     ChangeStreamOptions()) override;
   virtual Status DeleteFile(std::string name) override;
   Status DeleteFilesInRange(ColumnFamilyHandle* column_family,
                             const Slice* begin, const Slice* end);
@@ -395,6 +427,11 @@ class DBImpl : public DB {
   // Same as above, should called without mutex held and not on write thread.
   ColumnFamilyHandle* GetColumnFamilyHandleUnlocked(uint32_t column_family_id);
 
+  // Returns a new handle of the column family of column_family, which stays
+  // valid until it is deleted, whatever happens to column_family. The caller
+  // must delete it before the DB. Should be called without mutex held.
+  ColumnFamilyHandle* NewColumnFamilyHandle(ColumnFamilyHandle* column_family);
+
   // Returns the number of currently running flushes.
   // REQUIREMENT: mutex_ must be held when calling this function.
   int num_running_flushes() {
@@ -416,9 +453,11 @@ class DBImpl : public DB {
     uint64_t log_number_;
     std::string name_;
     WriteBatch* batch_;
+    // of the first update of the prepared section
+    SequenceNumber seq_;
     explicit RecoveredTransaction(const uint64_t log, const std::string& name,
-                                  WriteBatch* batch)
-        : log_number_(log), name_(name), batch_(batch) {}
+                                  WriteBatch* batch, SequenceNumber seq)
+        : log_number_(log), name_(name), batch_(batch), seq_(seq) {}
 
     ~RecoveredTransaction() { delete batch_; }
   };
@@ -440,8 +479,9 @@ class DBImpl : public DB {
   }
 
   void InsertRecoveredTransaction(const uint64_t log, const std::string& name,
-                                  WriteBatch* batch) {
-    recovered_transactions_[name] = new RecoveredTransaction(log, name, batch);
+                                  WriteBatch* batch, SequenceNumber seq) {
+    recovered_transactions_[name] =
+        new RecoveredTransaction(log, name, batch, seq);
     MarkLogAsContainingPrepSection(log);
   }
 
@@ -465,6 +505,23 @@ class DBImpl : public DB {
   void MarkLogAsHavingPrepSectionFlushed(uint64_t log);
   void MarkLogAsContainingPrepSection(uint64_t log);
 
+  // Get() and NewIterator() whose reads skip the entries callback rejects,
+  // if any. callback must outlive the iterator.
+  // Note: 'value_found' from KeyMayExist propagates here
+  Status GetImpl(ReadOptions& options, ColumnFamilyHandle* column_family,
+                 const Slice& key, std::string* value,
+                 bool* value_found = nullptr, ReadCallback* callback = nullptr);
+  Iterator* NewIteratorImpl(const ReadOptions& options,
+                            ColumnFamilyHandle* column_family,
+                            ReadCallback* callback);
+
+  // As GetSnapshot(), but as of seq, which must not be above the last
+  // sequence number. Keeps the entries a recovered transaction may hide.
+  const Snapshot* GetSnapshotAt(SequenceNumber seq);
+
+  // The sequence numbers of the live snapshots, in ascending order
+  std::vector<SequenceNumber> GetSnapshotSequences();
+
  protected:
   Env* const env_;
   const std::string dbname_;
@@ -510,7 +567,8 @@ class DBImpl : public DB {
   Status WriteImpl(const WriteOptions& options, WriteBatch* updates,
                    WriteCallback* callback = nullptr,
                    uint64_t* log_used = nullptr, uint64_t log_ref = 0,
-                   bool disable_memtable = false);
+                   bool disable_memtable = false,
+                   PreReleaseCallback* pre_release_callback = nullptr);
 
   uint64_t FindMinLogContainingOutstandingPrep();
   uint64_t FindMinPrepLogReferencedByMemTable();
@@ -519,6 +577,7 @@ class DBImpl : public DB {
   friend class DB;
   friend class InternalStats;
   friend class TransactionImpl;
+  friend class WritePreparedTxn;
 #ifndef VIDARDB_LITE
   friend class ForwardIterator;
 #endif
@@ -529,6 +588,12 @@ class DBImpl : public DB {
 #endif
   struct CompactionState;
 
+  // RangeQuery() without filtering the rows by read_options.column_predicates,
+  // which the column tables may nevertheless use to skip rows.
+  bool RangeQueryImpl(ReadOptions& read_options,
+                      ColumnFamilyHandle* column_family, const Range& range,
+                      std::list<RangeQueryKeyVal>& res, Status* s);
+
   struct WriteContext;
 
   Status NewDB();
@@ -573,6 +638,12 @@ class DBImpl : public DB {
                                    bool* madeProgress, JobContext* job_context,
                                    LogBuffer* log_buffer);
 
+  // Flush the immutable memtables of cfds as one group, whose results are
+  // committed to the manifest atomically. Used with DBOptions::atomic_flush.
+  Status AtomicFlushMemTablesToOutputFiles(
+      const std::vector<ColumnFamilyData*>& cfds, bool* madeProgress,
+      JobContext* job_context, LogBuffer* log_buffer);
+
   // REQUIRES: log_numbers are sorted in ascending order
   Status RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
                          SequenceNumber* max_sequence, bool read_only);
@@ -593,9 +664,16 @@ class DBImpl : public DB {
 
   Status SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context);
 
+  // Switch the memtables of all column families at the same point of the
+  // write stream and schedule their flush. Used with DBOptions::atomic_flush.
+  Status SwitchMemtablesForAtomicFlush(WriteContext* context);
+
   // Force current memtable contents to be flushed.
   Status FlushMemTable(ColumnFamilyData* cfd, const FlushOptions& options);
 
+  // Switches and flushes the memtables of all column families together.
+  Status AtomicFlushMemTables(const FlushOptions& options);
+
   // Wait for memtable flushed
   Status WaitForFlushMemTable(ColumnFamilyData* cfd);
 
@@ -616,12 +694,23 @@ class DBImpl : public DB {
   void SchedulePendingFlush(ColumnFamilyData* cfd);
   void SchedulePendingCompaction(ColumnFamilyData* cfd);
   static void BGWorkCompaction(void* arg);
+  static void BGWorkBottomCompaction(void* arg);
   static void BGWorkFlush(void* db);
   static void UnscheduleCallback(void* arg);
-  void BackgroundCallCompaction(void* arg);
+  // Runs a read of GetAsync() or RangeQueryAsync() on read_pool_
+  void ScheduleAsyncRead(std::function<void()>&& run,
+                         std::function<void()>&& cancel);
+  static void BGWorkAsyncRead(void* arg);
+  static void UnscheduleAsyncReadCallback(void* arg);
+  void BackgroundCallCompaction(void* arg,
+                                Compaction* prepicked_compaction = nullptr);
   void BackgroundCallFlush();
+  // If prepicked_compaction is set, it is run, and it came from the BOTTOM
+  // pool. Otherwise a non-trivial compaction into the bottommost level is
+  // handed over to the BOTTOM pool if it has threads.
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
-                              LogBuffer* log_buffer, void* m = 0);
+                              LogBuffer* log_buffer, void* m = 0,
+                              Compaction* prepicked_compaction = nullptr);
   Status BackgroundFlush(bool* madeProgress, JobContext* job_context,
                          LogBuffer* log_buffer);
 
@@ -643,13 +732,17 @@ class DBImpl : public DB {
   // helper functions for adding and removing from flush & compaction queues
   void AddToCompactionQueue(ColumnFamilyData* cfd);
   ColumnFamilyData* PopFirstFromCompactionQueue();
+  // The column family to compact next: the first urgent one if any, else the
+  // one of highest CompactionUrgency(), the first one on ties
+  ColumnFamilyData* PopMostUrgentFromCompactionQueue();
   void AddToFlushQueue(ColumnFamilyData* cfd);
   ColumnFamilyData* PopFirstFromFlushQueue();
 
   // helper function to call after some of the logs_ were synced
   void MarkLogsSynced(uint64_t up_to, bool synced_dir, const Status& status);
 
-  const Snapshot* GetSnapshotImpl(bool is_write_conflict_boundary);
+  const Snapshot* GetSnapshotImpl(bool is_write_conflict_boundary,
+                                  SequenceNumber seq = kMaxSequenceNumber);
 
   // table_cache_ provides its own synchronization
   std::shared_ptr<Cache> table_cache_;
@@ -820,8 +913,18 @@ class DBImpl : public DB {
   int unscheduled_compactions_;
 
   // count how many background compactions are running or have been scheduled
+  // in the LOW pool
   int bg_compaction_scheduled_;
 
+  // count how many bottommost-level compactions are running or have been
+  // scheduled in the BOTTOM pool
+  int bg_bottom_compaction_scheduled_;
+
+  // The compactions of the BOTTOM pool dropped by UnSchedule(), whose files
+  // are released once the destructor gets mutex_ back. Only touched by the
+  // thread calling UnSchedule().
+  std::vector<Compaction*> unscheduled_bottom_compactions_;
+
   // stores the number of compactions are currently running
   int num_running_compactions_;
 
@@ -855,8 +958,18 @@ class DBImpl : public DB {
   struct CompactionArg {
     DBImpl* db;
     ManualCompaction* m;
+    // Picked in the LOW pool, run in the BOTTOM pool
+    Compaction* prepicked_compaction;
+  };
+
+  struct AsyncReadArg {
+    std::function<void()> run;
+    std::function<void()> cancel;  // if unscheduled on shutdown
   };
 
+  // Read executor of GetAsync() and RangeQueryAsync()
+  std::unique_ptr<ThreadPool> read_pool_;
+
   // Have we encountered a background error in paranoid mode?
   Status bg_error_;
 
@@ -967,15 +1080,14 @@ class DBImpl : public DB {
   virtual Status GetPropertiesOfTablesInRange(
       ColumnFamilyHandle* column_family, const Range* range, std::size_t n,
       TablePropertiesCollection* props) override;
+  using DB::EstimateRangeStats;
+  virtual Status EstimateRangeStats(ColumnFamilyHandle* column_family,
+                                    const Range& range,
+                                    const std::vector<uint32_t>& columns,
+                                    RangeStats* stats) override;
 
 #endif  // VIDARDB_LITE
 
-  // Function that Get and KeyMayExist call with no_io true or false
-  // Note: 'value_found' from KeyMayExist propagates here
-  Status GetImpl(ReadOptions& options, ColumnFamilyHandle* column_family,
-                 const Slice& key, std::string* value,
-                 bool* value_found = nullptr);
-
   bool GetIntPropertyInternal(ColumnFamilyData* cfd,
                               const DBPropertyInfo& property_info,
                               bool is_locked, uint64_t* value);
@@ -13,9 +13,11 @@
 #include <string>
 #include <limits>
 
+#include "db/blob_file.h"
 #include "db/dbformat.h"
 #include "db/filename.h"
 #include "db/pinned_iterators_manager.h"
+#include "db/read_callback.h"
 #include "port/port.h"
 #include "vidardb/env.h"
 #include "vidardb/iterator.h"
@@ -100,19 +102,28 @@ class DBIter: public Iterator {
 
   DBIter(Env* env, const ImmutableCFOptions& ioptions, const Comparator* cmp,
          InternalIterator* iter, SequenceNumber s, bool arena_mode,
-         uint64_t version_number, bool pin_data = false)
+         uint64_t version_number, bool pin_data = false,
+         BlobFileCache* blob_file_cache = nullptr,
+         const ReadOptions& read_options = ReadOptions(),
+         ReadCallback* read_callback = nullptr)
       : arena_mode_(arena_mode),
         env_(env),
         logger_(ioptions.info_log),
         user_comparator_(cmp),
         iter_(iter),
         sequence_(s),
+        read_callback_(read_callback),
         direction_(kForward),
         valid_(false),
         current_entry_is_merged_(false),
+        is_blob_(false),
         statistics_(ioptions.statistics),
         version_number_(version_number),
-        pin_thru_lifetime_(pin_data) {
+        pin_thru_lifetime_(pin_data),
+        blob_file_cache_(blob_file_cache) {
+    blob_read_options_.verify_checksums = read_options.verify_checksums;
+    blob_read_options_.fill_cache = read_options.fill_cache;
+    blob_read_options_.read_tier = read_options.read_tier;
     RecordTick(statistics_, NO_ITERATORS);
     if (pin_thru_lifetime_) {
       pinned_iters_mgr_.StartPinning();
@@ -144,7 +155,7 @@ class DBIter: public Iterator {
   }
   virtual Slice value() const override {
     assert(valid_);
-    if (current_entry_is_merged_) {
+    if (current_entry_is_merged_ || is_blob_) {
       return saved_value_;
     } else if (direction_ == kReverse) {
       return pinned_value_;
@@ -198,6 +209,12 @@ class DBIter: public Iterator {
   inline void FindNextUserEntry(bool skipping);
   void FindNextUserEntryInternal(bool skipping);
   bool ParseKey(ParsedInternalKey* key);
+  bool ReadBlobValue(const Slice& blob_index);
+
+  bool IsVisible(SequenceNumber seq) {
+    return seq <= sequence_ &&
+           (read_callback_ == nullptr || read_callback_->IsVisible(seq));
+  }
 
   // Temporarily pin the blocks that we encounter until ReleaseTempPinnedData()
   // is called
@@ -229,6 +246,7 @@ class DBIter: public Iterator {
   const Comparator* const user_comparator_;
   InternalIterator* iter_;
   SequenceNumber const sequence_;
+  ReadCallback* const read_callback_;
 
   Status status_;
   IterKey saved_key_;
@@ -237,11 +255,15 @@ class DBIter: public Iterator {
   Direction direction_;
   bool valid_;
   bool current_entry_is_merged_;
+  // the value is in saved_value_, read back from the blob files
+  bool is_blob_;
   Statistics* statistics_;
   uint64_t version_number_;
   // Means that we will pin all data blocks we read as long the Iterator
   // is not deleted, will be true if ReadOptions::pin_data is true
   const bool pin_thru_lifetime_;
+  BlobFileCache* blob_file_cache_;
+  ReadOptions blob_read_options_;
   // List of operands for merge operator.
   LocalStatistics local_stats_;
   PinnedIteratorsManager pinned_iters_mgr_;
@@ -263,6 +285,24 @@ inline bool DBIter::ParseKey(ParsedInternalKey* ikey) {
   }
 }
 
+// Sets saved_value_ to the value of the kTypeBlobIndex entry blob_index.
+// Returns false and records the error in status_ if it cannot be read.
+bool DBIter::ReadBlobValue(const Slice& blob_index) {
+  ClearSavedValue();
+  if (blob_file_cache_ == nullptr) {
+    status_ = Status::NotSupported("blob index without blob file cache");
+  } else {
+    status_ = blob_file_cache_->GetBlobValue(blob_read_options_, blob_index,
+                                             &saved_value_);
+  }
+  if (!status_.ok()) {
+    valid_ = false;
+    return false;
+  }
+  is_blob_ = true;
+  return true;
+}
+
 void DBIter::Next() {
   assert(valid_);
 
@@ -324,11 +364,12 @@ void DBIter::FindNextUserEntryInternal(bool skipping) {
   assert(iter_->Valid());
   assert(direction_ == kForward);
   current_entry_is_merged_ = false;
+  is_blob_ = false;
   do {
     ParsedInternalKey ikey;
 
     if (ParseKey(&ikey)) {
-      if (ikey.sequence <= sequence_) {
+      if (IsVisible(ikey.sequence)) {
         if (skipping &&
            user_comparator_->Compare(ikey.user_key, saved_key_.GetKey()) <= 0) {
           PERF_COUNTER_ADD(internal_key_skipped_count, 1);
@@ -344,10 +385,15 @@ void DBIter::FindNextUserEntryInternal(bool skipping) {
               PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
               break;
             case kTypeValue:
-              valid_ = true;
+            case kTypeBlobIndex:
               saved_key_.SetKey(
                   ikey.user_key,
                   !iter_->IsKeyPinned() || !pin_thru_lifetime_ /* copy */);
+              if (ikey.type == kTypeBlobIndex &&
+                  !ReadBlobValue(iter_->value())) {
+                return;
+              }
+              valid_ = true;
               return;
             default:
               assert(false);
@@ -427,6 +473,10 @@ void DBIter::PrevInternal() {
       }
       return;
     }
+    if (!status_.ok()) {
+      valid_ = false;
+      return;
+    }
     if (!iter_->Valid()) {
       break;
     }
@@ -445,6 +495,7 @@ void DBIter::PrevInternal() {
 bool DBIter::FindValueForCurrentKey() {
   assert(iter_->Valid());
   current_entry_is_merged_ = false;
+  is_blob_ = false;
   // last entry before merge (could be kTypeDeletion, kTypeSingleDeletion or
   // kTypeValue)
   ValueType last_key_entry_type = kTypeDeletion;
@@ -452,11 +503,22 @@ bool DBIter::FindValueForCurrentKey() {
   ParsedInternalKey ikey;
   FindParseableKey(&ikey, kReverse);
 
-  while (iter_->Valid() && ikey.sequence <= sequence_ &&
+  while (iter_->Valid() &&
          user_comparator_->Equal(ikey.user_key, saved_key_.GetKey())) {
+    if (!IsVisible(ikey.sequence)) {
+      // The newer entries are not visible either, unless some are hidden
+      // by the read callback only
+      if (read_callback_ == nullptr) {
+        break;
+      }
+      iter_->Prev();
+      FindParseableKey(&ikey, kReverse);
+      continue;
+    }
     last_key_entry_type = ikey.type;
     switch (last_key_entry_type) {
       case kTypeValue:
+      case kTypeBlobIndex:
         ReleaseTempPinnedData();
         TempPinData();
         pinned_value_ = iter_->value();
@@ -481,6 +543,11 @@ bool DBIter::FindValueForCurrentKey() {
     case kTypeValue:
       // do nothing - we've already has value in saved_value_
       break;
+    case kTypeBlobIndex:
+      if (!ReadBlobValue(pinned_value_)) {
+        return false;
+      }
+      break;
     default:
       assert(false);
       break;
@@ -516,7 +583,7 @@ void DBIter::FindPrevUserKey() {
   int cmp;
   while (iter_->Valid() && ((cmp = user_comparator_->Compare(
                                  ikey.user_key, saved_key_.GetKey())) == 0 ||
-                            (cmp > 0 && ikey.sequence > sequence_))) {
+                            (cmp > 0 && !IsVisible(ikey.sequence)))) {
     iter_->Prev();
     FindParseableKey(&ikey, kReverse);
   }
@@ -612,10 +679,13 @@ Iterator* NewDBIterator(Env* env, const ImmutableCFOptions& ioptions,
                         const Comparator* user_key_comparator,
                         InternalIterator* internal_iter,
                         const SequenceNumber& sequence, uint64_t version_number,
-                        bool pin_data) {
+                        bool pin_data, BlobFileCache* blob_file_cache,
+                        const ReadOptions& read_options,
+                        ReadCallback* read_callback) {
   DBIter* db_iter =
       new DBIter(env, ioptions, user_key_comparator, internal_iter, sequence,
-                 false, version_number, /*iterate_upper_bound,*/ pin_data);
+                 false, version_number, /*iterate_upper_bound,*/ pin_data,
+                 blob_file_cache, read_options, read_callback);
   return db_iter;
 }
 
@@ -650,13 +720,15 @@ void ArenaWrappedDBIter::RegisterCleanup(CleanupFunction function, void* arg1,
 ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     Env* env, const ImmutableCFOptions& ioptions,
     const Comparator* user_key_comparator, const SequenceNumber& sequence,
-    uint64_t version_number, bool pin_data) {
+    uint64_t version_number, bool pin_data, BlobFileCache* blob_file_cache,
+    const ReadOptions& read_options, ReadCallback* read_callback) {
   ArenaWrappedDBIter* iter = new ArenaWrappedDBIter();
   Arena* arena = iter->GetArena();
   auto mem = arena->AllocateAligned(sizeof(DBIter));
   DBIter* db_iter =
       new (mem) DBIter(env, ioptions, user_key_comparator, nullptr, sequence,
-                       true, version_number, pin_data);
+                       true, version_number, pin_data, blob_file_cache,
+                       read_options, read_callback);
 
   iter->SetDBIter(db_iter);
 
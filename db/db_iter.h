@@ -18,17 +18,23 @@
 namespace vidardb {
 
 class Arena;
+class BlobFileCache;
 class DBIter;
 class InternalIterator;
+class ReadCallback;
 
 // Return a new iterator that converts internal keys (yielded by
 // "*internal_iter") that were live at the specified "sequence" number
-// into appropriate user keys.
-extern Iterator* NewDBIterator(Env* env, const ImmutableCFOptions& options,
-                               const Comparator* user_key_comparator,
-                               InternalIterator* internal_iter,
-                               const SequenceNumber& sequence,
-                               uint64_t version_number, bool pin_data = false);
+// into appropriate user keys. The kTypeBlobIndex values are read back from
+// the blob files through "blob_file_cache" with "read_options". The
+// internal keys "read_callback" rejects, if any, are skipped.
+extern Iterator* NewDBIterator(
+    Env* env, const ImmutableCFOptions& options,
+    const Comparator* user_key_comparator, InternalIterator* internal_iter,
+    const SequenceNumber& sequence, uint64_t version_number,
+    bool pin_data = false, BlobFileCache* blob_file_cache = nullptr,
+    const ReadOptions& read_options = ReadOptions(),
+    ReadCallback* read_callback = nullptr);
 
 // A wrapper iterator which wraps DB Iterator and the arena, with which the DB
 // iterator is supposed be allocated. This class is used as an entry point of
@@ -72,6 +78,9 @@ class ArenaWrappedDBIter : public Iterator {
 extern ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     Env* env, const ImmutableCFOptions& options,
     const Comparator* user_key_comparator, const SequenceNumber& sequence,
-    uint64_t version_number, bool pin_data = false);
+    uint64_t version_number, bool pin_data = false,
+    BlobFileCache* blob_file_cache = nullptr,
+    const ReadOptions& read_options = ReadOptions(),
+    ReadCallback* read_callback = nullptr);
 
 }  // namespace vidardb
@@ -174,8 +174,10 @@ const Slice ReformatUserValue(const Slice& user_value,
   result.reserve(columns.size());
   std::vector<Slice> user_vals(splitter->Split(user_value));
   for (auto index : columns) {  // from 0 to MAX_COLUMN_INDEX
-    assert(index <= user_vals.size());
-    if (index > 0) {  // only process the value columns
+    // only process the value columns, the ones past the value being empty
+    if (index > user_vals.size()) {
+      result.emplace_back();
+    } else if (index > 0) {
       result.emplace_back(std::move(user_vals[index - 1]));
     }
   }
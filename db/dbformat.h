@@ -50,6 +50,7 @@ enum ValueType : unsigned char {
   kTypeCommitXID = 0xB,                   // WAL only.
   kTypeRollbackXID = 0xC,                 // WAL only.
   kTypeNoop = 0xD,                        // WAL only.
+  kTypeBlobIndex = 0x11,                  // Columns in blob files, SST only.
   kMaxValue = 0x7F                        // Not used for storing records.
 };
 
@@ -59,12 +60,12 @@ enum ValueType : unsigned char {
 // and the value type is embedded as the low 8 bits in the sequence
 // number in internal keys, we need to use the highest-numbered
 // ValueType, not the lowest).
-static const ValueType kValueTypeForSeek = kTypeSingleDeletion;
+static const ValueType kValueTypeForSeek = kTypeBlobIndex;
 
 // Checks whether a type is a value type (i.e. a type used in memtables and sst
 // files).
 inline bool IsValueType(ValueType t) {
-  return t < kTypeLogData || t == kTypeSingleDeletion;
+  return t < kTypeLogData || t == kTypeSingleDeletion || t == kTypeBlobIndex;
 }
 
 // We leave eight bits empty at the bottom so a type and sequence#
@@ -380,8 +381,10 @@ struct RangeQueryMeta {
   SequenceNumber limit_sequence;             // Limit sequence
   std::string next_start_key;                // Next start key
   std::map<std::string, SeqTypeVal, MapKeyComparator>* map_res; // Temp map
-  std::unordered_map<SequenceNumber,
-      std::list<RangeQueryKeyVal>::iterator> del_keys;  // store delete keys
+  // store delete keys, by their result entries since the sequence numbers of
+  // the bottommost files are all zero
+  std::unordered_map<RangeQueryKeyVal*,
+      std::list<RangeQueryKeyVal>::iterator> del_keys;
 
   RangeQueryMeta(ColumnFamilyData* cfd, SuperVersion* sv, SequenceNumber snap,
                  LookupKey* limit_key = nullptr, SequenceNumber limit_seq = 0,
@@ -424,15 +427,15 @@ inline std::vector<SequenceNumber> CompressResultList(
     auto it = --(meta->map_res->end());  // get the next start kv
     size_t delta_key_size = it->second.iter_->user_key.size();
     size_t delta_val_size = it->second.iter_->user_val.size();
+    if (it->second.type_ == kTypeDeletion) {
+      // remove from unordered_map
+      meta->del_keys.erase(&*it->second.iter_);
+    }
     res->erase(it->second.iter_);  // remove from list
     assert(read_options.result_key_size >= delta_key_size);
     assert(read_options.result_val_size >= delta_val_size);
     read_options.result_key_size -= delta_key_size;
     read_options.result_val_size -= delta_val_size;
-    if (it->second.type_ == kTypeDeletion) {
-      // remove from unordered_map
-      meta->del_keys.erase(it->second.seq_);
-    }
     deleted_sequence_numbers.emplace_back(it->second.seq_);
     meta->map_res->erase(it);  // remove from map
 
@@ -458,7 +461,10 @@ inline int CompareRangeLimit(const InternalKeyComparator& comparator,
     return -1;
   }
 
-  return comparator.Compare(internal_key, limit->internal_key());
+  // By user key: the limit has sequence number zero like the entries of the
+  // bottommost files, which the internal key order would put past it.
+  return comparator.user_comparator()->Compare(ExtractUserKey(internal_key),
+                                               limit->user_key());
 }
 /**************************** Quanzhao *****************************/
 
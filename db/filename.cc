@@ -33,6 +33,7 @@ namespace vidardb {
 
 static const std::string kVidarDbTFileExt = "sst";
 static const std::string kLevelDbTFileExt = "ldb";
+static const std::string kBlobFileExt = "blob";
 
 // Given a path, flatten the path name by replacing all chars not in
 // {[0-9,a-z,A-Z,-,_,.]} with _. And append '_LOG\0' at the end.
@@ -124,6 +125,22 @@ std::string TableFileName(const std::vector<DbPath>& db_paths, uint64_t number,
   return MakeTableFileName(path, number);
 }
 
+std::string MakeBlobFileName(const std::string& path, uint64_t number) {
+  return MakeFileName(path, number, kBlobFileExt.c_str());
+}
+
+std::string BlobFileName(const std::vector<DbPath>& db_paths,
+                         uint64_t number, uint32_t path_id) {
+  assert(number > 0);
+  std::string path;
+  if (path_id >= db_paths.size()) {
+    path = db_paths.back().path;
+  } else {
+    path = db_paths[path_id].path;
+  }
+  return MakeBlobFileName(path, number);
+}
+
 /******************************* Shichao ********************************/
 std::string TableSubFileName(const std::string& name, uint32_t number) {
   assert(number > 0);
@@ -235,7 +252,7 @@ std::string IdentityFileName(const std::string& dbname) {
 //    dbname/<info_log_name_prefix>
 //    dbname/<info_log_name_prefix>.old.[0-9]+
 //    dbname/MANIFEST-[0-9]+
-//    dbname/[0-9]+.(log|sst)
+//    dbname/[0-9]+.(log|sst|blob)
 //    dbname/METADB-[0-9]+
 //    dbname/OPTIONS-[0-9]+
 //    dbname/OPTIONS-[0-9]+.dbtmp
@@ -352,6 +369,8 @@ bool ParseFileName(const std::string& fname, uint64_t* number,
       *type = kTableFile;
     } else if (suffix.starts_with(kVidarDbTFileExt)) {  // Shichao
       *type = kTableSubFile;                            // Shichao
+    } else if (suffix == Slice(kBlobFileExt)) {
+      *type = kBlobFile;
     } else if (suffix == Slice(kTempFileNameSuffix)) {
       *type = kTempFile;
     } else {
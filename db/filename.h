@@ -37,6 +37,7 @@ enum FileType {
   kDBLockFile,
   kTableFile,
   kTableSubFile,  // Shichao
+  kBlobFile,
   kDescriptorFile,
   kCurrentFile,
   kTempFile,
@@ -78,6 +79,14 @@ extern std::string TableFileName(const std::vector<DbPath>& db_paths,
 
 extern std::string TableSubFileName(const std::string& name, uint32_t number);  // Shichao
 
+extern std::string MakeBlobFileName(const std::string& path, uint64_t number);
+
+// Return the name of the blob file with the specified number in the db path
+// path_id. A blob file is placed on the db path of the table file written
+// with it.
+extern std::string BlobFileName(const std::vector<DbPath>& db_paths,
+                                uint64_t number, uint32_t path_id);
+
 // Sufficient buffer size for FormatFileNumber.
 const size_t kFormatFileNumberBufSize = 38;
 
@@ -21,6 +21,9 @@
 #include <inttypes.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "db/builder.h"
@@ -59,6 +62,147 @@
 
 namespace vidardb {
 
+namespace {
+
+// Orders the memtable iterators by their first keys, and returns true if
+// their key ranges do not overlap, as for memtables filled by ascending
+// writes, so that they need not be merged.
+bool SortDisjointIterators(const InternalKeyComparator& icmp,
+                           std::vector<InternalIterator*>* iters) {
+  std::vector<std::pair<Slice, InternalIterator*>> firsts;
+  std::vector<InternalIterator*> empties;
+  for (auto iter : *iters) {
+    iter->SeekToFirst();
+    if (iter->Valid()) {
+      firsts.emplace_back(iter->key(), iter);
+    } else if (iter->status().ok()) {
+      empties.push_back(iter);
+    } else {
+      return false;
+    }
+  }
+  std::sort(firsts.begin(), firsts.end(),
+            [&icmp](const std::pair<Slice, InternalIterator*>& a,
+                    const std::pair<Slice, InternalIterator*>& b) {
+              return icmp.Compare(a.first, b.first) < 0;
+            });
+  for (size_t i = 1; i < firsts.size(); i++) {
+    InternalIterator* prev = firsts[i - 1].second;
+    prev->SeekToLast();
+    if (!prev->Valid() || icmp.Compare(prev->key(), firsts[i].first) >= 0) {
+      return false;
+    }
+  }
+
+  iters->clear();
+  for (const auto& first : firsts) {
+    iters->push_back(first.second);
+  }
+  iters->insert(iters->end(), empties.begin(), empties.end());
+  return true;
+}
+
+// Bounds the user keys of a memtable iterator to [*lower, *upper), an
+// absent bound being unbounded, for a subflush.
+class SubflushIterator : public InternalIterator {
+ public:
+  SubflushIterator(InternalIterator* iter, const Comparator* ucmp,
+                   const std::string* lower, const std::string* upper)
+      : iter_(iter), ucmp_(ucmp), lower_(lower), upper_(upper) {}
+
+  virtual ~SubflushIterator() { iter_->~InternalIterator(); }
+
+  virtual bool Valid() const override {
+    if (!iter_->Valid()) {
+      return false;
+    }
+    Slice user_key = ExtractUserKey(iter_->key());
+    return (lower_ == nullptr || ucmp_->Compare(user_key, *lower_) >= 0) &&
+           (upper_ == nullptr || ucmp_->Compare(user_key, *upper_) < 0);
+  }
+
+  virtual void SeekToFirst() override {
+    if (lower_ == nullptr) {
+      iter_->SeekToFirst();
+    } else {
+      Seek(InternalKey(*lower_, kMaxSequenceNumber, kValueTypeForSeek)
+               .Encode());
+    }
+  }
+
+  virtual void SeekToLast() override {
+    if (upper_ == nullptr) {
+      iter_->SeekToLast();
+      return;
+    }
+    iter_->Seek(
+        InternalKey(*upper_, kMaxSequenceNumber, kValueTypeForSeek).Encode());
+    if (iter_->Valid()) {
+      iter_->Prev();
+    } else if (iter_->status().ok()) {
+      iter_->SeekToLast();
+    }
+  }
+
+  virtual void Seek(const Slice& target) override { iter_->Seek(target); }
+  virtual void Next() override { iter_->Next(); }
+  virtual void Prev() override { iter_->Prev(); }
+  virtual Slice key() const override { return iter_->key(); }
+  virtual Slice value() override { return iter_->value(); }
+  virtual Status status() const override { return iter_->status(); }
+
+ private:
+  InternalIterator* iter_;  // allocated in the same arena
+  const Comparator* ucmp_;
+  const std::string* lower_;
+  const std::string* upper_;
+};
+
+// The subflushes of a flush, claimed in turn by the flush thread and by the
+// background threads it scheduled, which may only start once all of them
+// are written and then have nothing left to do
+class SubflushQueue {
+ public:
+  explicit SubflushQueue(std::vector<std::function<void()>>&& subflushes)
+      : subflushes_(std::move(subflushes)), next_(0), done_(0), cv_(&mu_) {}
+
+  static void BGWork(void* arg) {
+    auto queue = reinterpret_cast<std::shared_ptr<SubflushQueue>*>(arg);
+    (*queue)->Run();
+    delete queue;
+  }
+
+  // Writes subflushes until none is left to claim
+  void Run() {
+    size_t i;
+    while ((i = next_.fetch_add(1, std::memory_order_relaxed)) <
+           subflushes_.size()) {
+      subflushes_[i]();
+      MutexLock l(&mu_);
+      if (++done_ == subflushes_.size()) {
+        cv_.SignalAll();
+      }
+    }
+  }
+
+  // Waits for the subflushes claimed by the other threads
+  void Wait() {
+    MutexLock l(&mu_);
+    while (done_ < subflushes_.size()) {
+      cv_.Wait();
+    }
+  }
+
+ private:
+  const std::vector<std::function<void()>> subflushes_;
+  std::atomic<size_t> next_;
+  size_t done_;
+  port::Mutex mu_;
+  port::CondVar cv_;
+};
+
+}  // namespace
+
 FlushJob::FlushJob(const std::string& dbname, ColumnFamilyData* cfd,
                    const DBOptions& db_options,
                    const MutableCFOptions& mutable_cf_options,
@@ -70,7 +214,8 @@ FlushJob::FlushJob(const std::string& dbname, ColumnFamilyData* cfd,
                    JobContext* job_context, LogBuffer* log_buffer,
                    Directory* db_directory, Directory* output_file_directory,
                    CompressionType output_compression, Statistics* stats,
-                   EventLogger* event_logger, bool measure_io_stats)
+                   EventLogger* event_logger, bool measure_io_stats,
+                   bool write_manifest)
     : dbname_(dbname),
       cfd_(cfd),
       db_options_(db_options),
@@ -88,7 +233,10 @@ FlushJob::FlushJob(const std::string& dbname, ColumnFamilyData* cfd,
       output_compression_(output_compression),
       stats_(stats),
       event_logger_(event_logger),
-      measure_io_stats_(measure_io_stats) {
+      measure_io_stats_(measure_io_stats),
+      write_manifest_(write_manifest),
+      pick_memtable_called_(false),
+      edit_(nullptr) {
   // Update the thread status to indicate flush.
   ReportStartedFlush();
   TEST_SYNC_POINT("FlushJob::FlushJob()");
@@ -125,6 +273,38 @@ void FlushJob::RecordFlushIOStats() {
   IOSTATS_RESET(bytes_written);
 }
 
+void FlushJob::PickMemTable() {
+  db_mutex_->AssertHeld();
+  assert(!pick_memtable_called_);
+  pick_memtable_called_ = true;
+  // Save the contents of the earliest memtable as a new Table
+  cfd_->imm()->PickMemtablesToFlush(&mems_);
+  if (mems_.empty()) {
+    return;
+  }
+
+  ReportFlushInputSize(mems_);
+
+  // entries mems are (implicitly) sorted in ascending order by their created
+  // time. We will use the first memtable's `edit` to keep the meta info for
+  // this flush.
+  MemTable* m = mems_[0];
+  edit_ = m->GetEdits();
+  edit_->SetPrevLogNumber(0);
+  // SetLogNumber(log_num) indicates logs with number smaller than log_num
+  // will no longer be picked up for recovery.
+  edit_->SetLogNumber(mems_.back()->GetNextLogNumber());
+  edit_->SetColumnFamily(cfd_->GetID());
+}
+
+void FlushJob::Cancel() {
+  db_mutex_->AssertHeld();
+  assert(pick_memtable_called_);
+  if (!mems_.empty()) {
+    cfd_->imm()->RollbackMemtableFlush(mems_, 0);
+  }
+}
+
 Status FlushJob::Run(FileMetaData* file_meta) {
   AutoThreadOperationStageUpdater stage_run(
       ThreadStatus::STAGE_FLUSH_RUN);
@@ -143,31 +323,17 @@ Status FlushJob::Run(FileMetaData* file_meta) {
     prev_prepare_write_nanos = IOSTATS(prepare_write_nanos);
   }
 
-  // Save the contents of the earliest memtable as a new Table
-  FileMetaData meta;
-  std::vector<MemTable*> mems;
-  cfd_->imm()->PickMemtablesToFlush(&mems);
-  if (mems.empty()) {
+  if (!pick_memtable_called_) {
+    PickMemTable();
+  }
+  if (mems_.empty()) {
     LogToBuffer(log_buffer_, "[%s] Nothing in memtable to flush",
                 cfd_->GetName().c_str());
     return Status::OK();
   }
 
-  ReportFlushInputSize(mems);
-
-  // entries mems are (implicitly) sorted in ascending order by their created
-  // time. We will use the first memtable's `edit` to keep the meta info for
-  // this flush.
-  MemTable* m = mems[0];
-  VersionEdit* edit = m->GetEdits();
-  edit->SetPrevLogNumber(0);
-  // SetLogNumber(log_num) indicates logs with number smaller than log_num
-  // will no longer be picked up for recovery.
-  edit->SetLogNumber(mems.back()->GetNextLogNumber());
-  edit->SetColumnFamily(cfd_->GetID());
-
   // This will release and re-acquire the mutex.
-  Status s = WriteLevel0Table(mems, edit, &meta);
+  Status s = WriteLevel0Table(mems_, edit_, &meta_);
 
   if (s.ok() &&
       (shutting_down_->load(std::memory_order_acquire) || cfd_->IsDropped())) {
@@ -176,18 +342,18 @@ Status FlushJob::Run(FileMetaData* file_meta) {
   }
 
   if (!s.ok()) {
-    cfd_->imm()->RollbackMemtableFlush(mems, meta.fd.GetNumber());
-  } else {
+    cfd_->imm()->RollbackMemtableFlush(mems_, meta_.fd.GetNumber());
+  } else if (write_manifest_) {
     TEST_SYNC_POINT("FlushJob::InstallResults");
     // Replace immutable memtable with the generated Table
     s = cfd_->imm()->InstallMemtableFlushResults(
-        cfd_, mutable_cf_options_, mems, versions_, db_mutex_,
-        meta.fd.GetNumber(), &job_context_->memtables_to_free, db_directory_,
+        cfd_, mutable_cf_options_, mems_, versions_, db_mutex_,
+        meta_.fd.GetNumber(), &job_context_->memtables_to_free, db_directory_,
         log_buffer_);
   }
 
   if (s.ok() && file_meta != nullptr) {
-    *file_meta = meta;
+    *file_meta = meta_;
   }
   RecordFlushIOStats();
 
@@ -235,17 +401,12 @@ Status FlushJob::WriteLevel0Table(const std::vector<MemTable*>& mems,
     if (log_buffer_) {
       log_buffer_->FlushBufferToLog();
     }
-    std::vector<InternalIterator*> memtables;
-    ReadOptions ro;
-    ro.total_order_seek = true;
-    Arena arena;
     uint64_t total_num_entries = 0, total_num_deletes = 0;
     size_t total_memory_usage = 0;
     for (MemTable* m : mems) {
       Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
           "[%s] [JOB %d] Flushing memtable with next log file: %" PRIu64 "\n",
           cfd_->GetName().c_str(), job_context_->job_id, m->GetNextLogNumber());
-      memtables.push_back(m->NewIterator(ro, &arena));
       total_num_entries += m->num_entries();
       total_num_deletes += m->num_deletes();
       total_memory_usage += m->ApproximateMemoryUsage();
@@ -258,35 +419,56 @@ Status FlushJob::WriteLevel0Table(const std::vector<MemTable*>& mems,
                          << total_num_deletes << "memory_usage"
                          << total_memory_usage;
 
-    {
-      ScopedArenaIterator iter(
-          NewMergingIterator(&cfd_->internal_comparator(), &memtables[0],
-                             static_cast<int>(memtables.size()), &arena));
-      Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
-          "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": started",
-          cfd_->GetName().c_str(), job_context_->job_id, meta->fd.GetNumber());
-
-      TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:output_compression",
-                               &output_compression_);
-      s = BuildTable(
-          dbname_, db_options_.env, *cfd_->ioptions(), mutable_cf_options_,
-          env_options_, cfd_->table_cache(), iter.get(), meta,
-          cfd_->internal_comparator(), cfd_->int_tbl_prop_collector_factories(),
-          cfd_->GetID(), cfd_->GetName(), existing_snapshots_,
-          earliest_write_conflict_snapshot_, output_compression_,
-          cfd_->ioptions()->compression_opts,
-          mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
-          TableFileCreationReason::kFlush, event_logger_, job_context_->job_id,
-          Env::IO_HIGH, &table_properties_, 0 /* level */);
-      LogFlush(db_options_.info_log);
+    TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:output_compression",
+                             &output_compression_);
+
+    // Split the key range into subflushes run in parallel, each one written
+    // to its own level-0 file.
+    std::vector<std::string> boundaries;
+    size_t max_subflushes = std::min<size_t>(
+        db_options_.max_subflushes, total_memory_usage / kMinSubflushSize);
+    if (max_subflushes > 1) {
+      PickSubflushBoundaries(mems, max_subflushes, &boundaries);
+    }
+    subflush_outputs_.resize(boundaries.size());
+    std::vector<Status> statuses(boundaries.size() + 1);
+    std::vector<std::function<void()>> subflushes;
+    subflushes.reserve(boundaries.size() + 1);
+    subflushes.emplace_back([this, &mems, &boundaries, &statuses, meta]() {
+      statuses[0] = WriteSubflush(
+          mems, nullptr, boundaries.empty() ? nullptr : &boundaries[0], meta,
+          &table_properties_);
+    });
+    for (size_t i = 0; i < boundaries.size(); i++) {
+      FileMetaData* sub_meta = &subflush_outputs_[i].meta;
+      sub_meta->fd = FileDescriptor(versions_->NewFileNumber(), 0, 0, 0);
+      const std::string* upper =
+          i + 1 < boundaries.size() ? &boundaries[i + 1] : nullptr;
+      subflushes.emplace_back([this, &mems, &boundaries, &statuses, i, upper,
+                               sub_meta]() {
+        statuses[i + 1] = WriteSubflush(mems, &boundaries[i], upper, sub_meta,
+                                        &subflush_outputs_[i].table_properties);
+      });
+    }
+
+    // The idle threads of the pool of the flushes help, while this thread
+    // writes the subflushes none of them has picked up
+    auto queue = std::make_shared<SubflushQueue>(std::move(subflushes));
+    Env::Priority pri = db_options_.max_background_flushes > 0
+                            ? Env::Priority::HIGH
+                            : Env::Priority::LOW;
+    for (size_t i = 0; i < boundaries.size(); i++) {
+      db_options_.env->Schedule(&SubflushQueue::BGWork,
+                                new std::shared_ptr<SubflushQueue>(queue),
+                                pri);
+    }
+    queue->Run();
+    queue->Wait();
+    for (const auto& status : statuses) {
+      if (s.ok()) {
+        s = status;
+      }
     }
-    Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
-        "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": %" PRIu64
-        " bytes %s"
-        "%s",
-        cfd_->GetName().c_str(), job_context_->job_id, meta->fd.GetNumber(),
-        meta->fd.GetFileSize(), s.ToString().c_str(),
-        meta->marked_for_compaction ? " (needs compaction)" : "");
 
     if (!db_options_.disableDataSync && output_file_directory_ != nullptr) {
       output_file_directory_->Fsync();
@@ -301,27 +483,142 @@ Status FlushJob::WriteLevel0Table(const std::vector<MemTable*>& mems,
 
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
-  if (s.ok() && meta->fd.GetFileSize() > 0) {
-    // if we have more than 1 background thread, then we cannot
-    // insert files directly into higher levels because some other
-    // threads could be concurrently producing compacted files for
-    // that key range.
-    // Add file to L0
-    edit->AddFile(0 /* level */, meta->fd.GetNumber(), meta->fd.GetPathId(),
-                  meta->fd.GetFileSize(), meta->smallest, meta->largest,
-                  meta->smallest_seqno, meta->largest_seqno,
-                  meta->marked_for_compaction, meta->fd.GetFileSizeTotal());  // Shichao
+  std::vector<FileMetaData*> outputs(1, meta);
+  for (auto& output : subflush_outputs_) {
+    outputs.push_back(&output.meta);
+  }
+  if (outputs.size() > 1) {
+    // the files of the subflushes make a single sorted run
+    for (auto output : outputs) {
+      output->flush_id = meta->fd.GetNumber();
+    }
+  }
+  uint64_t bytes_written = 0;
+  for (auto output : outputs) {
+    if (s.ok() && output->fd.GetFileSize() > 0) {
+      // if we have more than 1 background thread, then we cannot
+      // insert files directly into higher levels because some other
+      // threads could be concurrently producing compacted files for
+      // that key range.
+      // Add file to L0
+      edit->AddFile(0 /* level */, output->fd.GetNumber(),
+                    output->fd.GetPathId(), output->fd.GetFileSize(),
+                    output->smallest, output->largest, output->smallest_seqno,
+                    output->largest_seqno, output->marked_for_compaction,
+                    output->fd.GetFileSizeTotal(),  // Shichao
+                    output->sub_path_ids, output->blob_refs,
+                    output->flush_id);
+    }
+    bytes_written += output->fd.GetFileSize();
   }
 
   // Note that here we treat flush as level 0 compaction in internal stats
   InternalStats::CompactionStats stats(1);
   stats.micros = db_options_.env->NowMicros() - start_micros;
-  stats.bytes_written = meta->fd.GetFileSize();
+  stats.bytes_written = bytes_written;
   cfd_->internal_stats()->AddCompactionStats(0 /* level */, stats);
   cfd_->internal_stats()->AddCFStats(InternalStats::BYTES_FLUSHED,
-                                     meta->fd.GetFileSize());
+                                     bytes_written);
   RecordFlushIOStats();
   return s;
 }
 
+void FlushJob::PickSubflushBoundaries(const std::vector<MemTable*>& mems,
+                                      size_t n,
+                                      std::vector<std::string>* boundaries) {
+  // Every sampled key stands for the same share of its memtable
+  std::vector<std::pair<Slice, double>> samples;
+  for (MemTable* m : mems) {
+    std::vector<Slice> keys;
+    m->SampleUserKeys(kSamplesPerSubflush * n, &keys);
+    for (const auto& key : keys) {
+      samples.emplace_back(key, static_cast<double>(
+                                    m->ApproximateMemoryUsage()) /
+                                    keys.size());
+    }
+  }
+  if (samples.empty()) {
+    return;
+  }
+  const Comparator* ucmp = cfd_->user_comparator();
+  std::sort(samples.begin(), samples.end(),
+            [ucmp](const std::pair<Slice, double>& a,
+                   const std::pair<Slice, double>& b) {
+              return ucmp->Compare(a.first, b.first) < 0;
+            });
+  double total = 0;
+  for (const auto& sample : samples) {
+    total += sample.second;
+  }
+
+  double seen = 0;
+  size_t j = 0;
+  for (size_t i = 1; i < n; i++) {
+    double target = total * i / n;
+    while (j < samples.size() && seen < target) {
+      seen += samples[j++].second;
+    }
+    if (j == samples.size()) {
+      break;
+    }
+    // All the versions of a user key go to the same subflush
+    if (boundaries->empty() ||
+        ucmp->Compare(samples[j].first, boundaries->back()) > 0) {
+      boundaries->push_back(samples[j].first.ToString());
+    }
+  }
+}
+
+Status FlushJob::WriteSubflush(const std::vector<MemTable*>& mems,
+                               const std::string* lower,
+                               const std::string* upper, FileMetaData* meta,
+                               TableProperties* table_properties) {
+  std::vector<InternalIterator*> memtables;
+  ReadOptions ro;
+  ro.total_order_seek = true;
+  Arena arena;
+  for (MemTable* m : mems) {
+    memtables.push_back(m->NewIterator(ro, &arena));
+  }
+
+  InternalIterator* input = nullptr;
+  if (memtables.size() > 1 &&
+      SortDisjointIterators(cfd_->internal_comparator(), &memtables)) {
+    input = NewConcatenatingIterator(
+        &memtables[0], static_cast<int>(memtables.size()), &arena);
+  } else {
+    input = NewMergingIterator(&cfd_->internal_comparator(), &memtables[0],
+                               static_cast<int>(memtables.size()), &arena);
+  }
+  if (lower != nullptr || upper != nullptr) {
+    auto mem = arena.AllocateAligned(sizeof(SubflushIterator));
+    input = new (mem)
+        SubflushIterator(input, cfd_->user_comparator(), lower, upper);
+  }
+  ScopedArenaIterator iter(input);
+  Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+      "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": started",
+      cfd_->GetName().c_str(), job_context_->job_id, meta->fd.GetNumber());
+
+  Status s = BuildTable(
+      dbname_, db_options_.env, *cfd_->ioptions(), mutable_cf_options_,
+      env_options_, cfd_->table_cache(), iter.get(), meta,
+      cfd_->internal_comparator(), cfd_->int_tbl_prop_collector_factories(),
+      cfd_->GetID(), cfd_->GetName(), existing_snapshots_,
+      earliest_write_conflict_snapshot_, output_compression_,
+      cfd_->ioptions()->compression_opts,
+      mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
+      TableFileCreationReason::kFlush, event_logger_, job_context_->job_id,
+      Env::IO_HIGH, table_properties, 0 /* level */);
+  LogFlush(db_options_.info_log);
+  Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+      "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": %" PRIu64
+      " bytes %s"
+      "%s",
+      cfd_->GetName().c_str(), job_context_->job_id, meta->fd.GetNumber(),
+      meta->fd.GetFileSize(), s.ToString().c_str(),
+      meta->marked_for_compaction ? " (needs compaction)" : "");
+  return s;
+}
+
 }  // namespace vidardb
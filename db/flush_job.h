@@ -61,12 +61,29 @@ class FlushJob {
            JobContext* job_context, LogBuffer* log_buffer,
            Directory* db_directory, Directory* output_file_directory,
            CompressionType output_compression, Statistics* stats,
-           EventLogger* event_logger, bool measure_io_stats);
+           EventLogger* event_logger, bool measure_io_stats,
+           bool write_manifest = true);
 
   ~FlushJob();
 
+  // Require db_mutex held.
+  // Once PickMemTable() is called, either Run() or Cancel() has to be called.
+  void PickMemTable();
   Status Run(FileMetaData* file_meta = nullptr);
+  void Cancel();
   TableProperties GetTableProperties() const { return table_properties_; }
+  const std::vector<MemTable*>& GetMemTables() const { return mems_; }
+  const FileMetaData& GetFileMetaData() const { return meta_; }
+
+  // The level-0 files written by the subflushes after the first one, whose
+  // output is GetFileMetaData().
+  struct SubflushOutput {
+    FileMetaData meta;
+    TableProperties table_properties;
+  };
+  const std::vector<SubflushOutput>& GetSubflushOutputs() const {
+    return subflush_outputs_;
+  }
 
  private:
   void ReportStartedFlush();
@@ -74,6 +91,21 @@ class FlushJob {
   void RecordFlushIOStats();
   Status WriteLevel0Table(const std::vector<MemTable*>& mems, VersionEdit* edit,
                           FileMetaData* meta);
+  // Picks up to n - 1 user keys splitting the memtables into n key ranges
+  // of similar sizes, from keys sampled evenly in each memtable.
+  void PickSubflushBoundaries(const std::vector<MemTable*>& mems, size_t n,
+                              std::vector<std::string>* boundaries);
+  // Writes the entries of the memtables with user keys in [*lower, *upper)
+  // to a level-0 file, an absent bound being unbounded.
+  Status WriteSubflush(const std::vector<MemTable*>& mems,
+                       const std::string* lower, const std::string* upper,
+                       FileMetaData* meta, TableProperties* table_properties);
+
+  // A subflush writes at least this much of the memtables
+  static const size_t kMinSubflushSize = 1 << 20;
+  // Keys sampled from each memtable per subflush to split them
+  static const size_t kSamplesPerSubflush = 16;
+
   const std::string& dbname_;
   ColumnFamilyData* cfd_;
   const DBOptions& db_options_;
@@ -93,6 +125,14 @@ class FlushJob {
   EventLogger* event_logger_;
   TableProperties table_properties_;
   bool measure_io_stats_;
+  // False when the caller commits the results itself, e.g. together with
+  // the flushes of other column families.
+  const bool write_manifest_;
+  bool pick_memtable_called_;
+  std::vector<MemTable*> mems_;
+  VersionEdit* edit_;
+  FileMetaData meta_;
+  std::vector<SubflushOutput> subflush_outputs_;
 };
 
 }  // namespace vidardb
@@ -147,6 +147,7 @@ static const std::string aggregated_table_properties_at_level =
     aggregated_table_properties + "-at-level";
 static const std::string num_running_compactions = "num-running-compactions";
 static const std::string num_running_flushes = "num-running-flushes";
+static const std::string compaction_time_share = "compaction-time-share";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
                       vidardb_prefix + num_files_at_level_prefix;
@@ -167,6 +168,8 @@ const std::string DB::Properties::kCompactionPending =
                       vidardb_prefix + compaction_pending;
 const std::string DB::Properties::kNumRunningCompactions =
     vidardb_prefix + num_running_compactions;
+const std::string DB::Properties::kCompactionTimeShare =
+    vidardb_prefix + compaction_time_share;
 const std::string DB::Properties::kNumRunningFlushes =
     vidardb_prefix + num_running_flushes;
 const std::string DB::Properties::kBackgroundErrors =
@@ -278,6 +281,8 @@ const std::unordered_map<std::string,
      {false, nullptr, &InternalStats::HandleNumRunningFlushes}},
     {DB::Properties::kNumRunningCompactions,
      {false, nullptr, &InternalStats::HandleNumRunningCompactions}},
+    {DB::Properties::kCompactionTimeShare,
+     {false, nullptr, &InternalStats::HandleCompactionTimeShare}},
 };
 
 const DBPropertyInfo* GetPropertyInfo(const Slice& property) {
@@ -455,6 +460,16 @@ bool InternalStats::HandleNumRunningCompactions(uint64_t* value, DBImpl* db,
   return true;
 }
 
+bool InternalStats::HandleCompactionTimeShare(uint64_t* value, DBImpl* db,
+                                              Version* version) {
+  uint64_t total = 0;
+  for (auto cfd : *db->versions_->GetColumnFamilySet()) {
+    total += cfd->internal_stats()->GetCFStats(COMPACTION_MICROS);
+  }
+  *value = (total == 0) ? 0 : cf_stats_value_[COMPACTION_MICROS] * 100 / total;
+  return true;
+}
+
 bool InternalStats::HandleBackgroundErrors(uint64_t* value, DBImpl* db,
                                            Version* version) {
   // Accumulated number of  errors in background flushes or compactions.
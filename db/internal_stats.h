@@ -59,6 +59,7 @@ class InternalStats {
     HARD_PENDING_COMPACTION_BYTES_LIMIT,
     WRITE_STALLS_ENUM_MAX,
     BYTES_FLUSHED,
+    COMPACTION_MICROS,
     INTERNAL_CF_STATS_ENUM_MAX,
   };
 
@@ -212,6 +213,10 @@ class InternalStats {
     ++cf_stats_count_[type];
   }
 
+  uint64_t GetCFStats(InternalCFStatsType type) const {
+    return cf_stats_value_[type];
+  }
+
   void AddDBStats(InternalDBStatsType type, uint64_t value) {
     auto& v = db_stats_[type];
     v.store(v.load(std::memory_order_relaxed) + value,
@@ -328,6 +333,8 @@ class InternalStats {
                                   Version* version);
   bool HandleNumRunningFlushes(uint64_t* value, DBImpl* db, Version* version);
   bool HandleCompactionPending(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleCompactionTimeShare(uint64_t* value, DBImpl* db,
+                                 Version* version);
   bool HandleNumRunningCompactions(uint64_t* value, DBImpl* db,
                                    Version* version);
   bool HandleBackgroundErrors(uint64_t* value, DBImpl* db, Version* version);
@@ -388,6 +395,7 @@ class InternalStats {
     HARD_PENDING_COMPACTION_BYTES_LIMIT,
     WRITE_STALLS_ENUM_MAX,
     BYTES_FLUSHED,
+    COMPACTION_MICROS,
     INTERNAL_CF_STATS_ENUM_MAX,
   };
 
@@ -433,6 +441,8 @@ class InternalStats {
 
   void AddCFStats(InternalCFStatsType type, uint64_t value) {}
 
+  uint64_t GetCFStats(InternalCFStatsType type) const { return 0; }
+
   void AddDBStats(InternalDBStatsType type, uint64_t value) {}
 
   HistogramImpl* GetFileReadHist(int level) { return nullptr; }
@@ -50,6 +50,9 @@ struct JobContext {
   // the list of all live sst files that cannot be deleted
   std::vector<FileDescriptor> sst_live;
 
+  // the list of all blob files referenced by live sst files
+  std::vector<uint64_t> blob_live;
+
   // a list of sst files that we need to delete
   std::vector<FileMetaData*> sst_delete_files;
 
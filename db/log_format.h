@@ -11,6 +11,13 @@
 // See ../doc/log_format.txt for more detail.
 
 #pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "util/xxhash.h"
+#include "vidardb/options.h"
+
 namespace vidardb {
 namespace log {
 
@@ -41,5 +48,22 @@ static const int kHeaderSize = 4 + 1 + 2;
 // (4 bytes), length (2 bytes).
 static const int kRecyclableHeaderSize = 4 + 1 + 4 + 2;
 
+// The type byte of a record holds its RecordType in the low bits and its
+// ChecksumType in the high bits, 0 (crc32c) in the files written before.
+static const int kRecordTypeBits = 4;
+static const unsigned int kRecordTypeMask = (1u << kRecordTypeBits) - 1;
+
+// The xxHash checksum of a record, from its type byte to the end of the
+// header, and its payload
+inline uint32_t XXHashRecord(ChecksumType type, const char* header, size_t n,
+                             const char* payload, size_t length) {
+  if (type == kxxHash64) {
+    return static_cast<uint32_t>(xxhash::XXH64(header, n, 0) ^
+                                 xxhash::XXH64(payload, length, 0));
+  }
+  return static_cast<uint32_t>(xxhash::XXH3_64bits(header, n) ^
+                               xxhash::XXH3_64bits(payload, length));
+}
+
 }  // namespace log
 }  // namespace vidardb
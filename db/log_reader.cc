@@ -352,7 +352,16 @@ unsigned int Reader::ReadPhysicalRecord(Slice* result, size_t* drop_size) {
     const char* header = buffer_.data();
     const uint32_t a = static_cast<uint32_t>(header[4]) & 0xff;
     const uint32_t b = static_cast<uint32_t>(header[5]) & 0xff;
-    const unsigned int type = header[6];
+    // The high bits of the type byte name the checksum of the record only
+    // if they are an xxHash one. Any other byte, as in the logs written
+    // before, is the record type of a crc32c record.
+    unsigned int type = static_cast<unsigned char>(header[6]);
+    ChecksumType checksum_type = kCRC32c;
+    if ((type >> kRecordTypeBits) == kxxHash64 ||
+        (type >> kRecordTypeBits) == kXXH3) {
+      checksum_type = static_cast<ChecksumType>(type >> kRecordTypeBits);
+      type &= kRecordTypeMask;
+    }
     const uint32_t length = a | (b << 8);
     int header_size = kHeaderSize;
     if (type >= kRecyclableFullType && type <= kRecyclableLastType) {
@@ -400,8 +409,15 @@ unsigned int Reader::ReadPhysicalRecord(Slice* result, size_t* drop_size) {
 
     // Check crc
     if (checksum_) {
-      uint32_t expected_crc = crc32c::Unmask(DecodeFixed32(header));
-      uint32_t actual_crc = crc32c::Value(header + 6, length + header_size - 6);
+      uint32_t expected_crc = DecodeFixed32(header);
+      uint32_t actual_crc;
+      if (checksum_type == kCRC32c) {
+        expected_crc = crc32c::Unmask(expected_crc);
+        actual_crc = crc32c::Value(header + 6, length + header_size - 6);
+      } else {
+        actual_crc = XXHashRecord(checksum_type, header + 6, header_size - 6,
+                                  header + header_size, length);
+      }
       if (actual_crc != expected_crc) {
         // Drop the rest of the buffer since "length" itself may have
         // been corrupted and if we trust it, we could find some
@@ -19,11 +19,15 @@ namespace vidardb {
 namespace log {
 
 Writer::Writer(unique_ptr<WritableFileWriter>&& dest,
-               uint64_t log_number, bool recycle_log_files)
+               uint64_t log_number, bool recycle_log_files,
+               ChecksumType checksum)
     : dest_(std::move(dest)),
       block_offset_(0),
       log_number_(log_number),
-      recycle_log_files_(recycle_log_files) {
+      recycle_log_files_(recycle_log_files),
+      checksum_(checksum) {
+  assert(checksum_ == kCRC32c || checksum_ == kxxHash64 ||
+         checksum_ == kXXH3);
   for (int i = 0; i <= kMaxRecordType; i++) {
     char t = static_cast<char>(i);
     type_crc_[i] = crc32c::Value(&t, 1);
@@ -96,7 +100,7 @@ Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   // Format the header
   buf[4] = static_cast<char>(n & 0xff);
   buf[5] = static_cast<char>(n >> 8);
-  buf[6] = static_cast<char>(t);
+  buf[6] = static_cast<char>(t | (checksum_ << kRecordTypeBits));
 
   uint32_t crc = type_crc_[t];
   if (t < kRecyclableFullType) {
@@ -114,12 +118,18 @@ Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
     // even if it were we'dbe far more likely to see a false positive
     // on the 32-bit CRC.
     EncodeFixed32(buf + 7, static_cast<uint32_t>(log_number_));
-    crc = crc32c::Extend(crc, buf + 7, 4);
+    if (checksum_ == kCRC32c) {
+      crc = crc32c::Extend(crc, buf + 7, 4);
+    }
   }
 
-  // Compute the crc of the record type and the payload.
-  crc = crc32c::Extend(crc, ptr, n);
-  crc = crc32c::Mask(crc);  // Adjust for storage
+  if (checksum_ == kCRC32c) {
+    // Compute the crc of the record type and the payload.
+    crc = crc32c::Extend(crc, ptr, n);
+    crc = crc32c::Mask(crc);  // Adjust for storage
+  } else {
+    crc = XXHashRecord(checksum_, buf + 6, header_size - 6, ptr, n);
+  }
   EncodeFixed32(buf, crc);
 
   // Write the header and the payload
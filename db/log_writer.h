@@ -13,6 +13,7 @@
 #include <memory>
 
 #include "db/log_format.h"
+#include "vidardb/options.h"
 #include "vidardb/slice.h"
 #include "vidardb/status.h"
 
@@ -66,14 +67,19 @@ namespace log {
  * Same as above, with the addition of
  * Log number = 32bit log file number, so that we can distinguish between
  * records written by the most recent log writer vs a previous one.
+ *
+ * The high bits of Type hold the ChecksumType of the record, 0 for crc32c.
+ * The xxHash ones cover the same bytes as the CRC.
  */
 class Writer {
  public:
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
+  // The records are checksummed with "checksum".
   explicit Writer(unique_ptr<WritableFileWriter>&& dest,
-                  uint64_t log_number, bool recycle_log_files);
+                  uint64_t log_number, bool recycle_log_files,
+                  ChecksumType checksum = kCRC32c);
   ~Writer();
 
   Status AddRecord(const Slice& slice);
@@ -86,6 +92,7 @@ class Writer {
   size_t block_offset_;       // Current offset in block
   uint64_t log_number_;
   bool recycle_log_files_;
+  const ChecksumType checksum_;
 
   // crc32c values for all supported record types.  These are
   // pre-computed to reduce the overhead of computing the crc of the
@@ -0,0 +1,26 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include "vidardb/types.h"
+
+namespace vidardb {
+
+// Called by the write thread once the sequence numbers of a batch are
+// assigned, before the batch is inserted into the memtables and made
+// visible to the reads. A write with such a callback reserves one more
+// sequence number at the end of its write group, so that the group is
+// always published above the last sequence number seen before it.
+class PreReleaseCallback {
+ public:
+  virtual ~PreReleaseCallback() {}
+
+  // seq is the sequence number of the first entry of the batch, last_seq the
+  // one the write group is published at.
+  virtual void Callback(SequenceNumber seq, SequenceNumber last_seq) = 0;
+};
+
+}  // namespace vidardb
@@ -0,0 +1,244 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "db/range_sampler.h"
+
+#include <algorithm>
+
+#include "db/column_family.h"
+#include "db/dbformat.h"
+#include "db/table_cache.h"
+#include "db/version_set.h"
+#include "memtable/memtable.h"
+#include "memtable/memtable_list.h"
+#include "table/scoped_arena_iterator.h"
+#include "table/table_reader.h"
+#include "util/arena.h"
+
+namespace vidardb {
+
+namespace {
+
+// Picks of an already picked block before giving up
+const int kMaxPickAttempts = 64;
+
+// Memory of a memtable per block, about the default block size of the tables
+const size_t kMemTableBlockSize = 4096;
+
+}  // namespace
+
+RangeSampler::RangeSampler(SuperVersion* sv, const EnvOptions& env_options,
+                           const Range& range, uint64_t seed)
+    : version_(sv->current),
+      env_options_(env_options),
+      ucmp_(sv->current->cfd()->user_comparator()),
+      from_min_(range.start.compare(kRangeQueryMin) == 0),
+      to_max_(range.limit.compare(kRangeQueryMax) == 0),
+      start_(range.start.ToString()),
+      limit_(range.limit.ToString()),
+      rnd_(seed) {
+  InternalKey k1(range.start, kMaxSequenceNumber, kValueTypeForSeek);
+  // the last internal key of range.limit
+  InternalKey k2(range.limit, 0, static_cast<ValueType>(0));
+  TableCache* table_cache = version_->cfd()->table_cache();
+  VersionStorageInfo* vstorage = version_->storage_info();
+  uint64_t weight = 0;
+  for (int level = 0; level < vstorage->num_non_empty_levels(); level++) {
+    std::vector<FileMetaData*> files;
+    vstorage->GetOverlappingInputs(level, from_min_ ? nullptr : &k1,
+                                   to_max_ ? nullptr : &k2, &files, -1,
+                                   nullptr, false);
+    for (const auto& f : files) {
+      // Only the files at the ends of the range of a level are weighted by
+      // the part of them within range, which needs their table reader.
+      uint64_t size = f->fd.GetFileSizeTotal();
+      bool start_inside =
+          !from_min_ && ucmp_->Compare(start_, f->smallest.user_key()) > 0;
+      bool limit_inside =
+          !to_max_ && ucmp_->Compare(limit_, f->largest.user_key()) < 0;
+      if (start_inside || limit_inside) {
+        Cache::Handle* handle = nullptr;
+        status_ = table_cache->FindTable(env_options_,
+                                         version_->cfd()->internal_comparator(),
+                                         f->fd, &handle);
+        if (!status_.ok()) {
+          files_.clear();
+          return;
+        }
+        TableReader* reader = table_cache->GetTableReaderFromHandle(handle);
+        uint64_t lo = start_inside ? reader->ApproximateOffsetOf(k1.Encode())
+                                   : 0;
+        uint64_t hi = limit_inside ? reader->ApproximateOffsetOf(k2.Encode())
+                                   : size;
+        table_cache->ReleaseHandle(handle);
+        size = hi > lo ? hi - lo : 0;
+      }
+      // every file overlapping the range may hold some rows of it
+      weight += std::max<uint64_t>(size, 1);
+      files_.push_back(
+          {f, nullptr, weight, false, f->smallest.user_key().ToString(), {},
+           0, 0});
+    }
+  }
+
+  AddMemTable(sv->mem, &weight);
+  for (MemTable* mem : sv->imm->GetMemTables()) {
+    AddMemTable(mem, &weight);
+  }
+}
+
+void RangeSampler::AddMemTable(MemTable* mem, uint64_t* weight) {
+  if (mem->num_entries() == 0) {
+    return;
+  }
+  Arena arena;
+  ScopedArenaIterator iter(mem->NewIterator(ReadOptions(), &arena));
+  iter->SeekToFirst();
+  if (!iter->Valid()) {
+    return;
+  }
+  std::string smallest = ExtractUserKey(iter->key()).ToString();
+  iter->SeekToLast();
+  std::string largest = ExtractUserKey(iter->key()).ToString();
+  if ((!from_min_ && ucmp_->Compare(largest, start_) < 0) ||
+      (!to_max_ && ucmp_->Compare(smallest, limit_) > 0)) {
+    return;
+  }
+
+  InternalKey k1(from_min_ ? Slice(smallest) : Slice(start_),
+                 kMaxSequenceNumber, kValueTypeForSeek);
+  InternalKey k2(to_max_ ? Slice(largest) : Slice(limit_), 0,
+                 static_cast<ValueType>(0));
+  uint64_t size = mem->ApproximateSize(k1.Encode(), k2.Encode());
+  *weight += std::max<uint64_t>(size, 1);
+  files_.push_back({nullptr, mem, *weight, false, smallest, {}, 0, 0});
+}
+
+Status RangeSampler::Load(File* file) {
+  if (file->mem != nullptr) {
+    LoadMemTable(file);
+  } else {
+    TableCache* table_cache = version_->cfd()->table_cache();
+    Cache::Handle* handle = nullptr;
+    Status s = table_cache->FindTable(env_options_,
+                                      version_->cfd()->internal_comparator(),
+                                      file->meta->fd, &handle);
+    if (!s.ok()) {
+      return s;
+    }
+    std::vector<std::string> keys;
+    s = table_cache->GetTableReaderFromHandle(handle)->GetDataBlockIndexKeys(
+        &keys);
+    table_cache->ReleaseHandle(handle);
+    if (s.IsNotSupported()) {
+      keys.clear();
+      s = Status::OK();
+    }
+    if (!s.ok()) {
+      return s;
+    }
+
+    for (auto& key : keys) {
+      key = ExtractUserKey(key).ToString();
+    }
+    if (keys.empty()) {
+      // the whole file as a single block
+      keys.push_back(file->meta->largest.user_key().ToString());
+    }
+    file->keys.swap(keys);
+  }
+
+  // From the first block whose last key may be at or after start, to the
+  // first one whose last key may be at or after limit
+  auto cmp = [this](const std::string& a, const std::string& b) {
+    return ucmp_->Compare(a, b) < 0;
+  };
+  size_t n = file->keys.size();
+  file->first = 0;
+  if (!from_min_) {
+    file->first = std::lower_bound(file->keys.begin(), file->keys.end(),
+                                   start_, cmp) - file->keys.begin();
+    file->first = std::min(file->first, n - 1);
+  }
+  file->last = n - 1;
+  if (!to_max_) {
+    file->last = std::lower_bound(file->keys.begin() + file->first,
+                                  file->keys.end(), limit_, cmp) -
+                 file->keys.begin();
+    file->last = std::min(file->last, n - 1);
+  }
+  file->loaded = true;
+  return Status::OK();
+}
+
+void RangeSampler::LoadMemTable(File* file) {
+  MemTable* mem = file->mem;
+  std::vector<Slice> sampled;
+  mem->SampleUserKeys(
+      std::max<size_t>(mem->ApproximateMemoryUsage() / kMemTableBlockSize, 1),
+      &sampled);
+  // The sampled keys end the blocks, up to the last key of the memtable
+  Arena arena;
+  ScopedArenaIterator iter(mem->NewIterator(ReadOptions(), &arena));
+  iter->SeekToLast();
+  std::string largest = iter->Valid() ? ExtractUserKey(iter->key()).ToString()
+                                      : file->smallest;
+  for (const auto& key : sampled) {
+    if (ucmp_->Compare(key, largest) >= 0) {
+      break;
+    }
+    if (file->keys.empty() || ucmp_->Compare(key, file->keys.back()) > 0) {
+      file->keys.push_back(key.ToString());
+    }
+  }
+  file->keys.push_back(largest);
+}
+
+bool RangeSampler::Next(std::string* start, bool* start_included,
+                        std::string* limit) {
+  for (int attempt = 0; attempt < kMaxPickAttempts; attempt++) {
+    if (!status_.ok() || files_.empty()) {
+      return false;
+    }
+
+    uint64_t w = rnd_.Uniform(files_.back().weight);
+    size_t i = std::upper_bound(files_.begin(), files_.end(), w,
+                                [](uint64_t v, const File& f) {
+                                  return v < f.weight;
+                                }) -
+               files_.begin();
+    File& file = files_[i];
+    if (!file.loaded) {
+      status_ = Load(&file);
+      if (!status_.ok()) {
+        return false;
+      }
+    }
+    size_t j = file.first + rnd_.Uniform(file.last - file.first + 1);
+    if (!picked_.insert(std::make_pair(i, j)).second) {
+      continue;
+    }
+
+    if (j == 0) {
+      *start = file.smallest;
+      *start_included = true;
+    } else {
+      *start = file.keys[j - 1];
+      *start_included = false;
+    }
+    *limit = file.keys[j];
+    if (!from_min_ && ucmp_->Compare(*start, start_) < 0) {
+      *start = start_;
+      *start_included = true;
+    }
+    if (!to_max_ && ucmp_->Compare(*limit, limit_) > 0) {
+      *limit = limit_;
+    }
+    return true;
+  }
+  return false;
+}
+
+}  // namespace vidardb
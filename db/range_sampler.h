@@ -0,0 +1,83 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "util/random.h"
+#include "vidardb/db.h"
+#include "vidardb/env.h"
+#include "vidardb/status.h"
+
+namespace vidardb {
+
+class MemTable;
+class Version;
+struct FileMetaData;
+struct SuperVersion;
+
+// Picks random data blocks, without replacement, among the ones overlapping a
+// key range in the files and the memtables of a super version. A file is
+// picked in proportion to its size, then one of its blocks uniformly, so that
+// every row has about the same chance to be in a picked block whatever its
+// level. Only the index blocks of the picked files are read. A memtable is
+// weighted the same way, by its entries within range times their average
+// size, and its blocks are key ranges between entries sampled from it.
+//
+// REQUIRES: the super version is referenced while the sampler is in use
+class RangeSampler {
+ public:
+  RangeSampler(SuperVersion* sv, const EnvOptions& env_options,
+               const Range& range, uint64_t seed);
+
+  // False if no file nor memtable overlaps the range.
+  bool empty() const { return files_.empty(); }
+
+  // Sets the user keys of a new random data block, clipped to the range: its
+  // rows are the ones after *start, or from it if *start_included, up to
+  // *limit included. Returns false once no new block is found, or on error.
+  bool Next(std::string* start, bool* start_included, std::string* limit);
+
+  Status status() const { return status_; }
+
+ private:
+  struct File {
+    FileMetaData* meta;  // nullptr for a memtable
+    MemTable* mem;
+    uint64_t weight;  // cumulated size of this file and the previous ones
+    bool loaded;
+    std::string smallest;  // user key of the first row
+    // User keys of the index entries of the data blocks
+    std::vector<std::string> keys;
+    // The blocks overlapping the range
+    size_t first;
+    size_t last;
+  };
+
+  void AddMemTable(MemTable* mem, uint64_t* weight);
+
+  Status Load(File* file);
+
+  void LoadMemTable(File* file);
+
+  Version* const version_;
+  const EnvOptions& env_options_;
+  const Comparator* const ucmp_;
+  const bool from_min_;
+  const bool to_max_;
+  const std::string start_;
+  const std::string limit_;
+  std::vector<File> files_;
+  std::set<std::pair<size_t, size_t>> picked_;
+  Random64 rnd_;
+  Status status_;
+};
+
+}  // namespace vidardb
@@ -0,0 +1,23 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include "vidardb/types.h"
+
+namespace vidardb {
+
+// Hides from a read some of the entries at or below its snapshot, e.g. the
+// ones of transactions not committed as of the snapshot. The older entries
+// of the same key are then read in their place.
+class ReadCallback {
+ public:
+  virtual ~ReadCallback() {}
+
+  // Whether the entry of sequence number seq is visible to the read
+  virtual bool IsVisible(SequenceNumber seq) = 0;
+};
+
+}  // namespace vidardb
@@ -32,15 +32,21 @@
 //
 // Every log file that is active is replayed. All sections of the file where the
 // checksum does not match is skipped over. We intentionally give preference to
-// data consistency.
+// data consistency. The logs are converted in parallel, each to its own table.
 //
 // (c) Extract metadata
 //
-// We scan every table to compute
+// We get from every table
 // (1) smallest/largest for the table
-// (2) largest sequence number in the table
+// (2) smallest/largest sequence number in the table
+// (3) the sizes and placement of the sub column files of a column table
+// (4) the blob files referenced by the table
 //
-// If we are unable to scan the file, then we ignore the table.
+// from its properties and its first and last keys if the properties record
+// the sequence numbers and no blob reference, otherwise by scanning the whole
+// table. The sub column files are verified by their footer and index when the
+// table is opened, and read in full by a scan only. The tables are processed
+// in parallel. If we are unable to read the file, then we ignore the table.
 //
 // (d) Write Descriptor
 //
@@ -59,9 +65,6 @@
 //       else place in level-M.
 //   (d) We can provide options for time consistent recovery and unsafe recovery
 //       (ignore checksum failure when applicable)
-// Possible optimization 2:
-//   Store per-table metadata (smallest, largest, largest-seq#, ...)
-//   in the table's meta section to speed up ScanTable.
 
 #ifndef VIDARDB_LITE
 
@@ -70,6 +73,12 @@
 #endif
 
 #include <inttypes.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "db/blob_file.h"
 #include "db/builder.h"
 #include "db/db_impl.h"
 #include "db/dbformat.h"
@@ -78,6 +87,7 @@
 #include "db/log_writer.h"
 #include "memtable/memtable.h"
 #include "db/table_cache.h"
+#include "db/table_properties_collector.h"
 #include "db/version_edit.h"
 #include "db/writebuffer.h"
 #include "db/write_batch_internal.h"
@@ -86,8 +96,14 @@
 #include "vidardb/env.h"
 #include "vidardb/options.h"
 #include "vidardb/immutable_options.h"
+#include "table/block.h"
+#include "table/column_table_builder.h"
+#include "table/format.h"
+#include "table/meta_blocks.h"
 #include "table/scoped_arena_iterator.h"
+#include "table/table_properties_internal.h"
 #include "util/file_reader_writer.h"
+#include "util/sync_point.h"
 
 namespace vidardb {
 
@@ -210,20 +226,56 @@ class Repairer {
     return Status::OK();
   }
 
+  // Runs work(0), ..., work(n-1) on up to max_file_opening_threads threads
+  void RunInParallel(size_t n, const std::function<void(size_t)>& work) {
+    std::atomic<size_t> next(0);
+    std::function<void()> run = [&]() {
+      for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+        work(i);
+      }
+    };
+    size_t max_threads = std::min(
+        n, static_cast<size_t>(std::max(options_.max_file_opening_threads, 1)));
+    if (max_threads <= 1) {
+      run();
+      return;
+    }
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < max_threads; i++) {
+      threads.emplace_back(run);
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
   void ConvertLogFilesToTables() {
+    // The tables are numbered in the order of the logs
+    std::sort(logs_.begin(), logs_.end());
+    std::vector<FileDescriptor> fds(logs_.size());
     for (size_t i = 0; i < logs_.size(); i++) {
+      fds[i] = FileDescriptor(next_file_number_++, 0, 0, 0);
+    }
+    RunInParallel(logs_.size(), [&](size_t i) {
       std::string logname = LogFileName(dbname_, logs_[i]);
-      Status status = ConvertLogToTable(logs_[i]);
+      Status status = ConvertLogToTable(logs_[i], &fds[i]);
       if (!status.ok()) {
         Log(InfoLogLevel::WARN_LEVEL, options_.info_log,
             "Log #%" PRIu64 ": ignoring conversion error: %s", logs_[i],
             status.ToString().c_str());
       }
       ArchiveFile(logname);
+    });
+    for (const auto& fd : fds) {
+      if (fd.GetFileSize() > 0) {
+        table_fds_.push_back(fd);
+      }
     }
   }
 
-  Status ConvertLogToTable(uint64_t log) {
+  // Writes the table fd->GetNumber() and sets *fd to it, left with no size
+  // if the log is not converted
+  Status ConvertLogToTable(uint64_t log, FileDescriptor* fd) {
     struct LogReporter : public log::Reader::Reporter {
       Env* env;
       std::shared_ptr<Logger> info_log;
@@ -236,6 +288,8 @@ class Repairer {
       }
     };
 
+    TEST_SYNC_POINT_CALLBACK("Repairer::ConvertLogToTable", &log);
+
     // Open the log file
     std::string logname = LogFileName(dbname_, log);
     unique_ptr<SequentialFile> lfile;
@@ -290,7 +344,7 @@ class Repairer {
     // Do not record a version edit for this conversion to a Table
     // since ExtractMetaData() will also generate edits.
     FileMetaData meta;
-    meta.fd = FileDescriptor(next_file_number_++, 0, 0, 0);  // Shichao
+    meta.fd = *fd;
     {
       ReadOptions ro;
       ro.total_order_seek = true;
@@ -310,9 +364,7 @@ class Repairer {
     delete cf_mems_default;
     mem = nullptr;
     if (status.ok()) {
-      if (meta.fd.GetFileSize() > 0) {
-        table_fds_.push_back(meta.fd);
-      }
+      *fd = meta.fd;
     }
     Log(InfoLogLevel::INFO_LEVEL, options_.info_log,
         "Log #%" PRIu64 ": %d ops saved to Table #%" PRIu64 " %s",
@@ -321,11 +373,15 @@ class Repairer {
   }
 
   void ExtractMetaData() {
-    for (size_t i = 0; i < table_fds_.size(); i++) {
-      TableInfo t;
-      t.meta.fd = table_fds_[i];
-      Status status = ScanTable(&t);
-      if (!status.ok()) {
+    std::vector<TableInfo> tables(table_fds_.size());
+    std::vector<Status> statuses(table_fds_.size());
+    RunInParallel(table_fds_.size(), [&](size_t i) {
+      tables[i].meta.fd = table_fds_[i];
+      statuses[i] = ScanTable(&tables[i]);
+    });
+    for (size_t i = 0; i < tables.size(); i++) {
+      const TableInfo& t = tables[i];
+      if (!statuses[i].ok()) {
         std::string fname = TableFileName(
             options_.db_paths, t.meta.fd.GetNumber(), t.meta.fd.GetPathId());
         char file_num_buf[kFormatFileNumberBufSize];
@@ -333,7 +389,7 @@ class Repairer {
                          file_num_buf, sizeof(file_num_buf));
         Log(InfoLogLevel::WARN_LEVEL, options_.info_log,
             "Table #%s: ignoring %s", file_num_buf,
-            status.ToString().c_str());
+            statuses[i].ToString().c_str());
         ArchiveFile(fname);
       } else {
         tables_.push_back(t);
@@ -344,48 +400,179 @@ class Repairer {
   Status ScanTable(TableInfo* t) {
     std::string fname = TableFileName(options_.db_paths, t->meta.fd.GetNumber(),
                                       t->meta.fd.GetPathId());
-    int counter = 0;
+    uint64_t counter = 0;
     uint64_t file_size;
+    uint64_t file_size_total = 0;
+    bool column = false;
+    bool from_properties = false;
     Status status = env_->GetFileSize(fname, &file_size);
+    if (status.ok()) {
+      file_size_total = file_size;
+      status = ReadSubFiles(fname, file_size, &file_size_total,
+                            &t->meta.sub_path_ids, &column);
+    }
     t->meta.fd = FileDescriptor(t->meta.fd.GetNumber(), t->meta.fd.GetPathId(),
-                                file_size, file_size);  // Shichao
+                                file_size, file_size_total);  // Shichao
+    std::shared_ptr<const TableProperties> props;
     if (status.ok()) {
-      InternalIterator* iter = table_cache_->NewIterator(
-          ReadOptions(), env_options_, icmp_, t->meta.fd);
-      bool empty = true;
-      ParsedInternalKey parsed;
-      t->min_sequence = 0;
-      t->max_sequence = 0;
-      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
-        Slice key = iter->key();
-        if (!ParseInternalKey(key, &parsed)) {
-          Log(InfoLogLevel::ERROR_LEVEL,
-              options_.info_log, "Table #%" PRIu64 ": unparsable key %s",
-              t->meta.fd.GetNumber(), EscapeString(key).c_str());
-          continue;
-        }
+      status = table_cache_->GetTableProperties(env_options_, icmp_,
+                                                t->meta.fd, &props);
+    }
+    if (status.ok() && props == nullptr && column) {
+      // the column tables need the number of rows to be read
+      status = Status::Corruption("missing table properties");
+    }
+    if (status.ok() && props != nullptr) {
+      status = ReadTableBounds(t, *props);
+      from_properties = status.ok();
+      if (from_properties) {
+        counter = props->num_entries;
+      } else if (status.IsNotSupported()) {
+        status = Status::OK();
+      }
+    }
+    if (status.ok() && !from_properties) {
+      status = ScanTableEntries(t, &counter);
+    }
+    TEST_SYNC_POINT_CALLBACK("Repairer::ScanTable:FromProperties",
+                             &from_properties);
+    Log(InfoLogLevel::INFO_LEVEL,
+        options_.info_log, "Table #%" PRIu64 ": %" PRIu64 " entries%s %s",
+        t->meta.fd.GetNumber(), counter,
+        from_properties ? " (from properties)" : "",
+        status.ToString().c_str());
+    return status;
+  }
 
-        counter++;
-        if (empty) {
-          empty = false;
-          t->meta.smallest.DecodeFrom(key);
-        }
-        t->meta.largest.DecodeFrom(key);
-        if (parsed.sequence < t->min_sequence) {
-          t->min_sequence = parsed.sequence;
-        }
-        if (parsed.sequence > t->max_sequence) {
-          t->max_sequence = parsed.sequence;
-        }
+  // Adds the sizes of the sub column files of a column table to
+  // *file_size_total, and sets *sub_path_ids to their placement if the table
+  // records it.
+  Status ReadSubFiles(const std::string& fname, uint64_t file_size,
+                      uint64_t* file_size_total,
+                      std::vector<uint32_t>* sub_path_ids, bool* column) {
+    *column = false;
+    unique_ptr<RandomAccessFile> file;
+    Status s = env_->NewRandomAccessFile(fname, &file, env_options_);
+    if (!s.ok()) {
+      return s;
+    }
+    RandomAccessFileReader file_reader(std::move(file), env_);
+    Footer footer;
+    s = ReadFooterFromFile(&file_reader, file_size, &footer);
+    if (!s.ok() || footer.table_magic_number() != kColumnTableMagicNumber) {
+      return s;
+    }
+
+    BlockContents meta_contents;
+    s = ReadBlockContents(&file_reader, footer, ReadOptions(),
+                          footer.metaindex_handle(), &meta_contents, env_,
+                          false /* do decompression */);
+    if (!s.ok()) {
+      return s;
+    }
+    Block meta(std::move(meta_contents));
+    std::unique_ptr<InternalIterator> meta_iter(
+        meta.NewIterator(BytewiseComparator()));
+    s = SeekToColumnBlock(meta_iter.get(), column);
+    if (!s.ok() || !*column) {
+      return s;
+    }
+    uint32_t column_count;
+    std::vector<uint64_t> file_sizes;
+    std::vector<uint32_t> path_ids;
+    s = ReadMetaColumnBlock(meta_iter->value(), &file_reader, footer, env_,
+                            options_.info_log.get(), &column_count, file_sizes,
+                            &path_ids);
+    if (!s.ok()) {
+      return s;
+    }
+    for (auto size : file_sizes) {
+      *file_size_total += size;
+    }
+    if (path_ids.size() == column_count + 1) {
+      sub_path_ids->assign(path_ids.begin() + 1, path_ids.end());
+    }
+    return Status::OK();
+  }
+
+  // Sets the key and sequence number ranges of the table from its properties
+  // and its first and last keys. Returns NotSupported if the properties do
+  // not record the sequence numbers or the table references blobs, whose
+  // references are only rebuilt by a scan.
+  Status ReadTableBounds(TableInfo* t, const TableProperties& props) {
+    bool blob_indexes_present = false;
+    uint64_t blob_indexes =
+        GetBlobIndexes(props.user_collected_properties, &blob_indexes_present);
+    if (!GetSequenceNumberRange(props.user_collected_properties,
+                                &t->min_sequence, &t->max_sequence) ||
+        !blob_indexes_present || blob_indexes > 0) {
+      return Status::NotSupported("table needs a scan");
+    }
+
+    ReadOptions ro;
+    ro.columns = {0};  // only the keys of a column table
+    InternalIterator* iter =
+        table_cache_->NewIterator(ro, env_options_, icmp_, t->meta.fd);
+    ParsedInternalKey parsed;
+    Status status;
+    iter->SeekToFirst();
+    if (iter->Valid() && ParseInternalKey(iter->key(), &parsed)) {
+      t->meta.smallest.DecodeFrom(iter->key());
+      iter->SeekToLast();
+    }
+    if (iter->Valid() && ParseInternalKey(iter->key(), &parsed)) {
+      t->meta.largest.DecodeFrom(iter->key());
+    } else {
+      status = iter->status();
+      if (status.ok()) {
+        status = Status::NotSupported("no parsable first or last key");
+      }
+    }
+    delete iter;
+    return status;
+  }
+
+  Status ScanTableEntries(TableInfo* t, uint64_t* counter) {
+    InternalIterator* iter = table_cache_->NewIterator(
+        ReadOptions(), env_options_, icmp_, t->meta.fd);
+    bool empty = true;
+    ParsedInternalKey parsed;
+    t->min_sequence = kMaxSequenceNumber;
+    t->max_sequence = 0;
+    t->meta.blob_refs.clear();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      Slice key = iter->key();
+      if (!ParseInternalKey(key, &parsed)) {
+        Log(InfoLogLevel::ERROR_LEVEL,
+            options_.info_log, "Table #%" PRIu64 ": unparsable key %s",
+            t->meta.fd.GetNumber(), EscapeString(key).c_str());
+        continue;
       }
-      if (!iter->status().ok()) {
-        status = iter->status();
+
+      (*counter)++;
+      if (empty) {
+        empty = false;
+        t->meta.smallest.DecodeFrom(key);
+      }
+      t->meta.largest.DecodeFrom(key);
+      if (parsed.sequence < t->min_sequence) {
+        t->min_sequence = parsed.sequence;
+      }
+      if (parsed.sequence > t->max_sequence) {
+        t->max_sequence = parsed.sequence;
+      }
+      uint64_t blob_number, blob_bytes;
+      if (parsed.type == kTypeBlobIndex &&
+          GetBlobFileRef(iter->value(), ioptions_.splitter, &blob_number,
+                         &blob_bytes)) {
+        t->meta.blob_refs[blob_number] += blob_bytes;
       }
-      delete iter;
     }
-    Log(InfoLogLevel::INFO_LEVEL,
-        options_.info_log, "Table #%" PRIu64 ": %d entries %s",
-        t->meta.fd.GetNumber(), counter, status.ToString().c_str());
+    if (empty) {
+      t->min_sequence = 0;
+    }
+    Status status = iter->status();
+    delete iter;
     return status;
   }
 
@@ -417,7 +604,8 @@ class Repairer {
                      t.meta.fd.GetFileSize(), t.meta.smallest, t.meta.largest,
                      t.min_sequence, t.max_sequence,
                      t.meta.marked_for_compaction,
-                     t.meta.fd.GetFileSizeTotal());  // Shichao
+                     t.meta.fd.GetFileSizeTotal(),  // Shichao
+                     t.meta.sub_path_ids, t.meta.blob_refs);
     }
 
     //fprintf(stderr, "NewDescriptor:\n%s\n", edit_.DebugString().c_str());
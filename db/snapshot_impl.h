@@ -58,8 +58,13 @@ class SnapshotList {
     s->unix_time_ = unix_time;
     s->is_write_conflict_boundary_ = is_write_conflict_boundary;
     s->list_ = this;
-    s->next_ = &list_;
-    s->prev_ = list_.prev_;
+    // After the newest snapshot, unless seq is older
+    SnapshotImpl* prev = list_.prev_;
+    while (prev != &list_ && prev->number_ > seq) {
+      prev = prev->prev_;
+    }
+    s->next_ = prev->next_;
+    s->prev_ = prev;
     s->prev_->next_ = s;
     s->next_->prev_ = s;
     count_++;
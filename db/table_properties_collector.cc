@@ -5,6 +5,8 @@
 
 #include "db/table_properties_collector.h"
 
+#include <algorithm>
+
 #include "db/dbformat.h"
 #include "util/coding.h"
 #include "util/string_util.h"
@@ -22,7 +24,11 @@ Status InternalKeyPropertiesCollector::InternalAdd(const Slice& key,
   // Note: We count both, deletions and single deletions here.
   if (ikey.type == ValueType::kTypeDeletion) {
     ++deleted_keys_;
+  } else if (ikey.type == ValueType::kTypeBlobIndex) {
+    ++blob_indexes_;
   }
+  smallest_seqno_ = std::min(smallest_seqno_, ikey.sequence);
+  largest_seqno_ = std::max(largest_seqno_, ikey.sequence);
 
   return Status::OK();
 }
@@ -45,13 +51,31 @@ Status InternalKeyPropertiesCollector::Finish(
   properties->insert(
       {InternalKeyTablePropertiesNames::kMergeOperands, val_merge_operands});
 
+  std::string val_blob_indexes;
+  PutVarint64(&val_blob_indexes, blob_indexes_);
+  properties->insert(
+      {InternalKeyTablePropertiesNames::kBlobIndexes, val_blob_indexes});
+
+  // none if the table is empty
+  if (smallest_seqno_ <= largest_seqno_) {
+    std::string val_smallest_seqno;
+    PutVarint64(&val_smallest_seqno, smallest_seqno_);
+    properties->insert(
+        {InternalKeyTablePropertiesNames::kSmallestSeqno, val_smallest_seqno});
+    std::string val_largest_seqno;
+    PutVarint64(&val_largest_seqno, largest_seqno_);
+    properties->insert(
+        {InternalKeyTablePropertiesNames::kLargestSeqno, val_largest_seqno});
+  }
+
   return Status::OK();
 }
 
 UserCollectedProperties
 InternalKeyPropertiesCollector::GetReadableProperties() const {
   return {{"kDeletedKeys", ToString(deleted_keys_)},
-          {"kMergeOperands", ToString(merge_operands_)}};
+          {"kMergeOperands", ToString(merge_operands_)},
+          {"kBlobIndexes", ToString(blob_indexes_)}};
 }
 
 namespace {
@@ -110,6 +134,12 @@ const std::string InternalKeyTablePropertiesNames::kDeletedKeys
   = "vidardb.deleted.keys";
 const std::string InternalKeyTablePropertiesNames::kMergeOperands =
     "vidardb.merge.operands";
+const std::string InternalKeyTablePropertiesNames::kSmallestSeqno =
+    "vidardb.smallest.seqno";
+const std::string InternalKeyTablePropertiesNames::kLargestSeqno =
+    "vidardb.largest.seqno";
+const std::string InternalKeyTablePropertiesNames::kBlobIndexes =
+    "vidardb.blob.indexes";
 
 uint64_t GetDeletedKeys(
     const UserCollectedProperties& props) {
@@ -124,4 +154,22 @@ uint64_t GetMergeOperands(const UserCollectedProperties& props,
       props, InternalKeyTablePropertiesNames::kMergeOperands, property_present);
 }
 
+bool GetSequenceNumberRange(const UserCollectedProperties& props,
+                            SequenceNumber* smallest_seqno,
+                            SequenceNumber* largest_seqno) {
+  bool smallest_present, largest_present;
+  *smallest_seqno = GetUint64Property(
+      props, InternalKeyTablePropertiesNames::kSmallestSeqno,
+      &smallest_present);
+  *largest_seqno = GetUint64Property(
+      props, InternalKeyTablePropertiesNames::kLargestSeqno, &largest_present);
+  return smallest_present && largest_present;
+}
+
+uint64_t GetBlobIndexes(const UserCollectedProperties& props,
+                        bool* property_present) {
+  return GetUint64Property(
+      props, InternalKeyTablePropertiesNames::kBlobIndexes, property_present);
+}
+
 }  // namespace vidardb
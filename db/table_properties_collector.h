@@ -6,6 +6,7 @@
 // This file defines a collection of statistics collectors.
 #pragma once
 
+#include "db/dbformat.h"
 #include "vidardb/table_properties.h"
 
 #include <memory>
@@ -17,6 +18,9 @@ namespace vidardb {
 struct InternalKeyTablePropertiesNames {
   static const std::string kDeletedKeys;
   static const std::string kMergeOperands;
+  static const std::string kSmallestSeqno;
+  static const std::string kLargestSeqno;
+  static const std::string kBlobIndexes;
 };
 
 // Base class for internal table properties collector.
@@ -67,6 +71,9 @@ class InternalKeyPropertiesCollector : public IntTblPropCollector {
  private:
   uint64_t deleted_keys_ = 0;
   uint64_t merge_operands_ = 0;
+  SequenceNumber smallest_seqno_ = kMaxSequenceNumber;
+  SequenceNumber largest_seqno_ = 0;
+  uint64_t blob_indexes_ = 0;
 };
 
 class InternalKeyPropertiesCollectorFactory
@@ -134,4 +141,14 @@ class UserKeyTablePropertiesCollectorFactory
   std::shared_ptr<TablePropertiesCollectorFactory> user_collector_factory_;
 };
 
+// Sets *smallest_seqno and *largest_seqno to the sequence numbers of the
+// entries of the table. Returns false if the table does not record them.
+extern bool GetSequenceNumberRange(const UserCollectedProperties& props,
+                                   SequenceNumber* smallest_seqno,
+                                   SequenceNumber* largest_seqno);
+
+// The number of kTypeBlobIndex entries of the table
+extern uint64_t GetBlobIndexes(const UserCollectedProperties& props,
+                               bool* property_present);
+
 }  // namespace vidardb
@@ -136,10 +136,21 @@ class VersionBuilder::Rep {
         auto f2 = level_files[i];
         if (level == 0) {
           assert(level_zero_cmp_(f1, f2));
-          assert(f1->largest_seqno > f2->largest_seqno ||
-                 // We can have multiple files with seqno = 0 as a result of
-                 // using DB::AddFile()
-                 (f1->largest_seqno == 0 && f2->largest_seqno == 0));
+          if (f1->flush_id != 0 && f1->flush_id == f2->flush_id) {
+            // The files of the subflushes of one flush have disjoint key
+            // ranges, but interleaved sequence numbers
+            const Comparator* ucmp =
+                vstorage->InternalComparator()->user_comparator();
+            assert(ucmp->Compare(f1->largest.user_key(),
+                                 f2->smallest.user_key()) < 0 ||
+                   ucmp->Compare(f2->largest.user_key(),
+                                 f1->smallest.user_key()) < 0);
+          } else {
+            assert(f1->largest_seqno > f2->largest_seqno ||
+                   // We can have multiple files with seqno = 0 as a result of
+                   // using DB::AddFile()
+                   (f1->largest_seqno == 0 && f2->largest_seqno == 0));
+          }
         } else {
           assert(level_nonzero_cmp_(f1, f2));
 
@@ -209,13 +220,20 @@ class VersionBuilder::Rep {
     for (const auto& del_file : del) {
       const auto level = del_file.first;
       const auto number = del_file.second;
-      levels_[level].deleted_files.insert(number);
       CheckConsistencyForDeletes(edit, number, level);
 
       auto exising = levels_[level].added_files.find(number);
       if (exising != levels_[level].added_files.end()) {
+        // Added by a previous edit. Unless the base version has it too, do
+        // not remember it, otherwise replaying a long manifest keeps every
+        // file ever compacted away.
         UnrefFile(exising->second);
-        levels_[level].added_files.erase(number);
+        levels_[level].added_files.erase(exising);
+        if (InBaseVersion(level, number)) {
+          levels_[level].deleted_files.insert(number);
+        }
+      } else {
+        levels_[level].deleted_files.insert(number);
       }
     }
 
@@ -227,11 +245,26 @@ class VersionBuilder::Rep {
 
       assert(levels_[level].added_files.find(f->fd.GetNumber()) ==
              levels_[level].added_files.end());
-      levels_[level].deleted_files.erase(f->fd.GetNumber());
+      // A file of the base version deleted and added back at the same level
+      // stays deleted, so that only the added copy is saved
+      auto deleted = levels_[level].deleted_files.find(f->fd.GetNumber());
+      if (deleted != levels_[level].deleted_files.end() &&
+          !InBaseVersion(level, f->fd.GetNumber())) {
+        levels_[level].deleted_files.erase(deleted);
+      }
       levels_[level].added_files[f->fd.GetNumber()] = f;
     }
   }
 
+  bool InBaseVersion(int level, uint64_t number) const {
+    for (const auto* f : base_vstorage_->LevelFiles(level)) {
+      if (f->fd.GetNumber() == number) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   // Save the current state in *v.
   void SaveTo(VersionStorageInfo* vstorage) {
     CheckConsistency(base_vstorage_);
@@ -275,7 +308,8 @@ class VersionBuilder::Rep {
           MaybeAddFile(vstorage, level, *base_iter);
         }
 
-        MaybeAddFile(vstorage, level, added);
+        // deleted_files only refers to the base copy of a re-added file
+        vstorage->AddFile(level, added, info_log_);
       }
 
       // Add remaining base files
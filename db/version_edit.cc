@@ -43,12 +43,17 @@ enum Tag {
   kColumnFamilyAdd = 201,
   kColumnFamilyDrop = 202,
   kMaxColumnFamily = 203,
+
+  kInAtomicGroup = 300,
 };
 
 enum CustomTag {
   kTerminate = 1,  // The end of customized fields
   kNeedCompaction = 2,
+  kFlushId = 3,
   kPathId = 65,
+  kSubPathIds = 66,
+  kBlobRefs = 67,
 };
 // If this bit for the custom tag is set, opening DB should fail if
 // we don't know this field.
@@ -79,6 +84,8 @@ void VersionEdit::Clear() {
   is_column_family_add_ = 0;
   is_column_family_drop_ = 0;
   column_family_name_.clear();
+  is_in_atomic_group_ = false;
+  remaining_entries_ = 0;
 }
 
 bool VersionEdit::EncodeTo(std::string* dst) const {
@@ -119,7 +126,15 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
       return false;
     }
     bool has_customized_fields = false;
-    if (f.marked_for_compaction) {
+    bool has_sub_path_ids = false;
+    for (uint32_t sub_path_id : f.sub_path_ids) {
+      if (sub_path_id != f.fd.GetPathId()) {
+        has_sub_path_ids = true;
+        break;
+      }
+    }
+    if (f.marked_for_compaction || has_sub_path_ids || !f.blob_refs.empty() ||
+        f.flush_id != 0) {
       PutVarint32(dst, kNewFile4);
       has_customized_fields = true;
     } else if (f.fd.GetPathId() == 0) {
@@ -167,6 +182,9 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
       //   tag kPathId: 1 byte as path_id
       //   tag kNeedCompaction:
       //        now only can take one char value 1 indicating need-compaction
+      //   tag kSubPathIds: 1 byte per sub column as its path_id
+      //   tag kBlobRefs: varint64 pairs of blob file number and bytes
+      //   tag kFlushId: varint64 as the flush_id of a level-0 file
       //
       if (f.fd.GetPathId() != 0) {
         PutVarint32(dst, CustomTag::kPathId);
@@ -178,6 +196,26 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
         char p = static_cast<char>(1);
         PutLengthPrefixedSlice(dst, Slice(&p, 1));
       }
+      if (has_sub_path_ids) {
+        PutVarint32(dst, CustomTag::kSubPathIds);
+        std::string p(f.sub_path_ids.begin(), f.sub_path_ids.end());
+        PutLengthPrefixedSlice(dst, p);
+      }
+      if (!f.blob_refs.empty()) {
+        PutVarint32(dst, CustomTag::kBlobRefs);
+        std::string p;
+        for (const auto& ref : f.blob_refs) {
+          PutVarint64(&p, ref.first);
+          PutVarint64(&p, ref.second);
+        }
+        PutLengthPrefixedSlice(dst, p);
+      }
+      if (f.flush_id != 0) {
+        PutVarint32(dst, CustomTag::kFlushId);
+        std::string p;
+        PutVarint64(&p, f.flush_id);
+        PutLengthPrefixedSlice(dst, p);
+      }
       TEST_SYNC_POINT_CALLBACK("VersionEdit::EncodeTo:NewFile4:CustomizeFields",
                                dst);
 
@@ -199,6 +237,11 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
   if (is_column_family_drop_) {
     PutVarint32(dst, kColumnFamilyDrop);
   }
+
+  if (is_in_atomic_group_) {
+    PutVarint32(dst, kInAtomicGroup);
+    PutVarint32(dst, remaining_entries_);
+  }
   return true;
 }
 
@@ -269,6 +312,31 @@ const char* VersionEdit::DecodeNewFile4From(Slice* input) {
           }
           f.marked_for_compaction = (field[0] == 1);
           break;
+        case kSubPathIds:
+          f.sub_path_ids.resize(field.size());
+          for (size_t i = 0; i < field.size(); i++) {
+            f.sub_path_ids[i] = static_cast<unsigned char>(field[i]);
+            if (f.sub_path_ids[i] > 3) {
+              return "sub_path_id wrong value";
+            }
+          }
+          break;
+        case kBlobRefs:
+          while (!field.empty()) {
+            uint64_t blob_number;
+            uint64_t blob_bytes;
+            if (!GetVarint64(&field, &blob_number) ||
+                !GetVarint64(&field, &blob_bytes)) {
+              return "blob_refs field wrong encoding";
+            }
+            f.blob_refs[blob_number] = blob_bytes;
+          }
+          break;
+        case kFlushId:
+          if (!GetVarint64(&field, &f.flush_id) || !field.empty()) {
+            return "flush_id field wrong encoding";
+          }
+          break;
         default:
           if ((custom_tag & kCustomTagNonSafeIgnoreMask) != 0) {
             // Should not proceed if cannot understand it
@@ -463,6 +531,15 @@ Status VersionEdit::DecodeFrom(const Slice& src) {
         is_column_family_drop_ = true;
         break;
 
+      case kInAtomicGroup:
+        is_in_atomic_group_ = true;
+        if (!GetVarint32(&input, &remaining_entries_)) {
+          if (!msg) {
+            msg = "remaining entries";
+          }
+        }
+        break;
+
       default:
         msg = "unknown tag";
         break;
@@ -541,6 +618,11 @@ std::string VersionEdit::DebugString(bool hex_key) const {
     r.append("\n  MaxColumnFamily: ");
     AppendNumberTo(&r, max_column_family_);
   }
+  if (is_in_atomic_group_) {
+    r.append("\n  AtomicGroup: ");
+    AppendNumberTo(&r, remaining_entries_);
+    r.append(" entries remain");
+  }
   r.append("\n}\n");
   return r;
 }
@@ -611,6 +693,9 @@ std::string VersionEdit::DebugJSON(int edit_num, bool hex_key) const {
   if (has_max_column_family_) {
     jw << "MaxColumnFamily" << max_column_family_;
   }
+  if (is_in_atomic_group_) {
+    jw << "AtomicGroupRemainingEntries" << remaining_entries_;
+  }
 
   jw.EndObject();
 
@@ -14,6 +14,7 @@
 
 #pragma once
 #include <algorithm>
+#include <map>
 #include <set>
 #include <utility>
 #include <vector>
@@ -102,6 +103,19 @@ struct FileMetaData {
   bool marked_for_compaction;  // True if client asked us nicely to compact this
                                // file.
 
+  // Path ids of the column table sub files, one per sub column. Only
+  // persisted when some sub file is placed away from the main file.
+  std::vector<uint32_t> sub_path_ids;
+
+  // Blob files referenced by the table, mapped to the bytes of the blobs
+  // referenced in each of them.
+  std::map<uint64_t, uint64_t> blob_refs;
+
+  // For a level-0 file written by a flush split into subflushes, the number
+  // of the first file of that flush, shared by all its files, which make a
+  // single sorted run. Zero for the other files.
+  uint64_t flush_id;
+
   FileMetaData()
       : refs(0),
         being_compacted(false),
@@ -114,7 +128,8 @@ struct FileMetaData {
         raw_key_size(0),
         raw_value_size(0),
         init_stats_from_file(false),
-        marked_for_compaction(false) {}
+        marked_for_compaction(false),
+        flush_id(0) {}
 
   // REQUIRED: Keys must be given to the function in sorted order (it expects
   // the last key to be the largest).
@@ -195,7 +210,12 @@ class VersionEdit {
                uint64_t file_size, const InternalKey& smallest,
                const InternalKey& largest, const SequenceNumber& smallest_seqno,
                const SequenceNumber& largest_seqno, bool marked_for_compaction,
-               uint64_t file_size_total) {                // Shichao
+               uint64_t file_size_total,                  // Shichao
+               const std::vector<uint32_t>& sub_path_ids =
+                   std::vector<uint32_t>(),
+               const std::map<uint64_t, uint64_t>& blob_refs =
+                   std::map<uint64_t, uint64_t>(),
+               uint64_t flush_id = 0) {
     assert(smallest_seqno <= largest_seqno);
     FileMetaData f;
     f.fd = FileDescriptor(file, file_path_id, file_size, file_size_total);  // Shichao
@@ -204,6 +224,9 @@ class VersionEdit {
     f.smallest_seqno = smallest_seqno;
     f.largest_seqno = largest_seqno;
     f.marked_for_compaction = marked_for_compaction;
+    f.sub_path_ids = sub_path_ids;
+    f.blob_refs = blob_refs;
+    f.flush_id = flush_id;
     new_files_.emplace_back(level, f);
   }
 
@@ -245,6 +268,15 @@ class VersionEdit {
     is_column_family_drop_ = true;
   }
 
+  // Edits of an atomic group are recovered all together or not at all.
+  // remaining_entries is the number of edits following this one in the group.
+  void MarkAtomicGroup(uint32_t remaining_entries) {
+    is_in_atomic_group_ = true;
+    remaining_entries_ = remaining_entries;
+  }
+  bool IsInAtomicGroup() const { return is_in_atomic_group_; }
+  uint32_t GetRemainingEntries() const { return remaining_entries_; }
+
   // return true on success.
   bool EncodeTo(std::string* dst) const;
   Status DecodeFrom(const Slice& src);
@@ -293,6 +325,9 @@ class VersionEdit {
   bool is_column_family_drop_;
   bool is_column_family_add_;
   std::string column_family_name_;
+
+  bool is_in_atomic_group_;
+  uint32_t remaining_entries_;
 };
 
 }  // namespace vidardb
@@ -21,9 +21,12 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <set>
 #include <climits>
+#include <functional>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -41,6 +44,7 @@
 #include "table/format.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
+#include "table/column_stats.h"
 #include "table/merger.h"
 #include "table/meta_blocks.h"
 #include "table/table_reader.h"
@@ -50,6 +54,7 @@
 #include "util/logging.h"
 #include "util/perf_context_imp.h"
 #include "util/stop_watch.h"
+#include "util/string_util.h"
 #include "util/sync_point.h"
 
 namespace vidardb {
@@ -733,6 +738,86 @@ Status Version::GetPropertiesOfTablesInRange(
   return Status::OK();
 }
 
+Status Version::EstimateRangeStats(const Range& range,
+                                   const std::vector<uint32_t>& columns,
+                                   RangeStats* stats) const {
+  const Comparator* ucmp = cfd_->internal_comparator().user_comparator();
+  bool from_min = range.start.compare(kRangeQueryMin) == 0;
+  bool to_max = range.limit.compare(kRangeQueryMax) == 0;
+  InternalKey k1(range.start, kMaxSequenceNumber, kValueTypeForSeek);
+  // the last internal key of range.limit
+  InternalKey k2(range.limit, 0, static_cast<ValueType>(0));
+
+  std::vector<ColumnStatsAggregator> aggregators(columns.size());
+  double num_rows = 0;
+  for (int level = 0; level < storage_info_.num_non_empty_levels(); level++) {
+    std::vector<FileMetaData*> files;
+    storage_info_.GetOverlappingInputs(level, from_min ? nullptr : &k1,
+                                       to_max ? nullptr : &k2, &files, -1,
+                                       nullptr, false);
+    for (const auto& file_meta : files) {
+      Cache::Handle* handle = nullptr;
+      Status s = cfd_->table_cache()->FindTable(
+          vset_->env_options_, cfd_->internal_comparator(), file_meta->fd,
+          &handle);
+      if (!s.ok()) {
+        return s;
+      }
+      TableReader* reader =
+          cfd_->table_cache()->GetTableReaderFromHandle(handle);
+      std::shared_ptr<const TableProperties> props =
+          reader->GetTableProperties();
+
+      // offsets add up the sub column files, so compare to the total size
+      uint64_t size = file_meta->fd.GetFileSizeTotal();
+      uint64_t lo = 0;
+      uint64_t hi = size;
+      if (!from_min &&
+          ucmp->Compare(range.start, file_meta->smallest.user_key()) > 0) {
+        lo = reader->ApproximateOffsetOf(k1.Encode());
+      }
+      if (!to_max &&
+          ucmp->Compare(range.limit, file_meta->largest.user_key()) < 0) {
+        hi = reader->ApproximateOffsetOf(k2.Encode());
+      }
+      cfd_->table_cache()->ReleaseHandle(handle);
+
+      double fraction = 0;
+      if (size > 0 && hi > lo) {
+        fraction = std::min(static_cast<double>(hi - lo) / size, 1.0);
+      }
+      if (props == nullptr || fraction == 0) {
+        continue;
+      }
+
+      uint64_t deleted = GetDeletedKeys(props->user_collected_properties);
+      num_rows += fraction * (props->num_entries -
+                              std::min(deleted, props->num_entries));
+      for (size_t i = 0; i < columns.size(); i++) {
+        auto it = props->user_collected_properties.find(
+            TablePropertiesNames::kColumnStatsPrefix + ToString(columns[i]));
+        if (it == props->user_collected_properties.end()) {
+          continue;
+        }
+        TableColumnStats column_stats;
+        s = column_stats.DecodeFrom(it->second);
+        if (!s.ok()) {
+          return s;
+        }
+        aggregators[i].Add(column_stats, fraction);
+      }
+    }
+  }
+
+  stats->num_rows = static_cast<uint64_t>(num_rows + 0.5);
+  stats->columns.resize(columns.size());
+  for (size_t i = 0; i < columns.size(); i++) {
+    stats->columns[i].column = columns[i];
+    aggregators[i].Finish(&stats->columns[i]);
+  }
+  return Status::OK();
+}
+
 Status Version::GetAggregatedTableProperties(
     std::shared_ptr<const TableProperties>* tp, int level) {
   TablePropertiesCollection props;
@@ -962,7 +1047,8 @@ Version::Version(ColumnFamilyData* column_family_data, VersionSet* vset,
 
 void Version::Get(const ReadOptions& read_options, const LookupKey& k,
                   std::string* value, Status* status, bool* value_found,
-                  bool* key_exists, SequenceNumber* seq) {
+                  bool* key_exists, SequenceNumber* seq,
+                  ReadCallback* callback) {
   Slice ikey = k.internal_key();
   Slice user_key = k.user_key();
 
@@ -974,7 +1060,7 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
   }
 
   GetContext get_context(user_comparator(), GetContext::kNotFound, user_key,
-                         value, value_found, seq);
+                         value, value_found, seq, callback);
 
   FilePicker fp(storage_info_.files_, k, k, &storage_info_.level_files_brief_,
                 storage_info_.num_non_empty_levels_,
@@ -1003,6 +1089,17 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
         } else if (fp.GetHitFileLevel() >= 2) {
           RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
         }
+        if (get_context.is_blob_index() && value != nullptr) {
+          std::string blob_index;
+          blob_index.swap(*value);
+          *status = cfd_->blob_file_cache()->GetBlobValue(read_options,
+                                                          blob_index, value);
+          if (status->IsIncomplete() && value_found != nullptr) {
+            // the blob file is not open and no I/O is allowed
+            *status = Status::OK();
+            *value_found = false;
+          }
+        }
         return;
       case GetContext::kDeleted:
         // Use empty error message for speed
@@ -1300,6 +1397,20 @@ void VersionStorageInfo::EstimateCompactionBytesNeeded(
   }
 }
 
+int VersionStorageInfo::Level0SortedRuns(std::vector<int>* runs) const {
+  const auto& files = files_[0];
+  runs->assign(files.size(), 0);
+  int num_runs = 0;
+  for (size_t i = 0; i < files.size(); i++) {
+    if (i == 0 || files[i]->flush_id == 0 ||
+        files[i]->flush_id != files[i - 1]->flush_id) {
+      num_runs++;
+    }
+    (*runs)[i] = num_runs - 1;
+  }
+  return num_runs;
+}
+
 void VersionStorageInfo::ComputeCompactionScore(
     const MutableCFOptions& mutable_cf_options) {
   for (int level = 0; level <= MaxInputLevel(); level++) {
@@ -1318,10 +1429,15 @@ void VersionStorageInfo::ComputeCompactionScore(
       // overwrites/deletions).
       int num_sorted_runs = 0;
       uint64_t total_size = 0;
-      for (auto* f : files_[level]) {
+      std::vector<int> runs;
+      Level0SortedRuns(&runs);
+      int last_run = -1;
+      for (size_t i = 0; i < files_[level].size(); i++) {
+        FileMetaData* f = files_[level][i];
         if (!f->being_compacted) {
           total_size += f->compensated_file_size;
-          num_sorted_runs++;
+          num_sorted_runs += runs[i] != last_run ? 1 : 0;
+          last_run = runs[i];
         }
       }
 
@@ -1945,7 +2061,8 @@ void VersionStorageInfo::CalculateBaseBytes(const ImmutableCFOptions& ioptions,
                                             const MutableCFOptions& options) {
   // Special logic to set number of sorted runs.
   // It is to match the previous behavior when all files are in L0.
-  int num_l0_count = static_cast<int>(files_[0].size());
+  std::vector<int> runs;
+  int num_l0_count = Level0SortedRuns(&runs);
 
   set_l0_delay_trigger_count(num_l0_count);
 
@@ -2010,6 +2127,17 @@ void Version::AddLiveFiles(std::vector<FileDescriptor>* live) {
   }
 }
 
+void Version::AddLiveBlobFiles(std::vector<uint64_t>* live) {
+  for (int level = 0; level < storage_info_.num_levels(); level++) {
+    const std::vector<FileMetaData*>& files = storage_info_.files_[level];
+    for (const auto& file : files) {
+      for (const auto& ref : file->blob_refs) {
+        live->push_back(ref.first);
+      }
+    }
+  }
+}
+
 std::string Version::DebugString(bool hex) const {
   std::string r;
   for (int level = 0; level < storage_info_.num_levels_; level++) {
@@ -2045,10 +2173,11 @@ struct VersionSet::ManifestWriter {
   InstrumentedCondVar cv;
   ColumnFamilyData* cfd;
   VersionEdit* edit;
+  bool atomic_group;
 
   explicit ManifestWriter(InstrumentedMutex* mu, ColumnFamilyData* _cfd,
                           VersionEdit* e)
-      : done(false), cv(mu), cfd(_cfd), edit(e) {}
+      : done(false), cv(mu), cfd(_cfd), edit(e), atomic_group(false) {}
 };
 
 VersionSet::VersionSet(const std::string& dbname, const DBOptions* db_options,
@@ -2068,6 +2197,7 @@ VersionSet::VersionSet(const std::string& dbname, const DBOptions* db_options,
       prev_log_number_(0),
       current_version_number_(0),
       manifest_file_size_(0),
+      manifest_snapshot_size_(0),
       env_options_(storage_options),
       env_options_compactions_(env_options_) {}
 
@@ -2167,10 +2297,11 @@ Status VersionSet::LogAndApply(ColumnFamilyData* column_family_data,
     builder_guard.reset(new BaseReferencedVersionBuilder(column_family_data));
     auto* builder = builder_guard->version_builder();
     for (const auto& writer : manifest_writers_) {
-      if (writer->edit->IsColumnFamilyManipulation() ||
+      if (writer->atomic_group || writer->edit->IsColumnFamilyManipulation() ||
           writer->cfd->GetID() != column_family_data->GetID()) {
         // no group commits for column family add or drop
         // also, group commits across column families are not supported
+        // except for atomic groups, which are committed on their own
         break;
       }
       last_writer = writer;
@@ -2180,13 +2311,200 @@ Status VersionSet::LogAndApply(ColumnFamilyData* column_family_data,
     builder->SaveTo(v->storage_info());
   }
 
+  Status s = WriteManifestEdits(batch_edits, mu, db_directory,
+                                new_descriptor_log, [&]() {
+    if (!edit->IsColumnFamilyManipulation() &&
+        db_options_->max_open_files == -1) {
+      // unlimited table cache. Pre-load table handle now.
+      // Need to do it out of the mutex.
+      builder_guard->version_builder()->LoadTableHandlers(
+          column_family_data->internal_stats());
+    }
+
+    if (!edit->IsColumnFamilyManipulation()) {
+      // This is cpu-heavy operations, which should be called outside mutex.
+      v->PrepareApply(mutable_cf_options, true);
+    }
+  });
+
+  // Install the new version
+  if (s.ok()) {
+    if (edit->is_column_family_add_) {
+      // no group commit on column family add
+      assert(batch_edits.size() == 1);
+      assert(new_cf_options != nullptr);
+      CreateColumnFamily(*new_cf_options, edit);
+    } else if (edit->is_column_family_drop_) {
+      assert(batch_edits.size() == 1);
+      column_family_data->SetDropped();
+      if (column_family_data->Unref()) {
+        delete column_family_data;
+      }
+    } else {
+      uint64_t max_log_number_in_batch  = 0;
+      for (auto& e : batch_edits) {
+        if (e->has_log_number_) {
+          max_log_number_in_batch =
+              std::max(max_log_number_in_batch, e->log_number_);
+        }
+      }
+      if (max_log_number_in_batch != 0) {
+        assert(column_family_data->GetLogNumber() <= max_log_number_in_batch);
+        column_family_data->SetLogNumber(max_log_number_in_batch);
+      }
+      AppendVersion(column_family_data, v);
+    }
+  } else {
+    std::string version_edits;
+    for (auto& e : batch_edits) {
+      version_edits = version_edits + "\n" + e->DebugString(true);
+    }
+    Log(InfoLogLevel::ERROR_LEVEL, db_options_->info_log,
+        "[%s] Error in committing version edit to MANIFEST: %s",
+        column_family_data ? column_family_data->GetName().c_str() : "<null>",
+        version_edits.c_str());
+    delete v;
+  }
+
+  // wake up all the waiting writers
+  while (true) {
+    ManifestWriter* ready = manifest_writers_.front();
+    manifest_writers_.pop_front();
+    if (ready != &w) {
+      ready->status = s;
+      ready->done = true;
+      ready->cv.Signal();
+    }
+    if (ready == last_writer) break;
+  }
+  // Notify new head of write queue
+  if (!manifest_writers_.empty()) {
+    manifest_writers_.front()->cv.Signal();
+  }
+  return s;
+}
+
+Status VersionSet::LogAndApply(
+    const std::vector<ColumnFamilyData*>& column_family_datas,
+    const std::vector<const MutableCFOptions*>& mutable_cf_options_list,
+    const std::vector<VersionEdit*>& edit_list, InstrumentedMutex* mu,
+    Directory* db_directory) {
+  mu->AssertHeld();
+  assert(!column_family_datas.empty());
+  assert(column_family_datas.size() == mutable_cf_options_list.size());
+  assert(column_family_datas.size() == edit_list.size());
+
+  if (column_family_datas.size() == 1) {
+    return LogAndApply(column_family_datas[0], *mutable_cf_options_list[0],
+                       edit_list[0], mu, db_directory);
+  }
+
+  // queue our request, the group is never merged with other writers
+  ManifestWriter w(mu, column_family_datas[0], edit_list[0]);
+  w.atomic_group = true;
+  manifest_writers_.push_back(&w);
+  while (&w != manifest_writers_.front()) {
+    w.cv.Wait();
+  }
+
+  std::vector<ColumnFamilyData*> cfds;
+  std::vector<const MutableCFOptions*> mutable_cf_options;
+  std::vector<VersionEdit*> batch_edits;
+  std::vector<Version*> versions;
+  std::vector<std::unique_ptr<BaseReferencedVersionBuilder>> builders;
+  for (size_t i = 0; i < column_family_datas.size(); i++) {
+    ColumnFamilyData* cfd = column_family_datas[i];
+    assert(!edit_list[i]->IsColumnFamilyManipulation());
+    if (cfd->IsDropped()) {
+      // nothing of a dropped column family needs to be consistent
+      continue;
+    }
+    Version* v = new Version(cfd, this, current_version_number_++);
+    builders.emplace_back(new BaseReferencedVersionBuilder(cfd));
+    auto* builder = builders.back()->version_builder();
+    LogAndApplyHelper(cfd, builder, v, edit_list[i], mu);
+    builder->SaveTo(v->storage_info());
+    cfds.push_back(cfd);
+    mutable_cf_options.push_back(mutable_cf_options_list[i]);
+    batch_edits.push_back(edit_list[i]);
+    versions.push_back(v);
+  }
+
+  Status s;
+  if (batch_edits.empty()) {
+    s = Status::ShutdownInProgress();
+  } else {
+    for (size_t i = 0; i < batch_edits.size(); i++) {
+      batch_edits[i]->MarkAtomicGroup(
+          static_cast<uint32_t>(batch_edits.size() - 1 - i));
+    }
+
+    s = WriteManifestEdits(batch_edits, mu, db_directory, false, [&]() {
+      for (size_t i = 0; i < versions.size(); i++) {
+        if (db_options_->max_open_files == -1) {
+          // unlimited table cache. Pre-load table handle now.
+          builders[i]->version_builder()->LoadTableHandlers(
+              cfds[i]->internal_stats());
+        }
+        versions[i]->PrepareApply(*mutable_cf_options[i], true);
+      }
+    });
+  }
+
+  if (s.ok()) {
+    for (size_t i = 0; i < versions.size(); i++) {
+      if (batch_edits[i]->has_log_number_) {
+        assert(cfds[i]->GetLogNumber() <= batch_edits[i]->log_number_);
+        cfds[i]->SetLogNumber(batch_edits[i]->log_number_);
+      }
+      AppendVersion(cfds[i], versions[i]);
+    }
+  } else {
+    if (!batch_edits.empty()) {
+      std::string version_edits;
+      for (auto& e : batch_edits) {
+        version_edits = version_edits + "\n" + e->DebugString(true);
+      }
+      Log(InfoLogLevel::ERROR_LEVEL, db_options_->info_log,
+          "Error in committing atomic group of version edits to MANIFEST: %s",
+          version_edits.c_str());
+    }
+    for (auto* v : versions) {
+      delete v;
+    }
+  }
+
+  manifest_writers_.pop_front();
+  // Notify new head of write queue
+  if (!manifest_writers_.empty()) {
+    manifest_writers_.front()->cv.Signal();
+  }
+  return s;
+}
+
+Status VersionSet::WriteManifestEdits(
+    const std::vector<VersionEdit*>& batch_edits, InstrumentedMutex* mu,
+    Directory* db_directory, bool new_descriptor_log,
+    const std::function<void()>& prepare_versions) {
+  mu->AssertHeld();
+  assert(!batch_edits.empty());
+  VersionEdit* edit = batch_edits.front();
+
   // Initialize new descriptor log file if necessary by creating
   // a temporary file that contains a snapshot of the current version.
   uint64_t new_manifest_file_size = 0;
+  uint64_t new_manifest_snapshot_size = manifest_snapshot_size_;
   Status s;
 
   assert(pending_manifest_file_number_ == 0);
-  if (!descriptor_log_ ||
+  // Once most of the manifest is edits already folded into the current
+  // versions, start over with a fresh snapshot to keep recovery short.
+  bool compact_manifest =
+      db_options_->manifest_snapshot_ratio > 0 &&
+      manifest_file_size_ > db_options_->manifest_preallocation_size &&
+      manifest_file_size_ / db_options_->manifest_snapshot_ratio >
+          manifest_snapshot_size_;
+  if (!descriptor_log_ || compact_manifest ||
       manifest_file_size_ > db_options_->max_manifest_file_size) {
     pending_manifest_file_number_ = NewFileNumber();
     batch_edits.back()->SetNextFile(next_file_number_.load());
@@ -2209,13 +2527,7 @@ Status VersionSet::LogAndApply(ColumnFamilyData* column_family_data,
     mu->Unlock();
 
     TEST_SYNC_POINT("VersionSet::LogAndApply:WriteManifest");
-    if (!edit->IsColumnFamilyManipulation() &&
-        db_options_->max_open_files == -1) {
-      // unlimited table cache. Pre-load table handle now.
-      // Need to do it out of the mutex.
-      builder_guard->version_builder()->LoadTableHandlers(
-          column_family_data->internal_stats());
-    }
+    prepare_versions();
 
     // This is fine because everything inside of this block is serialized --
     // only one thread can be here at the same time
@@ -2236,14 +2548,10 @@ Status VersionSet::LogAndApply(ColumnFamilyData* column_family_data,
             new WritableFileWriter(std::move(descriptor_file), opt_env_opts));
         descriptor_log_.reset(new log::Writer(std::move(file_writer), 0, false));
         s = WriteSnapshot(descriptor_log_.get());
+        new_manifest_snapshot_size = descriptor_log_->file()->GetFileSize();
       }
     }
 
-    if (!edit->IsColumnFamilyManipulation()) {
-      // This is cpu-heavy operations, which should be called outside mutex.
-      v->PrepareApply(mutable_cf_options, true);
-    }
-
     // Write new record to MANIFEST log
     if (s.ok()) {
       for (auto& e : batch_edits) {
@@ -2292,80 +2600,26 @@ Status VersionSet::LogAndApply(ColumnFamilyData* column_family_data,
     mu->Lock();
   }
 
-  // Append the old mainfest file to the obsolete_manifests_ list to be deleted
-  // by PurgeObsoleteFiles later.
-  if (s.ok() && new_descriptor_log) {
-    obsolete_manifests_.emplace_back(
-        DescriptorFileName("", manifest_file_number_));
-  }
-
-  // Install the new version
   if (s.ok()) {
-    if (edit->is_column_family_add_) {
-      // no group commit on column family add
-      assert(batch_edits.size() == 1);
-      assert(new_cf_options != nullptr);
-      CreateColumnFamily(*new_cf_options, edit);
-    } else if (edit->is_column_family_drop_) {
-      assert(batch_edits.size() == 1);
-      column_family_data->SetDropped();
-      if (column_family_data->Unref()) {
-        delete column_family_data;
-      }
-    } else {
-      uint64_t max_log_number_in_batch  = 0;
-      for (auto& e : batch_edits) {
-        if (e->has_log_number_) {
-          max_log_number_in_batch =
-              std::max(max_log_number_in_batch, e->log_number_);
-        }
-      }
-      if (max_log_number_in_batch != 0) {
-        assert(column_family_data->GetLogNumber() <= max_log_number_in_batch);
-        column_family_data->SetLogNumber(max_log_number_in_batch);
-      }
-      AppendVersion(column_family_data, v);
+    // Append the old mainfest file to the obsolete_manifests_ list to be
+    // deleted by PurgeObsoleteFiles later.
+    if (new_descriptor_log) {
+      obsolete_manifests_.emplace_back(
+          DescriptorFileName("", manifest_file_number_));
     }
-
     manifest_file_number_ = pending_manifest_file_number_;
     manifest_file_size_ = new_manifest_file_size;
+    manifest_snapshot_size_ = new_manifest_snapshot_size;
     prev_log_number_ = edit->prev_log_number_;
-  } else {
-    std::string version_edits;
-    for (auto& e : batch_edits) {
-      version_edits = version_edits + "\n" + e->DebugString(true);
-    }
-    Log(InfoLogLevel::ERROR_LEVEL, db_options_->info_log,
-        "[%s] Error in committing version edit to MANIFEST: %s",
-        column_family_data ? column_family_data->GetName().c_str() : "<null>",
-        version_edits.c_str());
-    delete v;
-    if (new_descriptor_log) {
-      Log(InfoLogLevel::INFO_LEVEL, db_options_->info_log,
-        "Deleting manifest %" PRIu64 " current manifest %" PRIu64 "\n",
-        manifest_file_number_, pending_manifest_file_number_);
-      descriptor_log_.reset();
-      env_->DeleteFile(
-          DescriptorFileName(dbname_, pending_manifest_file_number_));
-    }
+  } else if (new_descriptor_log) {
+    Log(InfoLogLevel::INFO_LEVEL, db_options_->info_log,
+      "Deleting manifest %" PRIu64 " current manifest %" PRIu64 "\n",
+      manifest_file_number_, pending_manifest_file_number_);
+    descriptor_log_.reset();
+    env_->DeleteFile(
+        DescriptorFileName(dbname_, pending_manifest_file_number_));
   }
   pending_manifest_file_number_ = 0;
-
-  // wake up all the waiting writers
-  while (true) {
-    ManifestWriter* ready = manifest_writers_.front();
-    manifest_writers_.pop_front();
-    if (ready != &w) {
-      ready->status = s;
-      ready->done = true;
-      ready->cv.Signal();
-    }
-    if (ready == last_writer) break;
-  }
-  // Notify new head of write queue
-  if (!manifest_writers_.empty()) {
-    manifest_writers_.front()->cv.Signal();
-  }
   return s;
 }
 
@@ -2485,13 +2739,7 @@ Status VersionSet::Recover(
                        true /*checksum*/, 0 /*initial_offset*/, 0);
     Slice record;
     std::string scratch;
-    while (reader.ReadRecord(&record, &scratch) && s.ok()) {
-      VersionEdit edit;
-      s = edit.DecodeFrom(record);
-      if (!s.ok()) {
-        break;
-      }
-
+    auto apply_edit = [&](VersionEdit& edit) -> Status {
       // Not found means that user didn't supply that column
       // family option AND we encountered column family add
       // record. Once we encounter column family drop record,
@@ -2512,9 +2760,8 @@ Status VersionSet::Recover(
 
       if (edit.is_column_family_add_) {
         if (cf_in_builders || cf_in_not_found) {
-          s = Status::Corruption(
+          return Status::Corruption(
               "Manifest adding the same column family twice");
-          break;
         }
         auto cf_options = cf_name_to_options.find(edit.column_family_name_);
         if (cf_options == cf_name_to_options.end()) {
@@ -2542,24 +2789,21 @@ Status VersionSet::Recover(
         } else if (cf_in_not_found) {
           column_families_not_found.erase(edit.column_family_);
         } else {
-          s = Status::Corruption(
+          return Status::Corruption(
               "Manifest - dropping non-existing column family");
-          break;
         }
       } else if (!cf_in_not_found) {
         if (!cf_in_builders) {
-          s = Status::Corruption(
+          return Status::Corruption(
               "Manifest record referencing unknown column family");
-          break;
         }
 
         cfd = column_family_set_->GetColumnFamily(edit.column_family_);
         // this should never happen since cf_in_builders is true
         assert(cfd != nullptr);
         if (edit.max_level_ >= cfd->current()->storage_info()->num_levels()) {
-          s = Status::InvalidArgument(
+          return Status::InvalidArgument(
               "db has more levels than options.num_levels");
-          break;
         }
 
         // if it is not column family add or column family drop,
@@ -2583,10 +2827,9 @@ Status VersionSet::Recover(
         }
         if (edit.has_comparator_ &&
             edit.comparator_ != cfd->user_comparator()->Name()) {
-          s = Status::InvalidArgument(
+          return Status::InvalidArgument(
               cfd->user_comparator()->Name(),
               "does not match existing comparator " + edit.comparator_);
-          break;
         }
       }
 
@@ -2608,6 +2851,42 @@ Status VersionSet::Recover(
         last_sequence = edit.last_sequence_;
         have_last_sequence = true;
       }
+      return Status::OK();
+    };
+
+    // Edits of an atomic group are only applied once the whole group has been
+    // read, so a group cut short by a crash is dropped.
+    std::vector<VersionEdit> atomic_group;
+    while (reader.ReadRecord(&record, &scratch) && s.ok()) {
+      VersionEdit edit;
+      s = edit.DecodeFrom(record);
+      if (!s.ok()) {
+        break;
+      }
+
+      if (edit.IsInAtomicGroup()) {
+        if (!atomic_group.empty() &&
+            atomic_group.back().GetRemainingEntries() !=
+                edit.GetRemainingEntries() + 1) {
+          s = Status::Corruption("Manifest atomic group out of order");
+          break;
+        }
+        atomic_group.push_back(edit);
+        if (edit.GetRemainingEntries() > 0) {
+          continue;
+        }
+        for (auto& group_edit : atomic_group) {
+          s = apply_edit(group_edit);
+          if (!s.ok()) {
+            break;
+          }
+        }
+        atomic_group.clear();
+      } else if (!atomic_group.empty()) {
+        s = Status::Corruption("Manifest atomic group is incomplete");
+      } else {
+        s = apply_edit(edit);
+      }
     }
   }
 
@@ -2644,28 +2923,62 @@ Status VersionSet::Recover(
   }
 
   if (s.ok()) {
+    std::vector<std::pair<ColumnFamilyData*, Version*>> versions;
     for (auto cfd : *column_family_set_) {
       if (cfd->IsDropped()) {
         continue;
       }
-      auto builders_iter = builders.find(cfd->GetID());
-      assert(builders_iter != builders.end());
-      auto* builder = builders_iter->second->version_builder();
+      versions.emplace_back(cfd,
+                            new Version(cfd, this, current_version_number_++));
+    }
+
+    // Opening tables and loading their stats dominate recovery, so the column
+    // families are built in parallel, sharing max_file_opening_threads.
+    int max_threads = std::max(db_options_->max_file_opening_threads, 1);
+    int cf_threads =
+        std::min(max_threads, static_cast<int>(versions.size()));
+    int file_threads = std::max(max_threads / std::max(cf_threads, 1), 1);
+    std::atomic<size_t> next_version_idx(0);
+    std::function<void()> build_versions_func = [&]() {
+      while (true) {
+        size_t version_idx = next_version_idx.fetch_add(1);
+        if (version_idx >= versions.size()) {
+          break;
+        }
 
-      if (db_options_->max_open_files == -1) {
-        // unlimited table cache. Pre-load table handle now.
-        // Need to do it out of the mutex.
-        builder->LoadTableHandlers(cfd->internal_stats(),
-                                   db_options_->max_file_opening_threads);
+        ColumnFamilyData* cfd = versions[version_idx].first;
+        Version* v = versions[version_idx].second;
+        auto builders_iter = builders.find(cfd->GetID());
+        assert(builders_iter != builders.end());
+        auto* builder = builders_iter->second->version_builder();
+
+        if (db_options_->max_open_files == -1) {
+          // unlimited table cache. Pre-load table handle now.
+          // Need to do it out of the mutex.
+          builder->LoadTableHandlers(cfd->internal_stats(), file_threads);
+        }
+
+        builder->SaveTo(v->storage_info());
+        v->PrepareApply(*cfd->GetLatestMutableCFOptions(),
+            !(db_options_->skip_stats_update_on_db_open));
       }
+    };
 
-      Version* v = new Version(cfd, this, current_version_number_++);
-      builder->SaveTo(v->storage_info());
+    if (cf_threads <= 1) {
+      build_versions_func();
+    } else {
+      std::vector<std::thread> threads;
+      for (int i = 0; i < cf_threads; i++) {
+        threads.emplace_back(build_versions_func);
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+    }
 
-      // Install recovered version
-      v->PrepareApply(*cfd->GetLatestMutableCFOptions(),
-          !(db_options_->skip_stats_update_on_db_open));
-      AppendVersion(cfd, v);
+    // Install recovered versions
+    for (auto& cfd_version : versions) {
+      AppendVersion(cfd_version.first, cfd_version.second);
     }
 
     manifest_file_size_ = current_manifest_file_size;
@@ -3103,7 +3416,8 @@ Status VersionSet::WriteSnapshot(log::Writer* log) {
           edit.AddFile(level, f->fd.GetNumber(), f->fd.GetPathId(),
                        f->fd.GetFileSize(), f->smallest, f->largest,
                        f->smallest_seqno, f->largest_seqno,
-                       f->marked_for_compaction, f->fd.GetFileSizeTotal());  // Shichao
+                       f->marked_for_compaction, f->fd.GetFileSizeTotal(),  // Shichao
+                       f->sub_path_ids, f->blob_refs, f->flush_id);
         }
       }
       edit.SetLogNumber(cfd->GetLogNumber());
@@ -3268,6 +3582,16 @@ void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list) {
   }
 }
 
+void VersionSet::AddLiveBlobFiles(std::vector<uint64_t>* live_list) {
+  for (auto cfd : *column_family_set_) {
+    Version* dummy_versions = cfd->dummy_versions();
+    for (Version* v = dummy_versions->next_; v != dummy_versions;
+         v = v->next_) {
+      v->AddLiveBlobFiles(live_list);
+    }
+  }
+}
+
 InternalIterator* VersionSet::MakeInputIterator(const Compaction* c) {
   auto cfd = c->column_family_data();
   ReadOptions read_options;
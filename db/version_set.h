@@ -25,6 +25,7 @@
 #pragma once
 #include <atomic>
 #include <deque>
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
@@ -58,6 +59,7 @@ class InternalIterator;
 class LogBuffer;
 class LookupKey;
 class MemTable;
+class ReadCallback;
 class Version;
 class VersionSet;
 class WriteBuffer;
@@ -211,6 +213,11 @@ class VersionStorageInfo {
 
   void set_l0_delay_trigger_count(int v) { l0_delay_trigger_count_ = v; }
 
+  // Sets (*runs)[i] to the sorted run of the i-th level-0 file, where a run
+  // gathers the files of one flush split into subflushes, i.e. of the same
+  // non-zero flush_id. Returns the number of runs.
+  int Level0SortedRuns(std::vector<int>* runs) const;
+
   // REQUIRES: This version has been saved (see VersionSet::SaveTo)
   int NumLevelFiles(int level) const {
     assert(finalized_);
@@ -450,7 +457,8 @@ class Version {
   // REQUIRES: lock is not held
   void Get(const ReadOptions&, const LookupKey& key, std::string* val,
            Status* status, bool* value_found = nullptr,
-           bool* key_exists = nullptr, SequenceNumber* seq = nullptr);
+           bool* key_exists = nullptr, SequenceNumber* seq = nullptr,
+           ReadCallback* callback = nullptr);
 
   /**************** Shichao *******************/
   void RangeQuery(ReadOptions& read_options, const LookupRange& range,
@@ -472,6 +480,10 @@ class Version {
   // Add all files listed in the current version to *live.
   void AddLiveFiles(std::vector<FileDescriptor>* live);
 
+  // Add the blob files referenced by the files of the current version to
+  // *live, possibly more than once.
+  void AddLiveBlobFiles(std::vector<uint64_t>* live);
+
   // Return a human readable string that describes this version's contents.
   std::string DebugString(bool hex = false) const;
 
@@ -496,6 +508,12 @@ class Version {
   Status GetPropertiesOfTablesInRange(const Range* range, std::size_t n,
                                       TablePropertiesCollection* props) const;
 
+  // Estimates the statistics of the rows in range from the table properties
+  // of the files, see DB::EstimateRangeStats().
+  Status EstimateRangeStats(const Range& range,
+                            const std::vector<uint32_t>& columns,
+                            RangeStats* stats) const;
+
   // REQUIRES: lock is held
   // On success, "tp" will contains the aggregated table property amoug
   // the table properties of all sst files in this version.
@@ -594,6 +612,17 @@ class VersionSet {
       bool new_descriptor_log = false,
       const ColumnFamilyOptions* column_family_options = nullptr);
 
+  // Apply one edit per column family as an atomic group: the edits are
+  // written to the MANIFEST together and Recover() replays either all or
+  // none of them. Column families dropped in the meantime are skipped.
+  // REQUIRES: *mu is held on entry.
+  // REQUIRES: edits are not column family manipulations
+  Status LogAndApply(
+      const std::vector<ColumnFamilyData*>& column_family_datas,
+      const std::vector<const MutableCFOptions*>& mutable_cf_options_list,
+      const std::vector<VersionEdit*>& edit_list, InstrumentedMutex* mu,
+      Directory* db_directory = nullptr);
+
   // Recover the last saved descriptor from persistent storage.
   // If read_only == true, Recover() will not complain if some column families
   // are not opened
@@ -678,6 +707,9 @@ class VersionSet {
   // Add all files listed in any live version to *live.
   void AddLiveFiles(std::vector<FileDescriptor>* live_list);
 
+  // Add the blob files referenced by any live version to *live_list.
+  void AddLiveBlobFiles(std::vector<uint64_t>* live_list);
+
   // Return the approximate size of data to be scanned for range [start, end)
   // in levels [start_level, end_level). If end_level == 0 it will search
   // through all non-empty levels
@@ -761,6 +793,9 @@ class VersionSet {
   // Current size of manifest file
   uint64_t manifest_file_size_;
 
+  // Size of the snapshot the current manifest file starts with
+  uint64_t manifest_snapshot_size_;
+
   std::vector<FileMetaData*> obsolete_files_;
   std::vector<std::string> obsolete_manifests_;
 
@@ -778,6 +813,13 @@ class VersionSet {
   void LogAndApplyCFHelper(VersionEdit* edit);
   void LogAndApplyHelper(ColumnFamilyData* cfd, VersionBuilder* b, Version* v,
                          VersionEdit* edit, InstrumentedMutex* mu);
+
+  // Write batch_edits to the MANIFEST, rolling it over first if needed, and
+  // run prepare_versions while *mu is released.
+  Status WriteManifestEdits(const std::vector<VersionEdit*>& batch_edits,
+                            InstrumentedMutex* mu, Directory* db_directory,
+                            bool new_descriptor_log,
+                            const std::function<void()>& prepare_versions);
 };
 
 }  // namespace vidardb
@@ -137,6 +137,43 @@ void WriteBatch::Put(ColumnFamilyHandle* column_family, const Slice& key,
   WriteBatchInternal::Put(this, GetColumnFamilyID(column_family), key, value);
 }
 
+void WriteBatchInternal::PutColumns(WriteBatch* b, uint32_t column_family_id,
+                                    const Slice& key,
+                                    const std::vector<Slice>& columns,
+                                    const Splitter* splitter) {
+  WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
+  if (column_family_id == 0) {
+    b->rep_.push_back(static_cast<char>(kTypeValue));
+  } else {
+    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyValue));
+    PutVarint32(&b->rep_, column_family_id);
+  }
+  PutLengthPrefixedSlice(&b->rep_, key);
+  size_t size = splitter->StitchedSize(columns);
+  PutVarint32(&b->rep_, static_cast<uint32_t>(size));
+  size_t offset = b->rep_.size();
+  for (size_t i = 0; i < columns.size(); i++) {
+    splitter->Append(b->rep_, columns[i], i + 1 == columns.size());
+  }
+  assert(b->rep_.size() - offset == size);
+  (void)offset;
+}
+
+Status WriteBatch::PutColumns(ColumnFamilyHandle* column_family,
+                              const Slice& key,
+                              const std::vector<Slice>& columns) {
+  if (column_family == nullptr) {
+    return Status::InvalidArgument("PutColumns needs a column family handle.");
+  }
+  auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
+  const Splitter* splitter = cfh->cfd()->ioptions()->splitter;
+  if (splitter == nullptr) {
+    return Status::InvalidArgument("PutColumns needs a splitter.");
+  }
+  WriteBatchInternal::PutColumns(this, cfh->GetID(), key, columns, splitter);
+  return Status::OK();
+}
+
 void WriteBatchInternal::Delete(WriteBatch* b, uint32_t column_family_id,
                                 const Slice& key) {
   WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
@@ -270,6 +307,9 @@ Status ReadRecordFromWriteBatch(Slice* input, char* tag,
       }
       break;
     case kTypeColumnFamilyDeletion:
+      if (!GetVarint32(input, column_family)) {
+        return Status::Corruption("bad WriteBatch Delete");
+      }
     // intentional fallthrough
     case kTypeDeletion:
       if (!GetLengthPrefixedSlice(input, key)) {
@@ -307,7 +347,12 @@ Status ReadRecordFromWriteBatch(Slice* input, char* tag,
 }
 
 Status WriteBatch::Iterate(Handler* handler) const {
-  Slice input(rep_);
+  return WriteBatchInternal::Iterate(rep_, handler);
+}
+
+Status WriteBatchInternal::Iterate(const Slice& contents,
+                                   WriteBatch::Handler* handler) {
+  Slice input(contents);
   if (input.size() < WriteBatchInternal::kHeader) {
     return Status::Corruption("malformed WriteBatch (too small)");
   }
@@ -361,7 +406,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
   if (!s.ok()) {
     return s;
   }
-  if (found != WriteBatchInternal::Count(this)) {
+  if (found != static_cast<int>(DecodeFixed32(contents.data() + 8))) {
     return Status::Corruption("WriteBatch has wrong count");
   } else {
     return Status::OK();
@@ -381,6 +426,8 @@ class MemTableInserter : public WriteBatch::Handler {
   const bool concurrent_memtable_writes_;
   // current recovered transaction we are rebuilding (recovery)
   WriteBatch* rebuilding_trx_;
+  // sequence number of its first update
+  SequenceNumber rebuilding_trx_seq_;
 
   // cf_mems should not be shared with concurrent inserters
   MemTableInserter(SequenceNumber sequence, ColumnFamilyMemTables* cf_mems,
@@ -396,7 +443,8 @@ class MemTableInserter : public WriteBatch::Handler {
         log_number_ref_(0),
         db_(reinterpret_cast<DBImpl*>(db)),
         concurrent_memtable_writes_(concurrent_memtable_writes),
-        rebuilding_trx_(nullptr) {
+        rebuilding_trx_(nullptr),
+        rebuilding_trx_seq_(0) {
     assert(cf_mems_);
   }
 
@@ -452,8 +500,11 @@ class MemTableInserter : public WriteBatch::Handler {
     }
 
     MemTable* mem = cf_mems_->GetMemTable();
-
-    mem->Add(sequence_, kTypeValue, key, value, concurrent_memtable_writes_);
+    if (!mem->GetMemTableOptions()->inplace_update_support) {
+      mem->Add(sequence_, kTypeValue, key, value, concurrent_memtable_writes_);
+    } else {
+      mem->Update(sequence_, key, value);
+    }
 
     // Since all Puts are logged in transaction logs (if enabled), always bump
     // sequence number. Even if the update eventually fails and does not result
@@ -512,11 +563,12 @@ class MemTableInserter : public WriteBatch::Handler {
 
       // we are now iterating through a prepared section
       rebuilding_trx_ = new WriteBatch();
+      rebuilding_trx_seq_ = sequence_;
     } else {
       // in non-recovery we ignore prepare markers
-      // and insert the values directly. making sure we have a
-      // log for each insertion to reference.
-      assert(log_number_ref_ > 0);
+      // and insert the values directly. a write-prepared transaction
+      // inserts them at prepare time, without a log to reference: its
+      // log is kept by MarkLogAsContainingPrepSection() until it commits.
     }
 
     return Status::OK();
@@ -529,11 +581,10 @@ class MemTableInserter : public WriteBatch::Handler {
     if (recovering_log_number_ != 0) {
       assert(db_->allow_2pc());
       db_->InsertRecoveredTransaction(recovering_log_number_, name.ToString(),
-                                      rebuilding_trx_);
+                                      rebuilding_trx_, rebuilding_trx_seq_);
       rebuilding_trx_ = nullptr;
     } else {
       assert(rebuilding_trx_ == nullptr);
-      assert(log_number_ref_ > 0);
     }
 
     return Status::OK();
@@ -70,6 +70,12 @@ class WriteBatchInternal {
   static void Put(WriteBatch* batch, uint32_t column_family_id,
                   const Slice& key, const Slice& value);
 
+  // Put of a value stitched by splitter from columns, which are appended
+  // directly to the batch.
+  static void PutColumns(WriteBatch* batch, uint32_t column_family_id,
+                         const Slice& key, const std::vector<Slice>& columns,
+                         const Splitter* splitter);
+
   static void Delete(WriteBatch* batch, uint32_t column_family_id,
                      const Slice& key);
 
@@ -108,6 +114,10 @@ class WriteBatchInternal {
 
   static void SetContents(WriteBatch* batch, const Slice& contents);
 
+  // Same as WriteBatch::Iterate on the batch of the given contents, without
+  // copying them into a WriteBatch.
+  static Status Iterate(const Slice& contents, WriteBatch::Handler* handler);
+
   // Inserts batches[i] into memtable, for i in 0..num_batches-1 inclusive.
   //
   // If ignore_missing_column_families == true. WriteBatch
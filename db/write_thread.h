@@ -21,6 +21,8 @@
 
 namespace vidardb {
 
+class PreReleaseCallback;
+
 class WriteThread {
  public:
   enum State : uint8_t {
@@ -87,6 +89,7 @@ class WriteThread {
     ParallelGroup* parallel_group;
     SequenceNumber sequence;  // the sequence number to use
     Status status;            // status of memtable inserter
+    PreReleaseCallback* pre_release_callback;
     std::aligned_storage<sizeof(std::mutex)>::type state_mutex_bytes;
     std::aligned_storage<sizeof(std::condition_variable)>::type state_cv_bytes;
     Writer* link_older;  // read/write only before linking, or as leader
@@ -103,6 +106,7 @@ class WriteThread {
           made_waitable(false),
           state(STATE_INIT),
           parallel_group(nullptr),
+          pre_release_callback(nullptr),
           link_older(nullptr),
           link_newer(nullptr) {}
 
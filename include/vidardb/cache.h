@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 #include <memory>
+#include "vidardb/memory_allocator.h"
 #include "vidardb/slice.h"
 #include "vidardb/status.h"
 
@@ -42,9 +43,16 @@ extern std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits);
 extern std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
                                           bool strict_capacity_limit);
 
+// Same as above, but the blocks inserted by the table readers are allocated
+// with memory_allocator, which the cache keeps alive as long as its entries.
+extern std::shared_ptr<Cache> NewLRUCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    std::shared_ptr<MemoryAllocator> memory_allocator);
+
 class Cache {
  public:
-  Cache() {}
+  explicit Cache(std::shared_ptr<MemoryAllocator> memory_allocator = nullptr)
+      : memory_allocator_(std::move(memory_allocator)) {}
 
   // Destroys all existing entries by calling the "deleter"
   // function that was passed via the Insert() function.
@@ -147,6 +155,11 @@ class Cache {
   // Prerequisit: no entry is referenced.
   virtual void EraseUnRefEntries() = 0;
 
+  // The allocator of the blocks inserted by the table readers, unless
+  // TableOptions::memory_allocator overrides it. Their usable size is charged
+  // to the cache.
+  MemoryAllocator* memory_allocator() const { return memory_allocator_.get(); }
+
  private:
   void LRU_Remove(Handle* e);
   void LRU_Append(Handle* e);
@@ -155,6 +168,9 @@ class Cache {
   // No copying allowed
   Cache(const Cache&);
   Cache& operator=(const Cache&);
+
+  // Destroyed after the entries of the derived cache
+  std::shared_ptr<MemoryAllocator> memory_allocator_;
 };
 
 }  // namespace vidardb
@@ -0,0 +1,44 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#ifndef STORAGE_VIDARDB_INCLUDE_COMPACTION_FILTER_H_
+#define STORAGE_VIDARDB_INCLUDE_COMPACTION_FILTER_H_
+
+#include <string>
+
+#include "vidardb/slice.h"
+
+namespace vidardb {
+
+// CompactionFilter allows an application to modify/delete a key-value at
+// the time of compaction. A CompactionFilter implementation must be
+// thread-safe since vidardb may invoke it concurrently from multiple
+// compactions.
+class CompactionFilter {
+ public:
+  virtual ~CompactionFilter() {}
+
+  // The compaction process invokes this method for the newest version of a
+  // key that is not visible to any snapshot, i.e. only if nobody can read an
+  // older version of it any more. Flushes do not invoke it.
+  //
+  // Return true if the key-value should be removed: it is then replaced by a
+  // deletion. Otherwise, if *value_changed is set to true, the value is
+  // replaced by *new_value.
+  virtual bool Filter(int level, const Slice& key, const Slice& existing_value,
+                      std::string* new_value, bool* value_changed) const = 0;
+
+  // Returns a name that identifies this compaction filter.
+  // The name will be printed to LOG file on start up for diagnosis.
+  virtual const char* Name() const = 0;
+};
+
+}  // namespace vidardb
+
+#endif  // STORAGE_VIDARDB_INCLUDE_COMPACTION_FILTER_H_
@@ -16,6 +16,8 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <functional>
+#include <future>
 #include <memory>
 #include <vector>
 #include <string>
@@ -138,6 +140,30 @@ struct RangeQueryKeyVal {
 typedef std::unordered_map<std::string, std::shared_ptr<const TableProperties>>
     TablePropertiesCollection;
 
+// Estimated statistics of a column over a key range, an empty column value
+// counting as a null.
+struct ColumnStats {
+  uint32_t column;
+  uint64_t num_nulls;
+  // Distinct non null values
+  uint64_t num_distinct;
+  // Bounds of equi-depth buckets of the non null values, i.e. about the same
+  // number of values falls between each pair of consecutive bounds. The first
+  // and the last ones are the smallest and the largest values seen. Empty if
+  // nothing is known about the column.
+  std::vector<std::string> histogram;
+
+  ColumnStats() : column(0), num_nulls(0), num_distinct(0) {}
+};
+
+struct RangeStats {
+  uint64_t num_rows;
+  // In the order of the requested columns
+  std::vector<ColumnStats> columns;
+
+  RangeStats() : num_rows(0) {}
+};
+
 
 // A DB is a persistent ordered map from keys to values.
 // A DB is safe for concurrent access from multiple threads without
@@ -227,6 +253,20 @@ class DB {
     return Put(options, DefaultColumnFamily(), key, value);
   }
 
+  // Set the database entry for "key" to the value made of columns, stitched
+  // by the splitter of the column family while written to the batch, so the
+  // caller needs not stitch them beforehand. Returns InvalidArgument if the
+  // column family has no splitter.
+  // Note: consider setting options.sync = true.
+  virtual Status PutColumns(const WriteOptions& options,
+                            ColumnFamilyHandle* column_family,
+                            const Slice& key,
+                            const std::vector<Slice>& columns);
+  virtual Status PutColumns(const WriteOptions& options, const Slice& key,
+                            const std::vector<Slice>& columns) {
+    return PutColumns(options, DefaultColumnFamily(), key, columns);
+  }
+
   // Remove the database entry (if any) for "key".  Returns OK on
   // success, and a non-OK status on error.  It is not an error if "key"
   // did not exist in the database.
@@ -259,6 +299,24 @@ class DB {
     return Get(options, DefaultColumnFamily(), key, value);
   }
 
+  // As Get(), but stores the value of each column in columns, from 1 to
+  // MAX_COLUMN_INDEX, into the same position of *values, split by the
+  // splitter of the column family. Only these columns are read from column
+  // tables. If columns is empty, stores all the columns of the value.
+  // Returns InvalidArgument if the column family has no splitter.
+  virtual Status GetColumns(const ReadOptions& /*options*/,
+                            ColumnFamilyHandle* /*column_family*/,
+                            const Slice& /*key*/,
+                            const std::vector<uint32_t>& /*columns*/,
+                            std::vector<std::string>* /*values*/) {
+    return Status::NotSupported("Not implemented");
+  }
+  virtual Status GetColumns(const ReadOptions& options, const Slice& key,
+                            const std::vector<uint32_t>& columns,
+                            std::vector<std::string>* values) {
+    return GetColumns(options, DefaultColumnFamily(), key, columns, values);
+  }
+
   /***************** Shichao **********************/
   // OLAP, given a range of keys, return attribute(s) values.
   // If another subrange query exists, it returns true, else false.
@@ -276,6 +334,68 @@ class DB {
   }
   /***************** Shichao **********************/
 
+  // Called once with the outcome of a GetAsync(), and the value if found.
+  typedef std::function<void(const Status&, std::string&&)> GetCallback;
+
+  // Called once with the outcome of a RangeQueryAsync(), and whether another
+  // subrange query exists, as returned by RangeQuery().
+  typedef std::function<void(const Status&, bool)> RangeQueryCallback;
+
+  // As Get(), without waiting for I/O. If the value is found in the
+  // memtables or the block cache, callback is called before returning.
+  // Otherwise the lookup goes to the read executor of the DB
+  // (DBOptions::async_read_threads), and callback is called on one of its
+  // threads. Callbacks should not block, since they hold up the executor.
+  virtual void GetAsync(const ReadOptions& /*options*/,
+                        ColumnFamilyHandle* /*column_family*/,
+                        const Slice& /*key*/, GetCallback callback) {
+    callback(Status::NotSupported("Not implemented"), std::string());
+  }
+  void GetAsync(const ReadOptions& options, const Slice& key,
+                GetCallback callback) {
+    GetAsync(options, DefaultColumnFamily(), key, std::move(callback));
+  }
+  std::future<std::pair<Status, std::string>> GetAsync(
+      const ReadOptions& options, ColumnFamilyHandle* column_family,
+      const Slice& key);
+
+  // As RangeQuery(), on the read executor of the DB. options and res are
+  // used until callback is called, and options keeps the state of the
+  // subrange queries between the calls as in RangeQuery(). range is copied.
+  virtual void RangeQueryAsync(ReadOptions& /*options*/,
+                               ColumnFamilyHandle* /*column_family*/,
+                               const Range& /*range*/,
+                               std::list<RangeQueryKeyVal>& /*res*/,
+                               RangeQueryCallback callback) {
+    callback(Status::NotSupported("Not implemented"), false);
+  }
+  void RangeQueryAsync(ReadOptions& options, const Range& range,
+                       std::list<RangeQueryKeyVal>& res,
+                       RangeQueryCallback callback) {
+    RangeQueryAsync(options, DefaultColumnFamily(), range, res,
+                    std::move(callback));
+  }
+  std::future<std::pair<Status, bool>> RangeQueryAsync(
+      ReadOptions& options, ColumnFamilyHandle* column_family,
+      const Range& range, std::list<RangeQueryKeyVal>& res);
+
+  // Appends to res, in key order, up to n rows picked at random among the
+  // ones in range, both ends included, as of options.snapshot. Their values
+  // are projected on options.columns as in RangeQuery(). Rather than
+  // scanning the range, the rows are drawn from random data blocks of the
+  // files and the memtables overlapping it, weighted by their size within the
+  // range, so the cost grows with n and not with the size of the range.
+  virtual Status SampleRange(const ReadOptions& /*options*/,
+                             ColumnFamilyHandle* /*column_family*/,
+                             const Range& /*range*/, size_t /*n*/,
+                             std::list<RangeQueryKeyVal>& /*res*/) {
+    return Status::NotSupported("Not implemented");
+  }
+  virtual Status SampleRange(const ReadOptions& options, const Range& range,
+                             size_t n, std::list<RangeQueryKeyVal>& res) {
+    return SampleRange(options, DefaultColumnFamily(), range, n, res);
+  }
+
   // Return a heap-allocated iterator over the contents of the database.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -366,6 +486,11 @@ class DB {
     //      running compactions.
     static const std::string kNumRunningCompactions;
 
+    //  "vidardb.compaction-time-share" - returns the percentage of the time
+    //      spent by all the compactions of the DB that went to compacting the
+    //      target column family.
+    static const std::string kCompactionTimeShare;
+
     //  "vidardb.background-errors" - returns accumulated number of background
     //      errors.
     static const std::string kBackgroundErrors;
@@ -498,6 +623,7 @@ class DB {
   //  "vidardb.estimate-pending-compaction-bytes"
   //  "vidardb.num-running-compactions"
   //  "vidardb.num-running-flushes"
+  //  "vidardb.compaction-time-share"
   virtual bool GetIntProperty(ColumnFamilyHandle* column_family,
                               const Slice& property, uint64_t* value) = 0;
   virtual bool GetIntProperty(const Slice& property, uint64_t* value) {
@@ -733,6 +859,15 @@ class DB {
       const TransactionLogIterator::ReadOptions&
           read_options = TransactionLogIterator::ReadOptions()) = 0;
 
+  // Sets *stream to a ChangeStream handing out the batches of the WAL from
+  // the one holding seq_number. See ChangeStream for the retention of the WAL
+  // files it needs.
+  virtual Status NewChangeStream(
+      SequenceNumber /*seq_number*/, unique_ptr<ChangeStream>* /*stream*/,
+      const ChangeStreamOptions& /*options*/ = ChangeStreamOptions()) {
+    return Status::NotSupported("Not implemented");
+  }
+
 // Windows API macro interference
 #undef DeleteFile
   // Delete the file name from the db directory and update the internal state to
@@ -805,6 +940,24 @@ class DB {
   virtual Status GetPropertiesOfTablesInRange(
       ColumnFamilyHandle* column_family, const Range* range, std::size_t n,
       TablePropertiesCollection* props) = 0;
+
+  // Estimates the statistics of the rows in range, both ends included, from
+  // the table properties of the files of the current version, pro-rated by
+  // the part of each file within range. No data block is read, and the rows
+  // still in the memtables are not counted. columns are numbered from 1 as in
+  // ReadOptions::columns; their statistics come from the column table files,
+  // the other files only counting in num_rows.
+  virtual Status EstimateRangeStats(ColumnFamilyHandle* /*column_family*/,
+                                    const Range& /*range*/,
+                                    const std::vector<uint32_t>& /*columns*/,
+                                    RangeStats* /*stats*/) {
+    return Status::NotSupported("Not implemented");
+  }
+  virtual Status EstimateRangeStats(const Range& range,
+                                    const std::vector<uint32_t>& columns,
+                                    RangeStats* stats) {
+    return EstimateRangeStats(DefaultColumnFamily(), range, columns, stats);
+  }
 #endif  // VIDARDB_LITE
 
   // Needed for StackableDB
@@ -250,8 +250,10 @@ class Env {
   // REQUIRES: lock has not already been unlocked.
   virtual Status UnlockFile(FileLock* lock) = 0;
 
-  // Priority for scheduling job in thread pool
-  enum Priority { LOW, HIGH, TOTAL };
+  // Priority for scheduling job in thread pool. The BOTTOM pool runs the
+  // compactions into the bottommost level, and has no thread by default.
+  // Its idle threads also run the jobs waiting in the other pools.
+  enum Priority { LOW, HIGH, BOTTOM, TOTAL };
 
   // Priority for requesting bytes in rate limiter scheduler
   enum IOPriority {
@@ -328,9 +330,12 @@ class Env {
 
   // The number of background worker threads of a specific thread pool
   // for this environment. 'LOW' is the default pool.
-  // default number: 1
+  // default number: 1, 0 for 'BOTTOM'
   virtual void SetBackgroundThreads(int number, Priority pri = LOW) = 0;
 
+  // Get the number of background worker threads of a specific thread pool.
+  virtual int GetBackgroundThreads(Priority pri = LOW) { return 0; }
+
   // Enlarge number of background worker threads of a specific thread pool
   // for this environment if it is smaller than specified. 'LOW' is the default
   // pool.
@@ -939,6 +944,10 @@ class EnvWrapper : public Env {
     return target_->SetBackgroundThreads(num, pri);
   }
 
+  int GetBackgroundThreads(Priority pri) override {
+    return target_->GetBackgroundThreads(pri);
+  }
+
   void IncBackgroundThreadsIfNeeded(int num, Priority pri) override {
     return target_->IncBackgroundThreadsIfNeeded(num, pri);
   }
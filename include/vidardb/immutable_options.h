@@ -35,6 +35,10 @@ struct ImmutableCFOptions {
 
   const Splitter* splitter;
 
+  bool inplace_update_support;
+
+  const CompactionFilter* compaction_filter;
+
   Logger* info_log;
 
   Statistics* statistics;
@@ -87,6 +91,10 @@ struct ImmutableCFOptions {
   std::vector<std::shared_ptr<EventListener>> listeners;
 
   std::shared_ptr<Cache> row_cache;
+
+  uint64_t min_blob_size;
+
+  double blob_gc_garbage_ratio;
 };
 
 }  // namespace vidardb
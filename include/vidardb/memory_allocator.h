@@ -0,0 +1,62 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stddef.h>
+#include <memory>
+
+#include "vidardb/status.h"
+
+namespace vidardb {
+
+// MemoryAllocator is an interface that a client can implement to supply the
+// buffers of the blocks read from table files, which live in the block cache
+// until they are evicted. The implementation must be thread-safe.
+class MemoryAllocator {
+ public:
+  virtual ~MemoryAllocator() {}
+
+  // Name of the allocator, for logging purpose.
+  virtual const char* Name() const = 0;
+
+  // Allocate a buffer of at least size bytes.
+  virtual void* Allocate(size_t size) = 0;
+
+  // Deallocate a buffer previously returned by Allocate().
+  virtual void Deallocate(void* p) = 0;
+
+  // Returns the memory actually occupied by the buffer p, which was allocated
+  // with allocation_size bytes. It is charged to the block cache.
+  virtual size_t UsableSize(void* p, size_t allocation_size) const {
+    return allocation_size;
+  }
+};
+
+// Create an allocator carving the buffers out of chunks of chunk_size bytes
+// by size class. A freed buffer is reused by the next one of a similar size
+// instead of going back to malloc, which avoids the fragmentation and the
+// malloc/free cost of block cache churn. Buffers larger than chunk_size / 8
+// are allocated with new[]. Chunks are only released with the allocator, so
+// its footprint is the peak usage of the block cache. Not used unless given
+// to a block cache or to TableOptions::memory_allocator.
+extern std::shared_ptr<MemoryAllocator> NewSlabMemoryAllocator(
+    size_t chunk_size = 1 << 20);
+
+// Same as NewSlabMemoryAllocator(), but the chunks are huge pages of
+// huge_page_size bytes, mapped with mmap(MAP_HUGETLB), to cut the TLB misses
+// of block scans. Huge pages must be reserved beforehand, e.g.
+//     sysctl -w vm.nr_hugepages=128
+// If none can be mapped, the allocator falls back to normal pages and asks
+// for transparent huge pages instead.
+extern std::shared_ptr<MemoryAllocator> NewHugePageMemoryAllocator(
+    size_t huge_page_size = 2 << 20);
+
+// Create an allocator using a dedicated jemalloc arena. Returns NotSupported
+// if vidardb is not built with jemalloc.
+extern Status NewJemallocMemoryAllocator(
+    std::shared_ptr<MemoryAllocator>* memory_allocator);
+
+}  // namespace vidardb
@@ -42,6 +42,7 @@
 
 #include <memory>
 #include <stdexcept>
+#include <vector>
 #include <stdint.h>
 #include <stdlib.h>
 #include "db/dbformat.h"  // Shichao
@@ -134,6 +135,11 @@ class MemTableRep {
     return 0;
   }
 
+  // Appends to entries, in order, about n or more entries spread evenly
+  // over the collection, e.g. to split it into key ranges of similar sizes.
+  // Appends nothing if sampling is not supported.
+  virtual void SampleEntries(size_t n, std::vector<const char*>* entries) {}
+
   // Report an approximation of how much memory has been used other than memory
   // that was allocated through the allocator.  Safe to call from any thread.
   virtual size_t ApproximateMemoryUsage() = 0;
@@ -30,6 +30,7 @@
 namespace vidardb {
 
 class Cache;
+class CompactionFilter;
 class Comparator;
 class Env;
 enum InfoLogLevel : unsigned char;
@@ -60,6 +61,19 @@ enum CompressionType : char {
   kDisableCompressionOption = -1,
 };
 
+// The checksum of each block of the table files and of each record of the
+// WAL files. Recorded in the table footer and in the type of the WAL
+// records, so files of any type stay readable whatever the option is.
+enum ChecksumType : char {
+  // NOTE: do not change the values of existing entries, as these are
+  // part of the persistent format on disk.
+  kCRC32c = 0x0,
+  // Based on the low 32 bits of XXH64
+  kxxHash64 = 0x1,
+  // Based on the low 32 bits of XXH3, the fastest on blocks of a few KB
+  kXXH3 = 0x2,
+};
+
 enum CompactionStyle : char {
   // level based compaction style
   kCompactionStyleLevel = 0x0,
@@ -205,6 +219,13 @@ struct ColumnFamilyOptions {
   // for columnar storage.
   std::shared_ptr<Splitter> splitter;
 
+  // A single CompactionFilter instance to call into during compaction.
+  // Allows an application to modify/delete a key-value during background
+  // compaction. It is not owned by vidardb and must outlive the DB.
+  //
+  // Default: nullptr
+  const CompactionFilter* compaction_filter;
+
   // -------------------
   // Parameters that affect performance
 
@@ -330,6 +351,18 @@ struct ColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   int level0_file_num_compaction_trigger;
 
+  // Weight of this column family when the background threads pick the next
+  // column family to compact. The one whose levels are the furthest past
+  // their compaction triggers, multiplied by this weight, goes first, but a
+  // column family whose level-0 files make the writes speed up compactions
+  // goes before the others regardless of its weight. A value of 0 is
+  // sanitized to 1.
+  //
+  // Default: 1
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t compaction_weight;
+
   // Target file size for compaction.
   // target_file_size_base is per-file size for level-1.
   // Target file size for level L can be calculated by
@@ -420,6 +453,49 @@ struct ColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t arena_block_size;
 
+  // If > 0, the memtable arena allocates its blocks from huge pages of this
+  // size (e.g. 2MB) through mmap(MAP_HUGETLB), cutting the TLB misses of skip
+  // list seeks. Huge pages must be reserved beforehand, e.g.
+  //     sysctl -w vm.nr_hugepages=20
+  // See linux doc Documentation/vm/hugetlbpage.txt. If no huge page can be
+  // mapped, the arena silently falls back to normal malloc'd blocks.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t memtable_huge_page_size;
+
+  // If > 0, every memtable keeps a bloom filter of its user keys with about
+  // this many bits per key, so that a Get of a key missing from a memtable
+  // skips its skip list search. The filter is sized from write_buffer_size,
+  // assuming entries of 64 bytes, and allocated from the memtable arena.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t memtable_bloom_bits_per_key;
+
+  // If true, a Put of a key whose latest memtable entry is a value at least
+  // as large as the new one overwrites that entry in place, instead of
+  // adding a new one. This keeps the memtables of update heavy column
+  // families with fixed size values (counters, status) from filling up.
+  // In return, GetSnapshot() returns nullptr while a column family has it,
+  // the iterators reading such keys may see values written after them, and
+  // the overwritten values never reach the WAL recovery or the table files.
+  // Not compatible with allow_concurrent_memtable_write, nor with
+  // WRITE_PREPARED transactions.
+  //
+  // Default: false
+  bool inplace_update_support;
+
+  // Number of locks guarding the in-place updates of the entries of a
+  // memtable, picked by the hash of the user key.
+  //
+  // Default: 10000
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t inplace_update_num_locks;
+
   // Disable automatic compactions. Manual compactions can still
   // be issued on this column family
   //
@@ -485,6 +561,22 @@ struct ColumnFamilyOptions {
   // Default: false
   bool report_bg_io_stats;
 
+  // If > 0, the columns of at least min_blob_size bytes (the whole value if
+  // splitter is NULL) are separated into append-only blob files by flushes
+  // and compactions, and the table files keep a small reference to them
+  // instead. Compactions then move the references around rather than
+  // rewriting the large values at every level.
+  //
+  // Default: 0 (disabled)
+  uint64_t min_blob_size;
+
+  // A compaction rewrites the blobs it meets into a new blob file when more
+  // than this fraction of their blob file is no longer referenced by any
+  // table file, so that the mostly dead file can eventually be deleted.
+  //
+  // Default: 0.5
+  double blob_gc_garbage_ratio;
+
   // Create ColumnFamilyOptions with default values for all fields
   ColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
@@ -568,9 +660,17 @@ struct DBOptions {
 
   // If max_open_files is -1, DB will open all files on DB::Open(). You can
   // use this option to increase the number of threads used to open the files.
+  // These threads are shared by the column families, whose versions are
+  // recovered in parallel on DB::Open(). RepairDB() also uses them to convert
+  // the logs and to read the table files.
   // Default: 16
   int max_file_opening_threads;
 
+  // Number of threads of the read executor of GetAsync() and
+  // RangeQueryAsync(), started on the first read that needs I/O.
+  // Default: 4
+  int async_read_threads;
+
   // Once write-ahead logs exceed this size, we will start forcing the flush of
   // column families whose memtables are backed by the oldest live WAL file
   // (i.e. the ones that are causing all the space amplification). If set to 0
@@ -671,6 +771,15 @@ struct DBOptions {
   // Default: 1 (i.e. no subcompactions)
   uint32_t max_subcompactions;
 
+  // This value represents the maximum number of threads that will
+  // concurrently perform a memtable flush job by splitting the key range of
+  // its memtables, each part written to its own level-0 file. The parts are
+  // written by the flush thread and the idle threads of the flush pool. The
+  // files of one flush do not overlap, so they count as a single sorted run
+  // towards level0_file_num_compaction_trigger and the write stall triggers.
+  // Default: 1 (i.e. no subflushes)
+  uint32_t max_subflushes;
+
   // Maximum number of concurrent background memtable flush jobs, submitted to
   // the HIGH priority thread pool.
   //
@@ -720,6 +829,14 @@ struct DBOptions {
   // The default value is MAX_INT so that roll-over does not take place.
   uint64_t max_manifest_file_size;
 
+  // manifest file is also rolled over, starting with a snapshot of the current
+  // versions, once it grows beyond manifest_snapshot_ratio times the size of
+  // the snapshot it started with and beyond manifest_preallocation_size. This
+  // bounds the number of edits replayed on DB open regardless of flush and
+  // compaction frequency. 0 disables it.
+  // Default: 8
+  uint32_t manifest_snapshot_ratio;
+
   // Number of shards used for table cache.
   int table_cache_numshardbits;
 
@@ -941,6 +1058,11 @@ struct DBOptions {
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode;
 
+  // The checksum of the records of the new WAL files. The existing ones are
+  // replayed with the checksum recorded in each record.
+  // Default: kCRC32c
+  ChecksumType wal_checksum;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -962,6 +1084,15 @@ struct DBOptions {
   // DEFAULT: false
   bool dump_malloc_stats;
 
+  // If true, the memtables of all column families are switched together and
+  // flushed as one group whose results are committed to the MANIFEST
+  // atomically, so after a crash every column family reflects the same point
+  // of the write stream. This keeps column families mutually consistent when
+  // they are written with WriteOptions::disableWAL. DB::Flush() on any column
+  // family flushes all of them.
+  // DEFAULT: false
+  bool atomic_flush;
+
   /*************************** Shichao ***********************/
   using showKeyFun = void(*)(const std::string&, std::string&);
   showKeyFun show_key_fun;
@@ -1016,6 +1147,18 @@ enum ReadTier {
                           // Get and MultiGet and does not support iterators.
 };
 
+// RangeQuery() filter on a value column: its value must be equal to one of
+// values, i.e. an equality predicate if there is only one.
+struct ColumnPredicate {
+  // From 1 to MAX_COLUMN_INDEX, as in ReadOptions::columns
+  uint32_t column;
+  std::vector<std::string> values;
+
+  ColumnPredicate() : column(0) {}
+  ColumnPredicate(uint32_t _column, const std::vector<std::string>& _values)
+      : column(_column), values(_values) {}
+};
+
 // Options that control read operations
 struct ReadOptions {
   // If true, all data read from underlying storage will be
@@ -1076,6 +1219,14 @@ struct ReadOptions {
   // Default: 0
   size_t readahead_size;
 
+  // If non-zero, forward scans read up to this many data blocks of each
+  // table file, and of each column of a column table, ahead of the iterator
+  // on background threads. The look-ahead starts at one block and doubles at
+  // every block the scan moves to. The blocks go to the block cache, or are
+  // kept by the iterator if fill_cache is false.
+  // Default: 0
+  size_t prefetch_blocks;
+
   /***************************** Quanzhao *********************************/
   // If empty, RangeQuery will return all columns, else return the specified
   // index column.
@@ -1090,6 +1241,12 @@ struct ReadOptions {
   // Default: 0
   size_t batch_capacity;
 
+  // If not empty, RangeQuery will only return the rows matching all of the
+  // predicates, which need the column family to have a splitter. The column
+  // tables resolve them with their bitmap indexes when they have some, see
+  // ColumnTableOptions::bitmap_index_max_cardinality. Iterators ignore them.
+  std::vector<ColumnPredicate> column_predicates;
+
   // Store the temporary states for RangeQuery.
   // Note: Caller should not set the value.
   void* range_query_meta;
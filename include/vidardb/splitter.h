@@ -41,6 +41,12 @@ class Splitter {
 
   // Append a sub-slice.
   virtual void Append(std::string& ss, const Slice& s, bool last) const = 0;
+
+  // The size of the string stitched from multiple sub-slices, so that they
+  // can be appended one by one in place of a length prefixed string.
+  virtual size_t StitchedSize(const std::vector<Slice>& v) const {
+    return Stitch(v).size();
+  }
 };
 
 // A built-in pipe splitter that uses '|' to split a slice.
@@ -60,6 +66,8 @@ class PipeSplitter : public Splitter {
 
   virtual void Append(std::string& ss, const Slice& s, bool last) const override;
 
+  virtual size_t StitchedSize(const std::vector<Slice>& v) const override;
+
  private:
   const char delim = '|';
 };
@@ -89,6 +97,8 @@ class EncodingSplitter : public Splitter {
                        std::string& buf) const override;
 
   virtual void Append(std::string& ss, const Slice& s, bool last) const override;
+
+  virtual size_t StitchedSize(const std::vector<Slice>& v) const override;
 };
 
 // Create a default encoding splitter
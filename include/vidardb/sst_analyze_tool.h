@@ -0,0 +1,22 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef VIDARDB_LITE
+
+namespace vidardb {
+
+// Reports how the data of a row or column table file is encoded: per column
+// sizes, block counts, value lengths, the ratio of each compression codec and
+// the full scan throughput. It can also rewrite the file with other table
+// options to compare them. Run with --help for the usage.
+class SstAnalyzeTool {
+ public:
+  int Run(int argc, char** argv);
+};
+
+}  // namespace vidardb
+
+#endif  // VIDARDB_LITE
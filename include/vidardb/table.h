@@ -18,10 +18,12 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "vidardb/env.h"
 #include "vidardb/immutable_options.h"
 #include "vidardb/iterator.h"
+#include "vidardb/memory_allocator.h"
 #include "vidardb/options.h"
 #include "vidardb/status.h"
 
@@ -49,6 +51,15 @@ struct TableOptions {
   // `FlushBlockBySizePolicy`).
   std::shared_ptr<FlushBlockPolicyFactory> flush_block_policy_factory;
 
+  // If non-NULL, the buffers of the blocks read from table files, including
+  // the sub column files, are allocated with it instead of new[], e.g.
+  // NewHugePageMemoryAllocator() to back the block cache with huge pages.
+  // Cached blocks are freed by the cache, which may outlive these options, so
+  // with a block_cache this must be the allocator the cache was created with
+  // (see NewLRUCache()), or NULL to use it. The internal cache is created
+  // with it.
+  std::shared_ptr<MemoryAllocator> memory_allocator = nullptr;
+
   // Disable block cache. If this is set to true,
   // then no block cache should be used, and the block_cache should
   // point to a nullptr object.
@@ -79,6 +90,10 @@ struct TableOptions {
 
   // Same as block_restart_interval but used for the index block.
   int index_block_restart_interval = 1;
+
+  // The checksum of the blocks of the new table files. The existing files
+  // are read with the checksum recorded in their footer.
+  ChecksumType checksum = kCRC32c;
 };
 
 struct BlockBasedTableOptions : public TableOptions {};
@@ -92,6 +107,24 @@ extern TableFactory* NewBlockBasedTableFactory(
 struct ColumnTableOptions : public TableOptions {
   // Total column number excluding key
   uint32_t column_count = 0;
+
+  // Placement of the sub column files among DBOptions::db_paths. The i-th
+  // entry is the minimal path id of column i+1: its sub column file is written
+  // to max(path id of the main file, column_path_ids[i]).
+  // Frequently projected columns should keep 0 and follow the main file as it
+  // moves down the levels, while rarely used wide columns can be pinned on a
+  // slower path from the very first flush.
+  // Missing entries are treated as 0. Empty means every sub column file sits
+  // next to its main file.
+  std::vector<uint32_t> column_path_ids;
+
+  // If > 0, every sub column file of at most this many distinct values gets a
+  // bitmap index mapping each value to its rows, which RangeQuery() uses to
+  // resolve ReadOptions::column_predicates without reading the data blocks of
+  // the rows that do not match. Meant for low cardinality columns such as
+  // flags and status codes; the files of the other columns are left without.
+  // Default: 0, no bitmap index
+  uint32_t bitmap_index_max_cardinality = 0;
 };
 
 // Create default column table factory.
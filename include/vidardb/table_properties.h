@@ -50,11 +50,15 @@ struct TablePropertiesNames {
   static const std::string kMergeOperator;
   static const std::string kPropertyCollectors;
   static const std::string kCompression;
+  // Followed by the column (from 1), statistics of the sub columns of the
+  // column tables
+  static const std::string kColumnStatsPrefix;
 };
 
 extern const std::string kPropertiesBlock;
 extern const std::string kCompressionDictBlock;
 extern const std::string kColumnBlock;  // Shichao
+extern const std::string kBitmapIndexBlock;
 
 enum EntryType {
   kEntryPut,
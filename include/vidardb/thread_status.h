@@ -47,6 +47,7 @@ struct ThreadStatus {
     HIGH_PRIORITY = 0,  // VidarDB BG thread in high-pri thread pool
     LOW_PRIORITY,  // VidarDB BG thread in low-pri thread pool
     USER,  // User thread (Non-VidarDB BG thread)
+    BOTTOM_PRIORITY,  // VidarDB BG thread in bottom-pri thread pool
     NUM_THREAD_TYPES
   };
 
@@ -6,6 +6,7 @@
 #ifndef STORAGE_VIDARDB_INCLUDE_TRANSACTION_LOG_ITERATOR_H_
 #define STORAGE_VIDARDB_INCLUDE_TRANSACTION_LOG_ITERATOR_H_
 
+#include "vidardb/slice.h"
 #include "vidardb/status.h"
 #include "vidardb/types.h"
 #include "vidardb/write_batch.h"
@@ -120,6 +121,62 @@ class TransactionLogIterator {
         : verify_checksums_(verify_checksums) {}
   };
 };
+
+// A write batch of the WAL as handed out by a ChangeStream, its contents
+// being in the format of WriteBatch::Data().
+struct ChangeRecord {
+  SequenceNumber sequence;  // of the first update in the batch
+  Slice data;
+};
+
+struct ChangeStreamOptions {
+  // If true, the checksums of the WAL records are verified.
+  // Default: true
+  bool verify_checksums;
+
+  // A call to ChangeStream::Next() stops handing out batches once it has
+  // about this many bytes of them.
+  // Default: 1MB
+  size_t max_chunk_bytes;
+
+  // The WAL files are read ahead by this many bytes at a time rather than
+  // block by block.
+  // Default: 1MB
+  size_t readahead_size;
+
+  ChangeStreamOptions()
+      : verify_checksums(true),
+        max_chunk_bytes(1 << 20),
+        readahead_size(1 << 20) {}
+};
+
+// A ChangeStream tails the WAL files of a db from a sequence number, for
+// change data capture or replication. Unlike TransactionLogIterator, it hands
+// out the batches in chunks, out of one buffer reused from call to call,
+// without copying each of them into its own WriteBatch, and goes on
+// returning the batches written after it was created.
+//
+// The WAL files must outlive their memtables, by setting WAL_ttl_seconds or
+// WAL_size_limit_MB, for the stream to reach the batches in them. A stream
+// must be deleted before its db.
+class ChangeStream {
+ public:
+  ChangeStream() {}
+  virtual ~ChangeStream() {}
+
+  // Sets *records to the next batches, in the order of their sequence
+  // numbers. The first batch returned by a stream is the one holding the
+  // update of its starting sequence number, which may come after other
+  // updates of the batch. The data of the records is valid until the next
+  // call. *records is empty once all the batches written are returned.
+  //
+  // Returns Corruption if the WAL files miss some of the batches, e.g. when
+  // they were deleted before being read.
+  virtual Status Next(std::vector<ChangeRecord>* records) = 0;
+
+  // The sequence number after the updates of the batches returned so far
+  virtual SequenceNumber NextSequence() const = 0;
+};
 } //  namespace vidardb
 
 #endif  // STORAGE_VIDARDB_INCLUDE_TRANSACTION_LOG_ITERATOR_H_
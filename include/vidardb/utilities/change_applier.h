@@ -0,0 +1,71 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef VIDARDB_LITE
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "vidardb/db.h"
+#include "vidardb/options.h"
+#include "vidardb/transaction_log.h"
+
+// Follower side of a change stream (DB::NewChangeStream()).
+//
+// The updates of each chunk of records are split into one WriteBatch per
+// thread, either by the hash of their key or by their column family, and the
+// batches are written to the follower concurrently. The updates of one key
+// always go to the same batch, so they are applied in the order of the
+// leader, but the updates of one leader batch are no longer atomic.
+//
+// After each chunk, the last applied sequence number is made durable in the
+// file CHANGE_APPLIER of the follower directory, and the updates at or
+// before it are skipped from then on. A chunk interrupted by a failure is
+// applied again from its start, which is harmless since puts and deletes
+// are idempotent.
+namespace vidardb {
+
+struct ChangeApplierOptions {
+  enum Partitioning : char {
+    kByKeyHash = 0x0,
+    kByColumnFamily = 0x1,
+  };
+
+  // Number of threads applying a chunk, the calling one included.
+  size_t num_threads = 4;
+
+  Partitioning partitioning = kByKeyHash;
+
+  // Follower column family of each leader column family id. If empty, only
+  // the default column family (id 0) is replicated, to the default one of the
+  // follower. The updates of the other column families fail Apply().
+  std::unordered_map<uint32_t, ColumnFamilyHandle*> column_families;
+
+  WriteOptions write_options;
+};
+
+class ChangeApplier {
+ public:
+  // follower must outlive *applier.
+  static Status Open(const ChangeApplierOptions& options, DB* follower,
+                     std::unique_ptr<ChangeApplier>* applier);
+
+  virtual ~ChangeApplier() {}
+
+  // Applies the updates of records, which follow each other as returned by
+  // ChangeStream::Next(). The leaders using 2PC (TransactionDB) cannot be
+  // replicated: a chunk holding 2PC markers fails with NotSupported before
+  // any of its updates is applied, and AppliedSequence() stays unchanged.
+  virtual Status Apply(const std::vector<ChangeRecord>& records) = 0;
+
+  // The last sequence number applied, 0 if none. A stream resuming the
+  // replication starts right after it.
+  virtual SequenceNumber AppliedSequence() const = 0;
+};
+
+}  // namespace vidardb
+#endif  // VIDARDB_LITE
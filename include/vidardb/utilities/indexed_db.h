@@ -0,0 +1,73 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef VIDARDB_LITE
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "vidardb/db.h"
+#include "vidardb/utilities/stackable_db.h"
+
+// Database with secondary indexes on the value columns of its column
+// families.
+//
+// The index on column i (from 1, as in ReadOptions::columns) of a column
+// family is a hidden column family mapping (column value, user key) to an
+// empty value. Put() and Write() add the index entries of the rows to the
+// same WriteBatch as the rows, so that both are committed atomically.
+// Overwritten and deleted rows leave their stale index entries behind:
+// RangeQueryByIndex() skips them, and the compactions of the index remove
+// them lazily. CompactRange() on a column family compacts its indexes too.
+namespace vidardb {
+
+class IndexedDB : public StackableDB {
+ public:
+  // Open an IndexedDB similar to DB::Open(). The hidden column families of
+  // the indexes are opened along with column_families, and are not returned
+  // in handles.
+  static Status Open(const Options& options, const std::string& dbname,
+                     IndexedDB** dbptr);
+
+  static Status Open(const DBOptions& db_options, const std::string& dbname,
+                     const std::vector<ColumnFamilyDescriptor>& column_families,
+                     std::vector<ColumnFamilyHandle*>* handles,
+                     IndexedDB** dbptr);
+
+  virtual ~IndexedDB() {}
+
+  // Creates the index on column of column_family, which must have a splitter,
+  // and fills it with the rows already there. Writes wait until it is done.
+  virtual Status CreateIndex(ColumnFamilyHandle* column_family,
+                             uint32_t column) = 0;
+
+  virtual Status DropIndex(ColumnFamilyHandle* column_family,
+                           uint32_t column) = 0;
+
+  // Fills res with the rows of column_family whose column is within range,
+  // both ends included, in the order of their keys. As in RangeQuery(), the
+  // values are projected on read_options.columns, and the rows come in
+  // batches of at most read_options.batch_capacity bytes: call it again with
+  // the same read_options while it returns true.
+  virtual bool RangeQueryByIndex(ReadOptions& read_options,
+                                 ColumnFamilyHandle* column_family,
+                                 uint32_t column, const Range& range,
+                                 std::list<RangeQueryKeyVal>& res,
+                                 Status* s) = 0;
+
+ protected:
+  // To Create an IndexedDB, call Open()
+  explicit IndexedDB(DB* db) : StackableDB(db) {}
+
+ private:
+  // No copying allowed
+  IndexedDB(const IndexedDB&);
+  void operator=(const IndexedDB&);
+};
+
+}  // namespace vidardb
+#endif  // VIDARDB_LITE
@@ -43,12 +43,56 @@ class StackableDB : public DB {
     return db_->Put(options, column_family, key, val);
   }
 
+  // As a WriteBatch given to Write(), so that the stacked DBs which override
+  // Write() see the row
+  using DB::PutColumns;
+  virtual Status PutColumns(const WriteOptions& options,
+                            ColumnFamilyHandle* column_family,
+                            const Slice& key,
+                            const std::vector<Slice>& columns) override {
+    return DB::PutColumns(options, column_family, key, columns);
+  }
+
   using DB::Get;
   virtual Status Get(ReadOptions& options, ColumnFamilyHandle* column_family,
                      const Slice& key, std::string* value) override {
     return db_->Get(options, column_family, key, value);
   }
 
+  using DB::GetColumns;
+  virtual Status GetColumns(const ReadOptions& options,
+                            ColumnFamilyHandle* column_family,
+                            const Slice& key,
+                            const std::vector<uint32_t>& columns,
+                            std::vector<std::string>* values) override {
+    return db_->GetColumns(options, column_family, key, columns, values);
+  }
+
+  using DB::SampleRange;
+  virtual Status SampleRange(const ReadOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Range& range, size_t n,
+                             std::list<RangeQueryKeyVal>& res) override {
+    return db_->SampleRange(options, column_family, range, n, res);
+  }
+
+  using DB::GetAsync;
+  virtual void GetAsync(const ReadOptions& options,
+                        ColumnFamilyHandle* column_family, const Slice& key,
+                        GetCallback callback) override {
+    db_->GetAsync(options, column_family, key, std::move(callback));
+  }
+
+  using DB::RangeQueryAsync;
+  virtual void RangeQueryAsync(ReadOptions& options,
+                               ColumnFamilyHandle* column_family,
+                               const Range& range,
+                               std::list<RangeQueryKeyVal>& res,
+                               RangeQueryCallback callback) override {
+    db_->RangeQueryAsync(options, column_family, range, res,
+                         std::move(callback));
+  }
+
   using DB::AddFile;
   virtual Status AddFile(ColumnFamilyHandle* column_family,
                          const ExternalSstFileInfo* file_info,
@@ -237,12 +281,26 @@ class StackableDB : public DB {
     return db_->GetPropertiesOfTablesInRange(column_family, range, n, props);
   }
 
+  using DB::EstimateRangeStats;
+  virtual Status EstimateRangeStats(ColumnFamilyHandle* column_family,
+                                    const Range& range,
+                                    const std::vector<uint32_t>& columns,
+                                    RangeStats* stats) override {
+    return db_->EstimateRangeStats(column_family, range, columns, stats);
+  }
+
   virtual Status GetUpdatesSince(
       SequenceNumber seq_number, unique_ptr<TransactionLogIterator>* iter,
       const TransactionLogIterator::ReadOptions& read_options) override {
     return db_->GetUpdatesSince(seq_number, iter, read_options);
   }
 
+  virtual Status NewChangeStream(
+      SequenceNumber seq_number, unique_ptr<ChangeStream>* stream,
+      const ChangeStreamOptions& options = ChangeStreamOptions()) override {
+    return db_->NewChangeStream(seq_number, stream, options);
+  }
+
   virtual ColumnFamilyHandle* DefaultColumnFamily() const override {
     return db_->DefaultColumnFamily();
   }
@@ -22,6 +22,17 @@ namespace vidardb {
 
 class TransactionDBMutexFactory;
 
+enum TxnDBWritePolicy {
+  // Write to the memtables only at commit. Prepare only writes to the WAL, so
+  // the commit of a large transaction writes all its data again.
+  WRITE_COMMITTED = 0,
+  // Write to the memtables at prepare, and only a commit marker at commit.
+  // The reads skip the data of the transactions not committed in their
+  // snapshot. RangeQuery(), RangeQueryAsync(), SampleRange(), GetAsync() and
+  // GetColumns() are not supported yet.
+  WRITE_PREPARED,
+};
+
 struct TransactionDBOptions {
   // Specifies the maximum number of keys that can be locked at the same time
   // per column family.
@@ -63,6 +74,10 @@ struct TransactionDBOptions {
   // condition variable for all transaction locking instead of the default
   // mutex/condvar implementation.
   std::shared_ptr<TransactionDBMutexFactory> custom_mutex_factory;
+
+  // When the data of the transactions is written to the memtables. See
+  // TxnDBWritePolicy.
+  TxnDBWritePolicy write_policy = WRITE_COMMITTED;
 };
 
 struct TransactionOptions {
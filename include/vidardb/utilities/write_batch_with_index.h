@@ -85,9 +85,15 @@ class WriteBatchWithIndex : public WriteBatchBase {
   // overwrite_key: if true, overwrite the key in the index when inserting
   //                the same key as previously, so iterator will never
   //                show two entries with the same key.
+  // hash_index: if true, the newest update of each key is also indexed by
+  //             hash, so GetFromBatchAndDB() and the overwrite of a key find
+  //             it in O(1) rather than by a search of the ordered index.
+  //             Only used for the column families with a bytewise
+  //             comparator, forward or reverse.
   explicit WriteBatchWithIndex(
       const Comparator* backup_index_comparator = BytewiseComparator(),
-      size_t reserved_bytes = 0, bool overwrite_key = false);
+      size_t reserved_bytes = 0, bool overwrite_key = false,
+      bool hash_index = false);
   virtual ~WriteBatchWithIndex();
 
   using WriteBatchBase::Put;
@@ -28,6 +28,7 @@
 #include <atomic>
 #include <stack>
 #include <string>
+#include <vector>
 #include <stdint.h>
 #include "vidardb/status.h"
 #include "vidardb/write_batch_base.h"
@@ -51,6 +52,13 @@ class WriteBatch : public WriteBatchBase {
     Put(nullptr, key, value);
   }
 
+  // Store the mapping "key->columns", with the value stitched from the
+  // columns by the splitter of column_family as they are appended to the
+  // batch, so the caller needs no stitched copy of them.
+  // Returns InvalidArgument if column_family is nullptr or has no splitter.
+  Status PutColumns(ColumnFamilyHandle* column_family, const Slice& key,
+                    const std::vector<Slice>& columns);
+
   using WriteBatchBase::Delete;
   // If the database contains a mapping for "key", erase it.  Else do nothing.
   void Delete(ColumnFamilyHandle* column_family, const Slice& key) override;
@@ -45,6 +45,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <atomic>
+#include <vector>
 #include "port/port.h"
 #include "util/allocator.h"
 #include "util/random.h"
@@ -55,6 +56,7 @@ template <class Comparator>
 class InlineSkipList {
  private:
   struct Node;
+  struct Splice;
 
  public:
   // Create a new InlineSkipList object that will use "cmp" for comparing
@@ -80,12 +82,29 @@ class InlineSkipList {
   // Like Insert, but external synchronization is not required.
   void InsertConcurrently(const char* key);
 
+  // Allocates a splice for InsertConcurrently(key, splice), from the
+  // allocator so that it lives as long as the skip list.
+  void* AllocateSplice();
+
+  // Like InsertConcurrently(key), but starts from the predecessors and
+  // successors of the previous key inserted with this splice, so a writer
+  // inserting keys in order finds their place in O(1) expected time, even
+  // with other writers inserting elsewhere.
+  //
+  // REQUIRES: no concurrent calls with the same splice
+  void InsertConcurrently(const char* key, void* splice);
+
   // Returns true iff an entry that compares equal to key is in the list.
   bool Contains(const char* key) const;
 
   // Return estimated number of entries smaller than `key`.
   uint64_t EstimateCount(const char* key) const;
 
+  // Appends to keys, in order, the keys of the highest level holding at
+  // least n of them, which are spread evenly over the list by its random
+  // heights, or all the keys if the list has fewer than n.
+  void SampleKeys(size_t n, std::vector<const char*>* keys) const;
+
   // Iteration over the contents of a skip list
   class Iterator {
    public:
@@ -194,6 +213,11 @@ class InlineSkipList {
   void FindLevelSplice(const char* key, Node* before, Node* after, int level,
                        Node** out_prev, Node** out_next);
 
+  // Inserts a key allocated by AllocateKey with compare-and-swaps, starting
+  // from the levels of splice that still bracket it, and leaves the splice
+  // around the key.
+  void InsertConcurrently(const char* key, Splice* splice);
+
   // No copying allowed
   InlineSkipList(const InlineSkipList&);
   InlineSkipList& operator=(const InlineSkipList&);
@@ -264,6 +288,17 @@ struct InlineSkipList<Comparator>::Node {
   std::atomic<Node*> next_[1];
 };
 
+// The predecessor and successor of a key at each level of the list.
+// prev_[i + 1] is at or before prev_[i], and next_[i + 1] at or after
+// next_[i], with prev_[height_] == head_ and next_[height_] == nullptr.
+// height_ of zero means the splice is yet to be filled.
+template <class Comparator>
+struct InlineSkipList<Comparator>::Splice {
+  int height_ = 0;
+  Node** prev_;
+  Node** next_;
+};
+
 template <class Comparator>
 inline InlineSkipList<Comparator>::Iterator::Iterator(
     const InlineSkipList* list) {
@@ -452,6 +487,29 @@ uint64_t InlineSkipList<Comparator>::EstimateCount(const char* key) const {
   }
 }
 
+template <class Comparator>
+void InlineSkipList<Comparator>::SampleKeys(
+    size_t n, std::vector<const char*>* keys) const {
+  // Every level holds about kBranching_ times as many keys as the one above
+  std::vector<const char*> level_keys;
+  for (int level = GetMaxHeight() - 1; level >= 0; level--) {
+    level_keys.clear();
+    Node* x = head_;
+    while (true) {
+      Node* next = x->Next(level);
+      if (next == nullptr) {
+        break;
+      }
+      level_keys.push_back(next->Key());
+      x = next;
+    }
+    if (level_keys.size() >= n) {
+      break;
+    }
+  }
+  keys->insert(keys->end(), level_keys.begin(), level_keys.end());
+}
+
 template <class Comparator>
 InlineSkipList<Comparator>::InlineSkipList(const Comparator cmp,
                                            Allocator* allocator,
@@ -591,6 +649,34 @@ void InlineSkipList<Comparator>::FindLevelSplice(const char* key, Node* before,
 
 template <class Comparator>
 void InlineSkipList<Comparator>::InsertConcurrently(const char* key) {
+  Node* prev[kMaxPossibleHeight + 1];
+  Node* next[kMaxPossibleHeight + 1];
+  Splice splice;
+  splice.prev_ = prev;
+  splice.next_ = next;
+  InsertConcurrently(key, &splice);
+}
+
+template <class Comparator>
+void* InlineSkipList<Comparator>::AllocateSplice() {
+  // prev_ and next_ of kMaxHeight_ + 1 levels follow the Splice
+  size_t array_size = sizeof(Node*) * (kMaxHeight_ + 1);
+  char* raw = allocator_->AllocateAligned(sizeof(Splice) + array_size * 2);
+  Splice* splice = new (raw) Splice();
+  splice->prev_ = reinterpret_cast<Node**>(raw + sizeof(Splice));
+  splice->next_ = reinterpret_cast<Node**>(raw + sizeof(Splice) + array_size);
+  return splice;
+}
+
+template <class Comparator>
+void InlineSkipList<Comparator>::InsertConcurrently(const char* key,
+                                                    void* splice) {
+  InsertConcurrently(key, static_cast<Splice*>(splice));
+}
+
+template <class Comparator>
+void InlineSkipList<Comparator>::InsertConcurrently(const char* key,
+                                                    Splice* splice) {
   Node* x = reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
   int height = x->UnstashHeight();
   assert(height >= 1 && height <= kMaxHeight_);
@@ -620,17 +706,51 @@ void InlineSkipList<Comparator>::InsertConcurrently(const char* key) {
   }
   assert(max_height <= kMaxPossibleHeight);
 
-  Node* prev[kMaxPossibleHeight + 1];
-  Node* next[kMaxPossibleHeight + 1];
-  prev[max_height] = head_;
-  next[max_height] = nullptr;
-  for (int i = max_height - 1; i >= 0; --i) {
-    FindLevelSplice(key, prev[i + 1], next[i + 1], i, &prev[i], &next[i]);
+  // Levels [0, recompute_height) of the splice need to be searched again.
+  int recompute_height = 0;
+  if (splice->height_ < max_height) {
+    // The splice is new, or the list has grown taller since its last use
+    splice->prev_[max_height] = head_;
+    splice->next_[max_height] = nullptr;
+    splice->height_ = max_height;
+    recompute_height = max_height;
+  } else {
+    // Climb up to the lowest level that is still tight around the key, so
+    // an in order key costs a couple of comparisons at level 0.
+    while (recompute_height < max_height) {
+      Node* prev = splice->prev_[recompute_height];
+      Node* next = splice->next_[recompute_height];
+      if (prev->Next(recompute_height) != next) {
+        // others inserted in between since
+        recompute_height++;
+      } else if (prev != head_ && !KeyIsAfterNode(key, prev)) {
+        // key is before the splice, skip the levels of the same node
+        while (recompute_height < max_height &&
+               splice->prev_[recompute_height] == prev) {
+          recompute_height++;
+        }
+      } else if (KeyIsAfterNode(key, next)) {
+        // key is after the splice, skip the levels of the same node
+        while (recompute_height < max_height &&
+               splice->next_[recompute_height] == next) {
+          recompute_height++;
+        }
+      } else {
+        // this level brackets the key, and so do all the ones above
+        break;
+      }
+    }
+  }
+  for (int i = recompute_height - 1; i >= 0; --i) {
+    FindLevelSplice(key, splice->prev_[i + 1], splice->next_[i + 1], i,
+                    &splice->prev_[i], &splice->next_[i]);
   }
+
+  bool splice_is_valid = true;
   for (int i = 0; i < height; ++i) {
     while (true) {
-      x->NoBarrier_SetNext(i, next[i]);
-      if (prev[i]->CASNext(i, next[i], x)) {
+      x->NoBarrier_SetNext(i, splice->next_[i]);
+      if (splice->prev_[i]->CASNext(i, splice->next_[i], x)) {
         // success
         break;
       }
@@ -639,9 +759,22 @@ void InlineSkipList<Comparator>::InsertConcurrently(const char* key) {
       // search, because it should be unlikely that lots of nodes have
       // been inserted between prev[i] and next[i]. No point in using
       // next[i] as the after hint, because we know it is stale.
-      FindLevelSplice(key, prev[i], nullptr, i, &prev[i], &next[i]);
+      FindLevelSplice(key, splice->prev_[i], nullptr, i, &splice->prev_[i],
+                      &splice->next_[i]);
+      // The narrower level i may no longer be within level i - 1
+      if (i > 0) {
+        splice_is_valid = false;
+      }
     }
   }
+  if (splice_is_valid) {
+    // x is now the predecessor of the next key in order
+    for (int i = 0; i < height; ++i) {
+      splice->prev_[i] = x;
+    }
+  } else {
+    splice->height_ = 0;
+  }
 }
 
 template <class Comparator>
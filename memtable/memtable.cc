@@ -22,12 +22,14 @@
 
 #include "db/dbformat.h"
 #include "db/pinned_iterators_manager.h"
+#include "db/read_callback.h"
 #include "db/writebuffer.h"
 #include "table/column_table_factory.h"
 #include "table/internal_iterator.h"
 #include "table/merger.h"
 #include "util/arena.h"
 #include "util/coding.h"
+#include "util/hash.h"
 #include "util/murmurhash.h"
 #include "util/mutexlock.h"
 #include "util/perf_context_imp.h"
@@ -45,6 +47,11 @@ MemTableOptions::MemTableOptions(const ImmutableCFOptions& ioptions,
                                  const MutableCFOptions& mutable_cf_options)
     : write_buffer_size(mutable_cf_options.write_buffer_size),
       arena_block_size(mutable_cf_options.arena_block_size),
+      memtable_huge_page_size(mutable_cf_options.memtable_huge_page_size),
+      memtable_bloom_bits_per_key(
+          mutable_cf_options.memtable_bloom_bits_per_key),
+      inplace_update_support(ioptions.inplace_update_support),
+      inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
       statistics(ioptions.statistics),
       info_log(ioptions.info_log),
       splitter(ioptions.splitter) {}
@@ -57,10 +64,13 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       moptions_(ioptions, mutable_cf_options),
       refs_(0),
       kArenaBlockSize(OptimizeBlockSize(moptions_.arena_block_size)),
-      arena_(moptions_.arena_block_size, 0),
+      arena_(moptions_.arena_block_size, moptions_.memtable_huge_page_size),
       allocator_(&arena_, write_buffer),
       table_(ioptions.memtable_factory->CreateMemTableRep(
           comparator_, &allocator_, ioptions.info_log)),
+      locks_(moptions_.inplace_update_support
+                 ? std::max<size_t>(moptions_.inplace_update_num_locks, 1)
+                 : 0),
       data_size_(0),
       num_entries_(0),
       num_deletes_(0),
@@ -73,6 +83,16 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       min_prep_log_referenced_(0),
       flush_state_(FLUSH_NOT_REQUESTED),
       env_(ioptions.env) {
+  if (moptions_.memtable_bloom_bits_per_key > 0) {
+    // entries of 64 bytes are assumed
+    uint64_t bits = moptions_.write_buffer_size / 64 *
+                    moptions_.memtable_bloom_bits_per_key;
+    bloom_filter_.reset(new DynamicBloom(
+        &allocator_, static_cast<uint32_t>(std::min<uint64_t>(
+                         bits, std::numeric_limits<uint32_t>::max())),
+        DynamicBloom::OptimalNumProbes(moptions_.memtable_bloom_bits_per_key),
+        moptions_.memtable_huge_page_size, moptions_.info_log));
+  }
   UpdateFlushState();
   // something went wrong if we need to flush before inserting anything
   assert(!ShouldScheduleFlush());
@@ -297,6 +317,14 @@ InternalIterator* MemTable::NewIterator(const ReadOptions& read_options,
   return new (mem) MemTableIterator(*this, read_options.columns, arena);
 }
 
+void MemTable::SampleUserKeys(size_t n, std::vector<Slice>* keys) {
+  std::vector<const char*> entries;
+  table_->SampleEntries(n, &entries);
+  for (auto entry : entries) {
+    keys->push_back(ExtractUserKey(GetLengthPrefixedSlice(entry)));
+  }
+}
+
 uint64_t MemTable::ApproximateSize(const Slice& start_ikey,
                                    const Slice& end_ikey) {
   uint64_t entry_count = table_->ApproximateNumEntries(start_ikey, end_ikey);
@@ -317,6 +345,11 @@ uint64_t MemTable::ApproximateSize(const Slice& start_ikey,
   return entry_count * (data_size / n);
 }
 
+port::RWMutex* MemTable::GetLock(const Slice& key) {
+  assert(!locks_.empty());
+  return &locks_[GetSliceHash(key) % locks_.size()];
+}
+
 void MemTable::Add(SequenceNumber s, ValueType type,
                    const Slice& key, /* user key */
                    const Slice& value, bool allow_concurrent) {
@@ -344,6 +377,9 @@ void MemTable::Add(SequenceNumber s, ValueType type,
   memcpy(p, value.data(), val_size);
   assert((unsigned)(p + val_size - buf) == (unsigned)encoded_len);
   if (!allow_concurrent) {
+    if (bloom_filter_) {
+      bloom_filter_->Add(key);
+    }
     table_->Insert(handle);
 
     // this is a bit ugly, but is the way to avoid locked instructions
@@ -369,6 +405,9 @@ void MemTable::Add(SequenceNumber s, ValueType type,
       assert(first_seqno_.load() >= earliest_seqno_.load());
     }
   } else {
+    if (bloom_filter_) {
+      bloom_filter_->AddConcurrently(key);
+    }
     table_->InsertConcurrently(handle);
 
     num_entries_.fetch_add(1, std::memory_order_relaxed);
@@ -410,6 +449,8 @@ struct Saver {
   Statistics* statistics;
   Env* env_;
   ReadOptions* read_options;  // Quanzhao
+  ReadCallback* callback;
+  bool inplace_update_support;
 };
 }  // namespace
 
@@ -435,9 +476,15 @@ static bool SaveValue(void* arg, const char* entry) {
     const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
     ValueType type;
     UnPackSequenceAndType(tag, &s->seq, &type);
+    if (s->callback != nullptr && !s->callback->IsVisible(s->seq)) {
+      return true;
+    }
 
     switch (type) {
       case kTypeValue: {
+        if (s->inplace_update_support) {
+          s->mem->GetLock(s->key->user_key())->ReadLock();
+        }
         std::string buf;  // prepare for splitting user value
         Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
         Slice user_val(ReformatUserValue(v, s->read_options->columns,
@@ -447,6 +494,9 @@ static bool SaveValue(void* arg, const char* entry) {
         if (s->get_value != nullptr) {
           s->get_value->assign(user_val.data(), user_val.size());
         }
+        if (s->inplace_update_support) {
+          s->mem->GetLock(s->key->user_key())->ReadUnlock();
+        }
         *(s->found_final_value) = true;
         return false;
       }
@@ -504,7 +554,15 @@ static bool SaveValueForRangeQuery(void* arg, const char* entry) {
 
         if (it->second.seq_ <= s->seq) {
           // TODO: might leverage move semantic later
-          Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
+          Slice v;
+          std::string copy;  // of a value that may be updated in place
+          if (s->inplace_update_support) {
+            ReadLock rl(s->mem->GetLock(user_key));
+            copy = GetLengthPrefixedSlice(key_ptr + key_length).ToString();
+            v = copy;
+          } else {
+            v = GetLengthPrefixedSlice(key_ptr + key_length);
+          }
           std::string buf;  // prepare for splitting user value
           Slice user_val(
               ReformatUserValue(v, s->read_options->columns,
@@ -513,7 +571,7 @@ static bool SaveValueForRangeQuery(void* arg, const char* entry) {
           if (it->second.seq_ < s->seq) {
             // replaced
             if (it->second.type_ == kTypeDeletion) {
-              meta->del_keys.erase(it->second.seq_);
+              meta->del_keys.erase(&*it->second.iter_);
             }
             assert(s->read_options->result_val_size >=
                 it->second.iter_->user_val.size());
@@ -525,7 +583,7 @@ static bool SaveValueForRangeQuery(void* arg, const char* entry) {
             s->read_options->result_val_size += 
                 it->second.iter_->user_val.size();
             if (type == kTypeDeletion) {
-              meta->del_keys.insert({s->seq, it->second.iter_});
+              meta->del_keys.insert({&*it->second.iter_, it->second.iter_});
             }
           } else {
             // inserted
@@ -536,7 +594,7 @@ static bool SaveValueForRangeQuery(void* arg, const char* entry) {
             s->read_options->result_val_size += delta_val_size;
             it->second.iter_ = --(s->res->end());
             if (type == kTypeDeletion) {
-              meta->del_keys.insert({s->seq, it->second.iter_});
+              meta->del_keys.insert({&*it->second.iter_, it->second.iter_});
             }
           }
 
@@ -559,7 +617,8 @@ static bool SaveValueForRangeQuery(void* arg, const char* entry) {
 /***************************** Shichao *****************************/
 
 bool MemTable::Get(ReadOptions& read_options, const LookupKey& key,
-                   std::string* value, Status* s, SequenceNumber* seq) {
+                   std::string* value, Status* s, SequenceNumber* seq,
+                   ReadCallback* callback) {
   // The sequence number is updated synchronously in version_set.h
   if (IsEmpty()) {
     // Avoiding recording stats for speed.
@@ -567,6 +626,14 @@ bool MemTable::Get(ReadOptions& read_options, const LookupKey& key,
   }
   PERF_TIMER_GUARD(get_from_memtable_time);
 
+  if (bloom_filter_) {
+    if (!bloom_filter_->MayContain(key.user_key())) {
+      PERF_COUNTER_ADD(bloom_memtable_miss_count, 1);
+      return false;
+    }
+    PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
+  }
+
   bool found_final_value = false;
 
   Saver saver;
@@ -580,6 +647,8 @@ bool MemTable::Get(ReadOptions& read_options, const LookupKey& key,
   saver.statistics = moptions_.statistics;
   saver.env_ = env_;
   saver.read_options = &read_options;
+  saver.callback = callback;
+  saver.inplace_update_support = moptions_.inplace_update_support;
   table_->Get(key, &saver, SaveValue);
 
   *seq = saver.seq;
@@ -590,6 +659,55 @@ bool MemTable::Get(ReadOptions& read_options, const LookupKey& key,
   return found_final_value;
 }
 
+void MemTable::Update(SequenceNumber seq, const Slice& key,
+                      const Slice& value) {
+  assert(moptions_.inplace_update_support);
+  LookupKey lkey(key, seq);
+  Slice mem_key = lkey.memtable_key();
+
+  std::unique_ptr<MemTableRep::Iterator> iter(
+      table_->GetDynamicPrefixIterator());
+  iter->Seek(lkey.internal_key(), mem_key.data());
+  if (iter->Valid()) {
+    // entry format is:
+    //    klength  varint32
+    //    userkey  char[klength-8]
+    //    tag      uint64
+    //    vlength  varint32
+    //    value    char[vlength]
+    const char* entry = iter->key();
+    uint32_t key_length = 0;
+    const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+    if (comparator_.comparator.user_comparator()->Equal(
+            Slice(key_ptr, key_length - 8), key)) {
+      const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
+      SequenceNumber unused;
+      ValueType type;
+      UnPackSequenceAndType(tag, &unused, &type);
+      if (type == kTypeValue) {
+        Slice prev_value = GetLengthPrefixedSlice(key_ptr + key_length);
+        uint32_t prev_size = static_cast<uint32_t>(prev_value.size());
+        uint32_t new_size = static_cast<uint32_t>(value.size());
+        // a smaller size never needs a longer varint
+        if (new_size <= prev_size) {
+          WriteLock wl(GetLock(key));
+          char* p =
+              EncodeVarint32(const_cast<char*>(key_ptr) + key_length, new_size);
+          memcpy(p, value.data(), value.size());
+          assert(static_cast<size_t>(p + value.size() - entry) <=
+                 static_cast<size_t>(VarintLength(key_length) + key_length +
+                                     VarintLength(prev_size) + prev_size));
+          RecordTick(moptions_.statistics, NUMBER_KEYS_UPDATED);
+          return;
+        }
+      }
+    }
+  }
+
+  // not found, a deletion, or not enough room
+  Add(seq, kTypeValue, key, value);
+}
+
 /***************************** Shichao *****************************/
 bool MemTable::RangeQuery(ReadOptions& read_options, const LookupRange& range,
                           std::list<RangeQueryKeyVal>& res, Status* s) {
@@ -611,6 +729,8 @@ bool MemTable::RangeQuery(ReadOptions& read_options, const LookupRange& range,
   saver.statistics = moptions_.statistics;
   saver.env_ = env_;
   saver.read_options = &read_options;
+  saver.callback = nullptr;
+  saver.inplace_update_support = moptions_.inplace_update_support;
 
   size_t old_size = res.size();
   table_->RangeQuery(range, res, &saver, SaveValueForRangeQuery);
@@ -29,6 +29,7 @@
 #include "vidardb/splitter.h"
 #include "memtable/memtable_allocator.h"
 #include "util/concurrent_arena.h"
+#include "util/dynamic_bloom.h"
 #include "util/instrumented_mutex.h"
 #include "util/mutable_cf_options.h"
 
@@ -36,6 +37,7 @@ namespace vidardb {
 class Mutex;
 class MemTableIterator;
 class MergeContext;
+class ReadCallback;
 class WriteBuffer;
 class InternalIterator;
 
@@ -45,6 +47,10 @@ struct MemTableOptions {
       const MutableCFOptions& mutable_cf_options);
   size_t write_buffer_size;
   size_t arena_block_size;
+  size_t memtable_huge_page_size;
+  uint32_t memtable_bloom_bits_per_key;
+  bool inplace_update_support;
+  size_t inplace_update_num_locks;
   Statistics* statistics;
   Logger* info_log;
   const Splitter* splitter;
@@ -167,8 +173,9 @@ class MemTable {
   // returned).  Otherwise, *seq will be set to kMaxSequenceNumber.
   // On success, *s may be set to OK, NotFound, or MergeInProgress.  Any other
   // status returned indicates a corruption or other unexpected error.
+  // The entries callback rejects, if any, are skipped.
   bool Get(ReadOptions& read_options, const LookupKey& key, std::string* value,
-           Status* s, SequenceNumber* seq);
+           Status* s, SequenceNumber* seq, ReadCallback* callback = nullptr);
 
   bool Get(ReadOptions& read_options, const LookupKey& key, std::string* value,
            Status* s) {
@@ -176,6 +183,16 @@ class MemTable {
     return Get(read_options, key, value, s, &seq);
   }
 
+  // Attempts to overwrite the value of the latest entry of key in place.
+  // If that entry is not a value at least as large as the new one, or key is
+  // not in the memtable, adds a new entry as Add() does. The overwritten
+  // entry keeps its sequence number, so that the readers which already see
+  // it keep seeing the key, hence no snapshot while in-place updates are on.
+  //
+  // REQUIRES: moptions_.inplace_update_support, and external synchronization
+  // to prevent simultaneous writes to the same MemTable.
+  void Update(SequenceNumber seq, const Slice& key, const Slice& value);
+
   /******************************* Shichao *******************************/
   // If memtable overlaps with the range including the deleted key, store
   // it in res and return true.
@@ -203,6 +220,9 @@ class MemTable {
   // Returns the edits area that is needed for flushing the memtable
   VersionEdit* GetEdits() { return &edit_; }
 
+  // The lock guarding the in-place updates of the entries of key
+  port::RWMutex* GetLock(const Slice& key);
+
   // Returns if there is no entry inserted to the mem table.
   // REQUIRES: external synchronization to prevent simultaneous
   // operations on the same MemTable (unless this Memtable is immutable).
@@ -259,11 +279,16 @@ class MemTable {
   // return true if the current MemTableRep supports snapshots.
   // inplace update prevents snapshots,
   bool IsSnapshotSupported() const {
-    return table_->IsSnapshotSupported();
+    return table_->IsSnapshotSupported() && !moptions_.inplace_update_support;
   }
 
   uint64_t ApproximateSize(const Slice& start_ikey, const Slice& end_ikey);
 
+  // Appends to keys, in order, about n or more user keys spread evenly over
+  // the memtable, or none if its representation cannot sample them. The
+  // keys live as long as the memtable.
+  void SampleUserKeys(size_t n, std::vector<Slice>* keys);
+
   const InternalKeyComparator& GetInternalKeyComparator() const {
     return comparator_.comparator;
   }
@@ -284,6 +309,10 @@ class MemTable {
   ConcurrentArena arena_;
   MemTableAllocator allocator_;
   unique_ptr<MemTableRep> table_;
+  // Bloom filter of the user keys, null if disabled
+  std::unique_ptr<DynamicBloom> bloom_filter_;
+  // Empty unless moptions_.inplace_update_support
+  std::vector<port::RWMutex> locks_;
 
   // Total data size of all data inserted
   std::atomic<uint64_t> data_size_;
@@ -106,8 +106,8 @@ int MemTableList::NumFlushed() const {
 // Operands stores the list of merge operations to apply, so far.
 bool MemTableListVersion::Get(ReadOptions& read_options, const LookupKey& key,
                               std::string* value, Status* s,
-                              SequenceNumber* seq) {
-  return GetFromList(read_options, &memlist_, key, value, s, seq);
+                              SequenceNumber* seq, ReadCallback* callback) {
+  return GetFromList(read_options, &memlist_, key, value, s, seq, callback);
 }
 
 /******************************* Shichao *******************************/
@@ -134,13 +134,15 @@ bool MemTableListVersion::GetFromHistory(ReadOptions& read_options,
 bool MemTableListVersion::GetFromList(ReadOptions& read_options,
                                       std::list<MemTable*>* list,
                                       const LookupKey& key, std::string* value,
-                                      Status* s, SequenceNumber* seq) {
+                                      Status* s, SequenceNumber* seq,
+                                      ReadCallback* callback) {
   *seq = kMaxSequenceNumber;
 
   for (auto& memtable : *list) {
     SequenceNumber current_seq = kMaxSequenceNumber;
 
-    bool done = memtable->Get(read_options, key, value, s, &current_seq);
+    bool done =
+        memtable->Get(read_options, key, value, s, &current_seq, callback);
     if (*seq == kMaxSequenceNumber) {
       // Store the most recent sequence number of any operation on this key.
       // Since we only care about the most recent change, we only need to
@@ -371,6 +373,61 @@ Status MemTableList::InstallMemtableFlushResults(
   return s;
 }
 
+Status MemTableList::InstallMemtableAtomicFlushResults(
+    const std::vector<ColumnFamilyData*>& cfds,
+    const std::vector<const MutableCFOptions*>& mutable_cf_options_list,
+    const std::vector<const std::vector<MemTable*>*>& mems_list,
+    VersionSet* vset, InstrumentedMutex* mu,
+    const std::vector<uint64_t>& file_numbers,
+    std::vector<MemTable*>* to_delete, Directory* db_directory,
+    LogBuffer* log_buffer) {
+  AutoThreadOperationStageUpdater stage_updater(
+      ThreadStatus::STAGE_MEMTABLE_INSTALL_FLUSH_RESULTS);
+  mu->AssertHeld();
+
+  std::vector<VersionEdit*> edit_list;
+  for (size_t k = 0; k < cfds.size(); ++k) {
+    const std::vector<MemTable*>& mems = *mems_list[k];
+    assert(!mems.empty());
+    for (size_t i = 0; i < mems.size(); ++i) {
+      // All the edits are associated with the first memtable of this batch.
+      assert(i == 0 || mems[i]->GetEdits()->NumEntries() == 0);
+
+      mems[i]->flush_completed_ = true;
+      mems[i]->file_number_ = file_numbers[k];
+    }
+    edit_list.push_back(mems[0]->GetEdits());
+  }
+
+  // this can release and reacquire the mutex.
+  Status s = vset->LogAndApply(cfds, mutable_cf_options_list, edit_list, mu,
+                               db_directory);
+
+  for (size_t k = 0; k < cfds.size(); ++k) {
+    MemTableList* imm = cfds[k]->imm();
+    // we will be changing the version in the next code path,
+    // so we better create a new one, since versions are immutable
+    imm->InstallNewVersion();
+    for (MemTable* m : *mems_list[k]) {
+      if (s.ok()) {  // commit new state
+        LogToBuffer(log_buffer, "[%s] Level-0 commit table #%" PRIu64
+                                " of atomic flush: memtable done",
+                    cfds[k]->GetName().c_str(), m->file_number_);
+        imm->current_->Remove(m, to_delete);
+      } else {
+        // commit failed. setup state so that we can flush again.
+        m->flush_completed_ = false;
+        m->flush_in_progress_ = false;
+        m->edit_.Clear();
+        imm->num_flush_not_started_++;
+        m->file_number_ = 0;
+        imm->imm_flush_needed.store(true, std::memory_order_release);
+      }
+    }
+  }
+  return s;
+}
+
 // New memtables are inserted at the front of the list.
 void MemTableList::Add(MemTable* m, std::vector<MemTable*>* to_delete) {
   assert(static_cast<int>(current_->memlist_.size()) >= num_flush_not_started_);
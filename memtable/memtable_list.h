@@ -33,6 +33,7 @@ class ColumnFamilyData;
 class InternalKeyComparator;
 class InstrumentedMutex;
 class MergeIteratorBuilder;
+class ReadCallback;
 
 // keeps a list of immutable memtables in a vector. the list is immutable
 // if refcount is bigger than one. It is used as a state for Get() and
@@ -57,7 +58,7 @@ class MemTableListVersion {
   // will be stored in *seq on success (regardless of whether true/false is
   // returned).  Otherwise, *seq will be set to kMaxSequenceNumber.
   bool Get(ReadOptions& read_options, const LookupKey& key, std::string* value,
-           Status* s, SequenceNumber* seq);
+           Status* s, SequenceNumber* seq, ReadCallback* callback = nullptr);
 
   bool Get(ReadOptions& read_options, const LookupKey& key, std::string* value,
            Status* s) {
@@ -89,6 +90,9 @@ class MemTableListVersion {
   void AddIterators(const ReadOptions& options,
                     MergeIteratorBuilder* merge_iter_builder);
 
+  // The immutable memtables, from the most recent one
+  const std::list<MemTable*>& GetMemTables() const { return memlist_; }
+
   uint64_t GetTotalNumEntries() const;
 
   uint64_t GetTotalNumDeletes() const;
@@ -111,7 +115,7 @@ class MemTableListVersion {
 
   bool GetFromList(ReadOptions& read_options, std::list<MemTable*>* list,
                    const LookupKey& key, std::string* value, Status* s,
-                   SequenceNumber* seq);
+                   SequenceNumber* seq, ReadCallback* callback = nullptr);
 
   void AddMemTable(MemTable* m);
 
@@ -200,6 +204,18 @@ class MemTableList {
       uint64_t file_number, std::vector<MemTable*>* to_delete,
       Directory* db_directory, LogBuffer* log_buffer);
 
+  // Commit the flushes of several column families in the manifest file as
+  // one atomic group. mems_list[i] are the memtables of cfds[i] flushed into
+  // file_numbers[i]; they must be the earliest ones of that column family.
+  static Status InstallMemtableAtomicFlushResults(
+      const std::vector<ColumnFamilyData*>& cfds,
+      const std::vector<const MutableCFOptions*>& mutable_cf_options_list,
+      const std::vector<const std::vector<MemTable*>*>& mems_list,
+      VersionSet* vset, InstrumentedMutex* mu,
+      const std::vector<uint64_t>& file_numbers,
+      std::vector<MemTable*>* to_delete, Directory* db_directory,
+      LogBuffer* log_buffer);
+
   // New memtables are inserted at the front of the list.
   // Takes ownership of the referenced held on *m by the caller of Add().
   void Add(MemTable* m, std::vector<MemTable*>* to_delete);
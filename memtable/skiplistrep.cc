@@ -12,6 +12,7 @@
 #include "memtable/memtable.h"
 #include "vidardb/memtablerep.h"
 #include "util/arena.h"
+#include "util/thread_local.h"
 
 namespace vidardb {
 namespace {
@@ -19,6 +20,9 @@ class SkipListRep : public MemTableRep {
   InlineSkipList<const MemTableRep::KeyComparator&> skip_list_;
   const MemTableRep::KeyComparator& cmp_;
   const size_t lookahead_;
+  // The splice of the last InsertConcurrently of each writer thread, which
+  // makes in order inserts cheap
+  ThreadLocalPtr splices_;
 
   friend class LookaheadIterator;
 public:
@@ -40,7 +44,12 @@ public:
   }
 
   virtual void InsertConcurrently(KeyHandle handle) override {
-    skip_list_.InsertConcurrently(static_cast<char*>(handle));
+    void* splice = splices_.Get();
+    if (splice == nullptr) {
+      splice = skip_list_.AllocateSplice();
+      splices_.Reset(splice);
+    }
+    skip_list_.InsertConcurrently(static_cast<char*>(handle), splice);
   }
 
   // Returns true iff an entry that compares equal to key is in the list.
@@ -94,6 +103,11 @@ public:
     return (end_count >= start_count) ? (end_count - start_count) : 0;
   }
 
+  virtual void SampleEntries(size_t n,
+                             std::vector<const char*>* entries) override {
+    skip_list_.SampleKeys(n, entries);
+  }
+
   virtual ~SkipListRep() override { }
 
   // Iteration over the contents of a skip list
@@ -734,6 +734,11 @@ WinEnvThreads::WinEnvThreads(Env* hosted_env) : hosted_env_(hosted_env), thread_
     // This allows later initializing the thread-local-env of each thread.
     thread_pools_[pool_id].SetHostEnv(hosted_env);
   }
+  thread_pools_[Env::Priority::BOTTOM].SetBackgroundThreads(0);
+  thread_pools_[Env::Priority::BOTTOM].AddStealVictim(
+    &thread_pools_[Env::Priority::HIGH]);
+  thread_pools_[Env::Priority::BOTTOM].AddStealVictim(
+    &thread_pools_[Env::Priority::LOW]);
 }
 
 WinEnvThreads::~WinEnvThreads() {
@@ -747,7 +752,7 @@ WinEnvThreads::~WinEnvThreads() {
 
 void WinEnvThreads::Schedule(void(*function)(void*), void* arg, Env::Priority pri,
   void* tag, void(*unschedFunction)(void* arg)) {
-  assert(pri >= Env::Priority::LOW && pri <= Env::Priority::HIGH);
+  assert(pri >= Env::Priority::LOW && pri < Env::Priority::TOTAL);
   thread_pools_[pri].Schedule(function, arg, tag, unschedFunction);
 }
 
@@ -796,7 +801,7 @@ void WinEnvThreads::WaitForJoin() {
 }
 
 unsigned int WinEnvThreads::GetThreadPoolQueueLen(Env::Priority pri) const {
-  assert(pri >= Env::Priority::LOW && pri <= Env::Priority::HIGH);
+  assert(pri >= Env::Priority::LOW && pri < Env::Priority::TOTAL);
   return thread_pools_[pri].GetQueueLen();
 }
 
@@ -812,12 +817,17 @@ void  WinEnvThreads::SleepForMicroseconds(int micros) {
 }
 
 void WinEnvThreads::SetBackgroundThreads(int num, Env::Priority pri) {
-  assert(pri >= Env::Priority::LOW && pri <= Env::Priority::HIGH);
+  assert(pri >= Env::Priority::LOW && pri < Env::Priority::TOTAL);
   thread_pools_[pri].SetBackgroundThreads(num);
 }
 
+int WinEnvThreads::GetBackgroundThreads(Env::Priority pri) {
+  assert(pri >= Env::Priority::LOW && pri < Env::Priority::TOTAL);
+  return thread_pools_[pri].GetBackgroundThreads();
+}
+
 void WinEnvThreads::IncBackgroundThreadsIfNeeded(int num, Env::Priority pri) {
-  assert(pri >= Env::Priority::LOW && pri <= Env::Priority::HIGH);
+  assert(pri >= Env::Priority::LOW && pri < Env::Priority::TOTAL);
   thread_pools_[pri].IncBackgroundThreadsIfNeeded(num);
 }
 
@@ -988,6 +998,10 @@ void  WinEnv::SetBackgroundThreads(int num, Env::Priority pri) {
   return winenv_threads_.SetBackgroundThreads(num, pri);
 }
 
+int WinEnv::GetBackgroundThreads(Env::Priority pri) {
+  return winenv_threads_.GetBackgroundThreads(pri);
+}
+
 void  WinEnv::IncBackgroundThreadsIfNeeded(int num, Env::Priority pri) {
   return winenv_threads_.IncBackgroundThreadsIfNeeded(num, pri);
 }
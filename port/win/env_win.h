@@ -57,6 +57,8 @@ public:
   // Allow increasing the number of worker threads.
   void SetBackgroundThreads(int num, Env::Priority pri);
 
+  int GetBackgroundThreads(Env::Priority pri);
+
   void IncBackgroundThreadsIfNeeded(int num, Env::Priority pri);
 
 private:
@@ -257,6 +259,8 @@ public:
   // Allow increasing the number of worker threads.
   void SetBackgroundThreads(int num, Env::Priority pri) override;
 
+  int GetBackgroundThreads(Env::Priority pri) override;
+
   void IncBackgroundThreadsIfNeeded(int num, Env::Priority pri) override;
 
   EnvOptions OptimizeForLogWrite(const EnvOptions& env_options,
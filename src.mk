@@ -1,7 +1,9 @@
 # These are the sources from which libvidardb.a is built:
 LIB_SOURCES =                                                   \
   db/auto_roll_logger.cc                                        \
+  db/blob_file.cc                                               \
   db/builder.cc                                                 \
+  db/change_stream.cc                                           \
   db/column_family.cc                                           \
   db/compaction.cc                                              \
   db/compaction_iterator.cc                                     \
@@ -27,6 +29,7 @@ LIB_SOURCES =                                                   \
   memtable/memtable_allocator.cc                                \
   memtable/memtable.cc                                          \
   memtable/memtable_list.cc                                     \
+  db/range_sampler.cc                                           \
   db/repair.cc                                                  \
   db/snapshot_impl.cc                                           \
   db/table_cache.cc                                             \
@@ -47,10 +50,13 @@ LIB_SOURCES =                                                   \
   table/block_based_table_builder.cc                            \
   table/block_based_table_factory.cc                            \
   table/block_based_table_reader.cc                             \
+  table/bitmap_index.cc                                         \
+  table/column_stats.cc                                         \
   table/column_table_builder.cc                                 \
   table/column_table_factory.cc                                 \
   table/column_table_reader.cc                                  \
   table/block_builder.cc                                        \
+  table/block_prefetcher.cc                                     \
   table/block.cc                                                \
   table/column_block_builder.cc                                 \
   table/flush_block_policy.cc                                   \
@@ -79,6 +85,7 @@ LIB_SOURCES =                                                   \
   util/sst_file_manager_impl.cc                                 \
   util/file_util.cc                                             \
   util/file_reader_writer.cc                                    \
+  util/dynamic_bloom.cc                                         \
   util/hash.cc                                                  \
   util/histogram.cc                                             \
   util/instrumented_mutex.cc                                    \
@@ -86,6 +93,7 @@ LIB_SOURCES =                                                   \
   util/event_logger.cc                                          \
   util/log_buffer.cc                                            \
   util/logging.cc                                               \
+  util/memory_allocator.cc                                      \
   util/murmurhash.cc                                            \
   util/mutable_cf_options.cc                                    \
   util/options.cc                                               \
@@ -107,6 +115,7 @@ LIB_SOURCES =                                                   \
   util/thread_status_updater_debug.cc                           \
   util/thread_status_util.cc                                    \
   util/thread_status_util_debug.cc                              \
+  util/xxhash.cc                                                \
   utilities/write_batch_with_index/write_batch_with_index.cc    \
   utilities/write_batch_with_index/write_batch_with_index_internal.cc    \
   utilities/transactions/transaction_db_mutex_impl.cc           \
@@ -115,8 +124,13 @@ LIB_SOURCES =                                                   \
   utilities/transactions/transaction_impl.cc                    \
   utilities/transactions/transaction_lock_mgr.cc                \
   utilities/transactions/transaction_db_impl.cc                 \
+  utilities/transactions/write_prepared_txn.cc                  \
+  utilities/transactions/write_prepared_txn_db.cc               \
+  utilities/change_applier/change_applier.cc                    \
+  utilities/indexed_db/indexed_db_impl.cc                       \
 
 TOOL_SOURCES = \
+  tools/sst_analyze_tool.cc                                     \
 
 MOCK_SOURCES = \
   table/mock_table.cc \
@@ -140,6 +154,8 @@ TEST_BENCH_SOURCES =                                                         \
   test/db/db_iter_test.cc                                                    \
   test/db/db_test.cc                                                         \
   test/db/db_block_cache_test.cc                                             \
+  test/db/db_blob_test.cc                                                    \
+  test/db/db_range_query_test.cc                                             \
   test/db/db_io_failure_test.cc                                              \
   test/db/db_compaction_test.cc                                              \
   test/db/db_dynamic_level_test.cc                                           \
@@ -171,7 +187,9 @@ TEST_BENCH_SOURCES =                                                         \
   test/db/wal_manager_test.cc                                                \
   test/db/write_batch_test.cc                                                \
   test/db/write_controller_test.cc                                           \
+  test/table/bitmap_index_test.cc                                            \
   test/table/block_test.cc                                                   \
+  test/table/column_stats_test.cc                                            \
   test/table/merger_test.cc                                                  \
   table/table_reader_bench.cc                                                \
   test/table/table_test.cc                                                   \
@@ -182,10 +200,16 @@ TEST_BENCH_SOURCES =                                                         \
   test/util/cache_test.cc                                                    \
   test/util/coding_test.cc                                                   \
   test/util/crc32c_test.cc                                                   \
+  test/util/xxhash_test.cc                                                   \
+  test/util/dynamic_bloom_test.cc                                            \
   test/util/env_test.cc                                                      \
   test/util/filelock_test.cc                                                 \
   test/util/histogram_test.cc                                                \
+  test/utilities/change_applier_test.cc                                      \
   test/utilities/env_registry_test.cc                                        \
+  test/utilities/indexed_db_test.cc                                          \
+  test/utilities/write_batch_with_index_test.cc                              \
+  test/utilities/write_prepared_txn_db_test.cc                               \
   test/util/iostats_context_test.cc                                          \
   util/log_write_bench.cc                                                    \
   test/util/mock_env_test.cc                                                 \
@@ -0,0 +1,191 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "table/bitmap_index.h"
+
+#include <assert.h>
+#include <algorithm>
+
+#include "util/coding.h"
+
+namespace vidardb {
+
+namespace {
+
+const uint32_t kChunkBits = 16;
+const uint32_t kChunkSize = 1u << kChunkBits;
+const uint32_t kChunkWords = kChunkSize / 64;
+const uint32_t kMaxArraySize = 4096;
+
+inline void PutFixed16(std::string* dst, uint16_t value) {
+  char buf[2];
+  buf[0] = static_cast<char>(value & 0xff);
+  buf[1] = static_cast<char>(value >> 8);
+  dst->append(buf, 2);
+}
+
+inline uint16_t DecodeFixed16(const char* ptr) {
+  return static_cast<uint16_t>(static_cast<unsigned char>(ptr[0]) |
+                               (static_cast<unsigned char>(ptr[1]) << 8));
+}
+
+}  // namespace
+
+void RoaringBitmap::Add(uint64_t ordinal) {
+  uint64_t high = ordinal >> kChunkBits;
+  uint16_t low = static_cast<uint16_t>(ordinal & (kChunkSize - 1));
+  if (chunks_.empty() || chunks_.back().high != high) {
+    assert(chunks_.empty() || chunks_.back().high < high);
+    chunks_.emplace_back();
+    chunks_.back().high = high;
+    chunks_.back().cardinality = 0;
+  }
+
+  Chunk& chunk = chunks_.back();
+  if (chunk.words.empty()) {
+    assert(chunk.array.empty() || chunk.array.back() < low);
+    chunk.array.push_back(low);
+    if (chunk.array.size() > kMaxArraySize) {
+      // too dense for an array, switch to a bitmap
+      chunk.words.assign(kChunkWords, 0);
+      for (uint16_t v : chunk.array) {
+        chunk.words[v >> 6] |= 1ull << (v & 63);
+      }
+      std::vector<uint16_t>().swap(chunk.array);
+    }
+  } else {
+    chunk.words[low >> 6] |= 1ull << (low & 63);
+  }
+  chunk.cardinality++;
+}
+
+void RoaringBitmap::EncodeTo(std::string* dst) const {
+  PutVarint32(dst, static_cast<uint32_t>(chunks_.size()));
+  for (const auto& chunk : chunks_) {
+    PutVarint64(dst, chunk.high);
+    PutVarint32(dst, chunk.cardinality);
+    if (chunk.words.empty()) {
+      for (uint16_t v : chunk.array) {
+        PutFixed16(dst, v);
+      }
+    } else {
+      for (uint64_t w : chunk.words) {
+        PutFixed64(dst, w);
+      }
+    }
+  }
+}
+
+size_t RoaringBitmap::ApproximateMemoryUsage() const {
+  size_t usage = chunks_.capacity() * sizeof(Chunk);
+  for (const auto& chunk : chunks_) {
+    usage += chunk.array.capacity() * sizeof(uint16_t) +
+             chunk.words.capacity() * sizeof(uint64_t);
+  }
+  return usage;
+}
+
+BitmapIndexBuilder::BitmapIndexBuilder(uint32_t max_cardinality)
+    : max_cardinality_(max_cardinality),
+      abandoned_(false),
+      block_(1 /* block_restart_interval */) {}
+
+void BitmapIndexBuilder::Add(const Slice& value, uint64_t ordinal) {
+  if (abandoned_) {
+    return;
+  }
+
+  buf_.assign(value.data(), value.size());
+  auto it = bitmaps_.find(buf_);
+  if (it == bitmaps_.end()) {
+    if (bitmaps_.size() >= max_cardinality_) {
+      abandoned_ = true;
+      bitmaps_.clear();
+      return;
+    }
+    it = bitmaps_.emplace(buf_, RoaringBitmap()).first;
+  }
+  it->second.Add(ordinal);
+}
+
+Slice BitmapIndexBuilder::Finish() {
+  assert(!abandoned_);
+  // std::map iterates in the bytewise order of the values
+  for (const auto& it : bitmaps_) {
+    buf_.clear();
+    it.second.EncodeTo(&buf_);
+    block_.Add(it.first, buf_);
+  }
+  return block_.Finish();
+}
+
+RowBitmap::RowBitmap(uint64_t num_rows)
+    : num_rows_(num_rows), words_((num_rows + 63) / 64, 0) {}
+
+Status RowBitmap::Or(const Slice& encoded) {
+  Slice input = encoded;
+  uint32_t num_chunks = 0;
+  if (!GetVarint32(&input, &num_chunks)) {
+    return Status::Corruption("bad bitmap index entry");
+  }
+
+  for (uint32_t i = 0; i < num_chunks; i++) {
+    uint64_t high = 0;
+    uint32_t cardinality = 0;
+    if (!GetVarint64(&input, &high) || !GetVarint32(&input, &cardinality) ||
+        cardinality > kChunkSize) {
+      return Status::Corruption("bad bitmap index chunk");
+    }
+    uint64_t base = high << kChunkBits;
+    if (base >= num_rows_) {
+      return Status::Corruption("bitmap index chunk out of range");
+    }
+
+    if (cardinality <= kMaxArraySize) {
+      if (input.size() < cardinality * 2ull) {
+        return Status::Corruption("truncated bitmap index chunk");
+      }
+      for (uint32_t j = 0; j < cardinality; j++) {
+        uint64_t ordinal = base + DecodeFixed16(input.data() + j * 2);
+        if (ordinal < num_rows_) {
+          words_[ordinal >> 6] |= 1ull << (ordinal & 63);
+        }
+      }
+      input.remove_prefix(cardinality * 2);
+    } else {
+      if (input.size() < kChunkWords * 8ull) {
+        return Status::Corruption("truncated bitmap index chunk");
+      }
+      // chunks are aligned to words, so they are simply or-ed in place
+      size_t first = static_cast<size_t>(base >> 6);
+      size_t n = std::min<size_t>(kChunkWords, words_.size() - first);
+      for (size_t j = 0; j < n; j++) {
+        words_[first + j] |= DecodeFixed64(input.data() + j * 8);
+      }
+      input.remove_prefix(kChunkWords * 8);
+    }
+  }
+  return Status::OK();
+}
+
+void RowBitmap::And(const RowBitmap& other) {
+  assert(num_rows_ == other.num_rows_);
+  // plain word loop, vectorized by the compiler
+  uint64_t* dst = words_.data();
+  const uint64_t* src = other.words_.data();
+  for (size_t i = 0, n = words_.size(); i < n; i++) {
+    dst[i] &= src[i];
+  }
+}
+
+uint64_t RowBitmap::Count() const {
+  uint64_t count = 0;
+  for (uint64_t w : words_) {
+    count += __builtin_popcountll(w);
+  }
+  return count;
+}
+
+}  // namespace vidardb
@@ -0,0 +1,113 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Bitmap index of a sub column file: every distinct column value maps to the
+// set of row ordinals holding it, compressed the Roaring way. The ordinals
+// are split on their high bits into chunks of 65536 rows, and each non-empty
+// chunk is stored either as the sorted array of its low 16 bits, or as a
+// bitmap of 1024 words once it holds more than 4096 rows.
+//
+// Encoding of a set:
+//    num_chunks: varint32
+//    chunk[0], chunk[1], ..., chunk[num_chunks-1]
+// where each chunk is
+//    high bits: varint64
+//    cardinality: varint32
+//    cardinality * fixed16 low bits if cardinality <= 4096, otherwise
+//    1024 * fixed64 words
+// The sets are stored in a meta block keyed by the column values.
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "table/block_builder.h"
+#include "vidardb/slice.h"
+#include "vidardb/status.h"
+
+namespace vidardb {
+
+// Compressed set of row ordinals, built in increasing order.
+class RoaringBitmap {
+ public:
+  RoaringBitmap() {}
+
+  // REQUIRES: ordinal is larger than any previously added one
+  void Add(uint64_t ordinal);
+
+  void EncodeTo(std::string* dst) const;
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  struct Chunk {
+    uint64_t high;
+    uint32_t cardinality;
+    std::vector<uint16_t> array;  // while cardinality <= kMaxArraySize
+    std::vector<uint64_t> words;  // afterwards
+  };
+
+  std::vector<Chunk> chunks_;
+};
+
+// Builds the bitmap index of a sub column file, unless the column turns out to
+// have more distinct values than max_cardinality.
+class BitmapIndexBuilder {
+ public:
+  BitmapIndexBuilder(const BitmapIndexBuilder&) = delete;
+  void operator=(const BitmapIndexBuilder&) = delete;
+
+  explicit BitmapIndexBuilder(uint32_t max_cardinality);
+
+  // REQUIRES: ordinal is larger than any previously added one
+  void Add(const Slice& value, uint64_t ordinal);
+
+  // True if the index is given up because of too many distinct values
+  bool abandoned() const { return abandoned_; }
+
+  bool empty() const { return bitmaps_.empty(); }
+
+  // Returns the contents of the meta block.
+  // REQUIRES: !abandoned()
+  Slice Finish();
+
+ private:
+  const uint32_t max_cardinality_;
+  bool abandoned_;
+  std::map<std::string, RoaringBitmap> bitmaps_;
+  BlockBuilder block_;
+  std::string buf_;
+};
+
+// Uncompressed set of the row ordinals of a table file, which is what the
+// encoded sets are decoded into to be combined.
+class RowBitmap {
+ public:
+  explicit RowBitmap(uint64_t num_rows);
+
+  // Adds the rows of the encoded set.
+  Status Or(const Slice& encoded);
+
+  // Keeps only the rows of other as well.
+  // REQUIRES: other covers the same number of rows
+  void And(const RowBitmap& other);
+
+  bool Contains(uint64_t ordinal) const {
+    return ordinal < num_rows_ &&
+           (words_[ordinal >> 6] >> (ordinal & 63)) & 1;
+  }
+
+  uint64_t Count() const;
+
+ private:
+  const uint64_t num_rows_;
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace vidardb
@@ -42,11 +42,15 @@ class Block {
   bool cachable() const { return contents_.cachable; }
 
   size_t usable_size() const {
-#ifdef VIDARDB_MALLOC_USABLE_SIZE
     if (contents_.allocation.get() != nullptr) {
+      MemoryAllocator* allocator = contents_.allocation.get_deleter().allocator;
+      if (allocator != nullptr) {
+        return allocator->UsableSize(contents_.allocation.get(), size_);
+      }
+#ifdef VIDARDB_MALLOC_USABLE_SIZE
       return malloc_usable_size(contents_.allocation.get());
-    }
 #endif  // VIDARDB_MALLOC_USABLE_SIZE
+    }
     return size_;
   }
 
@@ -37,7 +37,6 @@
 #include "util/string_util.h"
 #include "util/coding.h"
 #include "util/compression.h"
-#include "util/crc32c.h"
 #include "util/stop_watch.h"
 
 namespace vidardb {
@@ -392,9 +391,10 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
     trailer[0] = type;
     char* trailer_without_type = trailer + 1;
 
-    auto crc = crc32c::Value(block_contents.data(), block_contents.size());
-    crc = crc32c::Extend(crc, trailer, 1);  // Extend to cover block type
-    EncodeFixed32(trailer_without_type, crc32c::Mask(crc));
+    EncodeFixed32(trailer_without_type,
+                  ComputeBlockChecksum(r->table_options.checksum,
+                                       block_contents.data(),
+                                       block_contents.size(), type));
 
     r->status = r->file->Append(Slice(trailer, kBlockTrailerSize));
     if (r->status.ok()) {
@@ -497,10 +497,10 @@ Status BlockBasedTableBuilder::Finish() {
 
   // Write footer
   if (ok()) {
-    // No need to write out new footer if we're using default checksum.
     Footer footer(kBlockBasedTableMagicNumber);
     footer.set_metaindex_handle(metaindex_block_handle);
     footer.set_index_handle(index_block_handle);
+    footer.set_checksum(r->table_options.checksum);
     std::string footer_encoding;
     footer.EncodeTo(&footer_encoding);
     r->status = r->file->Append(footer_encoding);
@@ -33,7 +33,10 @@ BlockBasedTableFactory::BlockBasedTableFactory(
   if (table_options_.no_block_cache) {
     table_options_.block_cache.reset();
   } else if (table_options_.block_cache == nullptr) {
-    table_options_.block_cache = NewLRUCache(8 << 20);
+    table_options_.block_cache =
+        NewLRUCache(8 << 20, 6 /* num_shard_bits */,
+                    false /* strict_capacity_limit */,
+                    table_options_.memory_allocator);
   }
   if (table_options_.block_size_deviation < 0 ||
       table_options_.block_size_deviation > 100) {
@@ -82,6 +85,16 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
 
 Status BlockBasedTableFactory::SanitizeOptions(
     const DBOptions& db_opts, const ColumnFamilyOptions& cf_opts) const {
+  if (!IsSupportedChecksum(table_options_.checksum)) {
+    return Status::InvalidArgument("Unsupported checksum type.");
+  }
+  if (table_options_.memory_allocator != nullptr &&
+      table_options_.block_cache != nullptr &&
+      table_options_.block_cache->memory_allocator() !=
+          table_options_.memory_allocator.get()) {
+    return Status::InvalidArgument(
+        "memory_allocator must be the allocator of block_cache.");
+  }
   return Status::OK();
 }
 
@@ -106,6 +119,10 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
              table_options_.block_cache->GetCapacity());
     ret.append(buffer);
   }
+  MemoryAllocator* memory_allocator = GetMemoryAllocator(table_options_);
+  snprintf(buffer, kBufferSize, "  memory_allocator: %s\n",
+           memory_allocator ? memory_allocator->Name() : "nullptr");
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  block_size: %" VIDARDB_PRIszt "\n",
            table_options_.block_size);
   ret.append(buffer);
@@ -118,6 +135,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  index_block_restart_interval: %d\n",
            table_options_.index_block_restart_interval);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  checksum: %d\n",
+           static_cast<int>(table_options_.checksum));
+  ret.append(buffer);
   return ret;
 }
 
@@ -18,6 +18,7 @@
 
 #include "db/dbformat.h"
 #include "table/block.h"
+#include "table/block_prefetcher.h"
 #include "table/block_based_table_factory.h"
 #include "table/format.h"
 #include "table/get_context.h"
@@ -58,10 +59,12 @@ Status ReadBlockFromFile(RandomAccessFileReader* file, const Footer& footer,
                          const ReadOptions& options, const BlockHandle& handle,
                          std::unique_ptr<Block>* result, Env* env,
                          bool do_uncompress, const Slice& compression_dict,
-                         Logger* info_log) {
+                         Logger* info_log,
+                         MemoryAllocator* allocator = nullptr) {
   BlockContents contents;
   Status s = ReadBlockContents(file, footer, options, handle, &contents, env,
-                               do_uncompress, compression_dict, info_log);
+                               do_uncompress, compression_dict, info_log,
+                               allocator);
   if (s.ok()) {
     result->reset(new Block(std::move(contents)));
   }
@@ -171,12 +174,12 @@ class BinarySearchIndexReader : public IndexReader {
   static Status Create(RandomAccessFileReader* file, const Footer& footer,
                        const BlockHandle& index_handle, Env* env,
                        const Comparator* comparator, IndexReader** index_reader,
-                       Statistics* statistics) {
+                       Statistics* statistics, MemoryAllocator* allocator) {
     std::unique_ptr<Block> index_block;
     auto s = ReadBlockFromFile(file, footer, ReadOptions(), index_handle,
                                &index_block, env, true /* decompress */,
                                Slice() /*compression dict*/,
-                               /*info_log*/ nullptr);
+                               /*info_log*/ nullptr, allocator);
 
     if (s.ok()) {
       *index_reader = new BinarySearchIndexReader(
@@ -445,7 +448,8 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
         s = ReadBlockFromFile(rep->file.get(), rep->footer,
                               read_options, handle, &raw_block,
                               rep->ioptions.env, true, compression_dict,
-                              rep->ioptions.info_log);
+                              rep->ioptions.info_log,
+                              GetMemoryAllocator(rep->table_options));
       }
 
       if (s.ok()) {
@@ -469,7 +473,8 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
     std::unique_ptr<Block> block_value;
     s = ReadBlockFromFile(rep->file.get(), rep->footer, read_options, handle,
                           &block_value, rep->ioptions.env, true,
-                          compression_dict, rep->ioptions.info_log);
+                          compression_dict, rep->ioptions.info_log,
+                          GetMemoryAllocator(rep->table_options));
     if (s.ok()) {
       block.value = block_value.release();
     }
@@ -502,8 +507,9 @@ Status BlockBasedTable::CreateIndexReader(IndexReader** index_reader) {
   const Footer& footer = rep_->footer;
   Statistics* stats = rep_->ioptions.statistics;
 
-  return BinarySearchIndexReader::Create(file, footer, footer.index_handle(),
-                                         env, comparator, index_reader, stats);
+  return BinarySearchIndexReader::Create(
+      file, footer, footer.index_handle(), env, comparator, index_reader, stats,
+      GetMemoryAllocator(rep_->table_options));
 }
 
 InternalIterator* BlockBasedTable::NewIndexIterator(
@@ -814,16 +820,75 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
                           const ReadOptions& read_options)
       : TwoLevelIteratorState(),
         table_(table),
-        read_options_(read_options) {}
+        read_options_(read_options) {
+    // A readahead file can't be read by several threads
+    if (read_options_.prefetch_blocks > 0 &&
+        read_options_.read_tier != kBlockCacheTier &&
+        read_options_.readahead_size == 0) {
+      prefetcher_.reset(new BlockPrefetcher(
+          [this](const Slice& index_value, std::unique_ptr<Block>* block) {
+            return ReadDataBlock(index_value, block);
+          },
+          read_options_.prefetch_blocks));
+    }
+  }
 
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override {
+    if (prefetcher_ != nullptr) {
+      std::unique_ptr<Block> block = prefetcher_->Take(index_value);
+      if (block != nullptr) {
+        Rep* rep = table_->rep_;
+        InternalIterator* iter =
+            block->NewIterator(&rep->internal_comparator, nullptr);
+        iter->RegisterCleanup(&DeleteHeldResource<Block>, block.release(),
+                              nullptr);
+        return iter;
+      }
+    }
     return NewDataBlockIterator(table_->rep_, read_options_, index_value);
   }
 
+  size_t MaxPrefetch() const override {
+    return prefetcher_ != nullptr ? read_options_.prefetch_blocks : 0;
+  }
+
+  void Prefetch(const Slice& index_value) override {
+    prefetcher_->Prefetch(index_value);
+  }
+
  private:
+  // Reads the block into the block cache, or else into *block
+  Status ReadDataBlock(const Slice& index_value,
+                       std::unique_ptr<Block>* block) {
+    Rep* rep = table_->rep_;
+    if (read_options_.fill_cache &&
+        rep->table_options.block_cache != nullptr) {
+      std::unique_ptr<InternalIterator> iter(
+          NewDataBlockIterator(rep, read_options_, index_value));
+      return iter->status();
+    }
+
+    BlockHandle handle;
+    Slice input = index_value;
+    Status s = handle.DecodeFrom(&input);
+    if (!s.ok()) {
+      return s;
+    }
+    Slice compression_dict;
+    if (rep->compression_dict_block) {
+      compression_dict = rep->compression_dict_block->data;
+    }
+    return ReadBlockFromFile(rep->file.get(), rep->footer, read_options_,
+                             handle, block, rep->ioptions.env, true,
+                             compression_dict, rep->ioptions.info_log,
+                             GetMemoryAllocator(rep->table_options));
+  }
+
   // Don't own table_
   BlockBasedTable* table_;
   const ReadOptions read_options_;
+  // Destroyed first, as its reads use the members above
+  std::unique_ptr<BlockPrefetcher> prefetcher_;
 };
 
 /***************************** Shichao *********************************/
@@ -933,7 +998,7 @@ class BlockBasedTable::BlockBasedIterator : public InternalIterator {
         if (it->second.seq_ < parsed_key.sequence) {
           // replaced
           if (it->second.type_ == kTypeDeletion) {
-            meta->del_keys.erase(it->second.seq_);
+            meta->del_keys.erase(&*it->second.iter_);
           }
           assert(read_options.result_val_size >= 
               it->second.iter_->user_val.size());
@@ -943,7 +1008,7 @@ class BlockBasedTable::BlockBasedIterator : public InternalIterator {
           it->second.iter_->user_val = user_val.ToString();
           read_options.result_val_size += it->second.iter_->user_val.size();
           if (parsed_key.type == kTypeDeletion) {
-            meta->del_keys.insert({parsed_key.sequence, it->second.iter_});
+            meta->del_keys.insert({&*it->second.iter_, it->second.iter_});
           }
         } else {
           // inserted
@@ -954,7 +1019,7 @@ class BlockBasedTable::BlockBasedIterator : public InternalIterator {
           read_options.result_val_size += delta_val_size;
           it->second.iter_ = --res.end();
           if (parsed_key.type == kTypeDeletion) {
-            meta->del_keys.insert({parsed_key.sequence, it->second.iter_});
+            meta->del_keys.insert({&*it->second.iter_, it->second.iter_});
           }
         }
 
@@ -1094,6 +1159,14 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   return Status::OK();
 }
 
+Status BlockBasedTable::GetDataBlockIndexKeys(std::vector<std::string>* keys) {
+  unique_ptr<InternalIterator> index_iter(NewIndexIterator(ReadOptions()));
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    keys->push_back(index_iter->key().ToString());
+  }
+  return index_iter->status();
+}
+
 uint64_t BlockBasedTable::ApproximateOffsetOf(const Slice& key) {
   unique_ptr<InternalIterator> index_iter(NewIndexIterator(ReadOptions()));
 
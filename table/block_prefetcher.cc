@@ -0,0 +1,136 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "table/block_prefetcher.h"
+
+#include "table/block.h"
+#include "util/mutexlock.h"
+#include "util/threadpool.h"
+#include "vidardb/env.h"
+
+namespace vidardb {
+
+namespace {
+
+const int kPrefetchThreads = 4;
+
+ThreadPool* PrefetchThreadPool() {
+  // Never deleted, as the iterators may outlive static destruction
+  static ThreadPool* pool = []() {
+    ThreadPool* p = new ThreadPool();
+    p->SetHostEnv(Env::Default());
+    p->SetBackgroundThreads(kPrefetchThreads);
+    return p;
+  }();
+  return pool;
+}
+
+}  // namespace
+
+BlockPrefetcher::BlockPrefetcher(ReadFunction read, size_t max_blocks)
+    : read_(std::move(read)),
+      max_blocks_(max_blocks),
+      cv_(&mutex_),
+      pending_(0) {}
+
+BlockPrefetcher::~BlockPrefetcher() {
+  PrefetchThreadPool()->UnSchedule(this);
+  mutex_.Lock();
+  while (pending_ > 0) {
+    cv_.Wait();
+  }
+  mutex_.Unlock();
+}
+
+void BlockPrefetcher::Prefetch(const Slice& index_value) {
+  std::string key = index_value.ToString();
+  {
+    MutexLock l(&mutex_);
+    if (entries_.count(key) > 0) {
+      return;
+    }
+    if (entries_.size() >= max_blocks_) {
+      // The blocks left behind by a seek are not taken anymore
+      for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.state != kReading) {
+          it = entries_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    entries_[key].state = kQueued;
+    pending_++;
+  }
+  PrefetchThreadPool()->Schedule(&BlockPrefetcher::BGWorkRead,
+                                 new ReadArg{this, std::move(key)}, this,
+                                 &BlockPrefetcher::UnscheduleRead);
+}
+
+std::unique_ptr<Block> BlockPrefetcher::Take(const Slice& index_value) {
+  std::unique_ptr<Block> block;
+  MutexLock l(&mutex_);
+  auto it = entries_.find(index_value.ToString());
+  if (it == entries_.end()) {
+    return block;
+  }
+  while (it->second.state == kReading) {
+    cv_.Wait();
+    it = entries_.find(index_value.ToString());
+    if (it == entries_.end()) {
+      return block;
+    }
+  }
+  block = std::move(it->second.block);
+  entries_.erase(it);
+  return block;
+}
+
+void BlockPrefetcher::BGWorkRead(void* arg) {
+  ReadArg* ra = reinterpret_cast<ReadArg*>(arg);
+  ra->prefetcher->Read(ra->index_value);
+  ra->prefetcher->ReadDone();
+  delete ra;
+}
+
+void BlockPrefetcher::UnscheduleRead(void* arg) {
+  ReadArg* ra = reinterpret_cast<ReadArg*>(arg);
+  ra->prefetcher->ReadDone();
+  delete ra;
+}
+
+void BlockPrefetcher::Read(const std::string& index_value) {
+  {
+    MutexLock l(&mutex_);
+    auto it = entries_.find(index_value);
+    if (it == entries_.end() || it->second.state != kQueued) {
+      return;  // taken or dropped in the meanwhile
+    }
+    it->second.state = kReading;
+  }
+
+  std::unique_ptr<Block> block;
+  Status s = read_(index_value, &block);
+
+  MutexLock l(&mutex_);
+  auto it = entries_.find(index_value);
+  if (s.ok()) {
+    it->second.state = kDone;
+    it->second.block = std::move(block);
+  } else {
+    // read again by the iterator, to report the error
+    entries_.erase(it);
+  }
+  cv_.SignalAll();
+}
+
+void BlockPrefetcher::ReadDone() {
+  MutexLock l(&mutex_);
+  if (--pending_ == 0) {
+    cv_.SignalAll();
+  }
+}
+
+}  // namespace vidardb
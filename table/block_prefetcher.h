@@ -0,0 +1,70 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "port/port.h"
+#include "vidardb/slice.h"
+#include "vidardb/status.h"
+
+namespace vidardb {
+
+class Block;
+
+// Reads the data blocks of a table iterator ahead of it, on background
+// threads shared by all the tables. A block is known by its index value.
+class BlockPrefetcher {
+ public:
+  // Reads the block of index_value, into *block or else into the block cache
+  typedef std::function<Status(const Slice& index_value,
+                               std::unique_ptr<Block>* block)>
+      ReadFunction;
+
+  // At most max_blocks prefetched blocks are kept
+  BlockPrefetcher(ReadFunction read, size_t max_blocks);
+
+  // Drops the reads not started yet, and waits for the others
+  ~BlockPrefetcher();
+
+  void Prefetch(const Slice& index_value);
+
+  // If the block of index_value is being prefetched, waits for it. Returns the
+  // block if it was not put in the block cache, nullptr otherwise. A block
+  // whose read did not start yet is no longer prefetched.
+  std::unique_ptr<Block> Take(const Slice& index_value);
+
+ private:
+  enum State : char { kQueued, kReading, kDone };
+
+  struct Entry {
+    State state;
+    std::unique_ptr<Block> block;
+  };
+
+  struct ReadArg {
+    BlockPrefetcher* prefetcher;
+    std::string index_value;
+  };
+
+  static void BGWorkRead(void* arg);
+  static void UnscheduleRead(void* arg);
+  void Read(const std::string& index_value);
+  // Called once per scheduled read, run or not
+  void ReadDone();
+
+  const ReadFunction read_;
+  const size_t max_blocks_;
+  port::Mutex mutex_;
+  port::CondVar cv_;
+  std::unordered_map<std::string, Entry> entries_;
+  size_t pending_;  // reads scheduled and not done
+};
+
+}  // namespace vidardb
@@ -0,0 +1,216 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "table/column_stats.h"
+
+#include <math.h>
+#include <algorithm>
+
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace vidardb {
+
+namespace {
+
+const size_t kSampleSize = 1024;
+const size_t kHistogramBuckets = 32;
+// Longer sampled values are cut, which only lowers the bounds a little
+const size_t kMaxSampledValueSize = 128;
+
+}  // namespace
+
+void HyperLogLog::Add(const Slice& value) {
+  uint64_t h =
+      (static_cast<uint64_t>(Hash(value.data(), value.size(), 0x1b873593))
+       << 32) |
+      Hash(value.data(), value.size(), 0xcc9e2d51);
+  // Hash() mixes short values poorly, while the high bits pick the register
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  uint32_t index = static_cast<uint32_t>(h >> (64 - kPrecision));
+  uint64_t rest = h << kPrecision;
+  uint8_t rank = rest == 0 ? static_cast<uint8_t>(64 - kPrecision + 1)
+                           : static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+  if (static_cast<uint8_t>(registers_[index]) < rank) {
+    registers_[index] = static_cast<char>(rank);
+  }
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+  for (uint32_t i = 0; i < kNumRegisters; i++) {
+    if (static_cast<uint8_t>(registers_[i]) <
+        static_cast<uint8_t>(other.registers_[i])) {
+      registers_[i] = other.registers_[i];
+    }
+  }
+}
+
+uint64_t HyperLogLog::Estimate() const {
+  const double m = kNumRegisters;
+  double sum = 0;
+  uint32_t zeros = 0;
+  for (uint32_t i = 0; i < kNumRegisters; i++) {
+    uint8_t r = static_cast<uint8_t>(registers_[i]);
+    sum += ldexp(1.0, -r);
+    zeros += r == 0;
+  }
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+  if (estimate <= 2.5 * m && zeros > 0) {
+    // small range correction, i.e. linear counting
+    estimate = m * log(m / zeros);
+  }
+  return static_cast<uint64_t>(estimate + 0.5);
+}
+
+bool HyperLogLog::DecodeFrom(Slice* input) {
+  if (input->size() < kNumRegisters) {
+    return false;
+  }
+  registers_.assign(input->data(), kNumRegisters);
+  input->remove_prefix(kNumRegisters);
+  return true;
+}
+
+void TableColumnStats::EncodeTo(std::string* dst) const {
+  PutVarint64(dst, num_values);
+  PutVarint64(dst, num_nulls);
+  distinct.EncodeTo(dst);
+  PutVarint32(dst, static_cast<uint32_t>(histogram.size()));
+  for (const auto& bound : histogram) {
+    PutLengthPrefixedSlice(dst, bound);
+  }
+}
+
+Status TableColumnStats::DecodeFrom(const Slice& encoded) {
+  Slice input = encoded;
+  uint32_t num_bounds = 0;
+  if (!GetVarint64(&input, &num_values) || !GetVarint64(&input, &num_nulls) ||
+      !distinct.DecodeFrom(&input) || !GetVarint32(&input, &num_bounds)) {
+    return Status::Corruption("bad column stats");
+  }
+  histogram.clear();
+  for (uint32_t i = 0; i < num_bounds; i++) {
+    Slice bound;
+    if (!GetLengthPrefixedSlice(&input, &bound)) {
+      return Status::Corruption("bad column stats histogram");
+    }
+    histogram.push_back(bound.ToString());
+  }
+  return Status::OK();
+}
+
+ColumnStatsBuilder::ColumnStatsBuilder() : rnd_(301) {}
+
+void ColumnStatsBuilder::Add(const Slice& value) {
+  if (value.empty()) {
+    stats_.num_nulls++;
+    return;
+  }
+
+  size_t size = std::min(value.size(), kMaxSampledValueSize);
+  Slice cut(value.data(), size);
+  if (stats_.num_values == 0 || cut.compare(min_) < 0) {
+    min_.assign(cut.data(), cut.size());
+  }
+  if (stats_.num_values == 0 || cut.compare(max_) > 0) {
+    max_.assign(cut.data(), cut.size());
+  }
+  stats_.num_values++;
+  stats_.distinct.Add(value);
+  if (sample_.size() < kSampleSize) {
+    sample_.emplace_back(value.data(), size);
+  } else {
+    uint64_t i = rnd_.Uniform(stats_.num_values);
+    if (i < kSampleSize) {
+      sample_[i].assign(value.data(), size);
+    }
+  }
+}
+
+std::string ColumnStatsBuilder::Finish() {
+  std::sort(sample_.begin(), sample_.end());
+  stats_.histogram.clear();
+  if (!sample_.empty()) {
+    size_t n = sample_.size();
+    size_t buckets = std::min(kHistogramBuckets, n - 1);
+    for (size_t i = 0; i <= buckets; i++) {
+      stats_.histogram.push_back(
+          sample_[buckets == 0 ? 0 : i * (n - 1) / buckets]);
+    }
+    // the sample may miss the extremes
+    stats_.histogram.front() = min_;
+    stats_.histogram.back() = max_;
+  }
+
+  std::string encoded;
+  stats_.EncodeTo(&encoded);
+  return encoded;
+}
+
+void ColumnStatsAggregator::Add(const TableColumnStats& stats,
+                                double fraction) {
+  total_values_ += stats.num_values;
+  values_ += fraction * stats.num_values;
+  nulls_ += fraction * stats.num_nulls;
+  distinct_.Merge(stats.distinct);
+
+  if (stats.histogram.empty()) {
+    return;
+  }
+  // the smallest bound opens the first bucket, and holds no value itself
+  size_t buckets = stats.histogram.size() - 1;
+  bounds_.emplace_back(stats.histogram[0],
+                       buckets == 0 ? fraction * stats.num_values : 0);
+  for (size_t i = 1; i <= buckets; i++) {
+    bounds_.emplace_back(stats.histogram[i],
+                         fraction * stats.num_values / buckets);
+  }
+}
+
+void ColumnStatsAggregator::Finish(ColumnStats* result) const {
+  result->num_nulls = static_cast<uint64_t>(nulls_ + 0.5);
+
+  // Distinct values among values_ of the total_values_ rows, assuming each
+  // distinct value is spread evenly over the files.
+  result->num_distinct = 0;
+  if (total_values_ > 0 && values_ > 0) {
+    double distinct = std::min<double>(
+        static_cast<double>(distinct_.Estimate()), total_values_);
+    distinct = std::max(distinct, 1.0);
+    double q = std::min(values_ / total_values_, 1.0);
+    distinct *= 1 - pow(1 - q, total_values_ / distinct);
+    result->num_distinct = std::max<uint64_t>(
+        static_cast<uint64_t>(std::min(distinct, values_) + 0.5), 1);
+  }
+
+  result->histogram.clear();
+  if (bounds_.empty()) {
+    return;
+  }
+  std::vector<std::pair<std::string, double>> bounds(bounds_);
+  std::sort(bounds.begin(), bounds.end());
+  double total = 0;
+  for (const auto& bound : bounds) {
+    total += bound.second;
+  }
+
+  result->histogram.push_back(bounds.front().first);
+  size_t j = 0;
+  double seen = bounds[0].second;
+  for (size_t i = 1; i <= kHistogramBuckets && j + 1 < bounds.size(); i++) {
+    double target = total * i / kHistogramBuckets;
+    while (j + 1 < bounds.size() && (seen < target || seen == 0)) {
+      seen += bounds[++j].second;
+    }
+    result->histogram.push_back(bounds[j].first);
+  }
+  result->histogram.back() = bounds.back().first;
+}
+
+}  // namespace vidardb
@@ -0,0 +1,109 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Statistics of the values of a sub column, stored by column tables in the
+// table properties under TablePropertiesNames::kColumnStatsPrefix followed by
+// the column (from 1). An empty column value counts as a null.
+//
+// Encoding:
+//    num_values: varint64 (non null values)
+//    num_nulls: varint64
+//    registers: 1024 bytes (HyperLogLog of the non null values)
+//    num_bounds: varint32
+//    bound[0], ..., bound[num_bounds-1]: length prefixed slices
+// where the bounds split a sample of the non null values into equi-depth
+// buckets, except bound[0] and bound[num_bounds-1] which are the smallest and
+// the largest of all the values.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "util/random.h"
+#include "vidardb/db.h"
+#include "vidardb/slice.h"
+#include "vidardb/status.h"
+
+namespace vidardb {
+
+// Sketch of the number of distinct values, with a standard error of about
+// 3% once there are more than a few thousand of them.
+class HyperLogLog {
+ public:
+  static const uint32_t kPrecision = 10;
+  static const uint32_t kNumRegisters = 1u << kPrecision;
+
+  HyperLogLog() : registers_(kNumRegisters, 0) {}
+
+  void Add(const Slice& value);
+
+  // Afterwards the sketch counts the values of both
+  void Merge(const HyperLogLog& other);
+
+  uint64_t Estimate() const;
+
+  void EncodeTo(std::string* dst) const { dst->append(registers_); }
+
+  bool DecodeFrom(Slice* input);
+
+ private:
+  std::string registers_;
+};
+
+// Statistics of a sub column in a table file.
+struct TableColumnStats {
+  uint64_t num_values = 0;
+  uint64_t num_nulls = 0;
+  HyperLogLog distinct;
+  std::vector<std::string> histogram;
+
+  void EncodeTo(std::string* dst) const;
+
+  Status DecodeFrom(const Slice& input);
+};
+
+// Collects the statistics of a sub column while its table file is built.
+class ColumnStatsBuilder {
+ public:
+  ColumnStatsBuilder();
+
+  void Add(const Slice& value);
+
+  // Returns the encoded statistics.
+  std::string Finish();
+
+ private:
+  TableColumnStats stats_;
+  // Reservoir sample of the values, sorted into the histogram at the end
+  std::vector<std::string> sample_;
+  Random64 rnd_;
+  std::string min_;
+  std::string max_;
+};
+
+// Merges the statistics of a column over the files overlapping a key range.
+class ColumnStatsAggregator {
+ public:
+  ColumnStatsAggregator() : total_values_(0), values_(0), nulls_(0) {}
+
+  // Adds the statistics of a file, fraction of whose rows are in the range.
+  void Add(const TableColumnStats& stats, double fraction);
+
+  void Finish(ColumnStats* result) const;
+
+ private:
+  uint64_t total_values_;  // in the whole files
+  double values_;          // in the range
+  double nulls_;
+  HyperLogLog distinct_;
+  // Upper bounds of the buckets of the files, with their estimated number of
+  // values in the range
+  std::vector<std::pair<std::string, double>> bounds_;
+};
+
+}  // namespace vidardb
@@ -9,6 +9,7 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -24,10 +25,12 @@
 #include "vidardb/table.h"
 #include "vidardb/splitter.h"
 
+#include "table/bitmap_index.h"
 #include "table/block.h"
 #include "table/column_table_reader.h"
 #include "table/block_builder.h"
 #include "table/column_block_builder.h"
+#include "table/column_stats.h"
 #include "table/column_table_factory.h"
 #include "table/format.h"
 #include "table/meta_blocks.h"
@@ -36,7 +39,6 @@
 #include "util/string_util.h"
 #include "util/coding.h"
 #include "util/compression.h"
-#include "util/crc32c.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 
@@ -198,6 +200,20 @@ Slice CompressBlock(const Slice& raw,
   return raw;
 }
 
+// Sub column file follows the main file, unless the column is pinned on a
+// slower path.
+uint32_t SubFilePathId(const ImmutableCFOptions& ioptions,
+                       const ColumnTableOptions& table_options,
+                       uint32_t main_path_id, uint32_t column_index) {
+  uint32_t path_id = main_path_id;
+  if (column_index < table_options.column_path_ids.size()) {
+    path_id = std::max(path_id, table_options.column_path_ids[column_index]);
+  }
+  assert(!ioptions.db_paths.empty());
+  return std::min(path_id,
+                  static_cast<uint32_t>(ioptions.db_paths.size() - 1));
+}
+
 }  // namespace
 
 // Slight change from kBlockBasedTableMagicNumber.
@@ -242,6 +258,16 @@ struct ColumnTableBuilder::Rep {
   const EnvOptions& env_options;
   std::vector<std::unique_ptr<ColumnTableBuilder>> builders;
 
+  // -1 if the file is not placed in the db paths
+  const int path_id;
+  std::vector<uint32_t> sub_path_ids;
+
+  // Sub column only, null if the bitmap index is disabled
+  std::unique_ptr<BitmapIndexBuilder> bitmap_index;
+
+  // Main column only, statistics of the sub columns
+  std::vector<ColumnStatsBuilder> column_stats;
+
   Rep(bool _main_column,
       const ImmutableCFOptions& _ioptions,
       const ColumnTableOptions& table_opt,
@@ -253,7 +279,7 @@ struct ColumnTableBuilder::Rep {
       const CompressionOptions& _compression_opts,
       const std::string* _compression_dict,
       const std::string& _column_family_name,
-      const EnvOptions& _env_options)
+      const EnvOptions& _env_options, int _path_id)
       : main_column(_main_column),
         ioptions(_ioptions),
         table_options(table_opt),
@@ -274,13 +300,18 @@ struct ColumnTableBuilder::Rep {
                 table_options, *data_block)),
         column_family_id(_column_family_id),
         column_family_name(_column_family_name),
-        env_options(_env_options) {
+        env_options(_env_options),
+        path_id(_path_id) {
     if (main_column && int_tbl_prop_collector_factories) {
       for (auto& collector_factories : *int_tbl_prop_collector_factories) {
         table_properties_collectors.emplace_back(
             collector_factories->CreateIntTblPropCollector(column_family_id));
       }
     }
+    if (!main_column && table_options.bitmap_index_max_cardinality > 0) {
+      bitmap_index.reset(
+          new BitmapIndexBuilder(table_options.bitmap_index_max_cardinality));
+    }
   }
 };
 
@@ -296,11 +327,11 @@ ColumnTableBuilder::ColumnTableBuilder(
     const std::string* compression_dict,
     const std::string& column_family_name,
     const EnvOptions& env_options,
-    bool main_column) {
+    bool main_column, int path_id) {
   rep_ = new Rep(main_column, ioptions, table_options, internal_comparator,
                  int_tbl_prop_collector_factories, column_family_id, file,
                  compression_type, compression_opts, compression_dict,
-                 column_family_name, env_options);
+                 column_family_name, env_options, path_id);
 }
 
 ColumnTableBuilder::~ColumnTableBuilder() {
@@ -310,11 +341,25 @@ ColumnTableBuilder::~ColumnTableBuilder() {
 
 void ColumnTableBuilder::CreateSubcolumnBuilders(Rep* r) {
   r->builders.resize(r->table_options.column_count);
+  r->column_stats.resize(r->table_options.column_count);
   std::string fname = r->file->writable_file()->GetFileName();
   Env::IOPriority pri = r->file->writable_file()->GetIOPriority();
+  if (r->path_id >= 0) {
+    r->sub_path_ids.resize(r->table_options.column_count);
+  }
   for (auto i = 0u; i < r->table_options.column_count; i++) {
     unique_ptr<WritableFile> file;
     std::string col_fname(TableSubFileName(fname, i+1));
+    if (r->path_id >= 0) {
+      uint32_t main_path_id = static_cast<uint32_t>(r->path_id);
+      r->sub_path_ids[i] = SubFilePathId(r->ioptions, r->table_options,
+                                         main_path_id, i);
+      if (r->sub_path_ids[i] != main_path_id) {
+        col_fname = TableSubFileName(
+            TableFileName(r->ioptions.db_paths, TableFileNameToNumber(fname),
+                          r->sub_path_ids[i]), i+1);
+      }
+    }
     r->status = NewWritableFile(r->ioptions.env, col_fname, &file,
                                 r->env_options);
     assert(r->status.ok());
@@ -328,7 +373,8 @@ void ColumnTableBuilder::CreateSubcolumnBuilders(Rep* r) {
 }
 
 void ColumnTableBuilder::AddInSubcolumnBuilders(Rep* r, const Slice& key,
-                                                const Slice& value) {
+                                                const Slice& value,
+                                                ValueType type) {
   std::vector<Slice> vals(r->ioptions.splitter->Split(value));
   if (!vals.empty() && vals.size() != r->table_options.column_count) {
     r->status = Status::InvalidArgument("table_options.column_count");
@@ -359,6 +405,14 @@ void ColumnTableBuilder::AddInSubcolumnBuilders(Rep* r, const Slice& key,
     // sub column format (, vals[i]): (, vals[i+0]), (, vals[i+1])
     // however, key is stored in the first elem of every restart
     rep->data_block->Add(key, vals.empty()? Slice(): vals[i]);
+    // only the plain values are indexed, the others are never filtered out
+    if (rep->bitmap_index && type == kTypeValue) {
+      rep->bitmap_index->Add(vals.empty()? Slice(): vals[i],
+                             rep->props.num_entries);
+    }
+    if (type == kTypeValue) {
+      r->column_stats[i].Add(vals.empty()? Slice(): vals[i]);
+    }
     rep->props.num_entries++;
     rep->props.raw_key_size += rep->data_block->IsKeyStored() ? key.size() : 0;
     rep->props.raw_value_size += vals.empty()? 0: vals[i].size();
@@ -412,7 +466,7 @@ void ColumnTableBuilder::Add(const Slice& key, const Slice& value) {
                                     r->table_properties_collectors,
                                     r->ioptions.info_log);
 
-  AddInSubcolumnBuilders(r, pos, value);
+  AddInSubcolumnBuilders(r, pos, value, ExtractValueType(key));
 }
 
 void ColumnTableBuilder::Flush() {
@@ -476,9 +530,10 @@ void ColumnTableBuilder::WriteRawBlock(const Slice& block_contents,
     trailer[0] = type;
     char* trailer_without_type = trailer + 1;
 
-    auto crc = crc32c::Value(block_contents.data(), block_contents.size());
-    crc = crc32c::Extend(crc, trailer, 1);  // Extend to cover block type
-    EncodeFixed32(trailer_without_type, crc32c::Mask(crc));
+    EncodeFixed32(trailer_without_type,
+                  ComputeBlockChecksum(r->table_options.checksum,
+                                       block_contents.data(),
+                                       block_contents.size(), type));
 
     r->status = r->file->Append(Slice(trailer, kBlockTrailerSize));
     if (r->status.ok()) {
@@ -533,10 +588,11 @@ Status ColumnTableBuilder::Finish() {
 
   // Write meta blocks and metaindex block with the following order.
   //    1. [format, col_num; col_file_size...]
-  //    2. [properties]
-  //    3. [compression_dict]
-  //    4. [meta_index_builder]
-  //    5. [index_blocks]
+  //    2. [bitmap_index]  (sub column only)
+  //    3. [properties]
+  //    4. [compression_dict]
+  //    5. [meta_index_builder]
+  //    6. [index_blocks]
   MetaIndexBuilder meta_index_builder;
 
   if (ok()) {
@@ -544,9 +600,18 @@ Status ColumnTableBuilder::Finish() {
     {
       MetaColumnBlockBuilder meta_column_block_builder;
       uint32_t column_count = (uint32_t)r->builders.size();
-      meta_column_block_builder.Add(r->main_column, column_count);
-      for (auto i = 0u; i < column_count; i++) {
+      if (r->sub_path_ids.empty()) {
+        meta_column_block_builder.Add(r->main_column, column_count);
+        for (auto i = 0u; i < column_count; i++) {
           meta_column_block_builder.Add(i+1, r->builders[i]->rep_->offset);
+        }
+      } else {
+        meta_column_block_builder.Add(r->main_column, column_count,
+                                      static_cast<uint32_t>(r->path_id));
+        for (auto i = 0u; i < column_count; i++) {
+          meta_column_block_builder.Add(i+1, r->builders[i]->rep_->offset,
+                                        r->sub_path_ids[i]);
+        }
       }
 
       BlockHandle column_block_handle;
@@ -555,6 +620,15 @@ Status ColumnTableBuilder::Finish() {
       meta_index_builder.Add(kColumnBlock, column_block_handle);
     }
 
+    // Write bitmap index block.
+    if (r->bitmap_index && !r->bitmap_index->abandoned() &&
+        !r->bitmap_index->empty()) {
+      BlockHandle bitmap_index_block_handle;
+      WriteRawBlock(r->bitmap_index->Finish(), kNoCompression,
+                    &bitmap_index_block_handle);
+      meta_index_builder.Add(kBitmapIndexBlock, bitmap_index_block_handle);
+    }
+
     // Write properties and compression dictionary blocks.
     {
       PropertyBlockBuilder property_block_builder;
@@ -584,6 +658,16 @@ Status ColumnTableBuilder::Finish() {
       // Add basic properties
       property_block_builder.AddTableProperty(r->props);
 
+      // Add column statistics
+      if (r->main_column) {
+        for (auto i = 0u; i < r->column_stats.size(); i++) {
+          r->props.user_collected_properties.emplace(
+              TablePropertiesNames::kColumnStatsPrefix + ToString(i+1),
+              r->column_stats[i].Finish());
+        }
+        property_block_builder.Add(r->props.user_collected_properties);
+      }
+
       // Add user collected properties
       if (r->main_column) {
         NotifyCollectTableCollectorsOnFinish(r->table_properties_collectors,
@@ -616,10 +700,10 @@ Status ColumnTableBuilder::Finish() {
 
   // Write footer
   if (ok()) {
-    // No need to write out new footer if we're using default checksum.
     Footer footer(kColumnTableMagicNumber);
     footer.set_metaindex_handle(metaindex_block_handle);
     footer.set_index_handle(index_block_handle);
+    footer.set_checksum(r->table_options.checksum);
     std::string footer_encoding;
     footer.EncodeTo(&footer_encoding);
     r->status = r->file->Append(footer_encoding);
@@ -681,6 +765,10 @@ bool ColumnTableBuilder::NeedCompact() const {
   return false;
 }
 
+std::vector<uint32_t> ColumnTableBuilder::SubFilePathIds() const {
+  return rep_->sub_path_ids;
+}
+
 TableProperties ColumnTableBuilder::GetTableProperties() const {
   TableProperties ret = rep_->props;
   for (const auto& collector : rep_->table_properties_collectors) {
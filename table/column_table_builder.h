@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 
+#include "db/dbformat.h"
 #include "vidardb/flush_block_policy.h"
 #include "vidardb/options.h"
 #include "vidardb/status.h"
@@ -43,7 +44,7 @@ class ColumnTableBuilder : public TableBuilder {
       const std::string* compression_dict,
       const std::string& column_family_name,
       const EnvOptions& env_options,
-      bool main_column = true);
+      bool main_column = true, int path_id = -1);
 
   // REQUIRES: Either Finish() or Abandon() has been called.
   ~ColumnTableBuilder();
@@ -81,6 +82,10 @@ class ColumnTableBuilder : public TableBuilder {
 
   bool NeedCompact() const override;
 
+  // Path ids of the sub column files, empty if the main file is not placed in
+  // the db paths.
+  std::vector<uint32_t> SubFilePathIds() const override;
+
   // Get table properties
   TableProperties GetTableProperties() const override;
 
@@ -114,8 +119,10 @@ class ColumnTableBuilder : public TableBuilder {
   // Called by main column to create sub column builders
   void CreateSubcolumnBuilders(Rep* r);
 
-  // Called by main column to add kv in sub column builders
-  void AddInSubcolumnBuilders(Rep* r, const Slice& key, const Slice& value);
+  // Called by main column to add kv in sub column builders, type being the
+  // one of the main column entry
+  void AddInSubcolumnBuilders(Rep* r, const Slice& key, const Slice& value,
+                              ValueType type);
 
   // No copying allowed
   ColumnTableBuilder(const ColumnTableBuilder&) = delete;
@@ -28,7 +28,10 @@ ColumnTableFactory::ColumnTableFactory(
   if (table_options_.no_block_cache) {
     table_options_.block_cache.reset();
   } else if (table_options_.block_cache == nullptr) {
-    table_options_.block_cache = NewLRUCache(8 << 20);
+    table_options_.block_cache =
+        NewLRUCache(8 << 20, 6 /* num_shard_bits */,
+                    false /* strict_capacity_limit */,
+                    table_options_.memory_allocator);
   }
   if (table_options_.block_size_deviation < 0 ||
       table_options_.block_size_deviation > 100) {
@@ -72,7 +75,8 @@ TableBuilder* ColumnTableFactory::NewTableBuilder(
       table_builder_options.compression_opts,
       table_builder_options.compression_dict,
       table_builder_options.column_family_name,
-      table_builder_options.env_options);
+      table_builder_options.env_options, true /* main_column */,
+      table_builder_options.path_id);
 
   return table_builder;
 }
@@ -82,6 +86,16 @@ Status ColumnTableFactory::SanitizeOptions(
   if (!cf_opts.splitter) {
     return Status::InvalidArgument("Missing splitter.");
   }
+  if (!IsSupportedChecksum(table_options_.checksum)) {
+    return Status::InvalidArgument("Unsupported checksum type.");
+  }
+  if (table_options_.memory_allocator != nullptr &&
+      table_options_.block_cache != nullptr &&
+      table_options_.block_cache->memory_allocator() !=
+          table_options_.memory_allocator.get()) {
+    return Status::InvalidArgument(
+        "memory_allocator must be the allocator of block_cache.");
+  }
   return Status::OK();
 }
 
@@ -106,6 +120,10 @@ std::string ColumnTableFactory::GetPrintableTableOptions() const {
              table_options_.block_cache->GetCapacity());
     ret.append(buffer);
   }
+  MemoryAllocator* memory_allocator = GetMemoryAllocator(table_options_);
+  snprintf(buffer, kBufferSize, "  memory_allocator: %s\n",
+           memory_allocator ? memory_allocator->Name() : "nullptr");
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  block_size: %" VIDARDB_PRIszt "\n",
            table_options_.block_size);
   ret.append(buffer);
@@ -118,6 +136,12 @@ std::string ColumnTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  index_block_restart_interval: %d\n",
            table_options_.index_block_restart_interval);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  checksum: %d\n",
+           static_cast<int>(table_options_.checksum));
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  bitmap_index_max_cardinality: %u\n",
+           table_options_.bitmap_index_max_cardinality);
+  ret.append(buffer);
   return ret;
 }
 
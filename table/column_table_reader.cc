@@ -5,17 +5,21 @@
 
 #include "table/column_table_reader.h"
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
 #include "db/dbformat.h"
 #include "db/filename.h"
+#include "table/bitmap_index.h"
 #include "table/block.h"
+#include "table/block_prefetcher.h"
 #include "table/column_table_factory.h"
 #include "table/format.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
+#include "table/iterator_wrapper.h"
 #include "table/meta_blocks.h"
 #include "table/two_level_iterator.h"
 #include "util/coding.h"
@@ -42,6 +46,10 @@ typedef ColumnTable::IndexReader IndexReader;
 
 namespace {
 
+// Range query seeks the sub column iterators over more skipped rows than this
+// rather than stepping through them, not to read the data blocks in between.
+const size_t kMaxSkippedSubKeys = 16;
+
 // Read the block identified by "handle" from "file".
 // The only relevant option is options.verify_checksums for now.
 // On failure return non-OK.
@@ -52,10 +60,12 @@ Status ReadBlockFromFile(RandomAccessFileReader* file, const Footer& footer,
                          const ReadOptions& options, const BlockHandle& handle,
                          std::unique_ptr<Block>* result, Env* env,
                          bool do_uncompress, const Slice& compression_dict,
-                         Logger* info_log) {
+                         Logger* info_log,
+                         MemoryAllocator* allocator = nullptr) {
   BlockContents contents;
   Status s = ReadBlockContents(file, footer, options, handle, &contents, env,
-                               do_uncompress, compression_dict, info_log);
+                               do_uncompress, compression_dict, info_log,
+                               allocator);
   if (s.ok()) {
     result->reset(new Block(std::move(contents)));
   }
@@ -165,12 +175,12 @@ class BinarySearchIndexReader : public IndexReader {
   static Status Create(RandomAccessFileReader* file, const Footer& footer,
                        const BlockHandle& index_handle, Env* env,
                        const Comparator* comparator, IndexReader** index_reader,
-                       Statistics* statistics) {
+                       Statistics* statistics, MemoryAllocator* allocator) {
     std::unique_ptr<Block> index_block;
     auto s = ReadBlockFromFile(file, footer, ReadOptions(), index_handle,
                                &index_block, env, true /* decompress */,
                                Slice() /*compression dict*/,
-                               /*info_log*/ nullptr);
+                               /*info_log*/ nullptr, allocator);
 
     if (s.ok()) {
       *index_reader = new BinarySearchIndexReader(
@@ -275,6 +285,9 @@ struct ColumnTable::Rep {
 
   bool main_column;
   std::vector<unique_ptr<ColumnTable>> tables;  // sub colum tables
+
+  // Sub column only, null if the file has no bitmap index
+  std::unique_ptr<Block> bitmap_index_block;
 };
 
 // Load the meta-block from the file. On success, return the loaded meta block
@@ -440,7 +453,8 @@ InternalIterator* ColumnTable::NewDataBlockIterator(
         StopWatch sw(rep->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
         s = ReadBlockFromFile(rep->file.get(), rep->footer, read_options,
                               handle, &raw_block, rep->ioptions.env, true,
-                              compression_dict, rep->ioptions.info_log);
+                              compression_dict, rep->ioptions.info_log,
+                              GetMemoryAllocator(rep->table_options));
       }
 
       if (s.ok()) {
@@ -464,7 +478,8 @@ InternalIterator* ColumnTable::NewDataBlockIterator(
     std::unique_ptr<Block> block_value;
     s = ReadBlockFromFile(rep->file.get(), rep->footer, read_options, handle,
                           &block_value, rep->ioptions.env, true,
-                          compression_dict, rep->ioptions.info_log);
+                          compression_dict, rep->ioptions.info_log,
+                          GetMemoryAllocator(rep->table_options));
     if (s.ok()) {
       block.value = block_value.release();
     }
@@ -498,8 +513,9 @@ Status ColumnTable::CreateIndexReader(IndexReader** index_reader) {
   const Footer& footer = rep_->footer;
   Statistics* stats = rep_->ioptions.statistics;
 
-  return BinarySearchIndexReader::Create(file, footer, footer.index_handle(),
-                                         env, comparator, index_reader, stats);
+  return BinarySearchIndexReader::Create(
+      file, footer, footer.index_handle(), env, comparator, index_reader, stats,
+      GetMemoryAllocator(rep_->table_options));
 }
 
 InternalIterator* ColumnTable::NewIndexIterator(
@@ -655,6 +671,11 @@ Status ColumnTable::DumpDataBlocks(WritableFile* out_file) {
       continue;
     }
 
+    // main column: (user key, row position), sub column: (row position,
+    // value) with the position stored by the first entry of a restart only
+    Slice restart_key;
+    uint64_t row = 0;
+    std::string row_key;
     for (datablock_iter->SeekToFirst(); datablock_iter->Valid();
          datablock_iter->Next()) {
       s = datablock_iter->status();
@@ -664,18 +685,28 @@ Status ColumnTable::DumpDataBlocks(WritableFile* out_file) {
       }
       Slice key = datablock_iter->key();
       Slice value = datablock_iter->value();
-      InternalKey ikey, iValue;
-      ikey.DecodeFrom(key);
-      iValue.DecodeFrom(value);
+      if (rep_->main_column) {
+        key = ExtractUserKey(key);
+      } else {
+        if (key.size() == sizeof(uint64_t) && key != restart_key) {
+          restart_key = key;
+          row = DecodeFixed64BigEndian(key.data());
+        } else {
+          row++;
+        }
+        row_key.clear();
+        PutFixed64BigEndian(&row_key, row);
+        key = row_key;
+      }
 
       out_file->Append("  HEX    ");
-      out_file->Append(ikey.user_key().ToString(true).c_str());
+      out_file->Append(key.ToString(true).c_str());
       out_file->Append(": ");
-      out_file->Append(iValue.user_key().ToString(true).c_str());
+      out_file->Append(value.ToString(true).c_str());
       out_file->Append("\n");
 
-      std::string str_key = ikey.user_key().ToString();
-      std::string str_value = iValue.user_key().ToString();
+      std::string str_key = key.ToString();
+      std::string str_value = value.ToString();
       std::string res_key(""), res_value("");
       char cspace = ' ';
       for (size_t i = 0; i < str_key.size(); i++) {
@@ -746,9 +777,10 @@ Status ColumnTable::Open(const ImmutableCFOptions& ioptions,
 
     uint32_t column_count;
     std::vector<uint64_t> file_sizes;
+    std::vector<uint32_t> path_ids;
     s = ReadMetaColumnBlock(meta_iter->value(), rep->file.get(), rep->footer,
                             ioptions.env, ioptions.info_log, &column_count,
-                            file_sizes);
+                            file_sizes, &path_ids);
     if (!s.ok()) {
       return s;
     }
@@ -773,6 +805,17 @@ Status ColumnTable::Open(const ImmutableCFOptions& ioptions,
         continue;
       }
       std::string col_fname = TableSubFileName(fname, i+1);
+      // sub column file placed on another db path than its main file. The
+      // placement is read from the meta column block rather than from the
+      // sub_path_ids of the manifest, since TableCache only passes the
+      // FileDescriptor down and tools open tables without a manifest; both
+      // are written from the same placement when the table is built.
+      if (!path_ids.empty() && path_ids[i+1] != path_ids[0] &&
+          path_ids[i+1] < ioptions.db_paths.size()) {
+        col_fname = TableSubFileName(
+            TableFileName(ioptions.db_paths, TableFileNameToNumber(fname),
+                          path_ids[i+1]), i+1);
+      }
       unique_ptr<RandomAccessFile> col_file;
       s = rep->ioptions.env->NewRandomAccessFile(col_fname, &col_file,
                                                  env_options);
@@ -845,6 +888,31 @@ Status ColumnTable::Open(const ImmutableCFOptions& ioptions,
     }
   }
 
+  // Read the bitmap index meta block of a sub column file
+  if (!rep->main_column) {
+    bool found_bitmap_index = false;
+    Status bs = SeekToBitmapIndexBlock(meta_iter.get(), &found_bitmap_index);
+    if (bs.ok() && found_bitmap_index) {
+      Slice handle_value = meta_iter->value();
+      BlockHandle handle;
+      bs = handle.DecodeFrom(&handle_value);
+      if (bs.ok()) {
+        bs = ReadBlockFromFile(rep->file.get(), rep->footer, ReadOptions(),
+                               handle, &rep->bitmap_index_block,
+                               rep->ioptions.env, true /* decompress */,
+                               Slice() /*compression dict*/,
+                               rep->ioptions.info_log);
+      }
+    }
+    if (!bs.ok()) {
+      // the rows are then simply not filtered by the index
+      Log(InfoLogLevel::WARN_LEVEL, rep->ioptions.info_log,
+          "Encountered error while reading data from bitmap index block %s",
+          bs.ToString().c_str());
+      rep->bitmap_index_block.reset();
+    }
+  }
+
   unique_ptr<ColumnTable> new_table(new ColumnTable(rep));
   if (prefetch_index) {
     // pre-fetching of blocks is turned on
@@ -874,16 +942,76 @@ class ColumnTable::BlockEntryIteratorState : public TwoLevelIteratorState {
                           const ReadOptions& read_options)
       : TwoLevelIteratorState(),
         table_(table),
-        read_options_(read_options) {}
+        read_options_(read_options) {
+    // A readahead file can't be read by several threads
+    if (read_options_.prefetch_blocks > 0 &&
+        read_options_.read_tier != kBlockCacheTier &&
+        read_options_.readahead_size == 0) {
+      prefetcher_.reset(new BlockPrefetcher(
+          [this](const Slice& index_value, std::unique_ptr<Block>* block) {
+            return ReadDataBlock(index_value, block);
+          },
+          read_options_.prefetch_blocks));
+    }
+  }
 
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override {
+    if (prefetcher_ != nullptr) {
+      std::unique_ptr<Block> block = prefetcher_->Take(index_value);
+      if (block != nullptr) {
+        Rep* rep = table_->rep_;
+        InternalIterator* iter =
+            block->NewIterator(&rep->internal_comparator, nullptr,
+                              !rep->main_column);
+        iter->RegisterCleanup(&DeleteHeldResource<Block>, block.release(),
+                              nullptr);
+        return iter;
+      }
+    }
     return NewDataBlockIterator(table_->rep_, read_options_, index_value);
   }
 
+  size_t MaxPrefetch() const override {
+    return prefetcher_ != nullptr ? read_options_.prefetch_blocks : 0;
+  }
+
+  void Prefetch(const Slice& index_value) override {
+    prefetcher_->Prefetch(index_value);
+  }
+
  private:
+  // Reads the block into the block cache, or else into *block
+  Status ReadDataBlock(const Slice& index_value,
+                       std::unique_ptr<Block>* block) {
+    Rep* rep = table_->rep_;
+    if (read_options_.fill_cache &&
+        rep->table_options.block_cache != nullptr) {
+      std::unique_ptr<InternalIterator> iter(
+          NewDataBlockIterator(rep, read_options_, index_value));
+      return iter->status();
+    }
+
+    BlockHandle handle;
+    Slice input = index_value;
+    Status s = handle.DecodeFrom(&input);
+    if (!s.ok()) {
+      return s;
+    }
+    Slice compression_dict;
+    if (rep->compression_dict_block) {
+      compression_dict = rep->compression_dict_block->data;
+    }
+    return ReadBlockFromFile(rep->file.get(), rep->footer, read_options_,
+                             handle, block, rep->ioptions.env, true,
+                             compression_dict, rep->ioptions.info_log,
+                             GetMemoryAllocator(rep->table_options));
+  }
+
   // Don't own table_
   ColumnTable* table_;
   const ReadOptions read_options_;
+  // Destroyed first, as its reads use the members above
+  std::unique_ptr<BlockPrefetcher> prefetcher_;
 };
 
 class ColumnTable::ColumnIterator : public InternalIterator {
@@ -891,12 +1019,13 @@ class ColumnTable::ColumnIterator : public InternalIterator {
   ColumnIterator(const std::vector<InternalIterator*>& columns,
                  bool has_main_column, const Splitter* splitter,
                  const InternalKeyComparator& internal_comparator,
-                 uint64_t num_entries = 0)
+                 uint64_t num_entries = 0, RowBitmap* rows = nullptr)
       : columns_(columns),
         has_main_column_(has_main_column),
         splitter_(splitter),
         internal_comparator_(internal_comparator),
-        num_entries_(num_entries) {}
+        num_entries_(num_entries),
+        rows_(rows) {}
 
   virtual ~ColumnIterator() {
     for (const auto& it : columns_) {
@@ -991,9 +1120,12 @@ class ColumnTable::ColumnIterator : public InternalIterator {
   virtual Status RangeQuery(ReadOptions& read_options, const LookupRange& range,
                             std::list<RangeQueryKeyVal>& res) {
     std::vector<std::map<std::string, SeqTypeVal>::iterator> user_vals;
-    std::vector<bool> sub_key_bs;  // trace the valid sub_keys
-    // user key's sequence number -> sub_key_bs index
-    std::unordered_map<SequenceNumber, size_t> seq_idx_map;
+    // user keys of user_vals, only traced in batches, since the map entries
+    // popped out may be dereferenced no more
+    std::vector<std::string> user_keys;
+    // trace the valid sub_keys, the i-th one being the row start ordinal + i
+    std::vector<bool> sub_key_bs;
+    bool batched = read_options.batch_capacity > 0;
     if (num_entries_ > 0) {
       user_vals.reserve(num_entries_);
       sub_key_bs.reserve(num_entries_);
@@ -1025,13 +1157,21 @@ class ColumnTable::ColumnIterator : public InternalIterator {
           if (!ParseInternalKey(iter->key(), &parsed_key)) {
             return Status::Corruption("corrupted internal key in Table::Iter");
           }
+          if (start_sub_key.empty()) {  // record the sub start key
+            start_sub_key.assign(iter->value().data_, iter->value().size_);
+          }
 
           if (parsed_key.sequence <= sequence_num) {
             std::string user_key(iter->key().data(), iter->key().size() - 8);
-            SeqTypeVal stv(parsed_key.sequence, parsed_key.type, res.end());
-            if (start_sub_key.empty()) {  // record the sub start key
-              start_sub_key.assign(iter->value().data_, iter->value().size_);
+            // The rows out of the predicates shadow their older versions just
+            // like deletions, without reading their sub column values.
+            ValueType type = parsed_key.type;
+            bool filtered = rows_ && type == kTypeValue &&
+                !rows_->Contains(DecodeFixed64BigEndian(iter->value().data()));
+            if (filtered) {
+              type = kTypeDeletion;
             }
+            SeqTypeVal stv(parsed_key.sequence, type, res.end());
 
             // give accurate hint
             auto it = meta->map_res->end();
@@ -1049,45 +1189,48 @@ class ColumnTable::ColumnIterator : public InternalIterator {
             // two cases:
             // 1. already exists the same user key, invalidate the old one
             // 2. same seq, the current one
-            sub_key_bs.push_back(true);
-            seq_idx_map.insert({parsed_key.sequence, sub_key_bs.size() - 1});
+            sub_key_bs.push_back(!filtered);
+            if (!filtered) {
+              user_vals.push_back(it);
+              if (batched) {
+                user_keys.push_back(user_key);
+              }
+            }
 
             if (it->second.seq_ < parsed_key.sequence) {
               // replaced
               if (it->second.type_ == kTypeDeletion) {
-                meta->del_keys.erase(it->second.seq_);
+                meta->del_keys.erase(&*it->second.iter_);
               }
               assert(read_options.result_val_size >=
                   it->second.iter_->user_val.size());
               read_options.result_val_size -= it->second.iter_->user_val.size();
               it->second.seq_ = parsed_key.sequence;
-              it->second.type_ = parsed_key.type;
+              it->second.type_ = type;
               it->second.iter_->user_val = "";
-              user_vals.push_back(it);
-              if (parsed_key.type == kTypeDeletion) {
-                meta->del_keys.insert({parsed_key.sequence, it->second.iter_});
+              if (type == kTypeDeletion) {
+                meta->del_keys.insert({&*it->second.iter_, it->second.iter_});
               }
             } else {
               // inserted
               res.emplace_back(user_key, "");
               read_options.result_key_size += user_key.size();
               it->second.iter_ = --res.end();
-              user_vals.push_back(it);
-              if (parsed_key.type == kTypeDeletion) {
-                meta->del_keys.insert({parsed_key.sequence, it->second.iter_});
+              if (type == kTypeDeletion) {
+                meta->del_keys.insert({&*it->second.iter_, it->second.iter_});
               }
 
               // check the result size only by key size
               auto crl = CompressResultList(&res, read_options);
-              if (crl.size() > 0 && meta->map_res->rbegin()->first <= user_key) {
+              if (crl.size() > 0 &&
+                  meta->map_res->rbegin()->first <= user_key) {
                 if (meta->map_res->rbegin()->first < user_key) {
-                  for (auto& seq : crl) {
-                    // element added but popped out in map
-                    // remove in bits as well
-                    if (seq_idx_map.erase(seq) > 0) {
-                      sub_key_bs.pop_back();
-                      user_vals.pop_back();
-                    }
+                  // the current one added but popped out in map, remove it
+                  // in bits as well
+                  sub_key_bs.pop_back();
+                  if (!filtered) {
+                    user_vals.pop_back();
+                    user_keys.pop_back();
                   }
                 }
                 break;  // Reach the batch capacity
@@ -1098,17 +1241,32 @@ class ColumnTable::ColumnIterator : public InternalIterator {
           }
         }
       } else {  // loop query all sub column values
-        if (!start_sub_key.empty()) {
-          iter->Seek(start_sub_key);
-        } else {  // not found valid keys
+        if (user_vals.empty()) {  // not found valid keys
           break;
         }
+        iter->Seek(start_sub_key);
+        uint64_t start_ordinal = DecodeFixed64BigEndian(start_sub_key.data());
 
+        // sub_key_idx follows the row of iter
         size_t sub_key_idx = 0, user_val_idx = 0;
-        for (; iter->Valid() && sub_key_idx < sub_key_bs.size(); iter->Next()) {
-          if (!sub_key_bs[sub_key_idx++]) {  // follow sub_key's order
+        for (size_t k = 0; iter->Valid() && k < sub_key_bs.size(); k++) {
+          if (!sub_key_bs[k]) {  // follow sub_key's order
             continue;
           }
+          if (k - sub_key_idx > kMaxSkippedSubKeys) {
+            // jump over the data blocks of the skipped rows
+            std::string sub_key;
+            PutFixed64BigEndian(&sub_key, start_ordinal + k);
+            iter->Seek(sub_key);
+          } else {
+            for (; sub_key_idx < k && iter->Valid(); sub_key_idx++) {
+              iter->Next();
+            }
+          }
+          sub_key_idx = k;
+          if (!iter->Valid()) {
+            break;
+          }
 
           auto& it = user_vals[user_val_idx++]->second.iter_;
           size_t prev_val_size = it->user_val.size();
@@ -1116,28 +1274,31 @@ class ColumnTable::ColumnIterator : public InternalIterator {
                             i + 1 == columns_.size());
           size_t delta_val_size = it->user_val.size() - prev_val_size;
           read_options.result_val_size += delta_val_size;
+          iter->Next();
+          sub_key_idx++;
 
           // check the result size by key and value size
           auto crl = CompressResultList(&res, read_options);
           if (crl.size() > 0) {  // Reach the batch capacity
-            size_t smallest_idx = sub_key_bs.size();
-            for (auto& seq : crl) {
-              auto idx_iter = seq_idx_map.find(seq);
-              if (idx_iter == seq_idx_map.end()) {
-                // user_key is not in this sstable
-                continue;
-              }
-
-              size_t idx = idx_iter->second;
-              assert(idx <= sub_key_bs.size());
-              smallest_idx = std::min(smallest_idx, idx);
-              seq_idx_map.erase(idx_iter);
+            // the last user keys are popped out in map, down to the new
+            // limit key, remove them in bits as well
+            const std::string& limit_key = meta->map_res->rbegin()->first;
+            size_t n = user_keys.size();
+            while (n > 0 && meta->map_res->key_comp()(limit_key,
+                                                      user_keys[n - 1])) {
+              n--;
             }
-
-            // remove sub_key index from sub_key_bs
-            assert(smallest_idx <= sub_key_bs.size());
-            if (smallest_idx < sub_key_bs.size()) {
-              sub_key_bs.resize(smallest_idx);
+            if (n < user_keys.size()) {
+              // sub_key_bs index of the n-th valid sub_key
+              size_t idx = 0;
+              for (size_t valid = 0; idx < sub_key_bs.size(); idx++) {
+                if (sub_key_bs[idx] && valid++ == n) {
+                  break;
+                }
+              }
+              sub_key_bs.resize(idx);
+              user_vals.resize(n);
+              user_keys.resize(n);
             }
           }
         }
@@ -1185,6 +1346,8 @@ class ColumnTable::ColumnIterator : public InternalIterator {
   const Splitter* splitter_;                         // used in rangequery
   const InternalKeyComparator& internal_comparator_; // used in rangrquery
   uint64_t num_entries_;  // used in rangrquery
+  // The rows matching the column predicates, null if unknown
+  std::unique_ptr<RowBitmap> rows_;  // used in rangequery
 };
 
 // Note: Column index must be from 0 to MAX_COLUMN_INDEX.
@@ -1211,6 +1374,14 @@ InternalIterator* ColumnTable::NewIterator(const ReadOptions& read_options,
   ReadOptions ro = SanitizeColumnReadOptions(
       rep_->table_options.column_count, read_options);
 
+  std::unique_ptr<RowBitmap> rows;
+  if (!ro.column_predicates.empty()) {
+    Status s = NewRowBitmap(ro, &rows);
+    if (!s.ok()) {
+      return NewErrorInternalIterator(s, arena);
+    }
+  }
+
   std::vector<InternalIterator*> iters;  // main column
   iters.push_back(NewTwoLevelIterator(new BlockEntryIteratorState(this, ro),
                                       NewIndexIterator(ro), arena));
@@ -1224,7 +1395,45 @@ InternalIterator* ColumnTable::NewIterator(const ReadOptions& read_options,
   }
   return new ColumnIterator(iters, true, rep_->ioptions.splitter,
                             rep_->internal_comparator,
-                            rep_->table_properties->num_entries);
+                            rep_->table_properties->num_entries,
+                            rows.release());
+}
+
+Status ColumnTable::NewRowBitmap(const ReadOptions& read_options,
+                                 std::unique_ptr<RowBitmap>* rows) {
+  rows->reset();
+  uint64_t num_rows = rep_->table_properties->num_entries;
+  for (const auto& predicate : read_options.column_predicates) {
+    uint32_t column = predicate.column;
+    if (column < 1 || column > rep_->tables.size() ||
+        !rep_->tables[column-1]) {
+      continue;
+    }
+    Block* block = rep_->tables[column-1]->rep_->bitmap_index_block.get();
+    if (block == nullptr) {  // too many distinct values
+      continue;
+    }
+
+    std::unique_ptr<RowBitmap> matched(new RowBitmap(num_rows));
+    std::unique_ptr<InternalIterator> iter(
+        block->NewIterator(BytewiseComparator()));
+    for (const auto& value : predicate.values) {
+      iter->Seek(value);
+      if (iter->Valid() && iter->key() == Slice(value)) {
+        Status s = matched->Or(iter->value());
+        if (!s.ok()) {
+          return s;
+        }
+      }
+    }
+
+    if (*rows) {
+      (*rows)->And(*matched);
+    } else {
+      *rows = std::move(matched);
+    }
+  }
+  return Status::OK();
 }
 
 Status ColumnTable::Get(const ReadOptions& read_options, const Slice& key,
@@ -1391,6 +1600,18 @@ Status ColumnTable::Prefetch(const Slice* const begin, const Slice* const end,
   return Status::OK();
 }
 
+Status ColumnTable::GetDataBlockIndexKeys(std::vector<std::string>* keys) {
+  // sub columns are keyed by the row ordinals
+  if (!rep_->main_column) {
+    return Status::NotSupported("GetDataBlockIndexKeys() on a sub column");
+  }
+  unique_ptr<InternalIterator> index_iter(NewIndexIterator(ReadOptions()));
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    keys->push_back(index_iter->key().ToString());
+  }
+  return index_iter->status();
+}
+
 uint64_t ColumnTable::ApproximateOffsetOf(const Slice& key) {
   unique_ptr<InternalIterator> index_iter(NewIndexIterator(ReadOptions()));
 
@@ -1490,6 +1711,9 @@ size_t ColumnTable::ApproximateMemoryUsage() const {
       usage += it->ApproximateMemoryUsage();
     }
   }
+  if (rep_->bitmap_index_block) {
+    usage += rep_->bitmap_index_block->usable_size();
+  }
   return usage;
 }
 
@@ -1551,6 +1775,19 @@ Status ColumnTable::DumpTable(WritableFile* out_file) {
   // Output Data blocks
   s = DumpDataBlocks(out_file);
 
+  // Output the sub column files
+  for (size_t i = 0; s.ok() && i < rep_->tables.size(); i++) {
+    if (!rep_->tables[i]) {
+      continue;  // not opened, filtered out by cols
+    }
+    out_file->Append("Column ");
+    out_file->Append(vidardb::ToString(i + 1));
+    out_file->Append(
+        " Details:\n"
+        "======================================\n");
+    s = rep_->tables[i]->DumpTable(out_file);
+  }
+
   return s;
 }
 
@@ -37,6 +37,7 @@ struct EnvOptions;
 struct ReadOptions;
 class GetContext;
 class InternalIterator;
+class RowBitmap;
 
 using std::unique_ptr;
 
@@ -95,6 +96,8 @@ class ColumnTable : public TableReader {
   // be close to the file length.
   uint64_t ApproximateOffsetOf(const Slice& key) override;
 
+  Status GetDataBlockIndexKeys(std::vector<std::string>* keys) override;
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   void SetupForCompaction() override;
@@ -103,8 +106,7 @@ class ColumnTable : public TableReader {
 
   size_t ApproximateMemoryUsage() const override;
 
-  // TODO: dump all columns
-  // convert SST file to a human readable form
+  // convert SST file to a human readable form, with its sub column files
   Status DumpTable(WritableFile* out_file) override;
 
   void Close() override;
@@ -162,6 +164,12 @@ class ColumnTable : public TableReader {
       Rep* rep, const ReadOptions& read_options, const Slice& index_value,
       BlockIter* input_iter = nullptr);
 
+  // Sets *rows to the rows matching read_options.column_predicates, as far as
+  // the bitmap indexes of the sub column files tell, or to null if none of
+  // the predicate columns has one.
+  Status NewRowBitmap(const ReadOptions& read_options,
+                      std::unique_ptr<RowBitmap>* rows);
+
   // Create a index reader based on the index type stored in the table.
   Status CreateIndexReader(IndexReader** index_reader);
 
@@ -12,6 +12,7 @@
 #include <string>
 #include <inttypes.h>
 
+#include "vidardb/cache.h"
 #include "vidardb/env.h"
 #include "table/block.h"
 #include "table/block_based_table_reader.h"
@@ -21,6 +22,7 @@
 #include "util/file_reader_writer.h"
 #include "util/perf_context_imp.h"
 #include "util/string_util.h"
+#include "util/xxhash.h"
 
 namespace vidardb {
 
@@ -28,6 +30,9 @@ extern const uint64_t kBlockBasedTableMagicNumber;
 
 const uint32_t DefaultStackBufferSize = 5000;
 
+// Spreads the block type over the xxHash checksums
+const uint32_t kBlockTypeMultiplier = 0x6b9083d9;
+
 void BlockHandle::EncodeTo(std::string* dst) const {
   // Sanity check that all fields have been set
   assert(offset_ != ~static_cast<uint64_t>(0));
@@ -58,19 +63,21 @@ std::string BlockHandle::ToString(bool hex) const {
 
 const BlockHandle BlockHandle::kNullBlockHandle(0, 0);
 
-// new footer format:
-//    checksum (char, 1 byte)
+// footer format:
 //    metaindex handle (varint64 offset, varint64 size)
 //    index handle     (varint64 offset, varint64 size)
-//    <padding> to make the total size 2 * BlockHandle::kMaxEncodedLength + 1
-//    footer version (4 bytes)
+//    <padding> to make the total size 2 * BlockHandle::kMaxEncodedLength - 1
+//    checksum type (char, 1 byte), 0 (crc32c) in the files written before it
 //    table_magic_number (8 bytes)
 void Footer::EncodeTo(std::string* dst) const {
   assert(HasInitializedTableMagicNumber());
   const size_t original_size = dst->size();
   metaindex_handle_.EncodeTo(dst);
   index_handle_.EncodeTo(dst);
-  dst->resize(original_size + kEncodedLength - 8);  // Padding
+  // The handles of any file below 2^56 bytes leave the checksum byte alone
+  assert(dst->size() <= original_size + kEncodedLength - 9);
+  dst->resize(original_size + kEncodedLength - 9);  // Padding
+  dst->push_back(static_cast<char>(checksum_));
   PutFixed32(dst, static_cast<uint32_t>(table_magic_number() & 0xffffffffu));
   PutFixed32(dst, static_cast<uint32_t>(table_magic_number() >> 32));
   assert(dst->size() == original_size + kEncodedLength);
@@ -92,10 +99,10 @@ Status Footer::DecodeFrom(Slice* input) {
                     (static_cast<uint64_t>(magic_lo)));
 
   set_table_magic_number(magic);
+  checksum_ = static_cast<ChecksumType>(magic_ptr[-1]);
 
-  // Footer version 1 and higher will always occupy exactly this many bytes.
-  // It consists of the checksum type, two block handles, padding,
-  // a version number, and a magic number
+  // The footer will always occupy exactly this many bytes. It consists of two
+  // block handles, padding, the checksum type, and a magic number
   if (input->size() < kEncodedLength) {
     return Status::Corruption("input is too short to be an sstable");
   } else {
@@ -122,6 +129,8 @@ std::string Footer::ToString() const {
   result.append("index handle: " + index_handle_.ToString() + "\n  ");
   result.append("table_magic_number: " +
                 vidardb::ToString(table_magic_number_) + "\n  ");
+  result.append("checksum: " + vidardb::ToString(static_cast<int>(checksum_)) +
+                "\n  ");
   return result;
 }
 
@@ -158,6 +167,28 @@ Status ReadFooterFromFile(RandomAccessFileReader* file, uint64_t file_size,
   return Status::OK();
 }
 
+bool IsSupportedChecksum(ChecksumType type) {
+  return type == kCRC32c || type == kxxHash64 || type == kXXH3;
+}
+
+uint32_t ComputeBlockChecksum(ChecksumType type, const char* data, size_t n,
+                              char block_type) {
+  switch (type) {
+    case kxxHash64:
+      return static_cast<uint32_t>(xxhash::XXH64(data, n, 0)) ^
+             (static_cast<unsigned char>(block_type) * kBlockTypeMultiplier);
+    case kXXH3:
+      return static_cast<uint32_t>(xxhash::XXH3_64bits(data, n)) ^
+             (static_cast<unsigned char>(block_type) * kBlockTypeMultiplier);
+    default: {
+      assert(type == kCRC32c);
+      uint32_t crc = crc32c::Value(data, n);
+      crc = crc32c::Extend(crc, &block_type, 1);  // Extend to cover block type
+      return crc32c::Mask(crc);
+    }
+  }
+}
+
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
 
@@ -191,9 +222,13 @@ Status ReadBlock(RandomAccessFileReader* file, const Footer& footer,
     PERF_TIMER_GUARD(block_checksum_time);
     uint32_t value = DecodeFixed32(data + n + 1);
     uint32_t actual = 0;
-
-    value = crc32c::Unmask(value);
-    actual = crc32c::Value(data, n + 1);
+    if (!IsSupportedChecksum(footer.checksum())) {
+      s = Status::Corruption(
+          "unknown checksum type " +
+          vidardb::ToString(static_cast<int>(footer.checksum())));
+    } else {
+      actual = ComputeBlockChecksum(footer.checksum(), data, n, data[n]);
+    }
 
     if (s.ok() && actual != value) {
       s = Status::Corruption("block checksum mismatch");
@@ -207,16 +242,24 @@ Status ReadBlock(RandomAccessFileReader* file, const Footer& footer,
 
 }  // namespace
 
+MemoryAllocator* GetMemoryAllocator(const TableOptions& table_options) {
+  // The cached blocks are freed by the cache, which keeps its allocator alive
+  if (table_options.block_cache != nullptr) {
+    return table_options.block_cache->memory_allocator();
+  }
+  return table_options.memory_allocator.get();
+}
+
 Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
                          const ReadOptions& read_options,
                          const BlockHandle& handle, BlockContents* contents,
                          Env* env, bool decompression_requested,
                          const Slice& compression_dict,
-                         Logger* info_log) {
+                         Logger* info_log, MemoryAllocator* allocator) {
   Status status;
   Slice slice;
   size_t n = static_cast<size_t>(handle.size());
-  std::unique_ptr<char[]> heap_buf;
+  CacheAllocationPtr heap_buf;
   char stack_buf[DefaultStackBufferSize];
   char* used_buf = nullptr;
   vidardb::CompressionType compression_type;
@@ -230,7 +273,7 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
     // trivially allocated stack buffer instead of needing a full malloc()
     used_buf = &stack_buf[0];
   } else {
-    heap_buf = std::unique_ptr<char[]>(new char[n + kBlockTrailerSize]);
+    heap_buf = AllocateBlock(n + kBlockTrailerSize, allocator);
     used_buf = heap_buf.get();
   }
 
@@ -247,14 +290,14 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
   if (decompression_requested && compression_type != kNoCompression) {
     // compressed page, uncompress, update cache
     status = UncompressBlockContents(slice.data(), n, contents,
-                                     compression_dict);
+                                     compression_dict, allocator);
   } else if (slice.data() != used_buf) {
     // the slice content is not the buffer provided
     *contents = BlockContents(Slice(slice.data(), n), false, compression_type);
   } else {
     // page is uncompressed, the buffer either stack or heap provided
     if (used_buf == &stack_buf[0]) {
-      heap_buf = std::unique_ptr<char[]>(new char[n]);
+      heap_buf = AllocateBlock(n, allocator);
       memcpy(heap_buf.get(), stack_buf, n);
     }
     *contents = BlockContents(std::move(heap_buf), n, true, compression_type);
@@ -272,8 +315,9 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
 // format_version is the block format as defined in include/vidardb/table.h
 Status UncompressBlockContents(const char* data, size_t n,
                                BlockContents* contents,
-                               const Slice& compression_dict) {
-  std::unique_ptr<char[]> ubuf;
+                               const Slice& compression_dict,
+                               MemoryAllocator* allocator) {
+  CacheAllocationPtr ubuf;
   int decompress_size = 0;
   assert(data[n] != kNoCompression);
   switch (data[n]) {
@@ -284,7 +328,7 @@ Status UncompressBlockContents(const char* data, size_t n,
       if (!Snappy_GetUncompressedLength(data, n, &ulength)) {
         return Status::Corruption(snappy_corrupt_msg);
       }
-      ubuf.reset(new char[ulength]);
+      ubuf = AllocateBlock(ulength, allocator);
       if (!Snappy_Uncompress(data, n, ubuf.get())) {
         return Status::Corruption(snappy_corrupt_msg);
       }
@@ -292,10 +336,9 @@ Status UncompressBlockContents(const char* data, size_t n,
       break;
     }
     case kZlibCompression:
-      ubuf.reset(Zlib_Uncompress(
-          data, n, &decompress_size,
-          GetCompressFormatForVersion(kZlibCompression),
-          compression_dict));
+      ubuf = Zlib_Uncompress(data, n, &decompress_size,
+                             GetCompressFormatForVersion(kZlibCompression),
+                             compression_dict, -14, allocator);
       if (!ubuf) {
         static char zlib_corrupt_msg[] =
           "Zlib not supported or corrupted Zlib compressed block contents";
@@ -305,9 +348,9 @@ Status UncompressBlockContents(const char* data, size_t n,
           BlockContents(std::move(ubuf), decompress_size, true, kNoCompression);
       break;
     case kBZip2Compression:
-      ubuf.reset(BZip2_Uncompress(
-          data, n, &decompress_size,
-          GetCompressFormatForVersion(kBZip2Compression)));
+      ubuf = BZip2_Uncompress(data, n, &decompress_size,
+                              GetCompressFormatForVersion(kBZip2Compression),
+                              allocator);
       if (!ubuf) {
         static char bzip2_corrupt_msg[] =
           "Bzip2 not supported or corrupted Bzip2 compressed block contents";
@@ -16,6 +16,7 @@
 #include "vidardb/table.h"
 
 #include "port/port.h" // noexcept
+#include "util/memory_allocator.h"
 
 namespace vidardb {
 
@@ -103,6 +104,10 @@ class Footer {
 
   uint64_t table_magic_number() const { return table_magic_number_; }
 
+  // The checksum of the blocks of the table
+  ChecksumType checksum() const { return checksum_; }
+  void set_checksum(ChecksumType t) { checksum_ = t; }
+
   void EncodeTo(std::string* dst) const;
 
   // Set the current footer based on the input slice.
@@ -143,6 +148,7 @@ class Footer {
   BlockHandle metaindex_handle_;
   BlockHandle index_handle_;
   uint64_t table_magic_number_ = 0;
+  ChecksumType checksum_ = kCRC32c;
 };
 
 // Read the footer from file
@@ -155,11 +161,20 @@ Status ReadFooterFromFile(RandomAccessFileReader* file, uint64_t file_size,
 // 1-byte type + 32-bit crc
 static const size_t kBlockTrailerSize = 5;
 
+// Whether the blocks of a table with this checksum type can be verified
+extern bool IsSupportedChecksum(ChecksumType type);
+
+// The checksum of the block data[0,n-1] and its type, as stored in the block
+// trailer. The xxHash ones hash the block alone and fold the type in, so the
+// block is checksummed as it is written, before its trailer.
+extern uint32_t ComputeBlockChecksum(ChecksumType type, const char* data,
+                                     size_t n, char block_type);
+
 struct BlockContents {
   Slice data;           // Actual contents of data
   bool cachable;        // True iff data can be cached
   CompressionType compression_type;
-  std::unique_ptr<char[]> allocation;
+  CacheAllocationPtr allocation;
 
   BlockContents() : cachable(false), compression_type(kNoCompression) {}
 
@@ -167,7 +182,7 @@ struct BlockContents {
                 CompressionType _compression_type)
       : data(_data), cachable(_cachable), compression_type(_compression_type) {}
 
-  BlockContents(std::unique_ptr<char[]>&& _data, size_t _size, bool _cachable,
+  BlockContents(CacheAllocationPtr&& _data, size_t _size, bool _cachable,
                 CompressionType _compression_type)
       : data(_data.get(), _size),
         cachable(_cachable),
@@ -185,6 +200,10 @@ struct BlockContents {
   }
 };
 
+// The allocator of the block buffers of a table: the one of its block cache,
+// which outlives the cached blocks, otherwise table_options' memory_allocator.
+extern MemoryAllocator* GetMemoryAllocator(const TableOptions& table_options);
+
 // Read the block identified by "handle" from "file".  On failure
 // return non-OK.  On success fill *result and return OK.
 extern Status ReadBlockContents(
@@ -192,18 +211,19 @@ extern Status ReadBlockContents(
     const ReadOptions& options, const BlockHandle& handle,
     BlockContents* contents, Env* env, bool do_uncompress = true,
     const Slice& compression_dict = Slice(),
-    Logger* info_log = nullptr);
+    Logger* info_log = nullptr, MemoryAllocator* allocator = nullptr);
 
 // The 'data' points to the raw block contents read in from file.
-// This method allocates a new heap buffer and the raw block
-// contents are uncompresed into this buffer. This buffer is
+// This method allocates a new heap buffer (from allocator if not null) and
+// the raw block contents are uncompresed into this buffer. This buffer is
 // returned via 'result' and it is upto the caller to
 // free this buffer.
 // For description of compress_format_version and possible values, see
 // util/compression.h
 extern Status UncompressBlockContents(const char* data, size_t n,
                                       BlockContents* contents,
-                                      const Slice& compression_dict);
+                                      const Slice& compression_dict,
+                                      MemoryAllocator* allocator = nullptr);
 
 // Implementation details follow.  Clients should ignore,
 
@@ -4,6 +4,7 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include "table/get_context.h"
+#include "db/read_callback.h"
 #include "vidardb/env.h"
 #include "vidardb/statistics.h"
 #include "util/perf_context_imp.h"
@@ -31,14 +32,17 @@ void appendToReplayLog(std::string* replay_log, ValueType type, Slice value) {
 
 GetContext::GetContext(const Comparator* ucmp, GetState init_state,
                        const Slice& user_key, std::string* ret_value,
-                       bool* value_found, SequenceNumber* seq)
+                       bool* value_found, SequenceNumber* seq,
+                       ReadCallback* callback)
     : ucmp_(ucmp),
       state_(init_state),
       user_key_(user_key),
       value_(ret_value),
       value_found_(value_found),
       seq_(seq),
-      replay_log_(nullptr) {
+      callback_(callback),
+      replay_log_(nullptr),
+      is_blob_index_(false) {
   if (seq_) {
     *seq_ = kMaxSequenceNumber;
   }
@@ -59,6 +63,9 @@ void GetContext::MarkKeyMayExist() {
 bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
                            const Slice& value) {
   if (ucmp_->Equal(parsed_key.user_key, user_key_)) {
+    if (callback_ != nullptr && !callback_->IsVisible(parsed_key.sequence)) {
+      return true;
+    }
     appendToReplayLog(replay_log_, parsed_key.type, value);
 
     if (seq_ != nullptr) {
@@ -71,9 +78,11 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
     // Key matches. Process it
     switch (parsed_key.type) {
       case kTypeValue:
+      case kTypeBlobIndex:
         assert(state_ == kNotFound);
         if (kNotFound == state_) {
           state_ = kFound;
+          is_blob_index_ = (parsed_key.type == kTypeBlobIndex);
           if (value_ != nullptr) {
             value_->assign(value.data(), value.size());
           }
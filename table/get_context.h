@@ -16,6 +16,8 @@
 
 namespace vidardb {
 
+class ReadCallback;
+
 class GetContext {
  public:
   enum GetState {
@@ -25,9 +27,10 @@ class GetContext {
     kCorrupt,
   };
 
+  // The entries callback rejects, if any, are skipped.
   GetContext(const Comparator* ucmp, GetState init_state, const Slice& user_key,
              std::string* ret_value, bool* value_found,
-             SequenceNumber* seq = nullptr);
+             SequenceNumber* seq = nullptr, ReadCallback* callback = nullptr);
 
   void MarkKeyMayExist();
 
@@ -40,6 +43,10 @@ class GetContext {
 
   GetState State() const { return state_; }
 
+  // Whether the value found is a kTypeBlobIndex one, to be read back from the
+  // blob files by the caller.
+  bool is_blob_index() const { return is_blob_index_; }
+
   // If a non-null string is passed, all the SaveValue calls will be
   // logged into the string. The operations can then be replayed on
   // another GetContext with replayGetContextLog.
@@ -48,6 +55,9 @@ class GetContext {
   // Do we need to fetch the SequenceNumber for this key?
   bool NeedToReadSequence() const { return (seq_ != nullptr); }
 
+  // Whether some entries may be skipped, which the row cache does not know
+  bool HasReadCallback() const { return callback_ != nullptr; }
+
   /************************** Shichao *******************************/
   // For column store only
   bool IsEqualToUserKey(const ParsedInternalKey& parsed_key) const {
@@ -64,7 +74,9 @@ class GetContext {
   // If a key is found, seq_ will be set to the SequenceNumber of most recent
   // write to the key or kMaxSequenceNumber if unknown
   SequenceNumber* seq_;
+  ReadCallback* callback_;
   std::string* replay_log_;
+  bool is_blob_index_;
 };
 
 void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
@@ -324,6 +324,139 @@ InternalIterator* NewMergingIterator(const Comparator* cmp,
   }
 }
 
+// Iterates over the children one after the other, skipping the empty ones.
+class ConcatenatingIterator : public InternalIterator {
+ public:
+  ConcatenatingIterator(InternalIterator** children, int n,
+                        bool is_arena_mode)
+      : is_arena_mode_(is_arena_mode), current_(n) {
+    children_.resize(n);
+    for (int i = 0; i < n; i++) {
+      children_[i].Set(children[i]);
+    }
+  }
+
+  virtual ~ConcatenatingIterator() {
+    for (auto& child : children_) {
+      child.DeleteIter(is_arena_mode_);
+    }
+  }
+
+  virtual bool Valid() const override {
+    return current_ >= 0 && current_ < static_cast<int>(children_.size()) &&
+           children_[current_].Valid();
+  }
+
+  virtual void SeekToFirst() override {
+    current_ = 0;
+    if (!children_.empty()) {
+      children_[0].SeekToFirst();
+    }
+    SkipEmptyForward();
+  }
+
+  virtual void SeekToLast() override {
+    current_ = static_cast<int>(children_.size()) - 1;
+    if (current_ >= 0) {
+      children_[current_].SeekToLast();
+    }
+    SkipEmptyBackward();
+  }
+
+  virtual void Seek(const Slice& target) override {
+    for (current_ = 0; current_ < static_cast<int>(children_.size());
+         current_++) {
+      children_[current_].Seek(target);
+      if (children_[current_].Valid() || !children_[current_].status().ok()) {
+        break;
+      }
+    }
+  }
+
+  virtual void Next() override {
+    assert(Valid());
+    children_[current_].Next();
+    SkipEmptyForward();
+  }
+
+  virtual void Prev() override {
+    assert(Valid());
+    children_[current_].Prev();
+    SkipEmptyBackward();
+  }
+
+  virtual Slice key() const override {
+    assert(Valid());
+    return children_[current_].key();
+  }
+
+  virtual Slice value() override {
+    assert(Valid());
+    return children_[current_].value();
+  }
+
+  virtual Status status() const override {
+    for (auto& child : children_) {
+      if (!child.status().ok()) {
+        return child.status();
+      }
+    }
+    return Status::OK();
+  }
+
+  virtual void SetPinnedItersMgr(
+      PinnedIteratorsManager* pinned_iters_mgr) override {
+    for (auto& child : children_) {
+      child.SetPinnedItersMgr(pinned_iters_mgr);
+    }
+  }
+
+  virtual bool IsKeyPinned() const override {
+    assert(Valid());
+    return children_[current_].IsKeyPinned();
+  }
+
+ private:
+  void SkipEmptyForward() {
+    while (current_ < static_cast<int>(children_.size()) &&
+           !children_[current_].Valid() && children_[current_].status().ok()) {
+      if (++current_ < static_cast<int>(children_.size())) {
+        children_[current_].SeekToFirst();
+      }
+    }
+  }
+
+  void SkipEmptyBackward() {
+    while (current_ >= 0 && !children_[current_].Valid() &&
+           children_[current_].status().ok()) {
+      if (--current_ >= 0) {
+        children_[current_].SeekToLast();
+      }
+    }
+  }
+
+  bool is_arena_mode_;
+  std::vector<IteratorWrapper> children_;
+  int current_;  // the child at the position, or out of range if none
+};
+
+InternalIterator* NewConcatenatingIterator(InternalIterator** list, int n,
+                                           Arena* arena) {
+  assert(n >= 0);
+  if (n == 0) {
+    return NewEmptyInternalIterator(arena);
+  } else if (n == 1) {
+    return list[0];
+  } else {
+    if (arena == nullptr) {
+      return new ConcatenatingIterator(list, n, false);
+    } else {
+      auto mem = arena->AllocateAligned(sizeof(ConcatenatingIterator));
+      return new (mem) ConcatenatingIterator(list, n, true);
+    }
+  }
+}
+
 MergeIteratorBuilder::MergeIteratorBuilder(const Comparator* comparator,
                                            Arena* a)
     : first_iter(nullptr), use_merging_iter(false), arena(a) {
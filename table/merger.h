@@ -30,6 +30,16 @@ extern InternalIterator* NewMergingIterator(const Comparator* comparator,
                                             InternalIterator** children, int n,
                                             Arena* arena = nullptr);
 
+// Return an iterator over the data of children[0,n-1] one after the other,
+// without the heap of a merging iterator.  Takes ownership of the child
+// iterators and will delete them when the result iterator is deleted.
+//
+// REQUIRES: n >= 0, and every key of children[i] is before every key of
+//           children[i+1]
+extern InternalIterator* NewConcatenatingIterator(InternalIterator** children,
+                                                  int n,
+                                                  Arena* arena = nullptr);
+
 class MergingIterator;
 
 // A builder class to build a merging iterator by adding iterators one by one.
@@ -119,6 +119,23 @@ void MetaColumnBlockBuilder::Add(uint32_t key, uint64_t value) {
   Add(str_key, str_val);
 }
 
+void MetaColumnBlockBuilder::Add(bool key, uint32_t value, uint32_t path_id) {
+  std::string str_key, str_val;
+  PutFixed32(&str_key, key);
+  PutFixed32(&str_val, value);
+  PutFixed32(&str_val, path_id);
+  Add(str_key, str_val);
+}
+
+void MetaColumnBlockBuilder::Add(uint32_t key, uint64_t value,
+                                 uint32_t path_id) {
+  std::string str_key, str_val;
+  PutFixed32(&str_key, key);
+  PutFixed64(&str_val, value);
+  PutFixed32(&str_val, path_id);
+  Add(str_key, str_val);
+}
+
 void MetaColumnBlockBuilder::Add(const std::string& key,
                              const std::string& value) {
     meta_column_block_->Add(key, value);
@@ -276,7 +293,8 @@ Status ReadProperties(const Slice& handle_value, RandomAccessFileReader* file,
 Status ReadMetaColumnBlock(const Slice& handle_value,
                            RandomAccessFileReader* file, const Footer& footer,
                            Env* env, Logger* logger, uint32_t* column_num,
-                           std::vector<uint64_t>& file_sizes) {
+                           std::vector<uint64_t>& file_sizes,
+                           std::vector<uint32_t>* path_ids) {
   Slice v = handle_value;
   BlockHandle handle;
   if (!handle.DecodeFrom(&v).ok()) {
@@ -303,13 +321,22 @@ Status ReadMetaColumnBlock(const Slice& handle_value,
       break;
     }
 
+    Slice val = iter->value();
+    uint32_t path_id = 0;
     if (i == 0) {
-      *column_num = DecodeFixed32(iter->value().data());
+      GetFixed32(&val, column_num);
       file_sizes.resize(*column_num);
     } else {
-      Slice val = iter->value();
       GetFixed64(&val, &file_sizes[i-1]);
     }
+    // path id is only recorded by the tables aware of file placement
+    if (path_ids != nullptr && GetFixed32(&val, &path_id)) {
+      path_ids->push_back(path_id);
+    }
+  }
+
+  if (path_ids != nullptr && path_ids->size() != i) {
+    path_ids->clear();
   }
 
   if (s.ok()) {
@@ -82,6 +82,9 @@ class MetaColumnBlockBuilder {
 
   void Add(bool key, uint32_t value);
   void Add(uint32_t key, uint64_t value);
+  // Same as above, additionally recording the db path id of the file
+  void Add(bool key, uint32_t value, uint32_t path_id);
+  void Add(uint32_t key, uint64_t value, uint32_t path_id);
   void Add(const std::string& key, const std::string& value);
 
   // Write all the added entries to the block and return the block contents
@@ -124,11 +127,15 @@ Status ReadProperties(const Slice& handle_value, RandomAccessFileReader* file,
 
 /*********************************** Shichao *******************************/
 // Read the meta column block from the table.
+// If path_ids is not null and the table records the placement of its files,
+// *path_ids is filled with the path id of the main file followed by those of
+// the sub column files; otherwise it is left empty.
 // @returns a status to indicate if the operation succeeded.
 Status ReadMetaColumnBlock(const Slice& handle_value,
                            RandomAccessFileReader* file, const Footer& footer,
                            Env* env, Logger* logger, uint32_t* column_num,
-                           std::vector<uint64_t>& file_sizes);
+                           std::vector<uint64_t>& file_sizes,
+                           std::vector<uint32_t>* path_ids = nullptr);
 /*********************************** Shichao *******************************/
 
 // Directly read the properties from the properties block of a plain table.
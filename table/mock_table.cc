@@ -138,5 +138,18 @@ void MockTableFactory::AssertLatestFile(
   }
 }
 
+void MockTableFactory::AssertFiles(const stl_wrappers::KVMap& file_contents,
+                                   size_t num_files) {
+  ASSERT_EQ(file_system_.files.size(), num_files);
+  stl_wrappers::KVMap all;
+  size_t total = 0;
+  for (const auto& file : file_system_.files) {
+    all.insert(file.second.begin(), file.second.end());
+    total += file.second.size();
+  }
+  ASSERT_EQ(file_contents.size(), total);
+  ASSERT_TRUE(file_contents == all);
+}
+
 }  // namespace mock
 }  // namespace vidardb
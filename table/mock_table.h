@@ -174,6 +174,9 @@ class MockTableFactory : public TableFactory {
   // contents are equal to file_contents
   void AssertSingleFile(const stl_wrappers::KVMap& file_contents);
   void AssertLatestFile(const stl_wrappers::KVMap& file_contents);
+  // This function will assert that num_files files exist, whose contents
+  // split file_contents without overlapping
+  void AssertFiles(const stl_wrappers::KVMap& file_contents, size_t num_files);
 
  private:
   uint32_t GetAndWriteNextID(WritableFileWriter* file) const;
@@ -59,7 +59,8 @@ struct TableBuilderOptions {
       const CompressionOptions& _compression_opts,
       const std::string* _compression_dict,
       const std::string& _column_family_name,
-      const EnvOptions& _env_options)  // Shichao
+      const EnvOptions& _env_options,  // Shichao
+      int _path_id = -1)
       : ioptions(_ioptions),
         internal_comparator(_internal_comparator),
         int_tbl_prop_collector_factories(_int_tbl_prop_collector_factories),
@@ -67,7 +68,8 @@ struct TableBuilderOptions {
         compression_opts(_compression_opts),
         compression_dict(_compression_dict),
         column_family_name(_column_family_name),
-        env_options(_env_options) {}  // Shichao
+        env_options(_env_options),  // Shichao
+        path_id(_path_id) {}
   const ImmutableCFOptions& ioptions;
   const InternalKeyComparator& internal_comparator;
   const std::vector<std::unique_ptr<IntTblPropCollectorFactory>>*
@@ -78,6 +80,10 @@ struct TableBuilderOptions {
   const std::string* compression_dict;
   const std::string& column_family_name;
   const EnvOptions& env_options;  // Shichao, only used by ColumnTableBuilder
+  // Index of ImmutableCFOptions::db_paths the file is written to, or -1 if the
+  // file does not live in the db paths (e.g. SstFileWriter). Only used by
+  // ColumnTableBuilder to place the sub column files.
+  int path_id;
 };
 
 // TableBuilder provides the interface used to build a Table
@@ -121,6 +127,12 @@ class TableBuilder {
   // FileSize(), while for column equals to all column size + meta size.
   virtual uint64_t FileSizeTotal() const { return FileSize(); }  // Shichao
 
+  // Path ids of the sub files written along with the main file, one per sub
+  // column in column order. Empty if the table has no sub files.
+  virtual std::vector<uint32_t> SubFilePathIds() const {
+    return std::vector<uint32_t>();
+  }
+
   // If the user defined table properties collector suggest the file to
   // be further compacted.
   virtual bool NeedCompact() const { return false; }
@@ -155,12 +155,15 @@ const std::string TablePropertiesNames::kMergeOperator =
 const std::string TablePropertiesNames::kPropertyCollectors =
     "vidardb.property.collectors";
 const std::string TablePropertiesNames::kCompression = "vidardb.compression";
+const std::string TablePropertiesNames::kColumnStatsPrefix =
+    "vidardb.column.stats.";
 
 extern const std::string kPropertiesBlock = "vidardb.properties";
 // Old property block name for backward compatibility
 extern const std::string kPropertiesBlockOldName = "vidardb.stats";
 extern const std::string kCompressionDictBlock = "vidardb.compression_dict";
 extern const std::string kColumnBlock = "vidardb.column";  // Shichao
+extern const std::string kBitmapIndexBlock = "vidardb.bitmap.index";
 
 // Seek to the properties block.
 // Return true if it successfully seeks to the properties block.
@@ -186,4 +189,10 @@ Status SeekToColumnBlock(InternalIterator* meta_iter, bool* is_found) {
 }
 /****************************** Shichao *******************************/
 
+// Seek to the bitmap index block of a sub column file.
+// Return true if it successfully seeks to that block.
+Status SeekToBitmapIndexBlock(InternalIterator* meta_iter, bool* is_found) {
+  return SeekToMetaBlock(meta_iter, kBitmapIndexBlock, is_found);
+}
+
 }  // namespace vidardb
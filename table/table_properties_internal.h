@@ -32,4 +32,8 @@ Status SeekToCompressionDictBlock(InternalIterator* meta_iter, bool* is_found);
 // Return true if it successfully seeks to that block.
 Status SeekToColumnBlock(InternalIterator* meta_iter, bool* is_found);
 /****************************** Shichao *****************************/
+
+// Seek to the bitmap index block of a sub column file.
+// If it successfully seeks to that block, "is_found" will be set to true.
+Status SeekToBitmapIndexBlock(InternalIterator* meta_iter, bool* is_found);
 }  // namespace vidardb
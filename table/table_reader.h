@@ -9,6 +9,10 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <vector>
+
+#include "vidardb/status.h"
 
 namespace vidardb {
 
@@ -69,6 +73,13 @@ class TableReader {
   // be close to the file length.
   virtual uint64_t ApproximateOffsetOf(const Slice& key) = 0;
 
+  // Appends to keys the index keys of the data blocks in order, each of them
+  // at or after the last key of its block and before the first key of the
+  // next one. Only the index block is read.
+  virtual Status GetDataBlockIndexKeys(std::vector<std::string>* keys) {
+    return Status::NotSupported("GetDataBlockIndexKeys() not supported");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -9,6 +9,8 @@
 
 #include "table/two_level_iterator.h"
 
+#include <algorithm>
+
 #include "db/pinned_iterators_manager.h"
 #include "vidardb/options.h"
 #include "vidardb/table.h"
@@ -87,6 +89,8 @@ class TwoLevelIterator : public InternalIterator {
   void SkipEmptyDataBlocksBackward();
   void SetSecondLevelIterator(InternalIterator* iter);
   void InitDataBlock();
+  // Called when a forward scan moves to the next data block
+  void PrefetchDataBlocks();
 
   TwoLevelIteratorState* state_;
   IteratorWrapper first_level_iter_;
@@ -97,6 +101,11 @@ class TwoLevelIterator : public InternalIterator {
   // If second_level_iter is non-nullptr, then "data_block_handle_" holds the
   // "index_value" passed to block_function_ to create the second_level_iter.
   std::string data_block_handle_;
+  const size_t max_prefetch_;
+  // Number of data blocks to prefetch, doubled at every block of a scan
+  size_t prefetch_depth_;
+  // Number of data blocks after the current one already prefetched
+  size_t prefetched_;
 };
 
 TwoLevelIterator::TwoLevelIterator(TwoLevelIteratorState* state,
@@ -105,10 +114,15 @@ TwoLevelIterator::TwoLevelIterator(TwoLevelIteratorState* state,
     : state_(state),
       first_level_iter_(first_level_iter),
       need_free_iter_and_state_(need_free_iter_and_state),
-      pinned_iters_mgr_(nullptr) {}
+      pinned_iters_mgr_(nullptr),
+      max_prefetch_(state->MaxPrefetch()),
+      prefetch_depth_(0),
+      prefetched_(0) {}
 
 void TwoLevelIterator::Seek(const Slice& target) {
   first_level_iter_.Seek(target);
+  prefetch_depth_ = 0;
+  prefetched_ = 0;
 
   InitDataBlock();
   if (second_level_iter_.iter() != nullptr) {
@@ -119,6 +133,8 @@ void TwoLevelIterator::Seek(const Slice& target) {
 
 void TwoLevelIterator::SeekToFirst() {
   first_level_iter_.SeekToFirst();
+  prefetch_depth_ = 0;
+  prefetched_ = 0;
   InitDataBlock();
   if (second_level_iter_.iter() != nullptr) {
     second_level_iter_.SeekToFirst();
@@ -158,6 +174,7 @@ void TwoLevelIterator::SkipEmptyDataBlocksForward() {
       return;
     }
     first_level_iter_.Next();
+    PrefetchDataBlocks();
     InitDataBlock();
     if (second_level_iter_.iter() != nullptr) {
       second_level_iter_.SeekToFirst();
@@ -217,6 +234,38 @@ void TwoLevelIterator::InitDataBlock() {
   }
 }
 
+void TwoLevelIterator::PrefetchDataBlocks() {
+  if (max_prefetch_ == 0 || !first_level_iter_.Valid()) {
+    return;
+  }
+  prefetched_ = prefetched_ > 0 ? prefetched_ - 1 : 0;
+  prefetch_depth_ = std::min(std::max<size_t>(prefetch_depth_ * 2, 1),
+                             max_prefetch_);
+  if (prefetched_ * 2 > prefetch_depth_) {
+    return;  // refilled once half of the blocks prefetched are consumed
+  }
+
+  // The index is scanned ahead, then sought back to the current block
+  std::string current_key = first_level_iter_.key().ToString();
+  std::string current_handle = first_level_iter_.value().ToString();
+  size_t ahead = 0;
+  while (ahead < prefetch_depth_) {
+    first_level_iter_.Next();
+    if (!first_level_iter_.Valid()) {
+      break;
+    }
+    if (++ahead > prefetched_) {
+      state_->Prefetch(first_level_iter_.value());
+    }
+  }
+  prefetched_ = ahead;
+  first_level_iter_.Seek(current_key);
+  while (first_level_iter_.Valid() &&
+         first_level_iter_.value() != current_handle) {
+    first_level_iter_.Next();  // past the blocks with the same index key
+  }
+}
+
 }  // namespace
 
 InternalIterator* NewTwoLevelIterator(TwoLevelIteratorState* state,
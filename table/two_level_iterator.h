@@ -23,6 +23,13 @@ struct TwoLevelIteratorState {
 
   virtual ~TwoLevelIteratorState() {}
   virtual InternalIterator* NewSecondaryIterator(const Slice& handle) = 0;
+
+  // Number of secondary iterators whose data may be read ahead of a forward
+  // scan, 0 if none
+  virtual size_t MaxPrefetch() const { return 0; }
+
+  // Starts reading the data of handle, for a later NewSecondaryIterator()
+  virtual void Prefetch(const Slice& handle) {}
 };
 
 
@@ -765,6 +765,70 @@ TEST_F(ColumnFamilyTest, LogDeletionTest) {
   Close();
 }
 
+TEST_F(ColumnFamilyTest, AtomicFlushRecovery) {
+  // The column families written without WAL are flushed together, and all
+  // recovered from the same point of the write stream
+  db_options_.atomic_flush = true;
+  Open();
+  CreateColumnFamiliesAndReopen({"one", "two"});
+  WriteOptions wo;
+  wo.disableWAL = true;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_OK(db_->Put(wo, handles_[i], "key", "v1"));
+  }
+  // flushes every column family
+  ASSERT_OK(Flush(1));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(1, NumTableFilesAtLevel(0, i));
+    ASSERT_OK(db_->Put(wo, handles_[i], "key", "v2"));
+  }
+  ASSERT_OK(db_->Put(wo, handles_[2], "other", "v2"));
+
+  Reopen();
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(1, NumTableFilesAtLevel(0, i));
+    ASSERT_EQ("v1", Get(i, "key"));
+  }
+  ASSERT_EQ("NOT_FOUND", Get(2, "other"));
+  Close();
+}
+
+TEST_F(ColumnFamilyTest, AtomicFlushTruncatedGroup) {
+  // A crash in the middle of the atomic group in the MANIFEST drops the whole
+  // group, so that no column family sees the second flush
+  db_options_.atomic_flush = true;
+  Open();
+  CreateColumnFamiliesAndReopen({"one", "two"});
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_OK(Put(i, "key", "v1"));
+  }
+  ASSERT_OK(Flush(0));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_OK(Put(i, "key", "v2"));
+  }
+  ASSERT_OK(Flush(0));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(2, NumTableFilesAtLevel(0, i));
+  }
+
+  // the group of the second flush is the end of the MANIFEST, and its last
+  // edit is cut short
+  std::string manifest =
+      DescriptorFileName(dbname_, dbfull()->TEST_Current_Manifest_FileNo());
+  Close();
+  uint64_t size;
+  ASSERT_OK(env_->GetFileSize(manifest, &size));
+  CopyFile(manifest, manifest + ".tmp", size - 1);
+  ASSERT_OK(env_->RenameFile(manifest + ".tmp", manifest));
+
+  Open({"default", "one", "two"});
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(1, NumTableFilesAtLevel(0, i));
+    ASSERT_EQ("v1", Get(i, "key"));
+  }
+  Close();
+}
+
 // Makes sure that obsolete log files get deleted
 TEST_F(ColumnFamilyTest, DifferentWriteBufferSizes) {
   // disable flushing stale column families
@@ -0,0 +1,268 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "db/filename.h"
+#include "test/db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "vidardb/splitter.h"
+#include "vidardb/table.h"
+
+namespace vidardb {
+
+class DBBlobTest : public DBTestBase {
+ public:
+  DBBlobTest() : DBTestBase("/db_blob_test") {}
+
+  Options BlobOptions() {
+    Options options = CurrentOptions();
+    options.min_blob_size = 100;
+    options.disable_auto_compactions = true;
+    return options;
+  }
+
+  // The numbers of the blob files in path
+  std::set<uint64_t> BlobFiles(const std::string& path) {
+    std::vector<std::string> filenames;
+    env_->GetChildren(path, &filenames);
+    std::set<uint64_t> numbers;
+    uint64_t number;
+    FileType type;
+    for (const auto& f : filenames) {
+      if (ParseFileName(f, &number, &type) && type == kBlobFile) {
+        numbers.insert(number);
+      }
+    }
+    return numbers;
+  }
+
+  static std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return buf;
+  }
+
+  // Every third value stays inline in the table
+  static std::string Value(int i, int round) {
+    if (i % 3 == 0) {
+      return "small" + ToString(i) + "-" + ToString(round);
+    }
+    return std::string(200 + i % 50, static_cast<char>('a' + i % 26)) +
+           ToString(round);
+  }
+
+  void PutRound(int begin, int end, int round) {
+    for (int i = begin; i < end; i++) {
+      ASSERT_OK(Put(Key(i), Value(i, round)));
+    }
+  }
+
+  void VerifyRound(int begin, int end, int round) {
+    for (int i = begin; i < end; i++) {
+      ASSERT_EQ(Value(i, round), Get(Key(i)));
+    }
+  }
+};
+
+TEST_F(DBBlobTest, PutGetFlushAndReopen) {
+  Options options = BlobOptions();
+  DestroyAndReopen(options);
+
+  PutRound(0, 300, 0);
+  ASSERT_TRUE(BlobFiles(dbname_).empty());
+  VerifyRound(0, 300, 0);
+
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1U, BlobFiles(dbname_).size());
+  VerifyRound(0, 300, 0);
+
+  // the iterators read the blobs back too
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+    ASSERT_EQ(Key(i), iter->key().ToString());
+    ASSERT_EQ(Value(i, 0), iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(300, i);
+  iter.reset();
+
+  Reopen(options);
+  VerifyRound(0, 300, 0);
+  ASSERT_EQ(1U, BlobFiles(dbname_).size());
+
+  // small values only: no blob file
+  ASSERT_OK(Put("small", "value"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1U, BlobFiles(dbname_).size());
+  ASSERT_EQ("value", Get("small"));
+}
+
+TEST_F(DBBlobTest, ColumnTable) {
+  Options options = BlobOptions();
+  options.splitter.reset(NewPipeSplitter());
+  ColumnTableOptions table_options;
+  table_options.column_count = 3;
+  options.table_factory.reset(NewColumnTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // only the large columns are separated
+  std::vector<std::string> values;
+  for (int i = 0; i < 100; i++) {
+    values.push_back(ToString(i) + "|" + std::string(150 + i, 'x') + "|" +
+                     (i % 2 == 0 ? std::string(300, 'y') : "short"));
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1U, BlobFiles(dbname_).size());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+
+  Reopen(options);
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+    ASSERT_EQ(values[i], iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(100, i);
+}
+
+TEST_F(DBBlobTest, GarbageCollection) {
+  Options options = BlobOptions();
+  options.blob_gc_garbage_ratio = 0.3;
+  DestroyAndReopen(options);
+
+  PutRound(0, 300, 0);
+  ASSERT_OK(Flush());
+  std::set<uint64_t> first = BlobFiles(dbname_);
+  ASSERT_EQ(1U, first.size());
+
+  // overwrite two thirds of the values, then compact them away
+  PutRound(0, 200, 1);
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  // the first blob file is still referenced by the last third
+  ASSERT_EQ(1U, BlobFiles(dbname_).count(*first.begin()));
+  VerifyRound(0, 200, 1);
+  VerifyRound(200, 300, 0);
+
+  // its garbage is above the ratio, so the next compaction rewrites its
+  // live blobs and the file is deleted
+  PutRound(0, 10, 2);
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0U, BlobFiles(dbname_).count(*first.begin()));
+  VerifyRound(0, 10, 2);
+  VerifyRound(10, 200, 1);
+  VerifyRound(200, 300, 0);
+
+  Reopen(options);
+  VerifyRound(0, 10, 2);
+  VerifyRound(10, 200, 1);
+  VerifyRound(200, 300, 0);
+}
+
+TEST_F(DBBlobTest, DeleteObsoleteBlobFiles) {
+  Options options = BlobOptions();
+  DestroyAndReopen(options);
+
+  PutRound(0, 100, 0);
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1U, BlobFiles(dbname_).size());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Delete(Key(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_TRUE(BlobFiles(dbname_).empty());
+  ASSERT_EQ("NOT_FOUND", Get(Key(1)));
+}
+
+TEST_F(DBBlobTest, DbPaths) {
+  Options options = BlobOptions();
+  options.db_paths.emplace_back(dbname_, 1 << 30);
+  options.db_paths.emplace_back(dbname_ + "_2", 1 << 30);
+  options.blob_gc_garbage_ratio = 0.3;
+  DestroyAndReopen(options);
+
+  PutRound(0, 300, 0);
+  ASSERT_OK(Flush());
+  std::set<uint64_t> first = BlobFiles(dbname_);
+  ASSERT_EQ(1U, first.size());
+
+  PutRound(0, 200, 1);
+  ASSERT_OK(Flush());
+  CompactRangeOptions compact_options;
+  compact_options.target_path_id = 1;
+  ASSERT_OK(db_->CompactRange(compact_options, nullptr, nullptr));
+  ASSERT_TRUE(BlobFiles(dbname_ + "_2").empty());
+
+  // the blobs rewritten by a compaction go to the db path of its output
+  PutRound(0, 10, 2);
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(compact_options, nullptr, nullptr));
+  ASSERT_EQ(0U, BlobFiles(dbname_).count(*first.begin()));
+  ASSERT_EQ(1U, BlobFiles(dbname_ + "_2").size());
+  VerifyRound(0, 10, 2);
+  VerifyRound(10, 200, 1);
+  VerifyRound(200, 300, 0);
+
+  Reopen(options);
+  VerifyRound(0, 10, 2);
+  VerifyRound(10, 200, 1);
+  VerifyRound(200, 300, 0);
+  Close();
+  DestroyDB(dbname_, options);
+}
+
+TEST_F(DBBlobTest, RepairKeepsBlobFiles) {
+  Options options = BlobOptions();
+  DestroyAndReopen(options);
+
+  PutRound(0, 300, 0);
+  ASSERT_OK(Flush());
+  PutRound(300, 400, 0);
+  ASSERT_OK(Flush());
+  std::set<uint64_t> blob_files = BlobFiles(dbname_);
+  ASSERT_EQ(2U, blob_files.size());
+  Close();
+
+  // lose the MANIFEST
+  std::vector<std::string> filenames;
+  ASSERT_OK(env_->GetChildren(dbname_, &filenames));
+  uint64_t number;
+  FileType type;
+  for (const auto& f : filenames) {
+    if (ParseFileName(f, &number, &type) &&
+        (type == kDescriptorFile || type == kCurrentFile)) {
+      ASSERT_OK(env_->DeleteFile(dbname_ + "/" + f));
+    }
+  }
+  ASSERT_OK(RepairDB(dbname_, options));
+
+  // the repaired tables still reference their blob files, which are kept
+  Reopen(options);
+  ASSERT_EQ(blob_files, BlobFiles(dbname_));
+  VerifyRound(0, 400, 0);
+
+  PutRound(0, 100, 1);
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  VerifyRound(0, 100, 1);
+  VerifyRound(100, 400, 0);
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  vidardb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
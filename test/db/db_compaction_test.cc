@@ -1722,6 +1722,169 @@ TEST_P(DBCompactionTestWithParam, ConvertCompactionStyle) {
   ASSERT_EQ(keys_in_db, expected_keys);
 }
 
+TEST_F(DBCompactionTest, L0CompactionTriggerWithSequentialKeys) {
+  Options options = CurrentOptions();
+  options.level0_file_num_compaction_trigger = 4;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // every flush is past the keys of the previous ones, yet its file is a
+  // sorted run of its own
+  auto put_and_flush = [&](int round) {
+    for (int i = 0; i < 10; i++) {
+      ASSERT_OK(Put(Key(round * 10 + i), "v"));
+    }
+    ASSERT_OK(Flush());
+  };
+  for (int round = 0; round < 4; round++) {
+    put_and_flush(round);
+  }
+  ASSERT_EQ("4", FilesPerLevel());
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+  ASSERT_EQ(4, cfd->current()->storage_info()->l0_delay_trigger_count());
+
+  options.disable_auto_compactions = false;
+  DestroyAndReopen(options);
+  for (int round = 0; round < 4; round++) {
+    put_and_flush(round);
+  }
+  dbfull()->TEST_WaitForCompact();
+  // the trigger is reached, and the files are compacted until it is not
+  ASSERT_LT(NumTableFilesAtLevel(0), 4);
+  ASSERT_GT(NumTableFilesAtLevel(1), 0);
+  for (int i = 0; i < 40; i++) {
+    ASSERT_EQ("v", Get(Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, SubflushesMakeOneSortedRun) {
+  Options options = CurrentOptions();
+  options.max_subflushes = 4;
+  options.write_buffer_size = 64 << 20;
+  options.level0_file_num_compaction_trigger = 2;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  auto put_and_flush = [&](int round) {
+    for (int i = 0; i < 40000; i++) {
+      ASSERT_OK(Put(Key(static_cast<int>(rnd.Uniform(1000000))),
+                    RandomString(&rnd, 100) + ToString(round)));
+    }
+    ASSERT_OK(Flush());
+  };
+  put_and_flush(0);
+  // one flush split into several overlapping-free files
+  int num_files = NumTableFilesAtLevel(0);
+  ASSERT_GT(num_files, 1);
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+  ASSERT_EQ(1, cfd->current()->storage_info()->l0_delay_trigger_count());
+
+  // the run is recorded in the MANIFEST
+  Reopen(options);
+  ASSERT_EQ(num_files, NumTableFilesAtLevel(0));
+  cfd = static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+  ASSERT_EQ(1, cfd->current()->storage_info()->l0_delay_trigger_count());
+
+  put_and_flush(1);
+  ASSERT_EQ(2, cfd->current()->storage_info()->l0_delay_trigger_count());
+
+  // two runs reach the trigger, and are compacted whole
+  options.disable_auto_compactions = false;
+  Reopen(options);
+  dbfull()->TEST_WaitForCompact();
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_GT(NumTableFilesAtLevel(1), 0);
+  ASSERT_OK(Put(Key(0), "v"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+  ASSERT_EQ("v", Get(Key(0)));
+}
+
+namespace {
+class CompactionOrderListener : public EventListener {
+ public:
+  virtual void OnCompactionCompleted(DB* db,
+                                     const CompactionJobInfo& info) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cf_names_.push_back(info.cf_name);
+  }
+
+  std::vector<std::string> GetColumnFamilies() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cf_names_;
+  }
+
+ private:
+  std::vector<std::string> cf_names_;
+  std::mutex mutex_;
+};
+}  // namespace
+
+TEST_F(DBCompactionTest, CompactMostUrgentColumnFamilyFirst) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.level0_file_num_compaction_trigger = 4;
+  options.base_background_compactions = 1;
+  options.max_background_compactions = 1;
+  options.max_background_flushes = 1;
+  CompactionOrderListener* listener = new CompactionOrderListener();
+  options.listeners.emplace_back(listener);
+  CreateAndReopenWithCF({"one", "two", "three"}, options);
+  ASSERT_OK(dbfull()->SetOptions(handles_[2], {{"compaction_weight", "3"}}));
+  env_->SetBackgroundThreads(1, Env::Priority::HIGH);
+
+  // the compactions wait for all the column families to be queued
+  env_->SetBackgroundThreads(1, Env::Priority::LOW);
+  test::SleepingBackgroundTask sleeping_task;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                 Env::Priority::LOW);
+  sleeping_task.WaitUntilSleeping();
+
+  // "one" is queued first, with an urgency of 1. "two" has the same files
+  // but weighs 3. "three" has twice the trigger, which makes it urgent.
+  for (int cf = 1; cf <= 3; cf++) {
+    int files = (cf == 3) ? 8 : 4;
+    for (int i = 0; i < files; i++) {
+      ASSERT_OK(Put(cf, Key(i), "value" + ToString(i)));
+      ASSERT_OK(Put(cf, Key(100 + i), "value"));
+      ASSERT_OK(Flush(cf));
+    }
+  }
+  ASSERT_EQ(4, NumTableFilesAtLevel(0, 1));
+  ASSERT_EQ(4, NumTableFilesAtLevel(0, 2));
+  ASSERT_EQ(8, NumTableFilesAtLevel(0, 3));
+  ASSERT_TRUE(listener->GetColumnFamilies().empty());
+
+  sleeping_task.WakeUp();
+  sleeping_task.WaitUntilDone();
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  std::vector<std::string> cf_names = listener->GetColumnFamilies();
+  ASSERT_GE(cf_names.size(), 3U);
+  ASSERT_EQ("three", cf_names[0]);
+  ASSERT_EQ("two", cf_names[1]);
+  ASSERT_EQ("one", cf_names[2]);
+  for (int cf = 1; cf <= 3; cf++) {
+    ASSERT_EQ(0, NumTableFilesAtLevel(0, cf));
+  }
+
+  // the compaction time is shared among the compacted column families
+  uint64_t total = 0;
+  for (int cf = 0; cf <= 3; cf++) {
+    uint64_t share;
+    ASSERT_TRUE(dbfull()->GetIntProperty(
+        handles_[cf], DB::Properties::kCompactionTimeShare, &share));
+    if (cf == 0) {
+      ASSERT_EQ(0U, share);
+    }
+    total += share;
+  }
+  ASSERT_LE(total, 100U);
+  ASSERT_GE(total, 97U);
+}
+
 TEST_F(DBCompactionTest, L0_CompactionBug_Issue44_a) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -1148,6 +1148,95 @@ TEST_F(DBIteratorTest, ReadAhead) {
   delete iter;
 }
 
+TEST_F(DBIteratorTest, PrefetchBlocks) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.statistics = vidardb::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  std::vector<std::string> values;
+  for (int i = 0; i < 1000; i++) {
+    values.push_back(std::string(200, static_cast<char>('a' + i % 26)) +
+                     ToString(i));
+    ASSERT_OK(Put(Key(i), values.back()));
+    if (i == 499) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(Flush());
+
+  // Reopens with an empty block cache
+  auto reopen = [&]() {
+    table_options.block_cache = NewLRUCache(8 << 20);
+    options.table_factory.reset(new BlockBasedTableFactory(table_options));
+    Reopen(options);
+  };
+  // The blocks added to the block cache while reading the first n keys
+  auto blocks_added = [&](const ReadOptions& read_options, int n,
+                          uint64_t at_least) {
+    uint64_t before = TestGetTickerCount(options, BLOCK_CACHE_ADD);
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    iter->SeekToFirst();
+    for (int i = 0; i < n; i++, iter->Next()) {
+      EXPECT_TRUE(iter->Valid());
+      EXPECT_EQ(values[i], iter->value().ToString());
+    }
+    // the prefetched blocks are read in the background
+    for (int i = 0; i < 500; i++) {
+      if (TestGetTickerCount(options, BLOCK_CACHE_ADD) - before >= at_least) {
+        break;
+      }
+      env_->SleepForMicroseconds(10000);
+    }
+    return TestGetTickerCount(options, BLOCK_CACHE_ADD) - before;
+  };
+
+  reopen();
+  uint64_t plain = blocks_added(ReadOptions(), 20, 0);
+  ASSERT_GT(plain, 0U);
+  reopen();
+  ReadOptions read_options;
+  read_options.prefetch_blocks = 8;
+  ASSERT_GT(blocks_added(read_options, 20, plain + 1), plain);
+
+  // the scans with prefetching see the same rows, in both directions
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+    ASSERT_EQ(Key(i), iter->key().ToString());
+    ASSERT_EQ(values[i], iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(1000, i);
+  iter->Seek(Key(700));
+  for (i = 700; i < 800; i++, iter->Next()) {
+    ASSERT_EQ(values[i], iter->value().ToString());
+  }
+  for (i = 800; i > 400; i--, iter->Prev()) {
+    ASSERT_EQ(Key(i), iter->key().ToString());
+  }
+  ASSERT_OK(iter->status());
+  iter.reset();
+
+  // without fill_cache, the prefetched blocks stay with the iterator
+  reopen();
+  read_options.fill_cache = false;
+  uint64_t before = TestGetTickerCount(options, BLOCK_CACHE_ADD);
+  iter.reset(db_->NewIterator(read_options));
+  i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+    ASSERT_EQ(values[i], iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(1000, i);
+  iter.reset();
+  ASSERT_EQ(before, TestGetTickerCount(options, BLOCK_CACHE_ADD));
+}
+
 }  // namespace vidardb
 
 int main(int argc, char** argv) {
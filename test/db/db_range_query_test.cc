@@ -0,0 +1,359 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test/db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "util/string_util.h"
+#include "vidardb/splitter.h"
+#include "vidardb/table.h"
+
+namespace vidardb {
+
+typedef std::vector<std::pair<std::string, std::string>> KVs;
+
+class DBRangeQueryTest : public DBTestBase {
+ public:
+  DBRangeQueryTest() : DBTestBase("/db_range_query_test") {}
+
+  Options TableOptions(bool column_table,
+                       uint32_t bitmap_index_max_cardinality = 0) {
+    Options options = CurrentOptions();
+    options.disable_auto_compactions = true;
+    options.splitter.reset(NewPipeSplitter());
+    if (column_table) {
+      ColumnTableOptions table_options;
+      table_options.column_count = 3;
+      table_options.bitmap_index_max_cardinality =
+          bitmap_index_max_cardinality;
+      options.table_factory.reset(NewColumnTableFactory(table_options));
+    }
+    return options;
+  }
+
+  static std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%04d", i);
+    return buf;
+  }
+
+  static std::string Row(int i, int version = 0) {
+    return "a" + ToString(i) + "_" + ToString(version) + "|s" +
+           ToString(i % 4) + "|t" + ToString(i % 3);
+  }
+
+  // The rows of all the batches of the query, sorted by key since a batch
+  // does not return them in order
+  KVs Query(ReadOptions ro, const Range& range = Range()) {
+    KVs kvs;
+    std::list<RangeQueryKeyVal> res;
+    Status s;
+    bool next;
+    do {
+      next = db_->RangeQuery(ro, range, res, &s);
+      EXPECT_OK(s);
+      for (const auto& kv : res) {
+        kvs.emplace_back(kv.user_key, kv.user_val);
+      }
+    } while (next && s.ok());
+    std::sort(kvs.begin(), kvs.end());
+    return kvs;
+  }
+};
+
+TEST_F(DBRangeQueryTest, FilteredRowsOfBottommostColumnTable) {
+  for (size_t capacity : {0, 30, 64, 200}) {
+    DestroyAndReopen(TableOptions(true, 8));
+    for (int i = 0; i < 100; i++) {
+      ASSERT_OK(Put(Key(i), Row(i)));
+    }
+    ASSERT_OK(Flush());
+    // all the rows now have sequence number zero
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    ASSERT_EQ("0,1", FilesPerLevel());
+    ASSERT_OK(Delete(Key(9)));
+    ASSERT_OK(Delete(Key(13)));
+
+    // the rows out of the predicates are tracked as deleted ones
+    ReadOptions ro;
+    ro.batch_capacity = capacity;
+    ro.column_predicates.emplace_back(2, std::vector<std::string>{"s1"});
+    KVs expected;
+    for (int i = 1; i < 100; i += 4) {
+      if (i != 9 && i != 13) {
+        expected.emplace_back(Key(i), Row(i));
+      }
+    }
+    ASSERT_EQ(expected, Query(ro)) << capacity;
+  }
+}
+
+TEST_F(DBRangeQueryTest, BatchesOfBottommostTables) {
+  for (bool column_table : {false, true}) {
+    DestroyAndReopen(TableOptions(column_table));
+    for (int i = 0; i < 100; i++) {
+      ASSERT_OK(Put(Key(i), Row(i)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    ASSERT_EQ("0,1", FilesPerLevel());
+    // newer versions in the memtable
+    for (int i = 0; i < 100; i += 7) {
+      ASSERT_OK(Put(Key(i), Row(i, 1)));
+    }
+    ASSERT_OK(Delete(Key(50)));
+
+    KVs expected, keys, projected;
+    for (int i = 0; i < 100; i++) {
+      if (i != 50) {
+        expected.emplace_back(Key(i), Row(i, i % 7 == 0 ? 1 : 0));
+        keys.emplace_back(Key(i), "");
+        projected.emplace_back(Key(i), "t" + ToString(i % 3) + "|a" +
+                                           ToString(i) + "_" +
+                                           ToString(i % 7 == 0 ? 1 : 0));
+      }
+    }
+    for (size_t capacity : {0, 30, 64, 200, 1000}) {
+      ReadOptions ro;
+      ro.batch_capacity = capacity;
+      ASSERT_EQ(expected, Query(ro)) << column_table << " " << capacity;
+      ro.columns = {0};
+      ASSERT_EQ(keys, Query(ro)) << column_table << " " << capacity;
+      ro.columns = {3, 1};
+      ASSERT_EQ(projected, Query(ro)) << column_table << " " << capacity;
+      ro.columns.clear();
+      KVs sub(expected.begin() + 10, expected.begin() + 60);
+      ASSERT_EQ(sub, Query(ro, Range(Key(10), Key(60))))
+          << column_table << " " << capacity;
+    }
+  }
+}
+
+TEST_F(DBRangeQueryTest, InvisibleLeadingRowsOfColumnTable) {
+  for (size_t capacity : {0, 30, 200}) {
+    DestroyAndReopen(TableOptions(true));
+    for (int i = 50; i < 100; i++) {
+      ASSERT_OK(Put(Key(i), Row(i)));
+    }
+    const Snapshot* snapshot = db_->GetSnapshot();
+    // the leading rows of the file and the newer versions are invisible to
+    // the snapshot
+    for (int i = 0; i < 100; i++) {
+      ASSERT_OK(Put(Key(i), Row(i, 1)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_EQ("1", FilesPerLevel());
+
+    KVs expected, projected;
+    for (int i = 50; i < 100; i++) {
+      expected.emplace_back(Key(i), Row(i));
+      projected.emplace_back(Key(i), "s" + ToString(i % 4) + "|a" +
+                                         ToString(i) + "_0");
+    }
+    ReadOptions ro;
+    ro.batch_capacity = capacity;
+    ro.snapshot = snapshot;
+    ASSERT_EQ(expected, Query(ro)) << capacity;
+    ro.columns = {2, 1};
+    ASSERT_EQ(projected, Query(ro)) << capacity;
+    db_->ReleaseSnapshot(snapshot);
+
+    ro.snapshot = nullptr;
+    ro.columns.clear();
+    KVs latest = Query(ro);
+    ASSERT_EQ(100U, latest.size());
+    for (int i = 0; i < 100; i++) {
+      ASSERT_EQ(Row(i, 1), latest[i].second);
+    }
+  }
+}
+
+TEST_F(DBRangeQueryTest, ColumnPredicates) {
+  // row table, column table, column table with bitmap indexes
+  for (int table = 0; table < 3; table++) {
+    DestroyAndReopen(TableOptions(table > 0, table == 2 ? 8 : 0));
+    std::map<std::string, std::string> model;
+    auto put = [&](int i, const std::string& row) {
+      ASSERT_OK(Put(Key(i), row));
+      model[Key(i)] = row;
+    };
+    for (int i = 0; i < 60; i++) {
+      put(i, Row(i));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    for (int i = 60; i < 100; i++) {
+      put(i, Row(i));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_EQ("1,1", FilesPerLevel());
+    for (int i = 100; i < 120; i++) {
+      put(i, Row(i));
+    }
+    put(5, "x|s9|t2");
+    put(65, "y|s1|t0");
+    ASSERT_OK(Delete(Key(1)));
+    model.erase(Key(1));
+
+    std::vector<std::vector<ColumnPredicate>> predicate_sets = {
+        {ColumnPredicate(2, {"s1"})},
+        {ColumnPredicate(2, {"s1", "s2"})},
+        {ColumnPredicate(2, {"s1", "s2"}), ColumnPredicate(3, {"t0"})},
+        {ColumnPredicate(2, {"s9"})},
+        {ColumnPredicate(2, {"zz"})},
+        {ColumnPredicate(3, {"t2"}), ColumnPredicate(2, {"s9", "s3"})},
+    };
+    std::vector<std::vector<uint32_t>> column_sets = {
+        {}, {0}, {1}, {3, 2}, {2}};
+    for (const auto& predicates : predicate_sets) {
+      for (const auto& columns : column_sets) {
+        KVs expected;
+        for (const auto& kv : model) {
+          std::vector<std::string> vals = StringSplit(kv.second, '|');
+          bool match = true;
+          for (const auto& predicate : predicates) {
+            const auto& values = predicate.values;
+            match = match && std::find(values.begin(), values.end(),
+                                       vals[predicate.column - 1]) !=
+                                 values.end();
+          }
+          if (!match) {
+            continue;
+          }
+          std::string val;
+          if (columns.empty()) {
+            val = kv.second;
+          }
+          for (auto column : columns) {
+            if (column > 0) {
+              val += (val.empty() ? "" : "|") + vals[column - 1];
+            }
+          }
+          expected.emplace_back(kv.first, val);
+        }
+
+        for (size_t capacity : {0, 64}) {
+          ReadOptions ro;
+          ro.batch_capacity = capacity;
+          ro.columns = columns;
+          ro.column_predicates = predicates;
+          ASSERT_EQ(expected, Query(ro))
+              << table << " " << predicates.size() << " " << columns.size()
+              << " " << capacity;
+          // the requested columns are left as they were
+          ASSERT_EQ(columns, ro.columns);
+        }
+      }
+    }
+
+    ReadOptions ro;
+    ro.column_predicates.emplace_back(0, std::vector<std::string>{"key0001"});
+    std::list<RangeQueryKeyVal> res;
+    Status s;
+    ASSERT_FALSE(db_->RangeQuery(ro, Range(), res, &s));
+    ASSERT_TRUE(s.IsInvalidArgument());
+  }
+
+  // the predicates need a splitter
+  Options options = CurrentOptions();
+  options.splitter.reset();
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("a", "b"));
+  ReadOptions ro;
+  ro.column_predicates.emplace_back(1, std::vector<std::string>{"b"});
+  std::list<RangeQueryKeyVal> res;
+  Status s;
+  ASSERT_FALSE(db_->RangeQuery(ro, Range(), res, &s));
+  ASSERT_TRUE(s.IsInvalidArgument());
+}
+
+TEST_F(DBRangeQueryTest, SampleRange) {
+  Options options = TableOptions(false);
+  options.write_buffer_size = 1 << 20;
+  DestroyAndReopen(options);
+  // only in the memtable
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), Row(i)));
+  }
+  std::list<RangeQueryKeyVal> res;
+  ASSERT_OK(db_->SampleRange(ReadOptions(), Range(), 50, res));
+  ASSERT_EQ(50U, res.size());
+  std::string prev;
+  for (const auto& kv : res) {
+    ASSERT_LT(prev, kv.user_key);
+    int i = atoi(kv.user_key.c_str() + 3);
+    ASSERT_EQ(Row(i), kv.user_val);
+    prev = kv.user_key;
+  }
+
+  // more than the rows of the range
+  res.clear();
+  ASSERT_OK(db_->SampleRange(ReadOptions(), Range(Key(10), Key(19)), 50, res));
+  ASSERT_EQ(10U, res.size());
+  ASSERT_EQ(Key(10), res.front().user_key);
+  ASSERT_EQ(Key(19), res.back().user_key);
+
+  ReadOptions ro;
+  ro.columns = {3};
+  res.clear();
+  ASSERT_OK(db_->SampleRange(ro, Range(Key(10), Key(19)), 50, res));
+  ASSERT_EQ(10U, res.size());
+  ASSERT_EQ("t" + ToString(10 % 3), res.front().user_val);
+}
+
+TEST_F(DBRangeQueryTest, SampleRangeWeighsMemTables) {
+  Options options = TableOptions(false);
+  options.write_buffer_size = 4 << 20;
+  DestroyAndReopen(options);
+  for (int i = 0; i < 2000; i++) {
+    ASSERT_OK(Put(Key(i), Row(i)));
+  }
+  ASSERT_OK(Flush());
+  // as many rows only in the memtable, after and within the ones of the file
+  for (int i = 2000; i < 4000; i++) {
+    ASSERT_OK(Put(Key(i), Row(i)));
+  }
+  for (int i = 0; i < 2000; i += 2) {
+    ASSERT_OK(Put(Key(i), Row(i, 1)));
+  }
+  ASSERT_EQ("1", FilesPerLevel());
+
+  std::string start = Key(1000), limit = Key(2999);
+  for (const Range& range : {Range(), Range(start, limit)}) {
+    size_t mem_rows = 0, total = 0;
+    for (int round = 0; round < 10; round++) {
+      std::list<RangeQueryKeyVal> res;
+      ASSERT_OK(db_->SampleRange(ReadOptions(), range, 100, res));
+      ASSERT_EQ(100U, res.size());
+      for (const auto& kv : res) {
+        int i = atoi(kv.user_key.c_str() + 3);
+        ASSERT_EQ(Row(i, i < 2000 && i % 2 == 0 ? 1 : 0), kv.user_val);
+        if (range.start.compare(kRangeQueryMin) != 0) {
+          ASSERT_GE(i, 1000);
+          ASSERT_LE(i, 2999);
+        }
+        mem_rows += i >= 2000 ? 1 : 0;
+        total++;
+      }
+    }
+    // half of the rows are only in the memtable
+    ASSERT_GT(mem_rows, total / 4);
+    ASSERT_LT(mem_rows, total * 3 / 4);
+  }
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  vidardb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
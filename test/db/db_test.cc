@@ -12,6 +12,7 @@
 // which is a pity, it is a good test
 #include <fcntl.h>
 #include <algorithm>
+#include <list>
 #include <set>
 #include <thread>
 #include <unordered_set>
@@ -39,6 +40,7 @@
 #include "vidardb/perf_context.h"
 #include "vidardb/slice.h"
 #include "vidardb/snapshot.h"
+#include "vidardb/splitter.h"
 #include "vidardb/table.h"
 #include "vidardb/table_properties.h"
 #include "vidardb/thread_status.h"
@@ -270,6 +272,52 @@ TEST_F(DBTest, DISABLED_VeryLargeValue) {
   ASSERT_EQ('w', value[0]);
 }
 
+TEST_F(DBTest, PutColumnsGetColumns) {
+  for (bool column_table : {false, true}) {
+    Options options = CurrentOptions();
+    options.splitter.reset(NewPipeSplitter());
+    if (column_table) {
+      ColumnTableOptions table_options;
+      table_options.column_count = 3;
+      options.table_factory.reset(NewColumnTableFactory(table_options));
+    }
+    DestroyAndReopen(options);
+
+    std::vector<Slice> columns = {"a", "", "c"};
+    ASSERT_OK(db_->PutColumns(WriteOptions(), "k1", columns));
+    ASSERT_OK(Put("k2", "x||z"));
+    for (int flush = 0; flush < 2; flush++) {
+      ASSERT_EQ("a||c", Get("k1"));
+      std::vector<std::string> values;
+      ASSERT_OK(db_->GetColumns(ReadOptions(), "k1", {}, &values));
+      ASSERT_EQ(std::vector<std::string>({"a", "", "c"}), values);
+      ASSERT_OK(db_->GetColumns(ReadOptions(), "k1", {3, 1}, &values));
+      ASSERT_EQ(std::vector<std::string>({"c", "a"}), values);
+      ASSERT_OK(db_->GetColumns(ReadOptions(), "k2", {2, 3}, &values));
+      ASSERT_EQ(std::vector<std::string>({"", "z"}), values);
+      ASSERT_TRUE(db_->GetColumns(ReadOptions(), "k3", {1}, &values)
+                      .IsNotFound());
+
+      // the columns start from 1, up to the ones of the value
+      ASSERT_TRUE(db_->GetColumns(ReadOptions(), "k1", {0}, &values)
+                      .IsInvalidArgument());
+      ASSERT_TRUE(db_->GetColumns(ReadOptions(), "k1", {1, 4}, &values)
+                      .IsInvalidArgument());
+      ASSERT_TRUE(values.empty());
+      ASSERT_OK(Flush());
+    }
+  }
+
+  // both need a splitter
+  DestroyAndReopen(CurrentOptions());
+  ASSERT_TRUE(db_->PutColumns(WriteOptions(), "k", {"a", "b"})
+                  .IsInvalidArgument());
+  ASSERT_OK(Put("k", "a|b"));
+  std::vector<std::string> values;
+  ASSERT_TRUE(
+      db_->GetColumns(ReadOptions(), "k", {1}, &values).IsInvalidArgument());
+}
+
 TEST_F(DBTest, GetFromImmutableLayer) {
   do {
     Options options = CurrentOptions();
@@ -323,6 +371,175 @@ TEST_F(DBTest, GetSnapshot) {
 }
 #endif  // VIDARDB_LITE
 
+TEST_F(DBTest, InPlaceUpdateSnapshots) {
+  Options options = CurrentOptions();
+  options.inplace_update_support = true;
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("k", "value1"));
+  // a snapshot would see the values updated after it
+  ASSERT_TRUE(db_->GetSnapshot() == nullptr);
+  ASSERT_OK(Put("k", "v2"));
+  ASSERT_EQ("v2", Get("k"));
+  ASSERT_OK(Put("k", "value3-longer"));
+  ASSERT_EQ("value3-longer", Get("k"));
+  Reopen(options);
+  ASSERT_EQ("value3-longer", Get("k"));
+  ASSERT_TRUE(db_->GetSnapshot() == nullptr);
+
+  options.inplace_update_support = false;
+  Reopen(options);
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_TRUE(snapshot != nullptr);
+  ASSERT_OK(Put("k", "v4"));
+  ASSERT_EQ("value3-longer", Get("k", snapshot));
+  ASSERT_EQ("v4", Get("k"));
+  db_->ReleaseSnapshot(snapshot);
+
+  // so does a column family with in-place updates, until it is dropped
+  Options inplace_options = options;
+  inplace_options.inplace_update_support = true;
+  CreateColumnFamilies({"inplace"}, inplace_options);
+  ASSERT_TRUE(db_->GetSnapshot() == nullptr);
+  ASSERT_OK(db_->DropColumnFamily(handles_[0]));
+  snapshot = db_->GetSnapshot();
+  ASSERT_TRUE(snapshot != nullptr);
+  db_->ReleaseSnapshot(snapshot);
+}
+
+TEST_F(DBTest, GetAsync) {
+  Options options = CurrentOptions();
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("k1", "v1"));
+  ASSERT_OK(Put("k2", "v2"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("k3", "v3"));
+
+  // the memtable hits complete on the calling thread
+  bool called = false;
+  db_->GetAsync(ReadOptions(), "k3",
+                [&called](const Status& s, std::string&& value) {
+                  ASSERT_OK(s);
+                  ASSERT_EQ("v3", value);
+                  called = true;
+                });
+  ASSERT_TRUE(called);
+  // a miss may need the table, and complete on the executor
+  auto result = db_->GetAsync(ReadOptions(), db_->DefaultColumnFamily(), "k0");
+  ASSERT_TRUE(result.get().first.IsNotFound());
+
+  // a table not open yet needs I/O, so the read goes to the executor
+  Reopen(options);
+  ReadOptions no_io;
+  no_io.read_tier = kBlockCacheTier;
+  called = false;
+  db_->GetAsync(no_io, "k1", [&called](const Status& s, std::string&& value) {
+    ASSERT_TRUE(s.IsIncomplete());
+    called = true;
+  });
+  ASSERT_TRUE(called);
+  result = db_->GetAsync(ReadOptions(), db_->DefaultColumnFamily(), "k1");
+  ASSERT_OK(result.get().first);
+  result = db_->GetAsync(ReadOptions(), db_->DefaultColumnFamily(), "k2");
+  std::pair<Status, std::string> value = result.get();
+  ASSERT_OK(value.first);
+  ASSERT_EQ("v2", value.second);
+  result = db_->GetAsync(ReadOptions(), db_->DefaultColumnFamily(), "k4");
+  ASSERT_TRUE(result.get().first.IsNotFound());
+}
+
+TEST_F(DBTest, RangeQueryAsync) {
+  Options options = CurrentOptions();
+  DestroyAndReopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "v" + Key(i)));
+    if (i == 50) {
+      ASSERT_OK(Flush());
+    }
+  }
+
+  ReadOptions ro;
+  ro.batch_capacity = 100;
+  std::list<RangeQueryKeyVal> res;
+  std::vector<std::string> keys;
+  std::string start = Key(10), limit = Key(89);
+  bool next;
+  do {
+    auto result =
+        db_->RangeQueryAsync(ro, db_->DefaultColumnFamily(),
+                             Range(start, limit), res);
+    std::pair<Status, bool> outcome = result.get();
+    ASSERT_OK(outcome.first);
+    next = outcome.second;
+    for (const auto& kv : res) {
+      ASSERT_EQ("v" + kv.user_key, kv.user_val);
+      keys.push_back(kv.user_key);
+    }
+  } while (next);
+  std::sort(keys.begin(), keys.end());
+  ASSERT_EQ(80U, keys.size());
+  ASSERT_EQ(Key(10), keys.front());
+  ASSERT_EQ(Key(89), keys.back());
+}
+
+TEST_F(DBTest, AsyncReadsDuringShutdown) {
+  Options options = CurrentOptions();
+  options.async_read_threads = 1;
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("k1", "v1"));
+  ASSERT_OK(Flush());
+
+  // the only reader thread is held by the callback of a first query
+  port::Mutex mu;
+  port::CondVar cv(&mu);
+  bool started = false;
+  bool release = false;
+  ReadOptions first_options;
+  std::list<RangeQueryKeyVal> first_res;
+  db_->RangeQueryAsync(first_options, Range(), first_res,
+                       [&](const Status& s, bool next) {
+                         ASSERT_OK(s);
+                         MutexLock l(&mu);
+                         started = true;
+                         cv.SignalAll();
+                         while (!release) {
+                           cv.Wait();
+                         }
+                       });
+  {
+    MutexLock l(&mu);
+    while (!started) {
+      cv.Wait();
+    }
+  }
+
+  // the reads queued behind it fail when the DB closes, the running one is
+  // waited for
+  const int kQueued = 3;
+  std::atomic<int> shutdown(0);
+  std::vector<ReadOptions> read_options(kQueued);
+  std::vector<std::list<RangeQueryKeyVal>> results(kQueued);
+  for (int i = 0; i < kQueued; i++) {
+    db_->RangeQueryAsync(read_options[i], Range(), results[i],
+                         [&shutdown](const Status& s, bool next) {
+                           ASSERT_TRUE(s.IsShutdownInProgress());
+                           ASSERT_FALSE(next);
+                           shutdown++;
+                         });
+  }
+  std::thread closer([this]() { Close(); });
+  while (shutdown.load() < kQueued) {
+    env_->SleepForMicroseconds(1000);
+  }
+  {
+    MutexLock l(&mu);
+    release = true;
+    cv.SignalAll();
+  }
+  closer.join();
+  ASSERT_EQ(kQueued, shutdown.load());
+  ASSERT_EQ(1U, first_res.size());
+}
+
 TEST_F(DBTest, GetLevel0Ordering) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -977,6 +977,73 @@ TEST_F(DBTest2, FirstSnapshotTest) {
 }
 
 #ifndef VIDARDB_LITE
+TEST_F(DBTest2, ParallelFollowersSequence) {
+  Options options = CurrentOptions();
+  options.allow_concurrent_memtable_write = true;
+  DestroyAndReopen(options);
+
+  // The leader waits for all the writers to join its group, which then
+  // writes to the memtable in parallel
+  const int kNumWriters = 4;
+  const int kBatchSize = 3;
+  std::atomic<int> joined(0);
+  std::atomic<int> parallel_followers(0);
+  vidardb::SyncPoint::GetInstance()->SetCallBack(
+      "WriteThread::JoinBatchGroup:Wait", [&](void* arg) {
+        auto* w = reinterpret_cast<WriteThread::Writer*>(arg);
+        joined.fetch_add(1);
+        if (w->link_older == nullptr) {
+          while (joined.load() < kNumWriters) {
+            env_->SleepForMicroseconds(1000);
+          }
+        }
+      });
+  vidardb::SyncPoint::GetInstance()->SetCallBack(
+      "WriteThread::JoinBatchGroup:DoneWaiting", [&](void* arg) {
+        auto* w = reinterpret_cast<WriteThread::Writer*>(arg);
+        if (w->state == WriteThread::STATE_PARALLEL_FOLLOWER) {
+          parallel_followers.fetch_add(1);
+        }
+      });
+  vidardb::SyncPoint::GetInstance()->EnableProcessing();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumWriters; i++) {
+    threads.emplace_back([&, i]() {
+      WriteBatch batch;
+      for (int j = 0; j < kBatchSize; j++) {
+        batch.Put("w" + ToString(i) + "_" + ToString(j), "value");
+      }
+      ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  vidardb::SyncPoint::GetInstance()->DisableProcessing();
+  vidardb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(kNumWriters - 1, parallel_followers.load());
+
+  // Each entry of the group has a sequence number of its own
+  const int kNumEntries = kNumWriters * kBatchSize;
+  ASSERT_EQ(static_cast<SequenceNumber>(kNumEntries),
+            dbfull()->GetLatestSequenceNumber());
+  std::vector<bool> seen(kNumEntries + 1, false);
+  int count = 0;
+  Arena arena;
+  ScopedArenaIterator iter(dbfull()->NewInternalIterator(&arena));
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ParsedInternalKey ikey;
+    ASSERT_TRUE(ParseInternalKey(iter->key(), &ikey));
+    ASSERT_GE(ikey.sequence, 1U);
+    ASSERT_LE(ikey.sequence, static_cast<SequenceNumber>(kNumEntries));
+    ASSERT_FALSE(seen[ikey.sequence]);
+    seen[ikey.sequence] = true;
+    count++;
+  }
+  ASSERT_EQ(kNumEntries, count);
+}
+
 static void UniqueIdCallback(void* arg) {
   int* result = reinterpret_cast<int*>(arg);
   if (*result == -1) {
@@ -245,6 +245,8 @@ class SpecialEnv : public EnvWrapper {
       Env::IOPriority GetIOPriority() override {
         return base_->GetIOPriority();
       }
+      // the column tables name their sub column files after it
+      std::string GetFileName() override { return base_->GetFileName(); }
     };
     class ManifestFile : public WritableFile {
      public:
@@ -38,6 +38,7 @@ TEST_F(FileNameTest, Parse) {
         {"100.log", 100, kLogFile, kAllMode},
         {"0.log", 0, kLogFile, kAllMode},
         {"0.sst", 0, kTableFile, kAllMode},
+        {"18.blob", 18, kBlobFile, kAllMode},
         {"CURRENT", 0, kCurrentFile, kAllMode},
         {"LOCK", 0, kDBLockFile, kAllMode},
         {"MANIFEST-2", 2, kDescriptorFile, kAllMode},
@@ -153,6 +154,14 @@ TEST_F(FileNameTest, Construction) {
   ASSERT_EQ(200U, number);
   ASSERT_EQ(kTableFile, type);
 
+  fname = BlobFileName({DbPath("bar", 0), DbPath("foo", 0)}, 300, 0);
+  ASSERT_EQ("bar/", std::string(fname.data(), 4));
+  ASSERT_TRUE(ParseFileName(fname.c_str() + 4, &number, &type));
+  ASSERT_EQ(300U, number);
+  ASSERT_EQ(kBlobFile, type);
+  fname = BlobFileName({DbPath("bar", 0), DbPath("foo", 0)}, 300, 1);
+  ASSERT_EQ("foo/", std::string(fname.data(), 4));
+
   fname = DescriptorFileName("bar", 100);
   ASSERT_EQ("bar/", std::string(fname.data(), 4));
   ASSERT_TRUE(ParseFileName(fname.c_str() + 4, &number, &type));
@@ -13,6 +13,7 @@
 #include "db/writebuffer.h"
 #include "vidardb/cache.h"
 #include "util/file_reader_writer.h"
+#include "util/random.h"
 #include "util/string_util.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
@@ -204,6 +205,72 @@ TEST_F(FlushJobTest, Snapshots) {
   job_context.Clean();
 }
 
+TEST_F(FlushJobTest, Subflushes) {
+  db_options_.max_subflushes = 4;
+  JobContext job_context(0);
+  auto cfd = versions_->GetColumnFamilySet()->GetDefault();
+  auto new_mem = cfd->ConstructNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                                           kMaxSequenceNumber);
+  new_mem->Ref();
+  auto inserted_keys = mock::MakeMockFile();
+  // enough for four subflushes of at least 1MB, in random order
+  Random rnd(301);
+  std::vector<int> order;
+  for (int i = 0; i < 50000; ++i) {
+    order.push_back(i);
+  }
+  std::random_shuffle(order.begin(), order.end());
+  SequenceNumber seqno = 0;
+  for (int i : order) {
+    char key[16];
+    snprintf(key, sizeof(key), "%08d", i);
+    std::string value(test::RandomHumanReadableString(&rnd, 100));
+    new_mem->Add(++seqno, kTypeValue, key, value);
+    InternalKey internal_key(key, seqno, kTypeValue);
+    inserted_keys.insert({internal_key.Encode().ToString(), value});
+  }
+  ASSERT_GE(new_mem->ApproximateMemoryUsage(), 4U << 20);
+
+  std::vector<MemTable*> to_delete;
+  cfd->imm()->Add(new_mem, &to_delete);
+  for (auto& m : to_delete) {
+    delete m;
+  }
+
+  EventLogger event_logger(db_options_.info_log.get());
+  FlushJob flush_job(dbname_, versions_->GetColumnFamilySet()->GetDefault(),
+                     db_options_, *cfd->GetLatestMutableCFOptions(),
+                     env_options_, versions_.get(), &mutex_, &shutting_down_,
+                     {}, kMaxSequenceNumber, &job_context, nullptr, nullptr,
+                     nullptr, kNoCompression, nullptr, &event_logger, true);
+  FileMetaData fd;
+  mutex_.Lock();
+  ASSERT_OK(flush_job.Run(&fd));
+  mutex_.Unlock();
+  ASSERT_EQ(3U, flush_job.GetSubflushOutputs().size());
+  mock_table_factory_->AssertFiles(inserted_keys, 4);
+
+  // the files cover the key range in order, as a single sorted run
+  std::vector<FileMetaData> outputs(1, fd);
+  for (const auto& output : flush_job.GetSubflushOutputs()) {
+    outputs.push_back(output.meta);
+  }
+  ASSERT_EQ("00000000", outputs.front().smallest.user_key().ToString());
+  ASSERT_EQ("00049999", outputs.back().largest.user_key().ToString());
+  for (size_t i = 1; i < outputs.size(); i++) {
+    ASSERT_LT(outputs[i - 1].largest.user_key().ToString(),
+              outputs[i].smallest.user_key().ToString());
+  }
+  VersionStorageInfo* vstorage = cfd->current()->storage_info();
+  ASSERT_EQ(4, vstorage->NumLevelFiles(0));
+  for (auto f : vstorage->LevelFiles(0)) {
+    ASSERT_EQ(fd.fd.GetNumber(), f->flush_id);
+  }
+  std::vector<int> runs;
+  ASSERT_EQ(1, vstorage->Level0SortedRuns(&runs));
+  job_context.Clean();
+}
+
 }  // namespace vidardb
 
 int main(int argc, char** argv) {
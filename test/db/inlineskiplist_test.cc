@@ -9,6 +9,7 @@
 
 #include "memtable/inlineskiplist.h"
 #include <set>
+#include <thread>
 #include "vidardb/env.h"
 #include "util/concurrent_arena.h"
 #include "util/hash.h"
@@ -337,6 +338,57 @@ TEST_F(InlineSkipTest, ConcurrentInsertWithoutThreads) {
   }
 }
 
+static void SpliceWriter(InlineSkipList<TestComparator>* list, int thread,
+                         int num_threads, int n) {
+  void* splice = list->AllocateSplice();
+  Random rnd(301 + thread);
+  for (int i = 0; i < n; i++) {
+    // mostly ascending, interleaved with the other writers, with some keys
+    // out of order
+    Key key = (rnd.OneIn(10) ? rnd.Uniform(n) : i) * num_threads + thread;
+    key = key * 2 + (rnd.OneIn(10) ? 1 : 0);
+    char* buf = list->AllocateKey(sizeof(Key));
+    memcpy(buf, &key, sizeof(Key));
+    if (list->Contains(buf)) {
+      continue;
+    }
+    list->InsertConcurrently(buf, splice);
+  }
+}
+
+TEST_F(InlineSkipTest, ConcurrentInsertWithSplice) {
+  const int kThreads = 4;
+  const int N = 20000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  InlineSkipList<TestComparator> list(cmp, &arena);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back(SpliceWriter, &list, t, kThreads, N);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // Each writer owns the keys of its residue, so the list holds exactly
+  // the keys every writer would insert alone.
+  std::set<Key> keys;
+  for (int t = 0; t < kThreads; t++) {
+    Random rnd(301 + t);
+    for (int i = 0; i < N; i++) {
+      Key key = (rnd.OneIn(10) ? rnd.Uniform(N) : i) * kThreads + t;
+      keys.insert(key * 2 + (rnd.OneIn(10) ? 1 : 0));
+    }
+  }
+  InlineSkipList<TestComparator>::Iterator iter(&list);
+  auto model_iter = keys.begin();
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next(), ++model_iter) {
+    ASSERT_TRUE(model_iter != keys.end());
+    ASSERT_EQ(*model_iter, Decode(iter.key()));
+  }
+  ASSERT_TRUE(model_iter == keys.end());
+}
+
 class TestState {
  public:
   ConcurrentTest t_;
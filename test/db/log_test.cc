@@ -296,6 +296,36 @@ class LogTest : public ::testing::TestWithParam<int> {
     ASSERT_EQ((char)('a' + expected_record_offset), record.data()[0]);
   }
 
+  // The contents of a log of its own with the records, checksummed with
+  // checksum
+  std::string WriteLog(ChecksumType checksum,
+                       const std::vector<std::string>& records) {
+    test::StringSink* sink = new test::StringSink();
+    Writer writer(unique_ptr<WritableFileWriter>(
+                      test::GetWritableFileWriter(sink)),
+                  123, GetParam(), checksum);
+    for (const auto& record : records) {
+      EXPECT_OK(writer.AddRecord(Slice(record)));
+    }
+    return sink->contents_;
+  }
+
+  // The records read back from the contents of a log
+  std::vector<std::string> ReadLog(const std::string& contents) {
+    Slice source(contents);
+    Reader reader(NULL,
+                  unique_ptr<SequentialFileReader>(
+                      test::GetSequentialFileReader(new StringSource(source))),
+                  &report_, true /*checksum*/, 0 /*initial_offset*/, 123);
+    std::vector<std::string> records;
+    Slice record;
+    std::string scratch;
+    while (reader.ReadRecord(&record, &scratch)) {
+      records.push_back(record.ToString());
+    }
+    return records;
+  }
+
 };
 
 size_t LogTest::initial_offset_record_sizes_[] =
@@ -728,6 +758,74 @@ TEST_P(LogTest, Recycle) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, ChecksumTypes) {
+  int header_size = GetParam() ? kRecyclableHeaderSize : kHeaderSize;
+  std::vector<std::string> records = {"foo", BigString("bar", 3 * kBlockSize),
+                                      "", "baz"};
+  for (ChecksumType checksum : {kCRC32c, kxxHash64, kXXH3}) {
+    size_t dropped = DroppedBytes();
+    std::string contents = WriteLog(checksum, records);
+    // the checksum type is in the high bits of the record type
+    ASSERT_EQ(static_cast<int>(checksum),
+              static_cast<unsigned char>(contents[6]) >> kRecordTypeBits);
+    ASSERT_EQ(records, ReadLog(contents));
+    ASSERT_EQ(dropped, DroppedBytes());
+
+    // a byte of the payload of the last record changed
+    std::string corrupted = contents;
+    corrupted[corrupted.size() - 1] ^= 1;
+    ASSERT_EQ(std::vector<std::string>(records.begin(), records.end() - 1),
+              ReadLog(corrupted));
+
+    // the checksum type of the last record changed, to another one or to an
+    // unknown one
+    for (int other = 0; other < 16; other++) {
+      if (other == checksum) {
+        continue;
+      }
+      corrupted = contents;
+      size_t type_offset = corrupted.size() - 3 - header_size + 6;
+      corrupted[type_offset] = static_cast<char>(
+          (corrupted[type_offset] & kRecordTypeMask) |
+          (other << kRecordTypeBits));
+      ASSERT_EQ(std::vector<std::string>(records.begin(), records.end() - 1),
+                ReadLog(corrupted));
+    }
+  }
+  if (!GetParam()) {
+    ASSERT_GT(DroppedBytes(), 0U);
+    ASSERT_EQ("OK", MatchError("checksum mismatch"));
+  } else {
+    // a bad record ends a recycled log
+    ASSERT_EQ(0U, DroppedBytes());
+  }
+}
+
+TEST_P(LogTest, LegacyCRC32cRecords) {
+  if (GetParam()) {
+    return;  // the header below is the one of the plain records
+  }
+  // the records written before the checksum types, with a crc32c of the type
+  // and the payload, and a type byte holding the record type alone
+  std::string contents;
+  for (const std::string& payload : {"foo", "", "barbaz"}) {
+    char header[kHeaderSize];
+    header[4] = static_cast<char>(payload.size() & 0xff);
+    header[5] = static_cast<char>(payload.size() >> 8);
+    header[6] = static_cast<char>(kFullType);
+    uint32_t crc = crc32c::Value(header + 6, 1);
+    crc = crc32c::Extend(crc, payload.data(), payload.size());
+    EncodeFixed32(header, crc32c::Mask(crc));
+    contents.append(header, kHeaderSize);
+    contents.append(payload);
+  }
+  ASSERT_EQ(std::vector<std::string>({"foo", "", "barbaz"}), ReadLog(contents));
+  ASSERT_EQ(0U, DroppedBytes());
+
+  // and the new crc32c records are written the same way
+  ASSERT_EQ(contents, WriteLog(kCRC32c, {"foo", "", "barbaz"}));
+}
+
 INSTANTIATE_TEST_CASE_P(bool, LogTest, ::testing::Values(0, 2));
 
 }  // namespace log
@@ -4,6 +4,8 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include <algorithm>
+#include <atomic>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,7 @@
 #include "vidardb/db.h"
 #include "vidardb/transaction_log.h"
 #include "util/file_util.h"
+#include "util/sync_point.h"
 
 namespace vidardb {
 
@@ -32,6 +35,66 @@ class RepairTest : public DBTestBase {
         });
     return sst_iter == files.end() ? "" : dbname_ + *sst_iter;
   }
+
+  // The metadata of the table files of the default column family, by number
+  std::map<uint64_t, FileMetaData> GetTables() {
+    std::vector<std::vector<FileMetaData>> levels;
+    dbfull()->TEST_GetFilesMetaData(db_->DefaultColumnFamily(), &levels);
+    std::map<uint64_t, FileMetaData> tables;
+    for (const auto& level : levels) {
+      for (const auto& f : level) {
+        tables[f.fd.GetNumber()] = f;
+      }
+    }
+    return tables;
+  }
+
+  // Deletes the manifest and repairs the DB, counting the tables whose
+  // metadata the Repairer read from their properties and those it scanned
+  void RepairWithoutManifest(const Options& options, int* from_properties,
+                             int* scanned) {
+    std::string manifest_path =
+        DescriptorFileName(dbname_, dbfull()->TEST_Current_Manifest_FileNo());
+    Close();
+    ASSERT_OK(env_->DeleteFile(manifest_path));
+
+    std::atomic<int> num_from_properties(0);
+    std::atomic<int> num_scanned(0);
+    vidardb::SyncPoint::GetInstance()->SetCallBack(
+        "Repairer::ScanTable:FromProperties", [&](void* arg) {
+          if (*reinterpret_cast<bool*>(arg)) {
+            num_from_properties++;
+          } else {
+            num_scanned++;
+          }
+        });
+    vidardb::SyncPoint::GetInstance()->EnableProcessing();
+    ASSERT_OK(RepairDB(dbname_, options));
+    vidardb::SyncPoint::GetInstance()->DisableProcessing();
+    vidardb::SyncPoint::GetInstance()->ClearAllCallBacks();
+    *from_properties = num_from_properties;
+    *scanned = num_scanned;
+    Reopen(options);
+  }
+
+  // The repaired tables have the key and sequence number ranges and the size
+  // of the tables before
+  static void AssertSameTables(const std::map<uint64_t, FileMetaData>& before,
+                               const std::map<uint64_t, FileMetaData>& after) {
+    ASSERT_EQ(before.size(), after.size());
+    for (const auto& t : before) {
+      auto it = after.find(t.first);
+      ASSERT_TRUE(it != after.end());
+      const FileMetaData& f = it->second;
+      ASSERT_EQ(t.second.smallest.Encode(), f.smallest.Encode());
+      ASSERT_EQ(t.second.largest.Encode(), f.largest.Encode());
+      ASSERT_EQ(t.second.smallest_seqno, f.smallest_seqno);
+      ASSERT_EQ(t.second.largest_seqno, f.largest_seqno);
+      ASSERT_EQ(t.second.fd.GetFileSize(), f.fd.GetFileSize());
+      ASSERT_EQ(t.second.fd.GetFileSizeTotal(), f.fd.GetFileSizeTotal());
+      ASSERT_EQ(t.second.sub_path_ids, f.sub_path_ids);
+    }
+  }
 };
 
 TEST_F(RepairTest, LostManifest) {
@@ -169,6 +232,162 @@ TEST_F(RepairTest, UnflushedSst) {
   ASSERT_EQ(Get("key"), "val");
 }
 
+TEST_F(RepairTest, MetadataFromProperties) {
+  // The properties of the tables record their sequence numbers, so that
+  // their key ranges are taken from their first and last keys
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "val" + ToString(i)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 50; i < 150; i++) {
+    ASSERT_OK(Put(Key(i), "new" + ToString(i)));
+  }
+  ASSERT_OK(Delete(Key(0)));
+  ASSERT_OK(Flush());
+  auto before = GetTables();
+  ASSERT_EQ(2U, before.size());
+
+  int from_properties, scanned;
+  RepairWithoutManifest(options, &from_properties, &scanned);
+  ASSERT_EQ(2, from_properties);
+  ASSERT_EQ(0, scanned);
+  AssertSameTables(before, GetTables());
+  ASSERT_EQ("NOT_FOUND", Get(Key(0)));
+  ASSERT_EQ("val1", Get(Key(1)));
+  ASSERT_EQ("new50", Get(Key(50)));
+  ASSERT_EQ("new149", Get(Key(149)));
+}
+
+TEST_F(RepairTest, ScanTablesWithBlobs) {
+  // The tables referencing blob files are scanned to rebuild the references,
+  // which keep the blob files alive
+  Options options = CurrentOptions();
+  options.min_blob_size = 100;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), std::string(200, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("small", "val"));
+  ASSERT_OK(Flush());
+  auto before = GetTables();
+  ASSERT_EQ(2U, before.size());
+
+  int from_properties, scanned;
+  RepairWithoutManifest(options, &from_properties, &scanned);
+  ASSERT_EQ(1, from_properties);
+  ASSERT_EQ(1, scanned);
+  auto after = GetTables();
+  AssertSameTables(before, after);
+  for (const auto& t : before) {
+    ASSERT_EQ(t.second.blob_refs, after[t.first].blob_refs);
+  }
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  Reopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(std::string(200, 'a' + i % 26), Get(Key(i)));
+  }
+  ASSERT_EQ("val", Get("small"));
+}
+
+TEST_F(RepairTest, ColumnTableSubFiles) {
+  // The sizes and the placement of the sub column files are read back from
+  // the column tables
+  Options options = CurrentOptions();
+  options.db_paths.emplace_back(dbname_, 1 << 30);
+  options.db_paths.emplace_back(dbname_ + "_2", 1 << 30);
+  options.splitter.reset(NewPipeSplitter());
+  ColumnTableOptions table_options;
+  table_options.column_count = 2;
+  table_options.column_path_ids = {0, 1};
+  options.table_factory.reset(NewColumnTableFactory(table_options));
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), ToString(i) + "|" + std::string(100, 'x')));
+  }
+  ASSERT_OK(Flush());
+  auto before = GetTables();
+  ASSERT_EQ(1U, before.size());
+  const FileMetaData& f = before.begin()->second;
+  ASSERT_EQ(std::vector<uint32_t>({0, 1}), f.sub_path_ids);
+  ASSERT_GT(f.fd.GetFileSizeTotal(), f.fd.GetFileSize());
+
+  int from_properties, scanned;
+  RepairWithoutManifest(options, &from_properties, &scanned);
+  ASSERT_EQ(1, from_properties);
+  ASSERT_EQ(0, scanned);
+  AssertSameTables(before, GetTables());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(ToString(i) + "|" + std::string(100, 'x'), Get(Key(i)));
+  }
+  Close();
+  DestroyDB(dbname_, options);
+}
+
+TEST_F(RepairTest, ParallelLogConversion) {
+  // Each unflushed log of the default column family is kept alive by the
+  // column family flushed after it
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  const int kNumLogs = 5;
+  for (int i = 0; i < kNumLogs; i++) {
+    ASSERT_OK(Put(Key(i), "val"));
+    ASSERT_OK(Put("key", "val" + ToString(i)));
+    ASSERT_OK(Put(1, "other", "val"));
+    ASSERT_OK(Flush(1));
+  }
+  std::string manifest_path =
+      DescriptorFileName(dbname_, dbfull()->TEST_Current_Manifest_FileNo());
+  VectorLogPtr wal_files;
+  ASSERT_OK(dbfull()->GetSortedWalFiles(wal_files));
+  ASSERT_GE(wal_files.size(), static_cast<size_t>(kNumLogs));
+  Close();
+  ASSERT_OK(env_->DeleteFile(manifest_path));
+
+  // the first logs are converted last
+  uint64_t first_log = wal_files[0]->LogNumber();
+  vidardb::SyncPoint::GetInstance()->SetCallBack(
+      "Repairer::ConvertLogToTable", [&](void* arg) {
+        uint64_t log = *reinterpret_cast<uint64_t*>(arg);
+        if (log < first_log + kNumLogs) {
+          env_->SleepForMicroseconds(
+              static_cast<int>(first_log + kNumLogs - log) * 20000);
+        }
+      });
+  vidardb::SyncPoint::GetInstance()->EnableProcessing();
+  Options repair_options = options;
+  repair_options.max_file_opening_threads = kNumLogs;
+  ASSERT_OK(RepairDB(dbname_, repair_options));
+  vidardb::SyncPoint::GetInstance()->DisableProcessing();
+  vidardb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  Reopen(options);
+
+  // the tables are numbered in the order of their logs, the other ones are
+  // the flushed tables of pikachu
+  size_t num_converted = 0;
+  SequenceNumber last_seqno = 0;
+  for (const auto& t : GetTables()) {
+    if (t.second.smallest.user_key() == "other") {
+      continue;
+    }
+    num_converted++;
+    ASSERT_GT(t.second.smallest_seqno, last_seqno);
+    last_seqno = t.second.largest_seqno;
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumLogs), num_converted);
+  for (int i = 0; i < kNumLogs; i++) {
+    ASSERT_EQ("val", Get(Key(i)));
+  }
+  ASSERT_EQ("val" + ToString(kNumLogs - 1), Get("key"));
+}
+
 }  // namespace vidardb
 
 int main(int argc, char** argv) {
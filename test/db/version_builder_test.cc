@@ -3,13 +3,17 @@
 //  LICENSE file in the root directory of this source tree. An additional grant
 //  of patent rights can be found in the PATENTS file in the same directory.
 
+#include <algorithm>
+#include <set>
 #include <string>
+#include "db/filename.h"
 #include "db/version_edit.h"
 #include "db/version_set.h"
 #include "util/logging.h"
 #include "util/string_util.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
+#include "vidardb/db.h"
 
 namespace vidardb {
 
@@ -275,6 +279,98 @@ TEST_F(VersionBuilderTest, ApplyDeleteAndSaveTo) {
   UnrefFilesInVersion(&new_vstorage);
 }
 
+TEST_F(VersionBuilderTest, ApplyMoveAndSaveTo) {
+  Add(1, 66U, "150", "200", 100U);
+  UpdateVersionStorageInfo();
+
+  EnvOptions env_options;
+  VersionBuilder version_builder(env_options, nullptr, &vstorage_);
+  VersionStorageInfo new_vstorage(&icmp_, ucmp_, options_.num_levels,
+                                  kCompactionStyleLevel, nullptr);
+
+  VersionEdit version_edit;
+  version_edit.AddFile(1, 666, 0, 100U, GetInternalKey("301"),
+                       GetInternalKey("350"), 200, 200, false, 0);
+  version_builder.Apply(&version_edit);
+
+  // move both the base file and the added file one level down
+  VersionEdit version_edit2;
+  version_edit2.DeleteFile(1, 66U);
+  version_edit2.DeleteFile(1, 666);
+  version_edit2.AddFile(2, 66U, 0, 100U, GetInternalKey("150"),
+                        GetInternalKey("200"), 100, 100, false, 0);
+  version_edit2.AddFile(2, 666, 0, 100U, GetInternalKey("301"),
+                        GetInternalKey("350"), 200, 200, false, 0);
+  version_builder.Apply(&version_edit2);
+
+  version_builder.SaveTo(&new_vstorage);
+
+  ASSERT_EQ(0U, new_vstorage.NumLevelBytes(1));
+  ASSERT_EQ(200U, new_vstorage.NumLevelBytes(2));
+
+  UnrefFilesInVersion(&new_vstorage);
+}
+
+TEST_F(VersionBuilderTest, ApplyDeleteReaddAndSaveTo) {
+  Add(1, 66U, "150", "200", 100U);
+  UpdateVersionStorageInfo();
+
+  EnvOptions env_options;
+  VersionBuilder version_builder(env_options, nullptr, &vstorage_);
+  VersionStorageInfo new_vstorage(&icmp_, ucmp_, options_.num_levels,
+                                  kCompactionStyleLevel, nullptr);
+
+  VersionEdit version_edit;
+  version_edit.DeleteFile(1, 66U);
+  version_builder.Apply(&version_edit);
+
+  VersionEdit version_edit2;
+  version_edit2.AddFile(1, 66U, 0, 100U, GetInternalKey("150"),
+                        GetInternalKey("200"), 100, 100, false, 0);
+  version_builder.Apply(&version_edit2);
+
+  version_builder.SaveTo(&new_vstorage);
+
+  // only the added copy of the base file is kept
+  ASSERT_EQ(1, new_vstorage.NumLevelFiles(1));
+  ASSERT_EQ(100U, new_vstorage.NumLevelBytes(1));
+
+  UnrefFilesInVersion(&new_vstorage);
+}
+
+TEST_F(VersionBuilderTest, ApplyDeleteReaddDeleteAndSaveTo) {
+  Add(1, 66U, "150", "200", 100U);
+  Add(1, 88U, "201", "300", 100U);
+  UpdateVersionStorageInfo();
+
+  EnvOptions env_options;
+  VersionBuilder version_builder(env_options, nullptr, &vstorage_);
+  VersionStorageInfo new_vstorage(&icmp_, ucmp_, options_.num_levels,
+                                  kCompactionStyleLevel, nullptr);
+
+  VersionEdit version_edit;
+  version_edit.DeleteFile(1, 66U);
+  version_builder.Apply(&version_edit);
+
+  VersionEdit version_edit2;
+  version_edit2.AddFile(1, 66U, 0, 100U, GetInternalKey("150"),
+                        GetInternalKey("200"), 100, 100, false, 0);
+  version_builder.Apply(&version_edit2);
+
+  VersionEdit version_edit3;
+  version_edit3.DeleteFile(1, 66U);
+  version_builder.Apply(&version_edit3);
+
+  version_builder.SaveTo(&new_vstorage);
+
+  // the base copy must not come back
+  ASSERT_EQ(1, new_vstorage.NumLevelFiles(1));
+  ASSERT_EQ(100U, new_vstorage.NumLevelBytes(1));
+  ASSERT_EQ(88U, new_vstorage.LevelFiles(1)[0]->fd.GetNumber());
+
+  UnrefFilesInVersion(&new_vstorage);
+}
+
 TEST_F(VersionBuilderTest, EstimatedActiveKeys) {
   const uint32_t kTotalSamples = 20;
   const uint32_t kNumLevels = 5;
@@ -297,6 +393,145 @@ TEST_F(VersionBuilderTest, EstimatedActiveKeys) {
             (kEntriesPerFile - 2 * kDeletionsPerFile) * kNumFiles);
 }
 
+class VersionRecoveryTest : public testing::Test {
+ public:
+  std::string dbname_;
+  Options options_;
+  DB* db_;
+  std::vector<ColumnFamilyHandle*> handles_;
+
+  VersionRecoveryTest() : db_(nullptr) {
+    dbname_ = test::TmpDir() + "/version_recovery_test";
+    options_.create_if_missing = true;
+    options_.create_missing_column_families = true;
+    DestroyDB(dbname_, options_);
+  }
+
+  ~VersionRecoveryTest() {
+    Close();
+    DestroyDB(dbname_, options_);
+  }
+
+  Status Open(int num_column_families) {
+    std::vector<ColumnFamilyDescriptor> column_families;
+    column_families.emplace_back(kDefaultColumnFamilyName, options_);
+    for (int i = 1; i < num_column_families; i++) {
+      column_families.emplace_back("cf" + ToString(i), options_);
+    }
+    return DB::Open(options_, dbname_, column_families, &handles_, &db_);
+  }
+
+  void Close() {
+    for (auto* handle : handles_) {
+      delete handle;
+    }
+    handles_.clear();
+    delete db_;
+    db_ = nullptr;
+  }
+
+  // Writes and flushes one file per column family
+  void FlushFiles(int round) {
+    for (size_t i = 0; i < handles_.size(); i++) {
+      ASSERT_OK(db_->Put(WriteOptions(), handles_[i], Key(round),
+                         ToString(round)));
+      ASSERT_OK(db_->Flush(FlushOptions(), handles_[i]));
+    }
+  }
+
+  std::string Get(size_t cf, int round) {
+    std::string value;
+    ReadOptions read_options;
+    Status s = db_->Get(read_options, handles_[cf], Key(round), &value);
+    return s.ok() ? value : s.ToString();
+  }
+
+  std::string CurrentManifest() {
+    std::string current;
+    EXPECT_OK(ReadFileToString(options_.env, CurrentFileName(dbname_),
+                               &current));
+    return current;
+  }
+
+  // The live files as "<column family>:<level>:<file name>"
+  std::vector<std::string> LiveFiles() {
+    std::vector<LiveFileMetaData> metadata;
+    db_->GetLiveFilesMetaData(&metadata);
+    std::vector<std::string> files;
+    for (const auto& f : metadata) {
+      files.push_back(f.column_family_name + ":" + ToString(f.level) + ":" +
+                      f.name);
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+  }
+
+  static std::string Key(int round) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", round);
+    return buf;
+  }
+};
+
+TEST_F(VersionRecoveryTest, ManifestRollover) {
+  options_.manifest_snapshot_ratio = 2;
+  options_.manifest_preallocation_size = 1;
+  options_.disable_auto_compactions = true;
+  ASSERT_OK(Open(3));
+
+  std::string first_manifest = CurrentManifest();
+  std::set<std::string> manifests;
+  const int kRounds = 40;
+  for (int round = 0; round < kRounds; round++) {
+    FlushFiles(round);
+    manifests.insert(CurrentManifest());
+  }
+  // each snapshot is followed by edits until it is twice as large
+  ASSERT_GT(manifests.size(), 2U);
+  ASSERT_NE(first_manifest, CurrentManifest());
+  std::vector<std::string> live_files = LiveFiles();
+  ASSERT_EQ(3U * kRounds, live_files.size());
+
+  Close();
+  ASSERT_OK(Open(3));
+  ASSERT_EQ(live_files, LiveFiles());
+  for (size_t cf = 0; cf < handles_.size(); cf++) {
+    for (int round = 0; round < kRounds; round++) {
+      ASSERT_EQ(ToString(round), Get(cf, round));
+    }
+  }
+}
+
+TEST_F(VersionRecoveryTest, ParallelRecovery) {
+  options_.disable_auto_compactions = true;
+  const int kColumnFamilies = 6;
+  ASSERT_OK(Open(kColumnFamilies));
+  const int kRounds = 5;
+  for (int round = 0; round < kRounds; round++) {
+    FlushFiles(round);
+  }
+  // move the files of some column families down, so that the recovered
+  // versions differ per column family
+  for (size_t cf = 0; cf < handles_.size(); cf += 2) {
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), handles_[cf], nullptr,
+                                nullptr));
+  }
+  std::vector<std::string> live_files = LiveFiles();
+  Close();
+
+  for (int threads : {1, 4, 16}) {
+    options_.max_file_opening_threads = threads;
+    ASSERT_OK(Open(kColumnFamilies));
+    ASSERT_EQ(live_files, LiveFiles());
+    for (size_t cf = 0; cf < handles_.size(); cf++) {
+      for (int round = 0; round < kRounds; round++) {
+        ASSERT_EQ(ToString(round), Get(cf, round));
+      }
+    }
+    Close();
+  }
+}
+
 }  // namespace vidardb
 
 int main(int argc, char** argv) {
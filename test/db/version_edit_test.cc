@@ -161,6 +161,98 @@ TEST_F(VersionEditTest, NewFile4NotSupportedField) {
   ASSERT_NOK(s);
 }
 
+TEST_F(VersionEditTest, EncodeDecodeSubPathIds) {
+  static const uint64_t kBig = 1ull << 50;
+  VersionEdit edit;
+  // colocated sub files are not persisted
+  edit.AddFile(1, 300, 1, 100, InternalKey("foo", kBig + 500, kTypeValue),
+               InternalKey("zoo", kBig + 600, kTypeDeletion), kBig + 500,
+               kBig + 600, false, 300, {1, 1});
+  edit.AddFile(1, 301, 0, 100, InternalKey("foo", kBig + 501, kTypeValue),
+               InternalKey("zoo", kBig + 601, kTypeDeletion), kBig + 501,
+               kBig + 601, false, 300, {0, 2, 0});
+  TestEncodeDecode(edit);
+
+  std::string encoded;
+  edit.EncodeTo(&encoded);
+  VersionEdit parsed;
+  Status s = parsed.DecodeFrom(encoded);
+  ASSERT_OK(s);
+  auto& new_files = parsed.GetNewFiles();
+  ASSERT_EQ(2u, new_files.size());
+  ASSERT_TRUE(new_files[0].second.sub_path_ids.empty());
+  ASSERT_EQ(std::vector<uint32_t>({0, 2, 0}), new_files[1].second.sub_path_ids);
+}
+
+TEST_F(VersionEditTest, EncodeDecodeBlobRefs) {
+  static const uint64_t kBig = 1ull << 50;
+  VersionEdit edit;
+  edit.AddFile(1, 300, 0, 100, InternalKey("foo", kBig + 500, kTypeValue),
+               InternalKey("zoo", kBig + 600, kTypeBlobIndex), kBig + 500,
+               kBig + 600, false, 300, {}, {{300, 1 << 20}, {kBig, 7}});
+  edit.AddFile(1, 301, 0, 100, InternalKey("foo", kBig + 501, kTypeValue),
+               InternalKey("zoo", kBig + 601, kTypeDeletion), kBig + 501,
+               kBig + 601, false, 300);
+  TestEncodeDecode(edit);
+
+  std::string encoded;
+  edit.EncodeTo(&encoded);
+  VersionEdit parsed;
+  Status s = parsed.DecodeFrom(encoded);
+  ASSERT_OK(s);
+  auto& new_files = parsed.GetNewFiles();
+  ASSERT_EQ(2u, new_files.size());
+  ASSERT_EQ(2u, new_files[0].second.blob_refs.size());
+  ASSERT_EQ(1u << 20, new_files[0].second.blob_refs.at(300));
+  ASSERT_EQ(7u, new_files[0].second.blob_refs.at(kBig));
+  ASSERT_TRUE(new_files[1].second.blob_refs.empty());
+}
+
+TEST_F(VersionEditTest, EncodeDecodeFlushId) {
+  static const uint64_t kBig = 1ull << 50;
+  VersionEdit edit;
+  edit.AddFile(0, 300, 0, 100, InternalKey("foo", kBig + 500, kTypeValue),
+               InternalKey("goo", kBig + 600, kTypeValue), kBig + 500,
+               kBig + 600, false, 100, {}, {}, 300);
+  edit.AddFile(0, 301, 0, 100, InternalKey("hoo", kBig + 501, kTypeValue),
+               InternalKey("zoo", kBig + 601, kTypeValue), kBig + 501,
+               kBig + 601, false, 100, {}, {}, 300);
+  edit.AddFile(0, 302, 0, 100, InternalKey("foo", kBig + 700, kTypeValue),
+               InternalKey("zoo", kBig + 800, kTypeValue), kBig + 700,
+               kBig + 800, false, 100);
+  TestEncodeDecode(edit);
+
+  std::string encoded;
+  edit.EncodeTo(&encoded);
+  VersionEdit parsed;
+  Status s = parsed.DecodeFrom(encoded);
+  ASSERT_OK(s);
+  auto& new_files = parsed.GetNewFiles();
+  ASSERT_EQ(3u, new_files.size());
+  ASSERT_EQ(300u, new_files[0].second.flush_id);
+  ASSERT_EQ(300u, new_files[1].second.flush_id);
+  ASSERT_EQ(0u, new_files[2].second.flush_id);
+}
+
+TEST_F(VersionEditTest, EncodeDecodeAtomicGroup) {
+  VersionEdit edit;
+  edit.SetColumnFamily(2);
+  edit.SetLogNumber(100);
+  edit.MarkAtomicGroup(3);
+  TestEncodeDecode(edit);
+
+  std::string encoded;
+  edit.EncodeTo(&encoded);
+  VersionEdit parsed;
+  Status s = parsed.DecodeFrom(encoded);
+  ASSERT_OK(s);
+  ASSERT_TRUE(parsed.IsInAtomicGroup());
+  ASSERT_EQ(3u, parsed.GetRemainingEntries());
+
+  edit.Clear();
+  ASSERT_TRUE(!edit.IsInAtomicGroup());
+}
+
 TEST_F(VersionEditTest, EncodeEmptyFile) {
   VersionEdit edit;
   edit.AddFile(0, 0, 0, 0, InternalKey(), InternalKey(), 0, 0, false, 0);
@@ -0,0 +1,131 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "table/bitmap_index.h"
+#include "table/block.h"
+#include "table/format.h"
+#include "util/random.h"
+#include "util/testharness.h"
+#include "vidardb/comparator.h"
+
+namespace vidardb {
+
+class BitmapIndexTest : public testing::Test {};
+
+namespace {
+
+void CheckRows(const RowBitmap& rows, uint64_t num_rows,
+               const std::set<uint64_t>& expected) {
+  ASSERT_EQ(expected.size(), rows.Count());
+  for (uint64_t i = 0; i < num_rows; i++) {
+    ASSERT_EQ(expected.count(i) > 0, rows.Contains(i)) << i;
+  }
+}
+
+}  // namespace
+
+TEST_F(BitmapIndexTest, RoaringBitmap) {
+  const uint64_t kNumRows = 200000;
+  Random rnd(301);
+  // sparse rows stay in arrays, dense ones switch to bitmaps
+  for (uint32_t one_in : {1u, 2u, 13u, 1000u}) {
+    RoaringBitmap bitmap;
+    std::set<uint64_t> expected;
+    for (uint64_t i = 0; i < kNumRows; i++) {
+      if (rnd.OneIn(one_in)) {
+        bitmap.Add(i);
+        expected.insert(i);
+      }
+    }
+    std::string encoded;
+    bitmap.EncodeTo(&encoded);
+
+    RowBitmap rows(kNumRows);
+    ASSERT_OK(rows.Or(encoded));
+    CheckRows(rows, kNumRows, expected);
+  }
+}
+
+TEST_F(BitmapIndexTest, AndOr) {
+  const uint64_t kNumRows = 70000;
+  RoaringBitmap even, odd, tens;
+  std::set<uint64_t> expected;
+  for (uint64_t i = 0; i < kNumRows; i++) {
+    (i % 2 == 0 ? even : odd).Add(i);
+    if (i % 10 == 0) {
+      tens.Add(i);
+      expected.insert(i);
+    }
+  }
+  std::string even_encoded, odd_encoded, tens_encoded;
+  even.EncodeTo(&even_encoded);
+  odd.EncodeTo(&odd_encoded);
+  tens.EncodeTo(&tens_encoded);
+
+  RowBitmap all(kNumRows);
+  ASSERT_OK(all.Or(even_encoded));
+  ASSERT_OK(all.Or(odd_encoded));
+  ASSERT_EQ(kNumRows, all.Count());
+
+  RowBitmap rows(kNumRows);
+  ASSERT_OK(rows.Or(tens_encoded));
+  rows.And(all);
+  CheckRows(rows, kNumRows, expected);
+
+  RowBitmap odd_rows(kNumRows);
+  ASSERT_OK(odd_rows.Or(odd_encoded));
+  rows.And(odd_rows);
+  ASSERT_EQ(0U, rows.Count());
+
+  RowBitmap corrupted(kNumRows);
+  ASSERT_TRUE(corrupted.Or(Slice(tens_encoded.data(), 10)).IsCorruption());
+}
+
+TEST_F(BitmapIndexTest, Builder) {
+  BitmapIndexBuilder builder(3);
+  std::vector<std::string> values = {"shipped", "paid", "", "paid"};
+  for (uint64_t i = 0; i < 1000; i++) {
+    builder.Add(values[i % values.size()], i);
+  }
+  ASSERT_FALSE(builder.abandoned());
+
+  BlockContents contents;
+  contents.data = builder.Finish();
+  Block block(std::move(contents));
+  std::unique_ptr<InternalIterator> iter(
+      block.NewIterator(BytewiseComparator()));
+  iter->SeekToFirst();
+  for (const std::string value : {"", "paid", "shipped"}) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(value, iter->key().ToString());
+    std::set<uint64_t> expected;
+    for (uint64_t i = 0; i < 1000; i++) {
+      if (values[i % values.size()] == value) {
+        expected.insert(i);
+      }
+    }
+    RowBitmap rows(1000);
+    ASSERT_OK(rows.Or(iter->value()));
+    CheckRows(rows, 1000, expected);
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->Valid());
+
+  // one more distinct value than allowed
+  builder.Add("new", 1000);
+  ASSERT_TRUE(builder.abandoned());
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,90 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <string>
+
+#include "table/column_stats.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace vidardb {
+
+class ColumnStatsTest : public testing::Test {};
+
+TEST_F(ColumnStatsTest, HyperLogLog) {
+  for (uint64_t n : {10u, 1000u, 100000u}) {
+    HyperLogLog hll;
+    for (uint64_t i = 0; i < n; i++) {
+      hll.Add(ToString(i));
+      hll.Add(ToString(i));  // duplicates do not count
+    }
+    ASSERT_NEAR(n, hll.Estimate(), n * 0.1 + 1);
+  }
+}
+
+TEST_F(ColumnStatsTest, EncodeDecode) {
+  ColumnStatsBuilder builder;
+  for (int i = 0; i < 10000; i++) {
+    builder.Add(i % 5 == 0 ? "" : ToString(1000 + i % 100));
+  }
+  TableColumnStats stats;
+  ASSERT_OK(stats.DecodeFrom(builder.Finish()));
+  ASSERT_EQ(8000U, stats.num_values);
+  ASSERT_EQ(2000U, stats.num_nulls);
+  ASSERT_NEAR(80, stats.distinct.Estimate(), 8);
+  ASSERT_EQ(33U, stats.histogram.size());
+  ASSERT_EQ("1001", stats.histogram.front());
+  ASSERT_EQ("1099", stats.histogram.back());
+  for (size_t i = 1; i < stats.histogram.size(); i++) {
+    ASSERT_LE(stats.histogram[i - 1], stats.histogram[i]);
+  }
+
+  ASSERT_TRUE(stats.DecodeFrom(Slice("\x01\x02", 2)).IsCorruption());
+}
+
+TEST_F(ColumnStatsTest, Aggregate) {
+  // two files with the values [0, 5000) and [5000, 10000)
+  TableColumnStats stats[2];
+  for (int f = 0; f < 2; f++) {
+    ColumnStatsBuilder builder;
+    for (int i = 0; i < 5000; i++) {
+      builder.Add(ToString(10000 + f * 5000 + i));
+      builder.Add(Slice());
+    }
+    ASSERT_OK(stats[f].DecodeFrom(builder.Finish()));
+  }
+
+  ColumnStatsAggregator whole;
+  whole.Add(stats[0], 1.0);
+  whole.Add(stats[1], 1.0);
+  ColumnStats result;
+  whole.Finish(&result);
+  ASSERT_EQ(10000U, result.num_nulls);
+  ASSERT_NEAR(10000, result.num_distinct, 1000);
+  ASSERT_EQ("10000", result.histogram.front());
+  ASSERT_EQ("19999", result.histogram.back());
+  // the middle bound splits the values evenly
+  const std::string& median = result.histogram[result.histogram.size() / 2];
+  ASSERT_GT(median, "14000");
+  ASSERT_LT(median, "16000");
+
+  ColumnStatsAggregator half;
+  half.Add(stats[0], 0.5);
+  half.Finish(&result);
+  ASSERT_EQ(2500U, result.num_nulls);
+  ASSERT_NEAR(2500, result.num_distinct, 250);
+
+  ColumnStatsAggregator none;
+  none.Finish(&result);
+  ASSERT_EQ(0U, result.num_distinct);
+  ASSERT_TRUE(result.histogram.empty());
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
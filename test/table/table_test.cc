@@ -369,6 +369,9 @@ class TableConstructor: public Constructor {
 
   void ResetTableReader() { table_reader_.reset(); }
 
+  // The bytes of the table written by the last Finish()
+  const std::string& contents() { return GetSink()->contents(); }
+
  private:
   void Reset() {
     uniq_id_ = 0;
@@ -1041,6 +1044,77 @@ void PrefetchRange(TableConstructor* c, Options* opt,
   c->ResetTableReader();
 }
 
+TEST_F(BlockBasedTableTest, ChecksumTypes) {
+  for (ChecksumType checksum : {kCRC32c, kxxHash64, kXXH3}) {
+    TableConstructor c(BytewiseComparator(), true);
+    for (int i = 0; i < 100; i++) {
+      c.Add("key" + ToString(i), "value" + ToString(i));
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    Options options;
+    options.compression = kNoCompression;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 256;
+    table_options.checksum = checksum;
+    // the blocks are read from the file each time
+    table_options.no_block_cache = true;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    const ImmutableCFOptions ioptions(options);
+    InternalKeyComparator ikc(options.comparator);
+    c.Finish(options, ioptions, table_options, ikc, &keys, &kvmap);
+
+    // the footer names the checksum of the blocks
+    std::string contents = c.contents();
+    Slice input(contents.data() + contents.size() - Footer::kEncodedLength,
+                Footer::kEncodedLength);
+    Footer footer;
+    ASSERT_OK(footer.DecodeFrom(&input));
+    ASSERT_EQ(checksum, footer.checksum());
+
+    std::unique_ptr<InternalIterator> iter(c.NewIterator());
+    auto kv = kvmap.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++kv) {
+      ASSERT_TRUE(kv != kvmap.end());
+      ASSERT_EQ(kv->first, iter->key().ToString());
+      ASSERT_EQ(kv->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(kv == kvmap.end());
+    iter.reset();
+    c.ResetTableReader();
+
+    // a flipped byte of the first data block is caught, and its keys skipped
+    contents[5] ^= 0x80;
+    unique_ptr<TableReader> reader;
+    ASSERT_OK(ioptions.table_factory->NewTableReader(
+        TableReaderOptions(ioptions, EnvOptions(), ikc),
+        unique_ptr<RandomAccessFileReader>(test::GetRandomAccessFileReader(
+            new test::StringSource(contents))),
+        contents.size(), &reader));
+    iter.reset(reader->NewIterator(ReadOptions()));
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_NE(kvmap.begin()->first, iter->key().ToString());
+    ASSERT_TRUE(iter->status().IsCorruption());
+    ASSERT_NE(std::string::npos,
+              iter->status().ToString().find("block checksum mismatch"));
+    iter.reset();
+    reader.reset();
+
+    // and so is a checksum type the reader does not know
+    contents[5] ^= 0x80;
+    contents[contents.size() - 9] = 0x7;
+    Status s = ioptions.table_factory->NewTableReader(
+        TableReaderOptions(ioptions, EnvOptions(), ikc),
+        unique_ptr<RandomAccessFileReader>(test::GetRandomAccessFileReader(
+            new test::StringSource(contents))),
+        contents.size(), &reader);
+    ASSERT_TRUE(s.IsCorruption());
+    ASSERT_NE(std::string::npos, s.ToString().find("unknown checksum type 7"));
+  }
+}
+
 TEST_F(BlockBasedTableTest, PrefetchTest) {
   // The purpose of this test is to test the prefetching operation built into
   // BlockBasedTable.
@@ -1979,6 +2053,29 @@ TEST_F(HarnessTest, FooterTests) {
     ASSERT_EQ(decoded_footer.metaindex_handle().size(), meta_index.size());
     ASSERT_EQ(decoded_footer.index_handle().offset(), index.offset());
     ASSERT_EQ(decoded_footer.index_handle().size(), index.size());
+    ASSERT_EQ(kCRC32c, decoded_footer.checksum());
+
+    // the checksum type is the byte before the magic number, left zero by
+    // the tables written before it, which are read as crc32c ones
+    ASSERT_EQ(0, encoded[Footer::kEncodedLength - 9]);
+  }
+  for (ChecksumType checksum : {kCRC32c, kxxHash64, kXXH3}) {
+    std::string encoded;
+    Footer footer(kBlockBasedTableMagicNumber);
+    BlockHandle meta_index(10, 5), index(20, 15);
+    footer.set_metaindex_handle(meta_index);
+    footer.set_index_handle(index);
+    footer.set_checksum(checksum);
+    footer.EncodeTo(&encoded);
+    ASSERT_EQ(Footer::kEncodedLength, encoded.size());
+    ASSERT_EQ(checksum, encoded[Footer::kEncodedLength - 9]);
+    Footer decoded_footer;
+    Slice encoded_slice(encoded);
+    ASSERT_OK(decoded_footer.DecodeFrom(&encoded_slice));
+    ASSERT_EQ(checksum, decoded_footer.checksum());
+    ASSERT_EQ(decoded_footer.table_magic_number(), kBlockBasedTableMagicNumber);
+    ASSERT_EQ(decoded_footer.metaindex_handle().offset(), meta_index.offset());
+    ASSERT_EQ(decoded_footer.index_handle().offset(), index.offset());
   }
 }
 
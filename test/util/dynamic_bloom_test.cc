@@ -0,0 +1,80 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "util/arena.h"
+#include "util/dynamic_bloom.h"
+#include "util/testharness.h"
+
+namespace vidardb {
+
+class DynamicBloomTest : public testing::Test {};
+
+namespace {
+std::string Key(int i) { return "key" + std::to_string(i); }
+}  // namespace
+
+TEST_F(DynamicBloomTest, EmptyFilter) {
+  Arena arena;
+  DynamicBloom bloom(&arena, 100, 2);
+  ASSERT_TRUE(!bloom.MayContain("hello"));
+  ASSERT_TRUE(!bloom.MayContain("world"));
+  // rounded up to a cache line
+  ASSERT_EQ(CACHE_LINE_SIZE, bloom.MemoryUsage());
+}
+
+TEST_F(DynamicBloomTest, FalsePositiveRate) {
+  const int kNumKeys = 100000;
+  const uint32_t kBitsPerKey = 10;
+  Arena arena;
+  DynamicBloom bloom(&arena, kNumKeys * kBitsPerKey,
+                     DynamicBloom::OptimalNumProbes(kBitsPerKey));
+  for (int i = 0; i < kNumKeys; i += 2) {
+    bloom.Add(Key(i));
+  }
+  int false_positives = 0;
+  for (int i = 0; i < kNumKeys; i++) {
+    if (i % 2 == 0) {
+      ASSERT_TRUE(bloom.MayContain(Key(i)));
+    } else if (bloom.MayContain(Key(i))) {
+      false_positives++;
+    }
+  }
+  // the keys fill half of the filter
+  ASSERT_LT(false_positives, kNumKeys / 2 / 100);
+}
+
+TEST_F(DynamicBloomTest, ConcurrentAdd) {
+  const int kNumThreads = 4;
+  const int kKeysPerThread = 20000;
+  Arena arena;
+  DynamicBloom bloom(&arena, kNumThreads * kKeysPerThread * 10,
+                     DynamicBloom::OptimalNumProbes(10));
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kNumThreads; t++) {
+    writers.emplace_back([&bloom, t]() {
+      for (int i = t; i < kNumThreads * kKeysPerThread; i += kNumThreads) {
+        bloom.AddConcurrently(Key(i));
+        ASSERT_TRUE(bloom.MayContain(Key(i)));
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  for (int i = 0; i < kNumThreads * kKeysPerThread; i++) {
+    ASSERT_TRUE(bloom.MayContain(Key(i)));
+  }
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -472,6 +472,111 @@ TEST_P(EnvPosixTestWithParam, DecreaseNumBgThreads) {
   ASSERT_TRUE(!tasks[5].IsSleeping());
 }
 
+TEST_P(EnvPosixTestWithParam, BottomPool) {
+  // no thread by default
+  ASSERT_EQ(0, env_->GetBackgroundThreads(Env::Priority::BOTTOM));
+  env_->SetBackgroundThreads(1, Env::Priority::BOTTOM);
+  ASSERT_EQ(1, env_->GetBackgroundThreads(Env::Priority::BOTTOM));
+
+  test::SleepingBackgroundTask tasks[2];
+  for (auto& task : tasks) {
+    env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &task,
+                   Env::Priority::BOTTOM);
+  }
+  tasks[0].WaitUntilSleeping();
+  Env::Default()->SleepForMicroseconds(kDelayMicros);
+  ASSERT_FALSE(tasks[1].IsSleeping());
+  ASSERT_EQ(1U, env_->GetThreadPoolQueueLen(Env::Priority::BOTTOM));
+
+  tasks[0].WakeUp();
+  tasks[0].WaitUntilDone();
+  tasks[1].WaitUntilSleeping();
+  ASSERT_EQ(0U, env_->GetThreadPoolQueueLen(Env::Priority::BOTTOM));
+  tasks[1].WakeUp();
+  tasks[1].WaitUntilDone();
+  env_->SetBackgroundThreads(0, Env::Priority::BOTTOM);
+}
+
+TEST_P(EnvPosixTestWithParam, BottomPoolStealsFromLowAndHigh) {
+  env_->SetBackgroundThreads(1, Env::Priority::LOW);
+  env_->SetBackgroundThreads(1, Env::Priority::HIGH);
+
+  // LOW and HIGH do not steal from each other
+  test::SleepingBackgroundTask low[2];
+  test::SleepingBackgroundTask high[2];
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &high[0],
+                 Env::Priority::HIGH);
+  high[0].WaitUntilSleeping();
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &high[1],
+                 Env::Priority::HIGH);
+  Env::Default()->SleepForMicroseconds(kDelayMicros);
+  ASSERT_FALSE(high[1].IsSleeping());
+  ASSERT_EQ(1U, env_->GetThreadPoolQueueLen(Env::Priority::HIGH));
+
+  // an idle BOTTOM thread runs the jobs waiting in HIGH, then in LOW
+  env_->SetBackgroundThreads(1, Env::Priority::BOTTOM);
+  high[1].WaitUntilSleeping();
+  ASSERT_EQ(0U, env_->GetThreadPoolQueueLen(Env::Priority::HIGH));
+  high[1].WakeUp();
+  high[1].WaitUntilDone();
+
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &low[0],
+                 Env::Priority::LOW);
+  low[0].WaitUntilSleeping();
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &low[1],
+                 Env::Priority::LOW);
+  low[1].WaitUntilSleeping();
+  ASSERT_EQ(0U, env_->GetThreadPoolQueueLen(Env::Priority::LOW));
+  ASSERT_TRUE(low[0].IsSleeping());
+
+  for (auto* task : {&low[0], &low[1], &high[0]}) {
+    task->WakeUp();
+    task->WaitUntilDone();
+  }
+  env_->SetBackgroundThreads(0, Env::Priority::BOTTOM);
+}
+
+namespace {
+// Schedules a sleeping task from a thread of the LOW pool, and waits for it
+// to run while keeping that thread busy
+struct ScheduleFromPool {
+  Env* env;
+  test::SleepingBackgroundTask task;
+  std::atomic<bool> ran;
+  std::atomic<bool> done;
+
+  static void Run(void* arg) {
+    ScheduleFromPool* job = reinterpret_cast<ScheduleFromPool*>(arg);
+    job->env->Schedule(&test::SleepingBackgroundTask::DoSleepTask,
+                       &job->task);
+    for (int i = 0; i < 100 && !job->task.IsSleeping(); i++) {
+      Env::Default()->SleepForMicroseconds(kDelayMicros / 10);
+    }
+    job->ran.store(job->task.IsSleeping());
+    job->done.store(true);
+  }
+};
+}  // namespace
+
+TEST_P(EnvPosixTestWithParam, StealFromSibling) {
+  env_->SetBackgroundThreads(2, Env::Priority::LOW);
+  // the task is queued to the busy thread scheduling it, so only a sibling
+  // stealing it runs it in time
+  ScheduleFromPool job;
+  job.env = env_;
+  job.ran.store(false);
+  job.done.store(false);
+  env_->Schedule(&ScheduleFromPool::Run, &job);
+  while (!job.done.load()) {
+    Env::Default()->SleepForMicroseconds(kDelayMicros / 10);
+  }
+  job.task.WakeUp();
+  job.task.WaitUntilDone();
+  ASSERT_TRUE(job.ran.load());
+  ASSERT_EQ(0U, env_->GetThreadPoolQueueLen(Env::Priority::LOW));
+  env_->SetBackgroundThreads(1, Env::Priority::LOW);
+}
+
 #ifdef OS_LINUX
 // Travis doesn't support fallocate or getting unique ID from files for whatever
 // reason.
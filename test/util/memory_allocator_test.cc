@@ -0,0 +1,209 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#include "vidardb/cache.h"
+#include "vidardb/db.h"
+#include "vidardb/table.h"
+#include "table/format.h"
+#include "util/memory_allocator.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace vidardb {
+
+class MemoryAllocatorTest : public testing::Test {};
+
+namespace {
+void AllocateAndReuse(MemoryAllocator* allocator) {
+  Random rnd(301);
+  std::vector<std::pair<char*, size_t>> buffers;
+  for (int i = 0; i < 1000; i++) {
+    size_t size = rnd.Uniform(64 << 10) + 1;
+    char* p = reinterpret_cast<char*>(allocator->Allocate(size));
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 16);
+    ASSERT_GE(allocator->UsableSize(p, size), size);
+    memset(p, i & 0xff, size);
+    buffers.emplace_back(p, size);
+  }
+  for (size_t i = 0; i < buffers.size(); i++) {
+    ASSERT_EQ(static_cast<char>(i & 0xff), buffers[i].first[0]);
+    ASSERT_EQ(static_cast<char>(i & 0xff),
+              buffers[i].first[buffers[i].second - 1]);
+  }
+
+  // a freed buffer is handed out again for the same size
+  char* p = buffers.back().first;
+  size_t size = buffers.back().second;
+  allocator->Deallocate(p);
+  buffers.pop_back();
+  ASSERT_EQ(p, allocator->Allocate(size));
+  buffers.emplace_back(p, size);
+
+  for (auto& buffer : buffers) {
+    allocator->Deallocate(buffer.first);
+  }
+}
+}  // namespace
+
+TEST_F(MemoryAllocatorTest, SlabAllocateAndReuse) {
+  auto allocator = NewSlabMemoryAllocator();
+  ASSERT_STREQ("SlabMemoryAllocator", allocator->Name());
+  AllocateAndReuse(allocator.get());
+}
+
+TEST_F(MemoryAllocatorTest, HugePageAllocateAndReuse) {
+  auto allocator = NewHugePageMemoryAllocator();
+  ASSERT_STREQ("HugePageMemoryAllocator", allocator->Name());
+  AllocateAndReuse(allocator.get());
+}
+
+TEST_F(MemoryAllocatorTest, HugePageLargeAllocation) {
+  const size_t kHugePageSize = 2 << 20;
+  auto allocator = NewHugePageMemoryAllocator(kHugePageSize);
+  char* p = reinterpret_cast<char*>(allocator->Allocate(kHugePageSize));
+  memset(p, 1, kHugePageSize);
+  ASSERT_GE(allocator->UsableSize(p, kHugePageSize), kHugePageSize);
+  allocator->Deallocate(p);
+}
+
+TEST_F(MemoryAllocatorTest, AllocateBlock) {
+  auto allocator = NewHugePageMemoryAllocator();
+  CacheAllocationPtr with_allocator = AllocateBlock(4096, allocator.get());
+  ASSERT_EQ(allocator.get(), with_allocator.get_deleter().allocator);
+  CacheAllocationPtr without_allocator = AllocateBlock(4096, nullptr);
+  ASSERT_TRUE(without_allocator.get_deleter().allocator == nullptr);
+}
+
+TEST_F(MemoryAllocatorTest, Jemalloc) {
+  std::shared_ptr<MemoryAllocator> allocator;
+  Status s = NewJemallocMemoryAllocator(&allocator);
+#ifdef VIDARDB_JEMALLOC
+  ASSERT_OK(s);
+  void* p = allocator->Allocate(4096);
+  ASSERT_GE(allocator->UsableSize(p, 4096), 4096U);
+  allocator->Deallocate(p);
+#else
+  ASSERT_TRUE(s.IsNotSupported());
+  ASSERT_TRUE(allocator == nullptr);
+#endif
+}
+
+TEST_F(MemoryAllocatorTest, CacheAllocator) {
+  auto allocator = NewSlabMemoryAllocator();
+  auto cache = NewLRUCache(1 << 20, 4, false, allocator);
+  ASSERT_EQ(allocator.get(), cache->memory_allocator());
+  ASSERT_TRUE(NewLRUCache(1 << 20)->memory_allocator() == nullptr);
+}
+
+namespace {
+// Counts the buffers it has handed out and not yet taken back
+class CountingAllocator : public MemoryAllocator {
+ public:
+  explicit CountingAllocator(std::atomic<int>* live) : live_(live) {}
+  const char* Name() const override { return "CountingAllocator"; }
+  void* Allocate(size_t size) override {
+    (*live_)++;
+    return new char[size];
+  }
+  void Deallocate(void* p) override {
+    (*live_)--;
+    delete[] reinterpret_cast<char*>(p);
+  }
+
+ private:
+  std::atomic<int>* live_;
+};
+}  // namespace
+
+TEST_F(MemoryAllocatorTest, DefaultBlockCache) {
+  // the internal block cache allocates with new[] unless told otherwise
+  std::shared_ptr<TableFactory> factory(NewBlockBasedTableFactory());
+  auto* options =
+      reinterpret_cast<BlockBasedTableOptions*>(factory->GetOptions());
+  ASSERT_TRUE(options->block_cache->memory_allocator() == nullptr);
+  ASSERT_TRUE(GetMemoryAllocator(*options) == nullptr);
+
+  ColumnTableOptions column_options;
+  column_options.column_count = 2;
+  factory.reset(NewColumnTableFactory(column_options));
+  auto* column_table_options =
+      reinterpret_cast<ColumnTableOptions*>(factory->GetOptions());
+  ASSERT_TRUE(column_table_options->block_cache->memory_allocator() ==
+              nullptr);
+}
+
+TEST_F(MemoryAllocatorTest, TableOptionsAllocator) {
+  std::atomic<int> live(0);
+  std::shared_ptr<MemoryAllocator> allocator(new CountingAllocator(&live));
+
+  // the internal block cache is created with it
+  BlockBasedTableOptions table_options;
+  table_options.memory_allocator = allocator;
+  std::shared_ptr<TableFactory> factory(
+      NewBlockBasedTableFactory(table_options));
+  auto* options =
+      reinterpret_cast<BlockBasedTableOptions*>(factory->GetOptions());
+  ASSERT_EQ(allocator.get(), options->block_cache->memory_allocator());
+  ASSERT_EQ(allocator.get(), GetMemoryAllocator(*options));
+  ASSERT_OK(factory->SanitizeOptions(DBOptions(), ColumnFamilyOptions()));
+
+  // the allocator of a given block cache is used for its blocks
+  table_options.block_cache = NewLRUCache(1 << 20);
+  table_options.memory_allocator = nullptr;
+  ASSERT_TRUE(GetMemoryAllocator(table_options) == nullptr);
+
+  // and may not be another one
+  table_options.memory_allocator = allocator;
+  factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_TRUE(factory->SanitizeOptions(DBOptions(), ColumnFamilyOptions())
+                  .IsInvalidArgument());
+}
+
+TEST_F(MemoryAllocatorTest, CacheOutlivesTableOptions) {
+  std::atomic<int> live(0);
+  std::shared_ptr<Cache> cache =
+      NewLRUCache(8 << 20, 4, false,
+                  std::make_shared<CountingAllocator>(&live));
+
+  std::string dbname = test::TmpDir() + "/memory_allocator_test";
+  Options options;
+  options.create_if_missing = true;
+  DestroyDB(dbname, options);
+  {
+    BlockBasedTableOptions table_options;
+    table_options.block_cache = cache;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DB* db;
+    ASSERT_OK(DB::Open(options, dbname, &db));
+    for (int i = 0; i < 1000; i++) {
+      ASSERT_OK(db->Put(WriteOptions(), "key" + ToString(i),
+                        std::string(100, 'a' + i % 26)));
+    }
+    ASSERT_OK(db->Flush(FlushOptions()));
+    ReadOptions read_options;
+    std::string value;
+    ASSERT_OK(db->Get(read_options, "key500", &value));
+    delete db;
+    options.table_factory.reset();
+  }
+
+  // the cached blocks are freed through the allocator kept by the cache
+  ASSERT_GT(live.load(), 0);
+  cache.reset();
+  ASSERT_EQ(0, live.load());
+  DestroyDB(dbname, options);
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -143,7 +143,7 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "cache_index_and_filter_blocks=1;"
       "pin_l0_filter_and_index_blocks_in_cache=1;"
       "index_type=kHashSearch;"
-      "checksum=kxxHash;hash_index_allow_collision=1;no_block_cache=1;"
+      "checksum=kxxHash64;hash_index_allow_collision=1;no_block_cache=1;"
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;"
       "block_size_deviation=8;block_restart_interval=4; "
       "index_block_restart_interval=4;"
@@ -223,9 +223,11 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "wal_dir=path/to/wal_dir;"
                              "db_write_buffer_size=2587;"
                              "max_subcompactions=64330;"
+                             "max_subflushes=4;"
                              "table_cache_numshardbits=28;"
                              "max_open_files=72;"
                              "max_file_opening_threads=35;"
+                             "async_read_threads=6;"
                              "base_background_compactions=3;"
                              "max_background_compactions=33;"
                              "use_fsync=true;"
@@ -236,6 +238,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "keep_log_file_num=4890;"
                              "skip_stats_update_on_db_open=false;"
                              "max_manifest_file_size=4295009941;"
+                             "manifest_snapshot_ratio=8;"
                              "db_log_dir=path/to/db_log_dir;"
                              "skip_log_error_on_recovery=true;"
                              "writable_file_max_buffer_size=1048576;"
@@ -264,12 +267,14 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "fail_if_options_file_error=false;"
                              "allow_concurrent_memtable_write=true;"
                              "wal_recovery_mode=kPointInTimeRecovery;"
+                             "wal_checksum=kXXH3;"
                              "enable_write_thread_adaptive_yield=true;"
                              "write_thread_slow_yield_usec=5;"
                              "write_thread_max_yield_usec=1000;"
                              "access_hint_on_compaction_start=NONE;"
                              "info_log_level=DEBUG_LEVEL;"
                              "dump_malloc_stats=false;"
+                             "atomic_flush=false;"
                              "allow_2pc=false;",
                              new_options));
 
@@ -295,6 +300,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
 TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
   const OffsetGap kColumnFamilyOptionsBlacklist = {
       {offsetof(struct ColumnFamilyOptions, comparator), sizeof(Comparator*)},
+      {offsetof(struct ColumnFamilyOptions, compaction_filter),
+       sizeof(const CompactionFilter*)},
       {offsetof(struct ColumnFamilyOptions, compression_per_level),
        sizeof(std::vector<CompressionType>)},
       {offsetof(struct ColumnFamilyOptions,
@@ -366,6 +373,10 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "max_successive_merges=5497;"
       "max_sequential_skip_in_iterations=4294971408;"
       "arena_block_size=1893;"
+      "memtable_huge_page_size=0;"
+      "memtable_bloom_bits_per_key=10;"
+      "inplace_update_support=false;"
+      "inplace_update_num_locks=7429;"
       "target_file_size_multiplier=35;"
       "source_compaction_factor=54;"
       "min_write_buffer_number_to_merge=9;"
@@ -381,6 +392,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "num_levels=99;"
       "level0_slowdown_writes_trigger=22;"
       "level0_file_num_compaction_trigger=14;"
+      "compaction_weight=3;"
       "expanded_compaction_factor=34;"
       "compaction_filter=urxcqstuwnCompactionFilter;"
       "soft_rate_limit=530.615385;"
@@ -396,7 +408,9 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "filter_deletes=false;"
       "hard_pending_compaction_bytes_limit=0;"
       "disable_auto_compactions=false;"
-      "report_bg_io_stats=true;",
+      "report_bg_io_stats=true;"
+      "min_blob_size=4096;"
+      "blob_gc_garbage_ratio=0.25;",
       new_options));
 
   ASSERT_EQ(unset_bytes_base,
@@ -0,0 +1,85 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <string>
+
+#include "util/xxhash.h"
+#include "util/testharness.h"
+
+namespace vidardb {
+namespace xxhash {
+
+class XXHashTest : public testing::Test {};
+
+namespace {
+
+struct Result {
+  size_t n;
+  uint64_t xxh64;
+  uint64_t xxh64_seeded;
+  uint64_t xxh3;
+};
+
+// From the reference implementation, covering every code path of XXH3
+const Result kResults[] = {
+    {0, 0xef46db3751d8e999ULL, 0xc4349fc93c010000ULL, 0x2d06800538d394c2ULL},
+    {1, 0xa96c7f0ce858bbb7ULL, 0x585882422a6165e7ULL, 0x4c5cca45d0f4811fULL},
+    {3, 0xbed43740ee6332bbULL, 0x45fa1406538fa168ULL, 0x6e3e2670e61106acULL},
+    {4, 0xfa212ae44b3bb23dULL, 0xa65107f22943365aULL, 0x5c4c63133443d03fULL},
+    {8, 0x994b676b71ce94ddULL, 0xce592d5f53e192ecULL, 0xf9fd4dd0b04d78f5ULL},
+    {9, 0x572b84c18b983af8ULL, 0x5495aa796de8ab73ULL, 0x7c20df9712c26edfULL},
+    {16, 0x94ad0095e72b24d5ULL, 0x3f8fea7c86a04013ULL, 0x86abf6baccea0858ULL},
+    {17, 0x1464f2eff23b5fe1ULL, 0xe5044d205f3d2f74ULL, 0xb58bf5dc5022d071ULL},
+    {128, 0x0430e433b792e757ULL, 0xa17ef243ce1ff792ULL, 0x10d17f72c0ccba41ULL},
+    {129, 0x1f9708e5a00618faULL, 0xb5d711b6226e05b6ULL, 0x1648bdc3db49d1a2ULL},
+    {240, 0xca0b65cc61295ca7ULL, 0x85e504429b241d4fULL, 0xb6cfaf343fab81e6ULL},
+    {241, 0x0ffefe0dfc875cf4ULL, 0x537b9610b2f8022dULL, 0x956cae592c67279eULL},
+    {1024, 0x5960af0c625acfb7ULL, 0xfe426926c35c85aaULL, 0x70bd377d9574f4bbULL},
+    {2048, 0xafd8cdfc2fae9426ULL, 0x16144a883eac0474ULL, 0x8b46caa67dab3a30ULL},
+};
+
+std::string TestData() {
+  std::string data;
+  for (int i = 0; i < 2048; i++) {
+    data.push_back(static_cast<char>(i * 131 + 7));
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST_F(XXHashTest, StandardResults) {
+  const std::string data = TestData();
+  for (const auto& r : kResults) {
+    ASSERT_EQ(r.xxh64, XXH64(data.data(), r.n, 0)) << r.n;
+    ASSERT_EQ(r.xxh64_seeded, XXH64(data.data(), r.n, 0x9E3779B97F4A7C15ULL))
+        << r.n;
+    ASSERT_EQ(r.xxh3, XXH3_64bits(data.data(), r.n)) << r.n;
+  }
+}
+
+TEST_F(XXHashTest, Unaligned) {
+  const std::string data = TestData();
+  std::string shifted = "x" + data;
+  for (size_t n = 0; n <= 1024; n++) {
+    ASSERT_EQ(XXH64(data.data(), n, 0), XXH64(shifted.data() + 1, n, 0));
+    ASSERT_EQ(XXH3_64bits(data.data(), n),
+              XXH3_64bits(shifted.data() + 1, n));
+  }
+}
+
+TEST_F(XXHashTest, Values) {
+  ASSERT_NE(XXH64("a", 1, 0), XXH64("foo", 3, 0));
+  ASSERT_NE(XXH64("a", 1, 0), XXH64("a", 1, 1));
+  ASSERT_NE(XXH3_64bits("a", 1), XXH3_64bits("foo", 3));
+}
+
+}  // namespace xxhash
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
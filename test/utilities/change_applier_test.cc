@@ -0,0 +1,273 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "vidardb/utilities/change_applier.h"
+#include "vidardb/utilities/transaction.h"
+#include "vidardb/utilities/transaction_db.h"
+
+namespace vidardb {
+
+// Replicates a leader DB to a follower DB of another directory, over the
+// loopback of a change stream
+class ChangeApplierTest : public testing::Test {
+ public:
+  ChangeApplierTest() : leader_(nullptr), follower_(nullptr) {
+    leader_name_ = test::TmpDir() + "/change_applier_test_leader";
+    follower_name_ = test::TmpDir() + "/change_applier_test_follower";
+    options_.create_if_missing = true;
+    options_.WAL_ttl_seconds = 1000;
+    DestroyDB(leader_name_, options_);
+    DestroyFollower();
+    EXPECT_OK(DB::Open(options_, leader_name_, &leader_));
+    EXPECT_OK(DB::Open(options_, follower_name_, &follower_));
+  }
+
+  ~ChangeApplierTest() {
+    applier_.reset();
+    delete leader_;
+    delete follower_;
+    DestroyDB(leader_name_, options_);
+    DestroyFollower();
+  }
+
+  // DestroyDB() leaves the checkpoint of the applier
+  void DestroyFollower() {
+    Env::Default()->DeleteFile(follower_name_ + "/CHANGE_APPLIER");
+    DestroyDB(follower_name_, options_);
+  }
+
+  // Applies the whole stream of the leader from the sequence number after
+  // the last one applied, in chunks of about chunk_bytes
+  void Replicate(size_t chunk_bytes = 1 << 20) {
+    ChangeStreamOptions stream_options;
+    stream_options.max_chunk_bytes = chunk_bytes;
+    std::unique_ptr<ChangeStream> stream;
+    ASSERT_OK(leader_->NewChangeStream(applier_->AppliedSequence() + 1,
+                                       &stream, stream_options));
+    std::vector<ChangeRecord> records;
+    while (true) {
+      ASSERT_OK(stream->Next(&records));
+      if (records.empty()) {
+        break;
+      }
+      ASSERT_OK(applier_->Apply(records));
+    }
+    ASSERT_EQ(leader_->GetLatestSequenceNumber(), applier_->AppliedSequence());
+  }
+
+  static std::vector<std::string> Contents(DB* db, ColumnFamilyHandle* cf) {
+    std::vector<std::string> contents;
+    std::unique_ptr<Iterator> iter(db->NewIterator(ReadOptions(), cf));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      contents.push_back(iter->key().ToString() + "=" +
+                         iter->value().ToString());
+    }
+    EXPECT_OK(iter->status());
+    return contents;
+  }
+
+  void AssertReplicated() {
+    ASSERT_EQ(Contents(leader_, leader_->DefaultColumnFamily()),
+              Contents(follower_, follower_->DefaultColumnFamily()));
+  }
+
+  std::string leader_name_;
+  std::string follower_name_;
+  Options options_;
+  DB* leader_;
+  DB* follower_;
+  std::unique_ptr<ChangeApplier> applier_;
+};
+
+TEST_F(ChangeApplierTest, ApplyByKeyHash) {
+  ChangeApplierOptions applier_options;
+  ASSERT_OK(ChangeApplier::Open(applier_options, follower_, &applier_));
+  ASSERT_EQ(0U, applier_->AppliedSequence());
+
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(leader_->Put(WriteOptions(), "key" + ToString(i),
+                           "value" + ToString(i)));
+  }
+  WriteBatch batch;
+  for (int i = 0; i < 1000; i += 3) {
+    batch.Delete("key" + ToString(i));
+    batch.Put("key" + ToString(i + 1), "overwritten" + ToString(i + 1));
+  }
+  ASSERT_OK(leader_->Write(WriteOptions(), &batch));
+  // small chunks spread the updates of a key over several calls
+  Replicate(4096);
+  AssertReplicated();
+
+  // the applier goes on from the last sequence number applied
+  ASSERT_OK(leader_->Put(WriteOptions(), "key0", "back"));
+  ASSERT_OK(leader_->Delete(WriteOptions(), "key2"));
+  Replicate();
+  AssertReplicated();
+  ASSERT_EQ(667U,
+            Contents(follower_, follower_->DefaultColumnFamily()).size());
+}
+
+TEST_F(ChangeApplierTest, ApplyByColumnFamily) {
+  std::vector<std::string> names = {"one", "two", "three"};
+  std::vector<ColumnFamilyHandle*> leader_handles;
+  std::vector<ColumnFamilyHandle*> follower_handles;
+  for (const auto& name : names) {
+    ColumnFamilyHandle* handle;
+    ASSERT_OK(leader_->CreateColumnFamily(options_, name, &handle));
+    leader_handles.push_back(handle);
+    ASSERT_OK(follower_->CreateColumnFamily(options_, name, &handle));
+    follower_handles.push_back(handle);
+  }
+
+  ChangeApplierOptions applier_options;
+  applier_options.num_threads = 2;
+  applier_options.partitioning = ChangeApplierOptions::kByColumnFamily;
+  applier_options.column_families[0] = follower_->DefaultColumnFamily();
+  for (size_t i = 0; i < names.size(); i++) {
+    applier_options.column_families[leader_handles[i]->GetID()] =
+        follower_handles[i];
+  }
+  ASSERT_OK(ChangeApplier::Open(applier_options, follower_, &applier_));
+
+  for (int i = 0; i < 300; i++) {
+    WriteBatch batch;
+    batch.Put("key" + ToString(i), "default" + ToString(i));
+    batch.Put(leader_handles[i % 3], "key" + ToString(i), ToString(i % 3));
+    if (i % 10 == 0) {
+      batch.Delete(leader_handles[(i + 1) % 3], "key" + ToString(i - 9));
+    }
+    ASSERT_OK(leader_->Write(WriteOptions(), &batch));
+  }
+  Replicate(1024);
+  AssertReplicated();
+  for (size_t i = 0; i < names.size(); i++) {
+    ASSERT_EQ(Contents(leader_, leader_handles[i]),
+              Contents(follower_, follower_handles[i]));
+  }
+
+  // the updates of an unmapped column family fail the chunk
+  ColumnFamilyHandle* unmapped;
+  ASSERT_OK(leader_->CreateColumnFamily(options_, "four", &unmapped));
+  ASSERT_OK(leader_->Put(WriteOptions(), unmapped, "key", "value"));
+  SequenceNumber applied = applier_->AppliedSequence();
+  std::unique_ptr<ChangeStream> stream;
+  ASSERT_OK(leader_->NewChangeStream(applied + 1, &stream));
+  std::vector<ChangeRecord> records;
+  ASSERT_OK(stream->Next(&records));
+  ASSERT_FALSE(applier_->Apply(records).ok());
+  ASSERT_EQ(applied, applier_->AppliedSequence());
+  stream.reset();
+
+  applier_.reset();
+  for (auto handle : leader_handles) {
+    delete handle;
+  }
+  for (auto handle : follower_handles) {
+    delete handle;
+  }
+  delete unmapped;
+}
+
+TEST_F(ChangeApplierTest, ResumeAfterReopen) {
+  ChangeApplierOptions applier_options;
+  ASSERT_OK(ChangeApplier::Open(applier_options, follower_, &applier_));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(leader_->Put(WriteOptions(), "key" + ToString(i), "first"));
+  }
+  Replicate();
+  SequenceNumber applied = applier_->AppliedSequence();
+  ASSERT_EQ(100U, applied);
+
+  // the checkpoint is read back by the applier of the reopened follower
+  applier_.reset();
+  delete follower_;
+  ASSERT_OK(DB::Open(options_, follower_name_, &follower_));
+  ASSERT_OK(ChangeApplier::Open(applier_options, follower_, &applier_));
+  ASSERT_EQ(applied, applier_->AppliedSequence());
+
+  for (int i = 0; i < 100; i += 2) {
+    ASSERT_OK(leader_->Put(WriteOptions(), "key" + ToString(i), "second"));
+  }
+  Replicate();
+  AssertReplicated();
+
+  // replaying the chunks already applied skips their updates
+  ASSERT_OK(follower_->Put(WriteOptions(), "key1", "follower"));
+  std::unique_ptr<ChangeStream> stream;
+  ASSERT_OK(leader_->NewChangeStream(1, &stream));
+  std::vector<ChangeRecord> records;
+  ASSERT_OK(stream->Next(&records));
+  ASSERT_FALSE(records.empty());
+  ASSERT_OK(applier_->Apply(records));
+  ReadOptions ro;
+  std::string value;
+  ASSERT_OK(follower_->Get(ro, "key1", &value));
+  ASSERT_EQ("follower", value);
+}
+
+TEST_F(ChangeApplierTest, TwoPhaseCommitNotSupported) {
+  delete leader_;
+  leader_ = nullptr;
+  DestroyDB(leader_name_, options_);
+  Options options = options_;
+  options.allow_2pc = true;
+  TransactionDB* txn_db;
+  ASSERT_OK(TransactionDB::Open(options, TransactionDBOptions(), leader_name_,
+                                &txn_db));
+  leader_ = txn_db;
+
+  ChangeApplierOptions applier_options;
+  ASSERT_OK(ChangeApplier::Open(applier_options, follower_, &applier_));
+  ASSERT_OK(leader_->Put(WriteOptions(), "before", "value"));
+  Replicate();
+
+  Transaction* txn = txn_db->BeginTransaction(WriteOptions());
+  ASSERT_OK(txn->SetName("xid"));
+  ASSERT_OK(txn->Put("key", "value"));
+  ASSERT_OK(txn->Prepare());
+  ASSERT_OK(txn->Commit());
+  delete txn;
+  ASSERT_OK(leader_->Put(WriteOptions(), "after", "value"));
+
+  // none of the chunk is applied
+  SequenceNumber applied = applier_->AppliedSequence();
+  std::unique_ptr<ChangeStream> stream;
+  ASSERT_OK(leader_->NewChangeStream(applied + 1, &stream));
+  std::vector<ChangeRecord> records;
+  ASSERT_OK(stream->Next(&records));
+  ASSERT_FALSE(records.empty());
+  ASSERT_TRUE(applier_->Apply(records).IsNotSupported());
+  ASSERT_EQ(applied, applier_->AppliedSequence());
+  ReadOptions ro;
+  std::string value;
+  ASSERT_TRUE(follower_->Get(ro, "key", &value).IsNotFound());
+  ASSERT_TRUE(follower_->Get(ro, "after", &value).IsNotFound());
+  ASSERT_OK(follower_->Get(ro, "before", &value));
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+  fprintf(stderr, "SKIPPED as ChangeApplier is not supported in VIDARDB_LITE\n");
+  return 0;
+}
+
+#endif  // !VIDARDB_LITE
@@ -0,0 +1,280 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "utilities/indexed_db/indexed_db_impl.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "vidardb/splitter.h"
+#include "vidardb/utilities/indexed_db.h"
+
+namespace vidardb {
+
+class IndexedDBTest : public testing::Test {
+ public:
+  IndexedDBTest() : db_(nullptr) {
+    dbname_ = test::TmpDir() + "/indexed_db_test";
+    options_.create_if_missing = true;
+    options_.splitter.reset(NewPipeSplitter());
+    DestroyDB(dbname_, options_);
+    Reopen();
+  }
+
+  ~IndexedDBTest() {
+    Close();
+    DestroyDB(dbname_, options_);
+  }
+
+  void Close() {
+    delete db_;
+    db_ = nullptr;
+  }
+
+  void Reopen() {
+    Close();
+    ASSERT_OK(IndexedDB::Open(options_, dbname_, &db_));
+  }
+
+  static std::string Row(const std::string& a, const std::string& b,
+                         const std::string& c) {
+    return a + "|" + b + "|" + c;
+  }
+
+  // The keys of the rows whose column is within [start, limit], in batches
+  // of capacity bytes
+  std::vector<std::string> QueryKeys(uint32_t column, const Slice& start,
+                                     const Slice& limit,
+                                     size_t capacity = 0) {
+    ReadOptions ro;
+    ro.batch_capacity = capacity;
+    ro.columns = {0};
+    std::list<RangeQueryKeyVal> res;
+    std::vector<std::string> keys;
+    Status s;
+    bool next;
+    do {
+      next = db_->RangeQueryByIndex(ro, db_->DefaultColumnFamily(), column,
+                                    Range(start, limit), res, &s);
+      EXPECT_OK(s);
+      for (const auto& kv : res) {
+        keys.push_back(kv.user_key);
+      }
+    } while (next);
+    return keys;
+  }
+
+  // The entries of the index on column, read with a plain DB
+  std::vector<std::string> IndexEntries(uint32_t column) {
+    Close();
+    std::vector<ColumnFamilyDescriptor> column_families;
+    column_families.emplace_back(kDefaultColumnFamilyName, options_);
+    std::string index_name = IndexedDBImpl::IndexColumnFamilyName(
+        column, kDefaultColumnFamilyName);
+    column_families.emplace_back(index_name, options_);
+    std::vector<ColumnFamilyHandle*> handles;
+    DB* db;
+    EXPECT_OK(DB::Open(options_, dbname_, column_families, &handles, &db));
+    std::vector<std::string> entries;
+    Iterator* iter = db->NewIterator(ReadOptions(), handles[1]);
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      entries.push_back(iter->key().ToString());
+    }
+    EXPECT_OK(iter->status());
+    delete iter;
+    for (auto handle : handles) {
+      delete handle;
+    }
+    delete db;
+    Reopen();
+    return entries;
+  }
+
+  std::string dbname_;
+  Options options_;
+  IndexedDB* db_;
+};
+
+TEST_F(IndexedDBTest, CreateIndex) {
+  ASSERT_OK(db_->Put(WriteOptions(), "k1", Row("a", "red", "1")));
+  ASSERT_OK(db_->Put(WriteOptions(), "k2", Row("b", "blue", "2")));
+
+  ColumnFamilyHandle* cf = db_->DefaultColumnFamily();
+  ASSERT_TRUE(db_->CreateIndex(cf, 0).IsInvalidArgument());
+  ASSERT_OK(db_->CreateIndex(cf, 2));
+  ASSERT_TRUE(db_->CreateIndex(cf, 2).IsInvalidArgument());
+
+  // the rows already there are indexed
+  ASSERT_EQ(std::vector<std::string>({"k1"}), QueryKeys(2, "red", "red"));
+  ASSERT_EQ(std::vector<std::string>({"k2"}), QueryKeys(2, "blue", "blue"));
+
+  ReadOptions ro;
+  std::list<RangeQueryKeyVal> res;
+  Status s;
+  ASSERT_FALSE(db_->RangeQueryByIndex(ro, cf, 3, Range(), res, &s));
+  ASSERT_TRUE(s.IsNotFound());
+
+  // the index is opened again with the DB
+  Reopen();
+  ASSERT_OK(db_->Put(WriteOptions(), "k3", Row("c", "red", "3")));
+  ASSERT_EQ(std::vector<std::string>({"k1", "k3"}),
+            QueryKeys(2, "red", "red"));
+
+  ASSERT_OK(db_->DropIndex(db_->DefaultColumnFamily(), 2));
+  ASSERT_TRUE(db_->DropIndex(db_->DefaultColumnFamily(), 2).IsNotFound());
+  res.clear();
+  ASSERT_FALSE(db_->RangeQueryByIndex(ro, db_->DefaultColumnFamily(), 2,
+                                      Range(), res, &s));
+  ASSERT_TRUE(s.IsNotFound());
+}
+
+TEST_F(IndexedDBTest, PutOverwriteDelete) {
+  ASSERT_OK(db_->CreateIndex(db_->DefaultColumnFamily(), 2));
+  ASSERT_OK(db_->Put(WriteOptions(), "k1", Row("a", "red", "1")));
+  ASSERT_OK(db_->Put(WriteOptions(), "k2", Row("b", "red", "2")));
+  ASSERT_OK(db_->Put(WriteOptions(), "k3", Row("c", "blue", "3")));
+  WriteBatch batch;
+  batch.Put("k4", Row("d", "green", "4"));
+  batch.Put("k5", Row("e", "red", "5"));
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+  ASSERT_EQ(std::vector<std::string>({"k1", "k2", "k5"}),
+            QueryKeys(2, "red", "red"));
+
+  // overwritten and deleted rows are not returned for their old values
+  ASSERT_OK(db_->Put(WriteOptions(), "k2", Row("b", "blue", "2")));
+  ASSERT_OK(db_->Delete(WriteOptions(), "k5"));
+  ASSERT_EQ(std::vector<std::string>({"k1"}), QueryKeys(2, "red", "red"));
+  ASSERT_EQ(std::vector<std::string>({"k2", "k3"}),
+            QueryKeys(2, "blue", "blue"));
+
+  // overwriting with the same column value returns the row once
+  ASSERT_OK(db_->Put(WriteOptions(), "k1", Row("z", "red", "9")));
+  ASSERT_EQ(std::vector<std::string>({"k1"}), QueryKeys(2, "red", "red"));
+
+  // the ranges include both ends
+  ASSERT_EQ(std::vector<std::string>({"k1", "k2", "k3", "k4"}),
+            QueryKeys(2, "blue", "red"));
+  ASSERT_EQ(std::vector<std::string>({"k2", "k3", "k4"}),
+            QueryKeys(2, kRangeQueryMin, "green"));
+  ASSERT_EQ(std::vector<std::string>({"k1", "k4"}),
+            QueryKeys(2, "c", kRangeQueryMax));
+  ASSERT_TRUE(QueryKeys(2, "purple", "purple").empty());
+}
+
+TEST_F(IndexedDBTest, PutColumns) {
+  ASSERT_OK(db_->CreateIndex(db_->DefaultColumnFamily(), 2));
+  std::vector<Slice> columns = {"a", "red", "1"};
+  ASSERT_OK(db_->PutColumns(WriteOptions(), "k1", columns));
+  ASSERT_EQ(std::vector<std::string>({"k1"}), QueryKeys(2, "red", "red"));
+}
+
+TEST_F(IndexedDBTest, Projection) {
+  ASSERT_OK(db_->CreateIndex(db_->DefaultColumnFamily(), 2));
+  ASSERT_OK(db_->Put(WriteOptions(), "k1", Row("a", "red", "1")));
+  ASSERT_OK(db_->Put(WriteOptions(), "k2", Row("b", "red", "2")));
+
+  ReadOptions ro;
+  ro.columns = {3, 1};
+  std::list<RangeQueryKeyVal> res;
+  Status s;
+  ASSERT_FALSE(db_->RangeQueryByIndex(ro, db_->DefaultColumnFamily(), 2,
+                                      Range("red", "red"), res, &s));
+  ASSERT_OK(s);
+  ASSERT_EQ(2U, res.size());
+  ASSERT_EQ("k1", res.front().user_key);
+  ASSERT_EQ("1|a", res.front().user_val);
+  ASSERT_EQ("k2", res.back().user_key);
+  ASSERT_EQ("2|b", res.back().user_val);
+}
+
+TEST_F(IndexedDBTest, BatchCapacity) {
+  ASSERT_OK(db_->CreateIndex(db_->DefaultColumnFamily(), 2));
+  std::vector<std::string> expected;
+  for (int i = 0; i < 100; i++) {
+    std::string key = "key" + ToString(1000 + i);
+    ASSERT_OK(db_->Put(WriteOptions(), key,
+                       Row(ToString(i), i % 2 ? "odd" : "even", "x")));
+    if (i % 2 == 0) {
+      expected.push_back(key);
+    }
+  }
+  ASSERT_EQ(expected, QueryKeys(2, "even", "even"));
+
+  ReadOptions ro;
+  ro.batch_capacity = 50;
+  std::list<RangeQueryKeyVal> res;
+  std::vector<std::string> keys;
+  Status s;
+  int batches = 0;
+  bool next;
+  do {
+    next = db_->RangeQueryByIndex(ro, db_->DefaultColumnFamily(), 2,
+                                  Range("even", "even"), res, &s);
+    ASSERT_OK(s);
+    ASSERT_FALSE(res.empty());
+    size_t size = 0;
+    for (const auto& kv : res) {
+      size += kv.user_key.size() + kv.user_val.size();
+      keys.push_back(kv.user_key);
+    }
+    ASSERT_LE(size, ro.batch_capacity);
+    ASSERT_EQ(size, ro.result_key_size + ro.result_val_size);
+    batches++;
+    // the batches read from the snapshot of the first one
+    ASSERT_OK(db_->Put(WriteOptions(), "key0000", Row("-", "even", "x")));
+  } while (next);
+  ASSERT_EQ(expected, keys);
+  ASSERT_GT(batches, 10);
+  ASSERT_TRUE(ro.range_query_meta == nullptr);
+
+  // a row larger than the capacity makes a batch of its own
+  ASSERT_EQ(expected.size() + 1, QueryKeys(2, "even", "even", 1).size());
+}
+
+TEST_F(IndexedDBTest, CompactionFilterDropsStaleEntries) {
+  ASSERT_OK(db_->CreateIndex(db_->DefaultColumnFamily(), 2));
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(db_->Put(WriteOptions(), "k" + ToString(i),
+                       Row("a", "old" + ToString(i), "1")));
+  }
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  for (int i = 0; i < 5; i++) {
+    ASSERT_OK(db_->Put(WriteOptions(), "k" + ToString(i),
+                       Row("a", "new" + ToString(i), "1")));
+  }
+  ASSERT_OK(db_->Delete(WriteOptions(), "k9"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+
+  // the stale entries stay until the index is compacted
+  ASSERT_EQ(15U, IndexEntries(2).size());
+  ASSERT_EQ(4U, QueryKeys(2, "old", "oldz").size());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::vector<std::string> entries = IndexEntries(2);
+  ASSERT_EQ(9U, entries.size());
+  ASSERT_EQ(4U, QueryKeys(2, "old", "oldz").size());
+  ASSERT_EQ(5U, QueryKeys(2, "new", "newz").size());
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+  fprintf(stderr, "SKIPPED as IndexedDB is not supported in VIDARDB_LITE\n");
+  return 0;
+}
+
+#endif  // !VIDARDB_LITE
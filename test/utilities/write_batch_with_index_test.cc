@@ -0,0 +1,187 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "vidardb/comparator.h"
+#include "vidardb/db.h"
+#include "vidardb/utilities/write_batch_with_index.h"
+
+namespace vidardb {
+
+// Checks the hash index of WriteBatchWithIndex against the skiplist path
+class WriteBatchWithIndexTest : public testing::Test {
+ public:
+  WriteBatchWithIndexTest() : db_(nullptr) {
+    dbname_ = test::TmpDir() + "/write_batch_with_index_test";
+    options_.create_if_missing = true;
+    DestroyDB(dbname_, options_);
+    EXPECT_OK(DB::Open(options_, dbname_, &db_));
+    ColumnFamilyOptions reverse_options;
+    reverse_options.comparator = ReverseBytewiseComparator();
+    ColumnFamilyHandle* handle;
+    EXPECT_OK(db_->CreateColumnFamily(reverse_options, "reverse", &handle));
+    handles_.push_back(db_->DefaultColumnFamily());
+    handles_.push_back(handle);
+  }
+
+  ~WriteBatchWithIndexTest() {
+    delete handles_[1];
+    delete db_;
+    DestroyDB(dbname_, options_);
+  }
+
+  static std::string Key(int i) { return "key" + ToString(i); }
+
+  // The entries of batch in handle, as seen by its iterator
+  static std::vector<std::string> Entries(WriteBatchWithIndex* batch,
+                                          ColumnFamilyHandle* handle) {
+    std::vector<std::string> entries;
+    std::unique_ptr<WBWIIterator> iter(batch->NewIterator(handle));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      WriteEntry entry = iter->Entry();
+      entries.push_back(entry.key.ToString() + ":" +
+                        ToString(static_cast<int>(entry.type)) + ":" +
+                        entry.value.ToString());
+    }
+    EXPECT_OK(iter->status());
+    return entries;
+  }
+
+  // Applies the same random updates to the batches, checking their point
+  // lookups and their entries agree after each of them
+  void RandomUpdates(WriteBatchWithIndex* plain, WriteBatchWithIndex* hashed,
+                     int num_keys, int num_updates) {
+    Random rnd(301);
+    ReadOptions ro;
+    int save_points = 0;
+    for (int i = 0; i < num_updates; i++) {
+      ColumnFamilyHandle* handle = handles_[rnd.Uniform(2)];
+      std::string key = Key(rnd.Uniform(num_keys));
+      int op = rnd.Uniform(20);
+      if (op < 12) {
+        std::string value = "v" + ToString(i);
+        plain->Put(handle, key, value);
+        hashed->Put(handle, key, value);
+      } else if (op < 17) {
+        plain->Delete(handle, key);
+        hashed->Delete(handle, key);
+      } else if (op < 19) {
+        plain->SetSavePoint();
+        hashed->SetSavePoint();
+        save_points++;
+      } else if (save_points > 0) {
+        ASSERT_OK(plain->RollbackToSavePoint());
+        ASSERT_OK(hashed->RollbackToSavePoint());
+        save_points--;
+      }
+
+      for (int k = 0; k < num_keys; k++) {
+        for (auto h : handles_) {
+          std::string expected;
+          std::string value;
+          Status s1 = plain->GetFromBatchAndDB(db_, ro, h, Key(k), &expected);
+          Status s2 = hashed->GetFromBatchAndDB(db_, ro, h, Key(k), &value);
+          ASSERT_EQ(s1.ToString(), s2.ToString());
+          if (s1.ok()) {
+            ASSERT_EQ(expected, value);
+          }
+        }
+      }
+    }
+    for (auto h : handles_) {
+      ASSERT_EQ(Entries(plain, h), Entries(hashed, h));
+    }
+  }
+
+  std::string dbname_;
+  Options options_;
+  DB* db_;
+  std::vector<ColumnFamilyHandle*> handles_;
+};
+
+TEST_F(WriteBatchWithIndexTest, HashIndexMatchesSkipList) {
+  // half of the keys are in the DB too
+  for (int k = 0; k < 30; k += 2) {
+    ASSERT_OK(db_->Put(WriteOptions(), handles_[0], Key(k), "db"));
+    ASSERT_OK(db_->Put(WriteOptions(), handles_[1], Key(k), "db"));
+  }
+  WriteBatchWithIndex plain(BytewiseComparator(), 0, false, false);
+  WriteBatchWithIndex hashed(BytewiseComparator(), 0, false, true);
+  RandomUpdates(&plain, &hashed, 30, 500);
+}
+
+TEST_F(WriteBatchWithIndexTest, HashIndexMatchesSkipListOverwriteKey) {
+  for (int k = 0; k < 30; k += 3) {
+    ASSERT_OK(db_->Put(WriteOptions(), handles_[0], Key(k), "db"));
+  }
+  WriteBatchWithIndex plain(BytewiseComparator(), 0, true, false);
+  WriteBatchWithIndex hashed(BytewiseComparator(), 0, true, true);
+  RandomUpdates(&plain, &hashed, 30, 500);
+
+  // the iterators with base read the overwritten entries the same way
+  for (auto h : handles_) {
+    std::unique_ptr<Iterator> plain_iter(
+        plain.NewIteratorWithBase(h, db_->NewIterator(ReadOptions(), h)));
+    std::unique_ptr<Iterator> hashed_iter(
+        hashed.NewIteratorWithBase(h, db_->NewIterator(ReadOptions(), h)));
+    for (plain_iter->SeekToFirst(), hashed_iter->SeekToFirst();
+         plain_iter->Valid(); plain_iter->Next(), hashed_iter->Next()) {
+      ASSERT_TRUE(hashed_iter->Valid());
+      ASSERT_EQ(plain_iter->key(), hashed_iter->key());
+      ASSERT_EQ(plain_iter->value(), hashed_iter->value());
+    }
+    ASSERT_FALSE(hashed_iter->Valid());
+  }
+}
+
+TEST_F(WriteBatchWithIndexTest, HashIndexCleared) {
+  WriteBatchWithIndex batch(BytewiseComparator(), 0, true, true);
+  ReadOptions ro;
+  std::string value;
+  batch.Put("a", "1");
+  ASSERT_OK(batch.GetFromBatchAndDB(db_, ro, "a", &value));
+  ASSERT_EQ("1", value);
+
+  batch.Clear();
+  ASSERT_TRUE(batch.GetFromBatchAndDB(db_, ro, "a", &value).IsNotFound());
+  batch.Put("a", "2");
+  batch.SetSavePoint();
+  batch.Put("a", "3");
+  batch.Delete("b");
+  ASSERT_OK(batch.GetFromBatchAndDB(db_, ro, "a", &value));
+  ASSERT_EQ("3", value);
+  ASSERT_OK(batch.RollbackToSavePoint());
+  ASSERT_OK(batch.GetFromBatchAndDB(db_, ro, "a", &value));
+  ASSERT_EQ("2", value);
+  ASSERT_OK(db_->Put(WriteOptions(), "b", "db"));
+  ASSERT_OK(batch.GetFromBatchAndDB(db_, ro, "b", &value));
+  ASSERT_EQ("db", value);
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+  fprintf(stderr,
+          "SKIPPED as WriteBatchWithIndex is not supported in VIDARDB_LITE\n");
+  return 0;
+}
+
+#endif  // !VIDARDB_LITE
@@ -0,0 +1,268 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "vidardb/utilities/transaction.h"
+#include "vidardb/utilities/transaction_db.h"
+
+namespace vidardb {
+
+class WritePreparedTxnDBTest : public testing::Test {
+ public:
+  WritePreparedTxnDBTest() : db_(nullptr) {
+    dbname_ = test::TmpDir() + "/write_prepared_txn_db_test";
+    options_.create_if_missing = true;
+    txn_db_options_.write_policy = WRITE_PREPARED;
+    DestroyDB(dbname_, options_);
+    Reopen();
+  }
+
+  ~WritePreparedTxnDBTest() {
+    Close();
+    DestroyDB(dbname_, options_);
+  }
+
+  void Close() {
+    delete db_;
+    db_ = nullptr;
+  }
+
+  void Reopen() {
+    Close();
+    ASSERT_OK(TransactionDB::Open(options_, txn_db_options_, dbname_, &db_));
+  }
+
+  std::string Get(const std::string& key, const Snapshot* snapshot = nullptr) {
+    ReadOptions ro;
+    ro.snapshot = snapshot;
+    std::string value;
+    Status s = db_->Get(ro, key, &value);
+    if (s.IsNotFound()) {
+      return "NOT_FOUND";
+    }
+    EXPECT_OK(s);
+    return value;
+  }
+
+  // The key=value pairs seen by an iterator at snapshot
+  std::string Scan(const Snapshot* snapshot = nullptr) {
+    ReadOptions ro;
+    ro.snapshot = snapshot;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    std::string result;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      result += iter->key().ToString() + "=" + iter->value().ToString() + " ";
+    }
+    EXPECT_OK(iter->status());
+    return result;
+  }
+
+  Transaction* Prepare(const std::string& name,
+                       const std::vector<std::string>& keys,
+                       const std::string& value) {
+    Transaction* txn = db_->BeginTransaction(WriteOptions());
+    EXPECT_OK(txn->SetName(name));
+    for (const auto& key : keys) {
+      EXPECT_OK(txn->Put(key, value));
+    }
+    EXPECT_OK(txn->Prepare());
+    return txn;
+  }
+
+  uint64_t NumSnapshots() {
+    uint64_t num;
+    EXPECT_TRUE(db_->GetIntProperty(DB::Properties::kNumSnapshots, &num));
+    return num;
+  }
+
+  std::string dbname_;
+  Options options_;
+  TransactionDBOptions txn_db_options_;
+  TransactionDB* db_;
+};
+
+TEST_F(WritePreparedTxnDBTest, PreparedDataVisibility) {
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "old"));
+  Transaction* txn = Prepare("xid", {"a", "b"}, "new");
+
+  // the prepared data is in the memtable, but not committed
+  ASSERT_EQ("old", Get("a"));
+  ASSERT_EQ("NOT_FOUND", Get("b"));
+  ASSERT_EQ("a=old ", Scan());
+  const Snapshot* before = db_->GetSnapshot();
+
+  ASSERT_OK(txn->Commit());
+  delete txn;
+  ASSERT_EQ("new", Get("a"));
+  ASSERT_EQ("new", Get("b"));
+  ASSERT_EQ("a=new b=new ", Scan());
+
+  // a snapshot taken before the commit does not see it
+  ASSERT_EQ("old", Get("a", before));
+  ASSERT_EQ("NOT_FOUND", Get("b", before));
+  ASSERT_EQ("a=old ", Scan(before));
+  const Snapshot* after = db_->GetSnapshot();
+  ASSERT_EQ("a=new b=new ", Scan(after));
+
+  // nor once the data is flushed and compacted
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("a=old ", Scan(before));
+  ASSERT_EQ("a=new b=new ", Scan(after));
+  db_->ReleaseSnapshot(before);
+  db_->ReleaseSnapshot(after);
+}
+
+TEST_F(WritePreparedTxnDBTest, Rollback) {
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "old"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  Transaction* txn = Prepare("xid", {"a", "b"}, "new");
+  ASSERT_OK(txn->Rollback());
+  delete txn;
+  ASSERT_EQ("old", Get("a"));
+  ASSERT_EQ("NOT_FOUND", Get("b"));
+  ASSERT_EQ("a=old ", Scan());
+
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("a=old ", Scan());
+
+  // the rolled back keys can be written again
+  txn = Prepare("xid2", {"b"}, "again");
+  ASSERT_OK(txn->Commit());
+  delete txn;
+  ASSERT_EQ("a=old b=again ", Scan());
+}
+
+TEST_F(WritePreparedTxnDBTest, RecoverPrepared) {
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "old"));
+  Transaction* txn = Prepare("xid", {"a", "b"}, "new");
+  delete txn;
+  Transaction* flushed = Prepare("xid2", {"c"}, "flushed");
+  delete flushed;
+  ASSERT_OK(db_->Flush(FlushOptions()));
+
+  Reopen();
+  ASSERT_EQ("a=old ", Scan());
+  std::vector<Transaction*> txns;
+  db_->GetAllPreparedTransactions(&txns);
+  ASSERT_EQ(2U, txns.size());
+
+  // the recovered data is still in its place, and kept by the compactions
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  txn = db_->GetTransactionByName("xid");
+  ASSERT_TRUE(txn != nullptr);
+  ASSERT_OK(txn->Commit());
+  delete txn;
+  ASSERT_EQ("a=new b=new ", Scan());
+  flushed = db_->GetTransactionByName("xid2");
+  ASSERT_TRUE(flushed != nullptr);
+  ASSERT_OK(flushed->Rollback());
+  delete flushed;
+  ASSERT_EQ("a=new b=new ", Scan());
+
+  // the commit is recovered too
+  Reopen();
+  ASSERT_EQ("a=new b=new ", Scan());
+  txns.clear();
+  db_->GetAllPreparedTransactions(&txns);
+  ASSERT_TRUE(txns.empty());
+  ASSERT_OK(db_->Put(WriteOptions(), "d", "after"));
+  ASSERT_EQ("a=new b=new d=after ", Scan());
+}
+
+TEST_F(WritePreparedTxnDBTest, CommitTableCleanup) {
+  // a prepared transaction guards the versions it replaces with a snapshot,
+  // which is released once no snapshot needs its entry any more
+  ASSERT_EQ(0U, NumSnapshots());
+  Transaction* txn = Prepare("xid", {"a"}, "1");
+  ASSERT_EQ(1U, NumSnapshots());
+  ASSERT_OK(txn->Commit());
+  delete txn;
+  ASSERT_EQ(0U, NumSnapshots());
+
+  txn = Prepare("xid2", {"a"}, "2");
+  const Snapshot* between = db_->GetSnapshot();
+  ASSERT_OK(txn->Commit());
+  delete txn;
+  ASSERT_EQ(2U, NumSnapshots());
+  ASSERT_EQ("1", Get("a", between));
+  db_->ReleaseSnapshot(between);
+  ASSERT_EQ(0U, NumSnapshots());
+  ASSERT_EQ("2", Get("a"));
+
+  txn = Prepare("xid3", {"a"}, "3");
+  ASSERT_OK(txn->Rollback());
+  delete txn;
+  ASSERT_EQ(0U, NumSnapshots());
+  ASSERT_EQ("2", Get("a"));
+}
+
+TEST_F(WritePreparedTxnDBTest, CloseWithLiveTransactions) {
+  // the transactions left open are deleted with the DB, named or expirable
+  Prepare("xid", {"a"}, "named");
+  TransactionOptions txn_options;
+  txn_options.expiration = 100000;
+  Transaction* expirable = db_->BeginTransaction(WriteOptions(), txn_options);
+  ASSERT_OK(expirable->Put("b", "expirable"));
+  Transaction* both = db_->BeginTransaction(WriteOptions(), txn_options);
+  ASSERT_OK(both->SetName("xid2"));
+  ASSERT_OK(both->Put("c", "both"));
+  ASSERT_OK(both->Prepare());
+
+  // the prepared ones are recovered
+  Reopen();
+  ASSERT_EQ("", Scan());
+  std::vector<Transaction*> txns;
+  db_->GetAllPreparedTransactions(&txns);
+  ASSERT_EQ(2U, txns.size());
+  for (auto txn : txns) {
+    ASSERT_OK(txn->Rollback());
+    delete txn;
+  }
+  ASSERT_EQ("", Scan());
+}
+
+TEST_F(WritePreparedTxnDBTest, InplaceUpdateNotSupported) {
+  ColumnFamilyOptions cf_options;
+  cf_options.inplace_update_support = true;
+  ColumnFamilyHandle* handle = nullptr;
+  ASSERT_TRUE(db_->CreateColumnFamily(cf_options, "inplace", &handle)
+                  .IsInvalidArgument());
+  ASSERT_TRUE(handle == nullptr);
+
+  Close();
+  options_.inplace_update_support = true;
+  ASSERT_TRUE(TransactionDB::Open(options_, txn_db_options_, dbname_, &db_)
+                  .IsInvalidArgument());
+  ASSERT_TRUE(db_ == nullptr);
+  options_.inplace_update_support = false;
+  Reopen();
+}
+
+}  // namespace vidardb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+  fprintf(stderr,
+          "SKIPPED as transactions are not supported in VIDARDB_LITE\n");
+  return 0;
+}
+
+#endif  // !VIDARDB_LITE
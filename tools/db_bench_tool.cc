@@ -54,6 +54,7 @@
 #include "util/statistics.h"
 #include "util/string_util.h"
 #include "util/testutil.h"
+#include "util/xxhash.h"
 
 #ifdef OS_WIN
 #include <io.h>  // open/close
@@ -91,6 +92,7 @@ DEFINE_string(benchmarks,
               "fill100K,"
               "crc32c,"
               "xxhash,"
+              "xxh3,"
               "compress,"
               "uncompress,"
               "acquireload,"
@@ -142,6 +144,7 @@ DEFINE_string(benchmarks,
               "merge\n"
               "\tcrc32c        -- repeated crc32c of 4K of data\n"
               "\txxhash        -- repeated xxHash of 4K of data\n"
+              "\txxh3          -- repeated XXH3 of 4K of data\n"
               "\tacquireload   -- load N*1000 times\n"
               "\tfillseekseq   -- write N values in sequential key, then read "
               "them by seeking to each key\n"
@@ -1955,6 +1958,10 @@ class Benchmark {
         method = &Benchmark::Compact;
       } else if (name == "crc32c") {
         method = &Benchmark::Crc32c;
+      } else if (name == "xxhash") {
+        method = &Benchmark::xxHash;
+      } else if (name == "xxh3") {
+        method = &Benchmark::XXH3;
       } else if (name == "acquireload") {
         method = &Benchmark::AcquireLoad;
       } else if (name == "compress") {
@@ -2133,6 +2140,44 @@ class Benchmark {
     thread->stats.AddMessage(label);
   }
 
+  void xxHash(ThreadState* thread) {
+    // Checksum about 500MB of data total
+    const int size = 4096;
+    const char* label = "(4K per op)";
+    std::string data(size, 'x');
+    int64_t bytes = 0;
+    uint64_t h = 0;
+    while (bytes < 500 * 1048576) {
+      h = xxhash::XXH64(data.data(), size, 0);
+      thread->stats.FinishedOps(nullptr, nullptr, 1, kHash);
+      bytes += size;
+    }
+    // Print so result is not dead
+    fprintf(stderr, "... h=0x%" PRIx64 "\r", h);
+
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(label);
+  }
+
+  void XXH3(ThreadState* thread) {
+    // Checksum about 500MB of data total
+    const int size = 4096;
+    const char* label = "(4K per op)";
+    std::string data(size, 'x');
+    int64_t bytes = 0;
+    uint64_t h = 0;
+    while (bytes < 500 * 1048576) {
+      h = xxhash::XXH3_64bits(data.data(), size);
+      thread->stats.FinishedOps(nullptr, nullptr, 1, kHash);
+      bytes += size;
+    }
+    // Print so result is not dead
+    fprintf(stderr, "... h=0x%" PRIx64 "\r", h);
+
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(label);
+  }
+
   void AcquireLoad(ThreadState* thread) {
     int dummy;
     std::atomic<void*> ap(&dummy);
@@ -2203,12 +2248,12 @@ class Benchmark {
         }
       case vidardb::kZlibCompression:
         uncompressed = Zlib_Uncompress(compressed.data(), compressed.size(),
-                                       &decompress_size, 2);
+                                       &decompress_size, 2).release();
         ok = uncompressed != nullptr;
         break;
       case vidardb::kBZip2Compression:
         uncompressed = BZip2_Uncompress(compressed.data(), compressed.size(),
-                                        &decompress_size, 2);
+                                        &decompress_size, 2).release();
         ok = uncompressed != nullptr;
         break;
       default:
@@ -2243,6 +2288,10 @@ class Benchmark {
     options.db_write_buffer_size = FLAGS_db_write_buffer_size;
     options.write_buffer_size = FLAGS_write_buffer_size;
     options.max_write_buffer_number = FLAGS_max_write_buffer_number;
+    if (FLAGS_memtable_bloom_bits > 0) {
+      options.memtable_bloom_bits_per_key =
+          static_cast<uint32_t>(FLAGS_memtable_bloom_bits);
+    }
     options.min_write_buffer_number_to_merge =
       FLAGS_min_write_buffer_number_to_merge;
     options.max_write_buffer_number_to_maintain =
@@ -77,9 +77,10 @@ DEFINE_int32(
     hashskiplist_branching_factor, 4,
     "branching_factor parameter to pass into NewHashSkiplistRepFactory");
 
-DEFINE_int32(
-    huge_page_tlb_size, 0,
-    "huge_page_tlb_size parameter to pass into NewHashLinkListRepFactory");
+DEFINE_int64(
+    memtable_huge_page_size, 0,
+    "Huge page size (e.g. 2097152) backing the memtable arena, 0 to use normal "
+    "pages. Run the same benchmarks with and without it to compare.");
 
 DEFINE_int32(bucket_entries_logging_threshold, 4096,
              "bucket_entries_logging_threshold parameter to pass into "
@@ -597,7 +598,8 @@ int main(int argc, char** argv) {
   vidardb::InternalKeyComparator internal_key_comp(
       vidardb::BytewiseComparator());
   vidardb::MemTable::KeyComparator key_comp(internal_key_comp);
-  vidardb::Arena arena;
+  vidardb::Arena arena(vidardb::Arena::kMinBlockSize,
+                       FLAGS_memtable_huge_page_size);
   vidardb::WriteBuffer wb(FLAGS_write_buffer_size);
   vidardb::MemTableAllocator memtable_allocator(&arena, &wb);
   uint64_t sequence;
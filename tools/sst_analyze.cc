@@ -0,0 +1,20 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include "vidardb/sst_analyze_tool.h"
+
+int main(int argc, char** argv) {
+  vidardb::SstAnalyzeTool tool;
+  return tool.Run(argc, argv);
+}
+#else
+#include <stdio.h>
+int main(int argc, char** argv) {
+  fprintf(stderr, "Not supported in lite mode.\n");
+  return 1;
+}
+#endif  // VIDARDB_LITE
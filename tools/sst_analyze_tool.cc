@@ -0,0 +1,749 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include "vidardb/sst_analyze_tool.h"
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "db/filename.h"
+#include "table/block.h"
+#include "table/block_based_table_builder.h"
+#include "table/column_table_builder.h"
+#include "table/format.h"
+#include "table/internal_iterator.h"
+#include "table/meta_blocks.h"
+#include "table/table_builder.h"
+#include "table/table_properties_internal.h"
+#include "table/table_reader.h"
+#include "util/compression.h"
+#include "util/file_reader_writer.h"
+#include "util/histogram.h"
+#include "util/string_util.h"
+#include "vidardb/comparator.h"
+#include "vidardb/env.h"
+#include "vidardb/options.h"
+#include "vidardb/splitter.h"
+#include "vidardb/table.h"
+#include "vidardb/table_properties.h"
+
+namespace vidardb {
+
+namespace {
+
+const CompressionType kCodecs[] = {kSnappyCompression, kZlibCompression,
+                                   kBZip2Compression};
+const size_t kNumCodecs = sizeof(kCodecs) / sizeof(kCodecs[0]);
+
+// The data blocks of one file: a row table, the key file of a column table
+// or one of its sub column files.
+struct FileReport {
+  std::string name;
+  std::string fname;
+  bool column_values = false;  // a sub column file
+  bool key_file = false;       // the main file of a column table
+  uint64_t file_size = 0;
+  uint64_t num_blocks = 0;
+  uint64_t num_entries = 0;
+  uint64_t raw_size = 0;     // uncompressed data blocks
+  uint64_t stored_size = 0;  // data blocks with their trailers, as stored
+  uint64_t stored_blocks[kBZip2Compression + 1] = {};  // by compression type
+  uint64_t scan_micros = 0;
+  // As the table builders would store the blocks with each codec
+  uint64_t codec_size[kNumCodecs] = {};
+  uint64_t codec_micros[kNumCodecs] = {};
+  // Value lengths, or user key lengths in the key file of a column table
+  HistogramImpl lengths;
+};
+
+struct AnalyzeOptions {
+  bool histograms = false;
+  bool try_codecs = true;
+};
+
+double MBPerSec(uint64_t bytes, uint64_t micros) {
+  return micros == 0 ? 0.0 : bytes / 1048576.0 / (micros / 1000000.0);
+}
+
+double Ratio(uint64_t raw, uint64_t stored) {
+  return stored == 0 ? 0.0 : static_cast<double>(raw) / stored;
+}
+
+// The block as the table builders would store it with this codec: kept
+// uncompressed unless the codec saves at least 12.5%.
+size_t CompressedSize(CompressionType type, const Slice& raw,
+                      const Slice& compression_dict, std::string* buf) {
+  CompressionOptions opts;
+  bool ok = false;
+  buf->clear();
+  switch (type) {
+    case kSnappyCompression:
+      ok = Snappy_Compress(opts, raw.data(), raw.size(), buf);
+      break;
+    case kZlibCompression:
+      ok = Zlib_Compress(opts, GetCompressFormatForVersion(kZlibCompression),
+                         raw.data(), raw.size(), buf, compression_dict);
+      break;
+    case kBZip2Compression:
+      ok = BZip2_Compress(opts, GetCompressFormatForVersion(kBZip2Compression),
+                          raw.data(), raw.size(), buf);
+      break;
+    default:
+      break;
+  }
+  if (ok && buf->size() < raw.size() - (raw.size() / 8u)) {
+    return buf->size();
+  }
+  return raw.size();
+}
+
+Status NewFileReader(Env* env, const EnvOptions& env_options,
+                     const std::string& fname,
+                     unique_ptr<RandomAccessFileReader>* reader,
+                     uint64_t* file_size) {
+  Status s = env->GetFileSize(fname, file_size);
+  if (!s.ok()) {
+    return s;
+  }
+  unique_ptr<RandomAccessFile> file;
+  s = env->NewRandomAccessFile(fname, &file, env_options);
+  if (s.ok()) {
+    reader->reset(new RandomAccessFileReader(std::move(file), env));
+  }
+  return s;
+}
+
+// Reads every data block of the file, verifying its checksum, and fills in
+// report. Only the reads, decompression and iteration of the blocks are
+// timed as the scan, not the codec trials.
+Status AnalyzeFile(Env* env, const EnvOptions& env_options,
+                   const AnalyzeOptions& options, FileReport* report) {
+  unique_ptr<RandomAccessFileReader> file;
+  Status s = NewFileReader(env, env_options, report->fname, &file,
+                           &report->file_size);
+  if (!s.ok()) {
+    return s;
+  }
+  Footer footer;
+  s = ReadFooterFromFile(file.get(), report->file_size, &footer);
+  if (!s.ok()) {
+    return s;
+  }
+
+  BlockContents dict_contents;
+  Slice compression_dict;
+  if (ReadMetaBlock(file.get(), report->file_size,
+                    footer.table_magic_number(), env, kCompressionDictBlock,
+                    &dict_contents).ok()) {
+    compression_dict = dict_contents.data;
+  }
+
+  ReadOptions read_options;
+  read_options.verify_checksums = true;
+  BlockContents index_contents;
+  s = ReadBlockContents(file.get(), footer, read_options,
+                        footer.index_handle(), &index_contents, env);
+  if (!s.ok()) {
+    return s;
+  }
+  Block index_block(std::move(index_contents));
+  std::unique_ptr<InternalIterator> index_iter(
+      index_block.NewIterator(BytewiseComparator()));
+
+  std::string buf;
+  for (index_iter->SeekToFirst(); s.ok() && index_iter->Valid();
+       index_iter->Next()) {
+    Slice handle_value = index_iter->value();
+    BlockHandle handle;
+    s = handle.DecodeFrom(&handle_value);
+    if (!s.ok()) {
+      break;
+    }
+
+    uint64_t start = env->NowMicros();
+    BlockContents contents;
+    s = ReadBlockContents(file.get(), footer, read_options, handle, &contents,
+                          env, false /* do_uncompress */);
+    if (!s.ok()) {
+      break;
+    }
+    CompressionType type = contents.compression_type;
+    if (type != kNoCompression) {
+      BlockContents uncompressed;
+      s = UncompressBlockContents(contents.data.data(), contents.data.size(),
+                                  &uncompressed, compression_dict);
+      if (!s.ok()) {
+        break;
+      }
+      contents = std::move(uncompressed);
+    }
+    Block block(std::move(contents));
+    std::unique_ptr<InternalIterator> iter(block.NewIterator(
+        BytewiseComparator(), nullptr, report->column_values));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      report->num_entries++;
+      report->lengths.Add(report->key_file
+                              ? ExtractUserKey(iter->key()).size()
+                              : iter->value().size());
+    }
+    s = iter->status();
+    report->scan_micros += env->NowMicros() - start;
+
+    report->num_blocks++;
+    report->raw_size += block.size();
+    report->stored_size += handle.size() + kBlockTrailerSize;
+    if (static_cast<size_t>(type) <= kBZip2Compression) {
+      report->stored_blocks[type]++;
+    }
+    if (!options.try_codecs) {
+      continue;
+    }
+    Slice raw(block.data(), block.size());
+    for (size_t i = 0; i < kNumCodecs; i++) {
+      if (!CompressionTypeSupported(kCodecs[i])) {
+        continue;
+      }
+      start = env->NowMicros();
+      report->codec_size[i] +=
+          CompressedSize(kCodecs[i], raw, compression_dict, &buf) +
+          kBlockTrailerSize;
+      report->codec_micros[i] += env->NowMicros() - start;
+    }
+  }
+  if (s.ok()) {
+    s = index_iter->status();
+  }
+  return s;
+}
+
+// The files of the table: the file itself, followed by its sub column files
+// if it is the main file of a column table. The sub column files placed on
+// another db path than the main file are looked for in db_paths.
+Status ListTableFiles(Env* env, const EnvOptions& env_options,
+                      const std::string& fname,
+                      const std::vector<DbPath>& db_paths,
+                      std::vector<std::unique_ptr<FileReport>>* reports,
+                      uint32_t* column_count) {
+  *column_count = 0;
+  unique_ptr<RandomAccessFileReader> file;
+  uint64_t file_size;
+  Status s = NewFileReader(env, env_options, fname, &file, &file_size);
+  if (!s.ok()) {
+    return s;
+  }
+  Footer footer;
+  s = ReadFooterFromFile(file.get(), file_size, &footer);
+  if (!s.ok()) {
+    return s;
+  }
+  uint64_t magic = footer.table_magic_number();
+  if (magic != kBlockBasedTableMagicNumber &&
+      magic != kColumnTableMagicNumber) {
+    return Status::NotSupported("Not a block based or column table", fname);
+  }
+
+  bool main_column = false;
+  std::vector<uint64_t> file_sizes;
+  std::vector<uint32_t> path_ids;
+  if (magic == kColumnTableMagicNumber) {
+    ReadOptions read_options;
+    read_options.verify_checksums = false;
+    BlockContents meta_contents;
+    s = ReadBlockContents(file.get(), footer, read_options,
+                          footer.metaindex_handle(), &meta_contents, env,
+                          false /* do_uncompress */);
+    if (!s.ok()) {
+      return s;
+    }
+    Block meta(std::move(meta_contents));
+    std::unique_ptr<InternalIterator> meta_iter(
+        meta.NewIterator(BytewiseComparator()));
+    s = SeekToColumnBlock(meta_iter.get(), &main_column);
+    if (s.ok() && main_column) {
+      s = ReadMetaColumnBlock(meta_iter->value(), file.get(), footer, env,
+                              nullptr, column_count, file_sizes, &path_ids);
+    }
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  FileReport* report = new FileReport();
+  report->name = magic == kBlockBasedTableMagicNumber ? "rows" :
+                 main_column ? "keys" : "column";
+  report->fname = fname;
+  report->column_values = magic == kColumnTableMagicNumber && !main_column;
+  report->key_file = main_column;
+  reports->emplace_back(report);
+  for (uint32_t i = 0; i < *column_count; i++) {
+    report = new FileReport();
+    report->name = "column " + ToString(i + 1);
+    report->fname = TableSubFileName(fname, i + 1);
+    if (!path_ids.empty() && path_ids[i + 1] != path_ids[0]) {
+      if (path_ids[i + 1] >= db_paths.size()) {
+        return Status::InvalidArgument(
+            "Sub column file on db path " + ToString(path_ids[i + 1]) +
+                ", pass the db paths with --db_paths",
+            report->fname);
+      }
+      report->fname = TableSubFileName(
+          TableFileName(db_paths, TableFileNameToNumber(fname),
+                        path_ids[i + 1]),
+          i + 1);
+    }
+    report->column_values = true;
+    reports->emplace_back(report);
+  }
+  return Status::OK();
+}
+
+void PrintReport(const FileReport& r, const AnalyzeOptions& options) {
+  const char* what = r.key_file ? "key" : "value";
+  fprintf(stdout, "%s: %s\n", r.name.c_str(), r.fname.c_str());
+  fprintf(stdout,
+          "  file size: %" PRIu64 ", data blocks: %" PRIu64
+          ", entries: %" PRIu64 "\n",
+          r.file_size, r.num_blocks, r.num_entries);
+  fprintf(stdout,
+          "  raw data size: %" PRIu64 ", stored data size: %" PRIu64
+          " (ratio %.2f)\n",
+          r.raw_size, r.stored_size, Ratio(r.raw_size, r.stored_size));
+  fprintf(stdout, "  stored blocks:");
+  for (size_t i = 0; i <= kBZip2Compression; i++) {
+    if (r.stored_blocks[i] > 0) {
+      fprintf(stdout, " %s %" PRIu64,
+              CompressionTypeToString(static_cast<CompressionType>(i)).c_str(),
+              r.stored_blocks[i]);
+    }
+  }
+  fprintf(stdout, "\n");
+  if (r.lengths.num() > 0) {
+    fprintf(stdout,
+            "  %s length: min %" PRIu64 ", avg %.1f, p50 %.1f, p90 %.1f, "
+            "p99 %.1f, max %" PRIu64 "\n",
+            what, r.lengths.min(), r.lengths.Average(), r.lengths.Median(),
+            r.lengths.Percentile(90), r.lengths.Percentile(99),
+            r.lengths.max());
+    if (options.histograms) {
+      fprintf(stdout, "%s", r.lengths.ToString().c_str());
+    }
+  }
+  fprintf(stdout, "  full scan: %.1f MB/s (%" PRIu64 " us)\n",
+          MBPerSec(r.raw_size, r.scan_micros), r.scan_micros);
+  if (!options.try_codecs) {
+    return;
+  }
+  for (size_t i = 0; i < kNumCodecs; i++) {
+    std::string codec = CompressionTypeToString(kCodecs[i]);
+    if (!CompressionTypeSupported(kCodecs[i])) {
+      fprintf(stdout, "  %s: not supported\n", codec.c_str());
+      continue;
+    }
+    fprintf(stdout,
+            "  %s: %" PRIu64 " bytes (ratio %.2f), compress %.1f MB/s\n",
+            codec.c_str(), r.codec_size[i], Ratio(r.raw_size, r.codec_size[i]),
+            MBPerSec(r.raw_size, r.codec_micros[i]));
+  }
+}
+
+Status AnalyzeTable(Env* env, const EnvOptions& env_options,
+                    const std::string& fname,
+                    const std::vector<DbPath>& db_paths,
+                    const AnalyzeOptions& options,
+                    std::vector<std::unique_ptr<FileReport>>* reports) {
+  uint32_t column_count;
+  Status s = ListTableFiles(env, env_options, fname, db_paths, reports,
+                            &column_count);
+  for (size_t i = 0; s.ok() && i < reports->size(); i++) {
+    s = AnalyzeFile(env, env_options, options, (*reports)[i].get());
+    if (s.ok()) {
+      PrintReport(*(*reports)[i], options);
+    }
+  }
+  if (s.ok() && reports->size() > 1) {
+    uint64_t file_size = 0, raw_size = 0, stored_size = 0;
+    for (const auto& r : *reports) {
+      file_size += r->file_size;
+      raw_size += r->raw_size;
+      stored_size += r->stored_size;
+    }
+    fprintf(stdout,
+            "total: %" PRIu32 " columns, file size: %" PRIu64
+            ", raw data size: %" PRIu64 ", stored data size: %" PRIu64
+            " (ratio %.2f)\n",
+            column_count, file_size, raw_size, stored_size,
+            Ratio(raw_size, stored_size));
+  }
+  return s;
+}
+
+// The options of the tables read and written by the tool
+struct TableConfig {
+  std::string table;  // "row" or "column", empty as the input file
+  uint32_t column_count = 0;
+  CompressionType compression = kNoCompression;
+  ColumnTableOptions table_options;
+  std::shared_ptr<Splitter> splitter;
+};
+
+Status NewTableFactory(const TableConfig& config, bool column,
+                       uint32_t column_count,
+                       std::shared_ptr<TableFactory>* factory) {
+  if (column) {
+    ColumnTableOptions opts = config.table_options;
+    opts.column_count = column_count;
+    if (opts.column_count == 0) {
+      return Status::InvalidArgument("--column_count is required");
+    }
+    factory->reset(NewColumnTableFactory(opts));
+  } else {
+    BlockBasedTableOptions opts;
+    static_cast<TableOptions&>(opts) = config.table_options;
+    factory->reset(NewBlockBasedTableFactory(opts));
+  }
+  return Status::OK();
+}
+
+// An input table, opened by the reader of its type
+struct TableFile {
+  Options options;
+  std::unique_ptr<ImmutableCFOptions> ioptions;
+  InternalKeyComparator internal_comparator{BytewiseComparator()};
+  unique_ptr<TableReader> reader;
+  bool column = false;
+  uint32_t column_count = 0;
+};
+
+Status OpenTable(Env* env, const EnvOptions& env_options,
+                 const std::string& fname,
+                 const std::vector<DbPath>& db_paths,
+                 const TableConfig& config, TableFile* table) {
+  std::vector<std::unique_ptr<FileReport>> files;
+  Status s = ListTableFiles(env, env_options, fname, db_paths, &files,
+                            &table->column_count);
+  if (!s.ok()) {
+    return s;
+  }
+  if (files[0]->column_values) {
+    return Status::NotSupported("Open the main file of the column table",
+                                fname);
+  }
+  table->column = table->column_count > 0;
+
+  TableConfig input_config;
+  s = NewTableFactory(input_config, table->column, table->column_count,
+                      &table->options.table_factory);
+  if (!s.ok()) {
+    return s;
+  }
+  table->options.env = env;
+  table->options.db_paths = db_paths;
+  table->options.splitter = config.splitter;
+  table->ioptions.reset(new ImmutableCFOptions(table->options));
+
+  unique_ptr<RandomAccessFileReader> file;
+  uint64_t file_size;
+  s = NewFileReader(env, env_options, fname, &file, &file_size);
+  if (!s.ok()) {
+    return s;
+  }
+  return table->options.table_factory->NewTableReader(
+      TableReaderOptions(*table->ioptions, env_options,
+                         table->internal_comparator),
+      std::move(file), file_size, &table->reader);
+}
+
+// Writes the entries of the input table to output, as a table of the options
+// of config
+Status RewriteTable(Env* env, const EnvOptions& env_options,
+                    TableFile* input, const std::string& output,
+                    const TableConfig& config) {
+  bool column = config.table.empty() ? input->column
+                                     : config.table == "column";
+  uint32_t column_count = config.column_count > 0 ? config.column_count
+                                                  : input->column_count;
+  Options options;
+  options.env = env;
+  options.splitter = config.splitter;
+  Status s = NewTableFactory(config, column, column_count,
+                             &options.table_factory);
+  if (!s.ok()) {
+    return s;
+  }
+  ImmutableCFOptions ioptions(options);
+
+  unique_ptr<WritableFile> file;
+  s = NewWritableFile(env, output, &file, env_options);
+  if (!s.ok()) {
+    return s;
+  }
+  unique_ptr<WritableFileWriter> file_writer(
+      new WritableFileWriter(std::move(file), env_options));
+  std::vector<std::unique_ptr<IntTblPropCollectorFactory>> collectors;
+  CompressionOptions compression_opts;
+  unique_ptr<TableBuilder> builder(options.table_factory->NewTableBuilder(
+      TableBuilderOptions(ioptions, input->internal_comparator, &collectors,
+                          config.compression, compression_opts,
+                          nullptr /* compression_dict */,
+                          "" /* column_family_name */, env_options),
+      TablePropertiesCollectorFactory::Context::kUnknownColumnFamily,
+      file_writer.get()));
+
+  std::unique_ptr<InternalIterator> iter(
+      input->reader->NewIterator(ReadOptions()));
+  for (iter->SeekToFirst(); iter->Valid() && builder->status().ok();
+       iter->Next()) {
+    // the column tables return the stitched empty columns of a deletion
+    builder->Add(iter->key(), ExtractValueType(iter->key()) == kTypeValue
+                                  ? iter->value()
+                                  : Slice());
+  }
+  s = iter->status();
+  if (s.ok()) {
+    s = builder->status();
+  }
+  if (s.ok()) {
+    s = builder->Finish();
+  } else {
+    builder->Abandon();
+  }
+  if (s.ok()) {
+    s = file_writer->Sync(false);
+  }
+  if (s.ok()) {
+    s = file_writer->Close();
+  }
+  return s;
+}
+
+void PrintComparison(const std::vector<std::unique_ptr<FileReport>>& before,
+                     const std::vector<std::unique_ptr<FileReport>>& after) {
+  fprintf(stdout, "comparison (input -> output):\n");
+  size_t n = std::max(before.size(), after.size());
+  for (size_t i = 0; i < n; i++) {
+    const FileReport* b = i < before.size() ? before[i].get() : nullptr;
+    const FileReport* a = i < after.size() ? after[i].get() : nullptr;
+    fprintf(stdout, "  %-10s", (b != nullptr ? b : a)->name.c_str());
+    if (b != nullptr) {
+      fprintf(stdout, " %12" PRIu64 " bytes %8.1f MB/s", b->file_size,
+              MBPerSec(b->raw_size, b->scan_micros));
+    } else {
+      fprintf(stdout, " %12s       %13s", "-", "");
+    }
+    fprintf(stdout, "  ->");
+    if (a != nullptr) {
+      fprintf(stdout, " %12" PRIu64 " bytes %8.1f MB/s", a->file_size,
+              MBPerSec(a->raw_size, a->scan_micros));
+    } else {
+      fprintf(stdout, " %12s", "-");
+    }
+    fprintf(stdout, "\n");
+  }
+}
+
+bool ParseCompression(const char* name, CompressionType* type) {
+  if (strcmp(name, "none") == 0) {
+    *type = kNoCompression;
+  } else if (strcmp(name, "snappy") == 0) {
+    *type = kSnappyCompression;
+  } else if (strcmp(name, "zlib") == 0) {
+    *type = kZlibCompression;
+  } else if (strcmp(name, "bzip2") == 0) {
+    *type = kBZip2Compression;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ParseChecksum(const char* name, ChecksumType* type) {
+  if (strcmp(name, "crc32c") == 0) {
+    *type = kCRC32c;
+  } else if (strcmp(name, "xxhash64") == 0) {
+    *type = kxxHash64;
+  } else if (strcmp(name, "xxh3") == 0) {
+    *type = kXXH3;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void PrintHelp() {
+  fprintf(stderr,
+      "vidardb_sst_analyze --file=<sst file> [--command=analyze|raw|rewrite]\n"
+      "\n"
+      "  --file=<sst file>\n"
+      "      A block based table or the main file of a column table, whose\n"
+      "      sub column files <sst file>_<column> are found next to it\n"
+      "\n"
+      "  --db_paths=<path>[,<path>...]\n"
+      "      The db paths of the database, in order, to find the sub column\n"
+      "      files placed on another db path than the main file\n"
+      "\n"
+      "  --command=analyze\n"
+      "      Per file of the table: sizes, data blocks, value lengths, the\n"
+      "      stored size with each codec and the full scan throughput\n"
+      "\n"
+      "  --command=raw\n"
+      "      Dump the table in a human readable form to <sst file>_dump.txt\n"
+      "\n"
+      "  --command=rewrite --output=<sst file>\n"
+      "      Write the entries of the table to a table of the options below,\n"
+      "      then analyze both and compare them\n"
+      "\n"
+      "  --histograms\n"
+      "      Print the distribution of the value lengths in full\n"
+      "\n"
+      "  --no_codecs\n"
+      "      Do not try the compression codecs on the data blocks\n"
+      "\n"
+      "  --splitter=pipe|encoding\n"
+      "      Splitter of the column values (default: pipe)\n"
+      "\n"
+      "Output options of rewrite:\n"
+      "  --table=row|column (default: as the input)\n"
+      "  --column_count=<n> (default: as the input)\n"
+      "  --compression=none|snappy|zlib|bzip2 (default: none)\n"
+      "  --block_size=<bytes>\n"
+      "  --block_restart_interval=<n>\n"
+      "  --checksum=crc32c|xxhash64|xxh3\n");
+}
+
+}  // namespace
+
+int SstAnalyzeTool::Run(int argc, char** argv) {
+  std::string fname;
+  std::string command = "analyze";
+  std::string output;
+  AnalyzeOptions options;
+  TableConfig config;
+  std::string splitter = "pipe";
+  std::vector<DbPath> db_paths;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool valid = true;
+    if (strncmp(arg, "--file=", 7) == 0) {
+      fname = arg + 7;
+    } else if (strncmp(arg, "--command=", 10) == 0) {
+      command = arg + 10;
+    } else if (strncmp(arg, "--output=", 9) == 0) {
+      output = arg + 9;
+    } else if (strcmp(arg, "--histograms") == 0) {
+      options.histograms = true;
+    } else if (strcmp(arg, "--no_codecs") == 0) {
+      options.try_codecs = false;
+    } else if (strncmp(arg, "--db_paths=", 11) == 0) {
+      for (const auto& path : StringSplit(arg + 11, ',')) {
+        db_paths.emplace_back(path, 0);
+      }
+    } else if (strncmp(arg, "--splitter=", 11) == 0) {
+      splitter = arg + 11;
+    } else if (strncmp(arg, "--table=", 8) == 0) {
+      config.table = arg + 8;
+    } else if (strncmp(arg, "--column_count=", 15) == 0) {
+      config.column_count = static_cast<uint32_t>(atoi(arg + 15));
+    } else if (strncmp(arg, "--compression=", 14) == 0) {
+      valid = ParseCompression(arg + 14, &config.compression);
+    } else if (strncmp(arg, "--block_size=", 13) == 0) {
+      config.table_options.block_size = static_cast<size_t>(atol(arg + 13));
+    } else if (strncmp(arg, "--block_restart_interval=", 25) == 0) {
+      config.table_options.block_restart_interval = atoi(arg + 25);
+    } else if (strncmp(arg, "--checksum=", 11) == 0) {
+      valid = ParseChecksum(arg + 11, &config.table_options.checksum);
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      fprintf(stderr, "Unrecognized argument '%s'\n\n", arg);
+      PrintHelp();
+      return 1;
+    }
+  }
+
+  if (fname.empty() ||
+      (command != "analyze" && command != "raw" && command != "rewrite") ||
+      (command == "rewrite" && output.empty()) ||
+      (!config.table.empty() && config.table != "row" &&
+       config.table != "column") ||
+      (splitter != "pipe" && splitter != "encoding")) {
+    PrintHelp();
+    return 1;
+  }
+  config.splitter.reset(splitter == "pipe" ? NewPipeSplitter()
+                                           : NewEncodingSplitter());
+  if (!CompressionTypeSupported(config.compression)) {
+    fprintf(stderr, "%s is not supported in this build\n",
+            CompressionTypeToString(config.compression).c_str());
+    return 1;
+  }
+
+  Env* env = Env::Default();
+  EnvOptions env_options;
+  Status s;
+  std::vector<std::unique_ptr<FileReport>> before, after;
+  if (command == "analyze") {
+    s = AnalyzeTable(env, env_options, fname, db_paths, options, &before);
+  } else if (command == "raw") {
+    TableFile table;
+    s = OpenTable(env, env_options, fname, db_paths, config, &table);
+    std::string dump_fname = fname + "_dump.txt";
+    unique_ptr<WritableFile> out_file;
+    if (s.ok()) {
+      s = env->NewWritableFile(dump_fname, &out_file, env_options);
+    }
+    if (s.ok()) {
+      s = table.reader->DumpTable(out_file.get());
+    }
+    if (s.ok()) {
+      s = out_file->Close();
+    }
+    if (s.ok()) {
+      fprintf(stdout, "Dumped to %s\n", dump_fname.c_str());
+    }
+  } else {
+    TableFile table;
+    s = OpenTable(env, env_options, fname, db_paths, config, &table);
+    if (s.ok()) {
+      s = RewriteTable(env, env_options, &table, output, config);
+    }
+    if (s.ok()) {
+      s = AnalyzeTable(env, env_options, fname, db_paths, options, &before);
+    }
+    if (s.ok()) {
+      fprintf(stdout, "\n");
+      s = AnalyzeTable(env, env_options, output, {}, options, &after);
+    }
+    if (s.ok()) {
+      fprintf(stdout, "\n");
+      PrintComparison(before, after);
+    }
+  }
+
+  if (!s.ok()) {
+    fprintf(stderr, "%s: %s\n", fname.c_str(), s.ToString().c_str());
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace vidardb
+
+#endif  // VIDARDB_LITE
@@ -88,6 +88,11 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned) {
   if (hugetlb_size_) {
     size = hugetlb_size_;
     block_head = AllocateFromHugePage(size);
+    if (!block_head) {
+      // No huge page reserved (or left), don't pay a failing mmap() for every
+      // further block of this arena.
+      hugetlb_size_ = 0;
+    }
   }
 #endif
   if (!block_head) {
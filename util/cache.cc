@@ -485,8 +485,10 @@ class ShardedLRUCache : public Cache {
 
  public:
   ShardedLRUCache(size_t capacity, int num_shard_bits,
-                  bool strict_capacity_limit)
-      : last_id_(0),
+                  bool strict_capacity_limit,
+                  std::shared_ptr<MemoryAllocator> memory_allocator)
+      : Cache(std::move(memory_allocator)),
+        last_id_(0),
         num_shard_bits_(num_shard_bits),
         capacity_(capacity),
         strict_capacity_limit_(strict_capacity_limit) {
@@ -601,11 +603,18 @@ std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits) {
 
 std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
                                    bool strict_capacity_limit) {
+  return NewLRUCache(capacity, num_shard_bits, strict_capacity_limit, nullptr);
+}
+
+std::shared_ptr<Cache> NewLRUCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    std::shared_ptr<MemoryAllocator> memory_allocator) {
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
   return std::make_shared<ShardedLRUCache>(capacity, num_shard_bits,
-                                           strict_capacity_limit);
+                                           strict_capacity_limit,
+                                           std::move(memory_allocator));
 }
 
 }  // namespace vidardb
@@ -37,6 +37,7 @@ extern void PutLengthPrefixedSliceParts(std::string* dst,
 
 // Standard Get... routines parse a value from the beginning of a Slice
 // and advance the slice past the parsed value.
+extern bool GetFixed32(Slice* input, uint32_t* value);
 extern bool GetFixed64(Slice* input, uint64_t* value);
 extern bool GetVarint32(Slice* input, uint32_t* value);
 extern bool GetVarint64(Slice* input, uint64_t* value);
@@ -256,6 +257,15 @@ inline bool GetFixed32BigEndian(const Slice* input, uint32_t* value) {
   return true;
 }
 
+inline bool GetFixed32(Slice* input, uint32_t* value) {
+  if (input->size() < sizeof(uint32_t)) {
+    return false;
+  }
+  *value = DecodeFixed32(input->data());
+  input->remove_prefix(sizeof(uint32_t));
+  return true;
+}
+
 inline bool GetFixed64(Slice* input, uint64_t* value) {
   if (input->size() < sizeof(uint64_t)) {
     return false;
@@ -0,0 +1,42 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/dynamic_bloom.h"
+
+#include <algorithm>
+#include <new>
+
+#include "util/allocator.h"
+
+namespace vidardb {
+
+DynamicBloom::DynamicBloom(Allocator* allocator, uint32_t total_bits,
+                           uint32_t num_probes, size_t huge_page_size,
+                           Logger* logger)
+    : num_lines_((std::max(total_bits, 1U) + CACHE_LINE_SIZE * 8 - 1) /
+                 (CACHE_LINE_SIZE * 8)),
+      num_probes_(std::max(num_probes, 1U)) {
+  size_t bytes = MemoryUsage();
+  // one more line to align the bits on a cache line
+  char* raw = allocator->AllocateAligned(bytes + CACHE_LINE_SIZE,
+                                         huge_page_size, logger);
+  uintptr_t misalign = reinterpret_cast<uintptr_t>(raw) % CACHE_LINE_SIZE;
+  if (misalign != 0) {
+    raw += CACHE_LINE_SIZE - misalign;
+  }
+  data_ = reinterpret_cast<std::atomic<uint64_t>*>(raw);
+  for (size_t i = 0; i < static_cast<size_t>(num_lines_) * kWordsPerLine;
+       i++) {
+    new (&data_[i]) std::atomic<uint64_t>(0);
+  }
+}
+
+uint32_t DynamicBloom::OptimalNumProbes(uint32_t bits_per_key) {
+  // ln(2) * bits_per_key
+  uint32_t num_probes = static_cast<uint32_t>(bits_per_key * 0.69);
+  return std::min(std::max(num_probes, 1U), 30U);
+}
+
+}  // namespace vidardb
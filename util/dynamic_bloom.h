@@ -0,0 +1,111 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include "port/port.h"
+#include "util/murmurhash.h"
+#include "vidardb/slice.h"
+
+namespace vidardb {
+
+class Allocator;
+class Logger;
+
+// A bloom filter of fixed size, built while keys are added and probed at the
+// same time, without any lock. All the probes of a key fall in one cache
+// line, so a lookup costs at most one cache miss.
+class DynamicBloom {
+ public:
+  // total_bits: rounded up to whole cache lines
+  // num_probes: number of bits set per key
+  // The bits are allocated from allocator, huge pages if huge_page_size > 0.
+  DynamicBloom(Allocator* allocator, uint32_t total_bits, uint32_t num_probes,
+               size_t huge_page_size = 0, Logger* logger = nullptr);
+
+  // Number of probes giving the lowest false positive rate for bits_per_key
+  static uint32_t OptimalNumProbes(uint32_t bits_per_key);
+
+  // REQUIRES: no concurrent Add() or AddConcurrently()
+  void Add(const Slice& key) { AddHash(Hash(key), false); }
+
+  // Safe with concurrent AddConcurrently() calls
+  void AddConcurrently(const Slice& key) { AddHash(Hash(key), true); }
+
+  // False if key was never added. Safe with concurrent adds.
+  bool MayContain(const Slice& key) const {
+    return MayContainHash(Hash(key));
+  }
+
+  size_t MemoryUsage() const {
+    return static_cast<size_t>(num_lines_) * CACHE_LINE_SIZE;
+  }
+
+ private:
+  static const uint32_t kWordsPerLine = CACHE_LINE_SIZE / sizeof(uint64_t);
+  // log2 of the bits of a cache line
+  static const uint32_t kLineShift = 9;
+  static_assert(CACHE_LINE_SIZE * 8 == 1U << kLineShift,
+                "kLineShift does not match CACHE_LINE_SIZE");
+
+  // util/hash.h's Hash() collides too often on short similar keys
+  static uint64_t Hash(const Slice& key) {
+    return MurmurHash(key.data(), static_cast<int>(key.size()), 0);
+  }
+
+  void AddHash(uint64_t hash, bool concurrent);
+  bool MayContainHash(uint64_t hash) const;
+
+  // First word of the cache line of hash
+  uint32_t LineOf(uint32_t hash) const {
+    return static_cast<uint32_t>(
+               (static_cast<uint64_t>(hash) * num_lines_) >> 32) *
+           kWordsPerLine;
+  }
+
+  uint32_t num_lines_;
+  const uint32_t num_probes_;
+  std::atomic<uint64_t>* data_;
+};
+
+inline bool DynamicBloom::MayContainHash(uint64_t hash) const {
+  uint32_t line = LineOf(static_cast<uint32_t>(hash));
+  // Every probe takes the top bits of a new multiplicative remix of the hash
+  uint32_t h = static_cast<uint32_t>(hash >> 32) ^ static_cast<uint32_t>(hash);
+  for (uint32_t i = 0; i < num_probes_; i++) {
+    h *= 0x9e3779b9U;
+    uint32_t bit = h >> (32 - kLineShift);
+    uint64_t mask = uint64_t{1} << (bit % 64);
+    if ((data_[line + bit / 64].load(std::memory_order_relaxed) & mask) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline void DynamicBloom::AddHash(uint64_t hash, bool concurrent) {
+  uint32_t line = LineOf(static_cast<uint32_t>(hash));
+  uint32_t h = static_cast<uint32_t>(hash >> 32) ^ static_cast<uint32_t>(hash);
+  for (uint32_t i = 0; i < num_probes_; i++) {
+    h *= 0x9e3779b9U;
+    uint32_t bit = h >> (32 - kLineShift);
+    uint64_t mask = uint64_t{1} << (bit % 64);
+    std::atomic<uint64_t>& word = data_[line + bit / 64];
+    if (concurrent) {
+      // skip the locked instruction when the bit is already there
+      if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+        word.fetch_or(mask, std::memory_order_relaxed);
+      }
+    } else {
+      word.store(word.load(std::memory_order_relaxed) | mask,
+                 std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace vidardb
@@ -644,18 +644,23 @@ class PosixEnv : public Env {
 
   // Allow increasing the number of worker threads.
   virtual void SetBackgroundThreads(int num, Priority pri) override {
-    assert(pri >= Priority::LOW && pri <= Priority::HIGH);
+    assert(pri >= Priority::LOW && pri < Priority::TOTAL);
     thread_pools_[pri].SetBackgroundThreads(num);
   }
 
+  virtual int GetBackgroundThreads(Priority pri) override {
+    assert(pri >= Priority::LOW && pri < Priority::TOTAL);
+    return thread_pools_[pri].GetBackgroundThreads();
+  }
+
   // Allow increasing the number of worker threads.
   virtual void IncBackgroundThreadsIfNeeded(int num, Priority pri) override {
-    assert(pri >= Priority::LOW && pri <= Priority::HIGH);
+    assert(pri >= Priority::LOW && pri < Priority::TOTAL);
     thread_pools_[pri].IncBackgroundThreadsIfNeeded(num);
   }
 
   virtual void LowerThreadPoolIOPriority(Priority pool = LOW) override {
-    assert(pool >= Priority::LOW && pool <= Priority::HIGH);
+    assert(pool >= Priority::LOW && pool < Priority::TOTAL);
 #ifdef OS_LINUX
     thread_pools_[pool].LowerIOPriority();
 #endif
@@ -755,12 +760,19 @@ PosixEnv::PosixEnv()
     // This allows later initializing the thread-local-env of each thread.
     thread_pools_[pool_id].SetHostEnv(this);
   }
+  thread_pools_[Priority::BOTTOM].SetBackgroundThreads(0);
+  // Idle bottommost-level compaction threads help with flushes and with the
+  // compactions into the upper levels
+  thread_pools_[Priority::BOTTOM].AddStealVictim(
+      &thread_pools_[Priority::HIGH]);
+  thread_pools_[Priority::BOTTOM].AddStealVictim(
+      &thread_pools_[Priority::LOW]);
   thread_status_updater_ = CreateThreadStatusUpdater();
 }
 
 void PosixEnv::Schedule(void (*function)(void* arg1), void* arg, Priority pri,
                         void* tag, void (*unschedFunction)(void* arg)) {
-  assert(pri >= Priority::LOW && pri <= Priority::HIGH);
+  assert(pri >= Priority::LOW && pri < Priority::TOTAL);
   thread_pools_[pri].Schedule(function, arg, tag, unschedFunction);
 }
 
@@ -769,7 +781,7 @@ int PosixEnv::UnSchedule(void* arg, Priority pri) {
 }
 
 unsigned int PosixEnv::GetThreadPoolQueueLen(Priority pri) const {
-  assert(pri >= Priority::LOW && pri <= Priority::HIGH);
+  assert(pri >= Priority::LOW && pri < Priority::TOTAL);
   return thread_pools_[pri].GetQueueLen();
 }
 
@@ -458,6 +458,79 @@ class ReadaheadRandomAccessFile : public RandomAccessFile {
   mutable uint64_t     buffer_offset_;
   mutable size_t       buffer_len_;
 };
+
+class ReadaheadSequentialFile : public SequentialFile {
+ public:
+  ReadaheadSequentialFile(std::unique_ptr<SequentialFile>&& file,
+                          size_t readahead_size)
+      : SequentialFile(file->GetFileName()),
+        file_(std::move(file)),
+        readahead_size_(readahead_size),
+        buffer_(new char[readahead_size]),
+        buffer_offset_(0),
+        buffer_len_(0) {}
+
+  ReadaheadSequentialFile(const ReadaheadSequentialFile&) = delete;
+
+  ReadaheadSequentialFile& operator=(const ReadaheadSequentialFile&) = delete;
+
+  virtual Status Read(size_t n, Slice* result, char* scratch) override {
+    size_t copied = std::min(n, buffer_len_ - buffer_offset_);
+    memcpy(scratch, buffer_.get() + buffer_offset_, copied);
+    buffer_offset_ += copied;
+    if (copied < n) {
+      if (n - copied >= readahead_size_) {
+        Slice rest;
+        Status s = file_->Read(n - copied, &rest, scratch + copied);
+        if (!s.ok()) {
+          return s;
+        }
+        if (rest.data() != scratch + copied) {
+          memmove(scratch + copied, rest.data(), rest.size());
+        }
+        copied += rest.size();
+      } else {
+        Slice readahead_result;
+        Status s = file_->Read(readahead_size_, &readahead_result,
+                               buffer_.get());
+        if (!s.ok()) {
+          return s;
+        }
+        if (readahead_result.data() != buffer_.get()) {
+          memmove(buffer_.get(), readahead_result.data(),
+                  readahead_result.size());
+        }
+        buffer_len_ = readahead_result.size();
+        buffer_offset_ = std::min(n - copied, buffer_len_);
+        memcpy(scratch + copied, buffer_.get(), buffer_offset_);
+        copied += buffer_offset_;
+      }
+    }
+    *result = Slice(scratch, copied);
+    return Status::OK();
+  }
+
+  virtual Status Skip(uint64_t n) override {
+    size_t skipped =
+        static_cast<size_t>(std::min<uint64_t>(n, buffer_len_ - buffer_offset_));
+    buffer_offset_ += skipped;
+    if (skipped < n) {
+      return file_->Skip(n - skipped);
+    }
+    return Status::OK();
+  }
+
+  virtual Status InvalidateCache(size_t offset, size_t length) override {
+    return file_->InvalidateCache(offset, length);
+  }
+
+ private:
+  std::unique_ptr<SequentialFile> file_;
+  const size_t readahead_size_;
+  std::unique_ptr<char[]> buffer_;
+  size_t buffer_offset_;
+  size_t buffer_len_;
+};
 }  // namespace
 
 std::unique_ptr<RandomAccessFile> NewReadaheadRandomAccessFile(
@@ -467,6 +540,13 @@ std::unique_ptr<RandomAccessFile> NewReadaheadRandomAccessFile(
   return result;
 }
 
+std::unique_ptr<SequentialFile> NewReadaheadSequentialFile(
+    std::unique_ptr<SequentialFile>&& file, size_t readahead_size) {
+  std::unique_ptr<SequentialFile> result(
+      new ReadaheadSequentialFile(std::move(file), readahead_size));
+  return result;
+}
+
 Status NewWritableFile(Env* env, const std::string& fname,
                        unique_ptr<WritableFile>* result,
                        const EnvOptions& options) {
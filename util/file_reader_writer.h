@@ -20,6 +20,11 @@ class HistogramImpl;
 std::unique_ptr<RandomAccessFile> NewReadaheadRandomAccessFile(
   std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size);
 
+// Reads file readahead_size bytes at a time. A read that hits the end of the
+// file gets what is there, and the next one what was appended since.
+std::unique_ptr<SequentialFile> NewReadaheadSequentialFile(
+    std::unique_ptr<SequentialFile>&& file, size_t readahead_size);
+
 class SequentialFileReader {
  private:
   std::unique_ptr<SequentialFile> file_;
@@ -0,0 +1,263 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/memory_allocator.h"
+
+#ifndef OS_WIN
+#include <sys/mman.h>
+#endif
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef VIDARDB_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#endif
+
+#include "port/port.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace vidardb {
+
+namespace {
+
+// Every buffer is preceded by a header recording its size class, so that
+// Deallocate() knows the free list to return it to. The header keeps the
+// buffers 16-byte aligned.
+const size_t kHeaderSize = 16;
+const uint32_t kNoSizeClass = UINT32_MAX;
+const size_t kMinSlotSize = 512;
+
+// Serves the buffers from slabs: chunks of chunk_size bytes are cut into
+// slots of one size class, and a freed slot goes back to the free list of its
+// class to be reused by the next buffer of a similar size. Chunks are only
+// released with the allocator.
+class SlabMemoryAllocator : public MemoryAllocator {
+ public:
+  SlabMemoryAllocator(size_t chunk_size, bool huge_page);
+
+  ~SlabMemoryAllocator();
+
+  virtual const char* Name() const override {
+    return huge_page_ ? "HugePageMemoryAllocator" : "SlabMemoryAllocator";
+  }
+
+  virtual void* Allocate(size_t size) override;
+
+  virtual void Deallocate(void* p) override;
+
+  virtual size_t UsableSize(void* p, size_t allocation_size) const override;
+
+ private:
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+
+  struct SizeClass {
+    port::Mutex mutex;
+    FreeSlot* free_list = nullptr;
+  };
+
+  // Carve a new chunk into slots of size class i.
+  // REQUIRES: classes_[i]->mutex is held
+  bool Refill(size_t i);
+
+  char* NewChunk();
+
+  const size_t chunk_size_;
+  const bool huge_page_;
+  // slot sizes, including the header, in ascending order
+  std::vector<size_t> slot_sizes_;
+  std::vector<std::unique_ptr<SizeClass>> classes_;
+
+  port::Mutex chunk_mutex_;
+  std::vector<char*> chunks_;
+  bool hugetlb_failed_;
+};
+
+SlabMemoryAllocator::SlabMemoryAllocator(size_t chunk_size, bool huge_page)
+    : chunk_size_(std::max(chunk_size, kMinSlotSize * 8)),
+      huge_page_(huge_page),
+      hugetlb_failed_(!huge_page) {
+  // Two size classes per power of two keep the internal fragmentation below
+  // a third, and at least 8 slots fit in one chunk.
+  for (size_t s = kMinSlotSize; s <= chunk_size_ / 8; s *= 2) {
+    slot_sizes_.push_back(s);
+    if (s + s / 2 <= chunk_size_ / 8) {
+      slot_sizes_.push_back(s + s / 2);
+    }
+  }
+  for (size_t i = 0; i < slot_sizes_.size(); i++) {
+    classes_.emplace_back(new SizeClass());
+  }
+}
+
+SlabMemoryAllocator::~SlabMemoryAllocator() {
+  for (char* chunk : chunks_) {
+#ifndef OS_WIN
+    munmap(chunk, chunk_size_);
+#else
+    delete[] chunk;
+#endif
+  }
+}
+
+char* SlabMemoryAllocator::NewChunk() {
+  MutexLock l(&chunk_mutex_);
+  chunks_.reserve(chunks_.size() + 1);
+#ifndef OS_WIN
+  void* addr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (!hugetlb_failed_) {
+    addr = mmap(nullptr, chunk_size_, (PROT_READ | PROT_WRITE),
+                (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB), -1, 0);
+    // don't pay a failing mmap() for every chunk when none is reserved
+    hugetlb_failed_ = (addr == MAP_FAILED);
+  }
+#endif
+  if (addr == MAP_FAILED) {
+    addr = mmap(nullptr, chunk_size_, (PROT_READ | PROT_WRITE),
+                (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+    if (addr == MAP_FAILED) {
+      return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_page_) {
+      madvise(addr, chunk_size_, MADV_HUGEPAGE);
+    }
+#endif
+  }
+  char* chunk = reinterpret_cast<char*>(addr);
+#else
+  char* chunk = new char[chunk_size_];
+#endif
+  chunks_.push_back(chunk);
+  return chunk;
+}
+
+bool SlabMemoryAllocator::Refill(size_t i) {
+  char* chunk = NewChunk();
+  if (chunk == nullptr) {
+    return false;
+  }
+  const size_t slot_size = slot_sizes_[i];
+  SizeClass* size_class = classes_[i].get();
+  for (size_t offset = 0; offset + slot_size <= chunk_size_;
+       offset += slot_size) {
+    auto slot = reinterpret_cast<FreeSlot*>(chunk + offset);
+    slot->next = size_class->free_list;
+    size_class->free_list = slot;
+  }
+  return true;
+}
+
+void* SlabMemoryAllocator::Allocate(size_t size) {
+  const size_t needed = size + kHeaderSize;
+  auto it = std::lower_bound(slot_sizes_.begin(), slot_sizes_.end(), needed);
+  uint32_t size_class = kNoSizeClass;
+  char* slot = nullptr;
+  if (it != slot_sizes_.end()) {
+    size_t i = it - slot_sizes_.begin();
+    SizeClass* c = classes_[i].get();
+    MutexLock l(&c->mutex);
+    if (c->free_list != nullptr || Refill(i)) {
+      slot = reinterpret_cast<char*>(c->free_list);
+      c->free_list = c->free_list->next;
+      size_class = static_cast<uint32_t>(i);
+    }
+  }
+  if (slot == nullptr) {
+    // too large for a size class, or out of chunks
+    slot = new char[needed];
+  }
+  *reinterpret_cast<uint32_t*>(slot) = size_class;
+  return slot + kHeaderSize;
+}
+
+void SlabMemoryAllocator::Deallocate(void* p) {
+  char* slot = reinterpret_cast<char*>(p) - kHeaderSize;
+  uint32_t size_class = *reinterpret_cast<uint32_t*>(slot);
+  if (size_class == kNoSizeClass) {
+    delete[] slot;
+    return;
+  }
+  SizeClass* c = classes_[size_class].get();
+  MutexLock l(&c->mutex);
+  auto free_slot = reinterpret_cast<FreeSlot*>(slot);
+  free_slot->next = c->free_list;
+  c->free_list = free_slot;
+}
+
+size_t SlabMemoryAllocator::UsableSize(void* p,
+                                       size_t allocation_size) const {
+  char* slot = reinterpret_cast<char*>(p) - kHeaderSize;
+  uint32_t size_class = *reinterpret_cast<uint32_t*>(slot);
+  if (size_class == kNoSizeClass) {
+    return allocation_size + kHeaderSize;
+  }
+  return slot_sizes_[size_class];
+}
+
+#ifdef VIDARDB_JEMALLOC
+// Allocates from a dedicated jemalloc arena, so that the churn of block
+// buffers does not fragment the arenas of the rest of the process.
+class JemallocMemoryAllocator : public MemoryAllocator {
+ public:
+  explicit JemallocMemoryAllocator(unsigned arena_index)
+      : flags_(MALLOCX_ARENA(arena_index) | MALLOCX_TCACHE_NONE) {}
+
+  virtual const char* Name() const override {
+    return "JemallocMemoryAllocator";
+  }
+
+  virtual void* Allocate(size_t size) override {
+    return mallocx(size, flags_);
+  }
+
+  virtual void Deallocate(void* p) override { dallocx(p, flags_); }
+
+  virtual size_t UsableSize(void* p, size_t allocation_size) const override {
+    return sallocx(p, flags_);
+  }
+
+ private:
+  const int flags_;
+};
+#endif  // VIDARDB_JEMALLOC
+
+}  // anonymous namespace
+
+std::shared_ptr<MemoryAllocator> NewSlabMemoryAllocator(size_t chunk_size) {
+  return std::make_shared<SlabMemoryAllocator>(chunk_size,
+                                               false /* huge_page */);
+}
+
+std::shared_ptr<MemoryAllocator> NewHugePageMemoryAllocator(
+    size_t huge_page_size) {
+  return std::make_shared<SlabMemoryAllocator>(huge_page_size,
+                                               true /* huge_page */);
+}
+
+Status NewJemallocMemoryAllocator(
+    std::shared_ptr<MemoryAllocator>* memory_allocator) {
+#ifdef VIDARDB_JEMALLOC
+  unsigned arena_index = 0;
+  size_t arena_index_size = sizeof(arena_index);
+  int ret = mallctl("arenas.create", &arena_index, &arena_index_size,
+                    nullptr, 0);
+  if (ret != 0) {
+    return Status::IOError("Failed to create jemalloc arena, error code: " +
+                           ToString(ret));
+  }
+  memory_allocator->reset(new JemallocMemoryAllocator(arena_index));
+  return Status::OK();
+#else
+  memory_allocator->reset();
+  return Status::NotSupported("Not compiled with jemalloc");
+#endif  // VIDARDB_JEMALLOC
+}
+
+}  // namespace vidardb
@@ -68,10 +68,18 @@ void MutableCFOptions::Dump(Logger* log) const {
       max_write_buffer_number);
   Log(log, "                         arena_block_size: %" VIDARDB_PRIszt,
       arena_block_size);
+  Log(log, "                  memtable_huge_page_size: %" VIDARDB_PRIszt,
+      memtable_huge_page_size);
+  Log(log, "              memtable_bloom_bits_per_key: %" PRIu32,
+      memtable_bloom_bits_per_key);
+  Log(log, "                 inplace_update_num_locks: %" VIDARDB_PRIszt,
+      inplace_update_num_locks);
   Log(log, "                 disable_auto_compactions: %d",
       disable_auto_compactions);
   Log(log, "       level0_file_num_compaction_trigger: %d",
       level0_file_num_compaction_trigger);
+  Log(log, "                        compaction_weight: %" PRIu32,
+      compaction_weight);
   Log(log, "           max_grandparent_overlap_factor: %d",
       max_grandparent_overlap_factor);
   Log(log, "               expanded_compaction_factor: %d",
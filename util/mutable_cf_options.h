@@ -17,9 +17,13 @@ struct MutableCFOptions {
       : write_buffer_size(options.write_buffer_size),
         max_write_buffer_number(options.max_write_buffer_number),
         arena_block_size(options.arena_block_size),
+        memtable_huge_page_size(options.memtable_huge_page_size),
+        memtable_bloom_bits_per_key(options.memtable_bloom_bits_per_key),
+        inplace_update_num_locks(options.inplace_update_num_locks),
         disable_auto_compactions(options.disable_auto_compactions),
         level0_file_num_compaction_trigger(
             options.level0_file_num_compaction_trigger),
+        compaction_weight(options.compaction_weight),
         compaction_pri(options.compaction_pri),
         max_grandparent_overlap_factor(options.max_grandparent_overlap_factor),
         expanded_compaction_factor(options.expanded_compaction_factor),
@@ -42,8 +46,12 @@ struct MutableCFOptions {
       : write_buffer_size(0),
         max_write_buffer_number(0),
         arena_block_size(0),
+        memtable_huge_page_size(0),
+        memtable_bloom_bits_per_key(0),
+        inplace_update_num_locks(0),
         disable_auto_compactions(false),
         level0_file_num_compaction_trigger(0),
+        compaction_weight(1),
         compaction_pri(kByCompensatedSize),
         max_grandparent_overlap_factor(0),
         expanded_compaction_factor(0),
@@ -82,10 +90,14 @@ struct MutableCFOptions {
   size_t write_buffer_size;
   int max_write_buffer_number;
   size_t arena_block_size;
+  size_t memtable_huge_page_size;
+  uint32_t memtable_bloom_bits_per_key;
+  size_t inplace_update_num_locks;
 
   // Compaction related options
   bool disable_auto_compactions;
   int level0_file_num_compaction_trigger;
+  uint32_t compaction_weight;
   CompactionPri compaction_pri;
   int max_grandparent_overlap_factor;
   int expanded_compaction_factor;
@@ -23,6 +23,7 @@
 #include <limits>
 
 #include "vidardb/cache.h"
+#include "vidardb/compaction_filter.h"
 #include "vidardb/comparator.h"
 #include "vidardb/env.h"
 #include "vidardb/sst_file_manager.h"
@@ -41,6 +42,8 @@ ImmutableCFOptions::ImmutableCFOptions(const Options& options)
       compaction_options_fifo(options.compaction_options_fifo),
       comparator(options.comparator),
       splitter(options.splitter.get()),
+      inplace_update_support(options.inplace_update_support),
+      compaction_filter(options.compaction_filter),
       info_log(options.info_log.get()),
       statistics(options.statistics.get()),
       env(options.env),
@@ -64,11 +67,14 @@ ImmutableCFOptions::ImmutableCFOptions(const Options& options)
       compaction_readahead_size(options.compaction_readahead_size),
       num_levels(options.num_levels),
       listeners(options.listeners),
-      row_cache(options.row_cache) {}
+      row_cache(options.row_cache),
+      min_blob_size(options.min_blob_size),
+      blob_gc_garbage_ratio(options.blob_gc_garbage_ratio) {}
 
 ColumnFamilyOptions::ColumnFamilyOptions()
     : comparator(BytewiseComparator()),
       splitter(nullptr),  // compatible with row store
+      compaction_filter(nullptr),
       write_buffer_size(512 << 20),
       max_write_buffer_number(2),
       min_write_buffer_number_to_merge(1),
@@ -77,6 +83,7 @@ ColumnFamilyOptions::ColumnFamilyOptions()
       bottommost_compression(kDisableCompressionOption),
       num_levels(7),
       level0_file_num_compaction_trigger(4),
+      compaction_weight(1),
       target_file_size_base(64 * 1048576),
       target_file_size_multiplier(1),
       max_bytes_for_level_base(256 * 1048576),
@@ -86,6 +93,10 @@ ColumnFamilyOptions::ColumnFamilyOptions()
       source_compaction_factor(1),
       max_grandparent_overlap_factor(10),
       arena_block_size(0),
+      memtable_huge_page_size(0),
+      memtable_bloom_bits_per_key(0),
+      inplace_update_support(false),
+      inplace_update_num_locks(10000),
       disable_auto_compactions(false),
       compaction_style(kCompactionStyleLevel),
       compaction_pri(kByCompensatedSize),
@@ -94,13 +105,16 @@ ColumnFamilyOptions::ColumnFamilyOptions()
       table_factory(
           std::shared_ptr<TableFactory>(new BlockBasedTableFactory())),
       paranoid_file_checks(false),
-      report_bg_io_stats(false) {
+      report_bg_io_stats(false),
+      min_blob_size(0),
+      blob_gc_garbage_ratio(0.5) {
   assert(memtable_factory.get() != nullptr);
 }
 
 ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
     : comparator(options.comparator),
       splitter(options.splitter),
+      compaction_filter(options.compaction_filter),
       write_buffer_size(options.write_buffer_size),
       max_write_buffer_number(options.max_write_buffer_number),
       min_write_buffer_number_to_merge(
@@ -114,6 +128,7 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
       num_levels(options.num_levels),
       level0_file_num_compaction_trigger(
           options.level0_file_num_compaction_trigger),
+      compaction_weight(options.compaction_weight),
       target_file_size_base(options.target_file_size_base),
       target_file_size_multiplier(options.target_file_size_multiplier),
       max_bytes_for_level_base(options.max_bytes_for_level_base),
@@ -124,6 +139,10 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
       source_compaction_factor(options.source_compaction_factor),
       max_grandparent_overlap_factor(options.max_grandparent_overlap_factor),
       arena_block_size(options.arena_block_size),
+      memtable_huge_page_size(options.memtable_huge_page_size),
+      memtable_bloom_bits_per_key(options.memtable_bloom_bits_per_key),
+      inplace_update_support(options.inplace_update_support),
+      inplace_update_num_locks(options.inplace_update_num_locks),
       disable_auto_compactions(options.disable_auto_compactions),
       compaction_style(options.compaction_style),
       compaction_pri(options.compaction_pri),
@@ -134,7 +153,9 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
       table_properties_collector_factories(
           options.table_properties_collector_factories),
       paranoid_file_checks(options.paranoid_file_checks),
-      report_bg_io_stats(options.report_bg_io_stats) {
+      report_bg_io_stats(options.report_bg_io_stats),
+      min_blob_size(options.min_blob_size),
+      blob_gc_garbage_ratio(options.blob_gc_garbage_ratio) {
   assert(memtable_factory.get() != nullptr);
   if (max_bytes_for_level_multiplier_additional.size() <
       static_cast<unsigned int>(num_levels)) {
@@ -157,6 +178,7 @@ DBOptions::DBOptions()
 #endif  // NDEBUG
       max_open_files(-1),
       max_file_opening_threads(16),
+      async_read_threads(4),
       max_total_wal_size(0),
       statistics(nullptr),
       disableDataSync(false),
@@ -167,12 +189,14 @@ DBOptions::DBOptions()
       base_background_compactions(1),
       max_background_compactions(1),
       max_subcompactions(1),
+      max_subflushes(1),
       max_background_flushes(1),
       max_log_file_size(0),
       log_file_time_to_roll(0),
       keep_log_file_num(1000),
       recycle_log_file_num(0),
       max_manifest_file_size(std::numeric_limits<uint64_t>::max()),
+      manifest_snapshot_ratio(8),
       table_cache_numshardbits(6),
       WAL_ttl_seconds(0),
       WAL_size_limit_MB(0),
@@ -200,9 +224,11 @@ DBOptions::DBOptions()
       write_thread_slow_yield_usec(3),
       skip_stats_update_on_db_open(false),
       wal_recovery_mode(WALRecoveryMode::kPointInTimeRecovery),
+      wal_checksum(kCRC32c),
       row_cache(nullptr),
       fail_if_options_file_error(false),
       dump_malloc_stats(false),
+      atomic_flush(false),
       show_key_fun(nullptr),  // Shichao
       export_path("") {       // Shichao
 }
@@ -218,6 +244,7 @@ DBOptions::DBOptions(const Options& options)
       info_log_level(options.info_log_level),
       max_open_files(options.max_open_files),
       max_file_opening_threads(options.max_file_opening_threads),
+      async_read_threads(options.async_read_threads),
       max_total_wal_size(options.max_total_wal_size),
       statistics(options.statistics),
       disableDataSync(options.disableDataSync),
@@ -230,12 +257,14 @@ DBOptions::DBOptions(const Options& options)
       base_background_compactions(options.base_background_compactions),
       max_background_compactions(options.max_background_compactions),
       max_subcompactions(options.max_subcompactions),
+      max_subflushes(options.max_subflushes),
       max_background_flushes(options.max_background_flushes),
       max_log_file_size(options.max_log_file_size),
       log_file_time_to_roll(options.log_file_time_to_roll),
       keep_log_file_num(options.keep_log_file_num),
       recycle_log_file_num(options.recycle_log_file_num),
       max_manifest_file_size(options.max_manifest_file_size),
+      manifest_snapshot_ratio(options.manifest_snapshot_ratio),
       table_cache_numshardbits(options.table_cache_numshardbits),
       WAL_ttl_seconds(options.WAL_ttl_seconds),
       WAL_size_limit_MB(options.WAL_size_limit_MB),
@@ -264,9 +293,11 @@ DBOptions::DBOptions(const Options& options)
       write_thread_slow_yield_usec(options.write_thread_slow_yield_usec),
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
       wal_recovery_mode(options.wal_recovery_mode),
+      wal_checksum(options.wal_checksum),
       row_cache(options.row_cache),
       fail_if_options_file_error(options.fail_if_options_file_error),
       dump_malloc_stats(options.dump_malloc_stats),
+      atomic_flush(options.atomic_flush),
       show_key_fun(options.show_key_fun),  // Shichao
       export_path(options.export_path) {   // Shichao
 }
@@ -284,6 +315,7 @@ void DBOptions::Dump(Logger* log) const {
     Header(log, "          Options.max_open_files: %d", max_open_files);
     Header(log,
         "Options.max_file_opening_threads: %d", max_file_opening_threads);
+    Header(log, "      Options.async_read_threads: %d", async_read_threads);
     Header(log,
         "      Options.max_total_wal_size: %" PRIu64, max_total_wal_size);
     Header(log, "       Options.disableDataSync: %d", disableDataSync);
@@ -292,6 +324,8 @@ void DBOptions::Dump(Logger* log) const {
          max_log_file_size);
     Header(log, "Options.max_manifest_file_size: %" PRIu64,
          max_manifest_file_size);
+    Header(log, "Options.manifest_snapshot_ratio: %" PRIu32,
+         manifest_snapshot_ratio);
     Header(log, "     Options.log_file_time_to_roll: %" VIDARDB_PRIszt,
          log_file_time_to_roll);
     Header(log, "     Options.keep_log_file_num: %" VIDARDB_PRIszt,
@@ -318,6 +352,8 @@ void DBOptions::Dump(Logger* log) const {
         max_background_compactions);
     Header(log, "                     Options.max_subcompactions: %" PRIu32,
         max_subcompactions);
+    Header(log, "                         Options.max_subflushes: %" PRIu32,
+        max_subflushes);
     Header(log, "                 Options.max_background_flushes: %d",
         max_background_flushes);
     Header(log, "                        Options.WAL_ttl_seconds: %" PRIu64,
@@ -371,8 +407,12 @@ void DBOptions::Dump(Logger* log) const {
         wal_bytes_per_sync);
     Header(log, "                       Options.wal_recovery_mode: %d",
         wal_recovery_mode);
+    Header(log, "                            Options.wal_checksum: %d",
+        wal_checksum);
     Header(log, "                  Options.enable_thread_tracking: %d",
         enable_thread_tracking);
+    Header(log, "                            Options.atomic_flush: %d",
+        atomic_flush);
     Header(log, "         Options.allow_concurrent_memtable_write: %d",
            allow_concurrent_memtable_write);
     Header(log, "            Options.write_thread_slow_yield_usec: %" PRIu64,
@@ -390,6 +430,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
   if (splitter) {
     Header(log, "              Options.splitter: %s", splitter->Name());
   }
+  Header(log, "       Options.compaction_filter: %s",
+         compaction_filter ? compaction_filter->Name() : "None");
   Header(log, "        Options.memtable_factory: %s", memtable_factory->Name());
   Header(log, "           Options.table_factory: %s", table_factory->Name());
   Header(log, "           table_factory options: %s",
@@ -426,6 +468,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
         compression_opts.max_dict_bytes);
     Header(log, "     Options.level0_file_num_compaction_trigger: %d",
         level0_file_num_compaction_trigger);
+    Header(log, "                      Options.compaction_weight: %" PRIu32,
+        compaction_weight);
     Header(log, "                  Options.target_file_size_base: %" PRIu64,
         target_file_size_base);
     Header(log, "            Options.target_file_size_multiplier: %d",
@@ -451,6 +495,16 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     Header(log,
          "                       Options.arena_block_size: %" VIDARDB_PRIszt,
          arena_block_size);
+    Header(log,
+         "                Options.memtable_huge_page_size: %" VIDARDB_PRIszt,
+         memtable_huge_page_size);
+    Header(log, "            Options.memtable_bloom_bits_per_key: %" PRIu32,
+           memtable_bloom_bits_per_key);
+    Header(log, "                 Options.inplace_update_support: %d",
+           inplace_update_support);
+    Header(log,
+           "               Options.inplace_update_num_locks: %" VIDARDB_PRIszt,
+           inplace_update_num_locks);
     Header(log, "               Options.disable_auto_compactions: %d",
         disable_auto_compactions);
     Header(log, "          Options.verify_checksums_in_compaction: %d",
@@ -473,6 +527,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
          paranoid_file_checks);
     Header(log, "               Options.report_bg_io_stats: %d",
            report_bg_io_stats);
+    Header(log, "                    Options.min_blob_size: %" PRIu64,
+           min_blob_size);
+    Header(log, "            Options.blob_gc_garbage_ratio: %f",
+           blob_gc_garbage_ratio);
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
@@ -635,6 +693,7 @@ ReadOptions::ReadOptions()
       total_order_seek(false),
       pin_data(false),
       readahead_size(0),
+      prefetch_blocks(0),
       batch_capacity(0),
       range_query_meta(nullptr),
       result_key_size(0),
@@ -649,6 +708,7 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       total_order_seek(false),
       pin_data(false),
       readahead_size(0),
+      prefetch_blocks(0),
       batch_capacity(0),
       range_query_meta(nullptr),
       result_key_size(0),
@@ -293,6 +293,10 @@ bool ParseOptionHelper(char* opt_address, const OptionType& opt_type,
       return ParseEnum<WALRecoveryMode>(
           wal_recovery_mode_string_map, value,
           reinterpret_cast<WALRecoveryMode*>(opt_address));
+    case OptionType::kChecksumType:
+      return ParseEnum<ChecksumType>(
+          checksum_type_string_map, value,
+          reinterpret_cast<ChecksumType*>(opt_address));
     case OptionType::kAccessHint:
       return ParseEnum<DBOptions::AccessHint>(
           access_hint_string_map, value,
@@ -394,6 +398,10 @@ bool SerializeSingleOptionHelper(const char* opt_address,
       return SerializeEnum<WALRecoveryMode>(
           wal_recovery_mode_string_map,
           *reinterpret_cast<const WALRecoveryMode*>(opt_address), value);
+    case OptionType::kChecksumType:
+      return SerializeEnum<ChecksumType>(
+          checksum_type_string_map,
+          *reinterpret_cast<const ChecksumType*>(opt_address), value);
     case OptionType::kAccessHint:
       return SerializeEnum<DBOptions::AccessHint>(
           access_hint_string_map,
@@ -416,6 +424,12 @@ bool ParseMemtableOptions(const std::string& name, const std::string& value,
     new_options->write_buffer_size = ParseSizeT(value);
   } else if (name == "arena_block_size") {
     new_options->arena_block_size = ParseSizeT(value);
+  } else if (name == "memtable_huge_page_size") {
+    new_options->memtable_huge_page_size = ParseSizeT(value);
+  } else if (name == "memtable_bloom_bits_per_key") {
+    new_options->memtable_bloom_bits_per_key = ParseUint32(value);
+  } else if (name == "inplace_update_num_locks") {
+    new_options->inplace_update_num_locks = ParseSizeT(value);
   } else if (name == "max_write_buffer_number") {
     new_options->max_write_buffer_number = ParseInt(value);
   } else {
@@ -431,6 +445,8 @@ bool ParseCompactionOptions(const std::string& name, const std::string& value,
     new_options->disable_auto_compactions = ParseBoolean(name, value);
   } else if (name == "level0_file_num_compaction_trigger") {
     new_options->level0_file_num_compaction_trigger = ParseInt(value);
+  } else if (name == "compaction_weight") {
+    new_options->compaction_weight = ParseUint32(value);
   } else if (name == "max_grandparent_overlap_factor") {
     new_options->max_grandparent_overlap_factor = ParseInt(value);
   } else if (name == "expanded_compaction_factor") {
@@ -1143,12 +1159,18 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.write_buffer_size = mutable_cf_options.write_buffer_size;
   cf_opts.max_write_buffer_number = mutable_cf_options.max_write_buffer_number;
   cf_opts.arena_block_size = mutable_cf_options.arena_block_size;
+  cf_opts.memtable_huge_page_size = mutable_cf_options.memtable_huge_page_size;
+  cf_opts.memtable_bloom_bits_per_key =
+      mutable_cf_options.memtable_bloom_bits_per_key;
+  cf_opts.inplace_update_num_locks =
+      mutable_cf_options.inplace_update_num_locks;
 
   // Compaction related options
   cf_opts.disable_auto_compactions =
       mutable_cf_options.disable_auto_compactions;
   cf_opts.level0_file_num_compaction_trigger =
       mutable_cf_options.level0_file_num_compaction_trigger;
+  cf_opts.compaction_weight = mutable_cf_options.compaction_weight;
   cf_opts.max_grandparent_overlap_factor =
       mutable_cf_options.max_grandparent_overlap_factor;
   cf_opts.expanded_compaction_factor =
@@ -87,6 +87,7 @@ enum class OptionType {
   kFlushBlockPolicyFactory,
   kEncodingType,
   kWALRecoveryMode,
+  kChecksumType,
   kAccessHint,
   kInfoLogLevel,
   kUnknown
@@ -220,6 +221,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"max_background_flushes",
      {offsetof(struct DBOptions, max_background_flushes), OptionType::kInt,
       OptionVerificationType::kNormal}},
+    {"async_read_threads",
+     {offsetof(struct DBOptions, async_read_threads), OptionType::kInt,
+      OptionVerificationType::kNormal}},
     {"max_file_opening_threads",
      {offsetof(struct DBOptions, max_file_opening_threads), OptionType::kInt,
       OptionVerificationType::kNormal}},
@@ -256,6 +260,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"max_subcompactions",
      {offsetof(struct DBOptions, max_subcompactions), OptionType::kUInt32T,
       OptionVerificationType::kNormal}},
+    {"max_subflushes",
+     {offsetof(struct DBOptions, max_subflushes), OptionType::kUInt32T,
+      OptionVerificationType::kNormal}},
     {"WAL_size_limit_MB",
      {offsetof(struct DBOptions, WAL_size_limit_MB), OptionType::kUInt64T,
       OptionVerificationType::kNormal}},
@@ -274,6 +281,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"max_manifest_file_size",
      {offsetof(struct DBOptions, max_manifest_file_size), OptionType::kUInt64T,
       OptionVerificationType::kNormal}},
+    {"manifest_snapshot_ratio",
+     {offsetof(struct DBOptions, manifest_snapshot_ratio),
+      OptionType::kUInt32T, OptionVerificationType::kNormal}},
     {"max_total_wal_size",
      {offsetof(struct DBOptions, max_total_wal_size), OptionType::kUInt64T,
       OptionVerificationType::kNormal}},
@@ -292,6 +302,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"wal_recovery_mode",
      {offsetof(struct DBOptions, wal_recovery_mode),
       OptionType::kWALRecoveryMode, OptionVerificationType::kNormal}},
+    {"wal_checksum",
+     {offsetof(struct DBOptions, wal_checksum), OptionType::kChecksumType,
+      OptionVerificationType::kNormal}},
     {"write_thread_slow_yield_usec",
      {offsetof(struct DBOptions, write_thread_slow_yield_usec),
       OptionType::kUInt64T, OptionVerificationType::kNormal}},
@@ -303,6 +316,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
       OptionVerificationType::kNormal}},
     {"dump_malloc_stats",
      {offsetof(struct DBOptions, dump_malloc_stats), OptionType::kBoolean,
+      OptionVerificationType::kNormal}},
+    {"atomic_flush",
+     {offsetof(struct DBOptions, atomic_flush), OptionType::kBoolean,
       OptionVerificationType::kNormal}}};
 
 static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
@@ -331,6 +347,12 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
     {"paranoid_file_checks",
      {offsetof(struct ColumnFamilyOptions, paranoid_file_checks),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"min_blob_size",
+     {offsetof(struct ColumnFamilyOptions, min_blob_size),
+      OptionType::kUInt64T, OptionVerificationType::kNormal}},
+    {"blob_gc_garbage_ratio",
+     {offsetof(struct ColumnFamilyOptions, blob_gc_garbage_ratio),
+      OptionType::kDouble, OptionVerificationType::kNormal}},
     {"verify_checksums_in_compaction",
      {offsetof(struct ColumnFamilyOptions, verify_checksums_in_compaction),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
@@ -340,6 +362,9 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
     {"level0_file_num_compaction_trigger",
      {offsetof(struct ColumnFamilyOptions, level0_file_num_compaction_trigger),
       OptionType::kInt, OptionVerificationType::kNormal}},
+    {"compaction_weight",
+     {offsetof(struct ColumnFamilyOptions, compaction_weight),
+      OptionType::kUInt32T, OptionVerificationType::kNormal}},
     {"max_bytes_for_level_multiplier",
      {offsetof(struct ColumnFamilyOptions, max_bytes_for_level_multiplier),
       OptionType::kInt, OptionVerificationType::kNormal}},
@@ -367,6 +392,18 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
     {"arena_block_size",
      {offsetof(struct ColumnFamilyOptions, arena_block_size),
       OptionType::kSizeT, OptionVerificationType::kNormal}},
+    {"memtable_huge_page_size",
+     {offsetof(struct ColumnFamilyOptions, memtable_huge_page_size),
+      OptionType::kSizeT, OptionVerificationType::kNormal}},
+    {"memtable_bloom_bits_per_key",
+     {offsetof(struct ColumnFamilyOptions, memtable_bloom_bits_per_key),
+      OptionType::kUInt32T, OptionVerificationType::kNormal}},
+    {"inplace_update_support",
+     {offsetof(struct ColumnFamilyOptions, inplace_update_support),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"inplace_update_num_locks",
+     {offsetof(struct ColumnFamilyOptions, inplace_update_num_locks),
+      OptionType::kSizeT, OptionVerificationType::kNormal}},
     {"write_buffer_size",
      {offsetof(struct ColumnFamilyOptions, write_buffer_size),
       OptionType::kSizeT, OptionVerificationType::kNormal}},
@@ -422,7 +459,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
           OptionType::kInt, OptionVerificationType::kNormal}},
         {"index_block_restart_interval",
          {offsetof(struct BlockBasedTableOptions, index_block_restart_interval),
-          OptionType::kInt, OptionVerificationType::kNormal}}};
+          OptionType::kInt, OptionVerificationType::kNormal}},
+        {"checksum",
+         {offsetof(struct BlockBasedTableOptions, checksum),
+          OptionType::kChecksumType, OptionVerificationType::kNormal}}};
 
 static std::unordered_map<std::string, CompressionType>
     compression_type_string_map = {
@@ -432,6 +472,9 @@ static std::unordered_map<std::string, CompressionType>
         {"kBZip2Compression", kBZip2Compression},
         {"kDisableCompressionOption", kDisableCompressionOption}};
 
+static std::unordered_map<std::string, ChecksumType> checksum_type_string_map =
+    {{"kCRC32c", kCRC32c}, {"kxxHash64", kxxHash64}, {"kXXH3", kXXH3}};
+
 static std::unordered_map<std::string, CompactionStyle>
     compaction_style_string_map = {
         {"kCompactionStyleLevel", kCompactionStyleLevel},
@@ -552,6 +552,9 @@ bool AreEqualOptions(
     case OptionType::kWALRecoveryMode:
       return (*reinterpret_cast<const WALRecoveryMode*>(offset1) ==
               *reinterpret_cast<const WALRecoveryMode*>(offset2));
+    case OptionType::kChecksumType:
+      return (*reinterpret_cast<const ChecksumType*>(offset1) ==
+              *reinterpret_cast<const ChecksumType*>(offset2));
     case OptionType::kAccessHint:
       return (*reinterpret_cast<const DBOptions::AccessHint*>(offset1) ==
               *reinterpret_cast<const DBOptions::AccessHint*>(offset2));
@@ -58,6 +58,14 @@ void PipeSplitter::Append(std::string& ss, const Slice& s, bool last) const {
   }
 }
 
+size_t PipeSplitter::StitchedSize(const std::vector<Slice>& v) const {
+  size_t size = v.empty() ? 0 : v.size() - 1;  // delimiters
+  for (const auto& s : v) {
+    size += s.size_;
+  }
+  return size;
+}
+
 Splitter* NewPipeSplitter() { return new PipeSplitter(); }
 
 std::vector<Slice> EncodingSplitter::Split(const Slice& s) const {
@@ -89,6 +97,14 @@ void EncodingSplitter::Append(std::string& ss, const Slice& s, bool last) const
   PutLengthPrefixedSlice(&ss, s);
 }
 
+size_t EncodingSplitter::StitchedSize(const std::vector<Slice>& v) const {
+  size_t size = 0;
+  for (const auto& s : v) {
+    size += VarintLength(s.size_) + s.size_;
+  }
+  return size;
+}
+
 Splitter* NewEncodingSplitter() { return new EncodingSplitter(); }
 
 }  // namespace vidardb
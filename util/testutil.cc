@@ -216,11 +216,13 @@ void RandomInitDBOptions(DBOptions* db_opt, Random* rnd) {
   db_opt->use_adaptive_mutex = rnd->Uniform(2);
   db_opt->use_fsync = rnd->Uniform(2);
   db_opt->recycle_log_file_num = rnd->Uniform(2);
+  db_opt->atomic_flush = rnd->Uniform(2);
 
   // int options
   db_opt->max_background_compactions = rnd->Uniform(100);
   db_opt->max_background_flushes = rnd->Uniform(100);
   db_opt->max_file_opening_threads = rnd->Uniform(100);
+  db_opt->async_read_threads = rnd->Uniform(100);
   db_opt->max_open_files = rnd->Uniform(100);
   db_opt->table_cache_numshardbits = rnd->Uniform(100);
 
@@ -237,6 +239,8 @@ void RandomInitDBOptions(DBOptions* db_opt, Random* rnd) {
 
   // uint32_t options
   db_opt->max_subcompactions = rnd->Uniform(100000);
+  db_opt->max_subflushes = rnd->Uniform(100000);
+  db_opt->manifest_snapshot_ratio = rnd->Uniform(16);
 
   // uint64_t options
   static const uint64_t uint_max = static_cast<uint64_t>(UINT_MAX);
@@ -258,6 +262,7 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, Random* rnd) {
 
   // boolean options
   cf_opt->report_bg_io_stats = rnd->Uniform(2);
+  cf_opt->inplace_update_support = rnd->Uniform(2);
   cf_opt->disable_auto_compactions = rnd->Uniform(2);
   cf_opt->paranoid_file_checks = rnd->Uniform(2);
   cf_opt->verify_checksums_in_compaction = rnd->Uniform(2);
@@ -276,14 +281,22 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, Random* rnd) {
 
   // size_t options
   cf_opt->arena_block_size = rnd->Uniform(10000);
+  cf_opt->memtable_huge_page_size = rnd->Uniform(10000);
+  cf_opt->inplace_update_num_locks = rnd->Uniform(10000);
   cf_opt->write_buffer_size = rnd->Uniform(10000);
 
   // uint32_t options
   cf_opt->max_bytes_for_level_base = rnd->Uniform(10000);
+  cf_opt->memtable_bloom_bits_per_key = rnd->Uniform(20);
+  cf_opt->compaction_weight = rnd->Uniform(10000);
 
   // uint64_t options
   static const uint64_t uint_max = static_cast<uint64_t>(UINT_MAX);
   cf_opt->target_file_size_base = uint_max + rnd->Uniform(10000);
+  cf_opt->min_blob_size = rnd->Uniform(10000);
+
+  // double options
+  cf_opt->blob_gc_garbage_ratio = static_cast<double>(rnd->Uniform(100)) / 100;
 
   // pointer typed options
   cf_opt->table_factory.reset(RandomTableFactory(rnd));
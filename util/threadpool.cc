@@ -122,13 +122,19 @@ int ThreadDetach(pthread_t& thread) {
   return pthread_detach(thread);
 }
 #endif
+
+// The pool and the id of the current thread, if it is a pool thread
+__thread ThreadPool* tls_pool = nullptr;
+__thread size_t tls_thread_id = 0;
 }
 
 ThreadPool::ThreadPool()
     : total_threads_limit_(1),
       bgthreads_(0),
-      queue_(),
+      queues_(1),
+      next_queue_(0),
       queue_len_(),
+      idle_threads_(0),
       exit_all_threads_(false),
       low_io_priority_(false),
       env_(nullptr) {
@@ -165,6 +171,8 @@ void ThreadPool::LowerIOPriority() {
 }
 
 void ThreadPool::BGThread(size_t thread_id) {
+  tls_pool = this;
+  tls_thread_id = thread_id;
   bool low_io_priority = false;
   while (true) {
 // Wait until there is an item that is ready to run
@@ -172,8 +180,17 @@ void ThreadPool::BGThread(size_t thread_id) {
     PthreadCall("lock", ThreadPoolMutexLock(uniqueLock));
     // Stop waiting if the thread needs to do work or needs to terminate.
     while (!exit_all_threads_ && !IsLastExcessiveThread(thread_id) &&
-           (queue_.empty() || IsExcessiveThread(thread_id))) {
+           (IsExcessiveThread(thread_id) ||
+            (queue_len_.load(std::memory_order_relaxed) == 0 &&
+             !CanSteal()))) {
+      bool idle = !IsExcessiveThread(thread_id);
+      if (idle) {
+        idle_threads_.fetch_add(1, std::memory_order_relaxed);
+      }
       PthreadCall("wait", ConditionWait(bgsignal_, uniqueLock));
+      if (idle) {
+        idle_threads_.fetch_sub(1, std::memory_order_relaxed);
+      }
     }
 
     if (exit_all_threads_) {  // mechanism to let BG threads exit safely
@@ -188,7 +205,14 @@ void ThreadPool::BGThread(size_t thread_id) {
       auto& terminating_thread = bgthreads_.back();
       PthreadCall("detach", ThreadDetach(terminating_thread));
       bgthreads_.pop_back();
-      if (HasExcessiveThread()) {
+      if (queues_.size() > 1) {
+        // Hand its jobs over to the first thread
+        BGQueue& queue = queues_.back();
+        queues_[0].insert(queues_[0].end(), queue.begin(), queue.end());
+        queues_.pop_back();
+      }
+      if (HasExcessiveThread() ||
+          queue_len_.load(std::memory_order_relaxed) > 0) {
         // There is still at least more excessive thread to terminate.
         WakeUpAllThreads();
       }
@@ -196,15 +220,34 @@ void ThreadPool::BGThread(size_t thread_id) {
       break;
     }
 
-    void (*function)(void*) = queue_.front().function;
-    void* arg = queue_.front().arg;
-    queue_.pop_front();
-    queue_len_.store(static_cast<unsigned int>(queue_.size()),
-                     std::memory_order_relaxed);
+    BGItem item;
+    bool steal = queue_len_.load(std::memory_order_relaxed) == 0;
+    if (!steal) {
+      TakeItem(thread_id, &item);
+    }
+    bool wake_up_thieves = !thieves_.empty() &&
+                           queue_len_.load(std::memory_order_relaxed) > 0 &&
+                           idle_threads_.load(std::memory_order_relaxed) == 0;
 
     bool decrease_io_priority = (low_io_priority != low_io_priority_);
     PthreadCall("unlock", MutexUnlock(uniqueLock));
 
+    if (steal) {
+      bool stolen = false;
+      for (ThreadPool* victim : victims_) {
+        if (victim->StealItem(&item)) {
+          stolen = true;
+          break;
+        }
+      }
+      if (!stolen) {
+        continue;  // taken by its own threads in the meanwhile
+      }
+    }
+    if (wake_up_thieves) {
+      WakeUpThieves();
+    }
+
 #ifdef OS_LINUX
     if (decrease_io_priority) {
 #define IOPRIO_CLASS_SHIFT (13)
@@ -227,8 +270,77 @@ void ThreadPool::BGThread(size_t thread_id) {
 #else
     (void)decrease_io_priority;  // avoid 'unused variable' error
 #endif
-    (*function)(arg);
+    (*item.function)(item.arg);
+  }
+}
+
+void ThreadPool::TakeItem(size_t thread_id, BGItem* item) {
+  size_t n = queues_.size();
+  size_t own = thread_id < n ? thread_id : 0;
+  if (!queues_[own].empty()) {
+    *item = queues_[own].front();
+    queues_[own].pop_front();
+  } else {
+    // The oldest job of a sibling, so that the jobs still run in the order
+    // they were scheduled
+    for (size_t i = 1; i < n; i++) {
+      BGQueue& queue = queues_[(own + i) % n];
+      if (!queue.empty()) {
+        *item = queue.front();
+        queue.pop_front();
+        break;
+      }
+    }
   }
+  queue_len_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool ThreadPool::StealItem(BGItem* item) {
+  Lock lock(mu_);
+  PthreadCall("lock", ThreadPoolMutexLock(lock));
+  bool stolen = !exit_all_threads_ &&
+                queue_len_.load(std::memory_order_relaxed) > 0 &&
+                idle_threads_.load(std::memory_order_relaxed) == 0;
+  if (stolen) {
+    // The newest job, which its own threads would run last
+    for (auto it = queues_.rbegin(); it != queues_.rend(); ++it) {
+      if (!it->empty()) {
+        *item = it->back();
+        it->pop_back();
+        break;
+      }
+    }
+    queue_len_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  PthreadCall("unlock", MutexUnlock(lock));
+  return stolen;
+}
+
+bool ThreadPool::CanSteal() const {
+  for (ThreadPool* victim : victims_) {
+    if (victim->queue_len_.load(std::memory_order_relaxed) > 0 &&
+        victim->idle_threads_.load(std::memory_order_relaxed) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::WakeUpThieves() {
+  // Under the mutex of each thief, which checks CanSteal() under it before
+  // waiting, so that no wake-up is lost
+  for (ThreadPool* thief : thieves_) {
+    Lock lock(thief->mu_);
+    PthreadCall("lock", ThreadPoolMutexLock(lock));
+    thief->WakeUpAllThreads();
+    PthreadCall("unlock", MutexUnlock(lock));
+  }
+}
+
+void ThreadPool::AddStealVictim(ThreadPool* victim) {
+  assert(victim != this);
+  victims_.push_back(victim);
+  victim->thieves_.push_back(this);
 }
 
 // Helper struct for passing arguments when creating threads.
@@ -246,9 +358,12 @@ static void* BGThreadWrapper(void* arg) {
 #ifdef VIDARDB_USING_THREAD_STATUS
   // for thread-status
   ThreadStatusUtil::RegisterThread(
-      tp->GetHostEnv(), (tp->GetThreadPriority() == Env::Priority::HIGH
-                             ? ThreadStatus::HIGH_PRIORITY
-                             : ThreadStatus::LOW_PRIORITY));
+      tp->GetHostEnv(),
+      (tp->GetThreadPriority() == Env::Priority::HIGH
+           ? ThreadStatus::HIGH_PRIORITY
+           : (tp->GetThreadPriority() == Env::Priority::BOTTOM
+                  ? ThreadStatus::BOTTOM_PRIORITY
+                  : ThreadStatus::LOW_PRIORITY)));
 #endif
   delete meta;
   tp->BGThread(thread_id);
@@ -271,13 +386,22 @@ void ThreadPool::SetBackgroundThreadsInternal(int num, bool allow_reduce) {
   }
   if (num > total_threads_limit_ ||
       (num < total_threads_limit_ && allow_reduce)) {
-    total_threads_limit_ = std::max(1, num);
+    // Only the bottommost-level compaction pool may have no thread
+    total_threads_limit_ = std::max(priority_ == Env::BOTTOM ? 0 : 1, num);
     WakeUpAllThreads();
     StartBGThreads();
   }
   PthreadCall("unlock", MutexUnlock(lock));
 }
 
+int ThreadPool::GetBackgroundThreads() {
+  Lock lock(mu_);
+  PthreadCall("lock", ThreadPoolMutexLock(lock));
+  int num = total_threads_limit_;
+  PthreadCall("unlock", MutexUnlock(lock));
+  return num;
+}
+
 void ThreadPool::IncBackgroundThreadsIfNeeded(int num) {
   SetBackgroundThreadsInternal(num, false);
 }
@@ -311,6 +435,9 @@ void ThreadPool::StartBGThreads() {
     bgthreads_.push_back(t);
 #endif
   }
+  if (queues_.size() < bgthreads_.size()) {
+    queues_.resize(bgthreads_.size());
+  }
 }
 
 void ThreadPool::Schedule(void (*function)(void* arg1), void* arg, void* tag,
@@ -326,14 +453,23 @@ void ThreadPool::Schedule(void (*function)(void* arg1), void* arg, void* tag,
 
   StartBGThreads();
 
-  // Add to priority queue
-  queue_.push_back(BGItem());
-  queue_.back().function = function;
-  queue_.back().arg = arg;
-  queue_.back().tag = tag;
-  queue_.back().unschedFunction = unschedFunction;
-  queue_len_.store(static_cast<unsigned int>(queue_.size()),
-                   std::memory_order_relaxed);
+  // Add to the queue of the scheduling thread, or else of the next thread
+  size_t n = std::min(queues_.size(),
+                      static_cast<size_t>(std::max(total_threads_limit_, 1)));
+  BGQueue* queue;
+  if (tls_pool == this && tls_thread_id < n) {
+    queue = &queues_[tls_thread_id];
+  } else {
+    queue = &queues_[next_queue_++ % n];
+  }
+  queue->push_back(BGItem());
+  queue->back().function = function;
+  queue->back().arg = arg;
+  queue->back().tag = tag;
+  queue->back().unschedFunction = unschedFunction;
+  queue_len_.fetch_add(1, std::memory_order_relaxed);
+  bool wake_up_thieves = !thieves_.empty() &&
+                         idle_threads_.load(std::memory_order_relaxed) == 0;
 
   if (!HasExcessiveThread()) {
     // Wake up at least one waiting thread.
@@ -345,6 +481,9 @@ void ThreadPool::Schedule(void (*function)(void* arg1), void* arg, void* tag,
   }
 
   PthreadCall("unlock", MutexUnlock(lock));
+  if (wake_up_thieves) {
+    WakeUpThieves();
+  }
 }
 
 int ThreadPool::UnSchedule(void* arg) {
@@ -353,23 +492,24 @@ int ThreadPool::UnSchedule(void* arg) {
   Lock lock(mu_);
   PthreadCall("lock", ThreadPoolMutexLock(lock));
 
-  // Remove from priority queue
-  BGQueue::iterator it = queue_.begin();
-  while (it != queue_.end()) {
-    if (arg == (*it).tag) {
-      void (*unschedFunction)(void*) = (*it).unschedFunction;
-      void* arg1 = (*it).arg;
-      if (unschedFunction != nullptr) {
-        (*unschedFunction)(arg1);
+  // Remove from all the queues
+  for (auto& queue : queues_) {
+    BGQueue::iterator it = queue.begin();
+    while (it != queue.end()) {
+      if (arg == (*it).tag) {
+        void (*unschedFunction)(void*) = (*it).unschedFunction;
+        void* arg1 = (*it).arg;
+        if (unschedFunction != nullptr) {
+          (*unschedFunction)(arg1);
+        }
+        it = queue.erase(it);
+        count++;
+      } else {
+        ++it;
       }
-      it = queue_.erase(it);
-      count++;
-    } else {
-      ++it;
     }
   }
-  queue_len_.store(static_cast<unsigned int>(queue_.size()),
-                   std::memory_order_relaxed);
+  queue_len_.fetch_sub(count, std::memory_order_relaxed);
   PthreadCall("unlock", MutexUnlock(lock));
   return count;
 }
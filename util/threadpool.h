@@ -37,11 +37,17 @@ class ThreadPool {
   void WakeUpAllThreads();
   void IncBackgroundThreadsIfNeeded(int num);
   void SetBackgroundThreads(int num);
+  int GetBackgroundThreads();
   void StartBGThreads();
   void Schedule(void (*function)(void* arg1), void* arg, void* tag,
                 void (*unschedFunction)(void* arg));
   int UnSchedule(void* arg);
 
+  // Lets the idle threads of this pool run the jobs queued in victim while
+  // none of the threads of victim is idle. Must be called before any job is
+  // scheduled in either pool, and victim must outlive this pool's threads.
+  void AddStealVictim(ThreadPool* victim);
+
   unsigned int GetQueueLen() const {
     return queue_len_.load(std::memory_order_relaxed);
   }
@@ -86,6 +92,18 @@ class ThreadPool {
 
   typedef std::deque<BGItem> BGQueue;
 
+  // Takes a job of this pool for the thread thread_id: the oldest one of its
+  // own queue, or else the newest one of a sibling queue.
+  // REQUIRES: mu_ is held and queue_len_ > 0
+  void TakeItem(size_t thread_id, BGItem* item);
+
+  // Takes the newest queued job if none of the threads of this pool is idle.
+  bool StealItem(BGItem* item);
+
+  // REQUIRES: mu_ is held
+  bool CanSteal() const;
+  void WakeUpThieves();
+
   int total_threads_limit_;
 
 #ifdef VIDARDB_STD_THREADPOOL
@@ -97,8 +115,14 @@ class ThreadPool {
   pthread_cond_t bgsignal_;
   std::vector<pthread_t> bgthreads_;
 #endif
-  BGQueue queue_;
-  std::atomic_uint queue_len_;  // Queue length. Used for stats reporting
+  // One queue per thread, at least one. A job is queued to the thread
+  // scheduling it if that is a thread of this pool, round-robin otherwise.
+  std::vector<BGQueue> queues_;
+  size_t next_queue_;
+  std::atomic_uint queue_len_;  // Jobs in all the queues
+  std::atomic_int idle_threads_;
+  std::vector<ThreadPool*> victims_;
+  std::vector<ThreadPool*> thieves_;
   bool exit_all_threads_;
   bool low_io_priority_;
   Env::Priority priority_;
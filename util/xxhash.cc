@@ -0,0 +1,424 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// xxHash, by Yann Collet (https://github.com/Cyan4973/xxHash), is released
+// under the BSD 2-Clause license.
+
+#include "util/xxhash.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "util/coding.h"
+
+namespace vidardb {
+namespace xxhash {
+
+namespace {
+
+const uint32_t kPrime32_1 = 0x9E3779B1U;
+const uint32_t kPrime32_2 = 0x85EBCA77U;
+const uint32_t kPrime32_3 = 0xC2B2AE3DU;
+
+const uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+const uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+
+const uint64_t kPrimeMx1 = 0x165667919E3779F9ULL;
+const uint64_t kPrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+inline uint64_t Rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint32_t Swap32(uint32_t x) {
+  return ((x << 24) & 0xff000000) | ((x << 8) & 0x00ff0000) |
+         ((x >> 8) & 0x0000ff00) | ((x >> 24) & 0x000000ff);
+}
+
+inline uint64_t Swap64(uint64_t x) {
+  return (static_cast<uint64_t>(Swap32(static_cast<uint32_t>(x))) << 32) |
+         Swap32(static_cast<uint32_t>(x >> 32));
+}
+
+inline uint64_t XorShift64(uint64_t v, int shift) { return v ^ (v >> shift); }
+
+// XOR of the two halves of the 128-bit product
+inline uint64_t Mul128Fold64(uint64_t lhs, uint64_t rhs) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+  return static_cast<uint64_t>(product) ^
+         static_cast<uint64_t>(product >> 64);
+#else
+  uint64_t lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+  uint64_t hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+  uint64_t lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+  uint64_t hi_hi = (lhs >> 32) * (rhs >> 32);
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  return lower ^ upper;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// XXH64
+
+inline uint64_t XXH64Round(uint64_t acc, uint64_t input) {
+  acc += input * kPrime64_2;
+  acc = Rotl64(acc, 31);
+  acc *= kPrime64_1;
+  return acc;
+}
+
+inline uint64_t XXH64MergeRound(uint64_t acc, uint64_t val) {
+  val = XXH64Round(0, val);
+  acc ^= val;
+  acc = acc * kPrime64_1 + kPrime64_4;
+  return acc;
+}
+
+inline uint64_t XXH64Avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= kPrime64_2;
+  h ^= h >> 29;
+  h *= kPrime64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+// ---------------------------------------------------------------------------
+// XXH3
+
+const size_t kSecretSize = 192;
+const size_t kSecretSizeMin = 136;
+const size_t kMidSizeMax = 240;
+const size_t kMidSizeStartOffset = 3;
+const size_t kMidSizeLastOffset = 17;
+const size_t kStripeLen = 64;
+const size_t kSecretConsumeRate = 8;
+const size_t kAccNb = kStripeLen / sizeof(uint64_t);
+const size_t kSecretLastAccStart = 7;
+const size_t kSecretMergeAccsStart = 11;
+
+const unsigned char kSecret[kSecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+inline const char* Secret(size_t offset) {
+  return reinterpret_cast<const char*>(kSecret) + offset;
+}
+
+// Fast avalanche, for input bits already partially mixed
+inline uint64_t XXH3Avalanche(uint64_t h) {
+  h = XorShift64(h, 37);
+  h *= kPrimeMx1;
+  h = XorShift64(h, 32);
+  return h;
+}
+
+// Stronger avalanche, for input not mixed yet
+inline uint64_t XXH3Rrmxmx(uint64_t h, uint64_t len) {
+  h ^= Rotl64(h, 49) ^ Rotl64(h, 24);
+  h *= kPrimeMx2;
+  h ^= (h >> 35) + len;
+  h *= kPrimeMx2;
+  return XorShift64(h, 28);
+}
+
+inline uint64_t XXH3Len1To3(const char* input, size_t len) {
+  uint32_t c1 = static_cast<unsigned char>(input[0]);
+  uint32_t c2 = static_cast<unsigned char>(input[len >> 1]);
+  uint32_t c3 = static_cast<unsigned char>(input[len - 1]);
+  uint32_t combined = (c1 << 16) | (c2 << 24) | (c3 << 0) |
+                      (static_cast<uint32_t>(len) << 8);
+  uint64_t bitflip = DecodeFixed32(Secret(0)) ^ DecodeFixed32(Secret(4));
+  return XXH64Avalanche(static_cast<uint64_t>(combined) ^ bitflip);
+}
+
+inline uint64_t XXH3Len4To8(const char* input, size_t len) {
+  uint32_t input1 = DecodeFixed32(input);
+  uint32_t input2 = DecodeFixed32(input + len - 4);
+  uint64_t bitflip = DecodeFixed64(Secret(8)) ^ DecodeFixed64(Secret(16));
+  uint64_t input64 = input2 + (static_cast<uint64_t>(input1) << 32);
+  return XXH3Rrmxmx(input64 ^ bitflip, len);
+}
+
+inline uint64_t XXH3Len9To16(const char* input, size_t len) {
+  uint64_t bitflip1 = DecodeFixed64(Secret(24)) ^ DecodeFixed64(Secret(32));
+  uint64_t bitflip2 = DecodeFixed64(Secret(40)) ^ DecodeFixed64(Secret(48));
+  uint64_t input_lo = DecodeFixed64(input) ^ bitflip1;
+  uint64_t input_hi = DecodeFixed64(input + len - 8) ^ bitflip2;
+  uint64_t acc = len + Swap64(input_lo) + input_hi +
+                 Mul128Fold64(input_lo, input_hi);
+  return XXH3Avalanche(acc);
+}
+
+inline uint64_t XXH3Len0To16(const char* input, size_t len) {
+  if (len > 8) {
+    return XXH3Len9To16(input, len);
+  }
+  if (len >= 4) {
+    return XXH3Len4To8(input, len);
+  }
+  if (len > 0) {
+    return XXH3Len1To3(input, len);
+  }
+  return XXH64Avalanche(DecodeFixed64(Secret(56)) ^ DecodeFixed64(Secret(64)));
+}
+
+inline uint64_t XXH3Mix16B(const char* input, const char* secret) {
+  uint64_t input_lo = DecodeFixed64(input);
+  uint64_t input_hi = DecodeFixed64(input + 8);
+  return Mul128Fold64(input_lo ^ DecodeFixed64(secret),
+                      input_hi ^ DecodeFixed64(secret + 8));
+}
+
+inline uint64_t XXH3Len17To128(const char* input, size_t len) {
+  uint64_t acc = len * kPrime64_1;
+  if (len > 32) {
+    if (len > 64) {
+      if (len > 96) {
+        acc += XXH3Mix16B(input + 48, Secret(96));
+        acc += XXH3Mix16B(input + len - 64, Secret(112));
+      }
+      acc += XXH3Mix16B(input + 32, Secret(64));
+      acc += XXH3Mix16B(input + len - 48, Secret(80));
+    }
+    acc += XXH3Mix16B(input + 16, Secret(32));
+    acc += XXH3Mix16B(input + len - 32, Secret(48));
+  }
+  acc += XXH3Mix16B(input + 0, Secret(0));
+  acc += XXH3Mix16B(input + len - 16, Secret(16));
+  return XXH3Avalanche(acc);
+}
+
+uint64_t XXH3Len129To240(const char* input, size_t len) {
+  uint64_t acc = len * kPrime64_1;
+  size_t rounds = len / 16;
+  for (size_t i = 0; i < 8; i++) {
+    acc += XXH3Mix16B(input + 16 * i, Secret(16 * i));
+  }
+  acc = XXH3Avalanche(acc);
+  for (size_t i = 8; i < rounds; i++) {
+    acc += XXH3Mix16B(input + 16 * i,
+                      Secret(16 * (i - 8) + kMidSizeStartOffset));
+  }
+  acc += XXH3Mix16B(input + len - 16,
+                    Secret(kSecretSizeMin - kMidSizeLastOffset));
+  return XXH3Avalanche(acc);
+}
+
+// Mixes a stripe of 64 bytes into the accumulators
+#if defined(__AVX2__)
+inline void XXH3Accumulate512(uint64_t* acc, const char* input,
+                              const char* secret) {
+  __m256i* xacc = reinterpret_cast<__m256i*>(acc);
+  const __m256i* xinput = reinterpret_cast<const __m256i*>(input);
+  const __m256i* xsecret = reinterpret_cast<const __m256i*>(secret);
+  for (size_t i = 0; i < kStripeLen / sizeof(__m256i); i++) {
+    __m256i data_vec = _mm256_loadu_si256(xinput + i);
+    __m256i key_vec = _mm256_loadu_si256(xsecret + i);
+    __m256i data_key = _mm256_xor_si256(data_vec, key_vec);
+    __m256i data_key_lo = _mm256_srli_epi64(data_key, 32);
+    __m256i product = _mm256_mul_epu32(data_key, data_key_lo);
+    __m256i data_swap = _mm256_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+    __m256i sum = _mm256_add_epi64(xacc[i], data_swap);
+    xacc[i] = _mm256_add_epi64(product, sum);
+  }
+}
+
+inline void XXH3ScrambleAcc(uint64_t* acc, const char* secret) {
+  __m256i* xacc = reinterpret_cast<__m256i*>(acc);
+  const __m256i* xsecret = reinterpret_cast<const __m256i*>(secret);
+  const __m256i prime32 = _mm256_set1_epi32(static_cast<int>(kPrime32_1));
+  for (size_t i = 0; i < kStripeLen / sizeof(__m256i); i++) {
+    __m256i acc_vec = xacc[i];
+    __m256i data_vec = _mm256_xor_si256(acc_vec, _mm256_srli_epi64(acc_vec, 47));
+    __m256i data_key =
+        _mm256_xor_si256(data_vec, _mm256_loadu_si256(xsecret + i));
+    __m256i data_key_hi = _mm256_srli_epi64(data_key, 32);
+    __m256i prod_lo = _mm256_mul_epu32(data_key, prime32);
+    __m256i prod_hi = _mm256_mul_epu32(data_key_hi, prime32);
+    xacc[i] = _mm256_add_epi64(prod_lo, _mm256_slli_epi64(prod_hi, 32));
+  }
+}
+#elif defined(__SSE2__)
+inline void XXH3Accumulate512(uint64_t* acc, const char* input,
+                              const char* secret) {
+  __m128i* xacc = reinterpret_cast<__m128i*>(acc);
+  const __m128i* xinput = reinterpret_cast<const __m128i*>(input);
+  const __m128i* xsecret = reinterpret_cast<const __m128i*>(secret);
+  for (size_t i = 0; i < kStripeLen / sizeof(__m128i); i++) {
+    __m128i data_vec = _mm_loadu_si128(xinput + i);
+    __m128i key_vec = _mm_loadu_si128(xsecret + i);
+    __m128i data_key = _mm_xor_si128(data_vec, key_vec);
+    __m128i data_key_lo = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+    __m128i product = _mm_mul_epu32(data_key, data_key_lo);
+    __m128i data_swap = _mm_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128i sum = _mm_add_epi64(xacc[i], data_swap);
+    xacc[i] = _mm_add_epi64(product, sum);
+  }
+}
+
+inline void XXH3ScrambleAcc(uint64_t* acc, const char* secret) {
+  __m128i* xacc = reinterpret_cast<__m128i*>(acc);
+  const __m128i* xsecret = reinterpret_cast<const __m128i*>(secret);
+  const __m128i prime32 = _mm_set1_epi32(static_cast<int>(kPrime32_1));
+  for (size_t i = 0; i < kStripeLen / sizeof(__m128i); i++) {
+    __m128i acc_vec = xacc[i];
+    __m128i data_vec = _mm_xor_si128(acc_vec, _mm_srli_epi64(acc_vec, 47));
+    __m128i data_key = _mm_xor_si128(data_vec, _mm_loadu_si128(xsecret + i));
+    __m128i data_key_hi =
+        _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+    __m128i prod_lo = _mm_mul_epu32(data_key, prime32);
+    __m128i prod_hi = _mm_mul_epu32(data_key_hi, prime32);
+    xacc[i] = _mm_add_epi64(prod_lo, _mm_slli_epi64(prod_hi, 32));
+  }
+}
+#else
+inline void XXH3Accumulate512(uint64_t* acc, const char* input,
+                              const char* secret) {
+  for (size_t i = 0; i < kAccNb; i++) {
+    uint64_t data_val = DecodeFixed64(input + 8 * i);
+    uint64_t data_key = data_val ^ DecodeFixed64(secret + 8 * i);
+    acc[i ^ 1] += data_val;
+    acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+  }
+}
+
+inline void XXH3ScrambleAcc(uint64_t* acc, const char* secret) {
+  for (size_t i = 0; i < kAccNb; i++) {
+    uint64_t acc64 = XorShift64(acc[i], 47);
+    acc64 ^= DecodeFixed64(secret + 8 * i);
+    acc64 *= kPrime32_1;
+    acc[i] = acc64;
+  }
+}
+#endif
+
+inline void XXH3Accumulate(uint64_t* acc, const char* input,
+                           const char* secret, size_t stripes) {
+  for (size_t n = 0; n < stripes; n++) {
+    XXH3Accumulate512(acc, input + n * kStripeLen,
+                      secret + n * kSecretConsumeRate);
+  }
+}
+
+uint64_t XXH3HashLong(const char* input, size_t len) {
+  // Aligned for the vector loads
+  alignas(32) uint64_t acc[kAccNb] = {kPrime32_3, kPrime64_1, kPrime64_2,
+                                      kPrime64_3, kPrime64_4, kPrime32_2,
+                                      kPrime64_5, kPrime32_1};
+
+  const size_t stripes_per_block = (kSecretSize - kStripeLen) /
+                                   kSecretConsumeRate;
+  const size_t block_len = kStripeLen * stripes_per_block;
+  const size_t blocks = (len - 1) / block_len;
+  for (size_t n = 0; n < blocks; n++) {
+    XXH3Accumulate(acc, input + n * block_len, Secret(0), stripes_per_block);
+    XXH3ScrambleAcc(acc, Secret(kSecretSize - kStripeLen));
+  }
+
+  // The last partial block, and the last stripe
+  const size_t stripes = ((len - 1) - block_len * blocks) / kStripeLen;
+  XXH3Accumulate(acc, input + blocks * block_len, Secret(0), stripes);
+  XXH3Accumulate512(acc, input + len - kStripeLen,
+                    Secret(kSecretSize - kStripeLen - kSecretLastAccStart));
+
+  uint64_t result = len * kPrime64_1;
+  const char* secret = Secret(kSecretMergeAccsStart);
+  for (size_t i = 0; i < 4; i++) {
+    result += Mul128Fold64(acc[2 * i] ^ DecodeFixed64(secret + 16 * i),
+                           acc[2 * i + 1] ^ DecodeFixed64(secret + 16 * i + 8));
+  }
+  return XXH3Avalanche(result);
+}
+
+}  // namespace
+
+uint64_t XXH64(const char* data, size_t n, uint64_t seed) {
+  const char* p = data;
+  const char* const end = data + n;
+  uint64_t h;
+
+  if (n >= 32) {
+    const char* const limit = end - 32;
+    uint64_t v1 = seed + kPrime64_1 + kPrime64_2;
+    uint64_t v2 = seed + kPrime64_2;
+    uint64_t v3 = seed + 0;
+    uint64_t v4 = seed - kPrime64_1;
+    do {
+      v1 = XXH64Round(v1, DecodeFixed64(p));
+      v2 = XXH64Round(v2, DecodeFixed64(p + 8));
+      v3 = XXH64Round(v3, DecodeFixed64(p + 16));
+      v4 = XXH64Round(v4, DecodeFixed64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = Rotl64(v1, 1) + Rotl64(v2, 7) + Rotl64(v3, 12) + Rotl64(v4, 18);
+    h = XXH64MergeRound(h, v1);
+    h = XXH64MergeRound(h, v2);
+    h = XXH64MergeRound(h, v3);
+    h = XXH64MergeRound(h, v4);
+  } else {
+    h = seed + kPrime64_5;
+  }
+
+  h += static_cast<uint64_t>(n);
+
+  while (p + 8 <= end) {
+    h ^= XXH64Round(0, DecodeFixed64(p));
+    h = Rotl64(h, 27) * kPrime64_1 + kPrime64_4;
+    p += 8;
+  }
+  if (p + 4 <= end) {
+    h ^= static_cast<uint64_t>(DecodeFixed32(p)) * kPrime64_1;
+    h = Rotl64(h, 23) * kPrime64_2 + kPrime64_3;
+    p += 4;
+  }
+  while (p < end) {
+    h ^= static_cast<unsigned char>(*p) * kPrime64_5;
+    h = Rotl64(h, 11) * kPrime64_1;
+    p++;
+  }
+  return XXH64Avalanche(h);
+}
+
+uint64_t XXH3_64bits(const char* data, size_t n) {
+  if (n <= 16) {
+    return XXH3Len0To16(data, n);
+  }
+  if (n <= 128) {
+    return XXH3Len17To128(data, n);
+  }
+  if (n <= kMidSizeMax) {
+    return XXH3Len129To240(data, n);
+  }
+  return XXH3HashLong(data, n);
+}
+
+}  // namespace xxhash
+}  // namespace vidardb
@@ -0,0 +1,25 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// xxHash, by Yann Collet (https://github.com/Cyan4973/xxHash), is released
+// under the BSD 2-Clause license. These are portable implementations of its
+// 64-bit hashes, giving the same results as the reference on every platform.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+namespace vidardb {
+namespace xxhash {
+
+// Return the XXH64 of data[0,n-1]
+extern uint64_t XXH64(const char* data, size_t n, uint64_t seed);
+
+// Return the XXH3 64-bit hash of data[0,n-1], with the default secret and
+// no seed. Much faster than XXH64 on large inputs.
+extern uint64_t XXH3_64bits(const char* data, size_t n);
+
+}  // namespace xxhash
+}  // namespace vidardb
@@ -0,0 +1,331 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include "vidardb/utilities/change_applier.h"
+
+#include <algorithm>
+#include <string>
+
+#include "db/write_batch_internal.h"
+#include "port/port.h"
+#include "util/coding.h"
+#include "util/logging.h"
+#include "util/murmurhash.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+#include "util/threadpool.h"
+#include "vidardb/env.h"
+#include "vidardb/write_batch.h"
+
+namespace vidardb {
+
+namespace {
+
+const std::string kCheckpointFileName = "CHANGE_APPLIER";
+
+// Splits the updates of a leader batch among the batches of the threads
+class Partitioner : public WriteBatch::Handler {
+ public:
+  Partitioner(const ChangeApplierOptions& options,
+              std::vector<WriteBatch>* batches)
+      : options_(options), batches_(batches), seq_(0), applied_(0) {}
+
+  // The updates at or before applied are skipped
+  void Reset(SequenceNumber seq, SequenceNumber applied) {
+    seq_ = seq;
+    applied_ = applied;
+    status_ = Status::OK();
+  }
+
+  // WriteBatch::Iterate() ignores the status of the markers, so it is kept
+  // here
+  const Status& status() const { return status_; }
+
+  virtual Status PutCF(uint32_t column_family_id, const Slice& key,
+                       const Slice& value) override {
+    ColumnFamilyHandle* column_family;
+    WriteBatch* batch;
+    Status s = Route(column_family_id, key, &column_family, &batch);
+    if (s.ok() && batch != nullptr) {
+      batch->Put(column_family, key, value);
+    }
+    return s;
+  }
+
+  virtual Status DeleteCF(uint32_t column_family_id,
+                          const Slice& key) override {
+    ColumnFamilyHandle* column_family;
+    WriteBatch* batch;
+    Status s = Route(column_family_id, key, &column_family, &batch);
+    if (s.ok() && batch != nullptr) {
+      batch->Delete(column_family, key);
+    }
+    return s;
+  }
+
+  virtual Status MarkBeginPrepare() override { return NotSupported(); }
+
+  virtual Status MarkEndPrepare(const Slice& xid) override {
+    return NotSupported();
+  }
+
+  virtual Status MarkCommit(const Slice& xid) override {
+    return NotSupported();
+  }
+
+  virtual Status MarkRollback(const Slice& xid) override {
+    return NotSupported();
+  }
+
+ private:
+  Status NotSupported() {
+    status_ = Status::NotSupported("2PC is not replicated");
+    return status_;
+  }
+
+  // Sets *batch to nullptr if the update was already applied
+  Status Route(uint32_t column_family_id, const Slice& key,
+               ColumnFamilyHandle** column_family, WriteBatch** batch) {
+    *batch = nullptr;
+    if (seq_++ <= applied_) {
+      return Status::OK();
+    }
+    auto it = options_.column_families.find(column_family_id);
+    if (it == options_.column_families.end()) {
+      return Status::InvalidArgument(
+          "No follower column family for the leader one " +
+          ToString(column_family_id));
+    }
+    *column_family = it->second;
+
+    uint64_t hash;
+    if (options_.partitioning == ChangeApplierOptions::kByColumnFamily) {
+      hash = column_family_id;
+    } else {
+      hash = MurmurHash(key.data(), static_cast<int>(key.size()),
+                        column_family_id);
+    }
+    *batch = &(*batches_)[hash % batches_->size()];
+    return Status::OK();
+  }
+
+  const ChangeApplierOptions& options_;
+  std::vector<WriteBatch>* const batches_;
+  SequenceNumber seq_;  // of the next update
+  SequenceNumber applied_;
+  Status status_;
+};
+
+class ChangeApplierImpl : public ChangeApplier {
+ public:
+  ChangeApplierImpl(const ChangeApplierOptions& options, DB* follower,
+                    SequenceNumber applied,
+                    std::unique_ptr<Directory>&& directory)
+      : options_(options),
+        follower_(follower),
+        checkpoint_file_(follower->GetName() + "/" + kCheckpointFileName),
+        directory_(std::move(directory)),
+        applied_(applied),
+        batches_(std::max<size_t>(options.num_threads, 1)),
+        partitioner_(options_, &batches_),
+        jobs_(batches_.size()),
+        statuses_(batches_.size()),
+        pending_jobs_(0),
+        cv_(&mu_) {
+    if (options_.column_families.empty()) {
+      options_.column_families[0] = follower_->DefaultColumnFamily();
+    }
+    for (size_t i = 0; i < jobs_.size(); i++) {
+      jobs_[i].applier = this;
+      jobs_[i].batch = i;
+    }
+    // The calling thread writes the first batch
+    if (batches_.size() > 1) {
+      pool_.SetHostEnv(follower_->GetEnv());
+      pool_.SetBackgroundThreads(static_cast<int>(batches_.size() - 1));
+    }
+  }
+
+  virtual ~ChangeApplierImpl() { pool_.JoinAllThreads(); }
+
+  virtual Status Apply(const std::vector<ChangeRecord>& records) override;
+
+  virtual SequenceNumber AppliedSequence() const override { return applied_; }
+
+ private:
+  struct WriteJob {
+    ChangeApplierImpl* applier;
+    size_t batch;
+  };
+
+  static void BGWorkWrite(void* arg);
+
+  // Makes applied_ durable, along with the writes it covers
+  Status WriteCheckpoint();
+
+  ChangeApplierOptions options_;
+  DB* const follower_;
+  const std::string checkpoint_file_;
+  std::unique_ptr<Directory> directory_;  // of the checkpoint file
+  SequenceNumber applied_;
+  std::vector<WriteBatch> batches_;  // one per thread
+  Partitioner partitioner_;
+
+  // The threads writing the batches but the first one, for all the calls
+  ThreadPool pool_;
+  std::vector<WriteJob> jobs_;
+  std::vector<Status> statuses_;
+  port::Mutex mu_;
+  size_t pending_jobs_;  // guarded by mu_
+  port::CondVar cv_;
+};
+
+void ChangeApplierImpl::BGWorkWrite(void* arg) {
+  WriteJob* job = reinterpret_cast<WriteJob*>(arg);
+  ChangeApplierImpl* applier = job->applier;
+  Status s = applier->follower_->Write(applier->options_.write_options,
+                                       &applier->batches_[job->batch]);
+  MutexLock l(&applier->mu_);
+  applier->statuses_[job->batch] = s;
+  if (--applier->pending_jobs_ == 0) {
+    applier->cv_.SignalAll();
+  }
+}
+
+Status ChangeApplierImpl::Apply(const std::vector<ChangeRecord>& records) {
+  if (records.empty()) {
+    return Status::OK();
+  }
+  for (auto& batch : batches_) {
+    batch.Clear();
+  }
+
+  SequenceNumber last = applied_;
+  for (const auto& record : records) {
+    if (record.data.size() < WriteBatchInternal::kHeader) {
+      return Status::Corruption("malformed WriteBatch (too small)");
+    }
+    partitioner_.Reset(record.sequence, applied_);
+    Status s = WriteBatchInternal::Iterate(record.data, &partitioner_);
+    if (!partitioner_.status().ok()) {
+      return partitioner_.status();
+    }
+    if (!s.ok()) {
+      return s;
+    }
+    uint32_t count = DecodeFixed32(record.data.data() + 8);
+    if (count > 0) {
+      last = std::max(last, record.sequence + count - 1);
+    }
+  }
+  if (last == applied_) {
+    return Status::OK();
+  }
+
+  for (auto& s : statuses_) {
+    s = Status::OK();
+  }
+  for (size_t i = 1; i < batches_.size(); i++) {
+    if (batches_[i].Count() > 0) {
+      {
+        MutexLock l(&mu_);
+        pending_jobs_++;
+      }
+      pool_.Schedule(&ChangeApplierImpl::BGWorkWrite, &jobs_[i], nullptr,
+                     nullptr);
+    }
+  }
+  if (batches_[0].Count() > 0) {
+    statuses_[0] = follower_->Write(options_.write_options, &batches_[0]);
+  }
+  {
+    MutexLock l(&mu_);
+    while (pending_jobs_ > 0) {
+      cv_.Wait();
+    }
+  }
+  for (const auto& s : statuses_) {
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  SequenceNumber previous = applied_;
+  applied_ = last;
+  Status s = WriteCheckpoint();
+  if (!s.ok()) {
+    applied_ = previous;
+  }
+  return s;
+}
+
+Status ChangeApplierImpl::WriteCheckpoint() {
+  Status s;
+  if (options_.write_options.disableWAL) {
+    for (const auto& it : options_.column_families) {
+      s = follower_->Flush(FlushOptions(), it.second);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  } else if (!options_.write_options.sync) {
+    s = follower_->SyncWAL();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  // Replaced atomically, as CURRENT
+  Env* env = follower_->GetEnv();
+  std::string tmp = checkpoint_file_ + ".dbtmp";
+  s = WriteStringToFile(env, ToString(applied_) + "\n", tmp, true);
+  if (s.ok()) {
+    s = env->RenameFile(tmp, checkpoint_file_);
+  }
+  if (!s.ok()) {
+    env->DeleteFile(tmp);
+    return s;
+  }
+  // the rename is durable once the directory is
+  return directory_->Fsync();
+}
+
+}  // namespace
+
+Status ChangeApplier::Open(const ChangeApplierOptions& options, DB* follower,
+                           std::unique_ptr<ChangeApplier>* applier) {
+  Env* env = follower->GetEnv();
+  std::string checkpoint_file = follower->GetName() + "/" + kCheckpointFileName;
+  SequenceNumber applied = 0;
+  Status s = env->FileExists(checkpoint_file);
+  if (s.ok()) {
+    std::string contents;
+    s = ReadFileToString(env, checkpoint_file, &contents);
+    if (!s.ok()) {
+      return s;
+    }
+    Slice input(contents);
+    if (!ConsumeDecimalNumber(&input, &applied) || input != "\n") {
+      return Status::Corruption("Bad change applier checkpoint",
+                                checkpoint_file);
+    }
+  } else if (!s.IsNotFound()) {
+    return s;
+  }
+
+  std::unique_ptr<Directory> directory;
+  s = env->NewDirectory(follower->GetName(), &directory);
+  if (!s.ok()) {
+    return s;
+  }
+  applier->reset(
+      new ChangeApplierImpl(options, follower, applied, std::move(directory)));
+  return Status::OK();
+}
+
+}  // namespace vidardb
+#endif  // VIDARDB_LITE
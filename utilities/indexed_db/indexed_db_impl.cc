@@ -0,0 +1,645 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include "utilities/indexed_db/indexed_db_impl.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "db/column_family.h"
+#include "db/db_impl.h"
+#include "db/dbformat.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+#include "vidardb/comparator.h"
+#include "vidardb/table.h"
+#include "vidardb/write_batch.h"
+
+namespace vidardb {
+
+namespace {
+
+const std::string kIndexColumnFamilyPrefix = "__vidardb_index__";
+
+// Rows put in a single batch while an index is created
+const int kCreateIndexBatchSize = 1000;
+
+// An index key is the column value followed by the user key. The column
+// value is escaped so that the index keys sort by column value first:
+// 0x00 becomes 0x00 0xff, and the column value ends with 0x00 0x01.
+void AppendColumnValue(const Slice& column_value, std::string* index_key) {
+  for (size_t i = 0; i < column_value.size(); i++) {
+    index_key->push_back(column_value[i]);
+    if (column_value[i] == '\0') {
+      index_key->push_back('\xff');
+    }
+  }
+  index_key->push_back('\0');
+  index_key->push_back('\x01');
+}
+
+std::string IndexKey(const Slice& column_value, const Slice& key) {
+  std::string index_key;
+  index_key.reserve(column_value.size() + 2 + key.size());
+  AppendColumnValue(column_value, &index_key);
+  index_key.append(key.data(), key.size());
+  return index_key;
+}
+
+bool ParseIndexKey(const Slice& index_key, std::string* column_value,
+                   Slice* key) {
+  column_value->clear();
+  for (size_t i = 0; i + 1 < index_key.size(); i++) {
+    if (index_key[i] != '\0') {
+      column_value->push_back(index_key[i]);
+    } else if (index_key[i + 1] == '\xff') {
+      column_value->push_back('\0');
+      i++;
+    } else if (index_key[i + 1] == '\x01') {
+      *key = Slice(index_key.data() + i + 2, index_key.size() - i - 2);
+      return true;
+    } else {
+      return false;
+    }
+  }
+  return false;
+}
+
+// Whether column_value is within range, both ends included
+bool InRange(const Slice& column_value, const Range& range) {
+  return (range.start.compare(kRangeQueryMin) == 0 ||
+          column_value.compare(range.start) >= 0) &&
+         (range.limit.compare(kRangeQueryMax) == 0 ||
+          column_value.compare(range.limit) <= 0);
+}
+
+}  // anonymous namespace
+
+IndexCompactionFilter::IndexCompactionFilter(
+    uint32_t column, const std::shared_ptr<Splitter>& splitter)
+    : column_(column),
+      splitter_(splitter),
+      db_(nullptr),
+      base_column_family_(nullptr) {}
+
+IndexCompactionFilter::~IndexCompactionFilter() { Detach(); }
+
+void IndexCompactionFilter::Attach(DB* db,
+                                   ColumnFamilyHandle* base_column_family) {
+  WriteLock wl(&mutex_);
+  assert(base_column_family_ == nullptr);
+  db_ = db;
+  base_column_family_ = base_column_family;
+}
+
+void IndexCompactionFilter::Detach() {
+  WriteLock wl(&mutex_);
+  delete base_column_family_;
+  base_column_family_ = nullptr;
+  db_ = nullptr;
+}
+
+bool IndexCompactionFilter::Filter(int level, const Slice& key,
+                                   const Slice& existing_value,
+                                   std::string* new_value,
+                                   bool* value_changed) const {
+  ReadLock rl(&mutex_);
+  if (base_column_family_ == nullptr) {
+    return false;
+  }
+
+  std::string column_value;
+  Slice user_key;
+  if (!ParseIndexKey(key, &column_value, &user_key)) {
+    return false;
+  }
+
+  ReadOptions read_options;
+  std::string row;
+  Status s = db_->Get(read_options, base_column_family_, user_key, &row);
+  if (s.IsNotFound()) {
+    return true;
+  } else if (!s.ok()) {
+    return false;  // keep the entry if unsure
+  }
+
+  std::vector<Slice> columns(splitter_->Split(row));
+  return column_ > columns.size() || columns[column_ - 1] != column_value;
+}
+
+// Collects the index entries of the rows put in a WriteBatch
+class IndexedDBImpl::IndexInserter : public WriteBatch::Handler {
+ public:
+  IndexInserter(
+      const std::unordered_map<uint32_t, IndexedColumnFamily>& indexed,
+      WriteBatch* index_batch)
+      : indexed_(indexed), index_batch_(index_batch) {}
+
+  virtual Status PutCF(uint32_t column_family_id, const Slice& key,
+                       const Slice& value) override {
+    auto it = indexed_.find(column_family_id);
+    if (it == indexed_.end()) {
+      return Status::OK();
+    }
+    std::vector<Slice> columns(it->second.splitter->Split(value));
+    for (const auto& index : it->second.indexes) {
+      if (index.column <= columns.size()) {
+        index_batch_->Put(index.column_family,
+                          IndexKey(columns[index.column - 1], key), Slice());
+      }
+    }
+    return Status::OK();
+  }
+
+  // Deleted rows leave their index entries to the compaction filter
+  virtual Status DeleteCF(uint32_t column_family_id,
+                          const Slice& key) override {
+    return Status::OK();
+  }
+
+  virtual Status MarkBeginPrepare() override { return Status::OK(); }
+
+  virtual Status MarkEndPrepare(const Slice& xid) override {
+    return Status::OK();
+  }
+
+  virtual Status MarkCommit(const Slice& xid) override { return Status::OK(); }
+
+  virtual Status MarkRollback(const Slice& xid) override {
+    return Status::OK();
+  }
+
+ private:
+  const std::unordered_map<uint32_t, IndexedColumnFamily>& indexed_;
+  WriteBatch* index_batch_;
+};
+
+IndexedDBImpl::IndexedDBImpl(DB* db) : IndexedDB(db) {}
+
+IndexedDBImpl::~IndexedDBImpl() {
+  for (auto& filter : filters_) {
+    filter->Detach();
+  }
+  for (auto& it : indexed_column_families_) {
+    for (auto& index : it.second.indexes) {
+      delete index.column_family;
+    }
+  }
+  // Close the DB while the compaction filters are still alive
+  delete db_;
+  db_ = nullptr;
+}
+
+std::string IndexedDBImpl::IndexColumnFamilyName(
+    uint32_t column, const std::string& base_name) {
+  return kIndexColumnFamilyPrefix + ToString(column) + "." + base_name;
+}
+
+bool IndexedDBImpl::ParseIndexColumnFamilyName(const std::string& name,
+                                               uint32_t* column,
+                                               std::string* base_name) {
+  if (name.compare(0, kIndexColumnFamilyPrefix.size(),
+                   kIndexColumnFamilyPrefix) != 0) {
+    return false;
+  }
+  size_t dot = name.find('.', kIndexColumnFamilyPrefix.size());
+  if (dot == std::string::npos || dot == kIndexColumnFamilyPrefix.size()) {
+    return false;
+  }
+  uint64_t value = 0;
+  for (size_t i = kIndexColumnFamilyPrefix.size(); i < dot; i++) {
+    if (!isdigit(name[i])) {
+      return false;
+    }
+    value = value * 10 + (name[i] - '0');
+    if (value > std::numeric_limits<uint32_t>::max()) {
+      return false;
+    }
+  }
+  *column = static_cast<uint32_t>(value);
+  *base_name = name.substr(dot + 1);
+  return *column > 0;
+}
+
+ColumnFamilyOptions IndexedDBImpl::IndexColumnFamilyOptions(
+    const ColumnFamilyOptions& base_options, const CompactionFilter* filter) {
+  ColumnFamilyOptions options(base_options);
+  // the index keys are escaped to sort bytewise
+  options.comparator = BytewiseComparator();
+  options.splitter.reset();
+  options.table_factory.reset(NewBlockBasedTableFactory());
+  options.min_blob_size = 0;
+  options.compaction_filter = filter;
+  return options;
+}
+
+void IndexedDBImpl::AddIndex(ColumnFamilyHandle* base_column_family,
+                             uint32_t column,
+                             const std::shared_ptr<Splitter>& splitter,
+                             ColumnFamilyHandle* index_column_family,
+                             std::unique_ptr<IndexCompactionFilter>&& filter) {
+  auto db_impl = reinterpret_cast<DBImpl*>(GetRootDB());
+  filter->Attach(db_, db_impl->NewColumnFamilyHandle(base_column_family));
+
+  IndexedColumnFamily& indexed =
+      indexed_column_families_[base_column_family->GetID()];
+  indexed.splitter = splitter;
+  indexed.indexes.push_back({column, index_column_family, filter.get()});
+  filters_.push_back(std::move(filter));
+}
+
+const IndexedDBImpl::Index* IndexedDBImpl::FindIndex(
+    ColumnFamilyHandle* column_family, uint32_t column) const {
+  auto it = indexed_column_families_.find(column_family->GetID());
+  if (it == indexed_column_families_.end()) {
+    return nullptr;
+  }
+  for (const auto& index : it->second.indexes) {
+    if (index.column == column) {
+      return &index;
+    }
+  }
+  return nullptr;
+}
+
+void IndexedDBImpl::RemoveIndex(IndexedColumnFamily* indexed, size_t i) {
+  Index& index = indexed->indexes[i];
+  index.filter->Detach();
+  delete index.column_family;
+  indexed->indexes.erase(indexed->indexes.begin() + i);
+}
+
+Status IndexedDBImpl::Put(const WriteOptions& options,
+                          ColumnFamilyHandle* column_family, const Slice& key,
+                          const Slice& val) {
+  WriteBatch batch;
+  batch.Put(column_family, key, val);
+  return Write(options, &batch);
+}
+
+Status IndexedDBImpl::Write(const WriteOptions& opts, WriteBatch* updates) {
+  ReadLock rl(&mutex_);
+  if (indexed_column_families_.empty()) {
+    return db_->Write(opts, updates);
+  }
+
+  // Append the index entries to a copy of the batch, so that they are
+  // written in the same write group as the rows.
+  WriteBatch batch(*updates);
+  IndexInserter inserter(indexed_column_families_, &batch);
+  Status s = updates->Iterate(&inserter);
+  if (!s.ok()) {
+    return s;
+  }
+  return db_->Write(opts, &batch);
+}
+
+Status IndexedDBImpl::CompactRange(const CompactRangeOptions& options,
+                                   ColumnFamilyHandle* column_family,
+                                   const Slice* begin, const Slice* end) {
+  Status s = db_->CompactRange(options, column_family, begin, end);
+  ReadLock rl(&mutex_);
+  auto it = indexed_column_families_.find(column_family->GetID());
+  if (it != indexed_column_families_.end()) {
+    for (const auto& index : it->second.indexes) {
+      if (!s.ok()) {
+        break;
+      }
+      s = db_->CompactRange(options, index.column_family, nullptr, nullptr);
+    }
+  }
+  return s;
+}
+
+Status IndexedDBImpl::DropColumnFamily(ColumnFamilyHandle* column_family) {
+  WriteLock wl(&mutex_);
+  auto it = indexed_column_families_.find(column_family->GetID());
+  if (it != indexed_column_families_.end()) {
+    auto& indexes = it->second.indexes;
+    while (!indexes.empty()) {
+      Status s = db_->DropColumnFamily(indexes.back().column_family);
+      if (!s.ok()) {
+        return s;
+      }
+      RemoveIndex(&it->second, indexes.size() - 1);
+    }
+    indexed_column_families_.erase(it);
+  }
+  return db_->DropColumnFamily(column_family);
+}
+
+Status IndexedDBImpl::CreateIndex(ColumnFamilyHandle* column_family,
+                                  uint32_t column) {
+  if (column == 0) {
+    return Status::InvalidArgument("Columns to index start from 1");
+  }
+
+  WriteLock wl(&mutex_);
+  if (FindIndex(column_family, column) != nullptr) {
+    return Status::InvalidArgument("Index already exists");
+  }
+  const ColumnFamilyOptions& base_options = GetOptions(column_family);
+  std::shared_ptr<Splitter> splitter = base_options.splitter;
+  if (!splitter) {
+    return Status::InvalidArgument("Column family has no splitter");
+  }
+
+  std::unique_ptr<IndexCompactionFilter> filter(
+      new IndexCompactionFilter(column, splitter));
+  ColumnFamilyHandle* index_column_family;
+  Status s = db_->CreateColumnFamily(
+      IndexColumnFamilyOptions(base_options, filter.get()),
+      IndexColumnFamilyName(column, column_family->GetName()),
+      &index_column_family);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // The writes wait for the write lock, so that no row is missed
+  WriteBatch batch;
+  std::unique_ptr<Iterator> iter(
+      db_->NewIterator(ReadOptions(), column_family));
+  for (iter->SeekToFirst(); s.ok() && iter->Valid(); iter->Next()) {
+    std::vector<Slice> columns(splitter->Split(iter->value()));
+    if (column <= columns.size()) {
+      batch.Put(index_column_family,
+                IndexKey(columns[column - 1], iter->key()), Slice());
+    }
+    if (batch.Count() >= kCreateIndexBatchSize) {
+      s = db_->Write(WriteOptions(), &batch);
+      batch.Clear();
+    }
+  }
+  if (s.ok()) {
+    s = iter->status();
+  }
+  if (s.ok() && batch.Count() > 0) {
+    s = db_->Write(WriteOptions(), &batch);
+  }
+  iter.reset();
+
+  if (!s.ok()) {
+    db_->DropColumnFamily(index_column_family);
+    delete index_column_family;
+    return s;
+  }
+  AddIndex(column_family, column, splitter, index_column_family,
+           std::move(filter));
+  return s;
+}
+
+Status IndexedDBImpl::DropIndex(ColumnFamilyHandle* column_family,
+                                uint32_t column) {
+  WriteLock wl(&mutex_);
+  auto it = indexed_column_families_.find(column_family->GetID());
+  if (it == indexed_column_families_.end()) {
+    return Status::NotFound("No index on the column");
+  }
+  auto& indexes = it->second.indexes;
+  for (size_t i = 0; i < indexes.size(); i++) {
+    if (indexes[i].column == column) {
+      Status s = db_->DropColumnFamily(indexes[i].column_family);
+      if (s.ok()) {
+        RemoveIndex(&it->second, i);
+        if (indexes.empty()) {
+          indexed_column_families_.erase(it);
+        }
+      }
+      return s;
+    }
+  }
+  return Status::NotFound("No index on the column");
+}
+
+bool IndexedDBImpl::RangeQueryByIndex(ReadOptions& read_options,
+                                      ColumnFamilyHandle* column_family,
+                                      uint32_t column, const Range& range,
+                                      std::list<RangeQueryKeyVal>& res,
+                                      Status* s) {
+  res.clear();
+  read_options.result_key_size = 0;
+  read_options.result_val_size = 0;
+
+  // Look up the keys of the rows at the first batch
+  if (read_options.range_query_meta == nullptr) {
+    std::unique_ptr<IndexRangeQueryMeta> meta(new IndexRangeQueryMeta);
+    *s = LookupIndex(read_options, column_family, column, range, meta.get());
+    if (!s->ok()) {
+      if (meta->snapshot != nullptr) {
+        db_->ReleaseSnapshot(meta->snapshot);
+      }
+      return false;
+    }
+    read_options.range_query_meta = meta.release();
+  }
+  IndexRangeQueryMeta* meta =
+      static_cast<IndexRangeQueryMeta*>(read_options.range_query_meta);
+
+  // Fetch the rows in key order with a single iterator, skipping the stale
+  // entries whose row has another column value now
+  ReadOptions ro(read_options);
+  ro.columns.clear();
+  if (meta->snapshot != nullptr) {
+    ro.snapshot = meta->snapshot;
+  }
+  const Comparator* ucmp =
+      reinterpret_cast<ColumnFamilyHandleImpl*>(column_family)
+          ->user_comparator();
+  const Splitter* splitter = GetOptions(column_family).splitter.get();
+  *s = Status::OK();
+  if (meta->next < meta->keys.size()) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro, column_family));
+    std::string buf;
+    for (; meta->next < meta->keys.size(); meta->next++) {
+      const std::string& k = meta->keys[meta->next];
+      iter->Seek(k);
+      if (!iter->Valid() || ucmp->Compare(iter->key(), k) != 0) {
+        continue;
+      }
+      std::vector<Slice> columns(splitter->Split(iter->value()));
+      if (column > columns.size() ||
+          !InRange(columns[column - 1], range)) {
+        continue;
+      }
+      buf.clear();
+      Slice val = ReformatUserValue(iter->value(), read_options.columns,
+                                    splitter, buf);
+      // A batch has at least one row, the next ones up to the capacity
+      if (read_options.batch_capacity > 0 && !res.empty() &&
+          read_options.result_key_size + read_options.result_val_size +
+                  k.size() + val.size() >
+              read_options.batch_capacity) {
+        break;
+      }
+      res.emplace_back(k, val.ToString());
+      read_options.result_key_size += k.size();
+      read_options.result_val_size += val.size();
+    }
+    *s = iter->status();
+  }
+
+  bool next_query = s->ok() && meta->next < meta->keys.size();
+  if (!next_query) {
+    if (meta->snapshot != nullptr) {
+      db_->ReleaseSnapshot(meta->snapshot);
+    }
+    delete meta;
+    read_options.range_query_meta = nullptr;
+  }
+  return next_query;
+}
+
+Status IndexedDBImpl::LookupIndex(const ReadOptions& read_options,
+                                  ColumnFamilyHandle* column_family,
+                                  uint32_t column, const Range& range,
+                                  IndexRangeQueryMeta* meta) {
+  ReadLock rl(&mutex_);
+  const Index* index = FindIndex(column_family, column);
+  if (index == nullptr) {
+    return Status::NotFound("No index on the column");
+  }
+
+  // Read the index and the rows from the same snapshot
+  ReadOptions ro(read_options);
+  ro.columns.clear();
+  if (ro.snapshot == nullptr) {
+    meta->snapshot = db_->GetSnapshot();
+    ro.snapshot = meta->snapshot;
+  }
+
+  std::unique_ptr<Iterator> index_iter(
+      db_->NewIterator(ro, index->column_family));
+  if (range.start.compare(kRangeQueryMin) == 0) {
+    index_iter->SeekToFirst();
+  } else {
+    std::string start;
+    AppendColumnValue(range.start, &start);
+    index_iter->Seek(start);
+  }
+  std::string column_value;
+  Slice key;
+  for (; index_iter->Valid(); index_iter->Next()) {
+    if (!ParseIndexKey(index_iter->key(), &column_value, &key)) {
+      continue;
+    }
+    if (!InRange(column_value, range)) {
+      break;
+    }
+    meta->keys.push_back(key.ToString());
+  }
+  Status s = index_iter->status();
+
+  const Comparator* ucmp =
+      reinterpret_cast<ColumnFamilyHandleImpl*>(column_family)
+          ->user_comparator();
+  std::sort(meta->keys.begin(), meta->keys.end(),
+            [ucmp](const std::string& a, const std::string& b) {
+              return ucmp->Compare(a, b) < 0;
+            });
+  meta->keys.erase(std::unique(meta->keys.begin(), meta->keys.end()),
+                   meta->keys.end());
+  return s;
+}
+
+Status IndexedDB::Open(const Options& options, const std::string& dbname,
+                       IndexedDB** dbptr) {
+  DBOptions db_options(options);
+  ColumnFamilyOptions cf_options(options);
+  std::vector<ColumnFamilyDescriptor> column_families;
+  column_families.push_back(
+      ColumnFamilyDescriptor(kDefaultColumnFamilyName, cf_options));
+  std::vector<ColumnFamilyHandle*> handles;
+  Status s = IndexedDB::Open(db_options, dbname, column_families, &handles,
+                             dbptr);
+  if (s.ok()) {
+    assert(handles.size() == 1);
+    // i can delete the handle since DBImpl is always holding a reference to
+    // default column family
+    delete handles[0];
+  }
+
+  return s;
+}
+
+Status IndexedDB::Open(
+    const DBOptions& db_options, const std::string& dbname,
+    const std::vector<ColumnFamilyDescriptor>& column_families,
+    std::vector<ColumnFamilyHandle*>* handles, IndexedDB** dbptr) {
+  // Open the index column families along with their base ones
+  std::vector<std::string> names;
+  if (!DB::ListColumnFamilies(db_options, dbname, &names).ok()) {
+    names.clear();  // a new DB
+  }
+
+  std::vector<ColumnFamilyDescriptor> column_families_copy = column_families;
+  std::vector<size_t> base_indices;
+  std::vector<uint32_t> columns;
+  std::vector<std::unique_ptr<IndexCompactionFilter>> filters;
+  for (const auto& name : names) {
+    uint32_t column;
+    std::string base_name;
+    if (!IndexedDBImpl::ParseIndexColumnFamilyName(name, &column,
+                                                   &base_name)) {
+      continue;
+    }
+    size_t i = 0;
+    while (i < column_families.size() && column_families[i].name != base_name) {
+      i++;
+    }
+    if (i == column_families.size()) {
+      return Status::InvalidArgument("Column family of index not opened: ",
+                                     base_name);
+    }
+    const ColumnFamilyOptions& base_options = column_families[i].options;
+    if (!base_options.splitter) {
+      return Status::InvalidArgument("Indexed column family has no splitter: ",
+                                     base_name);
+    }
+
+    filters.emplace_back(
+        new IndexCompactionFilter(column, base_options.splitter));
+    ColumnFamilyOptions options = IndexedDBImpl::IndexColumnFamilyOptions(
+        base_options, filters.back().get());
+    // Disable compactions momentarily, until the filter is attached
+    options.disable_auto_compactions = true;
+    column_families_copy.push_back(ColumnFamilyDescriptor(name, options));
+    base_indices.push_back(i);
+    columns.push_back(column);
+  }
+
+  DB* db;
+  std::vector<ColumnFamilyHandle*> all_handles;
+  Status s = DB::Open(db_options, dbname, column_families_copy, &all_handles,
+                      &db);
+  if (!s.ok()) {
+    return s;
+  }
+
+  IndexedDBImpl* indexed_db = new IndexedDBImpl(db);
+  *dbptr = indexed_db;
+  handles->assign(all_handles.begin(),
+                  all_handles.begin() + column_families.size());
+
+  std::vector<ColumnFamilyHandle*> compaction_enabled_cf_handles;
+  for (size_t j = 0; j < base_indices.size(); j++) {
+    ColumnFamilyHandle* index_handle = all_handles[column_families.size() + j];
+    indexed_db->AddIndex(all_handles[base_indices[j]], columns[j],
+                         column_families[base_indices[j]].options.splitter,
+                         index_handle, std::move(filters[j]));
+    if (!column_families[base_indices[j]].options.disable_auto_compactions) {
+      compaction_enabled_cf_handles.push_back(index_handle);
+    }
+  }
+  if (!compaction_enabled_cf_handles.empty()) {
+    s = indexed_db->EnableAutoCompaction(compaction_enabled_cf_handles);
+  }
+
+  return s;
+}
+
+}  //  namespace vidardb
+#endif  // VIDARDB_LITE
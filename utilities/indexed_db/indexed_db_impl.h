@@ -0,0 +1,161 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef VIDARDB_LITE
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "vidardb/compaction_filter.h"
+#include "vidardb/db.h"
+#include "vidardb/options.h"
+#include "vidardb/utilities/indexed_db.h"
+
+namespace vidardb {
+
+// Removes the index entries whose row does not have the indexed column value
+// any more.
+class IndexCompactionFilter : public CompactionFilter {
+ public:
+  IndexCompactionFilter(uint32_t column,
+                        const std::shared_ptr<Splitter>& splitter);
+
+  ~IndexCompactionFilter();
+
+  // Starts checking the rows in base_column_family of db, and takes the
+  // ownership of the handle. Until then, all the entries are kept.
+  void Attach(DB* db, ColumnFamilyHandle* base_column_family);
+
+  // Stops checking the rows, e.g. once the index is dropped, and deletes the
+  // handle.
+  void Detach();
+
+  virtual bool Filter(int level, const Slice& key, const Slice& existing_value,
+                      std::string* new_value,
+                      bool* value_changed) const override;
+
+  virtual const char* Name() const override {
+    return "vidardb.IndexCompactionFilter";
+  }
+
+ private:
+  const uint32_t column_;
+  const std::shared_ptr<Splitter> splitter_;
+
+  // Protects db_ and base_column_family_ from Detach()
+  mutable port::RWMutex mutex_;
+  DB* db_;
+  ColumnFamilyHandle* base_column_family_;
+};
+
+class IndexedDBImpl : public IndexedDB {
+ public:
+  explicit IndexedDBImpl(DB* db);
+
+  ~IndexedDBImpl();
+
+  // Registers the index on column of base_column_family, opened or created
+  // as index_column_family.
+  void AddIndex(ColumnFamilyHandle* base_column_family, uint32_t column,
+                const std::shared_ptr<Splitter>& splitter,
+                ColumnFamilyHandle* index_column_family,
+                std::unique_ptr<IndexCompactionFilter>&& filter);
+
+  using StackableDB::Put;
+  virtual Status Put(const WriteOptions& options,
+                     ColumnFamilyHandle* column_family, const Slice& key,
+                     const Slice& val) override;
+
+  using StackableDB::Write;
+  virtual Status Write(const WriteOptions& opts, WriteBatch* updates) override;
+
+  // Also compacts the whole indexes of column_family, which removes their
+  // stale entries.
+  using StackableDB::CompactRange;
+  virtual Status CompactRange(const CompactRangeOptions& options,
+                              ColumnFamilyHandle* column_family,
+                              const Slice* begin, const Slice* end) override;
+
+  using StackableDB::DropColumnFamily;
+  virtual Status DropColumnFamily(ColumnFamilyHandle* column_family) override;
+
+  virtual Status CreateIndex(ColumnFamilyHandle* column_family,
+                             uint32_t column) override;
+
+  virtual Status DropIndex(ColumnFamilyHandle* column_family,
+                           uint32_t column) override;
+
+  virtual bool RangeQueryByIndex(ReadOptions& read_options,
+                                 ColumnFamilyHandle* column_family,
+                                 uint32_t column, const Range& range,
+                                 std::list<RangeQueryKeyVal>& res,
+                                 Status* s) override;
+
+  // Name of the hidden column family of the index on column of the column
+  // family base_name.
+  static std::string IndexColumnFamilyName(uint32_t column,
+                                           const std::string& base_name);
+
+  // Returns false if name is not the one of an index column family.
+  static bool ParseIndexColumnFamilyName(const std::string& name,
+                                         uint32_t* column,
+                                         std::string* base_name);
+
+  // Options of the index column families of the column family base_options.
+  static ColumnFamilyOptions IndexColumnFamilyOptions(
+      const ColumnFamilyOptions& base_options, const CompactionFilter* filter);
+
+ private:
+  struct Index {
+    uint32_t column;
+    ColumnFamilyHandle* column_family;
+    IndexCompactionFilter* filter;
+  };
+
+  struct IndexedColumnFamily {
+    std::shared_ptr<Splitter> splitter;
+    std::vector<Index> indexes;
+  };
+
+  // The state of RangeQueryByIndex() between its batches
+  struct IndexRangeQueryMeta {
+    const Snapshot* snapshot = nullptr;  // taken by the query, if any
+    std::vector<std::string> keys;       // of the rows, in their order
+    size_t next = 0;                     // the next key to fetch
+  };
+
+  class IndexInserter;
+
+  // Collects into meta the keys of the rows whose column is within range.
+  Status LookupIndex(const ReadOptions& read_options,
+                     ColumnFamilyHandle* column_family, uint32_t column,
+                     const Range& range, IndexRangeQueryMeta* meta);
+
+  // REQUIRES: mutex_ held
+  const Index* FindIndex(ColumnFamilyHandle* column_family,
+                         uint32_t column) const;
+
+  // REQUIRES: mutex_ write locked
+  void RemoveIndex(IndexedColumnFamily* indexed, size_t i);
+
+  // Guards indexed_column_families_: write locked while the indexes change,
+  // read locked by the writes and the lookups.
+  port::RWMutex mutex_;
+
+  // Keyed by the ID of the base column family
+  std::unordered_map<uint32_t, IndexedColumnFamily> indexed_column_families_;
+
+  // The compaction filters of the index column families, including the
+  // dropped ones, which must outlive the DB.
+  std::vector<std::unique_ptr<IndexCompactionFilter>> filters_;
+};
+
+}  //  namespace vidardb
+#endif  // VIDARDB_LITE
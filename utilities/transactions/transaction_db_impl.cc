@@ -17,14 +17,33 @@
 #include <vector>
 
 #include "db/db_impl.h"
+#include "db/write_batch_internal.h"
 #include "utilities/transactions/transaction_db_mutex_impl.h"
 #include "utilities/transactions/transaction_impl.h"
+#include "utilities/transactions/write_prepared_txn_db.h"
 #include "vidardb/db.h"
 #include "vidardb/options.h"
 #include "vidardb/utilities/transaction_db.h"
 
 namespace vidardb {
 
+namespace {
+
+// The write-prepared transactions read their data through snapshots, which the
+// in-place memtable updates do not support
+Status CheckWritePolicy(const TransactionDBOptions& txn_db_options,
+                        const ColumnFamilyOptions& cf_options) {
+  if (txn_db_options.write_policy == WRITE_PREPARED &&
+      cf_options.inplace_update_support) {
+    return Status::InvalidArgument(
+        "WRITE_PREPARED transactions are not compatible with "
+        "inplace_update_support");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 TransactionDBImpl::TransactionDBImpl(DB* db,
                                      const TransactionDBOptions& txn_db_options)
     : TransactionDB(db),
@@ -37,12 +56,13 @@ TransactionDBImpl::TransactionDBImpl(DB* db,
 }
 
 TransactionDBImpl::~TransactionDBImpl() {
-  for (const auto& it : transactions_) {
-    delete it.second;
+  // The transactions remove themselves from both maps
+  while (!transactions_.empty()) {
+    delete transactions_.begin()->second;
   }
 
-  for (const auto& it : expirable_transactions_) {
-    delete it.second;
+  while (!expirable_transactions_.empty()) {
+    delete expirable_transactions_.begin()->second;
   }
 }
 
@@ -169,9 +189,13 @@ Status TransactionDBImpl::Write(const WriteOptions& opts, WriteBatch* updates) {
 Status TransactionDBImpl::CreateColumnFamily(
     const ColumnFamilyOptions& options, const std::string& column_family_name,
     ColumnFamilyHandle** handle) {
+  Status s = CheckWritePolicy(txn_db_options_, options);
+  if (!s.ok()) {
+    return s;
+  }
   InstrumentedMutexLock l(&column_family_mutex_);
 
-  Status s = db_->CreateColumnFamily(options, column_family_name, handle);
+  s = db_->CreateColumnFamily(options, column_family_name, handle);
   if (s.ok()) {
     lock_mgr_.AddColumnFamily((*handle)->GetID());
   }
@@ -297,6 +321,10 @@ Status TransactionDB::Open(
   // Enable MemTable History if not already enabled
   for (size_t i = 0; i < column_families_copy.size(); i++) {
     ColumnFamilyOptions* options = &column_families_copy[i].options;
+    Status s = CheckWritePolicy(txn_db_options, *options);
+    if (!s.ok()) {
+      return s;
+    }
 
     if (options->max_write_buffer_number_to_maintain == 0) {
       // Setting to -1 will set the History size to max_write_buffer_number.
@@ -317,26 +345,22 @@ Status TransactionDB::Open(
       DB::Open(db_options_2pc, dbname, column_families_copy, handles, &db);
 
   if (s.ok()) {
-    TransactionDBImpl* txn_db = new TransactionDBImpl(
-        db, TransactionDBImpl::ValidateTxnDBOptions(txn_db_options));
+    TransactionDBImpl* txn_db;
+    if (txn_db_options.write_policy == WRITE_PREPARED) {
+      txn_db = new WritePreparedTxnDB(
+          db, TransactionDBImpl::ValidateTxnDBOptions(txn_db_options));
+    } else {
+      txn_db = new TransactionDBImpl(
+          db, TransactionDBImpl::ValidateTxnDBOptions(txn_db_options));
+    }
     *dbptr = txn_db;
 
     for (auto cf_ptr : *handles) {
       txn_db->AddColumnFamily(cf_ptr);
     }
 
-    // Re-enable compaction for the column families that initially had
-    // compaction enabled.
-    assert(column_families_copy.size() == (*handles).size());
-    std::vector<ColumnFamilyHandle*> compaction_enabled_cf_handles;
-    compaction_enabled_cf_handles.reserve(compaction_enabled_cf_indices.size());
-    for (auto index : compaction_enabled_cf_indices) {
-      compaction_enabled_cf_handles.push_back((*handles)[index]);
-    }
-
-    s = txn_db->EnableAutoCompaction(compaction_enabled_cf_handles);
-
-    // create 'real' transactions from recovered shell transactions
+    // create 'real' transactions from recovered shell transactions, before
+    // the compactions drop the versions their prepared data replaced
     assert(dynamic_cast<DBImpl*>(db) != nullptr);
     auto dbimpl = reinterpret_cast<DBImpl*>(db);
     auto recovered_txns = dbimpl->recovered_transactions();
@@ -365,10 +389,30 @@ Status TransactionDB::Open(
       if (!s.ok()) {
         break;
       }
+      if (txn_db_options.write_policy == WRITE_PREPARED) {
+        reinterpret_cast<WritePreparedTxnDB*>(txn_db)->AddRecoveredTransaction(
+            txn, recovered_txn->seq_,
+            WriteBatchInternal::Count(recovered_txn->batch_));
+      }
     }
     if (s.ok()) {
       dbimpl->DeleteAllRecoveredTransactions();
     }
+
+    // Re-enable compaction for the column families that initially had
+    // compaction enabled.
+    assert(column_families_copy.size() == (*handles).size());
+    std::vector<ColumnFamilyHandle*> compaction_enabled_cf_handles;
+    compaction_enabled_cf_handles.reserve(compaction_enabled_cf_indices.size());
+    for (auto index : compaction_enabled_cf_indices) {
+      compaction_enabled_cf_handles.push_back((*handles)[index]);
+    }
+
+    Status enable_status =
+        txn_db->EnableAutoCompaction(compaction_enabled_cf_handles);
+    if (s.ok()) {
+      s = enable_status;
+    }
   }
 
   return s;
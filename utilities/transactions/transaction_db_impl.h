@@ -83,11 +83,12 @@ class TransactionDBImpl : public TransactionDB {
   void RegisterTransaction(Transaction* txn);
   void UnregisterTransaction(Transaction* txn);
 
- private:
+ protected:
   void ReinitializeTransaction(
       Transaction* txn, const WriteOptions& write_options,
       const TransactionOptions& txn_options = TransactionOptions());
 
+ private:
   Transaction* BeginInternalTransaction(const WriteOptions& options);
 
   const TransactionDBOptions txn_db_options_;
@@ -56,7 +56,8 @@ void TransactionImpl::Initialize(const TransactionOptions& txn_options) {
     SetSnapshot();
   }
 
-  if (expiration_time_ > 0) {
+  expirable_ = expiration_time_ > 0;
+  if (expirable_) {
     txn_db_impl_->InsertExpirableTransaction(txn_id_, this);
   }
 }
@@ -68,6 +69,7 @@ TransactionImpl::TransactionImpl(TransactionDB* txn_db,
       txn_db_impl_(nullptr),
       txn_id_(0),
       expiration_time_(0),
+      expirable_(false),
       lock_timeout_(0) {
   txn_db_impl_ = dynamic_cast<TransactionDBImpl*>(txn_db);
   assert(txn_db_impl_);
@@ -80,7 +82,7 @@ TransactionImpl::TransactionImpl(TransactionDB* txn_db,
 
 TransactionImpl::~TransactionImpl() {
   txn_db_impl_->UnLock(this, &GetTrackedKeys());
-  if (expiration_time_ > 0) {
+  if (expirable_) {
     txn_db_impl_->RemoveExpirableTransaction(txn_id_);
   }
   if (!name_.empty() && exec_status_ != COMMITED) {
@@ -128,12 +130,8 @@ Status TransactionImpl::Prepare() {
   if (can_prepare) {
     // transaction can't expire after preparation
     expiration_time_ = 0;
-    WriteOptions write_options = write_options_;
-    write_options.disableWAL = false;
     WriteBatchInternal::MarkEndPrepare(GetWriteBatch()->GetWriteBatch(), name_);
-    s = db_impl_->WriteImpl(write_options, GetWriteBatch()->GetWriteBatch(),
-                            /*callback*/ nullptr, &log_number_, /*log ref*/ 0,
-                            /* disable_memtable*/ true);
+    s = PrepareInternal();
     if (s.ok()) {
       assert(log_number_ != 0);
       dbimpl_->MarkLogAsContainingPrepSection(log_number_);
@@ -201,25 +199,7 @@ Status TransactionImpl::Commit() {
     }
   } else if (commit_prepared) {
     exec_status_.store(AWAITING_COMMIT);
-    WriteOptions write_options = write_options_;
-
-    // insert prepared batch into Memtable only.
-    // Memtable will ignore BeginPrepare/EndPrepare markers
-    // in non recovery mode and simply insert the values
-    write_options.disableWAL = true;
-    assert(log_number_ > 0);
-    s = db_impl_->WriteImpl(write_options, GetWriteBatch()->GetWriteBatch(),
-                            nullptr, nullptr, log_number_);
-    if (!s.ok()) {
-      return s;
-    }
-
-    // We take the commit-time batch and append the Commit marker.
-    // We then write this batch to both WAL and Memtable.
-    // The Memtable will ignore the Commit marker in non-recovery mode
-    write_options.disableWAL = false;
-    WriteBatchInternal::MarkCommit(GetCommitTimeWriteBatch(), name_);
-    s = db_impl_->WriteImpl(write_options, GetCommitTimeWriteBatch());
+    s = CommitInternal();
     if (!s.ok()) {
       return s;
     }
@@ -246,6 +226,43 @@ Status TransactionImpl::Commit() {
   return s;
 }
 
+Status TransactionImpl::PrepareInternal() {
+  WriteOptions write_options = write_options_;
+  write_options.disableWAL = false;
+  return db_impl_->WriteImpl(write_options, GetWriteBatch()->GetWriteBatch(),
+                             /*callback*/ nullptr, &log_number_, /*log ref*/ 0,
+                             /* disable_memtable*/ true);
+}
+
+Status TransactionImpl::CommitInternal() {
+  WriteOptions write_options = write_options_;
+
+  // insert prepared batch into Memtable only.
+  // Memtable will ignore BeginPrepare/EndPrepare markers
+  // in non recovery mode and simply insert the values
+  write_options.disableWAL = true;
+  assert(log_number_ > 0);
+  Status s = db_impl_->WriteImpl(write_options,
+                                 GetWriteBatch()->GetWriteBatch(), nullptr,
+                                 nullptr, log_number_);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // We take the commit-time batch and append the Commit marker.
+  // We then write this batch to both WAL and Memtable.
+  // The Memtable will ignore the Commit marker in non-recovery mode
+  write_options.disableWAL = false;
+  WriteBatchInternal::MarkCommit(GetCommitTimeWriteBatch(), name_);
+  return db_impl_->WriteImpl(write_options, GetCommitTimeWriteBatch());
+}
+
+Status TransactionImpl::RollbackInternal() {
+  WriteBatch rollback_marker;
+  WriteBatchInternal::MarkRollback(&rollback_marker, name_);
+  return db_impl_->WriteImpl(write_options_, &rollback_marker);
+}
+
 // Lock all keys in this batch.
 // On success, caller should unlock keys_to_unlock
 Status TransactionImpl::LockBatch(WriteBatch* batch,
@@ -358,10 +375,8 @@ Status TransactionImpl::CommitBatch(WriteBatch* batch) {
 Status TransactionImpl::Rollback() {
   Status s;
   if (exec_status_ == PREPARED) {
-    WriteBatch rollback_marker;
-    WriteBatchInternal::MarkRollback(&rollback_marker, name_);
     exec_status_.store(AWAITING_ROLLBACK);
-    s = db_impl_->WriteImpl(write_options_, &rollback_marker);
+    s = RollbackInternal();
     if (s.ok()) {
       // we do not need to keep our prepared section around
       assert(log_number_ > 0);
@@ -424,6 +439,9 @@ void TransactionImpl::Reinitialize(TransactionDB* txn_db,
   if (!name_.empty() && exec_status_ != COMMITED) {
     txn_db_impl_->UnregisterTransaction(this);
   }
+  if (expirable_) {
+    txn_db_impl_->RemoveExpirableTransaction(txn_id_);
+  }
   TransactionBaseImpl::Reinitialize(txn_db->GetBaseDB(), write_options);
   Initialize(txn_options);
 }
@@ -76,10 +76,23 @@ class TransactionImpl : public TransactionBaseImpl {
   Status TryLock(ColumnFamilyHandle* column_family, const Slice& key,
                  bool read_only, bool untracked = false) override;
 
- private:
+  // The writes of Prepare(), of Commit() after Prepare(), and of Rollback()
+  // after Prepare(). They write the prepared data to the memtables at commit.
+  virtual Status PrepareInternal();
+  virtual Status CommitInternal();
+  virtual Status RollbackInternal();
+
+  virtual Status ValidateSnapshot(ColumnFamilyHandle* column_family,
+                                  const Slice& key, SequenceNumber prev_seqno,
+                                  SequenceNumber* new_seqno);
+
+  void Clear() override;
+
   TransactionDBImpl* txn_db_impl_;
   DBImpl* db_impl_;
 
+ private:
+
   // Used to create unique ids for transactions.
   static std::atomic<TransactionID> txn_id_counter_;
 
@@ -90,6 +103,11 @@ class TransactionImpl : public TransactionBaseImpl {
   // microseconds according to Env->NowMicros())
   uint64_t expiration_time_;
 
+  // Whether this transaction is in the expirable transactions of the DB. It
+  // stays there after Prepare() clears expiration_time_, so that its locks
+  // are not stolen.
+  bool expirable_;
+
   // Timeout in microseconds when locking a key or -1 if there is no timeout.
   int64_t lock_timeout_;
 
@@ -98,13 +116,8 @@ class TransactionImpl : public TransactionBaseImpl {
   // returns true if this transaction has an expiration_time and has expired.
   bool IsExpired() const;
 
-  void Clear() override;
-
   Status LockBatch(WriteBatch* batch, TransactionKeyMap* keys_to_unlock);
 
-  Status ValidateSnapshot(ColumnFamilyHandle* column_family, const Slice& key,
-                          SequenceNumber prev_seqno, SequenceNumber* new_seqno);
-
   void UnlockGetForUpdate(ColumnFamilyHandle* column_family,
                           const Slice& key) override;
 
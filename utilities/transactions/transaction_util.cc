@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "db/db_impl.h"
+#include "db/read_callback.h"
 #include "util/string_util.h"
 #include "vidardb/status.h"
 #include "vidardb/utilities/write_batch_with_index.h"
@@ -26,7 +27,7 @@ namespace vidardb {
 Status TransactionUtil::CheckKey(DBImpl* db_impl, SuperVersion* sv,
                                  SequenceNumber earliest_seq,
                                  SequenceNumber key_seq, const std::string& key,
-                                 bool cache_only) {
+                                 bool cache_only, ReadCallback* callback) {
   Status result;
   bool need_to_read_sst = false;
 
@@ -78,7 +79,8 @@ Status TransactionUtil::CheckKey(DBImpl* db_impl, SuperVersion* sv,
 
     if (!(s.ok() || s.IsNotFound())) {
       result = s;
-    } else if (found_record_for_key && (seq > key_seq)) {
+    } else if (found_record_for_key &&
+               (callback ? !callback->IsVisible(seq) : seq > key_seq)) {
       // Write Conflict
       result = Status::Busy();
     }
@@ -91,7 +93,8 @@ Status TransactionUtil::CheckKeyForConflicts(DBImpl* db_impl,
                                              ColumnFamilyHandle* column_family,
                                              const std::string& key,
                                              SequenceNumber key_seq,
-                                             bool cache_only) {
+                                             bool cache_only,
+                                             ReadCallback* callback) {
   Status result;
 
   auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
@@ -107,7 +110,8 @@ Status TransactionUtil::CheckKeyForConflicts(DBImpl* db_impl,
     SequenceNumber earliest_seq =
         db_impl->GetEarliestMemTableSequenceNumber(sv, true);
 
-    result = CheckKey(db_impl, sv, earliest_seq, key_seq, key, cache_only);
+    result = CheckKey(db_impl, sv, earliest_seq, key_seq, key, cache_only,
+                      callback);
 
     db_impl->ReturnAndCleanupSuperVersion(cfd, sv);
   }
@@ -33,6 +33,7 @@ using TransactionKeyMap =
                        std::unordered_map<std::string, TransactionKeyMapInfo>>;
 
 class DBImpl;
+class ReadCallback;
 struct SuperVersion;
 class WriteBatchWithIndex;
 
@@ -45,12 +46,16 @@ class TransactionUtil {
   // SST files. This will make it more likely this function will
   // return an error if it is unable to determine if there are any conflicts.
   //
+  // If callback is not null, a write is a conflict if it is not visible to
+  // callback instead, which is expected to be at the key_seq snapshot.
+  //
   // Returns OK on success, BUSY if there is a conflicting write, or other error
   // status for any unexpected errors.
   static Status CheckKeyForConflicts(DBImpl* db_impl,
                                      ColumnFamilyHandle* column_family,
                                      const std::string& key,
-                                     SequenceNumber key_seq, bool cache_only);
+                                     SequenceNumber key_seq, bool cache_only,
+                                     ReadCallback* callback = nullptr);
 
   // For each key,SequenceNumber pair in the TransactionKeyMap, this function
   // will verify there have been no writes to the key in the db since that
@@ -68,7 +73,8 @@ class TransactionUtil {
  private:
   static Status CheckKey(DBImpl* db_impl, SuperVersion* sv,
                          SequenceNumber earliest_seq, SequenceNumber key_seq,
-                         const std::string& key, bool cache_only);
+                         const std::string& key, bool cache_only,
+                         ReadCallback* callback = nullptr);
 };
 
 }  // namespace vidardb
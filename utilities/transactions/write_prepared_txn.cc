@@ -0,0 +1,254 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include "utilities/transactions/write_prepared_txn.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "db/db_impl.h"
+#include "db/pre_release_callback.h"
+#include "db/write_batch_internal.h"
+#include "util/string_util.h"
+#include "utilities/transactions/transaction_util.h"
+#include "utilities/transactions/write_prepared_txn_db.h"
+
+namespace vidardb {
+
+namespace {
+
+// Adds the data of the prepare write to the commit table
+class AddPreparedCallback : public PreReleaseCallback {
+ public:
+  AddPreparedCallback(WritePreparedTxnDB* db, size_t count,
+                      const Snapshot* guard)
+      : db_(db), count_(count), guard_(guard), seq_(0) {}
+
+  virtual void Callback(SequenceNumber seq,
+                        SequenceNumber /*last_seq*/) override {
+    db_->AddPrepared(seq, seq + count_ - 1, guard_);
+    seq_ = seq;
+  }
+
+  // 0 if not called
+  SequenceNumber seq() const { return seq_; }
+
+ private:
+  WritePreparedTxnDB* db_;
+  const size_t count_;
+  const Snapshot* guard_;
+  SequenceNumber seq_;
+};
+
+// Commits the prepared data at the sequence number the write is published at
+class AddCommittedCallback : public PreReleaseCallback {
+ public:
+  AddCommittedCallback(WritePreparedTxnDB* db, SequenceNumber prepare_seq)
+      : db_(db), prepare_seq_(prepare_seq) {}
+
+  virtual void Callback(SequenceNumber /*seq*/,
+                        SequenceNumber last_seq) override {
+    db_->AddCommitted(prepare_seq_, last_seq);
+  }
+
+ private:
+  WritePreparedTxnDB* db_;
+  const SequenceNumber prepare_seq_;
+};
+
+// The keys of a batch, by column family id
+class KeyCollector : public WriteBatch::Handler {
+ public:
+  std::map<uint32_t, std::set<std::string>> keys_;
+
+  virtual Status PutCF(uint32_t column_family_id, const Slice& key,
+                       const Slice& /*value*/) override {
+    keys_[column_family_id].insert(key.ToString());
+    return Status::OK();
+  }
+
+  virtual Status DeleteCF(uint32_t column_family_id,
+                          const Slice& key) override {
+    keys_[column_family_id].insert(key.ToString());
+    return Status::OK();
+  }
+};
+
+}  // namespace
+
+WritePreparedTxn::WritePreparedTxn(WritePreparedTxnDB* txn_db,
+                                   const WriteOptions& write_options,
+                                   const TransactionOptions& txn_options)
+    : TransactionImpl(txn_db, write_options, txn_options),
+      wpt_db_(txn_db),
+      prepare_seq_(0),
+      recovered_(false) {}
+
+Status WritePreparedTxn::Get(ReadOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Slice& key, std::string* value) {
+  return GetWriteBatch()->GetFromBatchAndDB(wpt_db_, options, column_family,
+                                            key, value);
+}
+
+Iterator* WritePreparedTxn::GetIterator(const ReadOptions& options) {
+  Iterator* db_iter = wpt_db_->NewIterator(options);
+  assert(db_iter);
+
+  return GetWriteBatch()->NewIteratorWithBase(db_iter);
+}
+
+Iterator* WritePreparedTxn::GetIterator(const ReadOptions& options,
+                                        ColumnFamilyHandle* column_family) {
+  Iterator* db_iter = wpt_db_->NewIterator(options, column_family);
+  assert(db_iter);
+
+  return GetWriteBatch()->NewIteratorWithBase(column_family, db_iter);
+}
+
+Status WritePreparedTxn::PrepareInternal() {
+  WriteBatch* batch = GetWriteBatch()->GetWriteBatch();
+  size_t count = WriteBatchInternal::Count(batch);
+  if (count == 0) {
+    // nothing to hide from the reads
+    return TransactionImpl::PrepareInternal();
+  }
+
+  WriteOptions write_options = write_options_;
+  write_options.disableWAL = false;
+  // Keeps the versions replaced by the prepared data, for the reads not
+  // seeing it and for Rollback()
+  const Snapshot* guard = db_->GetSnapshot();
+  AddPreparedCallback callback(wpt_db_, count, guard);
+  Status s = db_impl_->WriteImpl(write_options, batch, /*callback*/ nullptr,
+                                 &log_number_, /*log ref*/ 0,
+                                 /* disable_memtable*/ false, &callback);
+  if (callback.seq() != 0) {
+    // in the commit table, even if the memtable insert failed
+    prepare_seq_ = callback.seq();
+  } else {
+    db_->ReleaseSnapshot(guard);
+  }
+  return s;
+}
+
+Status WritePreparedTxn::CommitInternal() {
+  if (prepare_seq_ == 0) {
+    return TransactionImpl::CommitInternal();
+  }
+
+  WriteOptions write_options = write_options_;
+  Status s;
+  if (recovered_) {
+    write_options.disableWAL = true;
+    assert(log_number_ > 0);
+    s = db_impl_->WriteImpl(write_options, GetWriteBatch()->GetWriteBatch(),
+                            nullptr, nullptr, log_number_);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  // The commit-time batch is written outside of the commit table, at the
+  // same time as the commit
+  write_options.disableWAL = false;
+  WriteBatchInternal::MarkCommit(GetCommitTimeWriteBatch(), name_);
+  AddCommittedCallback callback(wpt_db_, prepare_seq_);
+  s = db_impl_->WriteImpl(write_options, GetCommitTimeWriteBatch(), nullptr,
+                          nullptr, 0, false, &callback);
+  if (s.ok()) {
+    wpt_db_->RemoveObsoleteEntries();
+  }
+  return s;
+}
+
+Status WritePreparedTxn::RollbackInternal() {
+  if (prepare_seq_ == 0) {
+    return TransactionImpl::RollbackInternal();
+  }
+
+  KeyCollector collector;
+  Status s = GetWriteBatch()->GetWriteBatch()->Iterate(&collector);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // The prepared data is not committed in the guard snapshot, so the reads
+  // at it return the values the data replaced
+  WriteBatch rollback_batch;
+  ReadOptions ro;
+  ro.snapshot = wpt_db_->GetPreparedGuard(prepare_seq_);
+  for (const auto& cf_keys : collector.keys_) {
+    ColumnFamilyHandle* cfh = db_impl_->GetColumnFamilyHandleUnlocked(
+        cf_keys.first);
+    if (cfh == nullptr) {
+      return Status::InvalidArgument("Could not access column family " +
+                                     ToString(cf_keys.first));
+    }
+    std::unique_ptr<ColumnFamilyHandle> handle(
+        db_impl_->NewColumnFamilyHandle(cfh));
+    for (const auto& key : cf_keys.second) {
+      std::string value;
+      s = wpt_db_->Get(ro, handle.get(), key, &value);
+      if (s.ok()) {
+        WriteBatchInternal::Put(&rollback_batch, cf_keys.first, key, value);
+      } else if (s.IsNotFound()) {
+        WriteBatchInternal::Delete(&rollback_batch, cf_keys.first, key);
+      } else {
+        return s;
+      }
+    }
+  }
+
+  // The restored values are visible with the rollback, which commits the
+  // prepared data they shadow
+  WriteBatchInternal::MarkRollback(&rollback_batch, name_);
+  AddCommittedCallback callback(wpt_db_, prepare_seq_);
+  s = db_impl_->WriteImpl(write_options_, &rollback_batch, nullptr, nullptr, 0,
+                          false, &callback);
+  if (s.ok()) {
+    wpt_db_->RemoveObsoleteEntries();
+  }
+  return s;
+}
+
+// Return OK() if this key has not been committed more recently than the
+// transaction snapshot_.
+Status WritePreparedTxn::ValidateSnapshot(ColumnFamilyHandle* column_family,
+                                          const Slice& key,
+                                          SequenceNumber prev_seqno,
+                                          SequenceNumber* new_seqno) {
+  assert(snapshot_);
+
+  SequenceNumber seq = snapshot_->GetSequenceNumber();
+  if (prev_seqno <= seq) {
+    return Status::OK();
+  }
+
+  *new_seqno = seq;
+
+  ColumnFamilyHandle* cfh =
+      column_family ? column_family : db_impl_->DefaultColumnFamily();
+
+  // Data prepared before the snapshot may be committed after it
+  WritePreparedReadCallback callback(wpt_db_, seq);
+  return TransactionUtil::CheckKeyForConflicts(db_impl_, cfh, key.ToString(),
+                                               seq, false /* cache_only */,
+                                               &callback);
+}
+
+void WritePreparedTxn::Clear() {
+  prepare_seq_ = 0;
+  recovered_ = false;
+  TransactionImpl::Clear();
+}
+
+}  // namespace vidardb
+
+#endif  // VIDARDB_LITE
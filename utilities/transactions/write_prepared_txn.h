@@ -0,0 +1,77 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#ifndef VIDARDB_LITE
+
+#include <string>
+
+#include "utilities/transactions/transaction_impl.h"
+#include "vidardb/db.h"
+#include "vidardb/slice.h"
+#include "vidardb/status.h"
+#include "vidardb/types.h"
+#include "vidardb/utilities/transaction_db.h"
+
+namespace vidardb {
+
+class WritePreparedTxnDB;
+
+// A transaction of a WritePreparedTxnDB. Prepare() writes its data to the WAL
+// and the memtables, so Commit() only writes the commit-time batch and the
+// commit marker. Rollback() after Prepare() writes back the values the
+// prepared data replaced.
+//
+// The transactions committed without Prepare() write their data at commit,
+// outside of the commit table.
+class WritePreparedTxn : public TransactionImpl {
+ public:
+  WritePreparedTxn(WritePreparedTxnDB* db, const WriteOptions& write_options,
+                   const TransactionOptions& txn_options);
+
+  virtual ~WritePreparedTxn() {}
+
+  using TransactionImpl::Get;
+  Status Get(ReadOptions& options, ColumnFamilyHandle* column_family,
+             const Slice& key, std::string* value) override;
+
+  Iterator* GetIterator(const ReadOptions& options) override;
+  Iterator* GetIterator(const ReadOptions& options,
+                        ColumnFamilyHandle* column_family) override;
+
+  // For a transaction recovered as prepared. Its data prepared at seq is no
+  // longer in the memtables, so it is written again at commit.
+  void SetRecoveredPrepareSeq(SequenceNumber seq) {
+    prepare_seq_ = seq;
+    recovered_ = true;
+  }
+
+ protected:
+  Status PrepareInternal() override;
+  Status CommitInternal() override;
+  Status RollbackInternal() override;
+
+  Status ValidateSnapshot(ColumnFamilyHandle* column_family, const Slice& key,
+                          SequenceNumber prev_seqno,
+                          SequenceNumber* new_seqno) override;
+
+  void Clear() override;
+
+ private:
+  WritePreparedTxnDB* wpt_db_;
+
+  // Of the first prepared update in the commit table, 0 if none
+  SequenceNumber prepare_seq_;
+  bool recovered_;
+
+  // No copying allowed
+  WritePreparedTxn(const WritePreparedTxn&);
+  void operator=(const WritePreparedTxn&);
+};
+
+}  // namespace vidardb
+
+#endif  // VIDARDB_LITE
@@ -0,0 +1,233 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef VIDARDB_LITE
+
+#include "utilities/transactions/write_prepared_txn_db.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "db/db_impl.h"
+#include "util/mutexlock.h"
+#include "utilities/transactions/write_prepared_txn.h"
+
+namespace vidardb {
+
+namespace {
+
+// The read state of an iterator, deleted with it
+struct IteratorState {
+  IteratorState(WritePreparedTxnDB* _db, SequenceNumber snapshot_seq,
+                const Snapshot* _own_snapshot)
+      : db(_db), callback(_db, snapshot_seq), own_snapshot(_own_snapshot) {}
+
+  WritePreparedTxnDB* db;
+  WritePreparedReadCallback callback;
+  const Snapshot* own_snapshot;  // taken for the iterator, if any
+};
+
+void CleanupIteratorState(void* arg1, void* /*arg2*/) {
+  IteratorState* state = reinterpret_cast<IteratorState*>(arg1);
+  if (state->own_snapshot != nullptr) {
+    state->db->ReleaseSnapshot(state->own_snapshot);
+  }
+  delete state;
+}
+
+}  // namespace
+
+WritePreparedTxnDB::WritePreparedTxnDB(
+    DB* db, const TransactionDBOptions& txn_db_options)
+    : TransactionDBImpl(db, txn_db_options),
+      num_prepared_(0),
+      num_committed_(0) {
+  assert(dynamic_cast<DBImpl*>(db) != nullptr);
+  db_impl_ = reinterpret_cast<DBImpl*>(db);
+}
+
+WritePreparedTxnDB::~WritePreparedTxnDB() {
+  // The base DB is deleted by StackableDB
+  for (const auto& it : prepared_) {
+    db_->ReleaseSnapshot(it.second.guard);
+  }
+}
+
+Transaction* WritePreparedTxnDB::BeginTransaction(
+    const WriteOptions& write_options, const TransactionOptions& txn_options,
+    Transaction* old_txn) {
+  if (old_txn != nullptr) {
+    ReinitializeTransaction(old_txn, write_options, txn_options);
+    return old_txn;
+  } else {
+    return new WritePreparedTxn(this, write_options, txn_options);
+  }
+}
+
+// Without a snapshot, a read may still see a transaction committed after it
+// started, as if it had started later.
+Status WritePreparedTxnDB::Get(ReadOptions& options,
+                               ColumnFamilyHandle* column_family,
+                               const Slice& key, std::string* value) {
+  SequenceNumber snapshot_seq = options.snapshot != nullptr
+                                    ? options.snapshot->GetSequenceNumber()
+                                    : db_->GetLatestSequenceNumber();
+  WritePreparedReadCallback callback(this, snapshot_seq);
+  return db_impl_->GetImpl(options, column_family, key, value,
+                           nullptr /*value_found*/, &callback);
+}
+
+Iterator* WritePreparedTxnDB::NewIterator(const ReadOptions& options,
+                                          ColumnFamilyHandle* column_family) {
+  ReadOptions ro(options);
+  const Snapshot* own_snapshot = nullptr;
+  SequenceNumber snapshot_seq = kMaxSequenceNumber;
+  if (!ro.tailing) {
+    // Its snapshot keeps the commits it does not see in the commit table
+    if (ro.snapshot == nullptr) {
+      own_snapshot = db_->GetSnapshot();
+      ro.snapshot = own_snapshot;
+    }
+    snapshot_seq = ro.snapshot->GetSequenceNumber();
+  }
+  IteratorState* state = new IteratorState(this, snapshot_seq, own_snapshot);
+  Iterator* iter =
+      db_impl_->NewIteratorImpl(ro, column_family, &state->callback);
+  iter->RegisterCleanup(CleanupIteratorState, state, nullptr);
+  return iter;
+}
+
+void WritePreparedTxnDB::ReleaseSnapshot(const Snapshot* snapshot) {
+  db_->ReleaseSnapshot(snapshot);
+  RemoveObsoleteEntries();
+}
+
+Status WritePreparedTxnDB::GetColumns(const ReadOptions& /*options*/,
+                                      ColumnFamilyHandle* /*column_family*/,
+                                      const Slice& /*key*/,
+                                      const std::vector<uint32_t>& /*columns*/,
+                                      std::vector<std::string>* /*values*/) {
+  return Status::NotSupported("Not supported by WRITE_PREPARED");
+}
+
+Status WritePreparedTxnDB::SampleRange(const ReadOptions& /*options*/,
+                                       ColumnFamilyHandle* /*column_family*/,
+                                       const Range& /*range*/, size_t /*n*/,
+                                       std::list<RangeQueryKeyVal>& /*res*/) {
+  return Status::NotSupported("Not supported by WRITE_PREPARED");
+}
+
+void WritePreparedTxnDB::GetAsync(const ReadOptions& /*options*/,
+                                  ColumnFamilyHandle* /*column_family*/,
+                                  const Slice& /*key*/, GetCallback callback) {
+  callback(Status::NotSupported("Not supported by WRITE_PREPARED"),
+           std::string());
+}
+
+void WritePreparedTxnDB::RangeQueryAsync(ReadOptions& /*options*/,
+                                         ColumnFamilyHandle* /*column_family*/,
+                                         const Range& /*range*/,
+                                         std::list<RangeQueryKeyVal>& /*res*/,
+                                         RangeQueryCallback callback) {
+  callback(Status::NotSupported("Not supported by WRITE_PREPARED"), false);
+}
+
+bool WritePreparedTxnDB::IsInSnapshot(SequenceNumber seq,
+                                      SequenceNumber snapshot_seq) const {
+  if (seq > snapshot_seq) {
+    return false;
+  }
+  // A snapshot at or after seq was taken after seq was added, if prepared
+  if (num_prepared_.load(std::memory_order_acquire) == 0) {
+    return true;
+  }
+  ReadLock rl(&prepared_mutex_);
+  auto it = prepared_.upper_bound(seq);
+  if (it == prepared_.begin()) {
+    return true;
+  }
+  --it;
+  if (seq > it->second.last_seq) {
+    return true;
+  }
+  return it->second.commit_seq <= snapshot_seq;
+}
+
+void WritePreparedTxnDB::AddPrepared(SequenceNumber first_seq,
+                                     SequenceNumber last_seq,
+                                     const Snapshot* guard) {
+  assert(first_seq <= last_seq);
+  WriteLock wl(&prepared_mutex_);
+  prepared_[first_seq] = {last_seq, kMaxSequenceNumber, guard};
+  num_prepared_.store(prepared_.size(), std::memory_order_release);
+}
+
+void WritePreparedTxnDB::AddCommitted(SequenceNumber first_seq,
+                                      SequenceNumber commit_seq) {
+  WriteLock wl(&prepared_mutex_);
+  auto it = prepared_.find(first_seq);
+  assert(it != prepared_.end());
+  assert(it->second.commit_seq == kMaxSequenceNumber);
+  assert(it->second.last_seq < commit_seq);
+  it->second.commit_seq = commit_seq;
+  num_committed_.fetch_add(1, std::memory_order_release);
+}
+
+const Snapshot* WritePreparedTxnDB::GetPreparedGuard(
+    SequenceNumber first_seq) const {
+  ReadLock rl(&prepared_mutex_);
+  auto it = prepared_.find(first_seq);
+  assert(it != prepared_.end());
+  return it->second.guard;
+}
+
+void WritePreparedTxnDB::AddRecoveredTransaction(Transaction* txn,
+                                                 SequenceNumber seq,
+                                                 size_t count) {
+  if (count == 0) {
+    return;
+  }
+  AddPrepared(seq, seq + count - 1, db_impl_->GetSnapshotAt(seq - 1));
+  assert(dynamic_cast<WritePreparedTxn*>(txn) != nullptr);
+  reinterpret_cast<WritePreparedTxn*>(txn)->SetRecoveredPrepareSeq(seq);
+}
+
+void WritePreparedTxnDB::RemoveObsoleteEntries() {
+  if (num_committed_.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+  // The snapshots taken from now on are at or after the commits published by
+  // now. The ones not published yet are kept.
+  SequenceNumber published = db_->GetLatestSequenceNumber();
+  std::vector<SequenceNumber> snapshots = db_impl_->GetSnapshotSequences();
+
+  std::vector<const Snapshot*> guards;
+  {
+    WriteLock wl(&prepared_mutex_);
+    for (auto it = prepared_.begin(); it != prepared_.end();) {
+      const PreparedEntry& entry = it->second;
+      if (entry.commit_seq <= published) {
+        auto snapshot =
+            std::lower_bound(snapshots.begin(), snapshots.end(), it->first);
+        if (snapshot == snapshots.end() || *snapshot >= entry.commit_seq) {
+          guards.push_back(entry.guard);
+          it = prepared_.erase(it);
+          num_committed_.fetch_sub(1, std::memory_order_relaxed);
+          continue;
+        }
+      }
+      ++it;
+    }
+    num_prepared_.store(prepared_.size(), std::memory_order_release);
+  }
+
+  for (auto guard : guards) {
+    db_->ReleaseSnapshot(guard);
+  }
+}
+
+}  //  namespace vidardb
+#endif  // VIDARDB_LITE
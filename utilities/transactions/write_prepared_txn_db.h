@@ -0,0 +1,137 @@
+//  Copyright (c) 2019-present, VidarDB, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef VIDARDB_LITE
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "db/read_callback.h"
+#include "port/port.h"
+#include "utilities/transactions/transaction_db_impl.h"
+#include "vidardb/db.h"
+#include "vidardb/utilities/transaction_db.h"
+
+namespace vidardb {
+
+// A TransactionDB of the WRITE_PREPARED policy. The transactions write their
+// data to the memtables at prepare, and the reads skip the data of the
+// transactions not committed in their snapshot.
+//
+// The sequence numbers of the prepared data are kept in a commit table, along
+// with their commit sequence number once committed. A transaction is
+// committed in a snapshot if its commit sequence number is not greater than
+// the one of the snapshot. The data written outside of the commit table is
+// committed as soon as it is written. An entry is dropped once committed and
+// no live snapshot sits between its prepare and its commit.
+class WritePreparedTxnDB : public TransactionDBImpl {
+ public:
+  WritePreparedTxnDB(DB* db, const TransactionDBOptions& txn_db_options);
+
+  ~WritePreparedTxnDB();
+
+  Transaction* BeginTransaction(const WriteOptions& write_options,
+                                const TransactionOptions& txn_options,
+                                Transaction* old_txn) override;
+
+  using TransactionDBImpl::Get;
+  virtual Status Get(ReadOptions& options, ColumnFamilyHandle* column_family,
+                     const Slice& key, std::string* value) override;
+
+  using TransactionDBImpl::NewIterator;
+  virtual Iterator* NewIterator(const ReadOptions& options,
+                                ColumnFamilyHandle* column_family) override;
+
+  virtual void ReleaseSnapshot(const Snapshot* snapshot) override;
+
+  using TransactionDBImpl::GetColumns;
+  virtual Status GetColumns(const ReadOptions& options,
+                            ColumnFamilyHandle* column_family,
+                            const Slice& key,
+                            const std::vector<uint32_t>& columns,
+                            std::vector<std::string>* values) override;
+
+  using TransactionDBImpl::SampleRange;
+  virtual Status SampleRange(const ReadOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Range& range, size_t n,
+                             std::list<RangeQueryKeyVal>& res) override;
+
+  using TransactionDBImpl::GetAsync;
+  virtual void GetAsync(const ReadOptions& options,
+                        ColumnFamilyHandle* column_family, const Slice& key,
+                        GetCallback callback) override;
+
+  using TransactionDBImpl::RangeQueryAsync;
+  virtual void RangeQueryAsync(ReadOptions& options,
+                               ColumnFamilyHandle* column_family,
+                               const Range& range,
+                               std::list<RangeQueryKeyVal>& res,
+                               RangeQueryCallback callback) override;
+
+  // Whether the data written at seq is visible to a snapshot at snapshot_seq
+  bool IsInSnapshot(SequenceNumber seq, SequenceNumber snapshot_seq) const;
+
+  // Adds the prepared data from first_seq to last_seq to the commit table.
+  // guard keeps the versions the data replaced until the entry is dropped,
+  // and is released then.
+  void AddPrepared(SequenceNumber first_seq, SequenceNumber last_seq,
+                   const Snapshot* guard);
+
+  // Commits the prepared data starting at first_seq at commit_seq.
+  void AddCommitted(SequenceNumber first_seq, SequenceNumber commit_seq);
+
+  // The guard of the prepared data starting at first_seq
+  const Snapshot* GetPreparedGuard(SequenceNumber first_seq) const;
+
+  // Adds the data of a transaction recovered as prepared to the commit table.
+  // Its data may already be in the SST files, at the sequence numbers it was
+  // prepared at, but is no longer in the memtables.
+  void AddRecoveredTransaction(Transaction* txn, SequenceNumber seq,
+                               size_t count);
+
+  // Drops the committed entries no snapshot can tell from the data written
+  // outside of the commit table.
+  void RemoveObsoleteEntries();
+
+ private:
+  struct PreparedEntry {
+    SequenceNumber last_seq;
+    SequenceNumber commit_seq;  // kMaxSequenceNumber while prepared
+    const Snapshot* guard;
+  };
+
+  DBImpl* db_impl_;
+
+  mutable port::RWMutex prepared_mutex_;
+  // By the sequence number of their first update
+  std::map<SequenceNumber, PreparedEntry> prepared_;
+  // Size of prepared_, and its committed entries, read without the mutex
+  std::atomic<size_t> num_prepared_;
+  std::atomic<size_t> num_committed_;
+};
+
+// Visibility of the reads of a WritePreparedTxnDB at a snapshot
+class WritePreparedReadCallback : public ReadCallback {
+ public:
+  WritePreparedReadCallback(const WritePreparedTxnDB* db,
+                            SequenceNumber snapshot_seq)
+      : db_(db), snapshot_seq_(snapshot_seq) {}
+
+  virtual bool IsVisible(SequenceNumber seq) override {
+    return db_->IsInSnapshot(seq, snapshot_seq_);
+  }
+
+ private:
+  const WritePreparedTxnDB* db_;
+  const SequenceNumber snapshot_seq_;
+};
+
+}  //  namespace vidardb
+#endif  // VIDARDB_LITE
@@ -13,6 +13,7 @@
 #include "db/column_family.h"
 #include "memtable/skiplist.h"
 #include "util/arena.h"
+#include "util/string_util.h"
 #include "utilities/write_batch_with_index/write_batch_with_index_internal.h"
 #include "vidardb/comparator.h"
 #include "vidardb/iterator.h"
@@ -327,16 +328,24 @@ class WBWIIteratorImpl : public WBWIIterator {
 
 struct WriteBatchWithIndex::Rep {
   Rep(const Comparator* index_comparator, size_t reserved_bytes = 0,
-      bool _overwrite_key = false)
+      bool _overwrite_key = false, bool hash_index = false)
       : write_batch(reserved_bytes),
         comparator(index_comparator, &write_batch),
         skip_list(comparator, &arena),
         overwrite_key(_overwrite_key),
-        last_entry_offset(0) {}
+        last_entry_offset(0) {
+    if (hash_index) {
+      hash_map.reset(new WriteBatchEntryHashIndex(
+          0, WriteBatchEntryHash(&write_batch),
+          WriteBatchEntryEqual(&write_batch)));
+    }
+  }
   ReadableWriteBatch write_batch;
   WriteBatchEntryComparator comparator;
   Arena arena;
   WriteBatchEntrySkipList skip_list;
+  // nullptr unless hash_index
+  std::unique_ptr<WriteBatchEntryHashIndex> hash_map;
   bool overwrite_key;
   size_t last_entry_offset;
 
@@ -359,6 +368,16 @@ struct WriteBatchWithIndex::Rep {
   // put it to skip list.
   void AddNewEntry(uint32_t column_family_id);
 
+  // The newest index entry of key, nullptr if there is none or if key can not
+  // be looked up in hash_map.
+  WriteBatchIndexEntry* FindNewestEntry(uint32_t column_family_id,
+                                        const Slice& key);
+  // Looks key up in hash_map. Returns false if it is not usable for
+  // column_family_id.
+  bool GetFromHashIndex(uint32_t column_family_id, const Slice& key,
+                        WriteBatchWithIndexInternal::Result* result,
+                        std::string* value, Status* s);
+
   // Clear all updates buffered in this batch.
   void Clear();
   void ClearIndex();
@@ -380,6 +399,15 @@ bool WriteBatchWithIndex::Rep::UpdateExistingEntryWithCfId(
     return false;
   }
 
+  if (hash_map != nullptr && comparator.IsBytewise(column_family_id)) {
+    WriteBatchIndexEntry* entry = FindNewestEntry(column_family_id, key);
+    if (entry == nullptr) {
+      return false;
+    }
+    entry->offset = last_entry_offset;
+    return true;
+  }
+
   WBWIIteratorImpl iter(column_family_id, &skip_list, &write_batch);
   iter.Seek(key);
   if (!iter.Valid()) {
@@ -427,6 +455,53 @@ void WriteBatchWithIndex::Rep::AddNewEntry(uint32_t column_family_id) {
       new (mem) WriteBatchIndexEntry(last_entry_offset, column_family_id,
                                      key.data() - wb_data.data(), key.size());
   skip_list.Insert(index_entry);
+
+  if (hash_map != nullptr && comparator.IsBytewise(column_family_id)) {
+    auto it = hash_map->emplace(index_entry, index_entry);
+    if (!it.second) {
+      it.first->second = index_entry;
+    }
+  }
+}
+
+WriteBatchIndexEntry* WriteBatchWithIndex::Rep::FindNewestEntry(
+    uint32_t column_family_id, const Slice& key) {
+  WriteBatchIndexEntry search_entry(&key, column_family_id);
+  auto it = hash_map->find(&search_entry);
+  return it == hash_map->end() ? nullptr : it->second;
+}
+
+bool WriteBatchWithIndex::Rep::GetFromHashIndex(
+    uint32_t column_family_id, const Slice& key,
+    WriteBatchWithIndexInternal::Result* result, std::string* value,
+    Status* s) {
+  if (hash_map == nullptr || !comparator.IsBytewise(column_family_id)) {
+    return false;
+  }
+  *s = Status::OK();
+  WriteBatchIndexEntry* entry = FindNewestEntry(column_family_id, key);
+  if (entry == nullptr) {
+    *result = WriteBatchWithIndexInternal::Result::kNotFound;
+    return true;
+  }
+
+  WriteType type;
+  Slice entry_key, entry_value, blob, xid;
+  *s = write_batch.GetEntryFromDataOffset(entry->offset, &type, &entry_key,
+                                          &entry_value, &blob, &xid);
+  if (!s->ok()) {
+    *result = WriteBatchWithIndexInternal::Result::kError;
+  } else if (type == kPutRecord) {
+    *result = WriteBatchWithIndexInternal::Result::kFound;
+    value->assign(entry_value.data(), entry_value.size());
+  } else if (type == kDeleteRecord) {
+    *result = WriteBatchWithIndexInternal::Result::kDeleted;
+  } else {
+    *result = WriteBatchWithIndexInternal::Result::kError;
+    *s = Status::Corruption("Unexpected entry in WriteBatchWithIndex:",
+                            ToString(type));
+  }
+  return true;
 }
 
 void WriteBatchWithIndex::Rep::Clear() {
@@ -439,6 +514,9 @@ void WriteBatchWithIndex::Rep::ClearIndex() {
   arena.~Arena();
   new (&arena) Arena();
   new (&skip_list) WriteBatchEntrySkipList(comparator, &arena);
+  if (hash_map != nullptr) {
+    hash_map->clear();
+  }
   last_entry_offset = 0;
 }
 
@@ -505,8 +583,9 @@ Status WriteBatchWithIndex::Rep::ReBuildIndex() {
 
 WriteBatchWithIndex::WriteBatchWithIndex(
     const Comparator* default_index_comparator, size_t reserved_bytes,
-    bool overwrite_key)
-    : rep(new Rep(default_index_comparator, reserved_bytes, overwrite_key)) {}
+    bool overwrite_key, bool hash_index)
+    : rep(new Rep(default_index_comparator, reserved_bytes, overwrite_key,
+                  hash_index)) {}
 
 WriteBatchWithIndex::~WriteBatchWithIndex() { delete rep; }
 
@@ -601,8 +680,12 @@ Status WriteBatchWithIndex::GetFromBatchAndDB(DB* db, ReadOptions& read_options,
   const DBOptions& options = db->GetDBOptions();
 
   std::string batch_value;
-  auto result = WriteBatchWithIndexInternal::GetFromBatch(
-      options, this, column_family, key, rep->comparator, &batch_value, &s);
+  WriteBatchWithIndexInternal::Result result;
+  if (!rep->GetFromHashIndex(GetColumnFamilyID(column_family), key, &result,
+                             &batch_value, &s)) {
+    result = WriteBatchWithIndexInternal::GetFromBatch(
+        options, this, column_family, key, rep->comparator, &batch_value, &s);
+  }
 
   if (result == WriteBatchWithIndexInternal::Result::kFound) {
     value->assign(batch_value.data(), batch_value.size());
@@ -9,6 +9,7 @@
 
 #include "db/column_family.h"
 #include "util/coding.h"
+#include "util/hash.h"
 #include "util/string_util.h"
 #include "vidardb/comparator.h"
 #include "vidardb/db.h"
@@ -107,6 +108,35 @@ int WriteBatchEntryComparator::operator()(
   return 0;
 }
 
+bool WriteBatchEntryComparator::IsBytewise(uint32_t column_family) const {
+  const Comparator* cmp = GetComparator(column_family);
+  return cmp == BytewiseComparator() || cmp == ReverseBytewiseComparator();
+}
+
+namespace {
+Slice GetEntryKey(const ReadableWriteBatch* write_batch,
+                  const WriteBatchIndexEntry* entry) {
+  if (entry->search_key != nullptr) {
+    return *(entry->search_key);
+  }
+  return Slice(write_batch->Data().data() + entry->key_offset,
+               entry->key_size);
+}
+}  // namespace
+
+size_t WriteBatchEntryHash::operator()(
+    const WriteBatchIndexEntry* entry) const {
+  Slice key = GetEntryKey(write_batch_, entry);
+  return Hash(key.data(), key.size(), entry->column_family);
+}
+
+bool WriteBatchEntryEqual::operator()(
+    const WriteBatchIndexEntry* entry1,
+    const WriteBatchIndexEntry* entry2) const {
+  return entry1->column_family == entry2->column_family &&
+         GetEntryKey(write_batch_, entry1) == GetEntryKey(write_batch_, entry2);
+}
+
 int WriteBatchEntryComparator::CompareKey(uint32_t column_family,
                                           const Slice& key1,
                                           const Slice& key2) const {
@@ -8,6 +8,7 @@
 
 #include <limits>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "port/port.h"
@@ -83,12 +84,53 @@ class WriteBatchEntryComparator {
 
   const Comparator* default_comparator() { return default_comparator_; }
 
+  const Comparator* GetComparator(uint32_t column_family) const {
+    if (column_family < cf_comparators_.size() &&
+        cf_comparators_[column_family] != nullptr) {
+      return cf_comparators_[column_family];
+    }
+    return default_comparator_;
+  }
+
+  // True if the keys of column_family are equal only if their bytes are, so
+  // that they can be looked up by hash.
+  bool IsBytewise(uint32_t column_family) const;
+
  private:
   const Comparator* default_comparator_;
   std::vector<const Comparator*> cf_comparators_;
   const ReadableWriteBatch* write_batch_;
 };
 
+// Hash and equality of the keys of index entries, read from the write batch
+// as WriteBatchEntryComparator does.
+class WriteBatchEntryHash {
+ public:
+  explicit WriteBatchEntryHash(const ReadableWriteBatch* write_batch)
+      : write_batch_(write_batch) {}
+  size_t operator()(const WriteBatchIndexEntry* entry) const;
+
+ private:
+  const ReadableWriteBatch* write_batch_;
+};
+
+class WriteBatchEntryEqual {
+ public:
+  explicit WriteBatchEntryEqual(const ReadableWriteBatch* write_batch)
+      : write_batch_(write_batch) {}
+  bool operator()(const WriteBatchIndexEntry* entry1,
+                  const WriteBatchIndexEntry* entry2) const;
+
+ private:
+  const ReadableWriteBatch* write_batch_;
+};
+
+// The newest index entry of each key, by the first index entry of the key.
+// Only holds the column families for which IsBytewise() is true.
+typedef std::unordered_map<const WriteBatchIndexEntry*, WriteBatchIndexEntry*,
+                           WriteBatchEntryHash, WriteBatchEntryEqual>
+    WriteBatchEntryHashIndex;
+
 class WriteBatchWithIndexInternal {
  public:
   enum Result { kFound, kDeleted, kNotFound, kError };